@@ -0,0 +1,270 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  A hashed timer wheel for large numbers of timers.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsPlatform.h"
+
+namespace ts {
+    //!
+    //! A hashed timer wheel for large numbers of timers.
+    //! @ingroup thread
+    //!
+    //! A timer wheel is an array of slots, each slot representing a "tick" of time.
+    //! A timer is stored in the slot of its due time, modulo the number of slots.
+    //! Starting a timer does not depend on the due times of the other timers and
+    //! expiring timers only scans the slots of the elapsed ticks. The timers are also
+    //! indexed by identifier in a map, for cancellation. Starting or cancelling a timer
+    //! therefore costs O(log n) with n active timers, without moving other timers.
+    //! This is much more efficient than a sorted list when thousands of timers are
+    //! active, typically one per stream in SimulCrypt tools.
+    //!
+    //! The wheel has no notion of a clock. All times are provided by the application,
+    //! in milliseconds, relative to an arbitrary origin which is fixed for the life
+    //! of the wheel (for instance milliseconds since the start of the application).
+    //!
+    //! This class is not thread-safe. It is typically used inside an event loop.
+    //!
+    //! @tparam T Type of the data which are associated to each timer.
+    //! It is returned to the application when the timer expires.
+    //!
+    template <typename T>
+    class TimerWheel
+    {
+        TS_NOCOPY(TimerWheel);
+    public:
+        //!
+        //! Identifier of a timer in the wheel.
+        //!
+        typedef uint64_t TimerId;
+
+        //!
+        //! Value of an invalid timer identifier.
+        //!
+        static constexpr TimerId INVALID_TIMER = 0;
+
+        //!
+        //! Default number of slots in the wheel.
+        //!
+        static constexpr size_t DEFAULT_SLOTS = 1024;
+
+        //!
+        //! Constructor.
+        //! @param [in] resolution Duration of a tick in milliseconds.
+        //! @param [in] slots Number of slots in the wheel.
+        //! @param [in] origin Initial time of the wheel.
+        //!
+        TimerWheel(MilliSecond resolution = 1, size_t slots = DEFAULT_SLOTS, MilliSecond origin = 0);
+
+        //!
+        //! Start a timer.
+        //! @param [in] due Due time of the timer. When in the past, the timer expires at the next call to expire().
+        //! @param [in] data Application data which are returned when the timer expires.
+        //! @return Timer identifier, never equal to INVALID_TIMER.
+        //!
+        TimerId start(MilliSecond due, const T& data);
+
+        //!
+        //! Cancel a timer.
+        //! @param [in] id Timer identifier.
+        //! @return True if the timer was found and cancelled, false if it did not exist or already expired.
+        //!
+        bool cancel(TimerId id);
+
+        //!
+        //! Cancel all timers.
+        //!
+        void clear();
+
+        //!
+        //! Get the number of active timers.
+        //! @return The number of active timers.
+        //!
+        size_t size() const { return _index.size(); }
+
+        //!
+        //! Check if there is no active timer.
+        //! @return True if there is no active timer.
+        //!
+        bool empty() const { return _index.empty(); }
+
+        //!
+        //! Collect all timers which expired at a given time.
+        //! The expired timers are removed from the wheel.
+        //! @param [in] now Current time.
+        //! @param [out] expired Receives the data of all expired timers, in order of due time.
+        //! The data are appended to the vector, previous content is preserved.
+        //! @return The number of expired timers.
+        //!
+        size_t expire(MilliSecond now, std::vector<T>& expired);
+
+        //!
+        //! Get the maximum time to wait until the next timer may expire.
+        //! The returned value is typically used as timeout in an event loop.
+        //! When all timers are more than one revolution of the wheel away,
+        //! the returned value is the time to the end of the current revolution.
+        //! @param [in] now Current time.
+        //! @return Time to wait in milliseconds, zero if some timers already expired,
+        //! Infinite if there is no active timer.
+        //!
+        MilliSecond nextTimeout(MilliSecond now) const;
+
+    private:
+        // Description of a timer.
+        class Timer
+        {
+        public:
+            TimerId     id;
+            MilliSecond due;
+            T           data;
+            Timer(TimerId i, MilliSecond d, const T& x) : id(i), due(d), data(x) {}
+        };
+        typedef std::list<Timer> TimerList;
+        typedef std::pair<size_t, typename TimerList::iterator> TimerLocation;
+
+        const MilliSecond      _resolution;
+        std::vector<TimerList> _slots;
+        std::map<TimerId, TimerLocation> _index {};
+        MilliSecond            _tick = 0;     // Current tick, all previous ticks were scanned.
+        TimerId                _next_id = 1;  // Next timer id to allocate.
+
+        // Compute the tick of a given time.
+        MilliSecond tickOf(MilliSecond time) const { return time / _resolution; }
+    };
+}
+
+
+//----------------------------------------------------------------------------
+// Template definitions.
+//----------------------------------------------------------------------------
+
+#if !defined(TS_CXX17)
+template <typename T>
+constexpr typename ts::TimerWheel<T>::TimerId ts::TimerWheel<T>::INVALID_TIMER;
+template <typename T>
+constexpr size_t ts::TimerWheel<T>::DEFAULT_SLOTS;
+#endif
+
+// Constructor.
+template <typename T>
+ts::TimerWheel<T>::TimerWheel(MilliSecond resolution, size_t slots, MilliSecond origin) :
+    _resolution(std::max<MilliSecond>(1, resolution)),
+    _slots(std::max<size_t>(1, slots)),
+    _tick(tickOf(origin))
+{
+}
+
+// Start a timer.
+template <typename T>
+typename ts::TimerWheel<T>::TimerId ts::TimerWheel<T>::start(MilliSecond due, const T& data)
+{
+    // A timer in the past is stored in the current slot.
+    const size_t slot = size_t(std::max(tickOf(due), _tick) % MilliSecond(_slots.size()));
+    const TimerId id = _next_id++;
+    TimerList& list(_slots[slot]);
+    _index.insert(std::make_pair(id, TimerLocation(slot, list.insert(list.end(), Timer(id, due, data)))));
+    return id;
+}
+
+// Cancel a timer.
+template <typename T>
+bool ts::TimerWheel<T>::cancel(TimerId id)
+{
+    const auto it = _index.find(id);
+    if (it == _index.end()) {
+        return false;
+    }
+    else {
+        _slots[it->second.first].erase(it->second.second);
+        _index.erase(it);
+        return true;
+    }
+}
+
+// Cancel all timers.
+template <typename T>
+void ts::TimerWheel<T>::clear()
+{
+    for (auto& list : _slots) {
+        list.clear();
+    }
+    _index.clear();
+}
+
+// Collect all expired timers.
+template <typename T>
+size_t ts::TimerWheel<T>::expire(MilliSecond now, std::vector<T>& expired)
+{
+    const MilliSecond now_tick = tickOf(now);
+    if (now_tick < _tick || _index.empty()) {
+        _tick = std::max(_tick, now_tick);
+        return 0;
+    }
+
+    // Scan all slots from the current tick, each slot at most once.
+    // The slot of the current tick is scanned again next time since it
+    // may contain timers with a due time later in the same tick.
+    std::vector<Timer> timers;
+    const MilliSecond count = std::min(now_tick - _tick + 1, MilliSecond(_slots.size()));
+    for (MilliSecond tick = _tick; tick < _tick + count; ++tick) {
+        const size_t slot = size_t(tick % MilliSecond(_slots.size()));
+        TimerList& list(_slots[slot]);
+        for (auto it = list.begin(); it != list.end(); ) {
+            if (it->due <= now) {
+                _index.erase(it->id);
+                timers.push_back(std::move(*it));
+                it = list.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+    _tick = now_tick;
+
+    // Return the expired timers in order of due time, then order of start.
+    std::sort(timers.begin(), timers.end(), [](const Timer& t1, const Timer& t2) {
+        return t1.due < t2.due || (t1.due == t2.due && t1.id < t2.id);
+    });
+    expired.reserve(expired.size() + timers.size());
+    for (auto& t : timers) {
+        expired.push_back(std::move(t.data));
+    }
+    return timers.size();
+}
+
+// Get the maximum time to wait until the next timer may expire.
+template <typename T>
+ts::MilliSecond ts::TimerWheel<T>::nextTimeout(MilliSecond now) const
+{
+    if (_index.empty()) {
+        return Infinite;
+    }
+
+    // Look for the first slot with timers in the current revolution of the wheel.
+    // A timer in the past is stored in the slot of the current tick.
+    const MilliSecond end = _tick + MilliSecond(_slots.size());
+    for (MilliSecond tick = _tick; tick < end; ++tick) {
+        MilliSecond due = Infinite;
+        for (const auto& t : _slots[size_t(tick % MilliSecond(_slots.size()))]) {
+            if (tickOf(t.due) <= tick) {
+                due = std::min(due, t.due);
+            }
+        }
+        if (due != Infinite) {
+            return std::max<MilliSecond>(0, due - now);
+        }
+    }
+
+    // All timers are in later revolutions, wake up at the end of this one.
+    return std::max<MilliSecond>(0, end * _resolution - now);
+}
@@ -0,0 +1,324 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+
+#include "tsFileBatch.h"
+#include "tsFileUtils.h"
+#include "tsGuardMutex.h"
+#include "tsMonotonic.h"
+#include "tsjsonObject.h"
+#include "tsjsonArray.h"
+
+
+//----------------------------------------------------------------------------
+// Constructors and destructors.
+//----------------------------------------------------------------------------
+
+ts::FileBatch::FileBatch(const UString& report_suffix) :
+    _report_suffix(report_suffix)
+{
+}
+
+ts::FileBatch::~FileBatch()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Define command line options in an Args.
+//----------------------------------------------------------------------------
+
+void ts::FileBatch::defineArgs(Args& args)
+{
+    args.option(u"file-list", 0, Args::FILENAME, 0, Args::UNLIMITED_COUNT);
+    args.help(u"file-list",
+              u"A text file containing a list of input files, one per line. "
+              u"The files from this list are processed after the files from the command line. "
+              u"Several --file-list options may be specified.");
+
+    args.option(u"output-directory", 0, Args::DIRECTORY);
+    args.help(u"output-directory",
+              u"Write the report of each input file in a file in the specified directory. "
+              u"The name of each report file is the base name of the input file with suffix \"" + _report_suffix + u"\". "
+              u"When several input files have the same base name, their index in the list of input files "
+              u"(starting at 1) is appended to the base name, before the suffix. "
+              u"The directory is created if it does not exist. "
+              u"By default, when several input files are specified, all reports are written on the standard output, "
+              u"in the order of the input files, each one being preceded by a header line with the file name.");
+
+    args.option(u"summary-json", 0, Args::FILENAME);
+    args.help(u"summary-json",
+              u"Write a JSON summary of the processing of all input files in the specified file. "
+              u"If the file name is \"-\", the summary is written on the standard output.");
+
+    args.option(u"threads", 0, Args::POSITIVE);
+    args.help(u"threads",
+              u"Number of input files which are processed in parallel. "
+              u"The default is the number of CPU cores in the system.");
+}
+
+
+//----------------------------------------------------------------------------
+// Load arguments from command line.
+//----------------------------------------------------------------------------
+
+bool ts::FileBatch::loadArgs(Args& args)
+{
+    bool ok = true;
+    const size_t cores = std::max<size_t>(1, std::thread::hardware_concurrency());
+    args.getIntValue(_thread_count, u"threads", cores);
+    args.getValue(_output_dir, u"output-directory");
+    args.getValue(_summary_file, u"summary-json");
+
+    // Expand wildcards in file names (on Windows, the shell does not expand them).
+    UStringVector names;
+    args.getValues(names, u"");
+    _files.clear();
+    for (const auto& name : names) {
+        if (name.find(u'*') == NPOS && name.find(u'?') == NPOS) {
+            _files.push_back(name);
+        }
+        else if (!ExpandWildcardAndAppend(_files, name)) {
+            args.error(u"error expanding %s", {name});
+            ok = false;
+        }
+    }
+
+    // Load file lists.
+    UStringVector lists;
+    args.getValues(lists, u"file-list");
+    for (const auto& list : lists) {
+        UStringList lines;
+        if (!UString::Load(lines, list)) {
+            args.error(u"error reading %s", {list});
+            ok = false;
+        }
+        for (auto& line : lines) {
+            line.trim();
+            if (!line.empty()) {
+                _files.push_back(line);
+            }
+        }
+    }
+
+    // Without input file, use the standard input.
+    if (names.empty() && lists.empty()) {
+        _files.push_back(UString());
+    }
+    else if (_files.empty()) {
+        args.error(u"no input file found");
+        ok = false;
+    }
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Process all input files.
+//----------------------------------------------------------------------------
+
+bool ts::FileBatch::run(Report& report, std::ostream& output)
+{
+    const Monotonic start(true);
+
+    _report = &report;
+    _output = &output;
+    _next_file = 0;
+    _next_output = 0;
+    _results.clear();
+    _results.resize(_files.size());
+
+    if (!_output_dir.empty()) {
+        if (!IsDirectory(_output_dir) && !CreateDirectory(_output_dir, true, report)) {
+            return false;
+        }
+        buildReportNames();
+    }
+
+    if (!batchMode()) {
+        // One single file, process it in the current thread.
+        processOne(0);
+    }
+    else {
+        // Start a pool of threads and wait for all of them.
+        std::vector<WorkerPtr> workers;
+        const size_t count = std::min(_thread_count, _files.size());
+        report.verbose(u"processing %d files in %d threads", {_files.size(), count});
+        for (size_t i = 0; i < count; ++i) {
+            workers.push_back(new Worker(this));
+            workers.back()->start();
+        }
+        for (const auto& w : workers) {
+            w->waitForTermination();
+        }
+    }
+
+    // Overall status.
+    bool success = true;
+    for (const auto& res : _results) {
+        success = success && res.success;
+    }
+
+    if (!_summary_file.empty()) {
+        success = writeSummary((Monotonic(true) - start) / NanoSecPerMilliSec) && success;
+    }
+
+    _report = nullptr;
+    _output = nullptr;
+    return success;
+}
+
+
+//----------------------------------------------------------------------------
+// Build unique report file names in the output directory.
+//----------------------------------------------------------------------------
+
+void ts::FileBatch::buildReportNames()
+{
+    // Input files in distinct directories may have the same base name.
+    // Compare names without case, some file systems are case-insensitive.
+    UStringVector bases;
+    std::map<UString, size_t> count;
+    for (const auto& name : _files) {
+        bases.push_back(name.empty() ? u"stdin" : BaseName(name));
+        count[bases.back().toLower()]++;
+    }
+
+    std::set<UString> used;
+    _report_names.clear();
+    for (size_t i = 0; i < bases.size(); ++i) {
+        UString name(bases[i]);
+        if (count[name.toLower()] > 1) {
+            name += UString::Format(u"-%d", {i + 1});
+        }
+        // In the unlikely case where an input file is already named "name-N", add the index again.
+        while (!used.insert(name.toLower()).second) {
+            name += UString::Format(u"-%d", {i + 1});
+        }
+        _report_names.push_back(_output_dir + PathSeparator + name + _report_suffix);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Thread in the pool: process files until there is none left.
+//----------------------------------------------------------------------------
+
+void ts::FileBatch::Worker::main()
+{
+    for (;;) {
+        size_t index = 0;
+        {
+            GuardMutex lock(_batch->_mutex);
+            if (_batch->_next_file >= _batch->_files.size()) {
+                break;
+            }
+            index = _batch->_next_file++;
+        }
+        _batch->processOne(index);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Process one file.
+//----------------------------------------------------------------------------
+
+void ts::FileBatch::processOne(size_t index)
+{
+    const UString& name(_files[index]);
+    FileResult& res(_results[index]);
+    const UString display_name(name.empty() ? u"standard input" : name);
+    const Monotonic start(true);
+    json::Object* summary = new json::Object;
+    res.summary = summary;
+    summary->add(u"file", display_name);
+
+    if (!batchMode()) {
+        // Single file, directly use the application report and output.
+        res.success = processFile(name, *_output, *_report, *summary);
+    }
+    else {
+        // All messages are prefixed with the file name.
+        SyncReport report(*_report, _mutex, display_name + u": ");
+        if (!_output_dir.empty()) {
+            const UString& out_name(_report_names[index]);
+            std::ofstream out(out_name.toUTF8().c_str());
+            if (!out) {
+                report.error(u"cannot create %s", {out_name});
+            }
+            else {
+                res.success = processFile(name, out, report, *summary);
+                out.close();
+                summary->add(u"report", out_name);
+            }
+        }
+        else {
+            std::ostringstream out;
+            res.success = processFile(name, out, report, *summary);
+            res.output = out.str();
+        }
+    }
+
+    summary->add(u"status", UString(res.success ? u"success" : u"error"));
+    summary->add(u"duration-ms", (Monotonic(true) - start) / NanoSecPerMilliSec);
+
+    // Write all buffered reports which are now complete, in the order of the input files.
+    GuardMutex lock(_mutex);
+    res.done = true;
+    while (_next_output < _results.size() && _results[_next_output].done) {
+        FileResult& next(_results[_next_output]);
+        if (batchMode() && _output_dir.empty()) {
+            *_output << "==== " << _files[_next_output] << std::endl << next.output;
+            _output->flush();
+            next.output.clear();
+            next.output.shrink_to_fit();
+        }
+        _next_output++;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Write the JSON summary file.
+//----------------------------------------------------------------------------
+
+bool ts::FileBatch::writeSummary(MilliSecond duration)
+{
+    json::Object root;
+    json::Array* files = new json::Array;
+    size_t errors = 0;
+    for (const auto& res : _results) {
+        files->set(res.summary);
+        errors += !res.success;
+    }
+    root.add(u"files", _files.size());
+    root.add(u"errors", errors);
+    root.add(u"threads", batchMode() ? std::min(_thread_count, _files.size()) : 1);
+    root.add(u"duration-ms", duration);
+    root.add(u"results", json::ValuePtr(files));
+    return root.save(_summary_file, 2, true, *_report);
+}
+
+
+//----------------------------------------------------------------------------
+// A report which serializes messages from several threads.
+//----------------------------------------------------------------------------
+
+ts::FileBatch::SyncReport::SyncReport(Report& report, Mutex& mutex, const UString& prefix) :
+    Report(report.maxSeverity()),
+    _report(report),
+    _mutex(mutex),
+    _prefix(prefix)
+{
+}
+
+void ts::FileBatch::SyncReport::writeLog(int severity, const UString& msg)
+{
+    GuardMutex lock(_mutex);
+    _report.log(severity, _prefix + msg);
+}
@@ -0,0 +1,193 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Process a batch of input files in a pool of threads.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsArgs.h"
+#include "tsThread.h"
+#include "tsMutex.h"
+#include "tsjsonValue.h"
+
+namespace ts {
+
+    namespace json {
+        class Object;
+    }
+
+    //!
+    //! Process a batch of input files in a pool of threads.
+    //! @ingroup cmd
+    //!
+    //! This class is used by commands which analyze one input file, such as @c tsanalyze
+    //! or @c tstables, to process a list of files in one single process. The list of
+    //! files comes from the command line parameters (with wildcards) and from an optional
+    //! text file. Each file is processed in one thread of a pool. Each thread picks the
+    //! next unprocessed file when it completes the previous one, so that small and large
+    //! files are evenly distributed over the threads.
+    //!
+    //! The text report of each file is either written in a file in an output directory
+    //! or buffered and written on the standard output in the order of the input files.
+    //! An aggregated JSON summary of all files can be produced.
+    //!
+    //! When there is only one input file and no output directory, the file is processed
+    //! in the calling thread and its report is directly written on the output stream.
+    //!
+    //! The application shall define a subclass which implements processFile().
+    //! The application shall also define the parameters of the command (option @c "")
+    //! with an unlimited number of values.
+    //!
+    class TSDUCKDLL FileBatch
+    {
+        TS_NOCOPY(FileBatch);
+    public:
+        //!
+        //! Constructor.
+        //! @param [in] report_suffix Suffix of report files in the output directory.
+        //!
+        FileBatch(const UString& report_suffix = u".txt");
+
+        //!
+        //! Destructor.
+        //!
+        virtual ~FileBatch();
+
+        //!
+        //! Add command line option definitions in an Args.
+        //! @param [in,out] args Command line arguments to update.
+        //!
+        void defineArgs(Args& args);
+
+        //!
+        //! Load arguments from command line.
+        //! Args error indicator is set in case of incorrect arguments.
+        //! @param [in,out] args Command line arguments.
+        //! @return True on success, false on error in argument line.
+        //!
+        bool loadArgs(Args& args);
+
+        //!
+        //! Get the list of input files.
+        //! @return A constant reference to the list of input file names.
+        //! An empty name means the standard input.
+        //!
+        const UStringVector& fileNames() const { return _files; }
+
+        //!
+        //! Check if several files are processed in the thread pool.
+        //! @return True if several files are processed in the thread pool.
+        //!
+        bool batchMode() const { return _files.size() > 1 || !_output_dir.empty(); }
+
+        //!
+        //! Check if the reports are written on the output stream of run().
+        //! @return True if the reports are written on the output stream of run(),
+        //! false if they are written in an output directory.
+        //!
+        bool useOutputStream() const { return _output_dir.empty(); }
+
+        //!
+        //! Set the suffix of report files in the output directory.
+        //! @param [in] suffix Suffix of report files, including the dot.
+        //!
+        void setReportSuffix(const UString& suffix) { _report_suffix = suffix; }
+
+        //!
+        //! Process all input files.
+        //! @param [in,out] report Where to report errors. All messages about a file are prefixed
+        //! with the file name in batch mode.
+        //! @param [in,out] output Output stream for the reports, when there is no output directory.
+        //! @return True if all files were successfully processed, false otherwise.
+        //!
+        bool run(Report& report, std::ostream& output);
+
+    protected:
+        //!
+        //! Process one input file.
+        //! This method is invoked in any thread of the pool, possibly simultaneously for several files.
+        //! Data which are shared with the application, such as the command line arguments, shall be
+        //! accessed only under the protection of mutex().
+        //! @param [in] file_name Input file name. Empty for the standard input.
+        //! @param [in,out] output Output stream for the text report of this file.
+        //! @param [in,out] report Where to report errors for this file.
+        //! @param [in,out] summary JSON object where the subclass adds the summary data of this file.
+        //! The fields @c "file", @c "status" and @c "duration-ms" are added by this class.
+        //! @return True on success, false on error.
+        //!
+        virtual bool processFile(const UString& file_name, std::ostream& output, Report& report, json::Object& summary) = 0;
+
+        //!
+        //! Get a mutex to protect the data which are shared by all files, such as command line arguments.
+        //! @return A reference to the mutex.
+        //!
+        Mutex& mutex() { return _args_mutex; }
+
+    private:
+        // Result of one input file.
+        class FileResult
+        {
+        public:
+            bool           done = false;    // File was completely processed.
+            bool           success = false; // Processing status.
+            std::string    output {};       // Buffered text report (UTF-8).
+            json::ValuePtr summary {};      // Summary of the file.
+        };
+
+        // A report which serializes messages from several threads to a common report.
+        class SyncReport : public Report
+        {
+            TS_NOBUILD_NOCOPY(SyncReport);
+        public:
+            SyncReport(Report& report, Mutex& mutex, const UString& prefix);
+        protected:
+            virtual void writeLog(int severity, const UString& msg) override;
+        private:
+            Report& _report;
+            Mutex&  _mutex;
+            UString _prefix;
+        };
+
+        // Processing thread in the pool.
+        class Worker : public Thread
+        {
+            TS_NOBUILD_NOCOPY(Worker);
+        public:
+            Worker(FileBatch* batch) : _batch(batch) {}
+        private:
+            FileBatch* _batch;
+            virtual void main() override;
+        };
+        typedef SafePtr<Worker, NullMutex> WorkerPtr;
+
+        UString                 _report_suffix;
+        size_t                  _thread_count = 0;
+        UString                 _output_dir {};
+        UString                 _summary_file {};
+        UStringVector           _files {};
+        UStringVector           _report_names {};      // Report file names in output directory, same index as _files.
+        Report*                 _report = nullptr;     // Application report during run().
+        std::ostream*           _output = nullptr;     // Output stream during run().
+        Mutex                   _args_mutex {};        // Protection of application data.
+        Mutex                   _mutex {};             // Protection of all fields below.
+        size_t                  _next_file = 0;        // Index of next file to process.
+        size_t                  _next_output = 0;      // Index of next file to output.
+        std::vector<FileResult> _results {};           // Results of all files.
+
+        // Build unique report file names in the output directory.
+        void buildReportNames();
+
+        // Process one file, return false on error.
+        void processOne(size_t index);
+
+        // Write the JSON summary file.
+        bool writeSummary(MilliSecond duration);
+    };
+}
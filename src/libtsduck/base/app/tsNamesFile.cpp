@@ -244,59 +244,158 @@ ts::NamesFile::NamesFile(const UString& fileName, bool mergeExtensions) :
 // Load a configuration file and merge its content into this instance.
 //----------------------------------------------------------------------------
 
+namespace {
+    // Locate the next line in a text buffer. Return the trimmed line in [begin, end).
+    // Return the offset of the next line.
+    size_t NextLine(const std::string& text, size_t pos, size_t& begin, size_t& end)
+    {
+        const size_t eol = text.find('\n', pos);
+        const size_t next = eol == std::string::npos ? text.size() : eol + 1;
+        begin = pos;
+        end = eol == std::string::npos ? text.size() : eol;
+        while (begin < end && std::isspace(static_cast<unsigned char>(text[begin]))) {
+            begin++;
+        }
+        while (end > begin && std::isspace(static_cast<unsigned char>(text[end - 1]))) {
+            end--;
+        }
+        return next;
+    }
+}
+
 void ts::NamesFile::loadFile(const UString& fileName)
 {
     _log.debug(u"loading names file %s", {fileName});
 
-    // Open configuration file.
-    std::ifstream strm(fileName.toUTF8().c_str());
+    // Load the complete configuration file in memory.
+    std::ifstream strm(fileName.toUTF8().c_str(), std::ios::in | std::ios::binary);
     if (!strm) {
         _configErrors++;
         _log.error(u"error opening file %s", {fileName});
         return;
     }
+    const size_t file_index = _contents.size();
+    _contents.emplace_back(std::istreambuf_iterator<char>(strm), std::istreambuf_iterator<char>());
+    _fileNames.push_back(fileName);
+    strm.close();
+    const std::string& text(_contents.back());
 
-    ConfigSection* section = nullptr;
-    UString line;
-
-    // Read configuration file line by line.
-    for (size_t lineNumber = 1; line.getLine(strm); ++lineNumber) {
+    // Skip UTF-8 BOM, if present.
+    size_t pos = text.compare(0, 3, "\xEF\xBB\xBF") == 0 ? 3 : 0;
 
-        // Remove leading and trailing spaces in line.
-        line.trim();
+    // Locate all section headers. The section lines are parsed later, when the section is used.
+    ConfigSection* section = nullptr;
+    for (size_t lineNumber = 1; pos < text.size(); ++lineNumber) {
+        size_t begin = 0;
+        size_t end = 0;
+        const size_t next = NextLine(text, pos, begin, end);
 
-        if (line.empty() || line[0] == UChar('#')) {
-            // Empty or comment line, ignore.
-        }
-        else if (line.front() == UChar('[') && line.back() == UChar(']')) {
+        if (begin < end && text[begin] == '[' && text[end - 1] == ']') {
             // Handle beginning of section, get section name.
-            line.erase(0, 1);
-            line.pop_back();
-            line.convertToLower();
+            const UString name(UString::FromUTF8(text.data() + begin + 1, end - begin - 2).toLower());
 
             // Get or create associated section.
-            auto it = _sections.find(line);
+            auto it = _sections.find(name);
             if (it != _sections.end()) {
                 section = it->second;
             }
             else {
-                // Create new section.
                 section = new ConfigSection;
                 CheckNonNull(section);
-                _sections.insert(std::make_pair(line, section));
+                _sections.insert(std::make_pair(name, section));
             }
+            section->chunks.push_back({file_index, next, next, lineNumber + 1});
+        }
+        else if (section != nullptr) {
+            // Extend the current chunk of lines in the section.
+            section->chunks.back().end = next;
         }
-        else if (!decodeDefinition(line, section)) {
-            // Invalid line.
-            _log.error(u"%s: invalid line %d: %s", {fileName, lineNumber, line});
-            if (++_configErrors >= 20) {
-                // Give up after that number of errors
-                _log.error(u"%s: too many errors, giving up", {fileName});
+        else if (begin < end && text[begin] != '#') {
+            // Definition outside any section.
+            if (!configError(fileName, UString::Format(u"invalid line %d: %s", {lineNumber, UString::FromUTF8(text.data() + begin, end - begin)}))) {
                 break;
             }
         }
+        pos = next;
     }
-    strm.close();
+}
+
+
+//----------------------------------------------------------------------------
+// Report an error in a names file.
+//----------------------------------------------------------------------------
+
+bool ts::NamesFile::configError(const UString& fileName, const UString& message) const
+{
+    // Errors after the maximum are counted but no longer reported.
+    if (_configErrors < MAX_CONFIG_ERRORS) {
+        _log.error(u"%s: %s", {fileName, message});
+        if (++_configErrors == MAX_CONFIG_ERRORS) {
+            _log.error(u"%s: too many errors, giving up", {fileName});
+        }
+    }
+    else {
+        _configErrors++;
+    }
+    return _configErrors < MAX_CONFIG_ERRORS;
+}
+
+
+//----------------------------------------------------------------------------
+// Parse the lines of a section, if not yet done.
+//----------------------------------------------------------------------------
+
+void ts::NamesFile::parseSection(ConfigSection* section) const
+{
+    // Fast path, without synchronization, when the section is already parsed.
+    if (section == nullptr || section->parsed) {
+        return;
+    }
+
+    // Parse the section under the protection of the mutex, the section may be parsed in the meantime.
+    GuardMutex lock(_mutex);
+    if (section->parsed) {
+        return;
+    }
+
+    bool valid = true;
+    for (auto chunk = section->chunks.begin(); valid && chunk != section->chunks.end(); ++chunk) {
+        const std::string& text(_contents[chunk->file]);
+        size_t pos = chunk->begin;
+        for (size_t lineNumber = chunk->line; valid && pos < chunk->end; ++lineNumber) {
+            size_t begin = 0;
+            size_t end = 0;
+            pos = NextLine(text, pos, begin, end);
+            if (begin < end && text[begin] != '#' && !decodeDefinition(chunk->file, lineNumber, text.data() + begin, end - begin, section)) {
+                valid = configError(_fileNames[chunk->file], UString::Format(u"invalid line %d: %s", {lineNumber, UString::FromUTF8(text.data() + begin, end - begin)}));
+            }
+        }
+    }
+
+    // The entries are in load order: main file first, then extensions. When two ranges
+    // overlap, the first one is kept and the next one is an error. Index the accepted
+    // entries by first value, then sort the entries by first value.
+    std::map<Value, size_t> accepted;
+    for (size_t i = 0; i < section->entries.size(); ++i) {
+        const ConfigEntry& entry(section->entries[i]);
+        auto it = accepted.lower_bound(entry.first);
+        if ((it != accepted.end() && section->entries[it->second].first <= entry.last) ||
+            (it != accepted.begin() && section->entries[(--it)->second].last >= entry.first))
+        {
+            configError(_fileNames[entry.file], UString::Format(u"line %d: range 0x%X-0x%X overlaps with an existing range", {entry.line, entry.first, entry.last}));
+        }
+        else {
+            accepted.insert(std::make_pair(entry.first, i));
+        }
+    }
+    std::vector<ConfigEntry> entries;
+    entries.reserve(accepted.size());
+    for (const auto& it : accepted) {
+        entries.push_back(section->entries[it.second]);
+    }
+    section->entries.swap(entries);
+
+    section->parsed = true;
 }
 
 
@@ -304,20 +403,23 @@ void ts::NamesFile::loadFile(const UString& fileName)
 // Decode a line as "first[-last] = name". Return true on success.
 //----------------------------------------------------------------------------
 
-bool ts::NamesFile::decodeDefinition(const UString& line, ConfigSection* section)
+bool ts::NamesFile::decodeDefinition(size_t file, size_t line_number, const char* line, size_t size, ConfigSection* section) const
 {
-    // Check the presence of the '=' and in a valid section.
-    const size_t equal = line.find(UChar('='));
-    if (equal == 0 || equal == NPOS || section == nullptr) {
+    // Check the presence of the '='.
+    const char* const equal = reinterpret_cast<const char*>(std::memchr(line, '=', size));
+    if (equal == nullptr || equal == line) {
         return false;
     }
 
-    // Extract fields.
-    UString range(line, 0, equal);
+    // Extract fields. The range part is always ASCII. The name is kept in UTF-8.
+    UString range(UString::FromUTF8(line, equal - line));
     range.trim();
 
-    UString value(line, equal + 1, line.length() - equal - 1);
-    value.trim();
+    const char* value = equal + 1;
+    const char* const value_end = line + size;
+    while (value < value_end && std::isspace(static_cast<unsigned char>(*value))) {
+        value++;
+    }
 
     // Allowed "thousands separators" (ignored characters)
     const UString ignore(u".,_");
@@ -325,133 +427,90 @@ bool ts::NamesFile::decodeDefinition(const UString& line, ConfigSection* section
     // Special cases (not values):
     if (range.similar(u"bits")) {
         // Specification of size in bits of values in this section.
-        return value.toInteger(section->bits, ignore, 0, UString());
+        return UString::FromUTF8(value, value_end - value).toInteger(section->bits, ignore, 0, UString());
     }
     else if (range.similar(u"inherit")) {
         // Name of a section where to search unknown values here.
-        section->inherit = value;
+        section->inherit = UString::FromUTF8(value, value_end - value);
         return true;
     }
 
     // Decode "first[-last]"
-    Value first = 0;
-    Value last = 0;
+    ConfigEntry entry;
     const size_t dash = range.find(UChar('-'));
     bool valid = false;
 
     if (dash == NPOS) {
-        valid = range.toInteger(first, ignore, 0, UString());
-        last = first;
+        valid = range.toInteger(entry.first, ignore, 0, UString());
+        entry.last = entry.first;
     }
     else {
-        valid = range.substr(0, dash).toInteger(first, ignore, 0, UString()) && range.substr(dash + 1).toInteger(last, ignore, 0, UString()) && last >= first;
+        valid = range.substr(0, dash).toInteger(entry.first, ignore, 0, UString()) && range.substr(dash + 1).toInteger(entry.last, ignore, 0, UString()) && entry.last >= entry.first;
     }
 
-    // Add the definition.
+    // Add the definition, overlapping ranges are checked later.
     if (valid) {
-        if (section->freeRange(first, last)) {
-            section->addEntry(first, last, value);
-        }
-        else {
-            _log.error(u"%s: range 0x%X-0x%X overlaps with an existing range", {_configFile, first, last});
-            valid = false;
-        }
+        entry.file = uint32_t(file);
+        entry.offset = uint32_t(value - _contents[file].data());
+        entry.size = uint32_t(value_end - value);
+        entry.line = uint32_t(line_number);
+        section->entries.push_back(entry);
     }
     return valid;
 }
 
 
 //----------------------------------------------------------------------------
-// Destructor: free all resources.
+// Get the number of errors in the configuration file.
 //----------------------------------------------------------------------------
 
-ts::NamesFile::~NamesFile()
+size_t ts::NamesFile::errorCount() const
 {
-    // Deallocate all configuration sections.
     for (const auto& it : _sections) {
-        delete it.second;
+        parseSection(it.second);
     }
-    _sections.clear();
+    return _configErrors;
 }
 
 
 //----------------------------------------------------------------------------
-// Configuration section.
+// Destructor: free all resources.
 //----------------------------------------------------------------------------
 
-ts::NamesFile::ConfigSection::~ConfigSection()
+ts::NamesFile::~NamesFile()
 {
-    // Deallocate all configuration entries.
-    for (const auto& it : entries) {
+    // Deallocate all configuration sections.
+    for (const auto& it : _sections) {
         delete it.second;
     }
-    entries.clear();
-}
-
-
-//----------------------------------------------------------------------------
-// Check if a range is free, ie no value is defined in the range.
-//----------------------------------------------------------------------------
-
-bool ts::NamesFile::ConfigSection::freeRange(Value first, Value last) const
-{
-    // Get an iterator pointing to the first element that is "not less" than 'first'.
-    auto it = entries.lower_bound(first);
-
-    if (it != entries.end() && it->first <= last) {
-        // This is an existing range which starts inside [first..last].
-        assert(it->first >= first);
-        return false;
-    }
-
-    if (it != entries.begin() && (--it)->second->last >= first) {
-        // The previous range ends inside [first..last].
-        assert(it->first < first);
-        return false;
-    }
-
-    // No overlap found.
-    return true;
+    _sections.clear();
 }
 
 
 //----------------------------------------------------------------------------
-// Add a new configuration entry.
+// Get the entry for a value, null if not found.
 //----------------------------------------------------------------------------
 
-void ts::NamesFile::ConfigSection::addEntry(Value first, Value last, const UString& name)
+const ts::NamesFile::ConfigEntry* ts::NamesFile::ConfigSection::getEntry(Value val) const
 {
-    ConfigEntry* entry = new ConfigEntry(last, name);
-    CheckNonNull(entry);
-    entries.insert(std::make_pair(first, entry));
+    // Get the first entry with a first value which is strictly greater than val.
+    // The entry for val, if any, is the previous one.
+    auto it = std::upper_bound(entries.begin(), entries.end(), val, [](Value v, const ConfigEntry& e) { return v < e.first; });
+    if (it == entries.begin()) {
+        return nullptr;
+    }
+    --it;
+    return val <= it->last ? &*it : nullptr;
 }
 
 
 //----------------------------------------------------------------------------
-// Get a name from a value, empty if not found.
+// Get the name of an entry.
 //----------------------------------------------------------------------------
 
-ts::UString ts::NamesFile::ConfigSection::getName(Value val) const
+ts::UString ts::NamesFile::entryName(const ConfigEntry& entry) const
 {
-    // Eliminate trivial cases which would cause issues with code below.
-    if (entries.empty()) {
-        return UString();
-    }
-
-    // The key in the 'entries' map is the _first_ value of a range.
-    // Get an iterator pointing to the first element that is "not less" than 'val'.
-    auto it = entries.lower_bound(val);
-
-    if (it == entries.end() || (it != entries.begin() && it->first != val)) {
-        // There is no entry with a value range starting at 'val'.
-        // Maybe 'val' is in the range of the previous entry.
-        --it;
-    }
-
-    assert(it != entries.end());
-    assert(it->second != nullptr);
-
-    return val >= it->first && val <= it->second->last ? it->second->name : UString();
+    return UString::FromUTF8(_contents[entry.file].data() + entry.offset, entry.size);
 }
 
 
@@ -574,7 +633,14 @@ void ts::NamesFile::getName(const UString& sectionName, Value value, ConfigSecti
 
         // Get the name of the value in the section.
         section = it->second;
-        name = section->getName(value);
+        parseSection(section);
+        const ConfigEntry* entry = section->getEntry(value);
+        if (entry != nullptr) {
+            name = entryName(*entry);
+        }
+        else {
+            name.clear();
+        }
 
         // Return when name found or no "superclass" or too many levels of inheritance.
         if (!name.empty() || section->inherit.empty() || levels-- <= 0) {
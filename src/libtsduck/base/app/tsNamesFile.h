@@ -16,6 +16,7 @@
 #include "tsEnumUtils.h"
 #include "tsReport.h"
 #include "tsVersionInfo.h"
+#include "tsMutex.h"
 
 namespace ts {
     //!
@@ -124,9 +125,11 @@ namespace ts {
 
         //!
         //! Get the number of errors in the configuration file.
+        //! The sections of the configuration file are normally analyzed on demand, when a name is
+        //! first requested in them. This method analyzes all sections to get the complete error count.
         //! @return The number of errors in the configuration file.
         //!
-        size_t errorCount() const { return _configErrors; }
+        size_t errorCount() const;
 
         //!
         //! Check if a name exists in a specified section.
@@ -198,48 +201,68 @@ namespace ts {
         static void UnregisterExtensionFile(const UString& filename);
 
     private:
+        // The content of the names files is loaded in memory, in UTF-8 format. Only the section headers
+        // are located when the file is loaded. The content of a section is parsed when the section is
+        // first used. Names are converted to UString only when they are returned to the application.
+        // This makes the loading of a names file fast and its memory footprint close to the file size.
+
+        // Location of a range of lines in the content of a names file.
+        class ConfigChunk
+        {
+        public:
+            size_t file = 0;   // Index of file content in _contents.
+            size_t begin = 0;  // Offset of first line.
+            size_t end = 0;    // Offset after last line.
+            size_t line = 0;   // Line number of first line.
+        };
+
         // Description of a configuration entry.
-        // The first value of the range is the key in a map.
         class ConfigEntry
         {
         public:
-            Value   last = 0;  // Last value in the range.
-            UString name {};   // Associated name.
-
-            ConfigEntry(Value l = 0, const UString& n = UString()) : last(l), name(n) {}
+            Value    first = 0;   // First value in the range.
+            Value    last = 0;    // Last value in the range.
+            uint32_t file = 0;    // Index of file content in _contents.
+            uint32_t offset = 0;  // Offset of the name (UTF-8) in the file content.
+            uint32_t size = 0;    // Size in bytes of the name.
+            uint32_t line = 0;    // Line number in the file, for error messages.
         };
 
-        // Map of configuration entries, indexed by first value of the range.
-        typedef std::map<Value, ConfigEntry*> ConfigEntryMap;
-
         // Description of a configuration section.
         // The name of the section is the key in a map.
         class ConfigSection
         {
             TS_NOCOPY(ConfigSection);
         public:
-            size_t          bits = 0;     // Number of significant bits in values of the type.
-            ConfigEntryMap  entries {};   // All entries, indexed by names.
-            UString         inherit {};   // Redirect to this section if value not found.
+            std::atomic<bool>        parsed {false}; // The lines of the section have been parsed.
+            size_t                   bits = 0;       // Number of significant bits in values of the type.
+            UString                  inherit {};     // Redirect to this section if value not found.
+            std::vector<ConfigChunk> chunks {};      // Location of the lines of the section.
+            std::vector<ConfigEntry> entries {};     // All entries, sorted by first value, after parsing.
 
             ConfigSection() = default;
-            ~ConfigSection();
 
-            // Check if a range is free, ie no value is defined in the range.
-            bool freeRange(Value first, Value last) const;
-
-            // Add a new entry.
-            void addEntry(Value first, Value last, const UString& name);
-
-            // Get a name from a value, empty if not found.
-            UString getName(Value val) const;
+            // Get the entry for a value, null if not found.
+            const ConfigEntry* getEntry(Value val) const;
         };
 
         // Map of configuration sections, indexed by name.
         typedef std::map<UString, ConfigSection*> ConfigSectionMap;
 
+        // Parse the lines of a section, if not yet done.
+        void parseSection(ConfigSection* section) const;
+
         // Decode a line as "first[-last] = name". Return true on success, false on error.
-        bool decodeDefinition(const UString& line, ConfigSection* section);
+        bool decodeDefinition(size_t file, size_t line_number, const char* line, size_t size, ConfigSection* section) const;
+
+        // Report an error in a names file. Return false when there are too many errors.
+        bool configError(const UString& fileName, const UString& message) const;
+
+        // Give up after that number of errors.
+        static constexpr size_t MAX_CONFIG_ERRORS = 20;
+
+        // Get the name of an entry.
+        UString entryName(const ConfigEntry& entry) const;
 
         // Compute a number of hexa digits.
         static int HexaDigits(size_t bits);
@@ -257,10 +280,13 @@ namespace ts {
         static UString NormalizedSectionName(const UString& sectionName) { return sectionName.toTrimmed().toLower(); }
 
         // Names private fields.
-        Report&          _log;               // Error logger.
-        const UString    _configFile;        // Configuration file path.
-        size_t           _configErrors = 0;  // Number of errors in configuration file.
-        ConfigSectionMap _sections {};       // Configuration sections.
+        Report&                  _log;               // Error logger.
+        const UString            _configFile;        // Configuration file path.
+        mutable Mutex            _mutex {};          // Protect the parsing of sections.
+        mutable size_t           _configErrors = 0;  // Number of errors in configuration file.
+        ConfigSectionMap         _sections {};       // Configuration sections.
+        std::vector<std::string> _contents {};       // Content of all loaded files, UTF-8.
+        UStringVector            _fileNames {};      // Names of all loaded files, same index as _contents.
     };
 
     //!
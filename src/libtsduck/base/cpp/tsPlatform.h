@@ -547,6 +547,13 @@
     #define TS_NO_ARM_AES_INSTRUCTIONS
 #endif
 
+//!
+//! Define TS_NO_X86_AES_INSTRUCTIONS from the command line if you want to disable the usage of Intel/AMD AES-NI instructions.
+//!
+#if defined(DOXYGEN)
+    #define TS_NO_X86_AES_INSTRUCTIONS
+#endif
+
 //!
 //! Define TS_NO_ARM_SHA1_INSTRUCTIONS from the command line if you want to disable the usage of Arm64 SHA-1 instructions.
 //!
@@ -568,6 +575,13 @@
     #define TS_NO_ARM_SHA512_INSTRUCTIONS
 #endif
 
+//!
+//! Define TS_NO_X86_AVX2_INSTRUCTIONS from the command line if you want to disable the usage of Intel/AMD AVX2 instructions.
+//!
+#if defined(DOXYGEN)
+    #define TS_NO_X86_AVX2_INSTRUCTIONS
+#endif
+
 
 //----------------------------------------------------------------------------
 // Static linking.
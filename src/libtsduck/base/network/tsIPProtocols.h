@@ -68,6 +68,28 @@ namespace ts {
         IPv4_PROTO_SCTP     = 132,  //!< IPv4 protocol identifier for Stream Control Transmission Protocol (SCTP).
     };
 
+    //------------------------------------------------------------------------
+    // IPv6 protocol.
+    //------------------------------------------------------------------------
+
+    constexpr uint8_t IPv6_VERSION               =  6;   //!< Protocol version of IPv6.
+    constexpr size_t  IPv6_LENGTH_OFFSET         =  4;   //!< Offset of the payload length in an IPv6 header.
+    constexpr size_t  IPv6_NEXT_HEADER_OFFSET    =  6;   //!< Offset of the next header identifier in an IPv6 header.
+    constexpr size_t  IPv6_SRC_ADDR_OFFSET       =  8;   //!< Offset of source IP address in an IPv6 header.
+    constexpr size_t  IPv6_DEST_ADDR_OFFSET      = 24;   //!< Offset of destination IP address in an IPv6 header.
+    constexpr size_t  IPv6_HEADER_SIZE           = 40;   //!< Size of the fixed IPv6 header.
+    constexpr size_t  IPv6_ADDR_SIZE             = 16;   //!< Size in bytes of an IPv6 address.
+
+    //!
+    //! Selected IPv6 extension header identifiers.
+    //!
+    enum : uint8_t {
+        IPv6_EXT_HOP_BY_HOP = 0,   //!< IPv6 Hop-by-Hop options extension header.
+        IPv6_EXT_ROUTING    = 43,  //!< IPv6 Routing extension header.
+        IPv6_EXT_FRAGMENT   = 44,  //!< IPv6 Fragment extension header.
+        IPv6_EXT_DEST_OPT   = 60,  //!< IPv6 Destination options extension header.
+    };
+
     //!
     //! Get the name of an IP protocol (UDP, TCP, etc).
     //! @param [in] protocol Protocol identifier, as set in IP header.
@@ -94,6 +94,17 @@ namespace ts {
     constexpr SysSocketErrorCode SYS_SOCKET_ERR_NOTCONN = ENOTCONN;
 #endif
 
+    //!
+    //! System error code value meaning "operation would block" on a non-blocking socket.
+    //!
+#if defined(DOXYGEN)
+    constexpr SysSocketErrorCode SYS_SOCKET_ERR_WOULDBLOCK = platform_specific;
+#elif defined(TS_WINDOWS)
+    constexpr SysSocketErrorCode SYS_SOCKET_ERR_WOULDBLOCK = WSAEWOULDBLOCK;
+#elif defined(TS_UNIX)
+    constexpr SysSocketErrorCode SYS_SOCKET_ERR_WOULDBLOCK = EWOULDBLOCK;
+#endif
+
     //!
     //! Get the error code of the last socket system call.
     //! The validity of the returned value may depends on specific conditions.
@@ -12,6 +12,12 @@
 #include "tsIntegerUtils.h"
 #include "tsSysUtils.h"
 
+#if defined(TS_UNIX)
+    #include "tsBeforeStandardHeaders.h"
+    #include <sys/stat.h>
+    #include "tsAfterStandardHeaders.h"
+#endif
+
 
 //----------------------------------------------------------------------------
 // Constructors and destructors.
@@ -43,7 +49,7 @@ bool ts::PcapFile::error(Report& report, const UString& fmt, std::initializer_li
 
 bool ts::PcapFile::open(const UString& filename, Report& report)
 {
-    if (_in != nullptr) {
+    if (isOpen()) {
         report.error(u"already open");
         return false;
     }
@@ -67,6 +73,10 @@ bool ts::PcapFile::open(const UString& filename, Report& report)
         _in = &std::cin;
         _name = u"standard input";
     }
+    else if (mapFile(filename, report)) {
+        // The file is memory-mapped.
+        _name = filename;
+    }
     else {
         _file.open(filename.toUTF8().c_str(), std::ios::in | std::ios::binary);
         if (!_file) {
@@ -84,11 +94,46 @@ bool ts::PcapFile::open(const UString& filename, Report& report)
         return false;
     }
 
-    report.debug(u"opened %s, %s format version %d.%d, %s endian", {_name, _ng ? u"pcap-ng" : u"pcap", _major, _minor, _be ? u"big" : u"little"});
+    report.debug(u"opened %s, %s format version %d.%d, %s endian%s", {_name, _ng ? u"pcap-ng" : u"pcap", _major, _minor, _be ? u"big" : u"little", _map != nullptr ? u", memory-mapped" : u""});
     return true;
 }
 
 
+//----------------------------------------------------------------------------
+// Try to map a named file in memory.
+//----------------------------------------------------------------------------
+
+bool ts::PcapFile::mapFile(const UString& filename, Report& report)
+{
+#if defined(TS_UNIX)
+    // Only non-empty regular files can be mapped.
+    const int fd = ::open(filename.toUTF8().c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false; // error will be reported when opening as a stream
+    }
+    struct ::stat st;
+    void* addr = MAP_FAILED;
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 && uint64_t(st.st_size) <= uint64_t(std::numeric_limits<size_t>::max())) {
+        addr = ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        report.debug(u"cannot map %s in memory, reading it as a stream", {filename});
+        return false;
+    }
+
+    // The file is read sequentially, once.
+    ::madvise(addr, size_t(st.st_size), MADV_SEQUENTIAL);
+    _map = reinterpret_cast<const uint8_t*>(addr);
+    _map_size = size_t(st.st_size);
+    _map_next = 0;
+    return true;
+#else
+    return false;
+#endif
+}
+
+
 //----------------------------------------------------------------------------
 // Close the file.
 //----------------------------------------------------------------------------
@@ -99,6 +144,13 @@ void ts::PcapFile::close()
         _file.close();
     }
     _in = nullptr;
+#if defined(TS_UNIX)
+    if (_map != nullptr) {
+        ::munmap(const_cast<uint8_t*>(_map), _map_size);
+    }
+#endif
+    _map = nullptr;
+    _map_size = _map_next = 0;
 }
 
 
@@ -108,6 +160,15 @@ void ts::PcapFile::close()
 
 bool ts::PcapFile::readall(uint8_t* data, size_t size, Report& report)
 {
+    // Memory-mapped file: simply copy the data.
+    if (_map != nullptr) {
+        const uint8_t* addr = readInPlace(size, report);
+        if (addr != nullptr) {
+            std::memcpy(data, addr, size);
+        }
+        return addr != nullptr;
+    }
+
     // Repeatedly read until all requested bytes are read.
     while (size > 0) {
         // Read at most "size" bytes.
@@ -134,6 +195,34 @@ bool ts::PcapFile::readall(uint8_t* data, size_t size, Report& report)
 }
 
 
+//----------------------------------------------------------------------------
+// Read exactly "size" bytes, in place.
+//----------------------------------------------------------------------------
+
+const uint8_t* ts::PcapFile::readInPlace(size_t size, Report& report)
+{
+    if (_map != nullptr) {
+        // Memory-mapped file, no copy.
+        if (size > _map_size - _map_next) {
+            // Truncated file, consider it as an end of file.
+            _map_next = _map_size;
+            _file_size = _map_size;
+            error(report);
+            return nullptr;
+        }
+        const uint8_t* addr = _map + _map_next;
+        _map_next += size;
+        _file_size = _map_next;
+        return addr;
+    }
+    else {
+        // Read in the internal buffer. It is reused and no longer reallocated when large enough.
+        _buffer.resize(size);
+        return readall(_buffer.data(), size, report) ? _buffer.data() : nullptr;
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Read a file header, starting from a magic which was read as big endian.
 //----------------------------------------------------------------------------
@@ -163,15 +252,17 @@ bool ts::PcapFile::readHeader(uint32_t magic, Report& report)
         case PCAPNG_MAGIC: {
             // This is a pcap-ng file. Read the complete section header, compute endianness.
             _ng = true;
-            ByteBlock header;
-            if (!readNgBlockBody(magic, header, report)) {
+            const uint8_t* header = nullptr;
+            size_t header_size = 0;
+            if (!readNgBlockBody(magic, header, header_size, report)) {
                 return error(report);
             }
-            if (header.size() < 16) {
+            // The 'byte-order magic' is not included in the returned header.
+            if (header_size < 12) {
                 return error(report, u"invalid pcap-ng file, truncated section header in %s", {_name});
             }
-            _major = get16(header.data() + 4);
-            _minor = get16(header.data() + 6);
+            _major = get16(header);
+            _minor = get16(header + 2);
             _if.clear(); // will read interface descriptions in dedicated blocks.
             break;
         }
@@ -242,9 +333,10 @@ bool ts::PcapFile::analyzeNgInterface(const uint8_t* data, size_t size, Report&
 // Read a pcap-ng block. The 32-bit block type has already been read.
 //----------------------------------------------------------------------------
 
-bool ts::PcapFile::readNgBlockBody(uint32_t block_type, ByteBlock& body, Report& report)
+bool ts::PcapFile::readNgBlockBody(uint32_t block_type, const uint8_t*& body, size_t& body_size, Report& report)
 {
-    body.clear();
+    body = nullptr;
+    body_size = 0;
 
     // Read the first "Block Total Length" field.
     uint8_t lenfield[4];
@@ -253,45 +345,46 @@ bool ts::PcapFile::readNgBlockBody(uint32_t block_type, ByteBlock& body, Report&
     }
 
     // If the block type is Section Header, then the endianness is given by the first 4 bytes.
+    size_t header_size = 12;
     if (block_type == PCAPNG_SECTION_HEADER) {
         // Pcap-ng files have an endian-neutral block-type value for section header.
         // The byte order is defined by the 'byte-order magic' at the beginning of the section header block body.
-        body.resize(4);
-        if (!readall(body.data(), body.size(), report)) {
-            body.clear();
+        uint8_t order[4];
+        if (!readall(order, sizeof(order), report)) {
             return error(report);
         }
-        const uint32_t order_magic = GetUInt32BE(body.data());
+        const uint32_t order_magic = GetUInt32BE(order);
         if (order_magic != PCAPNG_ORDER_BE && order_magic != PCAPNG_ORDER_LE) {
-            body.clear();
             return error(report, u"invalid pcap-ng file, unknown 'byte-order magic' 0x%X in %s", {order_magic, _name});
         }
         _be = order_magic == PCAPNG_ORDER_BE;
+        header_size += sizeof(order);
     }
 
     // Interpret the packet size. The packet size include 12 additional bytes
     // for the block type and the two block length fields.
     const size_t size = get32(lenfield);
-    if (size % 4 != 0 || size < 12 + body.size()) {
-        body.clear();
+    if (size % 4 != 0 || size < header_size) {
         return error(report, u"invalid pcap-ng block length %d in %s", {size, _name});
     }
 
     // Read the rest of the block body.
-    const size_t start = body.size();
-    body.resize(size - 12);
-    if (!readall(body.data() + start, body.size() - start, report)) {
-        body.clear();
+    body = readInPlace(size - header_size, report);
+    if (body == nullptr) {
         return error(report);
     }
+    body_size = size - header_size;
 
     // Read and check the last "Block Total Length" field.
     if (!readall(lenfield, sizeof(lenfield), report)) {
+        body = nullptr;
+        body_size = 0;
         return error(report);
     }
     const size_t last_size = get32(lenfield);
     if (size != last_size) {
-        body.clear();
+        body = nullptr;
+        body_size = 0;
         return error(report, u"inconsistent pcap-ng block length in %s, leading length: %d, trailing length: %d", {_name, size, last_size});
     }
     return true;
@@ -299,32 +392,29 @@ bool ts::PcapFile::readNgBlockBody(uint32_t block_type, ByteBlock& body, Report&
 
 
 //----------------------------------------------------------------------------
-// Read the next IPv4 packet (headers included).
+// Read the next captured packet (link-layer frame), in place.
 //----------------------------------------------------------------------------
 
-bool ts::PcapFile::readIPv4(IPv4Packet& packet, MicroSecond& timestamp, Report& report)
+bool ts::PcapFile::readCapture(const uint8_t*& data, size_t& size, InterfaceDesc& ifd, MicroSecond& timestamp, Report& report)
 {
-    // Clear output values.
-    packet.clear();
-    timestamp = -1;
-
     // Check that the file is open.
-    if (_in == nullptr) {
+    if (!isOpen()) {
         report.error(u"no pcap file open");
         return false;
     }
     if (_error) {
-        if (!_in->eof()) {
+        if (!atEOF()) {
             report.debug(u"pcap file already in error state");
         }
         return false;
     }
 
-    // Loop on file blocks until an IPv4 packet is found.
+    // Loop on file blocks until a captured packet is found.
     for (;;) {
 
         // The captured packet will go there.
-        ByteBlock buffer;
+        const uint8_t* buffer = nullptr;
+        size_t buffer_size = 0;
         size_t cap_start = 0;  // captured packet start index in buffer
         size_t cap_size = 0;   // captured packet size
         size_t orig_size = 0;  // original packet size (on network)
@@ -347,25 +437,25 @@ bool ts::PcapFile::readIPv4(IPv4Packet& packet, MicroSecond& timestamp, Report&
                 continue; // loop to next packet block
             }
             // Read one data block.
-            if (!readNgBlockBody(type, buffer, report)) {
+            if (!readNgBlockBody(type, buffer, buffer_size, report)) {
                 return error(report);
             }
             if (type == PCAPNG_INTERFACE_DESC) {
                 // Process an interface description.
-                if (!analyzeNgInterface(buffer.data(), buffer.size(), report)) {
+                if (!analyzeNgInterface(buffer, buffer_size, report)) {
                     return error(report);
                 }
                 continue; // loop to next packet block
             }
-            else if ((type == PCAPNG_ENHANCED_PACKET || type == PCAPNG_OBSOLETE_PACKET) && buffer.size() >= 20) {
+            else if ((type == PCAPNG_ENHANCED_PACKET || type == PCAPNG_OBSOLETE_PACKET) && buffer_size >= 20) {
                 _packet_count++;
                 cap_start = 20;
-                cap_size = std::min<size_t>(get32(buffer.data() + 12), buffer.size() - 20);
-                orig_size = get32(buffer.data() + 16);
-                if_index = type == PCAPNG_OBSOLETE_PACKET ? get16(buffer.data()) : get32(buffer.data());
+                cap_size = std::min<size_t>(get32(buffer + 12), buffer_size - 20);
+                orig_size = get32(buffer + 16);
+                if_index = type == PCAPNG_OBSOLETE_PACKET ? get16(buffer) : get32(buffer);
                 if (if_index < _if.size() && _if[if_index].time_units != 0) {
                     const SubSecond units = _if[if_index].time_units;
-                    const SubSecond tstamp = SubSecond(uint64_t(get32(buffer.data() + 4)) << 32) + SubSecond(get32(buffer.data() + 8));
+                    const SubSecond tstamp = SubSecond(uint64_t(get32(buffer + 4)) << 32) + SubSecond(get32(buffer + 8));
                     // Take care to overflow in tstamp * MilliSecPerSec. Sometimes, the timestamp is a full time
                     // since 1970 with time unit being 1,000,000,000. The value is close to the 64-bit max.
                     if (units == MicroSecPerSec) {
@@ -385,11 +475,11 @@ bool ts::PcapFile::readIPv4(IPv4Packet& packet, MicroSecond& timestamp, Report&
                     }
                 }
             }
-            else if (type == PCAPNG_SIMPLE_PACKET && buffer.size() >= 4) {
+            else if (type == PCAPNG_SIMPLE_PACKET && buffer_size >= 4) {
                 _packet_count++;
                 cap_start = 4;
-                orig_size = get32(buffer.data());
-                cap_size = std::min(orig_size, buffer.size() - 4);
+                orig_size = get32(buffer);
+                cap_size = std::min(orig_size, buffer_size - 4);
             }
             else {
                 // This data block does not contain a captured packet, ignore it.
@@ -398,11 +488,11 @@ bool ts::PcapFile::readIPv4(IPv4Packet& packet, MicroSecond& timestamp, Report&
         }
         else {
             // Pcap file, beginning of a packet block. Read the 16-byte header.
-            _packet_count++;
             uint8_t header[16];
             if (!readall(header, sizeof(header), report)) {
                 return error(report);
             }
+            _packet_count++;
             const uint32_t tstamp = get32(header);
             const uint32_t sub_tstamp = get32(header + 4);
             cap_size = get32(header + 8);
@@ -412,8 +502,9 @@ bool ts::PcapFile::readIPv4(IPv4Packet& packet, MicroSecond& timestamp, Report&
             timestamp = (MicroSecond(tstamp) * MicroSecPerSec) + (SubSecond(sub_tstamp) * MicroSecPerSec) / _if[0].time_units;
 
             // Read packet data.
-            buffer.resize(cap_size);
-            if (!readall(buffer.data(), buffer.size(), report)) {
+            buffer_size = cap_size;
+            buffer = readInPlace(buffer_size, report);
+            if (buffer == nullptr) {
                 return error(report);
             }
         }
@@ -426,10 +517,7 @@ bool ts::PcapFile::readIPv4(IPv4Packet& packet, MicroSecond& timestamp, Report&
         }
 
         // Get link type, adjust timestamp.
-        InterfaceDesc ifd;
-        if (if_index < _if.size()) {
-            ifd = _if[if_index];
-        }
+        ifd = if_index < _if.size() ? _if[if_index] : InterfaceDesc();
         if (timestamp >= 0) {
             timestamp += ifd.time_offset;
             if (_first_timestamp < 0) {
@@ -439,46 +527,94 @@ bool ts::PcapFile::readIPv4(IPv4Packet& packet, MicroSecond& timestamp, Report&
         }
 
         report.log(2, u"pcap data block: %d bytes, captured packet at offset %d, %d bytes (original: %d bytes), link type: %d",
-                   {buffer.size(), cap_start, cap_size, orig_size, ifd.link_type});
+                   {buffer_size, cap_start, cap_size, orig_size, ifd.link_type});
+
+        data = buffer + cap_start;
+        size = cap_size;
+        return true;
+    }
+}
 
-        // Analyze the captured packet, trying to find an IPv4 datagram.
-        if (ifd.link_type == LINKTYPE_NULL && cap_size > 4 && get32(buffer.data() + cap_start) == 2) {
-            // BSD loopback encapsulation; the link layer header is a 4-byte field, in host byte order, containing 2 for IPv4 packets.
-            cap_start += 4;
-            cap_size -= 4;
+
+//----------------------------------------------------------------------------
+// Read the next IPv4 or IPv6 packet (headers included), without copy.
+//----------------------------------------------------------------------------
+
+bool ts::PcapFile::readIP(const uint8_t*& data, size_t& size, MicroSecond& timestamp, Report& report)
+{
+    // Loop on captured packets until an IP packet is found.
+    for (;;) {
+        InterfaceDesc ifd;
+        if (!readCapture(data, size, ifd, timestamp, report)) {
+            return false;
         }
-        else if (ifd.link_type == LINKTYPE_LOOP && cap_size > 4 && GetUInt32BE(buffer.data() + cap_start) == 2) {
-            // OpenBSD loopback encapsulation; the link-layer header is a 4-byte field, in network byte order, containing 2 for IPv4 packets/
-            cap_start += 4;
-            cap_size -= 4;
+
+        // Analyze the link layer, trying to find an IPv4 or IPv6 datagram.
+        // With BSD and OpenBSD loopback encapsulations, the link layer header is a 4-byte field containing
+        // the address family: 2 for IPv4, 24, 28 or 30 for IPv6 (depending on the operating system).
+        const uint32_t family = size > 4 ? (ifd.link_type == LINKTYPE_NULL ? get32(data) : GetUInt32BE(data)) : 0;
+        uint16_t ether_type = 0;
+        if ((ifd.link_type == LINKTYPE_NULL || ifd.link_type == LINKTYPE_LOOP) && (family == 2 || family == 24 || family == 28 || family == 30)) {
+            // BSD loopback encapsulation (host byte order) or OpenBSD loopback encapsulation (network byte order).
+            data += 4;
+            size -= 4;
         }
         else if ((ifd.link_type == LINKTYPE_ETHERNET || ifd.link_type == LINKTYPE_NULL || ifd.link_type == LINKTYPE_LOOP) &&
-                 cap_size > ETHER_HEADER_SIZE + ifd.fcs_size && GetUInt16BE(buffer.data() + cap_start + ETHER_TYPE_OFFSET) == ETHERTYPE_IPv4)
+                 size > ETHER_HEADER_SIZE + ifd.fcs_size &&
+                 ((ether_type = GetUInt16BE(data + ETHER_TYPE_OFFSET)) == ETHERTYPE_IPv4 || ether_type == ETHERTYPE_IPv6 || ether_type == ETHERTYPE_802_1Q))
         {
-            // Ethernet frame: 14-byte header: destination MAC (6 bytes), source MAC (6 bytes), ether type (2 bytes, 0x0800 for IPv4).
+            // Ethernet frame: 14-byte header: destination MAC (6 bytes), source MAC (6 bytes), ether type (2 bytes).
             // This should apply to LINKTYPE_ETHERNET only. However, in some pcap files (not pcap-ng), it has been noticed that
             // LINKTYPE_NULL and LINKTYPE_LOOP can contain a raw Ethernet frame without the initial 4 bytes of encapsulation.
-            cap_start += ETHER_HEADER_SIZE;
-            cap_size -= ETHER_HEADER_SIZE + ifd.fcs_size;
+            data += ETHER_HEADER_SIZE;
+            size -= ETHER_HEADER_SIZE + ifd.fcs_size;
+            // With a 802.1Q tag (VLAN), the real ether type follows a 2-byte tag.
+            if (ether_type == ETHERTYPE_802_1Q) {
+                if (size < 4 || ((ether_type = GetUInt16BE(data + 2)) != ETHERTYPE_IPv4 && ether_type != ETHERTYPE_IPv6)) {
+                    continue; // not an IP packet
+                }
+                data += 4;
+                size -= 4;
+            }
         }
-        else if (ifd.link_type == LINKTYPE_RAW && cap_size >= IPv4_MIN_HEADER_SIZE && (buffer[cap_start] >> 4) == 4) {
-            // Raw IPv4 or IPv6 header (version in first byte), no encopsulation.
+        else if (ifd.link_type != LINKTYPE_RAW) {
+            // Not an identified IP packet.
+            continue;
         }
-        else {
-            // Not an identified IPv4 packet.
-            cap_size = 0;
+
+        // Raw IPv4 or IPv6 header (version in first byte).
+        const uint8_t version = size > 0 ? (data[0] >> 4) : 0;
+        if ((version == IPv4_VERSION && size >= IPv4_MIN_HEADER_SIZE) || (version == IPv6_VERSION && size >= IPv6_HEADER_SIZE)) {
+            return true;
         }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Read the next IPv4 packet (headers included).
+//----------------------------------------------------------------------------
 
-        // A possible IPv4 datagram was found.
-        if (cap_size > 0) {
-            if (packet.reset(buffer.data() + cap_start, cap_size)) {
+bool ts::PcapFile::readIPv4(IPv4Packet& packet, MicroSecond& timestamp, Report& report)
+{
+    // Clear output values.
+    packet.clear();
+    timestamp = -1;
+
+    // Loop on IP packets until an IPv4 packet is found.
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    while (readIP(data, size, timestamp, report)) {
+        if ((data[0] >> 4) == IPv4_VERSION) {
+            if (packet.reset(data, size)) {
                 _ipv4_packet_count++;
-                _ipv4_packets_size += cap_size;
+                _ipv4_packets_size += size;
                 return true;
             }
             else {
-                report.warning(u"invalid IPv4 datagram in pcap file, %d bytes (original: %d bytes), link type: %d", {cap_size, orig_size, ifd.link_type});
+                report.warning(u"invalid IPv4 datagram in pcap file, %d bytes", {size});
             }
         }
     }
+    return false;
 }
@@ -24,9 +24,14 @@ namespace ts {
     //! @ingroup net
     //!
     //! This is the type of files which is created by Wireshark.
-    //! This class reads a pcap or pcapng file and extracts IPv4 frames.
+    //! This class reads a pcap or pcapng file and extracts IPv4 or IPv6 frames.
     //! All metadata and all other types of frames are ignored.
     //!
+    //! On UNIX systems, a named regular file is memory-mapped and the captured packets
+    //! are accessed in place, without copy and without intermediate allocation. On other
+    //! systems or with the standard input, the captured packets are read in an internal
+    //! buffer which is reused from one packet to another.
+    //!
     //! @see https://tools.ietf.org/pdf/draft-gharris-opsawg-pcap-02.pdf (PCAP)
     //! @see https://datatracker.ietf.org/doc/draft-gharris-opsawg-pcap/ (PCAP tracker)
     //! @see https://tools.ietf.org/pdf/draft-tuexen-opsawg-pcapng-04.pdf (PCAP-ng)
@@ -58,7 +63,14 @@ namespace ts {
         //! Check if the file is open.
         //! @return True if the file is open, false otherwise.
         //!
-        bool isOpen() const { return _in != nullptr; }
+        bool isOpen() const { return _in != nullptr || _map != nullptr; }
+
+        //!
+        //! Check if the file is memory-mapped.
+        //! @return True if the file is memory-mapped. In that case, the data which are returned
+        //! by readIP() remain valid until the file is closed.
+        //!
+        bool isMapped() const { return _map != nullptr; }
 
         //!
         //! Get the file name.
@@ -78,6 +90,21 @@ namespace ts {
         //!
         virtual bool readIPv4(IPv4Packet& packet, MicroSecond& timestamp, Report& report);
 
+        //!
+        //! Read the next IPv4 or IPv6 packet (headers included), without copy.
+        //! Skip intermediate metadata and other types of packets.
+        //! The packet is not validated, except for the IP version.
+        //!
+        //! @param [out] data Address of the IP packet. If the file is memory-mapped, this is
+        //! an address in the mapped file which remains valid until the file is closed. Otherwise,
+        //! this is an address in an internal buffer which remains valid until the next read.
+        //! @param [out] size Size in bytes of the IP packet, without link-layer trailer.
+        //! @param [out] timestamp Capture timestamp in microseconds since Unix epoch or -1 if none is available.
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error or end of file.
+        //!
+        bool readIP(const uint8_t*& data, size_t& size, MicroSecond& timestamp, Report& report);
+
         //!
         //! Get the number of captured packets so far.
         //! This includes all packets, not only IPv4 packets.
@@ -163,29 +190,45 @@ namespace ts {
             MicroSecond time_offset = 0;  // Offset to add to all time stamps.
         };
 
-        bool          _error = false;          // Error was set, may be logical error, not a file error.
-        std::istream* _in = nullptr;           // Point to actual input stream.
-        std::ifstream _file {};                // Input file (when it is a named file).
-        UString       _name {};                // Saved file name for messages.
-        bool          _be = false;             // The file use a big-endian representation.
-        bool          _ng = false;             // Pcapng format (not pcap).
-        uint16_t      _major = 0;              // File format major version.
-        uint16_t      _minor = 0;              // File format minor version.
-        uint64_t      _file_size = 0;          // Number of bytes read so far.
-        uint64_t      _packet_count = 0;       // Count of captured packets.
-        uint64_t      _ipv4_packet_count = 0;  // Count of captured IPv4 packets.
-        uint64_t      _packets_size = 0;       // Total size in bytes of captured packets.
-        uint64_t      _ipv4_packets_size = 0;  // Total size in bytes of captured IPv4 packets.
-        MicroSecond   _first_timestamp {-1};   // Timestamp of first packet in file.
-        MicroSecond   _last_timestamp {-1};    // Timestamp of last packet in file.
-        std::vector<InterfaceDesc> _if {};     // Capture interfaces by index, only one in pcap files.
+        bool           _error = false;          // Error was set, may be logical error, not a file error.
+        std::istream*  _in = nullptr;           // Point to actual input stream.
+        std::ifstream  _file {};                // Input file (when it is a named file).
+        const uint8_t* _map = nullptr;          // Memory-mapped file content (instead of _in).
+        size_t         _map_size = 0;           // Size of the memory-mapped file.
+        size_t         _map_next = 0;           // Index of next byte to read in _map.
+        ByteBlock      _buffer {};              // Buffer for data blocks when the file is not memory-mapped.
+        UString        _name {};                // Saved file name for messages.
+        bool           _be = false;             // The file use a big-endian representation.
+        bool           _ng = false;             // Pcapng format (not pcap).
+        uint16_t       _major = 0;              // File format major version.
+        uint16_t       _minor = 0;              // File format minor version.
+        uint64_t       _file_size = 0;          // Number of bytes read so far.
+        uint64_t       _packet_count = 0;       // Count of captured packets.
+        uint64_t       _ipv4_packet_count = 0;  // Count of captured IPv4 packets.
+        uint64_t       _packets_size = 0;       // Total size in bytes of captured packets.
+        uint64_t       _ipv4_packets_size = 0;  // Total size in bytes of captured IPv4 packets.
+        MicroSecond    _first_timestamp {-1};   // Timestamp of first packet in file.
+        MicroSecond    _last_timestamp {-1};    // Timestamp of last packet in file.
+        std::vector<InterfaceDesc> _if {};       // Capture interfaces by index, only one in pcap files.
 
         // Report an error (if fmt is not empty), set error indicator, return false.
         bool error(Report& report, const UString& fmt = UString(), std::initializer_list<ArgMixIn> args = {});
 
+        // Try to map a named file in memory. Return false if not possible, the file shall be read as a stream.
+        bool mapFile(const UString& filename, Report& report);
+
+        // Check if the end of file is reached.
+        bool atEOF() const { return _map != nullptr ? _map_next >= _map_size : _in == nullptr || _in->eof(); }
+
         // Read exactly "size" bytes. Return false if not enough bytes before eof.
         bool readall(uint8_t* data, size_t size, Report& report);
 
+        // Read exactly "size" bytes, in place in the mapped file or in _buffer. Return null if not enough bytes before eof.
+        const uint8_t* readInPlace(size_t size, Report& report);
+
+        // Read the next captured packet (link-layer frame), in place.
+        bool readCapture(const uint8_t*& data, size_t& size, InterfaceDesc& ifd, MicroSecond& timestamp, Report& report);
+
         // Read a file / section header, starting from a magic number which was read as big endian.
         bool readHeader(uint32_t magic, Report& report);
 
@@ -194,8 +237,9 @@ namespace ts {
 
         // Read a pcap-ng block. The 32-bit block type has already been read.
         // Start at "Block total length". Read complete block, including the two length fields.
-        // Return only the block body.
-        bool readNgBlockBody(uint32_t block_type, ByteBlock& body, Report& report);
+        // Return only the block body, in place. For a section header, the 'byte-order magic'
+        // is not included in the returned body.
+        bool readNgBlockBody(uint32_t block_type, const uint8_t*& body, size_t& body_size, Report& report);
 
         // Read 32 or 16 bits using the endianness.
         uint16_t get16(const void* addr) const { return _be ? GetUInt16BE(addr) : GetUInt16LE(addr); }
@@ -98,22 +98,26 @@ void ts::PcapFilter::setProtocolFilterTCP()
 {
     _protocols.clear();
     _protocols.insert(IPv4_PROTO_TCP);
+    compileFilters();
 }
 
 void ts::PcapFilter::setProtocolFilterUDP()
 {
     _protocols.clear();
     _protocols.insert(IPv4_PROTO_UDP);
+    compileFilters();
 }
 
 void ts::PcapFilter::setProtocolFilter(const std::set<uint8_t>& protocols)
 {
     _protocols = protocols;
+    compileFilters();
 }
 
 void ts::PcapFilter::clearProtocolFilter()
 {
     _protocols.clear();
+    compileFilters();
 }
 
 
@@ -125,12 +129,14 @@ void ts::PcapFilter::setSourceFilter(const IPv4SocketAddress& addr)
 {
     _source = addr;
     _bidirectional_filter = false;
+    compileFilters();
 }
 
 void ts::PcapFilter::setDestinationFilter(const IPv4SocketAddress& addr)
 {
     _destination = addr;
     _bidirectional_filter = false;
+    compileFilters();
 }
 
 void ts::PcapFilter::setBidirectionalFilter(const IPv4SocketAddress& addr1, const IPv4SocketAddress& addr2)
@@ -138,6 +144,7 @@ void ts::PcapFilter::setBidirectionalFilter(const IPv4SocketAddress& addr1, cons
     _source = addr1;
     _destination = addr2;
     _bidirectional_filter = true;
+    compileFilters();
 }
 
 void ts::PcapFilter::setWildcardFilter(bool on)
@@ -189,11 +196,49 @@ bool ts::PcapFilter::open(const UString& filename, Report& report)
         _last_time_offset = _opt_last_time_offset;
         _first_time = _opt_first_time;
         _last_time = _opt_last_time;
+        compileFilters();
     }
     return ok;
 }
 
 
+//----------------------------------------------------------------------------
+// Recompute the precompiled filters.
+//----------------------------------------------------------------------------
+
+void ts::PcapFilter::compileFilters()
+{
+    if (_protocols.empty()) {
+        _protocol_mask.set();
+    }
+    else {
+        _protocol_mask.reset();
+        for (auto proto : _protocols) {
+            _protocol_mask.set(proto);
+        }
+    }
+    _source_tuple.addr = _source.address();
+    _source_tuple.port = _source.port();
+    _destination_tuple.addr = _destination.address();
+    _destination_tuple.port = _destination.port();
+}
+
+
+//----------------------------------------------------------------------------
+// Check packet number and timestamp against the first and last filters.
+//----------------------------------------------------------------------------
+
+bool ts::PcapFilter::afterLast(MicroSecond timestamp) const
+{
+    return packetCount() > _last_packet || timestamp > _last_time || timeOffset(timestamp) > _last_time_offset;
+}
+
+bool ts::PcapFilter::beforeFirst(MicroSecond timestamp) const
+{
+    return packetCount() < _first_packet || timestamp < _first_time || timeOffset(timestamp) < _first_time_offset;
+}
+
+
 //----------------------------------------------------------------------------
 // Read an IPv4 packet, inherited method.
 //----------------------------------------------------------------------------
@@ -208,19 +253,12 @@ bool ts::PcapFilter::readIPv4(IPv4Packet& packet, MicroSecond& timestamp, Report
         }
 
         // Check final conditions (no need to read further in the file).
-        if (packetCount() > _last_packet ||
-            timestamp > _last_time ||
-            timeOffset(timestamp) > _last_time_offset)
-        {
+        if (afterLast(timestamp)) {
             return false;
         }
 
         // Check if the packet matches all general filters.
-        if ((!_protocols.empty() && !Contains(_protocols, packet.protocol())) ||
-            packetCount() < _first_packet ||
-            timestamp < _first_time ||
-            timeOffset(timestamp) < _first_time_offset)
-        {
+        if (!_protocol_mask.test(packet.protocol()) || beforeFirst(timestamp)) {
             // Drop that packet.
             continue;
         }
@@ -237,6 +275,7 @@ bool ts::PcapFilter::readIPv4(IPv4Packet& packet, MicroSecond& timestamp, Report
             if (unspecified) {
                 _source = src;
                 _destination = dst;
+                compileFilters();
                 display_filter = true;
             }
         }
@@ -244,6 +283,7 @@ bool ts::PcapFilter::readIPv4(IPv4Packet& packet, MicroSecond& timestamp, Report
             if (unspecified) {
                 _source = dst;
                 _destination = src;
+                compileFilters();
                 display_filter = true;
             }
         }
@@ -260,3 +300,118 @@ bool ts::PcapFilter::readIPv4(IPv4Packet& packet, MicroSecond& timestamp, Report
         return true;
     }
 }
+
+
+//----------------------------------------------------------------------------
+// Read the next UDP datagrams which match all filters.
+//----------------------------------------------------------------------------
+
+size_t ts::PcapFilter::readUDP(UDPDatagram* datagrams, size_t max_count, Report& report)
+{
+    // Without memory mapping, the data of a datagram are overwritten by the next read.
+    if (!isMapped()) {
+        max_count = std::min<size_t>(max_count, 1);
+    }
+
+    const bool unspecified = !_wildcard_filter && !addressFilterIsSet();
+    const bool ipv6_allowed = !_source.hasAddress() && !_destination.hasAddress();
+    const uint8_t* ip = nullptr;
+    size_t ip_size = 0;
+    MicroSecond timestamp = -1;
+    size_t count = 0;
+
+    while (count < max_count && readIP(ip, ip_size, timestamp, report)) {
+
+        // Check final conditions (no need to read further in the file) and general filters.
+        if (afterLast(timestamp)) {
+            break;
+        }
+        if (!_protocol_mask.test(IPv4_PROTO_UDP) || beforeFirst(timestamp)) {
+            continue;
+        }
+
+        // Locate the UDP header in the IP datagram.
+        size_t udp_start = 0;
+        const bool ipv6 = (ip[0] >> 4) == IPv6_VERSION;
+        if (ipv6) {
+            if (!ipv6_allowed) {
+                continue;
+            }
+            // A null payload length is a jumbogram, keep the captured size.
+            const size_t payload_size = GetUInt16BE(ip + IPv6_LENGTH_OFFSET);
+            if (payload_size > 0) {
+                ip_size = std::min(ip_size, IPv6_HEADER_SIZE + payload_size);
+            }
+            // Skip extension headers. Fragments are not reassembled.
+            uint8_t next = ip[IPv6_NEXT_HEADER_OFFSET];
+            udp_start = IPv6_HEADER_SIZE;
+            while ((next == IPv6_EXT_HOP_BY_HOP || next == IPv6_EXT_ROUTING || next == IPv6_EXT_DEST_OPT) && udp_start + 8 <= ip_size) {
+                next = ip[udp_start];
+                udp_start += 8 * (size_t(ip[udp_start + 1]) + 1);
+            }
+            if (next != IPv4_PROTO_UDP) {
+                continue;
+            }
+        }
+        else {
+            udp_start = IPv4Packet::IPHeaderSize(ip, ip_size);
+            if (udp_start == 0 || !IPv4Packet::VerifyIPHeaderChecksum(ip, udp_start) || ip[IPv4_PROTOCOL_OFFSET] != IPv4_PROTO_UDP) {
+                continue;
+            }
+            ip_size = std::min<size_t>(ip_size, GetUInt16BE(ip + IPv4_LENGTH_OFFSET));
+            // Fragments are not reassembled: "More Fragments" bit set or "Fragment Offset" not zero.
+            if ((GetUInt16BE(ip + IPv4_FRAGMENT_OFFSET) & 0x3FFF) != 0) {
+                continue;
+            }
+        }
+
+        // Check the UDP header.
+        if (udp_start + UDP_HEADER_SIZE > ip_size) {
+            continue;
+        }
+        const uint8_t* udp = ip + udp_start;
+        const size_t udp_size = GetUInt16BE(udp + UDP_LENGTH_OFFSET);
+        if (udp_size < UDP_HEADER_SIZE || udp_size > ip_size - udp_start) {
+            continue;
+        }
+
+        // Check the address filters. By default, the tuples are empty and match everything.
+        const uint16_t src_port = GetUInt16BE(udp + UDP_SRC_PORT_OFFSET);
+        const uint16_t dst_port = GetUInt16BE(udp + UDP_DEST_PORT_OFFSET);
+        const uint32_t src_addr = ipv6 ? 0 : GetUInt32BE(ip + IPv4_SRC_ADDR_OFFSET);
+        const uint32_t dst_addr = ipv6 ? 0 : GetUInt32BE(ip + IPv4_DEST_ADDR_OFFSET);
+        if (_source_tuple.match(src_addr, src_port) && _destination_tuple.match(dst_addr, dst_port)) {
+            if (unspecified && !ipv6) {
+                _source = IPv4SocketAddress(src_addr, src_port);
+                _destination = IPv4SocketAddress(dst_addr, dst_port);
+                compileFilters();
+                report.log(_display_addresses_severity, u"selected stream %s %s %s", {_source, _bidirectional_filter ? u"<->" : u"->", _destination});
+            }
+        }
+        else if (_bidirectional_filter && _source_tuple.match(dst_addr, dst_port) && _destination_tuple.match(src_addr, src_port)) {
+            if (unspecified && !ipv6) {
+                _source = IPv4SocketAddress(dst_addr, dst_port);
+                _destination = IPv4SocketAddress(src_addr, src_port);
+                compileFilters();
+                report.log(_display_addresses_severity, u"selected stream %s %s %s", {_source, _bidirectional_filter ? u"<->" : u"->", _destination});
+            }
+        }
+        else {
+            continue;
+        }
+
+        // The datagram is selected.
+        UDPDatagram& dg(datagrams[count++]);
+        dg.timestamp = timestamp;
+        dg.ip_header = ip;
+        dg.udp_header = udp;
+        dg.data = udp + UDP_HEADER_SIZE;
+        dg.size = udp_size - UDP_HEADER_SIZE;
+
+        // The filter is now locked on one stream, end the batch here.
+        if (unspecified && !ipv6) {
+            break;
+        }
+    }
+    return count;
+}
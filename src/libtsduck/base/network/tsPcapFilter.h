@@ -13,6 +13,7 @@
 
 #pragma once
 #include "tsPcapFile.h"
+#include "tsIPv6SocketAddress.h"
 
 namespace ts {
 
@@ -31,6 +32,64 @@ namespace ts {
     {
         TS_NOCOPY(PcapFilter);
     public:
+        //!
+        //! Description of a UDP datagram which is extracted from the file, without copy.
+        //!
+        //! The addresses point inside the file data. With a memory-mapped file, they remain
+        //! valid until the file is closed. Otherwise, they remain valid until the next read.
+        //!
+        class TSDUCKDLL UDPDatagram
+        {
+        public:
+            MicroSecond    timestamp = -1;       //!< Capture timestamp in microseconds, negative if unknown.
+            const uint8_t* ip_header = nullptr;  //!< Address of the IPv4 or IPv6 header.
+            const uint8_t* udp_header = nullptr; //!< Address of the UDP header.
+            const uint8_t* data = nullptr;       //!< Address of the UDP payload.
+            size_t         size = 0;             //!< Size in bytes of the UDP payload.
+
+            //!
+            //! Check if the datagram is an IPv6 one.
+            //! @return True for an IPv6 datagram, false for an IPv4 one.
+            //!
+            bool isIPv6() const { return ip_header != nullptr && (ip_header[0] >> 4) == IPv6_VERSION; }
+
+            //!
+            //! Get the source UDP port.
+            //! @return The source UDP port.
+            //!
+            uint16_t sourcePort() const { return GetUInt16BE(udp_header + UDP_SRC_PORT_OFFSET); }
+
+            //!
+            //! Get the destination UDP port.
+            //! @return The destination UDP port.
+            //!
+            uint16_t destinationPort() const { return GetUInt16BE(udp_header + UDP_DEST_PORT_OFFSET); }
+
+            //!
+            //! Get the source socket address of an IPv4 datagram.
+            //! @return The source socket address.
+            //!
+            IPv4SocketAddress sourceIPv4() const { return IPv4SocketAddress(GetUInt32BE(ip_header + IPv4_SRC_ADDR_OFFSET), sourcePort()); }
+
+            //!
+            //! Get the destination socket address of an IPv4 datagram.
+            //! @return The destination socket address.
+            //!
+            IPv4SocketAddress destinationIPv4() const { return IPv4SocketAddress(GetUInt32BE(ip_header + IPv4_DEST_ADDR_OFFSET), destinationPort()); }
+
+            //!
+            //! Get the source socket address of an IPv6 datagram.
+            //! @return The source socket address.
+            //!
+            IPv6SocketAddress sourceIPv6() const { return IPv6SocketAddress(ip_header + IPv6_SRC_ADDR_OFFSET, IPv6_ADDR_SIZE, sourcePort()); }
+
+            //!
+            //! Get the destination socket address of an IPv6 datagram.
+            //! @return The destination socket address.
+            //!
+            IPv6SocketAddress destinationIPv6() const { return IPv6SocketAddress(ip_header + IPv6_DEST_ADDR_OFFSET, IPv6_ADDR_SIZE, destinationPort()); }
+        };
+
         //!
         //! Default constructor.
         //!
@@ -216,14 +275,44 @@ namespace ts {
         //!
         bool loadArgs(DuckContext& duck, Args& args);
 
+        //!
+        //! Read the next UDP datagrams which match all filters, IPv4 or IPv6.
+        //!
+        //! The datagrams are not copied. With a memory-mapped file, several datagrams are returned
+        //! at once and their data remain valid until the file is closed. Otherwise, at most one
+        //! datagram is returned and its data remain valid until the next read.
+        //!
+        //! IPv4 fragments are ignored (no reassembly). Since the address filters are IPv4 socket
+        //! addresses, IPv6 datagrams are returned only when the address filters contain no IP
+        //! address. In that case, the ports of the filters still apply. In non-wildcard mode,
+        //! the filters are locked on the first IPv4 datagram only.
+        //!
+        //! @param [out] datagrams Address of an array of datagram descriptions.
+        //! @param [in] max_count Maximum number of datagrams to return.
+        //! @param [in,out] report Where to report errors.
+        //! @return Number of returned datagrams. Zero on end of file or error.
+        //!
+        size_t readUDP(UDPDatagram* datagrams, size_t max_count, Report& report);
+
         // Inherited methods.
         virtual bool open(const UString& filename, Report& report) override;
         virtual bool readIPv4(IPv4Packet& packet, MicroSecond& timestamp, Report& report) override;
 
     private:
+        // Precompiled address filter: zero means any address or port.
+        struct Tuple
+        {
+            uint32_t addr = 0;
+            uint16_t port = 0;
+            bool match(uint32_t a, uint16_t p) const { return (addr == 0 || addr == a) && (port == 0 || port == p); }
+        };
+
         std::set<uint8_t> _protocols {};
+        std::bitset<256>  _protocol_mask {};  // Precompiled _protocols, all set when _protocols is empty.
         IPv4SocketAddress _source {};
         IPv4SocketAddress _destination {};
+        Tuple             _source_tuple {};
+        Tuple             _destination_tuple {};
         bool              _bidirectional_filter = false;
         bool              _wildcard_filter = true;
         int               _display_addresses_severity {Severity::Debug};
@@ -240,6 +329,13 @@ namespace ts {
         MicroSecond       _opt_first_time = 0;
         MicroSecond       _opt_last_time {std::numeric_limits<ts::MicroSecond>::max()};
 
+        // Recompute the precompiled filters after a modification of the filters.
+        void compileFilters();
+
+        // Check if a packet number and timestamp are beyond the last filter or before the first one.
+        bool afterLast(MicroSecond timestamp) const;
+        bool beforeFirst(MicroSecond timestamp) const;
+
         // Get a date option and return it as micro-seconds since Unix epoch.
         ts::MicroSecond getDate(Args& args, const ts::UChar* arg_name, ts::MicroSecond def_value);
     };
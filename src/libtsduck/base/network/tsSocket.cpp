@@ -164,6 +164,34 @@ bool ts::Socket::reusePort(bool active, Report& report)
 }
 
 
+//----------------------------------------------------------------------------
+// Set the socket in non-blocking or blocking mode.
+//----------------------------------------------------------------------------
+
+bool ts::Socket::setNonBlocking(bool non_blocking, Report& report)
+{
+    report.debug(u"setting socket non-blocking mode to %s", {non_blocking});
+#if defined(TS_WINDOWS)
+    ::u_long mode = non_blocking ? 1 : 0;
+    if (::ioctlsocket(_sock, FIONBIO, &mode) != 0) {
+        report.error(u"error setting socket non-blocking mode: %s", {SysSocketErrorCodeMessage()});
+        return false;
+    }
+#else
+    int flags = ::fcntl(_sock, F_GETFL, 0);
+    if (flags >= 0) {
+        flags = non_blocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+        flags = ::fcntl(_sock, F_SETFL, flags);
+    }
+    if (flags < 0) {
+        report.error(u"error setting socket non-blocking mode: %s", {SysSocketErrorCodeMessage()});
+        return false;
+    }
+#endif
+    return true;
+}
+
+
 //----------------------------------------------------------------------------
 // Get local socket address
 //----------------------------------------------------------------------------
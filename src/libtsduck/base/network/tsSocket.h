@@ -89,6 +89,17 @@ namespace ts {
         //!
         bool reusePort(bool reuse_port, Report& report = CERR);
 
+        //!
+        //! Set the socket in non-blocking or blocking mode.
+        //! In non-blocking mode, I/O operations which cannot complete immediately
+        //! fail with error SYS_SOCKET_ERR_WOULDBLOCK. Non-blocking sockets are
+        //! typically used in event-driven servers, not in normal applications.
+        //! @param [in] non_blocking If true, the socket is set in non-blocking mode.
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //!
+        bool setNonBlocking(bool non_blocking, Report& report = CERR);
+
         //!
         //! Get local socket address
         //! @param [out] addr Local socket address of the connection.
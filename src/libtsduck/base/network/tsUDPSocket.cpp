@@ -426,6 +426,60 @@ bool ts::UDPSocket::send(const void* data, size_t size, const IPv4SocketAddress&
 }
 
 
+//----------------------------------------------------------------------------
+// Send a batch of messages.
+//----------------------------------------------------------------------------
+
+bool ts::UDPSocket::send(const OutputMessage* messages, size_t count, Report& report)
+{
+#if defined(TS_LINUX)
+
+    // Send by chunks of limited size, the system structures are built on the stack.
+    constexpr size_t MAX_BATCH = 64;
+    ::mmsghdr hdr[MAX_BATCH];
+    ::iovec iov[MAX_BATCH];
+    ::sockaddr addr[MAX_BATCH];
+
+    while (count > 0) {
+        const size_t chunk = std::min(count, MAX_BATCH);
+        TS_ZERO(hdr);
+        for (size_t i = 0; i < chunk; ++i) {
+            messages[i].destination.copy(addr[i]);
+            iov[i].iov_base = const_cast<void*>(messages[i].data);
+            iov[i].iov_len = messages[i].size;
+            hdr[i].msg_hdr.msg_name = &addr[i];
+            hdr[i].msg_hdr.msg_namelen = sizeof(addr[i]);
+            hdr[i].msg_hdr.msg_iov = &iov[i];
+            hdr[i].msg_hdr.msg_iovlen = 1;
+        }
+        const int sent = ::sendmmsg(getSocket(), hdr, (unsigned int)(chunk), 0);
+        if (sent < 0 && errno == EINTR) {
+            // Interrupted by a signal before sending anything, retry.
+            continue;
+        }
+        else if (sent <= 0) {
+            report.error(u"error sending UDP message: " + SysSocketErrorCodeMessage());
+            return false;
+        }
+        // Some messages may not be sent, they will be sent in the next call.
+        messages += sent;
+        count -= size_t(sent);
+    }
+    return true;
+
+#else
+
+    // One system call per message.
+    bool ok = true;
+    for (size_t i = 0; ok && i < count; ++i) {
+        ok = send(messages[i].data, messages[i].size, messages[i].destination, report);
+    }
+    return ok;
+
+#endif
+}
+
+
 //----------------------------------------------------------------------------
 // Receive a message.
 // If abort interface is non-zero, invoke it when I/O is interrupted
@@ -301,6 +301,30 @@ namespace ts {
         //!
         virtual bool send(const void* data, size_t size, Report& report = CERR);
 
+        //!
+        //! Description of one message to send in a batch.
+        //!
+        class TSDUCKDLL OutputMessage
+        {
+        public:
+            const void*       data = nullptr;   //!< Address of the message to send.
+            size_t            size = 0;         //!< Size in bytes of the message to send.
+            IPv4SocketAddress destination {};   //!< Socket address of the destination, address and port are mandatory.
+        };
+
+        //!
+        //! Send a batch of messages.
+        //!
+        //! On Linux, the messages are sent using sendmmsg(), with one system call for up to
+        //! 64 messages. On other systems, the messages are sent one by one.
+        //!
+        //! @param [in] messages Address of an array of messages to send.
+        //! @param [in] count Number of messages in @a messages.
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //!
+        bool send(const OutputMessage* messages, size_t count, Report& report = CERR);
+
         //!
         //! Receive a message.
         //!
@@ -0,0 +1,25 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Declare which memory accelerations are implemented.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsPlatform.h"
+
+// Global constant private boolean which is defined when the accelerated
+// module is compiled with accelerated instructions.
+extern const bool tsMemoryIsAccelerated;
+
+namespace ts {
+    // Accelerated version of LocateZeroZero(), compiled in a separated module.
+    // Shall be called only when SysInfo::avx2Instructions() is true.
+    const uint8_t* LocateZeroZeroAccel(const uint8_t* area, size_t area_size, uint8_t third);
+}
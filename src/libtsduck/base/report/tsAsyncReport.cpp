@@ -7,6 +7,41 @@
 //----------------------------------------------------------------------------
 
 #include "tsAsyncReport.h"
+#include "tsGuardMutex.h"
+#include "tsGuardCondition.h"
+#include "tsSysUtils.h"
+#include "tsjsonObject.h"
+#include "tsTextFormatter.h"
+
+// Maximum wait time of the logging thread when idle. In normal cases, the logging thread
+// is explicitly awaken. This timeout is only a fallback and the period of the statistics.
+#define IDLE_TIMEOUT 500
+
+// Per-thread cache of the last used ring buffer. The instance identifiers of AsyncReport
+// are never reused, so a cache entry of a deleted instance never matches.
+namespace {
+    std::atomic<uint64_t> next_instance_id {1};
+    thread_local uint64_t cached_instance_id = 0;
+    thread_local void* cached_ring = nullptr;
+}
+
+// Exit flags of the rings of the current thread, set when the thread terminates.
+namespace {
+    typedef ts::SafePtr<std::atomic<bool>, ts::Mutex> ExitFlagPtr;
+    class ThreadExitFlags
+    {
+    public:
+        ThreadExitFlags() = default;
+        ~ThreadExitFlags()
+        {
+            for (const auto& flag : flags) {
+                *flag = true;
+            }
+        }
+        std::vector<ExitFlagPtr> flags {};
+    };
+    thread_local ThreadExitFlags thread_exit_flags;
+}
 
 
 //----------------------------------------------------------------------------
@@ -16,7 +51,11 @@
 ts::AsyncReport::AsyncReport(int max_severity, const AsyncReportArgs& args) :
     Report(max_severity),
     Thread(ThreadAttributes().setPriority(ThreadAttributes::GetMinimumPriority())),
-    _log_queue(args.log_msg_count),
+    _instance_id(next_instance_id++),
+    _ring_size(args.log_msg_count),
+    _json(args.log_json),
+    _coalesce(args.log_coalesce),
+    _rate_limit(args.log_rate_limit),
     _time_stamp(args.timed_log),
     _synchronous(args.sync_log)
 {
@@ -42,9 +81,12 @@ ts::AsyncReport::~AsyncReport()
 void ts::AsyncReport::terminate()
 {
     if (!_terminated) {
-        // Insert an "end of report" message in the queue.
-        // This message will tell the logging thread to terminate.
-        _log_queue.forceEnqueue(new LogMessage(true, 0, UString()));
+        // Tell the logging thread to terminate after logging all pending messages.
+        _terminate = true;
+        {
+            GuardCondition lock(_mutex, _wakeup);
+            lock.signal();
+        }
 
         // Wait for termination of the logging thread
         waitForTermination();
@@ -54,7 +96,7 @@ void ts::AsyncReport::terminate()
 
 
 //----------------------------------------------------------------------------
-// Message logging method.
+// Message logging methods.
 //----------------------------------------------------------------------------
 
 void ts::AsyncReport::writeLog(int severity, const UString &msg)
@@ -68,11 +110,177 @@ void ts::AsyncReport::writeLog(int severity, const UString &msg)
     ::OutputDebugStringW(msgNewLine.wc_str());
 #endif
 
-    if (!_terminated) {
-        // Enqueue the message immediately (timeout = 0), drop message on overflow.
-        // On the contrary, in synchronous mode, wait infinitely until the message is queued.
-        _log_queue.enqueue(new LogMessage(false, severity, msg), _synchronous ? Infinite : 0);
+    enqueue(severity, msg, UString(), NPOS);
+}
+
+void ts::AsyncReport::logSource(int severity, const UString& msg, const UString& source, size_t index)
+{
+    if (severity <= _max_severity) {
+        enqueue(severity, msg, source, index);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Enqueue a message in the ring of the current thread.
+//----------------------------------------------------------------------------
+
+void ts::AsyncReport::enqueue(int severity, const UString& msg, const UString& source, size_t index)
+{
+    if (_terminated || _terminate) {
+        return;
+    }
+
+    LogRing* ring = threadRing();
+    LogMessage* slot = ring->startPush();
+    while (slot == nullptr) {
+        if (!_synchronous) {
+            // Drop the message on overflow, never block the caller.
+            _dropped++;
+            return;
+        }
+        // In synchronous mode, wait until the logging thread frees some space.
+        wakeUp();
+        SleepThread(1);
+        slot = ring->startPush();
+    }
+
+    // Fill the slot. The strings reuse the memory of previous messages in the same slot.
+    slot->sequence = _sequence++;
+    slot->time = Time::CurrentUTC();
+    slot->severity = severity;
+    slot->index = index;
+    slot->source = source;
+    slot->message = msg;
+    ring->commitPush();
+    wakeUp();
+}
+
+
+//----------------------------------------------------------------------------
+// Get the ring of the current thread, allocate it the first time.
+//----------------------------------------------------------------------------
+
+ts::AsyncReport::LogRing* ts::AsyncReport::threadRing()
+{
+    // Fast path, without lock: same instance as last message from this thread.
+    if (cached_instance_id == _instance_id) {
+        return static_cast<LogRing*>(cached_ring);
+    }
+
+    // Slow path: look for a ring of this thread or register a new one.
+    GuardMutex lock(_mutex);
+    const std::thread::id self(std::this_thread::get_id());
+    LogRing* ring = nullptr;
+    for (const auto& it : _rings) {
+        // Thread ids can be reused, ignore the rings of terminated threads.
+        if (it->owner == self && !*it->exited) {
+            ring = it.pointer();
+            break;
+        }
+    }
+    if (ring == nullptr) {
+        ring = new LogRing(_ring_size);
+        _rings.push_back(LogRingPtr(ring));
+        // Flag the ring when this thread terminates. Forget the flags of already deallocated rings.
+        std::vector<ExitFlagPtr>& flags(thread_exit_flags.flags);
+        flags.erase(std::remove_if(flags.begin(), flags.end(), [](const ExitFlagPtr& f) { return f.count() <= 1; }), flags.end());
+        flags.push_back(ring->exited);
+    }
+    cached_instance_id = _instance_id;
+    cached_ring = ring;
+    return ring;
+}
+
+
+//----------------------------------------------------------------------------
+// Wake up the logging thread if it is idle.
+//----------------------------------------------------------------------------
+
+void ts::AsyncReport::wakeUp()
+{
+    // The fence makes sure that the logging thread sees the new message
+    // if it set _sleeping before we read it (no lost wake-up).
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_sleeping.load() && _sleeping.exchange(false)) {
+        GuardCondition lock(_mutex, _wakeup);
+        lock.signal();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Lock-free single-producer single-consumer ring buffer.
+//----------------------------------------------------------------------------
+
+ts::AsyncReport::LogMessage* ts::AsyncReport::LogRing::startPush()
+{
+    const size_t tail = _tail.load(std::memory_order_relaxed);
+    return tail - _head.load(std::memory_order_acquire) >= _slots.size() ? nullptr : &_slots[tail % _slots.size()];
+}
+
+void ts::AsyncReport::LogRing::commitPush()
+{
+    _tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+size_t ts::AsyncReport::LogRing::pop(std::vector<LogMessage>& messages)
+{
+    size_t head = _head.load(std::memory_order_relaxed);
+    const size_t tail = _tail.load(std::memory_order_acquire);
+    const size_t count = tail - head;
+    for (; head != tail; ++head) {
+        messages.push_back(_slots[head % _slots.size()]);
+    }
+    _head.store(head, std::memory_order_release);
+    return count;
+}
+
+
+//----------------------------------------------------------------------------
+// Collect all messages from all rings, in sequence order.
+//----------------------------------------------------------------------------
+
+void ts::AsyncReport::collect(std::vector<LogMessage>& messages)
+{
+    // Rings are deallocated only in this thread, copy the list to avoid holding the mutex.
+    std::vector<LogRing*> rings;
+    {
+        GuardMutex lock(_mutex);
+        rings.reserve(_rings.size());
+        for (const auto& it : _rings) {
+            rings.push_back(it.pointer());
+        }
+    }
+
+    // The exit flag is checked before popping: all messages of a terminated thread are then collected.
+    size_t nonempty = 0;
+    size_t exited = 0;
+    for (auto ring : rings) {
+        exited += *ring->exited;
+        nonempty += ring->pop(messages) > 0;
+    }
+
+    // Deallocate the rings of terminated threads. They are empty since no message can be pushed.
+    if (exited > 0) {
+        GuardMutex lock(_mutex);
+        _rings.erase(std::remove_if(_rings.begin(), _rings.end(), [](const LogRingPtr& r) { return *r->exited && r->empty(); }), _rings.end());
+    }
+
+    // Restore the global order of messages from different threads.
+    if (nonempty > 1) {
+        std::sort(messages.begin(), messages.end(), [](const LogMessage& m1, const LogMessage& m2) { return m1.sequence < m2.sequence; });
+    }
+}
+
+bool ts::AsyncReport::allEmpty() const
+{
+    for (const auto& it : _rings) {
+        if (!it->empty()) {
+            return false;
+        }
     }
+    return true;
 }
 
 
@@ -82,22 +290,46 @@ void ts::AsyncReport::writeLog(int severity, const UString &msg)
 
 void ts::AsyncReport::main()
 {
-    LogMessagePtr msg;
+    std::vector<LogMessage> messages;
 
     // Notify subclasses (if any) of thread start.
     asyncThreadStarted();
+    _stats_time = Time::CurrentUTC();
 
-    while (_log_queue.dequeue(msg) && !msg->terminate) {
+    for (;;) {
+        // Read the termination flag first, all messages before termination are then collected.
+        const bool terminate = _terminate;
+
+        messages.clear();
+        collect(messages);
+        for (const auto& msg : messages) {
+            process(msg);
+        }
 
-        asyncThreadLog(msg->severity, msg->message);
+        // Flush pending statistics when idle or from time to time.
+        const Time now(Time::CurrentUTC());
+        if (messages.empty() || (_repeat_count > 0 && now - _repeat_start >= MilliSecPerSec)) {
+            flushRepeat();
+        }
+        flushStatistics(now, terminate);
 
-        // Abort application on fatal error
-        if (msg->severity == Severity::Fatal) {
-            std::exit(EXIT_FAILURE);
+        if (terminate && messages.empty()) {
+            break;
+        }
+        if (messages.empty()) {
+            // Wait for new messages.
+            GuardCondition lock(_mutex, _wakeup);
+            _sleeping = true;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!_terminate && allEmpty()) {
+                lock.waitCondition(IDLE_TIMEOUT);
+            }
+            _sleeping = false;
         }
     }
 
     if (_max_severity >= Severity::Debug) {
+        _output_time = Time::CurrentUTC();
         asyncThreadLog(Severity::Debug, u"Report logging thread terminated");
     }
 
@@ -106,6 +338,120 @@ void ts::AsyncReport::main()
 }
 
 
+//----------------------------------------------------------------------------
+// Process one message in the logging thread: coalescing and rate limiting.
+//----------------------------------------------------------------------------
+
+void ts::AsyncReport::process(const LogMessage& msg)
+{
+    // Coalesce identical consecutive messages.
+    if (_coalesce && _has_last && msg.severity == _last.severity && msg.index == _last.index && msg.message == _last.message && msg.source == _last.source) {
+        if (_repeat_count++ == 0) {
+            _repeat_start = msg.time;
+        }
+        _last.time = msg.time;
+        return;
+    }
+    flushRepeat();
+
+    // Apply the rate limit, except on fatal errors.
+    if (_rate_limit > 0 && msg.severity > Severity::Fatal) {
+        if (msg.time - _window_start >= MilliSecPerSec) {
+            flushStatistics(msg.time, true);
+            _window_start = msg.time;
+            _window_count = 0;
+        }
+        if (_window_count >= _rate_limit) {
+            _rate_dropped++;
+            return;
+        }
+        _window_count++;
+    }
+
+    if (_coalesce) {
+        _last = msg;
+        _has_last = true;
+    }
+    output(msg);
+}
+
+
+//----------------------------------------------------------------------------
+// Output pending repetitions and statistics.
+//----------------------------------------------------------------------------
+
+void ts::AsyncReport::flushRepeat()
+{
+    if (_repeat_count > 0) {
+        LogMessage msg(_last);
+        msg.message = UString::Format(u"last message repeated %d times", {_repeat_count});
+        output(msg);
+        _repeat_count = 0;
+    }
+}
+
+void ts::AsyncReport::flushStatistics(const Time& now, bool force)
+{
+    if (force || now - _stats_time >= MilliSecPerSec) {
+        _stats_time = now;
+        LogMessage msg;
+        msg.time = now;
+        msg.severity = Severity::Warning;
+        if (_rate_dropped > 0) {
+            msg.message.format(u"%'d log messages dropped by rate limit", {_rate_dropped});
+            output(msg);
+            _rate_dropped = 0;
+        }
+        const uint64_t dropped = _dropped;
+        if (dropped > _dropped_reported) {
+            msg.message.format(u"%'d log messages dropped, log buffers full", {dropped - _dropped_reported});
+            output(msg);
+            _dropped_reported = dropped;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Format and log one message in the logging thread.
+//----------------------------------------------------------------------------
+
+void ts::AsyncReport::output(const LogMessage& msg)
+{
+    _output_time = msg.time;
+    if (_json) {
+        json::Object obj;
+        obj.add(u"time", msg.time.UTCToLocal().format(Time::DATETIME));
+        obj.add(u"severity", Severity::Enums.name(msg.severity));
+        if (!msg.source.empty()) {
+            obj.add(u"source", msg.source);
+        }
+        if (msg.index != NPOS) {
+            obj.add(u"plugin", msg.index);
+        }
+        obj.add(u"message", msg.message);
+        TextFormatter text(NULLREP);
+        text.setString();
+        text.setEndOfLineMode(TextFormatter::EndOfLineMode::SPACING);
+        obj.print(text);
+        UString line;
+        text.getString(line);
+        asyncThreadLog(msg.severity, line);
+    }
+    else if (msg.source.empty()) {
+        asyncThreadLog(msg.severity, msg.message);
+    }
+    else {
+        asyncThreadLog(msg.severity, msg.source + u": " + msg.message);
+    }
+
+    // Abort application on fatal error
+    if (msg.severity == Severity::Fatal) {
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Asynchronous logging thread interface.
 //----------------------------------------------------------------------------
@@ -118,11 +464,18 @@ void ts::AsyncReport::asyncThreadStarted()
 void ts::AsyncReport::asyncThreadLog(int severity, const UString& message)
 {
     // The default implementation logs on stderr.
-    std::cerr << "* ";
-    if (_time_stamp) {
-        std::cerr << ts::Time::CurrentLocalTime().format(ts::Time::DATETIME) << " - ";
+    if (_json) {
+        // The JSON line is self-contained.
+        std::cerr << message << std::endl;
+    }
+    else {
+        std::cerr << "* ";
+        if (_time_stamp) {
+            // Time of the message, not of its output by the logging thread.
+            std::cerr << _output_time.UTCToLocal().format(ts::Time::DATETIME) << " - ";
+        }
+        std::cerr << Severity::Header(severity) << message << std::endl;
     }
-    std::cerr << Severity::Header(severity) << message << std::endl;
 }
 
 void ts::AsyncReport::asyncThreadCompleted()
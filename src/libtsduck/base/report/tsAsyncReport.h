@@ -14,9 +14,12 @@
 #pragma once
 #include "tsReport.h"
 #include "tsAsyncReportArgs.h"
-#include "tsMessageQueue.h"
+#include "tsSafePtr.h"
 #include "tsNullMutex.h"
 #include "tsThread.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
+#include "tsTime.h"
 
 namespace ts {
     //!
@@ -28,11 +31,20 @@ namespace ts {
     //! to the caller without waiting. The messages are logged later in one single
     //! low-priority thread.
     //!
-    //! In case of a huge amount of errors, there is no avalanche effect. If a caller
-    //! cannot immediately enqueue a message or if the internal queue of messages is
-    //! full, the message is dropped. In other words, reporting messages is guaranteed
-    //! to never block, slow down or crash the application. Messages are dropped when
-    //! necessary to avoid that kind of problem.
+    //! Each application thread which logs messages uses its own lock-free ring buffer
+    //! of messages. The logging thread drains all ring buffers and logs the messages
+    //! in their original order. Logging a message never acquires a mutex, except the
+    //! first time a thread logs a message (registration of its ring buffer) and when
+    //! the logging thread is idle and must be awaken.
+    //!
+    //! In case of a huge amount of errors, there is no avalanche effect. If the ring
+    //! buffer of a thread is full, the message is dropped and counted. In other words,
+    //! reporting messages is guaranteed to never block, slow down or crash the application.
+    //! Messages are dropped when necessary to avoid that kind of problem. The number of
+    //! dropped messages is periodically reported by the logging thread.
+    //!
+    //! The logging thread can optionally coalesce consecutive identical messages,
+    //! limit the rate of logged messages and format messages as JSON lines.
     //!
     //! Messages are displayed on the standard error device by default.
     //!
@@ -79,6 +91,25 @@ namespace ts {
         //!
         bool getSynchronous() const { return _synchronous; }
 
+        //!
+        //! Get the number of messages which were dropped because a ring buffer was full.
+        //! @return The number of dropped messages since the creation of this object.
+        //!
+        uint64_t droppedMessages() const { return _dropped; }
+
+        //!
+        //! Log a message with an identified source, typically a plugin.
+        //! In text mode, the message is displayed as "source: msg".
+        //! In JSON mode, the source and its index are separate fields.
+        //! The formatting of the message is done in the logging thread.
+        //! @param [in] severity Message severity.
+        //! @param [in] msg Message text.
+        //! @param [in] source Name of the source of the message.
+        //! @param [in] index Index of the source (plugin index in a chain for instance).
+        //! Use NPOS if there is no index.
+        //!
+        void logSource(int severity, const UString& msg, const UString& source, size_t index = NPOS);
+
         //!
         //! Synchronously terminate the report thread.
         //! Automatically performed in destructor.
@@ -113,22 +144,93 @@ namespace ts {
         // This hook is invoked in the context of the logging thread.
         virtual void main() override;
 
-        // The application threads send that type of message to the logging thread
-        struct LogMessage
+        // Message in a ring buffer.
+        class LogMessage
         {
-            LogMessage(bool t, int s, const UString& m) : terminate(t), severity(s), message(m) {}
+        public:
+            uint64_t sequence = 0;          // Global sequence number, to restore the order between threads.
+            Time     time {};               // UTC time of the message.
+            int      severity = Severity::Info;
+            size_t   index = NPOS;          // Index of the source, if any.
+            UString  source {};             // Source name, if any.
+            UString  message {};
+        };
 
-            bool    terminate = false;  // ask the logging thread to terminate
-            int     severity {Severity::Info};
-            UString message {};
+        // Ring buffer of messages, one per application thread.
+        // There is one single producer (the application thread) and one single consumer (the logging thread).
+        class LogRing
+        {
+            TS_NOBUILD_NOCOPY(LogRing);
+        public:
+            LogRing(size_t size) : owner(std::this_thread::get_id()), _slots(std::max<size_t>(1, size)) {}
+            const std::thread::id owner;    // Producer thread.
+            const SafePtr<std::atomic<bool>, Mutex> exited {new std::atomic<bool>(false)};  // Set when the producer thread exits.
+            LogMessage* startPush();        // Producer: get next free slot or null if full.
+            void commitPush();              // Producer: publish the slot from startPush().
+            size_t pop(std::vector<LogMessage>& messages); // Consumer: append all messages, return count.
+            bool empty() const { return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire); }
+        private:
+            std::vector<LogMessage> _slots;
+            std::atomic<size_t>     _head {0};  // Next slot to read, updated by consumer.
+            std::atomic<size_t>     _tail {0};  // Next slot to write, updated by producer.
         };
-        typedef SafePtr <LogMessage, NullMutex> LogMessagePtr;
-        typedef MessageQueue <LogMessage, NullMutex> LogMessageQueue;
+        typedef SafePtr<LogRing, NullMutex> LogRingPtr;
 
         // Private members:
-        LogMessageQueue _log_queue {};
-        volatile bool   _time_stamp = false;
-        volatile bool   _synchronous = false;
-        volatile bool   _terminated = false;
+        const uint64_t          _instance_id;           // Unique id of this instance, for per-thread ring lookup.
+        const size_t            _ring_size;
+        const bool              _json;
+        const bool              _coalesce;
+        const size_t            _rate_limit;
+        volatile bool           _time_stamp = false;
+        volatile bool           _synchronous = false;
+        volatile bool           _terminated = false;
+        std::atomic<bool>       _terminate {false};     // Request termination of the logging thread.
+        std::atomic<bool>       _sleeping {false};      // The logging thread is waiting for messages.
+        std::atomic<uint64_t>   _sequence {0};          // Sequence number of next message.
+        std::atomic<uint64_t>   _dropped {0};           // Number of dropped messages.
+        Mutex                   _mutex {};              // Protect _rings and wake-up condition.
+        Condition               _wakeup {};             // Signaled when the logging thread shall wake up.
+        std::vector<LogRingPtr> _rings {};              // All registered rings, one per application thread.
+
+        // State of the logging thread (accessed only in the logging thread).
+        bool                    _has_last = false;      // _last is valid.
+        LogMessage              _last {};               // Last logged message, for coalescing.
+        Time                    _stats_time {};         // Last time the statistics were reported.
+        Time                    _output_time {};        // UTC time of the message which is being output.
+        size_t                  _repeat_count = 0;      // Number of coalesced repetitions of _last.
+        Time                    _repeat_start {};       // Time of first coalesced repetition.
+        Time                    _window_start {};       // Start of current rate limit window.
+        size_t                  _window_count = 0;      // Number of messages in current rate limit window.
+        size_t                  _rate_dropped = 0;      // Number of messages dropped by rate limit in current window.
+        uint64_t                _dropped_reported = 0;  // Last reported number of dropped messages.
+
+        // Get the ring of the current thread, allocate it the first time.
+        LogRing* threadRing();
+
+        // Enqueue a message in the ring of the current thread.
+        void enqueue(int severity, const UString& msg, const UString& source, size_t index);
+
+        // Wake up the logging thread if it is idle.
+        void wakeUp();
+
+        // Collect all messages from all rings, in sequence order.
+        // The rings of terminated threads are deallocated when empty.
+        void collect(std::vector<LogMessage>& messages);
+
+        // Check if all rings are empty. Must be called with _mutex held.
+        bool allEmpty() const;
+
+        // Process one message in the logging thread: coalescing and rate limiting.
+        void process(const LogMessage& msg);
+
+        // Format and log one message in the logging thread.
+        void output(const LogMessage& msg);
+
+        // Output the pending repetitions of the last message.
+        void flushRepeat();
+
+        // Output the pending statistics on rate-limited and dropped messages.
+        void flushStatistics(const Time& now, bool force);
     };
 }
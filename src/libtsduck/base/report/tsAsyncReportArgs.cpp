@@ -18,14 +18,31 @@ void ts::AsyncReportArgs::defineArgs(Args& args)
 {
     args.option(u"log-message-count", 0, Args::POSITIVE);
     args.help(u"log-message-count",
-              u"Specify the maximum number of buffered log messages. Log messages are "
+              u"Specify the maximum number of buffered log messages per thread. Log messages are "
               u"displayed asynchronously in a low priority thread. This value specifies "
-              u"the maximum number of buffered log messages in memory, before being "
-              u"displayed. When too many messages are logged in a short period of time, "
+              u"the maximum number of buffered log messages in memory, for each thread "
+              u"which logs messages, before being displayed. When too many messages are logged in a short period of time, "
               u"while plugins use all CPU power, extra messages are dropped. Increase "
-              u"this value if you think that too many messages are dropped. The default "
+              u"this value if you think that too many messages are dropped. The number of "
+              u"dropped messages is periodically reported. The default "
               u"is " + UString::Decimal(MAX_LOG_MESSAGES) + u" messages.");
 
+    args.option(u"log-coalesce");
+    args.help(u"log-coalesce",
+              u"Coalesce consecutive identical log messages. Repeated messages are replaced "
+              u"by one single message indicating how many times the previous message was repeated.");
+
+    args.option(u"log-json");
+    args.help(u"log-json",
+              u"Log messages as structured JSON lines. Each line contains the time stamp, the "
+              u"severity, the message and, for messages from plugins, the plugin name and index.");
+
+    args.option(u"log-rate-limit", 0, Args::UNSIGNED);
+    args.help(u"log-rate-limit", u"count",
+              u"Specify the maximum number of log messages per second. Extra messages are "
+              u"dropped and the number of dropped messages is reported every second. "
+              u"Fatal errors are never dropped. The default is zero, meaning unlimited.");
+
     args.option(u"synchronous-log", 's');
     args.help(u"synchronous-log",
               u"Each logged message is guaranteed to be displayed, synchronously, without "
@@ -48,6 +65,9 @@ void ts::AsyncReportArgs::defineArgs(Args& args)
 bool ts::AsyncReportArgs::loadArgs(DuckContext& duck, Args& args)
 {
     args.getIntValue(log_msg_count, u"log-message-count", MAX_LOG_MESSAGES);
+    args.getIntValue(log_rate_limit, u"log-rate-limit", 0);
+    log_coalesce = args.present(u"log-coalesce");
+    log_json = args.present(u"log-json");
     sync_log = args.present(u"synchronous-log");
     timed_log = args.present(u"timed-log");
     return true;
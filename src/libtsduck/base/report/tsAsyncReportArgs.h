@@ -29,10 +29,13 @@ namespace ts {
         // Public fields
         bool   sync_log = false;                  //!< Synchronous log.
         bool   timed_log = false;                 //!< Add time stamps in log messages.
-        size_t log_msg_count = MAX_LOG_MESSAGES;  //!< Maximum buffered log messages.
+        size_t log_msg_count = MAX_LOG_MESSAGES;  //!< Maximum buffered log messages, per thread.
+        bool   log_json = false;                  //!< Log messages as JSON lines.
+        bool   log_coalesce = false;              //!< Coalesce consecutive identical messages.
+        size_t log_rate_limit = 0;                //!< Maximum number of logged messages per second, zero means unlimited.
 
         //!
-        //! Default maximum number of messages in the queue.
+        //! Default maximum number of messages in the queue of each thread.
         //! Must be limited since the logging thread has a low priority.
         //! If a high priority thread loops on report, it would exhaust the memory.
         //!
@@ -134,6 +134,30 @@ namespace ts {
         //!
         virtual void log(int severity, const UString& fmt, std::initializer_list<ArgMixIn> args);
 
+        //!
+        //! Report a message with an explicit severity and a printf-like interface.
+        //!
+        //! This variant takes the arguments directly, without enclosing braces.
+        //! The severity is checked inline, before building the list of arguments.
+        //! When the message is dropped, the arguments are neither packed nor formatted.
+        //! Use it in hot code paths where messages are usually filtered out, such as
+        //! per-packet debug messages. With a literal format string, the number of
+        //! arguments can be checked at compile time using TS_CHECKED_FORMAT().
+        //!
+        //! @param [in] severity Message severity.
+        //! @param [in] fmt Format string with embedded '\%' sequences.
+        //! @param [in] arg1 First argument to substitute in the format string.
+        //! @param [in] args Other arguments to substitute in the format string.
+        //! @see UString::format()
+        //!
+        template <class ARG1, class... ARGS>
+        void log(int severity, const UChar* fmt, const ARG1& arg1, const ARGS&... args)
+        {
+            if (severity <= _max_severity) {
+                log(severity, fmt, {arg1, args...});
+            }
+        }
+
         //!
         //! Report a fatal error message.
         //! @param [in] msg Message text.
@@ -156,6 +180,16 @@ namespace ts {
         //!
         void fatal(const UString& fmt, std::initializer_list<ArgMixIn> args) { log(Severity::Fatal, fmt, args); }
 
+        //!
+        //! Report a fatal error message with a printf-like interface and inline severity filtering.
+        //! @param [in] fmt Format string with embedded '\%' sequences.
+        //! @param [in] arg1 First argument to substitute in the format string.
+        //! @param [in] args Other arguments to substitute in the format string.
+        //! @see log(int, const UChar*, const ARG1&, const ARGS&...)
+        //!
+        template <class ARG1, class... ARGS>
+        void fatal(const UChar* fmt, const ARG1& arg1, const ARGS&... args) { log(Severity::Fatal, fmt, arg1, args...); }
+
         //!
         //! Report a severe error message.
         //! @param [in] msg Message text.
@@ -178,6 +212,16 @@ namespace ts {
         //!
         void severe(const UString& fmt, std::initializer_list<ArgMixIn> args) { log(Severity::Severe, fmt, args); }
 
+        //!
+        //! Report a severe error message with a printf-like interface and inline severity filtering.
+        //! @param [in] fmt Format string with embedded '\%' sequences.
+        //! @param [in] arg1 First argument to substitute in the format string.
+        //! @param [in] args Other arguments to substitute in the format string.
+        //! @see log(int, const UChar*, const ARG1&, const ARGS&...)
+        //!
+        template <class ARG1, class... ARGS>
+        void severe(const UChar* fmt, const ARG1& arg1, const ARGS&... args) { log(Severity::Severe, fmt, arg1, args...); }
+
         //!
         //! Report an error message.
         //! @param [in] msg Message text.
@@ -200,6 +244,16 @@ namespace ts {
         //!
         void error(const UString& fmt, std::initializer_list<ArgMixIn> args) { log(Severity::Error, fmt, args); }
 
+        //!
+        //! Report an error message with a printf-like interface and inline severity filtering.
+        //! @param [in] fmt Format string with embedded '\%' sequences.
+        //! @param [in] arg1 First argument to substitute in the format string.
+        //! @param [in] args Other arguments to substitute in the format string.
+        //! @see log(int, const UChar*, const ARG1&, const ARGS&...)
+        //!
+        template <class ARG1, class... ARGS>
+        void error(const UChar* fmt, const ARG1& arg1, const ARGS&... args) { log(Severity::Error, fmt, arg1, args...); }
+
         //!
         //! Report a warning message.
         //! @param [in] msg Message text.
@@ -222,6 +276,16 @@ namespace ts {
         //!
         void warning(const UString& fmt, std::initializer_list<ArgMixIn> args) { log(Severity::Warning, fmt, args); }
 
+        //!
+        //! Report a warning message with a printf-like interface and inline severity filtering.
+        //! @param [in] fmt Format string with embedded '\%' sequences.
+        //! @param [in] arg1 First argument to substitute in the format string.
+        //! @param [in] args Other arguments to substitute in the format string.
+        //! @see log(int, const UChar*, const ARG1&, const ARGS&...)
+        //!
+        template <class ARG1, class... ARGS>
+        void warning(const UChar* fmt, const ARG1& arg1, const ARGS&... args) { log(Severity::Warning, fmt, arg1, args...); }
+
         //!
         //! Report an informational message.
         //! @param [in] msg Message text.
@@ -244,6 +308,16 @@ namespace ts {
         //!
         void info(const UString& fmt, std::initializer_list<ArgMixIn> args) { log(Severity::Info, fmt, args); }
 
+        //!
+        //! Report an informational message with a printf-like interface and inline severity filtering.
+        //! @param [in] fmt Format string with embedded '\%' sequences.
+        //! @param [in] arg1 First argument to substitute in the format string.
+        //! @param [in] args Other arguments to substitute in the format string.
+        //! @see log(int, const UChar*, const ARG1&, const ARGS&...)
+        //!
+        template <class ARG1, class... ARGS>
+        void info(const UChar* fmt, const ARG1& arg1, const ARGS&... args) { log(Severity::Info, fmt, arg1, args...); }
+
         //!
         //! Report a verbose message.
         //! @param [in] msg Message text.
@@ -266,6 +340,16 @@ namespace ts {
         //!
         void verbose(const UString& fmt, std::initializer_list<ArgMixIn> args) { log(Severity::Verbose, fmt, args); }
 
+        //!
+        //! Report a verbose message with a printf-like interface and inline severity filtering.
+        //! @param [in] fmt Format string with embedded '\%' sequences.
+        //! @param [in] arg1 First argument to substitute in the format string.
+        //! @param [in] args Other arguments to substitute in the format string.
+        //! @see log(int, const UChar*, const ARG1&, const ARGS&...)
+        //!
+        template <class ARG1, class... ARGS>
+        void verbose(const UChar* fmt, const ARG1& arg1, const ARGS&... args) { log(Severity::Verbose, fmt, arg1, args...); }
+
         //!
         //! Report a debug message.
         //! @param [in] msg Message text.
@@ -288,6 +372,16 @@ namespace ts {
         //!
         void debug(const UString& fmt, std::initializer_list<ArgMixIn> args) { log(Severity::Debug, fmt, args); }
 
+        //!
+        //! Report a debug message with a printf-like interface and inline severity filtering.
+        //! @param [in] fmt Format string with embedded '\%' sequences.
+        //! @param [in] arg1 First argument to substitute in the format string.
+        //! @param [in] args Other arguments to substitute in the format string.
+        //! @see log(int, const UChar*, const ARG1&, const ARGS&...)
+        //!
+        template <class ARG1, class... ARGS>
+        void debug(const UChar* fmt, const ARG1& arg1, const ARGS&... args) { log(Severity::Debug, fmt, arg1, args...); }
+
         //!
         //! Check if errors (or worse) were reported through this object.
         //! @return True if errors (or worse) were reported through this object.
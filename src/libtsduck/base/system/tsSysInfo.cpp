@@ -10,6 +10,7 @@
 #include "tsSysUtils.h"
 #include "tsMemory.h"
 #include "tsCryptoAcceleration.h"
+#include "tsMemoryAcceleration.h"
 
 #if defined(TS_LINUX)
     #include <sys/auxv.h>
@@ -23,6 +24,11 @@
     #include "tsSysCtl.h"
 #endif
 
+#if (defined(TS_X86_64) || defined(TS_I386)) && (defined(TS_GCC) || defined(TS_LLVM))
+    #include <cpuid.h>
+    #define TS_X86_CPUID 1
+#endif
+
 // Define singleton instance
 TS_DEFINE_SINGLETON(ts::SysInfo);
 
@@ -281,7 +287,11 @@ ts::SysInfo::SysInfo() :
             #endif
         }
         if (GetEnvironment(u"TS_NO_AES_INSTRUCTIONS").empty()) {
-            #if defined(TS_LINUX) && defined(HWCAP_AES)
+            #if defined(TS_X86_CPUID)
+                // AES-NI support is reported in bit 25 of ECX, for CPUID leaf 1.
+                unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+                _aesInstructions = tsAESIsAccelerated && __get_cpuid(1, &eax, &ebx, &ecx, &edx) != 0 && (ecx & bit_AES) != 0;
+            #elif defined(TS_LINUX) && defined(HWCAP_AES)
                 _aesInstructions = tsAESIsAccelerated && (::getauxval(AT_HWCAP) & HWCAP_AES) != 0;
             #elif defined(TS_MAC)
                 _aesInstructions = tsAESIsAccelerated && SysCtrlBool("hw.optional.arm.FEAT_AES");
@@ -308,5 +318,12 @@ ts::SysInfo::SysInfo() :
                 _sha512Instructions = tsSHA512IsAccelerated && SysCtrlBool("hw.optional.arm.FEAT_SHA512");
             #endif
         }
+        if (GetEnvironment(u"TS_NO_AVX2_INSTRUCTIONS").empty()) {
+            #if defined(TS_X86_CPUID)
+                // Also checks that the operating system saves the AVX registers.
+                __builtin_cpu_init();
+                _avx2Instructions = tsMemoryIsAccelerated && __builtin_cpu_supports("avx2");
+            #endif
+        }
     }
 }
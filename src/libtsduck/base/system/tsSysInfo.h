@@ -136,6 +136,11 @@ namespace ts {
         //!
         bool sha512Instructions() const { return _sha512Instructions; }
         //!
+        //! Check if the CPU supports AVX2 instructions, used to accelerate some memory operations.
+        //! @return True if the CPU supports AVX2 instructions.
+        //!
+        bool avx2Instructions() const { return _avx2Instructions; }
+        //!
         //! Get the operating system version.
         //! @return The operating system version.
         //!
@@ -190,6 +195,7 @@ namespace ts {
         bool    _sha1Instructions = false;
         bool    _sha256Instructions = false;
         bool    _sha512Instructions = false;
+        bool    _avx2Instructions = false;
         int     _systemMajorVersion {-1};
         UString _systemVersion {};
         UString _systemName {};
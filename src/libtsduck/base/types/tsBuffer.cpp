@@ -884,6 +884,18 @@ bool ts::Buffer::backBits(size_t bits)
 bool ts::Buffer::skipReservedBits(size_t bits, int expected)
 {
     expected &= 1;  // force 0 or 1
+
+    // Fast path: check all reserved bits at once. Use the bit by bit path on error only.
+    if (!_read_error && bits > 0 && bits <= 56 && currentReadBitOffset() + bits <= currentWriteBitOffset()) {
+        const size_t rbyte = _state.rbyte;
+        const size_t rbit = _state.rbit;
+        if (getBits<uint64_t>(bits) == (expected == 0 ? 0 : (~uint64_t(0) >> (64 - bits)))) {
+            return true;
+        }
+        _state.rbyte = rbyte;
+        _state.rbit = rbit;
+    }
+
     while (!_read_error && bits-- > 0) {
         if (getBit() != expected && !_read_error) {
             // Invalid reserved bit.
@@ -1140,10 +1152,10 @@ bool ts::Buffer::putBit(uint8_t bit)
 
 
 //----------------------------------------------------------------------------
-// Internal "read bytes" method (1 to 8 bytes).
+// Internal "read bytes" method (1 to 8 bytes), slow path of rdb().
 //----------------------------------------------------------------------------
 
-const uint8_t* ts::Buffer::rdb(size_t bytes)
+const uint8_t* ts::Buffer::rdbSlow(size_t bytes)
 {
     // Internally used to read up to 8 bytes (64-bit integers).
     assert(bytes <= 8);
@@ -1397,7 +1397,17 @@ namespace ts {
         // - Otherwise, if current read pointer is at a byte boundary, return the read address in the buffer.
         // - If not byte aligned, read the bytes content into an internal 8-byte buffer, byte aligned, and return its address.
         // - Advance read pointer.
-        const uint8_t* rdb(size_t bytes);
+        // The most common case (no error, byte aligned, enough bytes) is inlined.
+        const uint8_t* rdb(size_t bytes)
+        {
+            if (!_read_error && _state.rbit == 0 && _state.rbyte + bytes <= _state.wbyte) {
+                const uint8_t* const buf = _buffer + _state.rbyte;
+                _state.rbyte += bytes;
+                return buf;
+            }
+            return rdbSlow(bytes);
+        }
+        const uint8_t* rdbSlow(size_t bytes);
 
         // Internal put integer method.
         template <typename INT, typename std::enable_if<std::is_integral<INT>::value || std::is_floating_point<INT>::value, int>::type = 0>
@@ -1502,7 +1512,23 @@ INT ts::Buffer::getBits(size_t bits)
 
     INT val = 0;
 
-    if (_big_endian) {
+    if (_big_endian && bits <= 56) {
+        // Fast path, the most common case in MPEG/DVB structures: load all bytes containing
+        // the field into a 64-bit cache, then extract the field. The field spans at most 8 bytes.
+        const size_t end_bit = _state.rbit + bits;
+        const size_t nbytes = (end_bit + 7) / 8;
+        const uint8_t* const data = _buffer + _state.rbyte;
+        uint64_t cache = 0;
+        for (size_t i = 0; i < nbytes; ++i) {
+            cache = (cache << 8) | data[i];
+        }
+        _state.rbyte += end_bit / 8;
+        _state.rbit = end_bit % 8;
+        if (bits > 0) {
+            val = static_cast<INT>((cache >> (8 * nbytes - end_bit)) & (~uint64_t(0) >> (64 - bits)));
+        }
+    }
+    else if (_big_endian) {
         // Read leading bits up to byte boundary
         while (bits > 0 && _state.rbit != 0) {
             val = INT(val << 1) | INT(getBit());
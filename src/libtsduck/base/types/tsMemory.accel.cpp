@@ -0,0 +1,78 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+//
+// Implementation of memory operations using accelerated instructions, when
+// available. This module is compiled with special options to use optional
+// instructions for the target architecture. It may fail when these
+// instructions are not implemented in the current CPU. Consequently, this
+// module shall not be called when these instructions are not implemented.
+//
+//----------------------------------------------------------------------------
+
+#include "tsMemory.h"
+#include "tsMemoryAcceleration.h"
+
+// Check if Intel/AMD AVX2 instructions can be used in intrinsics.
+#if defined(__AVX2__) && !defined(TS_NO_X86_AVX2_INSTRUCTIONS)
+    #define TS_X86_AVX2_INSTRUCTIONS 1
+    #include <immintrin.h>
+#endif
+
+// "Hidden" exported bool to inform the SysInfo class that we have compiled accelerated instructions.
+extern const bool tsMemoryIsAccelerated =
+#if defined(TS_X86_AVX2_INSTRUCTIONS)
+    true;
+#else
+    false;
+#endif
+
+// Don't complain about assert(false) when acceleration is not implemented.
+TS_LLVM_NOWARNING(missing-noreturn)
+
+
+//----------------------------------------------------------------------------
+// Locate a 3-byte pattern 00 00 XY into a memory area.
+//----------------------------------------------------------------------------
+
+const uint8_t* ts::LocateZeroZeroAccel(const uint8_t* area, size_t area_size, uint8_t third)
+{
+#if defined(TS_X86_AVX2_INSTRUCTIONS)
+    // Compare 32 positions at a time: bytes at offsets 0, 1, 2 from each position.
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i last = _mm256_set1_epi8(char(third));
+    while (area_size >= 34) {
+        const __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(area));
+        const __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(area + 1));
+        const __m256i b2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(area + 2));
+        const __m256i match = _mm256_and_si256(_mm256_and_si256(_mm256_cmpeq_epi8(b0, zero), _mm256_cmpeq_epi8(b1, zero)), _mm256_cmpeq_epi8(b2, last));
+        uint32_t mask = uint32_t(_mm256_movemask_epi8(match));
+        if (mask != 0) {
+            // The lowest bit in the mask is the first matching position.
+            while ((mask & 1) == 0) {
+                mask >>= 1;
+                ++area;
+            }
+            return area;
+        }
+        area += 32;
+        area_size -= 32;
+    }
+
+    // Remaining positions, less than 32.
+    for (; area_size >= 3; ++area, --area_size) {
+        if (area[0] == 0x00 && area[1] == 0x00 && area[2] == third) {
+            return area;
+        }
+    }
+    return nullptr;
+#else
+    // Shall not be called.
+    assert(false);
+    return nullptr;
+#endif
+}
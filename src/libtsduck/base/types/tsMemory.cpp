@@ -7,6 +7,17 @@
 //----------------------------------------------------------------------------
 
 #include "tsMemory.h"
+#include "tsMemoryAcceleration.h"
+#include "tsSysInfo.h"
+
+// SSE2 is always available on x86_64, Neon is always available on Arm64.
+#if (defined(__SSE2__) || (defined(TS_MSC) && defined(TS_X86_64))) && !defined(TS_NO_X86_SSE2_INSTRUCTIONS)
+    #define TS_X86_SSE2_INSTRUCTIONS 1
+    #include <emmintrin.h>
+#elif defined(TS_ARM64) && defined(__ARM_NEON) && !defined(TS_NO_ARM_NEON_INSTRUCTIONS)
+    #define TS_ARM_NEON_INSTRUCTIONS 1
+    #include <arm_neon.h>
+#endif
 
 
 //----------------------------------------------------------------------------
@@ -45,6 +56,85 @@ const uint8_t* ts::LocatePattern(const void* area, size_t area_size, const void*
 }
 
 
+//----------------------------------------------------------------------------
+// Locate a 3-byte pattern 00 00 XY into a memory area.
+//----------------------------------------------------------------------------
+
+namespace {
+    // Portable version, also used on the last bytes after SIMD processing.
+    const uint8_t* LocateZeroZeroPortable(const uint8_t* area, size_t area_size, uint8_t third)
+    {
+        if (area_size >= 3) {
+            const uint8_t* const end = area + area_size - 2;
+            for (const uint8_t* p = area; p < end; ) {
+                if (p[2] != 0x00 && p[2] != third) {
+                    // No pattern can start at p, p+1 or p+2.
+                    p += 3;
+                }
+                else if (p[2] == third && p[1] == 0x00 && p[0] == 0x00) {
+                    return p;
+                }
+                else {
+                    ++p;
+                }
+            }
+        }
+        return nullptr;
+    }
+}
+
+const uint8_t* ts::LocateZeroZero(const void* area, size_t area_size, uint8_t third)
+{
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(area);
+    if (p == nullptr || area_size < 3) {
+        return nullptr;
+    }
+
+    // Use AVX2 instructions on large enough areas when supported by the CPU (checked once).
+    static const bool avx2 = SysInfo::Instance().avx2Instructions();
+    if (avx2 && area_size >= 64) {
+        return LocateZeroZeroAccel(p, area_size, third);
+    }
+
+#if defined(TS_X86_SSE2_INSTRUCTIONS)
+
+    // Compare 16 positions at a time: bytes at offsets 0, 1, 2 from each position.
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i last = _mm_set1_epi8(char(third));
+    while (area_size >= 18) {
+        const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 1));
+        const __m128i b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 2));
+        const __m128i match = _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(b0, zero), _mm_cmpeq_epi8(b1, zero)), _mm_cmpeq_epi8(b2, last));
+        if (_mm_movemask_epi8(match) != 0) {
+            // The pattern starts in these 16 positions.
+            return LocateZeroZeroPortable(p, 18, third);
+        }
+        p += 16;
+        area_size -= 16;
+    }
+
+#elif defined(TS_ARM_NEON_INSTRUCTIONS)
+
+    // Compare 16 positions at a time: bytes at offsets 0, 1, 2 from each position.
+    const uint8x16_t zero = vdupq_n_u8(0);
+    const uint8x16_t last = vdupq_n_u8(third);
+    while (area_size >= 18) {
+        const uint8x16_t match = vandq_u8(vandq_u8(vceqq_u8(vld1q_u8(p), zero), vceqq_u8(vld1q_u8(p + 1), zero)), vceqq_u8(vld1q_u8(p + 2), last));
+        if (vmaxvq_u8(match) != 0) {
+            // The pattern starts in these 16 positions.
+            return LocateZeroZeroPortable(p, 18, third);
+        }
+        p += 16;
+        area_size -= 16;
+    }
+
+#endif
+
+    return LocateZeroZeroPortable(p, area_size, third);
+}
+
+
 //----------------------------------------------------------------------------
 // Check if a memory area contains all identical byte values.
 //----------------------------------------------------------------------------
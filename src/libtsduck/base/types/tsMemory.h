@@ -56,6 +56,18 @@ namespace ts {
     //!
     TSDUCKDLL const uint8_t* LocatePattern(const void* area, size_t area_size, const void* pattern, size_t pattern_size);
 
+    //!
+    //! Locate a 3-byte pattern 00 00 XY into a memory area.
+    //! This is a specialized and faster version of LocatePattern() for the start code prefixes
+    //! (00 00 01) and end of NALunits (00 00 00) in video elementary streams. When available,
+    //! SIMD instructions are used (SSE2 or AVX2 on Intel/AMD, Neon on Arm64).
+    //! @param [in] area Address of a memory area to check.
+    //! @param [in] area_size Size in bytes of the memory area.
+    //! @param [in] third Third byte in the pattern.
+    //! @return Address of the first occurence of 00 00 @a third in @a area or zero if not found.
+    //!
+    TSDUCKDLL const uint8_t* LocateZeroZero(const void* area, size_t area_size, uint8_t third);
+
     //!
     //! Check if a memory area contains all identical byte values.
     //! @param [in] area Address of a memory area to check.
@@ -1821,6 +1821,51 @@ namespace ts {
             return Format(fmt.c_str(), args);
         }
 
+        //!
+        //! Compute the number of arguments which are expected by a format string.
+        //!
+        //! This function is @c constexpr. When the format string is a literal, it can
+        //! be used in a @c static_assert to check the number of arguments at compile time.
+        //! Each '\%' sequence uses one argument, except '\%\%' and '\%<' sequences.
+        //! Each '*' width or precision field uses one additional argument.
+        //! @code
+        //! static_assert(ts::UString::FormatArgCount(u"%'d packets, %*d") == 3, "invalid format");
+        //! @endcode
+        //! The macro TS_CHECKED_FORMAT() uses it to check the arguments of a message.
+        //!
+        //! @param [in] fmt Format string with embedded '\%' sequences.
+        //! @return The number of arguments which are used by @a fmt.
+        //! @see format()
+        //!
+        static constexpr size_t FormatArgCount(const UChar* fmt)
+        {
+            return fmt == nullptr || *fmt == CHAR_NULL ? 0 :
+                *fmt != u'%' ? FormatArgCount(fmt + 1) :
+                fmt[1] == u'%' ? FormatArgCount(fmt + 2) :
+                FormatSequenceArgCount(fmt + 1, 0, false);
+        }
+
+        //!
+        //! Check at compile time the number of arguments of a format string.
+        //! This function is used by the macro TS_CHECKED_FORMAT(), it is not called directly.
+        //! @tparam EXPECTED Number of arguments which are used by the format string.
+        //! @tparam ACTUAL Number of arguments which are actually provided.
+        //! @param [in] fmt Format string with embedded '\%' sequences.
+        //! @return The format string @a fmt.
+        //!
+        template <size_t EXPECTED, size_t ACTUAL>
+        static constexpr const UChar* CheckedFormat(const UChar* fmt)
+        {
+            static_assert(EXPECTED == ACTUAL, "the number of arguments does not match the format string");
+            return fmt;
+        }
+
+        //! @cond nodoxygen
+        // Declared only, used in unevaluated context by TS_CHECKED_FORMAT() to count its arguments.
+        template <class... ARGS>
+        static auto FormatArgsCounter(const ARGS&...) -> char(&)[sizeof...(ARGS) + 1];
+        //! @endcond
+
         //!
         //! Scan this string for integer or character values using a template and arguments.
         //!
@@ -2235,6 +2280,27 @@ namespace ts {
         template<typename INT, typename std::enable_if<std::is_integral<INT>::value && std::is_signed<INT>::value && sizeof(INT) < 8>::type* = nullptr>
         static void DecimalMostNegative(UString& result, const UString& separator);
 
+        // Internal helper for FormatArgCount(): count the arguments of one '%' sequence, then
+        // of the rest of the format string. The sequence syntax is the one which is used by
+        // ArgMixInContext::processArg(), analyzed in successive steps:
+        // 0: '<', 1: '-', 2: '+', 3: '0', 4-5: width, 6: '.', 7-8: precision, 9: quote, 10: command.
+        static constexpr size_t FormatSequenceArgCount(const UChar* fmt, int step, bool reuse)
+        {
+            return
+                step == 0 ? (*fmt == u'<' ? FormatSequenceArgCount(fmt + 1, 1, true) : FormatSequenceArgCount(fmt, 1, reuse)) :
+                step == 1 ? FormatSequenceArgCount(*fmt == u'-' ? fmt + 1 : fmt, 2, reuse) :
+                step == 2 ? FormatSequenceArgCount(*fmt == u'+' ? fmt + 1 : fmt, 3, reuse) :
+                step == 3 ? FormatSequenceArgCount(*fmt == u'0' ? fmt + 1 : fmt, 4, reuse) :
+                step == 4 ? (*fmt == u'*' ? 1 + FormatSequenceArgCount(fmt + 1, 6, reuse) : FormatSequenceArgCount(fmt, 5, reuse)) :
+                step == 5 ? (*fmt >= u'0' && *fmt <= u'9' ? FormatSequenceArgCount(fmt + 1, 5, reuse) : FormatSequenceArgCount(fmt, 6, reuse)) :
+                step == 6 ? (*fmt == u'.' ? FormatSequenceArgCount(fmt + 1, 7, reuse) : FormatSequenceArgCount(fmt, 9, reuse)) :
+                step == 7 ? (*fmt == u'*' ? 1 + FormatSequenceArgCount(fmt + 1, 9, reuse) : FormatSequenceArgCount(fmt, 8, reuse)) :
+                step == 8 ? (*fmt >= u'0' && *fmt <= u'9' ? FormatSequenceArgCount(fmt + 1, 8, reuse) : FormatSequenceArgCount(fmt, 9, reuse)) :
+                step == 9 ? FormatSequenceArgCount(*fmt == u'\'' ? fmt + 1 : fmt, 10, reuse) :
+                *fmt == CHAR_NULL ? 0 :
+                (!reuse && (*fmt == u's' || *fmt == u'c' || *fmt == u'd' || *fmt == u'x' || *fmt == u'X' || *fmt == u'f') ? 1 : 0) + FormatArgCount(fmt + 1);
+        }
+
         //!
         //! Analysis context of a Format or Scan string, base class.
         //!
@@ -2343,6 +2409,24 @@ namespace ts {
     };
 }
 
+//!
+//! Format string and arguments with a compile-time check of the number of arguments.
+//!
+//! The format string must be a literal and at least one argument must be provided.
+//! The macro expands to the format string, followed by the arguments. It is used
+//! with the variadic methods of ts::Report. A compilation error is generated when
+//! the number of arguments does not match the format string.
+//! @code
+//! report.debug(TS_CHECKED_FORMAT(u"got %d packets from plugin %d", count, index));
+//! @endcode
+//!
+//! @param fmt Literal format string with embedded '\%' sequences.
+//! @see ts::UString::FormatArgCount()
+//! @hideinitializer
+//!
+#define TS_CHECKED_FORMAT(fmt, ...) \
+    ts::UString::CheckedFormat<ts::UString::FormatArgCount(fmt), sizeof(ts::UString::FormatArgsCounter(__VA_ARGS__)) - 1>(fmt), __VA_ARGS__
+
 //!
 //! Output operator for ts::UString on standard text streams with UTF-8 conversion.
 //! @param [in,out] strm A standard stream in output mode.
@@ -5,6 +5,7 @@
 //  AES block cipher
 //
 //  Arm64 acceleration based on public domain code from Arm.
+//  Intel/AMD acceleration using AES-NI instructions.
 //
 //----------------------------------------------------------------------------
 //
@@ -25,6 +26,11 @@
     #define TS_ARM_AES_INSTRUCTIONS 1
 #endif
 
+// Check if Intel/AMD AES-NI instructions can be used in intrinsics.
+#if defined(__AES__) && defined(__SSE2__) && !defined(TS_NO_X86_AES_INSTRUCTIONS)
+    #define TS_X86_AES_INSTRUCTIONS 1
+#endif
+
 #if defined(TS_ARM_AES_INSTRUCTIONS)
 #include <arm_neon.h>
 class ts::AES::Acceleration
@@ -33,11 +39,23 @@ public:
     uint8x16_t eK[15];  // Scheduled encryption keys in SIMD register format.
     uint8x16_t dK[15];  // Scheduled decryption keys in SIMD register format.
 };
+#elif defined(TS_X86_AES_INSTRUCTIONS)
+#include <wmmintrin.h>
+class ts::AES::Acceleration
+{
+public:
+    __m128i eK[15];  // Scheduled encryption keys in SSE register format.
+    __m128i dK[15];  // Scheduled decryption keys in SSE register format (equivalent inverse cipher).
+};
 #endif
 
+// Number of blocks which are interleaved in multi-block operations.
+// AES instructions have a latency of several cycles but can be issued every cycle.
+#define TS_AES_INTERLEAVE 4
+
 // "Hidden" exported bool to inform the SysInfo class that we have compiled accelerated instructions.
 extern const bool tsAESIsAccelerated =
-#if defined(TS_ARM_AES_INSTRUCTIONS)
+#if defined(TS_ARM_AES_INSTRUCTIONS) || defined(TS_X86_AES_INSTRUCTIONS)
     true;
 #else
     false;
@@ -53,7 +71,7 @@ TS_LLVM_NOWARNING(missing-noreturn)
 
 ts::AES::Acceleration* ts::AES::newAccel()
 {
-#if defined(TS_ARM_AES_INSTRUCTIONS)
+#if defined(TS_ARM_AES_INSTRUCTIONS) || defined(TS_X86_AES_INSTRUCTIONS)
     return new Acceleration;
 #else
     // Shall not be called.
@@ -64,7 +82,7 @@ ts::AES::Acceleration* ts::AES::newAccel()
 
 void ts::AES::deleteAccel(Acceleration* accel)
 {
-#if defined(TS_ARM_AES_INSTRUCTIONS)
+#if defined(TS_ARM_AES_INSTRUCTIONS) || defined(TS_X86_AES_INSTRUCTIONS)
     delete accel;
 #else
     // Shall not be called.
@@ -97,6 +115,22 @@ void ts::AES::setKeyAccel()
         accel.eK[i] = vld1q_u8(ek + 16 * i);
         accel.dK[i] = vld1q_u8(dk + 16 * i);
     }
+#elif defined(TS_X86_AES_INSTRUCTIONS)
+    // Same byte order as Arm64: the subkeys are used as byte arrays.
+    int max = (_nrounds + 1) * 4;
+    for (int i = 0; i < max; ++i) {
+        _eK[i] = ByteSwap32(_eK[i]);
+        _dK[i] = ByteSwap32(_dK[i]);
+    }
+
+    // Load scheduled keys in SSE registers format.
+    const __m128i* ek = reinterpret_cast<const __m128i*>(_eK);
+    const __m128i* dk = reinterpret_cast<const __m128i*>(_dK);
+    Acceleration& accel(*_accel);
+    for (int i = 0; i <= _nrounds; ++i) {
+        accel.eK[i] = _mm_loadu_si128(ek + i);
+        accel.dK[i] = _mm_loadu_si128(dk + i);
+    }
 #else
     // Shall not be called.
     assert(false);
@@ -141,6 +175,14 @@ void ts::AES::encryptAccel(const uint8_t* pt, uint8_t* ct)
         }
     }
     vst1q_u8(ct, blk);
+#elif defined(TS_X86_AES_INSTRUCTIONS)
+    const __m128i* k = _accel->eK;
+    __m128i blk = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pt)), k[0]);
+    for (int r = 1; r < _nrounds; ++r) {
+        blk = _mm_aesenc_si128(blk, k[r]);
+    }
+    blk = _mm_aesenclast_si128(blk, k[_nrounds]);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(ct), blk);
 #else
     // Shall not be called.
     assert(false);
@@ -185,8 +227,150 @@ void ts::AES::decryptAccel(const uint8_t* ct, uint8_t* pt)
         }
     }
     vst1q_u8(pt, blk);
+#elif defined(TS_X86_AES_INSTRUCTIONS)
+    const __m128i* k = _accel->dK;
+    __m128i blk = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ct)), k[0]);
+    for (int r = 1; r < _nrounds; ++r) {
+        blk = _mm_aesdec_si128(blk, k[r]);
+    }
+    blk = _mm_aesdeclast_si128(blk, k[_nrounds]);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pt), blk);
 #else
     // Shall not be called.
     assert(false);
 #endif
 }
+
+
+//----------------------------------------------------------------------------
+// Accelerated encryption of several independent blocks in ECB mode.
+//----------------------------------------------------------------------------
+
+void ts::AES::encryptBlocksAccel(const uint8_t* pt, uint8_t* ct, size_t count)
+{
+#if defined(TS_ARM_AES_INSTRUCTIONS)
+    const uint8x16_t* k = _accel->eK;
+    const int last = _nrounds - 1;
+    while (count >= TS_AES_INTERLEAVE) {
+        uint8x16_t b0 = vld1q_u8(pt);
+        uint8x16_t b1 = vld1q_u8(pt + 16);
+        uint8x16_t b2 = vld1q_u8(pt + 32);
+        uint8x16_t b3 = vld1q_u8(pt + 48);
+        for (int r = 0; r < last; ++r) {
+            b0 = vaesmcq_u8(vaeseq_u8(b0, k[r]));
+            b1 = vaesmcq_u8(vaeseq_u8(b1, k[r]));
+            b2 = vaesmcq_u8(vaeseq_u8(b2, k[r]));
+            b3 = vaesmcq_u8(vaeseq_u8(b3, k[r]));
+        }
+        vst1q_u8(ct,      veorq_u8(vaeseq_u8(b0, k[last]), k[last + 1]));
+        vst1q_u8(ct + 16, veorq_u8(vaeseq_u8(b1, k[last]), k[last + 1]));
+        vst1q_u8(ct + 32, veorq_u8(vaeseq_u8(b2, k[last]), k[last + 1]));
+        vst1q_u8(ct + 48, veorq_u8(vaeseq_u8(b3, k[last]), k[last + 1]));
+        pt += TS_AES_INTERLEAVE * BLOCK_SIZE;
+        ct += TS_AES_INTERLEAVE * BLOCK_SIZE;
+        count -= TS_AES_INTERLEAVE;
+    }
+#elif defined(TS_X86_AES_INSTRUCTIONS)
+    const __m128i* k = _accel->eK;
+    const __m128i* in = reinterpret_cast<const __m128i*>(pt);
+    __m128i* out = reinterpret_cast<__m128i*>(ct);
+    while (count >= TS_AES_INTERLEAVE) {
+        __m128i b0 = _mm_xor_si128(_mm_loadu_si128(in), k[0]);
+        __m128i b1 = _mm_xor_si128(_mm_loadu_si128(in + 1), k[0]);
+        __m128i b2 = _mm_xor_si128(_mm_loadu_si128(in + 2), k[0]);
+        __m128i b3 = _mm_xor_si128(_mm_loadu_si128(in + 3), k[0]);
+        for (int r = 1; r < _nrounds; ++r) {
+            b0 = _mm_aesenc_si128(b0, k[r]);
+            b1 = _mm_aesenc_si128(b1, k[r]);
+            b2 = _mm_aesenc_si128(b2, k[r]);
+            b3 = _mm_aesenc_si128(b3, k[r]);
+        }
+        _mm_storeu_si128(out,     _mm_aesenclast_si128(b0, k[_nrounds]));
+        _mm_storeu_si128(out + 1, _mm_aesenclast_si128(b1, k[_nrounds]));
+        _mm_storeu_si128(out + 2, _mm_aesenclast_si128(b2, k[_nrounds]));
+        _mm_storeu_si128(out + 3, _mm_aesenclast_si128(b3, k[_nrounds]));
+        in += TS_AES_INTERLEAVE;
+        out += TS_AES_INTERLEAVE;
+        count -= TS_AES_INTERLEAVE;
+    }
+    pt = reinterpret_cast<const uint8_t*>(in);
+    ct = reinterpret_cast<uint8_t*>(out);
+#else
+    // Shall not be called.
+    assert(false);
+#endif
+
+    // Remaining blocks, one by one.
+    for (; count > 0; --count) {
+        encryptAccel(pt, ct);
+        pt += BLOCK_SIZE;
+        ct += BLOCK_SIZE;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Accelerated decryption of several independent blocks in ECB mode.
+//----------------------------------------------------------------------------
+
+void ts::AES::decryptBlocksAccel(const uint8_t* ct, uint8_t* pt, size_t count)
+{
+#if defined(TS_ARM_AES_INSTRUCTIONS)
+    const uint8x16_t* k = _accel->dK;
+    const int last = _nrounds - 1;
+    while (count >= TS_AES_INTERLEAVE) {
+        uint8x16_t b0 = vld1q_u8(ct);
+        uint8x16_t b1 = vld1q_u8(ct + 16);
+        uint8x16_t b2 = vld1q_u8(ct + 32);
+        uint8x16_t b3 = vld1q_u8(ct + 48);
+        for (int r = 0; r < last; ++r) {
+            b0 = vaesimcq_u8(vaesdq_u8(b0, k[r]));
+            b1 = vaesimcq_u8(vaesdq_u8(b1, k[r]));
+            b2 = vaesimcq_u8(vaesdq_u8(b2, k[r]));
+            b3 = vaesimcq_u8(vaesdq_u8(b3, k[r]));
+        }
+        vst1q_u8(pt,      veorq_u8(vaesdq_u8(b0, k[last]), k[last + 1]));
+        vst1q_u8(pt + 16, veorq_u8(vaesdq_u8(b1, k[last]), k[last + 1]));
+        vst1q_u8(pt + 32, veorq_u8(vaesdq_u8(b2, k[last]), k[last + 1]));
+        vst1q_u8(pt + 48, veorq_u8(vaesdq_u8(b3, k[last]), k[last + 1]));
+        ct += TS_AES_INTERLEAVE * BLOCK_SIZE;
+        pt += TS_AES_INTERLEAVE * BLOCK_SIZE;
+        count -= TS_AES_INTERLEAVE;
+    }
+#elif defined(TS_X86_AES_INSTRUCTIONS)
+    const __m128i* k = _accel->dK;
+    const __m128i* in = reinterpret_cast<const __m128i*>(ct);
+    __m128i* out = reinterpret_cast<__m128i*>(pt);
+    while (count >= TS_AES_INTERLEAVE) {
+        __m128i b0 = _mm_xor_si128(_mm_loadu_si128(in), k[0]);
+        __m128i b1 = _mm_xor_si128(_mm_loadu_si128(in + 1), k[0]);
+        __m128i b2 = _mm_xor_si128(_mm_loadu_si128(in + 2), k[0]);
+        __m128i b3 = _mm_xor_si128(_mm_loadu_si128(in + 3), k[0]);
+        for (int r = 1; r < _nrounds; ++r) {
+            b0 = _mm_aesdec_si128(b0, k[r]);
+            b1 = _mm_aesdec_si128(b1, k[r]);
+            b2 = _mm_aesdec_si128(b2, k[r]);
+            b3 = _mm_aesdec_si128(b3, k[r]);
+        }
+        _mm_storeu_si128(out,     _mm_aesdeclast_si128(b0, k[_nrounds]));
+        _mm_storeu_si128(out + 1, _mm_aesdeclast_si128(b1, k[_nrounds]));
+        _mm_storeu_si128(out + 2, _mm_aesdeclast_si128(b2, k[_nrounds]));
+        _mm_storeu_si128(out + 3, _mm_aesdeclast_si128(b3, k[_nrounds]));
+        in += TS_AES_INTERLEAVE;
+        out += TS_AES_INTERLEAVE;
+        count -= TS_AES_INTERLEAVE;
+    }
+    ct = reinterpret_cast<const uint8_t*>(in);
+    pt = reinterpret_cast<uint8_t*>(out);
+#else
+    // Shall not be called.
+    assert(false);
+#endif
+
+    // Remaining blocks, one by one.
+    for (; count > 0; --count) {
+        decryptAccel(ct, pt);
+        ct += BLOCK_SIZE;
+        pt += BLOCK_SIZE;
+    }
+}
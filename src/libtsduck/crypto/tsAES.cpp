@@ -998,3 +998,31 @@ bool ts::AES::decryptImpl(const void* cipher, size_t cipher_length, void* plain,
     }
     return true;
 }
+
+
+//----------------------------------------------------------------------------
+// Several independent blocks in ECB mode. With accelerated instructions,
+// several blocks are interleaved to hide the latency of AES instructions.
+//----------------------------------------------------------------------------
+
+bool ts::AES::encryptBlocksImpl(const void* plain, void* cipher, size_t count)
+{
+    if (_accel_supported) {
+        encryptBlocksAccel(reinterpret_cast<const uint8_t*>(plain), reinterpret_cast<uint8_t*>(cipher), count);
+        return true;
+    }
+    else {
+        return BlockCipher::encryptBlocksImpl(plain, cipher, count);
+    }
+}
+
+bool ts::AES::decryptBlocksImpl(const void* cipher, void* plain, size_t count)
+{
+    if (_accel_supported) {
+        decryptBlocksAccel(reinterpret_cast<const uint8_t*>(cipher), reinterpret_cast<uint8_t*>(plain), count);
+        return true;
+    }
+    else {
+        return BlockCipher::decryptBlocksImpl(cipher, plain, count);
+    }
+}
@@ -168,6 +168,56 @@ namespace ts {
         //!
         bool decryptInPlace(void* data, size_t data_length, size_t* max_actual_length = nullptr);
 
+        //!
+        //! Encrypt several independent blocks of data (ECB mode).
+        //!
+        //! All blocks are contiguous and have the block size of the algorithm. They are
+        //! independently encrypted with the current key. Pure block ciphers such as AES
+        //! may process several blocks in parallel when hardware acceleration is available.
+        //! Each block counts as one use of the key.
+        //!
+        //! @param [in] plain Address of plain text blocks.
+        //! @param [out] cipher Address of buffer for cipher text blocks. Can be the same as @a plain.
+        //! @param [in] count Number of blocks.
+        //! @return True on success, false on error.
+        //!
+        bool encryptBlocks(const void* plain, void* cipher, size_t count);
+
+        //!
+        //! Decrypt several independent blocks of data (ECB mode).
+        //! @param [in] cipher Address of cipher text blocks.
+        //! @param [out] plain Address of buffer for plain text blocks. Can be the same as @a cipher.
+        //! @param [in] count Number of blocks.
+        //! @return True on success, false on error.
+        //! @see encryptBlocks()
+        //!
+        bool decryptBlocks(const void* cipher, void* plain, size_t count);
+
+        //!
+        //! Encrypt several independent messages in place.
+        //!
+        //! Each message is encrypted as if encryptInPlace() was called on it. A typical usage is
+        //! the scrambling of the payloads of a batch of TS packets. Chaining modes may interleave
+        //! the processing of the messages, allowing independent chains to run in parallel.
+        //! Each message counts as one use of the key.
+        //!
+        //! @param [in] count Number of messages.
+        //! @param [in] data Array of @a count message addresses.
+        //! @param [in] sizes Array of @a count message sizes in bytes.
+        //! @return True on success, false on error.
+        //!
+        bool encryptInPlaceMulti(size_t count, void* const data[], const size_t sizes[]);
+
+        //!
+        //! Decrypt several independent messages in place.
+        //! @param [in] count Number of messages.
+        //! @param [in] data Array of @a count message addresses.
+        //! @param [in] sizes Array of @a count message sizes in bytes.
+        //! @return True on success, false on error.
+        //! @see encryptInPlaceMulti()
+        //!
+        bool decryptInPlaceMulti(size_t count, void* const data[], const size_t sizes[]);
+
         //!
         //! Get the number of times the current key was used for encryption.
         //! @return The number of times the current key was used for encryption.
@@ -293,6 +343,50 @@ namespace ts {
         //!
         virtual bool decryptInPlaceImpl(void* data, size_t data_length, size_t* max_actual_length);
 
+        //!
+        //! Encrypt several independent blocks of data (implementation of algorithm-specific part).
+        //! The default implementation calls encryptImpl() on each block.
+        //! A subclass may provide a more efficient implementation.
+        //! @param [in] plain Address of plain text blocks.
+        //! @param [out] cipher Address of buffer for cipher text blocks. Can be the same as @a plain.
+        //! @param [in] count Number of blocks.
+        //! @return True on success, false on error.
+        //!
+        virtual bool encryptBlocksImpl(const void* plain, void* cipher, size_t count);
+
+        //!
+        //! Decrypt several independent blocks of data (implementation of algorithm-specific part).
+        //! The default implementation calls decryptImpl() on each block.
+        //! A subclass may provide a more efficient implementation.
+        //! @param [in] cipher Address of cipher text blocks.
+        //! @param [out] plain Address of buffer for plain text blocks. Can be the same as @a cipher.
+        //! @param [in] count Number of blocks.
+        //! @return True on success, false on error.
+        //!
+        virtual bool decryptBlocksImpl(const void* cipher, void* plain, size_t count);
+
+        //!
+        //! Encrypt several independent messages in place (implementation of algorithm-specific part).
+        //! The default implementation calls encryptInPlaceImpl() on each message.
+        //! A subclass may provide a more efficient implementation.
+        //! @param [in] count Number of messages.
+        //! @param [in] data Array of @a count message addresses.
+        //! @param [in] sizes Array of @a count message sizes in bytes.
+        //! @return True on success, false on error.
+        //!
+        virtual bool encryptInPlaceMultiImpl(size_t count, void* const data[], const size_t sizes[]);
+
+        //!
+        //! Decrypt several independent messages in place (implementation of algorithm-specific part).
+        //! The default implementation calls decryptInPlaceImpl() on each message.
+        //! A subclass may provide a more efficient implementation.
+        //! @param [in] count Number of messages.
+        //! @param [in] data Array of @a count message addresses.
+        //! @param [in] sizes Array of @a count message sizes in bytes.
+        //! @return True on success, false on error.
+        //!
+        virtual bool decryptInPlaceMultiImpl(size_t count, void* const data[], const size_t sizes[]);
+
     private:
         bool      _key_set = false;                   // Current key successfully set.
         int       _cipher_id = 0;                     // Cipher identity (from application).
@@ -303,8 +397,8 @@ namespace ts {
         ByteBlock _current_key{};                     // Current unscheduled key.
         BlockCipherAlertInterface* _alert = nullptr;  // Alert handler.
 
-        // Check if encryption or decryption is allowed. Increment counters.
-        bool allowEncrypt();
-        bool allowDecrypt();
+        // Check if encryption or decryption is allowed for a number of uses. Increment counters.
+        bool allowEncrypt(size_t count = 1);
+        bool allowDecrypt(size_t count = 1);
     };
 }
@@ -54,6 +54,15 @@ namespace ts {
 
         //! @copydoc ts::BlockCipher::decryptImpl()
         virtual bool decryptImpl(const void* cipher, size_t cipher_length, void* plain, size_t plain_maxsize, size_t* plain_length) override;
+
+        //! @copydoc ts::BlockCipher::encryptInPlaceImpl()
+        virtual bool encryptInPlaceImpl(void* data, size_t data_length, size_t* max_actual_length) override;
+
+        //! @copydoc ts::BlockCipher::decryptInPlaceImpl()
+        virtual bool decryptInPlaceImpl(void* data, size_t data_length, size_t* max_actual_length) override;
+
+        //! @copydoc ts::BlockCipher::encryptInPlaceMultiImpl()
+        virtual bool encryptInPlaceMultiImpl(size_t count, void* const data[], const size_t sizes[]) override;
     };
 }
 
@@ -134,7 +143,6 @@ bool ts::CBC<CIPHER>::decryptImpl(const void* cipher, size_t cipher_length, void
 {
     if (this->algo == nullptr ||
         this->iv.size() != this->block_size ||
-        this->work.size() < this->block_size ||
         cipher_length % this->block_size != 0 ||
         plain_maxsize < cipher_length)
     {
@@ -144,26 +152,45 @@ bool ts::CBC<CIPHER>::decryptImpl(const void* cipher, size_t cipher_length, void
         *plain_length = cipher_length;
     }
 
-    const uint8_t* previous = this->iv.data();
-    const uint8_t* ct = reinterpret_cast<const uint8_t*> (cipher);
-    uint8_t* pt = reinterpret_cast<uint8_t*> (plain);
+    // All blocks are independently decrypted and can be processed in batch.
+    return this->decryptCBC(reinterpret_cast<const uint8_t*>(cipher), reinterpret_cast<uint8_t*>(plain), cipher_length / this->block_size, this->iv.data());
+}
+
+
+//----------------------------------------------------------------------------
+// Encryption and decryption in place: the CBC implementation supports
+// identical input and output buffers, no need for an intermediate copy.
+//----------------------------------------------------------------------------
+
+template<class CIPHER>
+bool ts::CBC<CIPHER>::encryptInPlaceImpl(void* data, size_t data_length, size_t* max_actual_length)
+{
+    const size_t maxsize = max_actual_length != nullptr ? *max_actual_length : data_length;
+    return encryptImpl(data, data_length, data, maxsize, max_actual_length);
+}
+
+template<class CIPHER>
+bool ts::CBC<CIPHER>::decryptInPlaceImpl(void* data, size_t data_length, size_t* max_actual_length)
+{
+    const size_t maxsize = max_actual_length != nullptr ? *max_actual_length : data_length;
+    return decryptImpl(data, data_length, data, maxsize, max_actual_length);
+}
 
-    while (cipher_length > 0) {
-        // work = decrypt (cipher-text)
-        if (!this->algo->decrypt(ct, this->block_size, this->work.data(), this->block_size)) {
+
+//----------------------------------------------------------------------------
+// Encryption of several independent messages, interleaving the CBC chains.
+//----------------------------------------------------------------------------
+
+template<class CIPHER>
+bool ts::CBC<CIPHER>::encryptInPlaceMultiImpl(size_t count, void* const data[], const size_t sizes[])
+{
+    if (this->algo == nullptr || this->iv.size() != this->block_size) {
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (sizes[i] % this->block_size != 0) {
             return false;
         }
-        // plain-text = previous-cipher XOR work
-        for (size_t i = 0; i < this->block_size; ++i) {
-            pt[i] = previous[i] ^ this->work[i];
-        }
-        // previous-cipher = cipher-text
-        previous = ct;
-        // advance one block
-        ct += this->block_size;
-        pt += this->block_size;
-        cipher_length -= this->block_size;
     }
-
-    return true;
+    return this->encryptCBCInPlaceMulti(count, data, sizes, this->iv.data());
 }
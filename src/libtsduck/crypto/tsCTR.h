@@ -63,13 +63,16 @@ namespace ts {
         // Implementation of BlockCipher interface.
         virtual bool encryptImpl(const void* plain, size_t plain_length, void* cipher, size_t cipher_maxsize, size_t* cipher_length) override;
         virtual bool decryptImpl(const void* cipher, size_t cipher_length, void* plain, size_t plain_maxsize, size_t* plain_length) override;
+        virtual bool encryptInPlaceImpl(void* data, size_t data_length, size_t* max_actual_length) override;
+        virtual bool decryptInPlaceImpl(void* data, size_t data_length, size_t* max_actual_length) override;
 
     private:
         size_t _counter_bits; // size in bits of the counter part.
 
-        // We need two work blocks.
+        // We need 1 + 2 * BATCH_BLOCKS work blocks.
         // The first one contains the "input block" or counter.
-        // The second one contains the "output block", the encrypted counter.
+        // The next BATCH_BLOCKS ones contain successive values of the counter.
+        // The last BATCH_BLOCKS ones contain the "output blocks", the encrypted counters.
         // This private method increments the counter block.
         bool incrementCounter();
     };
@@ -82,7 +85,7 @@ namespace ts {
 
 template<class CIPHER>
 ts::CTR<CIPHER>::CTR(size_t counter_bits) :
-    CipherChainingTemplate<CIPHER>(1, 1, 2),
+    CipherChainingTemplate<CIPHER>(1, 1, 1 + 2 * CipherChaining::BATCH_BLOCKS),
     _counter_bits(0)
 {
     setCounterBits(counter_bits);
@@ -132,8 +135,8 @@ void ts::CTR<CIPHER>::setCounterBits(size_t counter_bits)
 template<class CIPHER>
 bool ts::CTR<CIPHER>::incrementCounter()
 {
-    // We must have two work blocks.
-    if (this->work.size() < 2 * this->block_size) {
+    // We must have at least the counter block.
+    if (this->work.size() < this->block_size) {
         return false;
     }
 
@@ -159,9 +162,10 @@ bool ts::CTR<CIPHER>::incrementCounter()
 template<class CIPHER>
 bool ts::CTR<CIPHER>::encryptImpl(const void* plain, size_t plain_length, void* cipher, size_t cipher_maxsize, size_t* cipher_length)
 {
+    const size_t batch = CipherChaining::BATCH_BLOCKS;
     if (this->algo == nullptr ||
         this->iv.size() != this->block_size ||
-        this->work.size() < 2 * this->block_size ||
+        this->work.size() < (1 + 2 * batch) * this->block_size ||
         cipher_maxsize < plain_length)
     {
         return false;
@@ -172,28 +176,35 @@ bool ts::CTR<CIPHER>::encryptImpl(const void* plain, size_t plain_length, void*
 
     // work[0] = iv
     std::memcpy(this->work.data(), this->iv.data(), this->block_size);
+    uint8_t* const counters = this->work.data() + this->block_size;
+    uint8_t* const output = counters + batch * this->block_size;
 
-    // Loop on all blocks, including last truncated one.
+    // Loop on all blocks, including last truncated one, by batches of independent blocks.
 
     const uint8_t* pt = reinterpret_cast<const uint8_t*>(plain);
     uint8_t* ct = reinterpret_cast<uint8_t*>(cipher);
 
     while (plain_length > 0) {
-        // work[1] = encrypt(work[0])
-        if (!this->algo->encrypt(this->work.data(), this->block_size, this->work.data() + this->block_size, this->block_size)) {
+        // Number of blocks in this batch.
+        const size_t count = std::min(batch, (plain_length + this->block_size - 1) / this->block_size);
+        // counters[i] = work[0], work[0] += 1
+        for (size_t i = 0; i < count; ++i) {
+            std::memcpy(counters + i * this->block_size, this->work.data(), this->block_size);
+            if (!incrementCounter()) {
+                return false;
+            }
+        }
+        // output = encrypt(counters)
+        if (!this->algo->encryptBlocks(counters, output, count)) {
             return false;
         }
-        // This block size:
-        const size_t size = std::min(plain_length, this->block_size);
-        // cipher-text = plain-text XOR work[1]
+        // This batch size:
+        const size_t size = std::min(plain_length, count * this->block_size);
+        // cipher-text = plain-text XOR output
         for (size_t i = 0; i < size; ++i) {
-            ct[i] = this->work[this->block_size + i] ^ pt[i];
-        }
-        // work[0] += 1
-        if (!incrementCounter()) {
-            return false;
+            ct[i] = output[i] ^ pt[i];
         }
-        // advance one block
+        // advance one batch
         ct += size;
         pt += size;
         plain_length -= size;
@@ -212,3 +223,23 @@ bool ts::CTR<CIPHER>::decryptImpl(const void* cipher, size_t cipher_length, void
     // With CTR, the encryption and decryption are identical operations.
     return this->encryptImpl(cipher, cipher_length, plain, plain_maxsize, plain_length);
 }
+
+
+//----------------------------------------------------------------------------
+// Encryption and decryption in place: the CTR implementation supports
+// identical input and output buffers, no need for an intermediate copy.
+//----------------------------------------------------------------------------
+
+template<class CIPHER>
+bool ts::CTR<CIPHER>::encryptInPlaceImpl(void* data, size_t data_length, size_t* max_actual_length)
+{
+    const size_t maxsize = max_actual_length != nullptr ? *max_actual_length : data_length;
+    return encryptImpl(data, data_length, data, maxsize, max_actual_length);
+}
+
+template<class CIPHER>
+bool ts::CTR<CIPHER>::decryptInPlaceImpl(void* data, size_t data_length, size_t* max_actual_length)
+{
+    const size_t maxsize = max_actual_length != nullptr ? *max_actual_length : data_length;
+    return encryptImpl(data, data_length, data, maxsize, max_actual_length);
+}
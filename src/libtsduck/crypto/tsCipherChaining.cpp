@@ -8,6 +8,10 @@
 
 #include "tsCipherChaining.h"
 
+#if !defined(TS_CXX17)
+constexpr size_t ts::CipherChaining::BATCH_BLOCKS;
+#endif
+
 
 //----------------------------------------------------------------------------
 // Constructor for subclasses
@@ -103,3 +107,114 @@ bool ts::CipherChaining::setIV(const void* iv_data, size_t iv_length)
         return true;
     }
 }
+
+
+//----------------------------------------------------------------------------
+// Encrypt the complete blocks of several messages in CBC mode, in place.
+//----------------------------------------------------------------------------
+
+bool ts::CipherChaining::encryptCBCInPlaceMulti(size_t count, void* const data[], const size_t sizes[], const uint8_t* iv_data)
+{
+    if (algo == nullptr || block_size == 0) {
+        return false;
+    }
+
+    // Work area: BATCH_BLOCKS input blocks, followed by BATCH_BLOCKS output blocks.
+    if (work.size() < 2 * BATCH_BLOCKS * block_size) {
+        work.resize(2 * BATCH_BLOCKS * block_size);
+    }
+    uint8_t* const in = work.data();
+    uint8_t* const out = in + BATCH_BLOCKS * block_size;
+
+    // Process messages by groups of BATCH_BLOCKS, one block of each message at a time.
+    for (size_t first = 0; first < count; first += BATCH_BLOCKS) {
+
+        const size_t lanes = std::min<size_t>(count - first, BATCH_BLOCKS);
+        std::array<uint8_t*, BATCH_BLOCKS> msg {};
+        std::array<const uint8_t*, BATCH_BLOCKS> previous {};
+        std::array<size_t, BATCH_BLOCKS> active {};
+        size_t max_blocks = 0;
+        for (size_t l = 0; l < lanes; ++l) {
+            msg[l] = reinterpret_cast<uint8_t*>(data[first + l]);
+            previous[l] = iv_data;
+            max_blocks = std::max(max_blocks, sizes[first + l] / block_size);
+        }
+
+        for (size_t b = 0; b < max_blocks; ++b) {
+            // Collect the next block of each chain: in = previous-cipher XOR plain-text
+            size_t n = 0;
+            for (size_t l = 0; l < lanes; ++l) {
+                if (b < sizes[first + l] / block_size) {
+                    const uint8_t* pt = msg[l] + b * block_size;
+                    uint8_t* w = in + n * block_size;
+                    for (size_t i = 0; i < block_size; ++i) {
+                        w[i] = previous[l][i] ^ pt[i];
+                    }
+                    active[n++] = l;
+                }
+            }
+            // Encrypt all collected blocks at once.
+            if (!algo->encryptBlocks(in, out, n)) {
+                return false;
+            }
+            // Store cipher blocks in their messages, they become the previous cipher blocks.
+            for (size_t k = 0; k < n; ++k) {
+                const size_t l = active[k];
+                uint8_t* ct = msg[l] + b * block_size;
+                std::memcpy(ct, out + k * block_size, block_size);
+                previous[l] = ct;
+            }
+        }
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Decrypt complete blocks in CBC mode.
+//----------------------------------------------------------------------------
+
+bool ts::CipherChaining::decryptCBC(const uint8_t* cipher, uint8_t* plain, size_t count, const uint8_t* iv_data)
+{
+    if (algo == nullptr || block_size == 0) {
+        return false;
+    }
+
+    // Work area: previous cipher block, saved cipher block, BATCH_BLOCKS decrypted blocks.
+    if (work.size() < (BATCH_BLOCKS + 2) * block_size) {
+        work.resize((BATCH_BLOCKS + 2) * block_size);
+    }
+    uint8_t* const previous = work.data();
+    uint8_t* const saved = previous + block_size;
+    uint8_t* const dec = saved + block_size;
+    std::memcpy(previous, iv_data, block_size);
+
+    while (count > 0) {
+        const size_t n = std::min<size_t>(count, BATCH_BLOCKS);
+        // dec = decrypt (cipher-text), all blocks at once
+        if (!algo->decryptBlocks(cipher, dec, n)) {
+            return false;
+        }
+        // Keep the last cipher block of the batch, it is overwritten when decrypting in place.
+        std::memcpy(saved, cipher + (n - 1) * block_size, block_size);
+        // plain-text = previous-cipher XOR dec. Process blocks backward so that, in place,
+        // a plain block overwrites a cipher block which is no longer needed.
+        for (size_t k = n; k-- > 1; ) {
+            const uint8_t* ct = cipher + (k - 1) * block_size;
+            const uint8_t* w = dec + k * block_size;
+            uint8_t* pt = plain + k * block_size;
+            for (size_t i = 0; i < block_size; ++i) {
+                pt[i] = ct[i] ^ w[i];
+            }
+        }
+        for (size_t i = 0; i < block_size; ++i) {
+            plain[i] = previous[i] ^ dec[i];
+        }
+        std::memcpy(previous, saved, block_size);
+        // advance n blocks
+        cipher += n * block_size;
+        plain += n * block_size;
+        count -= n;
+    }
+    return true;
+}
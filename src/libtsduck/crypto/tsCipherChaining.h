@@ -93,6 +93,39 @@ namespace ts {
 
         // Implementation of BlockCipher interface:
         virtual bool setKeyImpl(const void* key, size_t key_length, size_t rounds) override;
+
+        //!
+        //! Maximum number of independent blocks which are submitted at once to the block cipher.
+        //! Using BlockCipher::encryptBlocks() on several blocks lets accelerated implementations
+        //! pipeline the blocks.
+        //!
+        static constexpr size_t BATCH_BLOCKS = 8;
+
+        //!
+        //! Encrypt the complete blocks of several independent messages in CBC mode, in place.
+        //! The CBC chains are interleaved so that up to BATCH_BLOCKS independent blocks are
+        //! encrypted at a time. Any residue after the last complete block is left unmodified.
+        //! The @a work buffer is resized as necessary and its previous content is lost.
+        //! @param [in] count Number of messages.
+        //! @param [in] data Array of @a count message addresses.
+        //! @param [in] sizes Array of @a count message sizes in bytes.
+        //! @param [in] iv_data Address of the IV of all chains (one block).
+        //! @return True on success, false on error.
+        //!
+        bool encryptCBCInPlaceMulti(size_t count, void* const data[], const size_t sizes[], const uint8_t* iv_data);
+
+        //!
+        //! Decrypt complete blocks in CBC mode.
+        //! CBC decryption has no dependency between blocks: up to BATCH_BLOCKS blocks are decrypted at a time.
+        //! The @a work buffer is resized as necessary. On return, its first block contains the last
+        //! cipher block (or the IV when @a count is zero).
+        //! @param [in] cipher Address of cipher text.
+        //! @param [out] plain Address of plain text. Can be the same as @a cipher (decryption in place).
+        //! @param [in] count Number of blocks.
+        //! @param [in] iv_data Address of the IV (one block).
+        //! @return True on success, false on error.
+        //!
+        bool decryptCBC(const uint8_t* cipher, uint8_t* plain, size_t count, const uint8_t* iv_data);
     };
 
     //!
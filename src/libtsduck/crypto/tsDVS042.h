@@ -82,6 +82,15 @@ namespace ts {
         //! @copydoc ts::BlockCipher::decryptImpl()
         virtual bool decryptImpl(const void* cipher, size_t cipher_length, void* plain, size_t plain_maxsize,                              size_t* plain_length) override;
 
+        //! @copydoc ts::BlockCipher::encryptInPlaceImpl()
+        virtual bool encryptInPlaceImpl(void* data, size_t data_length, size_t* max_actual_length) override;
+
+        //! @copydoc ts::BlockCipher::decryptInPlaceImpl()
+        virtual bool decryptInPlaceImpl(void* data, size_t data_length, size_t* max_actual_length) override;
+
+        //! @copydoc ts::BlockCipher::encryptInPlaceMultiImpl()
+        virtual bool encryptInPlaceMultiImpl(size_t count, void* const data[], const size_t sizes[]) override;
+
     protected:
         ByteBlock shortIV;  //!< Current initialization vector for short blocks.
     };
@@ -232,39 +241,98 @@ bool ts::DVS042<CIPHER>::decryptImpl(const void* cipher, size_t cipher_length, v
         *plain_length = cipher_length;
     }
 
-    // Select IV depending on block size.
-    const uint8_t* previous = cipher_length < this->block_size ? this->shortIV.data() : this->iv.data();
-
-    // Decrypt all blocks in CBC mode, except the last one if partial
+    // Decrypt all blocks in CBC mode, except the last one if partial.
+    // On return, the first work block contains the last cipher block or the IV.
     const uint8_t* ct = reinterpret_cast<const uint8_t*>(cipher);
     uint8_t* pt = reinterpret_cast<uint8_t*>(plain);
-
-    while (cipher_length >= this->block_size) {
-        // work = decrypt (cipher-text)
-        if (!this->algo->decrypt(ct, this->block_size, this->work.data(), this->block_size)) {
-            return false;
-        }
-        // plain-text = previous-cipher XOR work
-        for (size_t i = 0; i < this->block_size; ++i) {
-            pt[i] = previous[i] ^ this->work[i];
-        }
-        // previous-cipher = cipher-text
-        previous = ct;
-        // advance one block
-        ct += this->block_size;
-        pt += this->block_size;
-        cipher_length -= this->block_size;
+    const size_t count = cipher_length / this->block_size;
+    if (!this->decryptCBC(ct, pt, count, cipher_length < this->block_size ? this->shortIV.data() : this->iv.data())) {
+        return false;
     }
+    ct += count * this->block_size;
+    pt += count * this->block_size;
+    cipher_length -= count * this->block_size;
 
     // Process final block if incomplete
     if (cipher_length > 0) {
-        // work = encrypt (Cn-1), which is encrypt (shortIV) for short packets
-        if (!this->algo->encrypt(previous, this->block_size, this->work.data(), this->block_size)) {
+        // work[1] = encrypt (Cn-1), which is encrypt (shortIV) for short packets
+        uint8_t* const previous = this->work.data();
+        uint8_t* const mask = previous + this->block_size;
+        if (!this->algo->encrypt(previous, this->block_size, mask, this->block_size)) {
             return false;
         }
-        // Pn = work XOR Cn, truncated
+        // Pn = work[1] XOR Cn, truncated
         for (size_t i = 0; i < cipher_length; ++i) {
-            pt[i] = this->work[i] ^ ct[i];
+            pt[i] = mask[i] ^ ct[i];
+        }
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Encryption and decryption in place: the DVS 042 implementation supports
+// identical input and output buffers, no need for an intermediate copy.
+//----------------------------------------------------------------------------
+
+template<class CIPHER>
+bool ts::DVS042<CIPHER>::encryptInPlaceImpl(void* data, size_t data_length, size_t* max_actual_length)
+{
+    const size_t maxsize = max_actual_length != nullptr ? *max_actual_length : data_length;
+    return encryptImpl(data, data_length, data, maxsize, max_actual_length);
+}
+
+template<class CIPHER>
+bool ts::DVS042<CIPHER>::decryptInPlaceImpl(void* data, size_t data_length, size_t* max_actual_length)
+{
+    const size_t maxsize = max_actual_length != nullptr ? *max_actual_length : data_length;
+    return decryptImpl(data, data_length, data, maxsize, max_actual_length);
+}
+
+
+//----------------------------------------------------------------------------
+// Encryption of several independent messages, interleaving the CBC chains.
+//----------------------------------------------------------------------------
+
+template<class CIPHER>
+bool ts::DVS042<CIPHER>::encryptInPlaceMultiImpl(size_t count, void* const data[], const size_t sizes[])
+{
+    if (this->algo == nullptr || this->iv.size() != this->block_size || this->shortIV.size() != this->block_size) {
+        return false;
+    }
+
+    // Encrypt all complete blocks of all messages in CBC mode.
+    if (!this->encryptCBCInPlaceMulti(count, data, sizes, this->iv.data())) {
+        return false;
+    }
+
+    // Process the final incomplete blocks by batches. The work buffer is already large enough.
+    const size_t bsize = this->block_size;
+    uint8_t* const in = this->work.data();
+    uint8_t* const out = in + CipherChaining::BATCH_BLOCKS * bsize;
+    std::array<size_t, CipherChaining::BATCH_BLOCKS> pending {};
+    size_t n = 0;
+
+    for (size_t msg = 0; msg < count || n > 0; ++msg) {
+        if (msg < count && sizes[msg] % bsize != 0) {
+            // in[n] = Cn-1, which is shortIV for short packets
+            uint8_t* const last = reinterpret_cast<uint8_t*>(data[msg]) + sizes[msg] - sizes[msg] % bsize;
+            std::memcpy(in + n * bsize, sizes[msg] < bsize ? this->shortIV.data() : last - bsize, bsize);
+            pending[n++] = msg;
+        }
+        if (n > 0 && (n == CipherChaining::BATCH_BLOCKS || msg + 1 >= count)) {
+            // out = encrypt (in), Cn = out XOR Pn, truncated
+            if (!this->algo->encryptBlocks(in, out, n)) {
+                return false;
+            }
+            for (size_t k = 0; k < n; ++k) {
+                const size_t residue = sizes[pending[k]] % bsize;
+                uint8_t* const last = reinterpret_cast<uint8_t*>(data[pending[k]]) + sizes[pending[k]] - residue;
+                for (size_t i = 0; i < residue; ++i) {
+                    last[i] ^= out[k * bsize + i];
+                }
+            }
+            n = 0;
         }
     }
     return true;
@@ -1639,6 +1639,11 @@ void ts::TSAnalyzer::recomputeStatistics()
             pc.crypto_period = pc.cryptop_ts_cnt / (pc.cryptop_cnt - 1);
         }
 
+        // Video parameters changes in AVC/HEVC PID's.
+        if (pc.carry_video) {
+            _pes_demux.getSPSCacheStatistics(pc.pid, pc.sps_cache_hits, pc.sps_cache_misses);
+        }
+
         // If the PID belongs to some services, update services info.
         for (auto& it : pc.services) {
             ServiceContextPtr scp(getService(it));
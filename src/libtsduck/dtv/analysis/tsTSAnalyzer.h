@@ -333,6 +333,8 @@ namespace ts {
             uint64_t      pcr_leap_cnt = 0;        //!< Number of leaps in PCR's (potential time discontinuities).
             uint64_t      pts_leap_cnt = 0;        //!< Number of leaps in PTS's (potential time discontinuities).
             uint64_t      dts_leap_cnt = 0;        //!< Number of leaps in DTS's (potential time discontinuities).
+            uint64_t      sps_cache_hits = 0;      //!< Number of AVC/HEVC SPS which were identical to the previous one.
+            uint64_t      sps_cache_misses = 0;    //!< Number of new or modified AVC/HEVC SPS.
             BitRate       ts_pcr_bitrate = 0;      //!< Average TS bitrate in b/s (eval from PCR).
             BitRate       bitrate = 0;             //!< Average PID bitrate in b/s.
             uint16_t      cas_id = 0;              //!< For EMM and ECM streams.
@@ -1261,6 +1261,10 @@ void ts::TSAnalyzerReport::reportJSON(TSAnalyzerOptions& opt, std::ostream& stm,
         if (pc.carry_pes) {
             jv.add(u"pes", pc.pl_start_cnt);
             jv.add(u"invalid-pes-prefix", pc.inv_pes_start);
+            if (pc.sps_cache_misses > 0) {
+                jv.query(u"sps-cache", true).add(u"hits", pc.sps_cache_hits);
+                jv.query(u"sps-cache", true).add(u"misses", pc.sps_cache_misses);
+            }
         }
         else {
             jv.add(u"unit-start", pc.unit_start_cnt);
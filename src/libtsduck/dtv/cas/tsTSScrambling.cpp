@@ -395,6 +395,12 @@ void ts::TSScrambling::rewindFixedCW()
     _decrypt_scv = SC_CLEAR;
 }
 
+void ts::TSScrambling::clearFixedCW()
+{
+    _cw_list.clear();
+    rewindFixedCW();
+}
+
 
 //----------------------------------------------------------------------------
 // Set the next fixed control word as scrambling key.
@@ -442,6 +448,21 @@ bool ts::TSScrambling::setCW(const ByteBlock& cw, int parity)
 }
 
 
+//----------------------------------------------------------------------------
+// Get the control word which is currently used for a parity.
+//----------------------------------------------------------------------------
+
+bool ts::TSScrambling::getCW(ByteBlock& cw, int parity) const
+{
+    const CipherChaining* algo = _scrambler[parity & 1];
+    if (algo == nullptr || !algo->getKey(cw)) {
+        cw.clear();
+        return false;
+    }
+    return true;
+}
+
+
 //----------------------------------------------------------------------------
 // Set the parity of all subsequent encryptions.
 //----------------------------------------------------------------------------
@@ -504,6 +525,21 @@ bool ts::TSScrambling::encrypt(TSPacket& pkt)
 }
 
 
+//----------------------------------------------------------------------------
+// Set the parity of the next decryptions.
+//----------------------------------------------------------------------------
+
+bool ts::TSScrambling::setDecryptParity(uint8_t scv)
+{
+    // Update current parity.
+    const uint8_t previous_scv = _decrypt_scv;
+    _decrypt_scv = scv;
+
+    // In case of fixed control word, use next key when the scrambling control changes.
+    return !hasFixedCW() || previous_scv == _decrypt_scv || setNextFixedCW(_decrypt_scv);
+}
+
+
 //----------------------------------------------------------------------------
 // Decrypt a TS packet with the CW corresponding to the parity in the packet.
 //----------------------------------------------------------------------------
@@ -517,11 +553,7 @@ bool ts::TSScrambling::decrypt(TSPacket& pkt)
     }
 
     // Update current parity.
-    const uint8_t previous_scv = _decrypt_scv;
-    _decrypt_scv = scv;
-
-    // In case of fixed control word, use next key when the scrambling control changes.
-    if (hasFixedCW() && previous_scv != _decrypt_scv && !setNextFixedCW(_decrypt_scv)) {
+    if (!setDecryptParity(scv)) {
         return false;
     }
 
@@ -547,3 +579,148 @@ bool ts::TSScrambling::decrypt(TSPacket& pkt)
     }
     return ok;
 }
+
+
+//----------------------------------------------------------------------------
+// Size of the part of the payload which is scrambled by an algorithm.
+//----------------------------------------------------------------------------
+
+size_t ts::TSScrambling::ScrambledSize(const CipherChaining* algo, const TSPacket& pkt)
+{
+    size_t psize = pkt.getPayloadSize();
+    if (!algo->residueAllowed()) {
+        // Remove the residue from the payload.
+        assert(algo->blockSize() != 0);
+        psize -= psize % algo->blockSize();
+    }
+    return psize;
+}
+
+
+//----------------------------------------------------------------------------
+// Encrypt a batch of TS packets with the current parity and corresponding CW.
+//----------------------------------------------------------------------------
+
+bool ts::TSScrambling::encrypt(TSPacket* pkt, size_t count)
+{
+    _batch_input.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        _batch_input[i] = pkt + i;
+    }
+    return encrypt(_batch_input.data(), count);
+}
+
+bool ts::TSScrambling::encrypt(TSPacket* const* pkt, size_t count)
+{
+    // Collect packets with payload, filter out encrypted packets.
+    _batch_packets.clear();
+    for (size_t i = 0; i < count; ++i) {
+        if (pkt[i]->isScrambled()) {
+            _report.error(u"try to scramble an already scrambled packet");
+            return false;
+        }
+        if (pkt[i]->hasPayload()) {
+            _batch_packets.push_back(pkt[i]);
+        }
+    }
+    if (_batch_packets.empty()) {
+        return true;
+    }
+
+    // If no current parity is set, start with even by default.
+    if (_encrypt_scv == SC_CLEAR && !setEncryptParity(SC_EVEN_KEY)) {
+        return false;
+    }
+
+    // Select scrambling algo.
+    assert(_encrypt_scv == SC_EVEN_KEY || _encrypt_scv == SC_ODD_KEY);
+    CipherChaining* algo = _scrambler[_encrypt_scv & 1];
+    assert(algo != nullptr);
+
+    // Collect the part of the payloads to scramble.
+    _batch_data.clear();
+    _batch_sizes.clear();
+    for (auto p : _batch_packets) {
+        const size_t psize = ScrambledSize(algo, *p);
+        if (psize > 0) {
+            _batch_data.push_back(p->getPayload());
+            _batch_sizes.push_back(psize);
+        }
+    }
+
+    // Encrypt all packets at once.
+    if (!algo->encryptInPlaceMulti(_batch_data.size(), _batch_data.data(), _batch_sizes.data())) {
+        _report.error(u"packet encryption error using %s", {algo->name()});
+        return false;
+    }
+    for (auto p : _batch_packets) {
+        p->setScrambling(_encrypt_scv);
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Decrypt a batch of TS packets.
+//----------------------------------------------------------------------------
+
+bool ts::TSScrambling::decrypt(TSPacket* pkt, size_t count)
+{
+    _batch_input.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        _batch_input[i] = pkt + i;
+    }
+    return decrypt(_batch_input.data(), count);
+}
+
+bool ts::TSScrambling::decrypt(TSPacket* const* pkt, size_t count)
+{
+    size_t next = 0;
+    while (next < count) {
+
+        // Clear or invalid packets are silently accepted.
+        const uint8_t scv = pkt[next]->getScrambling();
+        if (scv != SC_EVEN_KEY && scv != SC_ODD_KEY) {
+            ++next;
+            continue;
+        }
+
+        // Update current parity.
+        if (!setDecryptParity(scv)) {
+            return false;
+        }
+
+        // Select descrambling algo.
+        CipherChaining* algo = _scrambler[_decrypt_scv & 1];
+        assert(algo != nullptr);
+
+        // Collect all packets until the next parity change.
+        _batch_packets.clear();
+        _batch_data.clear();
+        _batch_sizes.clear();
+        for (; next < count; ++next) {
+            const uint8_t pscv = pkt[next]->getScrambling();
+            if (pscv == scv) {
+                const size_t psize = ScrambledSize(algo, *pkt[next]);
+                if (psize > 0) {
+                    _batch_data.push_back(pkt[next]->getPayload());
+                    _batch_sizes.push_back(psize);
+                }
+                _batch_packets.push_back(pkt[next]);
+            }
+            else if (pscv == SC_EVEN_KEY || pscv == SC_ODD_KEY) {
+                break;
+            }
+        }
+
+        // Decrypt all packets with that parity at once.
+        if (!algo->decryptInPlaceMulti(_batch_data.size(), _batch_data.data(), _batch_sizes.data())) {
+            _report.error(u"packet decryption error using %s", {algo->name()});
+            return false;
+        }
+        for (auto p : _batch_packets) {
+            p->setScrambling(SC_CLEAR);
+        }
+    }
+    return true;
+}
@@ -102,6 +102,13 @@ namespace ts {
         //!
         void rewindFixedCW();
 
+        //!
+        //! Forget the fixed control words from the command line.
+        //! Used when the control words are managed externally, for instance in a
+        //! copy of this object which is used by another thread.
+        //!
+        void clearFixedCW();
+
         //!
         //! Get the scrambling algorithm name.
         //! @return The scrambling algorithm name.
@@ -177,6 +184,23 @@ namespace ts {
         //!
         bool setEncryptParity(int parity);
 
+        //!
+        //! Get the control word which is currently used for a parity.
+        //! @param [out] cw The current control word.
+        //! @param [in] parity Use the parity of this integer value (odd or even).
+        //! @return True on success, false if no control word is set for this parity.
+        //!
+        bool getCW(ByteBlock& cw, int parity) const;
+
+        //!
+        //! Set the parity of the next decryptions, as found in a scrambling_control value.
+        //! This is automatically done by decrypt(). In case of fixed control words, the
+        //! next key is used when the parity changes.
+        //! @param [in] scv Scrambling control value, SC_EVEN_KEY or SC_ODD_KEY.
+        //! @return True on success, false on error (error setting next fixed CW, if any).
+        //!
+        bool setDecryptParity(uint8_t scv);
+
         //!
         //! Encrypt a TS packet with the current parity and corresponding CW.
         //! @param [in,out] pkt The packet to encrypt.
@@ -191,6 +215,46 @@ namespace ts {
         //!
         bool decrypt(TSPacket& pkt);
 
+        //!
+        //! Encrypt a batch of TS packets with the current parity and corresponding CW.
+        //! The packets are processed together, allowing the interleaving of independent
+        //! cipher chains (DVB-CISSA, ATIS-IDSA, AES-CBC) and the pipelining of AES blocks.
+        //! Packets without payload are left unmodified.
+        //! @param [in,out] pkt Address of an array of packets to encrypt.
+        //! @param [in] count Number of packets.
+        //! @return True on success, false on error. An already encrypted packet is an error
+        //! and, in that case, no packet is encrypted.
+        //!
+        bool encrypt(TSPacket* pkt, size_t count);
+
+        //!
+        //! Encrypt a batch of TS packets with the current parity and corresponding CW.
+        //! Same as the previous method with non-contiguous packets.
+        //! @param [in,out] pkt Address of an array of addresses of packets to encrypt.
+        //! @param [in] count Number of packets.
+        //! @return True on success, false on error. An already encrypted packet is an error
+        //! and, in that case, no packet is encrypted.
+        //!
+        bool encrypt(TSPacket* const* pkt, size_t count);
+
+        //!
+        //! Decrypt a batch of TS packets with the CW corresponding to the parity in each packet.
+        //! Consecutive packets with the same parity are processed together.
+        //! @param [in,out] pkt Address of an array of packets to decrypt.
+        //! @param [in] count Number of packets.
+        //! @return True on success, false on error. Clear packets are not an error.
+        //!
+        bool decrypt(TSPacket* pkt, size_t count);
+
+        //!
+        //! Decrypt a batch of TS packets with the CW corresponding to the parity in each packet.
+        //! Same as the previous method with non-contiguous packets.
+        //! @param [in,out] pkt Address of an array of addresses of packets to decrypt.
+        //! @param [in] count Number of packets.
+        //! @return True on success, false on error. Clear packets are not an error.
+        //!
+        bool decrypt(TSPacket* const* pkt, size_t count);
+
     private:
         // List of control words
         typedef std::list<ByteBlock> CWList;
@@ -210,6 +274,13 @@ namespace ts {
         CBC<AES>         _aescbc[2] {};
         CTR<AES>         _aesctr[2] {};
         CipherChaining*  _scrambler[2] {nullptr, nullptr};
+        std::vector<TSPacket*> _batch_input {};    // Batch processing: addresses of contiguous input packets.
+        std::vector<TSPacket*> _batch_packets {};  // Batch processing: packets in the batch.
+        std::vector<void*>     _batch_data {};     // Batch processing: addresses of data to process.
+        std::vector<size_t>    _batch_sizes {};    // Batch processing: sizes of data to process.
+
+        // Size of the part of the payload which is scrambled by an algorithm.
+        static size_t ScrambledSize(const CipherChaining* algo, const TSPacket& pkt);
 
         // Set the next fixed control word as scrambling key.
         bool setNextFixedCW(int parity);
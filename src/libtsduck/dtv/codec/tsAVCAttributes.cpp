@@ -8,6 +8,7 @@
 
 #include "tsAVCAttributes.h"
 #include "tsAVCSequenceParameterSet.h"
+#include "tsAVC.h"
 #include "tsNamesFile.h"
 
 
@@ -60,7 +61,20 @@ ts::UString ts::AVCAttributes::chromaFormatName() const
 
 bool ts::AVCAttributes::moreBinaryData(const uint8_t* data, size_t size)
 {
-    // Parse AVC access unit. We are interested in "sequence parameter set" only.
+    // We are interested in "sequence parameter set" only. Filter other access units without parsing.
+    if (data == nullptr || size == 0 || (data[0] & 0x1F) != AVC_AUT_SEQPARAMS) {
+        return false;
+    }
+
+    // The same SPS is usually repeated several times per second. Don't parse it again.
+    if (_last_sps.size() == size && std::memcmp(_last_sps.data(), data, size) == 0) {
+        _sps_hits++;
+        return false;
+    }
+    _sps_misses++;
+    _last_sps.copy(data, size);
+
+    // Parse AVC access unit.
     AVCSequenceParameterSet params(data, size);
 
     if (!params.valid) {
@@ -97,9 +97,8 @@ bool ts::AccessUnitIterator::next()
         return false;
     }
 
-    // Memory patterns which are used between access units.
-    static const uint8_t Zero3[] = {0x00, 0x00, 0x00};
-    static const uint8_t StartCodePrefix[] = {0x00, 0x00, 0x01};
+    // Size of the memory patterns which are used between access units: 00 00 01 or 00 00 00.
+    constexpr size_t prefix_size = 3;
 
     // Remaining size in data area.
     assert(_nalunit >= _data);
@@ -115,7 +114,7 @@ bool ts::AccessUnitIterator::next()
     // Locate next access unit: starts with 00 00 01.
     // The start code prefix 00 00 01 is not part of the NALunit.
     // The NALunit starts at the NALunit type byte (see H.264, 7.3.1).
-    const uint8_t* const p1 = LocatePattern(_nalunit, remain, StartCodePrefix, sizeof(StartCodePrefix));
+    const uint8_t* const p1 = LocateZeroZero(_nalunit, remain, 0x01);
     if (p1 == nullptr) {
         // No next access unit.
         _nalunit = nullptr;
@@ -124,12 +123,13 @@ bool ts::AccessUnitIterator::next()
     }
 
     // Jump to first byte of NALunit.
-    remain -= p1 - _nalunit + sizeof(StartCodePrefix);
-    _nalunit = p1 + sizeof(StartCodePrefix);
+    remain -= p1 - _nalunit + prefix_size;
+    _nalunit = p1 + prefix_size;
 
     // Locate end of access unit: ends with 00 00 00, 00 00 01 or end of data.
-    const uint8_t* const p2 = LocatePattern(_nalunit, remain, StartCodePrefix, sizeof(StartCodePrefix));
-    const uint8_t* const p3 = LocatePattern(_nalunit, remain, Zero3, sizeof(Zero3));
+    // A 00 00 00 pattern is searched only before the next 00 00 01 since the first one wins.
+    const uint8_t* const p2 = LocateZeroZero(_nalunit, remain, 0x01);
+    const uint8_t* const p3 = LocateZeroZero(_nalunit, p2 == nullptr ? remain : std::min<size_t>(remain, p2 - _nalunit + prefix_size - 1), 0x00);
     if (p2 == nullptr && p3 == nullptr) {
         // No 00 00 01, no 00 00 00, the NALunit extends up to the end of data.
         _nalunit_size = remain;
@@ -8,6 +8,7 @@
 
 #include "tsHEVCAttributes.h"
 #include "tsHEVCSequenceParameterSet.h"
+#include "tsHEVC.h"
 #include "tsNamesFile.h"
 
 
@@ -60,7 +61,20 @@ ts::UString ts::HEVCAttributes::chromaFormatName() const
 
 bool ts::HEVCAttributes::moreBinaryData(const uint8_t* data, size_t size)
 {
-    // Parse HEVC access unit. We are interested in "sequence parameter set" only.
+    // We are interested in "sequence parameter set" only. Filter other access units without parsing.
+    if (data == nullptr || size == 0 || ((data[0] >> 1) & 0x3F) != HEVC_AUT_SPS_NUT) {
+        return false;
+    }
+
+    // The same SPS is usually repeated several times per second. Don't parse it again.
+    if (_last_sps.size() == size && std::memcmp(_last_sps.data(), data, size) == 0) {
+        _sps_hits++;
+        return false;
+    }
+    _sps_misses++;
+    _last_sps.copy(data, size);
+
+    // Parse HEVC access unit.
     HEVCSequenceParameterSet params(data, size);
 
     if (!params.valid) {
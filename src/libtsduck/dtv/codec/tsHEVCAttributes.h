@@ -13,6 +13,7 @@
 
 #pragma once
 #include "tsAbstractAudioVideoAttributes.h"
+#include "tsByteBlock.h"
 
 namespace ts {
     //!
@@ -24,6 +25,10 @@ namespace ts {
     //! "sequence parameter set" NALunit. Initially, an HEVCAttributes object
     //! is invalid.
     //!
+    //! The last "sequence parameter set" is kept. When the same SPS is repeated,
+    //! which is the usual case, it is not parsed again. The numbers of reused and
+    //! parsed SPS are available to detect streams with changing parameters.
+    //!
     class TSDUCKDLL HEVCAttributes: public AbstractAudioVideoAttributes
     {
     public:
@@ -85,11 +90,26 @@ namespace ts {
         //!
         UString chromaFormatName() const;
 
+        //!
+        //! Get the number of "sequence parameter set" which were identical to the previous one and not parsed again.
+        //! @return The number of reused SPS.
+        //!
+        uint64_t spsCacheHits() const { return _sps_hits; }
+
+        //!
+        //! Get the number of "sequence parameter set" which were new or modified and were parsed.
+        //! @return The number of parsed SPS.
+        //!
+        uint64_t spsCacheMisses() const { return _sps_misses; }
+
     private:
-        size_t  _hsize = 0;    // Horizontal size in pixel
-        size_t  _vsize = 0;    // Vertical size in pixel
-        int     _profile = 0;  // HEVC profile
-        int     _level = 0;    // HEVC level
-        uint8_t _chroma = 0;   // Chroma format code (CHROMA_* from tsMPEG.h)
+        size_t    _hsize = 0;      // Horizontal size in pixel
+        size_t    _vsize = 0;      // Vertical size in pixel
+        int       _profile = 0;    // HEVC profile
+        int       _level = 0;      // HEVC level
+        uint8_t   _chroma = 0;     // Chroma format code (CHROMA_* from tsMPEG.h)
+        ByteBlock _last_sps {};    // Last parsed SPS NALunit
+        uint64_t  _sps_hits = 0;   // Number of SPS identical to _last_sps
+        uint64_t  _sps_misses = 0; // Number of parsed SPS
     };
 }
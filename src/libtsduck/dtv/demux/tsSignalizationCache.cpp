@@ -0,0 +1,163 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+
+#include "tsSignalizationCache.h"
+#include "tsGuardMutex.h"
+
+TS_DEFINE_SINGLETON(ts::SignalizationCache);
+
+#if !defined(TS_CXX17)
+constexpr size_t ts::SignalizationCache::DEFAULT_MAX_TABLES;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Constructor.
+//----------------------------------------------------------------------------
+
+ts::SignalizationCache::SignalizationCache()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Accessors and configuration.
+//----------------------------------------------------------------------------
+
+void ts::SignalizationCache::setMaxTables(size_t count)
+{
+    GuardMutex lock(_mutex);
+    _max_tables = count;
+    shrink(_max_tables);
+}
+
+size_t ts::SignalizationCache::maxTables() const
+{
+    GuardMutex lock(_mutex);
+    return _max_tables;
+}
+
+size_t ts::SignalizationCache::tableCount() const
+{
+    GuardMutex lock(_mutex);
+    return _entries.size();
+}
+
+uint64_t ts::SignalizationCache::hitCount() const
+{
+    GuardMutex lock(_mutex);
+    return _hits;
+}
+
+uint64_t ts::SignalizationCache::missCount() const
+{
+    GuardMutex lock(_mutex);
+    return _misses;
+}
+
+void ts::SignalizationCache::clear()
+{
+    GuardMutex lock(_mutex);
+    _lru.clear();
+    _entries.clear();
+}
+
+
+//----------------------------------------------------------------------------
+// Remove least recently used entries. Must be called under the lock.
+//----------------------------------------------------------------------------
+
+void ts::SignalizationCache::shrink(size_t max_count)
+{
+    while (_entries.size() > max_count) {
+        const ByteBlock* const oldest = _lru.back();
+        _lru.pop_back();
+        _entries.erase(*oldest);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Build the lookup key of a table.
+//----------------------------------------------------------------------------
+
+void ts::SignalizationCache::BuildKey(ByteBlock& key, const DuckContext& duck, const BinaryTable& table)
+{
+    // The key is made of the DuckContext properties which influence the
+    // deserialization, the table identification and the CRC32 of all sections.
+    // Since the CRC32 may collide, the full content is checked on lookup.
+    const size_t count = table.sectionCount();
+    key.clear();
+    key.reserve(32 + 6 * count);
+    key.appendUInt64(uint64_t(reinterpret_cast<uintptr_t>(duck.charsetIn())));
+    key.appendUInt16(uint16_t(duck.standards()));
+    key.appendUInt64(uint64_t(duck.timeReferenceOffset()));
+    key.appendUInt32(duck.actualPDS(0));
+    key.appendUInt8(table.tableId());
+    key.appendUInt16(table.tableIdExtension());
+    key.appendUInt8(table.version());
+    for (size_t i = 0; i < count; ++i) {
+        const SectionPtr& sect(table.sectionAt(i));
+        const size_t size = sect->size();
+        key.appendUInt16(uint16_t(size));
+        if (size >= 4) {
+            key.append(sect->content() + size - 4, 4);
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Search a table in the cache.
+//----------------------------------------------------------------------------
+
+ts::SignalizationCache::TablePtr ts::SignalizationCache::search(const ByteBlock& key, const BinaryTable& table)
+{
+    GuardMutex lock(_mutex);
+    const auto it = _entries.find(key);
+    if (it != _entries.end() && it->second.binary == table) {
+        _hits++;
+        _lru.splice(_lru.begin(), _lru, it->second.use);
+        return it->second.table;
+    }
+    else {
+        _misses++;
+        return TablePtr();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Insert a new deserialized table in the cache.
+//----------------------------------------------------------------------------
+
+void ts::SignalizationCache::insert(const ByteBlock& key, const BinaryTable& table, const TablePtr& ptr)
+{
+    // Build a private copy of the binary table outside the lock.
+    BinaryTable binary;
+    binary.copy(table);
+
+    GuardMutex lock(_mutex);
+    if (_max_tables == 0) {
+        return;
+    }
+
+    auto it = _entries.find(key);
+    if (it == _entries.end()) {
+        // Make room for the new table when the cache is full.
+        shrink(_max_tables - 1);
+        it = _entries.emplace(key, Entry()).first;
+        _lru.push_front(&it->first);
+        it->second.use = _lru.begin();
+    }
+    else {
+        _lru.splice(_lru.begin(), _lru, it->second.use);
+    }
+    it->second.binary = std::move(binary);
+    it->second.table = ptr;
+}
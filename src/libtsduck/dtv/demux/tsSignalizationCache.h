@@ -0,0 +1,189 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  A process-wide cache of deserialized signalization tables.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsAbstractTable.h"
+#include "tsBinaryTable.h"
+#include "tsDuckContext.h"
+#include "tsByteBlock.h"
+#include "tsSingleton.h"
+#include "tsSafePtr.h"
+#include "tsMutex.h"
+
+namespace ts {
+    //!
+    //! A process-wide cache of deserialized signalization tables.
+    //!
+    //! In a processing chain such as tsp, several plugins typically run their own
+    //! SignalizationDemux on the same stream. Each of them receives the same PAT,
+    //! PMT, SDT, NIT, etc. and deserializes them independently, at each repetition.
+    //! Complex tables (large NIT or SDT, PSIP VCT) are expensive to deserialize.
+    //!
+    //! This cache keeps the last deserialized instances of long tables, indexed by
+    //! their binary content and by the properties of the DuckContext which may affect
+    //! the deserialization (default character set, standards, time reference, PDS).
+    //! The cached tables are constant and shared by all users, in all threads. They are
+    //! marked as shared (see AbstractTable::isShared()): a user who needs to modify a table
+    //! makes a copy of it, and this copy gets its own private descriptors.
+    //!
+    //! Deserializing a table adds its defining standards in the DuckContext. This side effect
+    //! is replayed when a table is found in the cache, so that the context evolves the same way,
+    //! with or without cache.
+    //!
+    //! The cache is disabled by default (the maximum number of tables is zero).
+    //! An application enables it using setMaxTables(). In tsp, use option
+    //! @c --signalization-cache.
+    //!
+    //! This class is a singleton. Use static Instance() method to access the single instance.
+    //! All methods are thread-safe.
+    //!
+    //! @ingroup mpeg
+    //!
+    class TSDUCKDLL SignalizationCache
+    {
+        TS_DECLARE_SINGLETON(SignalizationCache);
+    public:
+        //!
+        //! Safe pointer to a constant deserialized table (thread-safe).
+        //!
+        typedef SafePtr<const AbstractTable, Mutex> TablePtr;
+
+        //!
+        //! Default maximum number of tables in the cache (the cache is disabled by default).
+        //!
+        static constexpr size_t DEFAULT_MAX_TABLES = 0;
+
+        //!
+        //! Get a deserialized table from the cache or deserialize it.
+        //! Short sections, such as TDT or TOT, are never cached since their content
+        //! changes all the time. They are always deserialized.
+        //! @tparam TABLE A subclass of AbstractTable.
+        //! @param [in,out] duck TSDuck execution context. The standards of the table are added
+        //! in the context, as if the table was deserialized.
+        //! @param [in] table The binary table to deserialize.
+        //! @param [out] holder Receives a safe pointer to the deserialized table. When the table
+        //! is cached, this instance is shared with the cache and other users and shall not be modified.
+        //! The returned table remains valid as long as @a holder is not modified.
+        //! @return A constant reference to the deserialized table. The table may be
+        //! invalid if the binary table was invalid.
+        //!
+        template <class TABLE, typename std::enable_if<std::is_base_of<AbstractTable, TABLE>::value>::type* = nullptr>
+        const TABLE& getTable(DuckContext& duck, const BinaryTable& table, TablePtr& holder);
+
+        //!
+        //! Set the maximum number of tables in the cache.
+        //! @param [in] count Maximum number of tables in the cache. When zero, the cache is disabled.
+        //!
+        void setMaxTables(size_t count);
+
+        //!
+        //! Get the maximum number of tables in the cache.
+        //! @return The maximum number of tables in the cache.
+        //!
+        size_t maxTables() const;
+
+        //!
+        //! Get the current number of tables in the cache.
+        //! @return The current number of tables in the cache.
+        //!
+        size_t tableCount() const;
+
+        //!
+        //! Get the number of successful lookups in the cache since the start of the application.
+        //! @return The number of successful lookups.
+        //!
+        uint64_t hitCount() const;
+
+        //!
+        //! Get the number of failed lookups in the cache since the start of the application.
+        //! @return The number of failed lookups.
+        //!
+        uint64_t missCount() const;
+
+        //!
+        //! Remove all tables from the cache.
+        //!
+        void clear();
+
+    private:
+        // Description of a cached table. The key is a fingerprint of the binary table
+        // and the context, the binary table is used to check the full content.
+        // The list of keys is ordered from the most recently used to the least recently used.
+        class Entry;
+        typedef std::map<ByteBlock, Entry> EntryMap;
+        typedef std::list<const ByteBlock*> KeyList;
+        class Entry
+        {
+        public:
+            BinaryTable       binary {};   // Copy of the binary table.
+            TablePtr          table {};    // Deserialized table, shared with users.
+            KeyList::iterator use {};      // Position in the LRU list.
+        };
+
+        mutable Mutex _mutex {};
+        size_t        _max_tables = DEFAULT_MAX_TABLES;
+        uint64_t      _hits = 0;
+        uint64_t      _misses = 0;
+        EntryMap      _entries {};
+        KeyList       _lru {};
+
+        // Remove least recently used entries to keep at most the specified number of entries. Must be called under the lock.
+        void shrink(size_t max_count);
+
+        // Build the lookup key of a table.
+        static void BuildKey(ByteBlock& key, const DuckContext& duck, const BinaryTable& table);
+
+        // Search a table in the cache, return a null pointer if not found.
+        TablePtr search(const ByteBlock& key, const BinaryTable& table);
+
+        // Insert a new deserialized table in the cache.
+        void insert(const ByteBlock& key, const BinaryTable& table, const TablePtr& ptr);
+    };
+}
+
+
+//----------------------------------------------------------------------------
+// Template definitions.
+//----------------------------------------------------------------------------
+
+template <class TABLE, typename std::enable_if<std::is_base_of<ts::AbstractTable, TABLE>::value>::type*>
+const TABLE& ts::SignalizationCache::getTable(DuckContext& duck, const BinaryTable& table, TablePtr& holder)
+{
+    ByteBlock key;
+    const bool cacheable = table.isValid() && !table.isShortSection() && maxTables() > 0;
+
+    if (cacheable) {
+        BuildKey(key, duck, table);
+        TablePtr shared(search(key, table));
+        // Two table classes with the same table id may exist in different standards.
+        const TABLE* const cached = dynamic_cast<const TABLE*>(shared.pointer());
+        if (cached != nullptr) {
+            // Same side effect on the context as the deserialization.
+            duck.addStandards(cached->definingStandards());
+            holder = shared;
+            return *cached;
+        }
+    }
+
+    // Deserialize outside the cache lock.
+    TABLE* const tp = new TABLE(duck, table);
+    holder = tp;
+    if (cacheable && tp->isValid()) {
+        // The deserialization may have added standards in the context, update the key.
+        BuildKey(key, duck, table);
+        // The table is now shared with the cache and other users, it must not be modified.
+        tp->setShared();
+        insert(key, table, holder);
+    }
+    return *tp;
+}
@@ -7,6 +7,7 @@
 //----------------------------------------------------------------------------
 
 #include "tsSignalizationDemux.h"
+#include "tsSignalizationCache.h"
 #include "tsDuckContext.h"
 #include "tsBinaryTable.h"
 #include "tsTSPacket.h"
@@ -647,28 +648,32 @@ void ts::SignalizationDemux::handleTable(SectionDemux&, const BinaryTable& table
 
     switch (tid) {
         case TID_PAT: {
-            const PAT pat(_duck, table);
+            SignalizationCache::TablePtr holder;
+            const PAT& pat(SignalizationCache::Instance().getTable<PAT>(_duck, table, holder));
             if (pat.isValid() && pid == PID_PAT) {
                 handlePAT(pat, pid);
             }
             break;
         }
         case TID_CAT: {
-            const CAT cat(_duck, table);
+            SignalizationCache::TablePtr holder;
+            const CAT& cat(SignalizationCache::Instance().getTable<CAT>(_duck, table, holder));
             if (cat.isValid() && pid == PID_CAT) {
                 handleCAT(cat, pid);
             }
             break;
         }
         case TID_PMT: {
-            const PMT pmt(_duck, table);
+            SignalizationCache::TablePtr holder;
+            const PMT& pmt(SignalizationCache::Instance().getTable<PMT>(_duck, table, holder));
             if (pmt.isValid()) {
                 handlePMT(pmt, pid);
             }
             break;
         }
         case TID_TSDT: {
-            const TSDT tsdt(_duck, table);
+            SignalizationCache::TablePtr holder;
+            const TSDT& tsdt(SignalizationCache::Instance().getTable<TSDT>(_duck, table, holder));
             if (tsdt.isValid() && pid == PID_TSDT && _handler != nullptr && isFilteredTableId(TID_TSDT)) {
                 _handler->handleTSDT(tsdt, pid);
             }
@@ -676,7 +681,8 @@ void ts::SignalizationDemux::handleTable(SectionDemux&, const BinaryTable& table
         }
         case TID_NIT_ACT:
         case TID_NIT_OTH:  {
-            const NIT nit(_duck, table);
+            SignalizationCache::TablePtr holder;
+            const NIT& nit(SignalizationCache::Instance().getTable<NIT>(_duck, table, holder));
             if (nit.isValid() && pid == nitPID()) {
                 handleNIT(nit, pid);
             }
@@ -684,14 +690,16 @@ void ts::SignalizationDemux::handleTable(SectionDemux&, const BinaryTable& table
         }
         case TID_SDT_ACT:
         case TID_SDT_OTH:  {
-            const SDT sdt(_duck, table);
+            SignalizationCache::TablePtr holder;
+            const SDT& sdt(SignalizationCache::Instance().getTable<SDT>(_duck, table, holder));
             if (sdt.isValid() && pid == PID_SDT) {
                 handleSDT(sdt, pid);
             }
             break;
         }
         case TID_BAT: {
-            const BAT bat(_duck, table);
+            SignalizationCache::TablePtr holder;
+            const BAT& bat(SignalizationCache::Instance().getTable<BAT>(_duck, table, holder));
             if (bat.isValid() && pid == PID_BAT && _handler != nullptr && isFilteredTableId(tid)) {
                 _handler->handleBAT(bat, pid);
             }
@@ -731,35 +739,40 @@ void ts::SignalizationDemux::handleTable(SectionDemux&, const BinaryTable& table
             break;
         }
         case TID_MGT: {
-            const MGT mgt(_duck, table);
+            SignalizationCache::TablePtr holder;
+            const MGT& mgt(SignalizationCache::Instance().getTable<MGT>(_duck, table, holder));
             if (mgt.isValid() && pid == PID_PSIP) {
                 handleMGT(mgt, pid);
             }
             break;
         }
         case TID_CVCT: {
-            const CVCT vct(_duck, table);
+            SignalizationCache::TablePtr holder;
+            const CVCT& vct(SignalizationCache::Instance().getTable<CVCT>(_duck, table, holder));
             if (vct.isValid() && pid == PID_PSIP) {
                 handleVCT(vct, pid, &SignalizationHandlerInterface::handleCVCT);
             }
             break;
         }
         case TID_TVCT: {
-            const TVCT vct(_duck, table);
+            SignalizationCache::TablePtr holder;
+            const TVCT& vct(SignalizationCache::Instance().getTable<TVCT>(_duck, table, holder));
             if (vct.isValid() && pid == PID_PSIP) {
                 handleVCT(vct, pid, &SignalizationHandlerInterface::handleTVCT);
             }
             break;
         }
         case TID_RRT: {
-            const RRT rrt(_duck, table);
+            SignalizationCache::TablePtr holder;
+            const RRT& rrt(SignalizationCache::Instance().getTable<RRT>(_duck, table, holder));
             if (rrt.isValid() && pid == PID_PSIP && _handler != nullptr && isFilteredTableId(tid)) {
                 _handler->handleRRT(rrt, pid);
             }
             break;
         }
         case TID_SAT: {
-            const SAT sat(_duck, table);
+            SignalizationCache::TablePtr holder;
+            const SAT& sat(SignalizationCache::Instance().getTable<SAT>(_duck, table, holder));
             if (sat.isValid() && pid == PID_SAT) {
                 handleSAT(sat, pid);
             }
@@ -930,7 +943,7 @@ void ts::SignalizationDemux::handlePMT(const PMT& pmt, PID pid)
         ctx->services.insert(pmt.service_id);
 
         // Look for ECM PID's at component level.
-        handleDescriptors(pmt.descs, pid);
+        handleDescriptors(it.second.descs, pid);
     }
 
     // Notify the PMT to the application.
@@ -1109,16 +1122,18 @@ void ts::SignalizationDemux::handleDescriptors(const DescriptorList& dlist, PID
             const DID did = ptr->tag();
 
             // Extract descriptor-dependent information.
+            // The same tables are repeatedly received and, with the signalization cache,
+            // shared by all demuxes. Their descriptors are deserialized only once.
             if (did == DID_CA) {
-                const CADescriptor desc(_duck, *ptr);
-                if (desc.isValid()) {
-                    getPIDContext(desc.ca_pid)->setCAS(dlist.table(), desc.cas_id);
+                const CADescriptor* desc = dlist.deserializedAt<CADescriptor>(_duck, index);
+                if (desc != nullptr) {
+                    getPIDContext(desc->ca_pid)->setCAS(dlist.table(), desc->cas_id);
                 }
             }
             else if (bool(_duck.standards() & Standards::ISDB) && did == DID_ISDB_CA) {
-                const ISDBAccessControlDescriptor desc(_duck, *ptr);
-                if (desc.isValid()) {
-                    getPIDContext(desc.pid)->setCAS(dlist.table(), desc.CA_system_id);
+                const ISDBAccessControlDescriptor* desc = dlist.deserializedAt<ISDBAccessControlDescriptor>(_duck, index);
+                if (desc != nullptr) {
+                    getPIDContext(desc->pid)->setCAS(dlist.table(), desc->CA_system_id);
                 }
             }
         }
@@ -7,10 +7,13 @@
 //----------------------------------------------------------------------------
 
 #include "tsECMGClient.h"
-#include "tsGuardCondition.h"
+#include "tsGuardMutex.h"
+#include "tsCondition.h"
+#include "tsThread.h"
 #include "tsNullReport.h"
 
 #if !defined(TS_CXX17)
+constexpr size_t ts::ECMGClient::LATENCY_BUCKETS;
 constexpr size_t ts::ECMGClient::RECEIVER_STACK_SIZE;
 constexpr size_t ts::ECMGClient::RESPONSE_QUEUE_SIZE;
 constexpr ts::MilliSecond ts::ECMGClient::RESPONSE_TIMEOUT;
@@ -18,36 +21,764 @@ constexpr ts::MilliSecond ts::ECMGClient::RESPONSE_TIMEOUT;
 
 
 //----------------------------------------------------------------------------
-// Constructor
+// An ECM channel, possibly shared between several clients.
+// The channel owns the TCP connection and the receiver thread.
 //----------------------------------------------------------------------------
 
-ts::ECMGClient::ECMGClient(const ecmgscs::Protocol& protocol, size_t extra_handler_stack_size) :
-    Thread(ThreadAttributes().setStackSize(RECEIVER_STACK_SIZE + extra_handler_stack_size)),
-    _protocol(protocol)
+class ts::ECMGClient::Channel: private Thread, private Report
 {
+    TS_NOBUILD_NOCOPY(Channel);
+public:
+    // Get an existing shared channel or open a new one and register a client in it.
+    // The stream id and ECM id are updated when already used in the channel.
+    static ChannelPtr Open(const ECMGClientArgs& args, ECMGClient* client, const AbortInterface* abort, uint16_t& stream_id, uint16_t& ecm_id);
+
+    // Unregister a client. Close the channel when this is the last client.
+    static bool Release(ChannelPtr& channel, ECMGClient* client);
+
+    // Constructor and destructor.
+    Channel(const ECMGClientArgs& args, const UString& key, size_t extra_stack_size);
+    virtual ~Channel() override;
+
+    // Check if the channel is connected to the ECMG.
+    bool isConnected() const;
+
+    // Get the response to channel_setup.
+    const ecmgscs::ChannelStatus& channelStatus() const { return _channel_status; }
+
+    // Send a stream message to the ECMG.
+    bool send(const tlv::Message& msg);
+
+    // Submit an ECM request. Without handler, the response is queued to the client.
+    bool submit(ECMGClient* client, const ecmgscs::CWProvision& msg, ECMGClientHandlerInterface* handler);
+
+    // Cancel a pending ECM request after a timeout.
+    void cancel(ECMGClient* client, uint16_t stream_id, uint16_t cp_number);
+
+    // Get the number of pending ECM requests of a client.
+    size_t pendingRequests(const ECMGClient* client) const;
+
+private:
+    // A client of the channel.
+    class Client
+    {
+    public:
+        ECMGClient* client = nullptr;
+        uint16_t    ecm_id = 0;
+    };
+    typedef std::map<uint16_t, Client> ClientMap;   // Index: ECM_stream_id
+
+    // An ECM request, in the backlog or sent to the ECMG.
+    class Request
+    {
+    public:
+        ECMGClient*                 client = nullptr;
+        ECMGClientHandlerInterface* handler = nullptr;
+        Monotonic                   submitted {true};  // Submission by the application.
+        Monotonic                   sent {};           // Sent to the ECMG.
+        tlv::MessagePtr             msg {};            // CW_provision, while in the backlog.
+    };
+    typedef std::pair<uint16_t, uint16_t> RequestKey;  // ECM_stream_id, CP_number
+    typedef std::map<RequestKey, Request> RequestMap;
+
+    // Registry of shared channels, indexed by ECMG address, ECM_channel_id, Super_CAS_id and version.
+    static Mutex _shared_mutex;
+    static std::map<UString, ChannelPtr> _shared_channels;
+
+    const UString            _key;                   // Key in registry of shared channels, empty if private.
+    bool                     _opening = false;       // Shared channel being connected, protected by _shared_mutex.
+    Condition                _opened {};             // Signaled when _opening is cleared, with _shared_mutex.
+    ecmgscs::Protocol        _protocol {};           // Owned by the channel, clients come and go.
+    const size_t             _max_outstanding;
+    const AbortInterface*    _abort = nullptr;
+    tlv::Logger              _logger {};             // Logger of the channel, reports through this object.
+    Mutex                    _report_mutex {};
+    Report*                  _report = nullptr;      // Report of one client of the channel.
+    tlv::Connection<Mutex>   _connection {_protocol, true, 3};
+    ecmgscs::ChannelStatus   _channel_status {_protocol};
+    MessageQueue<tlv::Message, NullMutex> _setup_queue {RESPONSE_QUEUE_SIZE};
+    mutable Mutex            _mutex {};              // Protect subsequent fields.
+    bool                     _connected = false;
+    MilliSecond              _ecm_timeout = RESPONSE_TIMEOUT;
+    ClientMap                _clients {};
+    RequestMap               _sent {};               // Requests sent to the ECMG.
+    std::list<std::pair<RequestKey, Request>> _backlog {};  // Requests waiting to be sent.
+    const ECMGClient*        _notifying = nullptr;   // Client whose handler is being notified.
+    Condition                _notify_done {};        // Signaled at end of notification, with _mutex.
+
+    // Connect to the ECMG and setup the channel.
+    bool open(const ECMGClientArgs& args, const AbortInterface* abort, const tlv::Logger& logger);
+
+    // Close the channel, disconnect from the ECMG.
+    bool close();
+
+    // Register and unregister a client, return the number of remaining clients.
+    void addClient(ECMGClient* client, uint16_t& stream_id, uint16_t& ecm_id);
+    size_t removeClient(ECMGClient* client);
+
+    // Set the report of the channel logger.
+    void setReport(Report* report);
+
+    // Send a request, with mutex held.
+    bool sendRequest(const RequestKey& key, Request& req, const ecmgscs::CWProvision& msg);
+
+    // Send requests from the backlog and drop expired requests, with mutex held.
+    void pumpRequests();
+
+    // Dispatch an incoming message, with mutex held. Return the handler to notify
+    // of an ECM_response, to be called after releasing the mutex, or a null pointer.
+    ECMGClientHandlerInterface* dispatch(const tlv::MessagePtr& msg);
+
+    // Find the client of a stream message, with mutex held.
+    ECMGClient* streamClient(const tlv::Message* msg) const;
+
+    // Inherited methods.
+    virtual void main() override;
+    virtual void writeLog(int severity, const UString& msg) override;
+};
+
+ts::Mutex ts::ECMGClient::Channel::_shared_mutex;
+std::map<ts::UString, ts::ECMGClient::ChannelPtr> ts::ECMGClient::Channel::_shared_channels;
+
+
+//----------------------------------------------------------------------------
+// Channel constructor and destructor.
+//----------------------------------------------------------------------------
+
+ts::ECMGClient::Channel::Channel(const ECMGClientArgs& args, const UString& key, size_t extra_stack_size) :
+    Thread(ThreadAttributes().setStackSize(RECEIVER_STACK_SIZE + extra_stack_size)),
+    _key(key),
+    _max_outstanding(std::max<size_t>(1, args.max_outstanding))
+{
+    _protocol.setVersion(args.dvbsim_version);
+    _channel_status.forceProtocolVersion(args.dvbsim_version);
+}
+
+ts::ECMGClient::Channel::~Channel()
+{
+    close();
+    setReport(nullptr);
 }
 
 
 //----------------------------------------------------------------------------
-// Destructor
+// Forward the log messages of the channel to the report of a client.
 //----------------------------------------------------------------------------
 
-ts::ECMGClient::~ECMGClient()
+void ts::ECMGClient::Channel::setReport(Report* report)
 {
+    GuardMutex lock(_report_mutex);
+    _report = report;
+    Report::setMaxSeverity(report == nullptr ? int(Severity::Info) : report->maxSeverity());
+}
+
+void ts::ECMGClient::Channel::writeLog(int severity, const UString& msg)
+{
+    GuardMutex lock(_report_mutex);
+    if (_report != nullptr) {
+        _report->log(severity, msg);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Get an existing shared channel or open a new one.
+//----------------------------------------------------------------------------
+
+ts::ECMGClient::ChannelPtr ts::ECMGClient::Channel::Open(const ECMGClientArgs& args, ECMGClient* client, const AbortInterface* abort, uint16_t& stream_id, uint16_t& ecm_id)
+{
+    // Private channels are not registered.
+    if (!args.shared_channel) {
+        ChannelPtr channel(new Channel(args, UString(), client->_extra_stack_size));
+        if (channel->open(args, abort, client->_logger)) {
+            channel->addClient(client, stream_id, ecm_id);
+        }
+        else {
+            channel.clear();
+        }
+        return channel;
+    }
+
+    // The registry is locked only to find or reserve the shared channel. The connection
+    // to the ECMG is performed without the lock. Other clients of the same channel wait
+    // until the connection completes, clients of other channels are not blocked.
+    const UString key(UString::Format(u"%s/%d/%d/%d", {args.ecmg_address, args.ecm_channel_id, args.super_cas_id, args.dvbsim_version}));
+    ChannelPtr channel;
     {
-        GuardCondition lock(_mutex, _work_to_do);
+        GuardMutex lock(_shared_mutex);
+        for (;;) {
+            const auto it = _shared_channels.find(key);
+            if (it == _shared_channels.end() || (!it->second->_opening && !it->second->isConnected())) {
+                // No usable channel, reserve a new one.
+                channel = new Channel(args, key, client->_extra_stack_size);
+                channel->_opening = true;
+                _shared_channels[key] = channel;
+                break;
+            }
+            else if (!it->second->_opening) {
+                // Already connected.
+                it->second->addClient(client, stream_id, ecm_id);
+                return it->second;
+            }
+            // Another client is opening this channel. The condition wakes up one waiter
+            // at a time, pass it to the next one. The channel is kept alive meanwhile.
+            const ChannelPtr opening(it->second);
+            while (opening->_opening) {
+                opening->_opened.wait(_shared_mutex, Infinite);
+            }
+            opening->_opened.signal();
+        }
+    }
+
+    // Connect to the ECMG, without lock on the registry.
+    const bool ok = channel->open(args, nullptr, client->_logger);
+
+    // Publish the result, wake up the clients which wait for the same channel.
+    GuardMutex lock(_shared_mutex);
+    channel->_opening = false;
+    if (ok) {
+        channel->addClient(client, stream_id, ecm_id);
+    }
+    else {
+        const auto it = _shared_channels.find(key);
+        if (it != _shared_channels.end() && it->second == channel) {
+            _shared_channels.erase(it);
+        }
+    }
+    channel->_opened.signal();
+    if (!ok) {
+        channel.clear();
+    }
+    return channel;
+}
+
+
+//----------------------------------------------------------------------------
+// Unregister a client. Close the channel when this is the last client.
+//----------------------------------------------------------------------------
+
+bool ts::ECMGClient::Channel::Release(ChannelPtr& channel, ECMGClient* client)
+{
+    if (channel.isNull()) {
+        return true;
+    }
+
+    // Unregister under protection of the registry lock, disconnect without the lock.
+    bool last = false;
+    {
+        GuardMutex lock(_shared_mutex);
+        last = channel->removeClient(client) == 0;
+        if (last && !channel->_key.empty()) {
+            const auto it = _shared_channels.find(channel->_key);
+            if (it != _shared_channels.end() && it->second == channel) {
+                _shared_channels.erase(it);
+            }
+        }
+    }
+
+    bool ok = true;
+    if (last) {
+        ok = channel->close();
+        channel->setReport(nullptr);
+    }
+    channel.clear();
+    return ok;
+}
+
 
-        // Break connection, if not already done
-        _abort = nullptr;
-        _logger.setReport(&NULLREP);
+//----------------------------------------------------------------------------
+// Connect to the ECMG and setup the channel.
+//----------------------------------------------------------------------------
+
+bool ts::ECMGClient::Channel::open(const ECMGClientArgs& args, const AbortInterface* abort, const tlv::Logger& logger)
+{
+    // All messages are reported through this object to the current client.
+    _abort = abort;
+    _logger = logger;
+    setReport(&_logger.report());
+    _logger.setReport(this);
+
+    // Perform TCP connection to ECMG server
+    // Flawfinder: ignore: this is our open(), not ::open().
+    if (!_connection.open(*this)) {
+        return false;
+    }
+    if (!_connection.connect(args.ecmg_address, *this)) {
+        _connection.close(*this);
+        return false;
+    }
+
+    // Send a channel_setup message to ECMG
+    ecmgscs::ChannelSetup channel_setup(_protocol);
+    channel_setup.channel_id = args.ecm_channel_id;
+    channel_setup.Super_CAS_id = args.super_cas_id;
+    if (!_connection.send(channel_setup, _logger)) {
         _connection.disconnect(NULLREP);
         _connection.close(NULLREP);
+        return false;
+    }
+
+    // Start the receiver thread.
+    Thread::start();
+
+    // Wait for a channel_status from the ECMG
+    tlv::MessagePtr msg;
+    if (!_setup_queue.dequeue(msg, RESPONSE_TIMEOUT)) {
+        error(u"ECMG channel_setup response timeout");
+        close();
+        return false;
+    }
+    if (msg->tag() != ecmgscs::Tags::channel_status) {
+        error(u"unexpected response from ECMG (expected channel_status):\n%s", {msg->dump(4)});
+        close();
+        return false;
+    }
+    ecmgscs::ChannelStatus* const csp = dynamic_cast<ecmgscs::ChannelStatus*>(msg.pointer());
+    assert(csp != nullptr);
+
+    // ECM channel now established
+    GuardMutex lock(_mutex);
+    _channel_status = *csp;
+    _ecm_timeout = std::max(RESPONSE_TIMEOUT, 2 * MilliSecond(_channel_status.max_comp_time));
+    _connected = true;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Close the channel, disconnect from the ECMG.
+//----------------------------------------------------------------------------
+
+bool ts::ECMGClient::Channel::close()
+{
+    bool ok = true;
+    bool connected = false;
+    {
+        GuardMutex lock(_mutex);
+        connected = _connected;
+        _connected = false;
+        _sent.clear();
+        _backlog.clear();
+    }
+
+    // Politely send a channel_close
+    if (connected) {
+        ecmgscs::ChannelClose cc(_protocol);
+        cc.channel_id = _channel_status.channel_id;
+        ok = _connection.send(cc, _logger);
+    }
 
-        // Notify receiver thread to terminate
-        _state = DESTRUCTING;
-        lock.signal();
+    // TCP disconnection, terminate the receiver thread.
+    if (_connection.isOpen()) {
+        ok = _connection.disconnect(NULLREP) && ok;
+        ok = _connection.close(NULLREP) && ok;
     }
     waitForTermination();
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Check if the channel is connected to the ECMG.
+//----------------------------------------------------------------------------
+
+bool ts::ECMGClient::Channel::isConnected() const
+{
+    GuardMutex lock(_mutex);
+    return _connected;
+}
+
+
+//----------------------------------------------------------------------------
+// Register and unregister clients.
+//----------------------------------------------------------------------------
+
+void ts::ECMGClient::Channel::addClient(ECMGClient* client, uint16_t& stream_id, uint16_t& ecm_id)
+{
+    GuardMutex lock(_mutex);
+
+    // Find free stream id and ECM id in the channel.
+    const uint16_t req_stream_id = stream_id;
+    const uint16_t req_ecm_id = ecm_id;
+    std::set<uint16_t> ecm_ids;
+    for (const auto& it : _clients) {
+        ecm_ids.insert(it.second.ecm_id);
+    }
+    while (_clients.count(stream_id) != 0) {
+        stream_id++;
+    }
+    while (ecm_ids.count(ecm_id) != 0) {
+        ecm_id++;
+    }
+    if (stream_id != req_stream_id || ecm_id != req_ecm_id) {
+        verbose(u"ECM_stream_id %d / ECM_id %d already used in shared ECM channel, using %d / %d", {req_stream_id, req_ecm_id, stream_id, ecm_id});
+    }
+
+    Client& cl(_clients[stream_id]);
+    cl.client = client;
+    cl.ecm_id = ecm_id;
+}
+
+size_t ts::ECMGClient::Channel::removeClient(ECMGClient* client)
+{
+    GuardMutex lock(_mutex);
+
+    // Wait for the end of a notification to the handler of this client, unless
+    // the client is removed from its own handler, in the receiver thread.
+    while (_notifying == client && !isCurrentThread()) {
+        _notify_done.wait(_mutex, Infinite);
+    }
+
+    // Remove the client and all its requests.
+    for (auto it = _clients.begin(); it != _clients.end(); ) {
+        it = it->second.client == client ? _clients.erase(it) : ++it;
+    }
+    for (auto it = _sent.begin(); it != _sent.end(); ) {
+        it = it->second.client == client ? _sent.erase(it) : ++it;
+    }
+    for (auto it = _backlog.begin(); it != _backlog.end(); ) {
+        it = it->second.client == client ? _backlog.erase(it) : ++it;
+    }
+
+    // If the channel reports through this client, switch to another one.
+    if (!_clients.empty() && _report == &client->_logger.report()) {
+        setReport(&_clients.begin()->second.client->_logger.report());
+    }
+
+    // Some requests may have been unlocked.
+    pumpRequests();
+    return _clients.size();
+}
+
+
+//----------------------------------------------------------------------------
+// Send a stream message to the ECMG.
+//----------------------------------------------------------------------------
+
+bool ts::ECMGClient::Channel::send(const tlv::Message& msg)
+{
+    return isConnected() && _connection.send(msg, _logger);
+}
+
+
+//----------------------------------------------------------------------------
+// Submit an ECM request.
+//----------------------------------------------------------------------------
+
+bool ts::ECMGClient::Channel::submit(ECMGClient* client, const ecmgscs::CWProvision& msg, ECMGClientHandlerInterface* handler)
+{
+    GuardMutex lock(_mutex);
+
+    if (!_connected) {
+        error(u"ECMG not connected");
+        return false;
+    }
+
+    // Requests are correlated with responses using the stream id and CP number.
+    const RequestKey key(msg.stream_id, msg.CP_number);
+    bool duplicate = _sent.count(key) != 0;
+    for (auto it = _backlog.begin(); !duplicate && it != _backlog.end(); ++it) {
+        duplicate = it->first == key;
+    }
+    if (duplicate) {
+        error(u"duplicate ECM request for ECM_stream_id %d, CP_number %d", {key.first, key.second});
+        return false;
+    }
+
+    Request req;
+    req.client = client;
+    req.handler = handler;
+
+    pumpRequests();
+    if (_backlog.empty() && _sent.size() < _max_outstanding) {
+        // Send the request immediately.
+        return sendRequest(key, req, msg);
+    }
+    else {
+        // Too many outstanding requests, wait for some responses.
+        req.msg = new ecmgscs::CWProvision(msg);
+        _backlog.push_back(std::make_pair(key, req));
+        return true;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Send a request, with mutex held.
+//----------------------------------------------------------------------------
+
+bool ts::ECMGClient::Channel::sendRequest(const RequestKey& key, Request& req, const ecmgscs::CWProvision& msg)
+{
+    req.sent.getSystemTime();
+    req.msg.clear();
+    _sent[key] = req;
+    if (_connection.send(msg, _logger)) {
+        return true;
+    }
+    else {
+        _sent.erase(key);
+        return false;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Send requests from the backlog and drop expired requests, with mutex held.
+//----------------------------------------------------------------------------
+
+void ts::ECMGClient::Channel::pumpRequests()
+{
+    // Drop requests without response. Otherwise, they would block the pipeline.
+    const Monotonic now(true);
+    for (auto it = _sent.begin(); it != _sent.end(); ) {
+        if ((now - it->second.sent) / NanoSecPerMilliSec > _ecm_timeout) {
+            warning(u"ECM generation timeout, ECM_stream_id %d, CP_number %d", {it->first.first, it->first.second});
+            GuardMutex client_lock(it->second.client->_mutex);
+            it->second.client->_latency.timeouts++;
+            it = _sent.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    // Send queued requests while there is room in the pipeline.
+    while (_connected && !_backlog.empty() && _sent.size() < _max_outstanding) {
+        const RequestKey key(_backlog.front().first);
+        Request req(_backlog.front().second);
+        _backlog.pop_front();
+        const ecmgscs::CWProvision* msg = dynamic_cast<const ecmgscs::CWProvision*>(req.msg.pointer());
+        if (msg != nullptr) {
+            const tlv::MessagePtr keep(req.msg);
+            sendRequest(key, req, *msg);
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Cancel a pending ECM request.
+//----------------------------------------------------------------------------
+
+void ts::ECMGClient::Channel::cancel(ECMGClient* client, uint16_t stream_id, uint16_t cp_number)
+{
+    GuardMutex lock(_mutex);
+    const RequestKey key(stream_id, cp_number);
+    bool found = _sent.erase(key) > 0;
+    for (auto it = _backlog.begin(); !found && it != _backlog.end(); ++it) {
+        if (it->first == key) {
+            _backlog.erase(it);
+            found = true;
+        }
+    }
+    if (found) {
+        GuardMutex client_lock(client->_mutex);
+        client->_latency.timeouts++;
+    }
+    pumpRequests();
+}
+
+
+//----------------------------------------------------------------------------
+// Get the number of pending ECM requests of a client.
+//----------------------------------------------------------------------------
+
+size_t ts::ECMGClient::Channel::pendingRequests(const ECMGClient* client) const
+{
+    GuardMutex lock(_mutex);
+    size_t count = 0;
+    for (const auto& it : _sent) {
+        count += it.second.client == client;
+    }
+    for (const auto& it : _backlog) {
+        count += it.second.client == client;
+    }
+    return count;
+}
+
+
+//----------------------------------------------------------------------------
+// Find the client of a stream message, with mutex held.
+//----------------------------------------------------------------------------
+
+ts::ECMGClient* ts::ECMGClient::Channel::streamClient(const tlv::Message* msg) const
+{
+    const tlv::StreamMessage* smsg = dynamic_cast<const tlv::StreamMessage*>(msg);
+    if (smsg != nullptr) {
+        const auto it = _clients.find(smsg->stream_id);
+        if (it != _clients.end()) {
+            return it->second.client;
+        }
+    }
+    return nullptr;
+}
+
+
+//----------------------------------------------------------------------------
+// Receiver thread main code
+//----------------------------------------------------------------------------
+
+void ts::ECMGClient::Channel::main()
+{
+    // Loop on message reception
+    tlv::MessagePtr msg;
+    while (_connection.receive(msg, _abort, _logger)) {
+        ECMGClientHandlerInterface* handler = nullptr;
+        {
+            GuardMutex lock(_mutex);
+            if (_connected) {
+                handler = dispatch(msg);
+            }
+            else {
+                // Channel setup in progress.
+                _setup_queue.enqueue(msg, 0);
+            }
+        }
+        // Asynchronous request -> notify application without holding the mutex.
+        // The handler may submit new requests in the channel.
+        if (handler != nullptr) {
+            const ecmgscs::ECMResponse* const resp = dynamic_cast<const ecmgscs::ECMResponse*>(msg.pointer());
+            assert(resp != nullptr);
+            handler->handleECM(*resp);
+            GuardMutex lock(_mutex);
+            _notifying = nullptr;
+            _notify_done.signal();
+        }
+    }
+
+    // Error while receiving messages, most likely a disconnection.
+    GuardMutex lock(_mutex);
+    _connected = false;
+}
+
+
+//----------------------------------------------------------------------------
+// Dispatch an incoming message, with mutex held.
+//----------------------------------------------------------------------------
+
+ts::ECMGClientHandlerInterface* ts::ECMGClient::Channel::dispatch(const tlv::MessagePtr& msg)
+{
+    ECMGClient* const client = streamClient(msg.pointer());
+    ECMGClientHandlerInterface* handler = nullptr;
+
+    switch (msg->tag()) {
+        case ecmgscs::Tags::channel_test: {
+            // Automatic reply to channel_test
+            _connection.send(_channel_status, _logger);
+            break;
+        }
+        case ecmgscs::Tags::channel_status: {
+            // Unsollicited channel_status, ignored.
+            break;
+        }
+        case ecmgscs::Tags::stream_test: {
+            // Automatic reply to stream_test
+            if (client != nullptr) {
+                ecmgscs::StreamStatus resp(_protocol);
+                {
+                    GuardMutex client_lock(client->_mutex);
+                    resp = client->_stream_status;
+                }
+                _connection.send(resp, _logger);
+            }
+            break;
+        }
+        case ecmgscs::Tags::ECM_response: {
+            // Find the corresponding request.
+            ecmgscs::ECMResponse* const resp = dynamic_cast<ecmgscs::ECMResponse*>(msg.pointer());
+            assert(resp != nullptr);
+            const auto it = _sent.find(RequestKey(resp->stream_id, resp->CP_number));
+            if (it == _sent.end()) {
+                debug(u"ignored unexpected ECM_response, ECM_stream_id %d, CP_number %d", {resp->stream_id, resp->CP_number});
+            }
+            else {
+                const Request req(it->second);
+                _sent.erase(it);
+                {
+                    GuardMutex client_lock(req.client->_mutex);
+                    req.client->_latency.feed((Monotonic(true) - req.submitted) / NanoSecPerMilliSec);
+                }
+                if (req.handler == nullptr) {
+                    // Synchronous request -> enqueue response for application thread
+                    tlv::MessagePtr m(msg);
+                    req.client->_response_queue.enqueue(m, 0);
+                }
+                else {
+                    // Asynchronous request -> notify application after releasing the mutex.
+                    // The client cannot be removed from the channel until the notification is complete.
+                    handler = req.handler;
+                    _notifying = req.client;
+                }
+            }
+            // A slot is now free in the pipeline.
+            pumpRequests();
+            break;
+        }
+        case ecmgscs::Tags::channel_error: {
+            error(u"ECMG channel error:\n%s", {msg->dump(4)});
+            break;
+        }
+        default: {
+            // Enqueue other stream messages for the application thread of the client.
+            if (client != nullptr) {
+                tlv::MessagePtr m(msg);
+                client->_response_queue.enqueue(m, 0);
+            }
+            else {
+                debug(u"ignored unexpected message from ECMG:\n%s", {msg->dump(4)});
+            }
+            break;
+        }
+    }
+    return handler;
+}
+
+
+//----------------------------------------------------------------------------
+// Constructor
+//----------------------------------------------------------------------------
+
+ts::ECMGClient::ECMGClient(const ecmgscs::Protocol& protocol, size_t extra_handler_stack_size) :
+    _protocol(protocol),
+    _extra_stack_size(extra_handler_stack_size)
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Destructor
+//----------------------------------------------------------------------------
+
+ts::ECMGClient::~ECMGClient()
+{
+    // Break connection, if not already done
+    ChannelPtr chan(channel());
+    Channel::Release(chan, this);
+    GuardMutex lock(_mutex);
+    _channel.clear();
+}
+
+
+//----------------------------------------------------------------------------
+// Get the channel of a connected client.
+//----------------------------------------------------------------------------
+
+ts::ECMGClient::ChannelPtr ts::ECMGClient::channel() const
+{
+    GuardMutex lock(_mutex);
+    return _channel;
+}
+
+bool ts::ECMGClient::isConnected() const
+{
+    const ChannelPtr chan(channel());
+    return !chan.isNull() && chan->isConnected();
+}
+
+size_t ts::ECMGClient::pendingRequests() const
+{
+    const ChannelPtr chan(channel());
+    return chan.isNull() ? 0 : chan->pendingRequests(this);
 }
 
 
@@ -61,11 +792,12 @@ bool ts::ECMGClient::abortConnection(const UString& message)
         _logger.report().error(message);
     }
 
-    GuardCondition lock(_mutex, _work_to_do);
-    _state = DISCONNECTED;
-    _connection.disconnect(_logger.report());
-    _connection.close(_logger.report());
-    lock.signal();
+    ChannelPtr chan(channel());
+    Channel::Release(chan, this);
+    {
+        GuardMutex lock(_mutex);
+        _channel.clear();
+    }
 
     _logger.setReport(&NULLREP);
     return false;
@@ -85,68 +817,42 @@ bool ts::ECMGClient::connect(const ECMGClientArgs& args,
     // Initial state check
     {
         GuardMutex lock(_mutex);
-        // Start receiver thread if first time
-        if (_state == INITIAL) {
-            _state = DISCONNECTED;
-            Thread::start();
-        }
-        if (_state != DISCONNECTED) {
+        if (!_channel.isNull()) {
             tlv::Logger log(logger);
             log.report().error(u"ECMG client already connected");
             return false;
         }
-        _abort = abort;
         _logger = logger;
     }
+    _response_queue.clear();
 
-    // Perform TCP connection to ECMG server
-    // Flawfinder: ignore: this is our open(), not ::open().
-    if (!_connection.open(_logger.report())) {
+    // Get a new or shared ECM channel. The TCP connection and channel_setup
+    // are performed only when the channel is new.
+    uint16_t stream_id = args.ecm_stream_id;
+    uint16_t ecm_id = args.ecm_id;
+    ChannelPtr chan(Channel::Open(args, this, abort, stream_id, ecm_id));
+    if (chan.isNull()) {
         return false;
     }
-    if (!_connection.connect(args.ecmg_address, _logger.report())) {
-        _connection.close(_logger.report());
-        return false;
-    }
-
-    // Send a channel_setup message to ECMG
-    ecmgscs::ChannelSetup channel_setup(_protocol);
-    channel_setup.channel_id = args.ecm_channel_id;
-    channel_setup.Super_CAS_id = args.super_cas_id;
-    if (!_connection.send(channel_setup, _logger)) {
-        return abortConnection();
-    }
-
-    // Tell the receiver thread to start listening for incoming messages
     {
-        GuardCondition lock(_mutex, _work_to_do);
-        _state = CONNECTING;
-        lock.signal();
-    }
-
-    // Wait for a channel_status from the ECMG
-    tlv::MessagePtr msg;
-    if (!_response_queue.dequeue(msg, RESPONSE_TIMEOUT)) {
-        return abortConnection(u"ECMG channel_setup response timeout");
-    }
-    if (msg->tag() != ecmgscs::Tags::channel_status) {
-        return abortConnection(u"unexpected response from ECMG (expected channel_status):\n" + msg->dump(4));
+        GuardMutex lock(_mutex);
+        _channel = chan;
+        _channel_status = chan->channelStatus();
+        channel_status = _channel_status;
     }
-    ecmgscs::ChannelStatus* const csp = dynamic_cast<ecmgscs::ChannelStatus*>(msg.pointer());
-    assert(csp != nullptr);
-    channel_status = _channel_status = *csp;
 
     // Send a stream_setup message to ECMG
     ecmgscs::StreamSetup stream_setup(_protocol);
     stream_setup.channel_id = args.ecm_channel_id;
-    stream_setup.stream_id = args.ecm_stream_id;
-    stream_setup.ECM_id = args.ecm_id;
+    stream_setup.stream_id = stream_id;
+    stream_setup.ECM_id = ecm_id;
     stream_setup.nominal_CP_duration = uint16_t(args.cp_duration / 100); // unit is 1/10 second
-    if (!_connection.send(stream_setup, _logger)) {
+    if (!chan->send(stream_setup)) {
         return abortConnection();
     }
 
     // Wait for a stream_status from the ECMG
+    tlv::MessagePtr msg;
     if (!_response_queue.dequeue(msg, RESPONSE_TIMEOUT)) {
         return abortConnection(u"ECMG stream_setup response timeout");
     }
@@ -155,14 +861,10 @@ bool ts::ECMGClient::connect(const ECMGClientArgs& args,
     }
     ecmgscs::StreamStatus* const ssp = dynamic_cast<ecmgscs::StreamStatus*>(msg.pointer());
     assert(ssp != nullptr);
-    stream_status = _stream_status = *ssp;
 
     // ECM stream now established
-    {
-        GuardMutex lock(_mutex);
-        _state = CONNECTED;
-    }
-
+    GuardMutex lock(_mutex);
+    stream_status = _stream_status = *ssp;
     return true;
 }
 
@@ -173,46 +875,27 @@ bool ts::ECMGClient::connect(const ECMGClientArgs& args,
 
 bool ts::ECMGClient::disconnect()
 {
-    // Mark disconnection in progress
-    State previous_state;
-    {
-        GuardMutex lock(_mutex);
-        previous_state = _state;
-        if (_state == CONNECTING || _state == CONNECTED) {
-            _state = DISCONNECTING;
-        }
+    ChannelPtr chan(channel());
+    if (chan.isNull()) {
+        return false;
     }
 
-    // Disconnection sequence
-    bool ok = previous_state == CONNECTED;
-    if (ok) {
-        // Politely send a stream_close_request
-        ecmgscs::StreamCloseRequest req(_protocol);
+    // Politely send a stream_close_request and wait for a stream_close_response
+    ecmgscs::StreamCloseRequest req(_protocol);
+    {
+        GuardMutex lock(_mutex);
         req.channel_id = _stream_status.channel_id;
         req.stream_id = _stream_status.stream_id;
-        tlv::MessagePtr resp;
-        // Politely send a stream_close_request
-        // and wait for a stream_close_response
-        ok = _connection.send(req, _logger) &&
-            _response_queue.dequeue(resp, RESPONSE_TIMEOUT) &&
-            resp->tag() == ecmgscs::Tags::stream_close_response;
-        // If we get a polite reply, send a channel_close
-        if (ok) {
-            ecmgscs::ChannelClose cc(_protocol);
-            cc.channel_id = _channel_status.channel_id;
-            ok = _connection.send(cc, _logger);
-        }
-    }
-
-    // TCP disconnection
-    GuardCondition lock(_mutex, _work_to_do);
-    if (previous_state == CONNECTING || previous_state == CONNECTED) {
-        _state = DISCONNECTED;
-        ok = _connection.disconnect(_logger.report()) && ok;
-        ok = _connection.close(_logger.report()) && ok;
-        lock.signal();
     }
+    tlv::MessagePtr resp;
+    bool ok = chan->send(req) &&
+        _response_queue.dequeue(resp, RESPONSE_TIMEOUT) &&
+        resp->tag() == ecmgscs::Tags::stream_close_response;
 
+    // Leave the channel, close it if this is the last stream.
+    ok = Channel::Release(chan, this) && ok;
+    GuardMutex lock(_mutex);
+    _channel.clear();
     return ok;
 }
 
@@ -228,8 +911,11 @@ void ts::ECMGClient::buildCWProvision(ecmgscs::CWProvision& msg,
                                       const ByteBlock& ac,
                                       uint16_t cp_duration)
 {
-    msg.channel_id = _stream_status.channel_id;
-    msg.stream_id = _stream_status.stream_id;
+    {
+        GuardMutex lock(_mutex);
+        msg.channel_id = _stream_status.channel_id;
+        msg.stream_id = _stream_status.stream_id;
+    }
     msg.CP_number = cp_number;
     msg.has_CW_encryption = false;
     msg.has_CP_duration = cp_duration != 0;
@@ -258,25 +944,38 @@ bool ts::ECMGClient::generateECM(uint16_t cp_number,
                                  uint16_t cp_duration,
                                  ecmgscs::ECMResponse& ecm_response)
 {
+    ChannelPtr chan(channel());
+    if (chan.isNull()) {
+        _logger.report().error(u"ECMG not connected");
+        return false;
+    }
+
     // Build a CW_provision message
     ecmgscs::CWProvision msg(_protocol);
     buildCWProvision(msg, cp_number, current_cw, next_cw, ac, cp_duration);
 
-    // Send the CW_provision message
-    if (!_connection.send(msg, _logger)) {
+    // Submit the CW_provision message without handler, the response is queued.
+    if (!chan->submit(this, msg, nullptr)) {
         return false;
     }
 
     // Compute ECM generation timeout (very conservative)
     const MilliSecond timeout = std::max(RESPONSE_TIMEOUT, 2 * MilliSecond(_channel_status.max_comp_time));
+    Monotonic deadline(true);
+    deadline += timeout * NanoSecPerMilliSec;
 
     // Wait for an ECM response from the ECMG
     tlv::MessagePtr resp;
-    if (!_response_queue.dequeue(resp, timeout)) {
-        _logger.report().error(u"ECM generation timeout");
-        return false;
-    }
-    if (resp->tag() == ecmgscs::Tags::ECM_response) {
+    for (;;) {
+        const MilliSecond remain = (deadline - Monotonic(true)) / NanoSecPerMilliSec;
+        if (remain <= 0 || !_response_queue.dequeue(resp, remain)) {
+            chan->cancel(this, msg.stream_id, cp_number);
+            _logger.report().error(u"ECM generation timeout");
+            return false;
+        }
+        if (resp->tag() != ecmgscs::Tags::ECM_response) {
+            break;
+        }
         ecmgscs::ECMResponse* const ep = dynamic_cast <ecmgscs::ECMResponse*>(resp.pointer());
         assert(ep != nullptr);
         if (ep->CP_number == cp_number) {
@@ -284,12 +983,16 @@ bool ts::ECMGClient::generateECM(uint16_t cp_number,
             ecm_response = *ep;
             return true;
         }
+        // Late response to a previous request which timed out, it was queued
+        // before the request was cancelled. Discard it and wait for our ECM.
+        _logger.report().debug(u"discarded stale ECM_response, CP_number %d", {ep->CP_number});
     }
 
     // Unexpected response. Messages other than our ECM_response are channel_test
     // and status_test. They are automatically handled in the reception thread.
     // At this point, if we receive a message, this is an error or an truely
     // unexpected message.
+    chan->cancel(this, msg.stream_id, cp_number);
     _logger.report().error(u"unexpected response to ECM request:\n%s", {resp->dump(4)});
     return false;
 }
@@ -306,115 +1009,70 @@ bool ts::ECMGClient::submitECM(uint16_t cp_number,
                                uint16_t cp_duration,
                                ECMGClientHandlerInterface* ecm_handler)
 {
+    ChannelPtr chan(channel());
+    if (chan.isNull()) {
+        _logger.report().error(u"ECMG not connected");
+        return false;
+    }
+
     // Build a CW_provision message
     ecmgscs::CWProvision msg(_protocol);
     buildCWProvision(msg, cp_number, current_cw, next_cw, ac, cp_duration);
 
-    // Register an asynchronous request
-    {
-        GuardMutex lock(_mutex);
-        _async_requests.insert(std::make_pair(cp_number, ecm_handler));
-    }
-
-    // Send the CW_provision message
-    bool ok = _connection.send(msg, _logger);
-
-    // Clear asynchronous request on error
-    if (!ok) {
-        GuardMutex lock(_mutex);
-        _async_requests.erase(cp_number);
-    }
-
-    return ok;
+    // Send the CW_provision message or queue it in the channel pipeline.
+    return chan->submit(this, msg, ecm_handler);
 }
 
 
 //----------------------------------------------------------------------------
-// Receiver thread main code
+// Latency statistics.
 //----------------------------------------------------------------------------
 
-void ts::ECMGClient::main()
+ts::ECMGClient::LatencyStatistics ts::ECMGClient::latencyStatistics() const
 {
-    // Main loop
-    for (;;) {
+    GuardMutex lock(_mutex);
+    return _latency;
+}
 
-        const AbortInterface* abort = nullptr;
+ts::MilliSecond ts::ECMGClient::LatencyStatistics::BucketLimit(size_t index)
+{
+    // Limits are 1, 2, 5, 10, 20, 50, etc.
+    static const MilliSecond mult[] = {1, 2, 5};
+    if (index + 1 >= LATENCY_BUCKETS) {
+        return Infinite;
+    }
+    MilliSecond limit = mult[index % 3];
+    for (size_t i = 0; i < index / 3; ++i) {
+        limit *= 10;
+    }
+    return limit;
+}
 
-        // Wait for a connection to be managed
-        {
-            // Lock the mutex, get object state
-            GuardCondition lock(_mutex, _work_to_do);
-            while (_state == DISCONNECTED) {
-                // Release the mutex and wait for something to do.
-                // Automatically reacquire the mutex when condition is signaled.
-                lock.waitCondition();
-            }
-            // Mutex still held, check if thread must terminate
-            if (_state == DESTRUCTING) {
-                return;
-            }
-            // Get abort handler
-            abort = _abort;
-            // Automatically release mutex
-        }
+void ts::ECMGClient::LatencyStatistics::feed(MilliSecond value)
+{
+    latency.feed(value);
+    size_t index = 0;
+    while (index + 1 < LATENCY_BUCKETS && value >= BucketLimit(index)) {
+        ++index;
+    }
+    histogram[index]++;
+}
 
-        // Loop on message reception
-        tlv::MessagePtr msg;
-        bool ok = true;
-        while (ok && _connection.receive(msg, abort, _logger)) {
-            switch (msg->tag()) {
-                case ecmgscs::Tags::channel_test: {
-                    // Automatic reply to channel_test
-                    ok = _connection.send(_channel_status, _logger);
-                    break;
-                }
-                case ecmgscs::Tags::stream_test: {
-                    // Automatic reply to stream_test
-                    ok = _connection.send(_stream_status, _logger);
-                    break;
-                }
-                case ecmgscs::Tags::ECM_response: {
-                    // Check if this is an asynchronous ECM response
-                    ecmgscs::ECMResponse* const resp = dynamic_cast <ecmgscs::ECMResponse*>(msg.pointer());
-                    assert(resp != nullptr);
-                    ECMGClientHandlerInterface* handler = nullptr;
-                    {
-                        GuardMutex lock(_mutex);
-                        auto it = _async_requests.find(resp->CP_number);
-                        if (it != _async_requests.end()) {
-                            handler = it->second;
-                            _async_requests.erase(resp->CP_number);
-                        }
-                    }
-                    if (handler == nullptr) {
-                        // Not an asynchronous request -> enqueue response for application thread
-                        _response_queue.enqueue(msg);
-                    }
-                    else {
-                        // Pending request -> notify application
-                        handler->handleECM(*resp);
-                    }
-                    break;
-                }
-                default: {
-                    // Enqueue the message for application thread
-                    _response_queue.enqueue(msg);
-                    break;
-                }
+ts::UString ts::ECMGClient::LatencyStatistics::histogramString() const
+{
+    UString str;
+    for (size_t index = 0; index < LATENCY_BUCKETS; ++index) {
+        if (histogram[index] > 0) {
+            if (!str.empty()) {
+                str.append(u", ");
             }
-        }
-
-        // Error while receiving messages, most likely a disconnection
-        {
-            GuardMutex lock(_mutex);
-            if (_state == DESTRUCTING) {
-                return;
+            if (index + 1 < LATENCY_BUCKETS) {
+                str.format(u"<%dms: %'d", {BucketLimit(index), histogram[index]});
             }
-            if (_state != DISCONNECTED) {
-                _state = DISCONNECTED;
-                _connection.disconnect(NULLREP);
-                _connection.close(NULLREP);
+            else {
+                str.format(u">=%dms: %'d", {BucketLimit(index - 1), histogram[index]});
             }
         }
     }
+    return str;
 }
@@ -19,9 +19,9 @@
 #include "tsECMGClientHandlerInterface.h"
 #include "tstlvConnection.h"
 #include "tsMessageQueue.h"
-#include "tsCondition.h"
+#include "tsSingleDataStatistics.h"
+#include "tsMonotonic.h"
 #include "tsMutex.h"
-#include "tsThread.h"
 
 namespace ts {
     //!
@@ -30,10 +30,21 @@ namespace ts {
     //! Restriction: The target ECMG shall support only current or current/next control
     //! words in ECM, meaning CW_per_msg = 1 or 2 and lead_CW = 0 or 1.
     //!
+    //! Each ECMGClient object manages one ECM stream. The ECM channel, meaning the TCP
+    //! connection to the ECMG, is either private to the ECMGClient or shared between
+    //! all ECMGClient objects in the process which use the same ECMG, ECM_channel_id and
+    //! Super_CAS_id (see ECMGClientArgs::shared_channel). In a shared channel, the ECM
+    //! requests of all streams are multiplexed and correlated with their responses
+    //! using the ECM_stream_id and the crypto-period number.
+    //!
+    //! ECM requests are pipelined: up to ECMGClientArgs::max_outstanding requests are
+    //! simultaneously sent to the ECMG in a channel. Additional requests are queued and
+    //! sent when responses are received.
+    //!
     //! @see DVB standard ETSI TS 103.197 V1.4.1 for ECMG <=> SCS protocol.
     //! @ingroup mpeg
     //!
-    class TSDUCKDLL ECMGClient: private Thread
+    class TSDUCKDLL ECMGClient
     {
         TS_NOBUILD_NOCOPY(ECMGClient);
     public:
@@ -50,12 +61,16 @@ namespace ts {
         //!
         //! Destructor.
         //!
-        virtual ~ECMGClient() override;
+        virtual ~ECMGClient();
 
         //!
         //! Connect to a remote ECMG.
         //! Perform all initial channel and stream negotiation.
         //!
+        //! In a shared channel, when the ECM_stream_id or ECM_id of @a args are already used
+        //! by another client of the channel, the next free values are used. The actual values
+        //! are returned in @a stream_status.
+        //!
         //! @param [in] args Set of ECMG parameters.
         //! @param [out] channel_status Initial response to channel_setup
         //! @param [out] stream_status Initial response to stream_setup
@@ -111,7 +126,7 @@ namespace ts {
 
         //!
         //! Disconnect from remote ECMG.
-        //! Close stream and channel.
+        //! Close stream. Close the channel if this was the last stream of the channel.
         //! @return True on success, false on error.
         //!
         bool disconnect();
@@ -120,19 +135,66 @@ namespace ts {
         //! Check if the ECMG is connected.
         //! @return True if the ECMG is connected.
         //!
-        bool isConnected() const {return _state == CONNECTED;}
+        bool isConnected() const;
 
-    private:
-        // State of the client connection
-        enum State {
-            INITIAL,         // initial state, receiver thread not started
-            DISCONNECTED,    // no TCP connection
-            CONNECTING,      // opening channel and stream
-            CONNECTED,       // stream established
-            DISCONNECTING,   // closing stream and channel
-            DESTRUCTING,     // object destruction in progress
+        //!
+        //! Get the number of ECM requests of this client which are waiting for a response.
+        //! @return The number of ECM requests which are either sent to the ECMG or queued
+        //! in the channel and which have not yet been answered.
+        //!
+        size_t pendingRequests() const;
+
+        //!
+        //! Number of buckets in the histogram of ECM generation latencies.
+        //!
+        static constexpr size_t LATENCY_BUCKETS = 12;
+
+        //!
+        //! Statistics on the ECM generation latency.
+        //! The latency of an ECM request is measured from the submission of the
+        //! request by the application to the reception of the ECM. It includes
+        //! the queueing time in the channel.
+        //!
+        class TSDUCKDLL LatencyStatistics
+        {
+        public:
+            SingleDataStatistics<MilliSecond> latency {};  //!< Statistics in milliseconds.
+            std::array<size_t, LATENCY_BUCKETS> histogram {{}};  //!< Histogram, see BucketLimit().
+            size_t timeouts = 0;                           //!< Number of ECM requests without response.
+
+            //!
+            //! Get the upper limit of a bucket in the histogram of latencies.
+            //! The limits of the buckets are 1, 2, 5, 10, 20, 50 ms, etc.
+            //! @param [in] index Index of the bucket, from 0 to LATENCY_BUCKETS - 1.
+            //! @return The upper limit (excluded) of the bucket in milliseconds.
+            //! The last bucket has no upper limit and Infinite is returned.
+            //!
+            static MilliSecond BucketLimit(size_t index);
+
+            //!
+            //! Add the latency of one ECM request.
+            //! @param [in] value Latency in milliseconds.
+            //!
+            void feed(MilliSecond value);
+
+            //!
+            //! Format the non-empty buckets of the histogram.
+            //! @return A string such as "<10ms: 12, <20ms: 3, >=2000ms: 1".
+            //!
+            UString histogramString() const;
         };
 
+        //!
+        //! Get the statistics on the ECM generation latency of this client.
+        //! @return A copy of the latency statistics.
+        //!
+        LatencyStatistics latencyStatistics() const;
+
+    private:
+        // An ECM channel, possibly shared between several clients.
+        class Channel;
+        typedef SafePtr<Channel, Mutex> ChannelPtr;
+
         // Stack size for execution of the receiver thread
         static constexpr size_t RECEIVER_STACK_SIZE = 128 * 1024;
 
@@ -142,20 +204,15 @@ namespace ts {
         // Timeout for responses from ECMG (except ECM generation)
         static constexpr MilliSecond RESPONSE_TIMEOUT = 5000;
 
-        // List of asynchronous ECM requests: key=cp_number, value=handler
-        typedef std::map <uint16_t, ECMGClientHandlerInterface*> AsyncRequests;
-
         // Private members
         const ecmgscs::Protocol& _protocol;
-        State                    _state = INITIAL;
-        const AbortInterface*    _abort = nullptr;
+        const size_t             _extra_stack_size;
+        mutable Mutex            _mutex {};               // exclusive access to protected fields
+        ChannelPtr               _channel {};             // ECM channel when connected
+        ecmgscs::ChannelStatus   _channel_status {_protocol};  // initial response to channel_setup
+        ecmgscs::StreamStatus    _stream_status {_protocol};   // initial response to stream_setup
         tlv::Logger              _logger {};
-        tlv::Connection <Mutex>  _connection {_protocol, true, 3}; // connection with ECMG server
-        ecmgscs::ChannelStatus   _channel_status {_protocol};      // initial response to channel_setup
-        ecmgscs::StreamStatus    _stream_status {_protocol};       // initial response to stream_setup
-        Mutex                    _mutex {};          // exclusive access to protected fields
-        Condition                _work_to_do {};     // notify receiver thread to do some work
-        AsyncRequests            _async_requests {};
+        LatencyStatistics        _latency {};
         MessageQueue <tlv::Message, NullMutex> _response_queue {RESPONSE_QUEUE_SIZE};
 
         // Build a CW_provision message.
@@ -166,8 +223,8 @@ namespace ts {
                               const ByteBlock& ac,
                               uint16_t cp_duration);
 
-        // Receiver thread main code
-        virtual void main() override;
+        // Get the channel of a connected client, null pointer if not connected.
+        ChannelPtr channel() const;
 
         // Report specified error message if not empty, abort connection and return false
         bool abortConnection(const UString& = UString());
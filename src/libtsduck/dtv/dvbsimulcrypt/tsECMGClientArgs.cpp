@@ -9,6 +9,10 @@
 #include "tsECMGClientArgs.h"
 #include "tsArgs.h"
 
+#if !defined(TS_CXX17)
+constexpr size_t ts::ECMGClientArgs::DEFAULT_MAX_OUTSTANDING;
+#endif
+
 
 //----------------------------------------------------------------------------
 // Define command line options in an Args.
@@ -51,6 +55,19 @@ void ts::ECMGClientArgs::defineArgs(Args& args)
          u"option is present without value, the messages are logged at info level. "
          u"A level can be a numerical debug level or a name.");
 
+    args.option(u"max-outstanding", 0, Args::POSITIVE);
+    args.help(u"max-outstanding",
+              u"Specifies the maximum number of ECM requests which are simultaneously sent to the ECMG "
+              u"in the ECM channel, without waiting for the responses. Additional requests are queued "
+              u"and sent when responses are received. The default is " + UString::Decimal(DEFAULT_MAX_OUTSTANDING) + u".");
+
+    args.option(u"shared-channel", 0);
+    args.help(u"shared-channel",
+              u"Share the TCP connection and ECM channel with all other ECMG clients in the same process "
+              u"(typically other plugins in the same tsp command) which use the same ECMG, ECM_channel_id "
+              u"and Super_CAS_id. Each client uses a distinct ECM stream in the shared channel. If the "
+              u"specified ECM_stream_id or ECM_id is already used in the channel, the next free value is used.");
+
     args.option(u"stream-id", 0, Args::UINT16);
     args.help(u"stream-id", u"Specifies the DVB SimulCrypt ECM_stream_id for the ECMG (default: 1).");
 
@@ -76,5 +93,7 @@ bool ts::ECMGClientArgs::loadArgs(DuckContext& duck, Args& args)
     args.getIntValue(dvbsim_version, u"ecmg-scs-version", 2);
     args.getHexaValue(access_criteria, u"access-criteria");
     args.getSocketValue(ecmg_address, u"ecmg");
+    args.getIntValue(max_outstanding, u"max-outstanding", DEFAULT_MAX_OUTSTANDING);
+    shared_channel = args.present(u"shared-channel");
     return true;
 }
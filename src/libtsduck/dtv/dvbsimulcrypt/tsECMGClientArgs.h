@@ -33,6 +33,11 @@ namespace ts {
         //!
         ECMGClientArgs() = default;
 
+        //!
+        //! Default maximum number of ECM requests which are simultaneously sent in an ECM channel.
+        //!
+        static constexpr size_t DEFAULT_MAX_OUTSTANDING = 16;
+
         // Public fields, by options.
         IPv4SocketAddress ecmg_address {};      //!< -\-ecmg, ECMG socket address (required or optional)
         uint32_t          super_cas_id = 0;     //!< -\-super-cas-id, CA system & subsystem id
@@ -44,6 +49,8 @@ namespace ts {
         uint16_t          ecm_id = 0;           //!< -\-ecm-id
         int               log_protocol = 0;     //!< -\-log-protocol
         int               log_data = 0;         //!< -\-log-data
+        bool              shared_channel = false;                     //!< -\-shared-channel
+        size_t            max_outstanding = DEFAULT_MAX_OUTSTANDING;  //!< -\-max-outstanding
 
         //!
         //! Add command line option definitions in an Args.
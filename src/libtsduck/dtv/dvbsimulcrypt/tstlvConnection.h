@@ -13,6 +13,7 @@
 
 #pragma once
 #include "tsTCPConnection.h"
+#include "tsIPUtils.h"
 #include "tstlvProtocol.h"
 #include "tstlvMessageFactory.h"
 #include "tstlvMessage.h"
@@ -94,6 +95,50 @@ namespace ts {
             //!
             bool receive(MessagePtr& msg, const AbortInterface* abort, Logger& logger);
 
+            //!
+            //! Receive a TLV message from a non-blocking socket.
+            //!
+            //! This method is designed for event-driven servers. The socket must have been
+            //! set in non-blocking mode using setNonBlocking(). The method never waits.
+            //! Available data are read from the socket and accumulated in an internal buffer.
+            //! When a complete message is available, it is deserialized and validated.
+            //! Invalid messages are processed as in receive().
+            //!
+            //! @param [out] msg A safe pointer to the received message. Set to null when
+            //! no complete message is available yet. Call the method again until @a msg is
+            //! null to get all messages which are already available.
+            //! @param [in,out] logger Where to report errors and messages.
+            //! @return True on success, false on error or disconnection from the peer.
+            //!
+            bool receiveNonBlocking(MessagePtr& msg, Logger& logger);
+
+            //!
+            //! Serialize and send a TLV message on a non-blocking socket.
+            //!
+            //! The message is serialized and appended to an internal output buffer.
+            //! As much data as possible are immediately sent without waiting. The rest
+            //! is sent later by flushOutput(), typically when the socket becomes writable.
+            //!
+            //! @param [in] msg The message to send.
+            //! @param [in,out] logger Where to report errors and messages.
+            //! @return True on success, false on error.
+            //!
+            bool sendNonBlocking(const Message& msg, Logger& logger);
+
+            //!
+            //! Send as much pending output data as possible on a non-blocking socket.
+            //! @param [in,out] report Where to report errors.
+            //! @return True on success, false on error.
+            //! @see sendNonBlocking()
+            //!
+            bool flushOutput(Report& report);
+
+            //!
+            //! Get the size of the pending output data on a non-blocking socket.
+            //! @return The number of bytes which are waiting to be sent by flushOutput().
+            //!
+            size_t pendingOutputSize() const { return _out_data.size() - _out_start; }
+
             //!
             //! Get invalid incoming messages processing.
             //! @return True if, when an invalid message is received, the corresponding
@@ -133,6 +178,20 @@ namespace ts {
             size_t          _invalid_msg_count = 0;
             MUTEX           _send_mutex {};
             MUTEX           _receive_mutex {};
+            ByteBlock       _in_data {};     // Input buffer in non-blocking mode, never shrinks.
+            size_t          _in_start = 0;   // Start of unprocessed data in _in_data.
+            size_t          _in_end = 0;     // End of received data in _in_data.
+            ByteBlock       _out_data {};    // Output buffer in non-blocking mode.
+            size_t          _out_start = 0;  // Start of unsent data in _out_data.
+
+            // Size of a message header.
+            size_t headerSize() const { return _protocol.hasVersion() ? 5 : 4; }
+
+            // Process an invalid message. Return false when the connection must be broken.
+            bool invalidMessage(MessageFactory& mf, Logger& logger, bool non_blocking);
+
+            // Send data on a non-blocking socket. Return false on error.
+            bool sendSome(Report& report);
         };
     }
 }
@@ -183,7 +242,7 @@ bool ts::tlv::Connection<MUTEX>::send(const Message& msg, Logger& logger)
     Serializer serial(bbp);
     msg.serialize(serial);
 
-    GuardMutex lock(_send_mutex);
+    TemplateGuardMutex<MUTEX> lock(_send_mutex);
     return SuperClass::send(bbp->data(), bbp->size(), logger.report());
 }
 
@@ -209,7 +268,7 @@ bool ts::tlv::Connection<MUTEX>::receive(MessagePtr& msg, const AbortInterface*
 
         // Receive complete message
         {
-            GuardMutex lock(_receive_mutex);
+            TemplateGuardMutex<MUTEX> lock(_receive_mutex);
 
             // Read message header
             if (!SuperClass::receive(bb.data(), header_size, abort, logger.report())) {
@@ -236,22 +295,172 @@ bool ts::tlv::Connection<MUTEX>::receive(MessagePtr& msg, const AbortInterface*
         }
 
         // Received an invalid message
-        _invalid_msg_count++;
+        if (!invalidMessage(mf, logger, false)) {
+            return false;
+        }
+    }
+}
+
+// Process an invalid message. Return false when the connection must be broken.
+template <class MUTEX>
+bool ts::tlv::Connection<MUTEX>::invalidMessage(MessageFactory& mf, Logger& logger, bool non_blocking)
+{
+    _invalid_msg_count++;
+
+    // Send back an error message if necessary
+    if (_auto_error_response) {
+        MessagePtr resp;
+        mf.buildErrorResponse(resp);
+        if (!(non_blocking ? sendNonBlocking(*resp, logger) : send(*resp, logger.report()))) {
+            return false;
+        }
+    }
+
+    // If invalid message max has been reached, break the connection
+    if (_max_invalid_msg > 0 && _invalid_msg_count >= _max_invalid_msg) {
+        logger.report().error(u"too many invalid messages from %s, disconnecting", {peerName()});
+        disconnect(logger.report());
+        return false;
+    }
+    return true;
+}
+
+// Receive a TLV message from a non-blocking socket.
+template <class MUTEX>
+bool ts::tlv::Connection<MUTEX>::receiveNonBlocking(MessagePtr& msg, Logger& logger)
+{
+    const size_t header_size = headerSize();
+    const size_t length_offset = header_size - 2;
+    msg.clear();
 
-        // Send back an error message if necessary
-        if (_auto_error_response) {
-            MessagePtr resp;
-            mf.buildErrorResponse(resp);
-            if (!send(*resp, logger.report())) {
+    TemplateGuardMutex<MUTEX> lock(_receive_mutex);
+    for (;;) {
+        // Extract all complete messages from the input buffer.
+        while (_in_end - _in_start >= header_size) {
+            const uint8_t* const data = _in_data.data() + _in_start;
+            const size_t size = header_size + GetUInt16(data + length_offset);
+            if (_in_end - _in_start < size) {
+                break;
+            }
+            _in_start += size;
+
+            // Analyze the message
+            MessageFactory mf(data, size, _protocol);
+            if (mf.errorStatus() == tlv::OK) {
+                _invalid_msg_count = 0;
+                mf.factory(msg);
+                if (!msg.isNull()) {
+                    logger.log(*msg, u"received message from " + peerName());
+                    return true;
+                }
+            }
+            else if (!invalidMessage(mf, logger, true)) {
                 return false;
             }
         }
 
-        // If invalid message max has been reached, break the connection
-        if (_max_invalid_msg > 0 && _invalid_msg_count >= _max_invalid_msg) {
-            logger.report().error(u"too many invalid messages from %s, disconnecting", {peerName()});
-            disconnect(logger.report());
+        // Compact the input buffer before reading more data.
+        if (_in_start > 0) {
+            std::memmove(_in_data.data(), _in_data.data() + _in_start, _in_end - _in_start);
+            _in_end -= _in_start;
+            _in_start = 0;
+        }
+
+        // Read as much data as possible, without waiting. The buffer is enlarged only when
+        // necessary, to avoid clearing a new receive area at each read.
+        constexpr size_t min_receive_size = 16384;
+        if (_in_data.size() - _in_end < min_receive_size) {
+            _in_data.resize(_in_end + min_receive_size);
+        }
+        const SysSocketSignedSizeType got = ::recv(getSocket(), SysRecvBufferPointer(_in_data.data() + _in_end), int(_in_data.size() - _in_end), 0);
+        if (got > 0) {
+            _in_end += size_t(got);
+        }
+
+        if (got == 0) {
+            // End of connection from the peer.
+            logger.report().debug(u"peer %s disconnected", {peerName()});
+            return false;
+        }
+        else if (got < 0) {
+            const SysSocketErrorCode err = LastSysSocketErrorCode();
+#if !defined(TS_WINDOWS)
+            if (err == EINTR) {
+                continue;
+            }
+            if (err == EAGAIN) {
+                return true;
+            }
+#endif
+            if (err == SYS_SOCKET_ERR_WOULDBLOCK) {
+                // No more data available now, message incomplete.
+                return true;
+            }
+            logger.report().error(u"error receiving data from socket: %s", {SysSocketErrorCodeMessage(err)});
+            return false;
+        }
+    }
+}
+
+// Serialize and send a TLV message on a non-blocking socket.
+template <class MUTEX>
+bool ts::tlv::Connection<MUTEX>::sendNonBlocking(const Message& msg, Logger& logger)
+{
+    logger.log(msg, u"sending message to " + peerName());
+
+    ByteBlockPtr bbp(new ByteBlock);
+    Serializer serial(bbp);
+    msg.serialize(serial);
+
+    TemplateGuardMutex<MUTEX> lock(_send_mutex);
+    _out_data.append(*bbp);
+    return sendSome(logger.report());
+}
+
+// Send as much pending output data as possible on a non-blocking socket.
+template <class MUTEX>
+bool ts::tlv::Connection<MUTEX>::flushOutput(Report& report)
+{
+    TemplateGuardMutex<MUTEX> lock(_send_mutex);
+    return sendSome(report);
+}
+
+// Send data on a non-blocking socket, with send mutex held.
+template <class MUTEX>
+bool ts::tlv::Connection<MUTEX>::sendSome(Report& report)
+{
+    while (_out_start < _out_data.size()) {
+        const SysSocketSignedSizeType gone = ::send(getSocket(), SysSendBufferPointer(_out_data.data() + _out_start), SysSendSizeType(_out_data.size() - _out_start), 0);
+        if (gone > 0) {
+            _out_start += size_t(gone);
+        }
+        else {
+            const SysSocketErrorCode err = LastSysSocketErrorCode();
+#if !defined(TS_WINDOWS)
+            if (err == EINTR) {
+                continue;
+            }
+            if (err == EAGAIN) {
+                break;
+            }
+#endif
+            if (err == SYS_SOCKET_ERR_WOULDBLOCK) {
+                // Socket buffer full, will be sent later.
+                break;
+            }
+            report.error(u"error sending data to socket: %s", {SysSocketErrorCodeMessage(err)});
             return false;
         }
     }
+
+    // Release sent data.
+    if (_out_start >= _out_data.size()) {
+        _out_data.clear();
+        _out_start = 0;
+    }
+    else if (_out_start > 65536) {
+        _out_data.erase(0, _out_start);
+        _out_start = 0;
+    }
+    return true;
 }
@@ -0,0 +1,541 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+
+#include "tstlvServer.h"
+#include "tsNullReport.h"
+#include "tsIPUtils.h"
+#include "tsSysUtils.h"
+
+#if defined(TS_LINUX)
+    #include "tsBeforeStandardHeaders.h"
+    #include <sys/epoll.h>
+    #include "tsAfterStandardHeaders.h"
+#elif defined(TS_UNIX)
+    #include "tsBeforeStandardHeaders.h"
+    #include <poll.h>
+    #include "tsAfterStandardHeaders.h"
+#endif
+
+namespace {
+    // Maximum wait time in the event loop, to check termination requests.
+    constexpr ts::MilliSecond STOP_CHECK_INTERVAL = 200;
+
+    // Maximum number of events per wait.
+    constexpr size_t MAX_EVENTS = 256;
+}
+
+
+//----------------------------------------------------------------------------
+// System-specific event polling.
+//----------------------------------------------------------------------------
+
+class ts::tlv::Server::Guts
+{
+    TS_NOCOPY(Guts);
+public:
+    // Description of an event.
+    class Event
+    {
+    public:
+        uint32_t id = 0;
+        bool     readable = false;
+        bool     writable = false;
+    };
+
+    // Constructor and destructor.
+    Guts() = default;
+    ~Guts();
+
+    // Initialize the polling mechanism.
+    bool init(Report& report);
+
+    // Add, modify or remove a socket. Always watch read events.
+    bool add(SysSocketType sock, uint32_t id, bool write, Report& report);
+    bool modify(SysSocketType sock, uint32_t id, bool write, Report& report);
+    void remove(SysSocketType sock);
+
+    // Wait for events. Return false on error.
+    bool wait(MilliSecond timeout, std::vector<Event>& events, Report& report);
+
+private:
+#if defined(TS_LINUX)
+    int _epoll = -1;
+    bool control(int op, SysSocketType sock, uint32_t id, bool write, Report& report);
+#else
+    std::map<SysSocketType, std::pair<uint32_t, bool>> _sockets {};
+#endif
+};
+
+#if defined(TS_LINUX)
+
+ts::tlv::Server::Guts::~Guts()
+{
+    if (_epoll >= 0) {
+        ::close(_epoll);
+    }
+}
+
+bool ts::tlv::Server::Guts::init(Report& report)
+{
+    if (_epoll < 0 && (_epoll = ::epoll_create1(EPOLL_CLOEXEC)) < 0) {
+        report.error(u"error creating epoll: %s", {SysErrorCodeMessage()});
+        return false;
+    }
+    return true;
+}
+
+bool ts::tlv::Server::Guts::control(int op, SysSocketType sock, uint32_t id, bool write, Report& report)
+{
+    ::epoll_event ev;
+    TS_ZERO(ev);
+    ev.events = write ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+    ev.data.u32 = id;
+    if (::epoll_ctl(_epoll, op, sock, &ev) != 0) {
+        report.error(u"epoll_ctl error: %s", {SysErrorCodeMessage()});
+        return false;
+    }
+    return true;
+}
+
+bool ts::tlv::Server::Guts::add(SysSocketType sock, uint32_t id, bool write, Report& report)
+{
+    return control(EPOLL_CTL_ADD, sock, id, write, report);
+}
+
+bool ts::tlv::Server::Guts::modify(SysSocketType sock, uint32_t id, bool write, Report& report)
+{
+    return control(EPOLL_CTL_MOD, sock, id, write, report);
+}
+
+void ts::tlv::Server::Guts::remove(SysSocketType sock)
+{
+    ::epoll_event ev;
+    TS_ZERO(ev);
+    ::epoll_ctl(_epoll, EPOLL_CTL_DEL, sock, &ev);
+}
+
+bool ts::tlv::Server::Guts::wait(MilliSecond timeout, std::vector<Event>& events, Report& report)
+{
+    ::epoll_event evs[MAX_EVENTS];
+    events.clear();
+    const int count = ::epoll_wait(_epoll, evs, int(MAX_EVENTS), int(timeout));
+    if (count < 0) {
+        if (errno == EINTR) {
+            return true;
+        }
+        report.error(u"epoll_wait error: %s", {SysErrorCodeMessage()});
+        return false;
+    }
+    events.resize(size_t(count));
+    for (size_t i = 0; i < events.size(); ++i) {
+        events[i].id = evs[i].data.u32;
+        // Errors and hang-ups are detected on read.
+        events[i].readable = (evs[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) != 0;
+        events[i].writable = (evs[i].events & EPOLLOUT) != 0;
+    }
+    return true;
+}
+
+#else
+
+ts::tlv::Server::Guts::~Guts()
+{
+}
+
+bool ts::tlv::Server::Guts::init(Report&)
+{
+    return true;
+}
+
+bool ts::tlv::Server::Guts::add(SysSocketType sock, uint32_t id, bool write, Report&)
+{
+    _sockets[sock] = std::make_pair(id, write);
+    return true;
+}
+
+bool ts::tlv::Server::Guts::modify(SysSocketType sock, uint32_t id, bool write, Report& report)
+{
+    return add(sock, id, write, report);
+}
+
+void ts::tlv::Server::Guts::remove(SysSocketType sock)
+{
+    _sockets.erase(sock);
+}
+
+bool ts::tlv::Server::Guts::wait(MilliSecond timeout, std::vector<Event>& events, Report& report)
+{
+#if defined(TS_WINDOWS)
+    std::vector<::WSAPOLLFD> fds(_sockets.size());
+    constexpr short read_flags = POLLRDNORM;
+    constexpr short write_flags = POLLWRNORM;
+#else
+    std::vector<::pollfd> fds(_sockets.size());
+    constexpr short read_flags = POLLIN;
+    constexpr short write_flags = POLLOUT;
+#endif
+
+    events.clear();
+    size_t index = 0;
+    for (const auto& it : _sockets) {
+        fds[index].fd = it.first;
+        fds[index].events = short(read_flags | (it.second.second ? write_flags : 0));
+        fds[index].revents = 0;
+        index++;
+    }
+
+#if defined(TS_WINDOWS)
+    // Unlike poll(), WSAPoll() fails with an empty set of sockets. Just wait for the timers.
+    if (fds.empty()) {
+        SleepThread(timeout);
+        return true;
+    }
+    const int count = ::WSAPoll(fds.data(), ULONG(fds.size()), INT(timeout));
+#else
+    const int count = ::poll(fds.data(), ::nfds_t(fds.size()), int(timeout));
+#endif
+    if (count < 0) {
+#if !defined(TS_WINDOWS)
+        if (errno == EINTR) {
+            return true;
+        }
+#endif
+        report.error(u"poll error: %s", {SysSocketErrorCodeMessage()});
+        return false;
+    }
+
+    for (const auto& fd : fds) {
+        if (fd.revents != 0) {
+            Event ev;
+            ev.id = _sockets[fd.fd].first;
+            ev.readable = (fd.revents & (read_flags | POLLERR | POLLHUP)) != 0;
+            ev.writable = (fd.revents & write_flags) != 0;
+            events.push_back(ev);
+        }
+    }
+    return true;
+}
+
+#endif
+
+
+//----------------------------------------------------------------------------
+// Constructor and destructor.
+//----------------------------------------------------------------------------
+
+ts::tlv::Server::Server(const Protocol& protocol, ServerHandlerInterface* handler, Logger& logger, size_t max_invalid_msg) :
+    _protocol(protocol),
+    _handler(handler),
+    _logger(logger),
+    _max_invalid_msg(max_invalid_msg),
+    _timers(1, TimerWheel<std::pair<uint32_t, uint64_t>>::DEFAULT_SLOTS, 0),
+    _guts(new Guts)
+{
+}
+
+ts::tlv::Server::~Server()
+{
+    close();
+    delete _guts;
+    _guts = nullptr;
+}
+
+
+//----------------------------------------------------------------------------
+// Current time in milliseconds since origin.
+//----------------------------------------------------------------------------
+
+ts::MilliSecond ts::tlv::Server::now() const
+{
+    return (Monotonic(true) - _origin) / NanoSecPerMilliSec;
+}
+
+
+//----------------------------------------------------------------------------
+// Open the server and start listening for clients.
+//----------------------------------------------------------------------------
+
+bool ts::tlv::Server::open(const IPv4SocketAddress& address, bool reuse_port, int backlog)
+{
+    Report& report(_logger.report());
+    if (_accepting) {
+        report.error(u"TLV server already open");
+        return false;
+    }
+    if (!_guts->init(report) ||
+        !_server.open(report) ||
+        !_server.reusePort(reuse_port, report) ||
+        !_server.bind(address, report) ||
+        !_server.listen(backlog, report) ||
+        !_server.setNonBlocking(true, report) ||
+        !_guts->add(_server.getSocket(), 0, false, report))
+    {
+        _server.close(NULLREP);
+        return false;
+    }
+    _accepting = true;
+    _terminate = false;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Stop accepting new clients.
+//----------------------------------------------------------------------------
+
+void ts::tlv::Server::stopAccepting()
+{
+    if (_accepting) {
+        _guts->remove(_server.getSocket());
+        _server.close(NULLREP);
+        _accepting = false;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Close the server, disconnect all clients.
+//----------------------------------------------------------------------------
+
+void ts::tlv::Server::close()
+{
+    stopAccepting();
+    for (const auto& it : _clients) {
+        disconnect(it.first);
+    }
+    processClosing();
+    _timers.clear();
+}
+
+
+//----------------------------------------------------------------------------
+// Run the event loop.
+//----------------------------------------------------------------------------
+
+bool ts::tlv::Server::run()
+{
+    std::vector<Guts::Event> events;
+    events.reserve(MAX_EVENTS);
+
+    // Loop until explicit termination or nothing more to serve.
+    while (!_terminate && (_accepting || !_clients.empty())) {
+
+        // Wait for I/O events until the next timer may expire.
+        const MilliSecond timeout = std::min(_timers.nextTimeout(now()), STOP_CHECK_INTERVAL);
+        if (!_guts->wait(timeout, events, _logger.report())) {
+            return false;
+        }
+
+        // Process I/O events.
+        for (const auto& ev : events) {
+            if (ev.id == 0) {
+                acceptClients();
+            }
+            else {
+                processClient(ev.id, ev.readable, ev.writable);
+            }
+            processClosing();
+        }
+
+        // Process expired timers.
+        processTimers();
+        processClosing();
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Accept all pending clients.
+//----------------------------------------------------------------------------
+
+void ts::tlv::Server::acceptClients()
+{
+    Report& report(_logger.report());
+
+    while (_accepting) {
+        ClientPtr ctx(new Client);
+        ctx->conn = new ClientConnection(_protocol, true, _max_invalid_msg);
+        IPv4SocketAddress addr;
+
+        // The listening socket is non-blocking, stop when there is no more pending client.
+        if (!_server.accept(*ctx->conn, addr, NULLREP)) {
+            const SysSocketErrorCode err = LastSysSocketErrorCode();
+#if !defined(TS_WINDOWS)
+            if (err == EAGAIN || err == EINTR) {
+                break;
+            }
+#endif
+            if (err != SYS_SOCKET_ERR_WOULDBLOCK) {
+                report.error(u"error accepting TCP client: %s", {SysSocketErrorCodeMessage(err)});
+            }
+            break;
+        }
+
+        // Register the new client.
+        const uint32_t id = _next_client++;
+        if (!ctx->conn->setNonBlocking(true, report) || !_guts->add(ctx->conn->getSocket(), id, false, report)) {
+            ctx->conn->disconnect(NULLREP);
+            ctx->conn->close(NULLREP);
+            continue;
+        }
+        _clients[id] = ctx;
+        report.debug(u"client %d connected from %s", {id, addr});
+        _handler->handleConnection(*this, id);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Process input and output events on a client.
+//----------------------------------------------------------------------------
+
+void ts::tlv::Server::processClient(uint32_t client, bool readable, bool writable)
+{
+    const auto it = _clients.find(client);
+    if (it == _clients.end() || it->second->closing) {
+        return;
+    }
+
+    // Keep a reference on the client while calling handlers.
+    ClientPtr ctx(it->second);
+
+    // Send pending output data.
+    if (writable && !ctx->conn->flushOutput(_logger.report())) {
+        disconnect(client);
+        return;
+    }
+
+    // Process all complete messages which are available.
+    if (readable) {
+        MessagePtr msg;
+        while (!ctx->closing) {
+            if (!ctx->conn->receiveNonBlocking(msg, _logger)) {
+                disconnect(client);
+                return;
+            }
+            if (msg.isNull()) {
+                break;
+            }
+            _handler->handleMessage(*this, client, msg);
+        }
+    }
+
+    updateWriting(client, *ctx);
+}
+
+
+//----------------------------------------------------------------------------
+// Update the interest in write events of a client.
+//----------------------------------------------------------------------------
+
+void ts::tlv::Server::updateWriting(uint32_t client, Client& ctx)
+{
+    const bool writing = ctx.conn->pendingOutputSize() > 0;
+    if (!ctx.closing && writing != ctx.writing) {
+        if (_guts->modify(ctx.conn->getSocket(), client, writing, _logger.report())) {
+            ctx.writing = writing;
+        }
+        else {
+            disconnect(client);
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Send a message to a client.
+//----------------------------------------------------------------------------
+
+bool ts::tlv::Server::send(uint32_t client, const Message& msg)
+{
+    const auto it = _clients.find(client);
+    if (it == _clients.end() || it->second->closing) {
+        return false;
+    }
+    else if (!it->second->conn->sendNonBlocking(msg, _logger)) {
+        disconnect(client);
+        return false;
+    }
+    else {
+        updateWriting(client, *it->second);
+        return true;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Client management.
+//----------------------------------------------------------------------------
+
+void ts::tlv::Server::disconnect(uint32_t client)
+{
+    const auto it = _clients.find(client);
+    if (it != _clients.end() && !it->second->closing) {
+        it->second->closing = true;
+        _closing.insert(client);
+    }
+}
+
+bool ts::tlv::Server::isConnected(uint32_t client) const
+{
+    const auto it = _clients.find(client);
+    return it != _clients.end() && !it->second->closing;
+}
+
+ts::UString ts::tlv::Server::peerName(uint32_t client) const
+{
+    const auto it = _clients.find(client);
+    return it == _clients.end() ? UString() : it->second->conn->peerName();
+}
+
+void ts::tlv::Server::processClosing()
+{
+    // The handlers may request more disconnections.
+    while (!_closing.empty()) {
+        const uint32_t client = *_closing.begin();
+        _closing.erase(_closing.begin());
+        const auto it = _clients.find(client);
+        if (it != _clients.end()) {
+            ClientPtr ctx(it->second);
+            _clients.erase(it);
+            _guts->remove(ctx->conn->getSocket());
+            ctx->conn->disconnect(NULLREP);
+            ctx->conn->close(NULLREP);
+            _logger.report().debug(u"client %d disconnected", {client});
+            _handler->handleDisconnection(*this, client);
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Timer management.
+//----------------------------------------------------------------------------
+
+ts::tlv::Server::TimerId ts::tlv::Server::startTimer(uint32_t client, MilliSecond delay, uint64_t cookie)
+{
+    return isConnected(client) ? _timers.start(now() + delay, std::make_pair(client, cookie)) : TimerWheel<std::pair<uint32_t, uint64_t>>::INVALID_TIMER;
+}
+
+bool ts::tlv::Server::cancelTimer(TimerId id)
+{
+    return _timers.cancel(id);
+}
+
+void ts::tlv::Server::processTimers()
+{
+    std::vector<std::pair<uint32_t, uint64_t>> expired;
+    _timers.expire(now(), expired);
+    for (const auto& it : expired) {
+        // Timers of disconnected clients are silently dropped.
+        if (isConnected(it.first)) {
+            _handler->handleTimer(*this, it.first, it.second);
+        }
+    }
+}
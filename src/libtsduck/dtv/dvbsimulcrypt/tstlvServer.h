@@ -0,0 +1,220 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Event-driven multi-client TCP server using TLV messages.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tstlvServerHandlerInterface.h"
+#include "tstlvConnection.h"
+#include "tsTCPServer.h"
+#include "tsTimerWheel.h"
+#include "tsMonotonic.h"
+#include "tsNullMutex.h"
+
+namespace ts {
+    namespace tlv {
+        //!
+        //! Event-driven multi-client TCP server using TLV messages.
+        //! @ingroup net
+        //!
+        //! This class is a framework for DVB SimulCrypt servers such as ECMG or EMMG/MUX
+        //! simulators. All client connections are handled in one single thread, the one
+        //! which calls run(), using non-blocking sockets. On Linux, the sockets are monitored
+        //! using epoll(). On other systems, poll() is used.
+        //!
+        //! Incoming messages, timers and client connections and disconnections are notified
+        //! to a ServerHandlerInterface. Each timer is attached to a client. Timers are managed
+        //! in a timer wheel, allowing thousands of concurrent timers (typically crypto-period
+        //! durations or emulated computation delays).
+        //!
+        //! All methods, except stop(), must be called from the thread which executes run(),
+        //! typically from the handler.
+        //!
+        class TSDUCKDLL Server
+        {
+            TS_NOBUILD_NOCOPY(Server);
+        public:
+            //!
+            //! Identifier of a timer.
+            //!
+            typedef TimerWheel<std::pair<uint32_t, uint64_t>>::TimerId TimerId;
+
+            //!
+            //! Constructor.
+            //! @param [in] protocol The incoming messages are interpreted according to this protocol.
+            //! The reference is kept in this object.
+            //! @param [in] handler The object which handles all events.
+            //! @param [in,out] logger Where to report errors and messages.
+            //! The reference is kept in this object.
+            //! @param [in] max_invalid_msg When non-zero, a client is automatically disconnected
+            //! when the number of consecutive invalid messages has reached this value.
+            //!
+            Server(const Protocol& protocol, ServerHandlerInterface* handler, Logger& logger, size_t max_invalid_msg = 3);
+
+            //!
+            //! Destructor.
+            //!
+            ~Server();
+
+            //!
+            //! Open the server and start listening for clients.
+            //! @param [in] address Local socket address to listen to.
+            //! @param [in] reuse_port If true, set the "reuse port" socket option.
+            //! @param [in] backlog Maximum number of incoming connections which are waiting to be accepted.
+            //! @return True on success, false on error.
+            //!
+            bool open(const IPv4SocketAddress& address, bool reuse_port = true, int backlog = 16);
+
+            //!
+            //! Close the server, disconnect all clients.
+            //!
+            void close();
+
+            //!
+            //! Run the event loop until stop() is called or the server is closed.
+            //! @return True on normal termination, false on error.
+            //!
+            bool run();
+
+            //!
+            //! Request the termination of the event loop.
+            //! This method can be called from any thread or from a handler.
+            //! The event loop terminates within a few hundred milliseconds.
+            //!
+            void stop() { _terminate = true; }
+
+            //!
+            //! Stop accepting new clients.
+            //! Already connected clients are still served.
+            //!
+            void stopAccepting();
+
+            //!
+            //! Send a message to a client.
+            //! The message is serialized and queued. It is sent as soon as possible without blocking
+            //! the event loop. In case of error, the client is disconnected.
+            //! @param [in] client Client identifier.
+            //! @param [in] msg The message to send.
+            //! @return True on success, false on error or unknown client.
+            //!
+            bool send(uint32_t client, const Message& msg);
+
+            //!
+            //! Disconnect a client.
+            //! The client is disconnected when the current handler returns.
+            //! @param [in] client Client identifier.
+            //!
+            void disconnect(uint32_t client);
+
+            //!
+            //! Check if a client is connected.
+            //! @param [in] client Client identifier.
+            //! @return True if the client is connected and not being disconnected.
+            //!
+            bool isConnected(uint32_t client) const;
+
+            //!
+            //! Get the name of the peer of a client.
+            //! @param [in] client Client identifier.
+            //! @return The peer name or an empty string if the client is unknown.
+            //!
+            UString peerName(uint32_t client) const;
+
+            //!
+            //! Get the number of connected clients.
+            //! @return The number of connected clients.
+            //!
+            size_t clientCount() const { return _clients.size(); }
+
+            //!
+            //! Start a timer for a client.
+            //! When the timer expires, ServerHandlerInterface::handleTimer() is invoked.
+            //! @param [in] client Client identifier.
+            //! @param [in] delay Delay in milliseconds. The resolution of timers is one millisecond.
+            //! @param [in] cookie Application data which are passed to the handler.
+            //! @return Timer identifier or TimerWheel::INVALID_TIMER if the client is unknown.
+            //!
+            TimerId startTimer(uint32_t client, MilliSecond delay, uint64_t cookie = 0);
+
+            //!
+            //! Cancel a timer.
+            //! @param [in] id Timer identifier.
+            //! @return True if the timer was cancelled, false if it already expired.
+            //!
+            bool cancelTimer(TimerId id);
+
+            //!
+            //! Get the number of active timers.
+            //! @return The number of active timers, including timers of disconnected clients
+            //! which have not yet expired.
+            //!
+            size_t timerCount() const { return _timers.size(); }
+
+            //!
+            //! Get the logger of the server.
+            //! @return A reference to the logger of the server.
+            //!
+            Logger& logger() { return _logger; }
+
+        private:
+            // The client connections are handled in one single thread.
+            typedef Connection<NullMutex> ClientConnection;
+            typedef SafePtr<ClientConnection, NullMutex> ClientConnectionPtr;
+
+            // Description of a client.
+            class Client
+            {
+                TS_NOCOPY(Client);
+            public:
+                Client() = default;
+                ClientConnectionPtr conn {};          // Connection to the client.
+                bool                closing = false;  // Disconnection requested.
+                bool                writing = false;  // Waiting for the socket to be writable.
+            };
+            typedef SafePtr<Client, NullMutex> ClientPtr;
+            typedef std::map<uint32_t, ClientPtr> ClientMap;
+
+            // Private fields.
+            const Protocol&          _protocol;
+            ServerHandlerInterface*  _handler;
+            Logger&                  _logger;
+            const size_t             _max_invalid_msg;
+            TCPServer                _server {};
+            bool                     _accepting = false;
+            volatile bool            _terminate = false;
+            uint32_t                 _next_client = 1;        // Client ids, zero is the listener.
+            ClientMap                _clients {};
+            std::set<uint32_t>       _closing {};             // Clients to disconnect.
+            Monotonic                _origin {true};          // Time origin of timers.
+            TimerWheel<std::pair<uint32_t, uint64_t>> _timers;
+            class Guts;                                       // Event polling, system-specific.
+            Guts*                    _guts = nullptr;
+
+            // Current time in milliseconds since origin.
+            MilliSecond now() const;
+
+            // Accept all pending clients.
+            void acceptClients();
+
+            // Process input and output events on a client.
+            void processClient(uint32_t client, bool readable, bool writable);
+
+            // Update the interest in write events of a client.
+            void updateWriting(uint32_t client, Client& ctx);
+
+            // Execute all pending disconnections.
+            void processClosing();
+
+            // Process all expired timers.
+            void processTimers();
+        };
+    }
+}
@@ -0,0 +1,26 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+
+#include "tstlvServerHandlerInterface.h"
+
+ts::tlv::ServerHandlerInterface::~ServerHandlerInterface()
+{
+}
+
+// Default implementations do nothing.
+void ts::tlv::ServerHandlerInterface::handleConnection(Server&, uint32_t)
+{
+}
+
+void ts::tlv::ServerHandlerInterface::handleTimer(Server&, uint32_t, uint64_t)
+{
+}
+
+void ts::tlv::ServerHandlerInterface::handleDisconnection(Server&, uint32_t)
+{
+}
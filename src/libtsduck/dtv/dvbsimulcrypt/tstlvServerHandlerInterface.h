@@ -0,0 +1,73 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Interface for classes which handle events from a TLV server.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tstlvMessage.h"
+
+namespace ts {
+    namespace tlv {
+
+        class Server;
+
+        //!
+        //! Interface for classes which handle events from a TLV server.
+        //! @ingroup net
+        //!
+        //! All handlers are invoked in the context of the thread which executes Server::run().
+        //! A handler may call any method of the server, including sending messages,
+        //! starting timers and disconnecting clients.
+        //!
+        class TSDUCKDLL ServerHandlerInterface
+        {
+        public:
+            //!
+            //! Invoked when a new client is connected.
+            //! The default implementation does nothing.
+            //! @param [in,out] server The TLV server.
+            //! @param [in] client Identifier of the new client.
+            //!
+            virtual void handleConnection(Server& server, uint32_t client);
+
+            //!
+            //! Invoked when a valid TLV message is received from a client.
+            //! @param [in,out] server The TLV server.
+            //! @param [in] client Identifier of the client.
+            //! @param [in] msg The received message.
+            //!
+            virtual void handleMessage(Server& server, uint32_t client, const MessagePtr& msg) = 0;
+
+            //!
+            //! Invoked when a timer of a client expires.
+            //! The default implementation does nothing.
+            //! @param [in,out] server The TLV server.
+            //! @param [in] client Identifier of the client.
+            //! @param [in] cookie The application data which were specified when the timer was started.
+            //!
+            virtual void handleTimer(Server& server, uint32_t client, uint64_t cookie);
+
+            //!
+            //! Invoked when a client is disconnected, either from the peer, on error or on request.
+            //! Pending timers of the client are silently dropped. The client identifier is no longer
+            //! valid after this call. The default implementation does nothing.
+            //! @param [in,out] server The TLV server.
+            //! @param [in] client Identifier of the client.
+            //!
+            virtual void handleDisconnection(Server& server, uint32_t client);
+
+            //!
+            //! Virtual destructor.
+            //!
+            virtual ~ServerHandlerInterface();
+        };
+    }
+}
@@ -10,6 +10,7 @@
 #include "tsMPEPacket.h"
 #include "tsBinaryTable.h"
 #include "tsPAT.h"
+#include "tsIPProtocols.h"
 #include "tsDataBroadcastIdDescriptor.h"
 #include "tsIPMACStreamLocationDescriptor.h"
 
@@ -103,16 +104,16 @@ void ts::MPEDemux::handleSection(SectionDemux& demux, const Section& section)
     // So, we need to carefully filter the sections. This must be a
     // DSM-CC Private Data section and it must come from a PID we filter.
 
-    if (section.tableId() == TID_DSMCC_PD && _pid_filter.test(section.sourcePID())) {
+    if (section.tableId() == TID_DSMCC_PD && _pid_filter.test(section.sourcePID()) && _handler != nullptr && matchFilters(section)) {
 
-        // Build the corresponding MPE packet.
-        MPEPacket mpe(section);
-        if (mpe.isValid() && _handler != nullptr) {
+        // Build the corresponding MPE packet, reusing the previous datagram buffer.
+        _mpe.copy(section);
+        if (_mpe.isValid()) {
 
             // Send the MPE packet to the application.
             beforeCallingHandler(section.sourcePID());
             try {
-                _handler->handleMPEPacket(*this, mpe);
+                _handler->handleMPEPacket(*this, _mpe);
             }
             catch (...) {
                 afterCallingHandler(false);
@@ -124,6 +125,33 @@ void ts::MPEDemux::handleSection(SectionDemux& demux, const Section& section)
 }
 
 
+//----------------------------------------------------------------------------
+// Check if the UDP datagram in an MPE section matches the filters.
+//----------------------------------------------------------------------------
+
+bool ts::MPEDemux::matchFilters(const Section& section) const
+{
+    if (!_source_filter.hasAddress() && !_source_filter.hasPort() && !_dest_filter.hasAddress() && !_dest_filter.hasPort()) {
+        // No filter, no need to parse the datagram.
+        return true;
+    }
+
+    // The datagram starts after the 12-byte header and ends before the 4-byte CRC32 (see MPEPacket).
+    if (section.size() < 16) {
+        // Not a valid MPE section, will be rejected later.
+        return true;
+    }
+    const uint8_t* const ip = section.content() + 12;
+    const uint8_t* udp = nullptr;
+    if (!MPEPacket::FindUDP(ip, section.size() - 16, &udp)) {
+        // Not a valid UDP datagram, will be rejected later.
+        return true;
+    }
+    return IPv4SocketAddress(GetUInt32(ip + IPv4_SRC_ADDR_OFFSET), GetUInt16(udp + UDP_SRC_PORT_OFFSET)).match(_source_filter) &&
+           IPv4SocketAddress(GetUInt32(ip + IPv4_DEST_ADDR_OFFSET), GetUInt16(udp + UDP_DEST_PORT_OFFSET)).match(_dest_filter);
+}
+
+
 //----------------------------------------------------------------------------
 // Invoked by the PSI demux when a complete table is available.
 //----------------------------------------------------------------------------
@@ -17,6 +17,7 @@
 #include "tsPMT.h"
 #include "tsINT.h"
 #include "tsMPEHandlerInterface.h"
+#include "tsMPEPacket.h"
 
 namespace ts {
     //!
@@ -67,6 +68,22 @@ namespace ts {
             _handler = h;
         }
 
+        //!
+        //! Set a filter on the source of the UDP datagrams.
+        //! The filter is applied directly on the DSM-CC sections, before any copy of the datagram.
+        //! @param [in] source Source IP address and UDP port to filter. The address or the port
+        //! can be unspecified, meaning any value. By default, there is no source filter.
+        //!
+        void setSourceFilter(const IPv4SocketAddress& source) { _source_filter = source; }
+
+        //!
+        //! Set a filter on the destination of the UDP datagrams.
+        //! The filter is applied directly on the DSM-CC sections, before any copy of the datagram.
+        //! @param [in] destination Destination IP address and UDP port to filter. The address or
+        //! the port can be unspecified, meaning any value. By default, there is no destination filter.
+        //!
+        void setDestinationFilter(const IPv4SocketAddress& destination) { _dest_filter = destination; }
+
     protected:
         // Inherited methods from AbstractDemux.
         virtual void immediateReset() override;
@@ -100,6 +117,9 @@ namespace ts {
         // Process the discovery of a new MPE PID.
         void processMPEDiscovery(const PMT& pmt, PID pid);
 
+        // Check if the UDP datagram in an MPE section matches the source and destination filters.
+        bool matchFilters(const Section& section) const;
+
         // Private members:
         MPEHandlerInterface* _handler = nullptr; // Application-defined handler
         SectionDemux         _psi_demux;         // Demux for PSI parsing.
@@ -107,5 +127,8 @@ namespace ts {
         PMTMap               _pmts {};           // Map of all PMT's in the TS.
         PIDSet               _new_pids {};       // New MPE PID's which where signalled to the application.
         std::set<uint32_t>   _int_tags {};       // Set of service_id / component_tag from the INT.
+        IPv4SocketAddress    _source_filter {};  // Filter on source of UDP datagrams.
+        IPv4SocketAddress    _dest_filter {};    // Filter on destination of UDP datagrams.
+        MPEPacket            _mpe {};            // Reused for all MPE sections, the datagram buffer is not reallocated.
     };
 }
@@ -188,8 +188,10 @@ ts::MPEPacket& ts::MPEPacket::copy(const MPEPacket& other)
 
 ts::MPEPacket& ts::MPEPacket::copy(const Section& section)
 {
-    // Clear previous content.
-    clear();
+    // Clear previous content. Keep the datagram buffer to reuse it.
+    _is_valid = false;
+    _source_pid = PID_NULL;
+    _dest_mac.clear();
 
     // Locate the section content, including header.
     const uint8_t* data = section.content();
@@ -214,7 +216,13 @@ ts::MPEPacket& ts::MPEPacket::copy(const Section& section)
 
     // Get the datagram from the rest of the section.
     // Do not include trailing 4 bytes (checksum or CRC32).
-    _datagram = new ByteBlock(data + 12, size - 16);
+    // The previous buffer is reused when it is not shared with another packet.
+    if (!_datagram.isNull() && _datagram.count() == 1) {
+        _datagram->copy(data + 12, size - 16);
+    }
+    else {
+        _datagram = new ByteBlock(data + 12, size - 16);
+    }
 
     // Check that the datagram contains a UDP/IP packet.
     _is_valid = true;
@@ -101,6 +101,9 @@ namespace ts {
 
         //!
         //! Copy content from a DSM-CC MPE section.
+        //! When the datagram buffer of this object is not shared with another
+        //! MPEPacket, it is reused. Decoding successive sections in the same
+        //! object does not allocate memory.
         //! @param [in] section A binary DSM-CC MPE section.
         //! @return A reference to this object.
         //!
@@ -251,6 +254,17 @@ namespace ts {
         //!
         bool setUDPMessage(const uint8_t* data, size_t size);
 
+        //!
+        //! Locate the UDP header and payload in an IPv4 datagram.
+        //! @param [in] dgAddress Address of the IPv4 datagram.
+        //! @param [in] dgSize Size in bytes of the IPv4 datagram.
+        //! @param [out] udpHeader Returned address of the UDP header. Ignored if null.
+        //! @param [out] udpAddress Returned address of the UDP payload. Ignored if null.
+        //! @param [out] udpSize Returned size of the UDP payload. Ignored if null.
+        //! @return True if the datagram contains a valid UDP message, false otherwise.
+        //!
+        static bool FindUDP(const uint8_t* dgAddress, size_t dgSize, const uint8_t** udpHeader = nullptr, const uint8_t** udpAddress = nullptr, size_t* udpSize = nullptr);
+
     private:
         // Private fields
         bool         _is_valid = false;      // A valid datagram is present.
@@ -258,10 +272,6 @@ namespace ts {
         MACAddress   _dest_mac {};           // Destination MAC address (in DSM-CC section).
         ByteBlockPtr _datagram {};           // Full binary content of the datagram.
 
-        // Locate UDP payload and size in a datagram.
-        // Output parameters are optional. Return false on error.
-        static bool FindUDP(const uint8_t* dgAddress, size_t dgSize, const uint8_t** udpHeader = nullptr, const uint8_t** udpAddress = nullptr, size_t* udpSize = nullptr);
-
         // Make sure the UDP datagram is valid.
         // If not valid, reallocate a new datagram area.
         // If force is true, reallocate all the time.
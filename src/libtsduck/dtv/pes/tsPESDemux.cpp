@@ -14,6 +14,7 @@
 #include "tsPMT.h"
 #include "tsPSI.h"
 #include "tsPES.h"
+#include "tsMPEG2.h"
 #include "tsAccessUnitIterator.h"
 #include "tsAlgorithm.h"
 
@@ -43,6 +44,9 @@ ts::PESDemux::~PESDemux()
 void ts::PESDemux::immediateReset()
 {
     SuperClass::immediateReset();
+    for (auto& it : _pids) {
+        releaseBuffer(it.second.ts);
+    }
     _pids.clear();
     _pid_types.clear();
 
@@ -54,11 +58,78 @@ void ts::PESDemux::immediateReset()
 void ts::PESDemux::immediateResetPID(PID pid)
 {
     SuperClass::immediateResetPID(pid);
-    _pids.erase(pid);
+    erasePIDContext(pid);
     _pid_types.erase(pid);
 }
 
 
+//----------------------------------------------------------------------------
+// PID context management.
+//----------------------------------------------------------------------------
+
+void ts::PESDemux::PIDContext::syncLost()
+{
+    sync = false;
+    if (!ts.isNull()) {
+        // The buffer may still be referenced by a handler. In that case, release it without modifying it.
+        // A new buffer is allocated at the next unit start.
+        if (ts.count() > 1) {
+            ts.clear();
+        }
+        else {
+            ts->clear();
+        }
+    }
+    resetStreaming();
+}
+
+void ts::PESDemux::PIDContext::resetStreaming()
+{
+    header_size = 0;
+    notified = 0;
+    scan_offset = 0;
+    codec = CodecType::UNDEFINED;
+    intra_found = false;
+}
+
+void ts::PESDemux::erasePIDContext(PID pid)
+{
+    const auto pci = _pids.find(pid);
+    if (pci != _pids.end()) {
+        releaseBuffer(pci->second.ts);
+        _pids.erase(pci);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Pool of PES buffers.
+//----------------------------------------------------------------------------
+
+ts::ByteBlockPtr ts::PESDemux::allocateBuffer()
+{
+    if (_buffer_pool.empty()) {
+        return ByteBlockPtr(new ByteBlock);
+    }
+    else {
+        // Reuse a previous buffer, with its allocated capacity.
+        ByteBlockPtr buf(_buffer_pool.back());
+        _buffer_pool.pop_back();
+        return buf;
+    }
+}
+
+void ts::PESDemux::releaseBuffer(ByteBlockPtr& buf)
+{
+    // A buffer which is still referenced by an application handler (in a PESPacket) cannot be reused.
+    if (!buf.isNull() && buf.count() == 1 && _buffer_pool.size() < MAX_POOL_SIZE) {
+        buf->clear();
+        _buffer_pool.push_back(buf);
+    }
+    buf.clear();
+}
+
+
 //----------------------------------------------------------------------------
 // Set/get the default audio or video codec for one specific PES PID's.
 //----------------------------------------------------------------------------
@@ -124,6 +195,19 @@ void ts::PESDemux::getHEVCAttributes(PID pid, HEVCAttributes& va) const
     }
 }
 
+void ts::PESDemux::getSPSCacheStatistics(PID pid, uint64_t& hits, uint64_t& misses) const
+{
+    const auto pci = _pids.find(pid);
+    if (pci == _pids.end()) {
+        hits = misses = 0;
+    }
+    else {
+        // Only one of AVC and HEVC is used on a PID.
+        hits = pci->second.avc.spsCacheHits() + pci->second.hevc.spsCacheHits();
+        misses = pci->second.avc.spsCacheMisses() + pci->second.hevc.spsCacheMisses();
+    }
+}
+
 void ts::PESDemux::getAC3Attributes(PID pid, AC3Attributes& va) const
 {
     const auto pci = _pids.find (pid);
@@ -191,7 +275,7 @@ void ts::PESDemux::processPacket(const TSPacket& pkt)
     // for a while => release context.
     if (pkt.getScrambling() != SC_CLEAR) {
         if (pc_exists) {
-            _pids.erase(pid);
+            erasePIDContext(pid);
         }
         return;
     }
@@ -209,17 +293,27 @@ void ts::PESDemux::processPacket(const TSPacket& pkt)
             PIDContext& pc(_pids[pid]);
             pc.continuity = pkt.getCC();
             pc.sync = true;
+            // The PES buffer of the previous packet may still be referenced by a handler.
+            // In that case, do not overwrite it, use another one.
+            if (pc.ts.isNull() || pc.ts.count() > 1) {
+                pc.ts = allocateBuffer();
+            }
+            // When the PES packet size is specified, allocate the complete buffer now.
+            if (pl_size >= 6 && GetUInt16(pl + 4) != 0) {
+                pc.ts->reserve(6 + GetUInt16(pl + 4));
+            }
             pc.ts->copy(pl, pl_size);
             pc.first_pkt = _packet_count;
             pc.last_pkt = _packet_count;
             pc.pcr = pkt.getPCR(); // can be invalid
+            pc.resetStreaming();
 
-            // Check if the complete PES packet is now present (without waiting for the next PUSI).
-            processPESPacketIfComplete(pid, pc);
+            // Process the new data (streaming mode or complete PES packet).
+            processNewData(pid);
         }
         else if (pc_exists) {
             // This PID does not contain PES packet, reset context
-            _pids.erase(pid);
+            erasePIDContext(pid);
         }
         // PUSI packet processing done.
         return;
@@ -272,8 +366,39 @@ void ts::PESDemux::processPacket(const TSPacket& pkt)
         pc.pcr = pkt.getPCR();
     }
 
-    // Check if the complete PES packet is now present (without waiting for the next PUSI).
-    processPESPacketIfComplete(pid, pc);
+    // Process the new data (streaming mode or complete PES packet).
+    processNewData(pid);
+}
+
+
+//----------------------------------------------------------------------------
+// Process new data in the PES buffer of a PID context.
+//----------------------------------------------------------------------------
+
+void ts::PESDemux::processNewData(PID pid)
+{
+    // In streaming mode, notify the new data.
+    if (_streaming && _pes_handler != nullptr) {
+        auto pci = _pids.find(pid);
+        if (pci != _pids.end()) {
+            beforeCallingHandler(pid);
+            try {
+                streamPESContent(pid, pci->second, false);
+            }
+            catch (...) {
+                afterCallingHandler(false);
+                throw;
+            }
+            afterCallingHandler(true);
+        }
+    }
+
+    // The PID context may have been reset by a handler.
+    const auto pci = _pids.find(pid);
+    if (pci != _pids.end()) {
+        // Check if the complete PES packet is now present (without waiting for the next PUSI).
+        processPESPacketIfComplete(pid, pci->second);
+    }
 }
 
 
@@ -374,6 +499,11 @@ void ts::PESDemux::processPESPacket(PID pid, PIDContext& pc)
     // This is used to prevent the destruction of PID contexts during the execution of a handler.
     beforeCallingHandler(pid);
     try {
+        // In streaming mode, notify the last start codes which were waiting for more data.
+        if (_streaming && _pes_handler != nullptr) {
+            streamPESContent(pid, pc, true);
+        }
+
         // Build a PES packet object around the TS buffer
         PESPacket pes(pc.ts, pid);
 
@@ -519,8 +649,7 @@ void ts::PESDemux::handlePESContent(PIDContext& pc, const PESPacket& pes)
         // The beginning of the payload is already a start code prefix.
         for (size_t offset = 0; offset < pl_size; ) {
             // Look for next start code
-            static const uint8_t StartCodePrefix[] = {0x00, 0x00, 0x01};
-            const uint8_t* pnext = LocatePattern(pl_data + offset + 1, pl_size - offset - 1, StartCodePrefix, sizeof(StartCodePrefix));
+            const uint8_t* pnext = LocateZeroZero(pl_data + offset + 1, pl_size - offset - 1, 0x01);
             size_t next = pnext == nullptr ? pl_size : pnext - pl_data;
             // Invoke handler
             _pes_handler->handleVideoStartCode(*this, pes, pl_data[offset + 3], offset, next - offset);
@@ -554,3 +683,116 @@ void ts::PESDemux::handlePESContent(PIDContext& pc, const PESPacket& pes)
         }
     }
 }
+
+
+//----------------------------------------------------------------------------
+// Streaming mode: notify the handler of new PES data.
+//----------------------------------------------------------------------------
+
+void ts::PESDemux::streamPESContent(PID pid, PIDContext& pc, bool last)
+{
+    // Wait for a complete PES header.
+    if (pc.header_size == 0) {
+        pc.header_size = PESPacket::HeaderSize(pc.ts->data(), pc.ts->size());
+        if (pc.header_size == 0) {
+            return;
+        }
+    }
+
+    // PES payload, possibly truncated. With a bounded PES packet, ignore the stuffing after the end of the PES packet.
+    const size_t pes_size = GetUInt16(pc.ts->data() + 4);
+    const size_t end = pes_size == 0 ? pc.ts->size() : std::min(pc.ts->size(), 6 + pes_size);
+    const uint8_t* const pl_data = pc.ts->data() + pc.header_size;
+    const size_t size = end > pc.header_size ? end - pc.header_size : 0;
+
+    // Notify the new payload data.
+    if (size > pc.notified) {
+        const size_t offset = pc.notified;
+        pc.notified = size;
+        _pes_handler->handlePESPayloadFragment(*this, pid, offset, pl_data + offset, size - offset);
+    }
+
+    // Determine the video codec when the first bytes of the payload are available.
+    if (pc.codec == CodecType::UNDEFINED && pc.scan_offset != NPOS && (size >= 4 || last)) {
+        const auto it_type = _pid_types.find(pid);
+        const uint8_t stream_type = it_type == _pid_types.end() ? uint8_t(ST_NULL) : it_type->second.stream_type;
+        const CodecType codec = getDefaultCodec(pid);
+        const AccessUnitIterator au_iter(pl_data, size, stream_type, codec);
+        if (au_iter.isValid()) {
+            pc.codec = au_iter.videoFormat();
+        }
+        else if (PESPacket::IsMPEG2Video(pc.ts->data(), pc.header_size + size, stream_type) ||
+                 ((codec == CodecType::MPEG1_VIDEO || codec == CodecType::MPEG2_VIDEO) && size >= 3 && pl_data[0] == 0x00 && pl_data[1] == 0x00 && pl_data[2] == 0x01))
+        {
+            pc.codec = codec == CodecType::MPEG1_VIDEO ? codec : CodecType::MPEG2_VIDEO;
+        }
+        else {
+            // Not a video stream, no start code to analyze in this PES packet.
+            pc.scan_offset = NPOS;
+        }
+    }
+
+    // Locate and analyze new start codes. A start code is analyzed only when the first
+    // bytes after it are available, except at the end of the PES packet.
+    constexpr size_t prefix_size = 3; // 00 00 01
+    while (pc.codec != CodecType::UNDEFINED && pc.scan_offset < size) {
+        const uint8_t* const next = LocateZeroZero(pl_data + pc.scan_offset, size - pc.scan_offset, 0x01);
+        if (next == nullptr) {
+            // No more start code. Keep the last bytes, a start code prefix may span over the next TS packet.
+            pc.scan_offset = std::max(pc.scan_offset, size < prefix_size ? 0 : size - prefix_size + 1);
+            break;
+        }
+        const size_t offset = next - pl_data;
+        if (!last && offset + prefix_size + STREAM_START_CODE_SIZE > size) {
+            // Wait for more data to analyze this start code.
+            pc.scan_offset = offset;
+            break;
+        }
+        pc.scan_offset = offset + prefix_size;
+        streamStartCode(pid, pc, pl_data + pc.scan_offset, size - pc.scan_offset, offset);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Streaming mode: analyze a start code in the PES payload.
+//----------------------------------------------------------------------------
+
+void ts::PESDemux::streamStartCode(PID pid, PIDContext& pc, const uint8_t* data, size_t size, size_t offset)
+{
+    // Extract the NALunit type or the MPEG-1/2 start code.
+    bool valid = true;
+    bool intra = false;
+    uint8_t type = 0;
+    if (pc.codec == CodecType::AVC && size >= 1) {
+        type = data[0] & 0x1F;
+    }
+    else if (pc.codec == CodecType::HEVC && size >= 1) {
+        type = (data[0] >> 1) & 0x3F;
+    }
+    else if (pc.codec == CodecType::VVC && size >= 2) {
+        type = (data[1] >> 3) & 0x1F;
+    }
+    else if ((pc.codec == CodecType::MPEG1_VIDEO || pc.codec == CodecType::MPEG2_VIDEO) && size >= 1) {
+        type = data[0];
+        intra = type == PST_SEQUENCE_HEADER || type == PST_GROUP;
+    }
+    else {
+        valid = false;
+    }
+
+    if (valid) {
+        // Same offsets as handleAccessUnit() and handleIntraImage() on the complete PES packet.
+        const bool xvc = pc.codec == CodecType::AVC || pc.codec == CodecType::HEVC || pc.codec == CodecType::VVC;
+        const size_t intra_offset = xvc ? offset + 3 : offset;
+        if (xvc) {
+            // Only the first bytes of access unit delimiters are analyzed.
+            intra = PESPacket::IsIntraAccessUnit(pc.codec, type, data, std::min<size_t>(size, 16));
+        }
+        _pes_handler->handleStreamStartCode(*this, pid, pc.codec, type, offset);
+        if (intra && !pc.intra_found) {
+            pc.intra_found = true;
+            _pes_handler->handleStreamIntraImage(*this, pid, intra_offset);
+        }
+    }
+}
@@ -75,6 +75,27 @@ namespace ts {
         //!
         void setPESHandler(PESHandlerInterface* h) { _pes_handler = h; }
 
+        //!
+        //! Set the streaming mode.
+        //! In streaming mode, the PES handler is notified of PES payload fragments, video start codes
+        //! and intra-coded images as soon as the corresponding TS packets are received, without waiting
+        //! for the end of the PES packet. For video PID's, this significantly reduces the latency since
+        //! a video PES packet usually contains a complete image and can span thousands of TS packets.
+        //! The complete PES packets are still notified as usual when they are complete.
+        //! @param [in] on True to enable the streaming mode, false to disable it (the default).
+        //! @see PESHandlerInterface::handlePESPayloadFragment()
+        //! @see PESHandlerInterface::handleStreamStartCode()
+        //! @see PESHandlerInterface::handleStreamIntraImage()
+        //!
+        void setStreaming(bool on) { _streaming = on; }
+
+        //!
+        //! Check if the streaming mode is enabled.
+        //! @return True if the streaming mode is enabled.
+        //! @see setStreaming()
+        //!
+        bool streaming() const { return _streaming; }
+
         //!
         //! Set the default audio or video codec for all analyzed PES PID's.
         //! The analysis of the content of a PES packet sometimes depends on the PES data format.
@@ -137,6 +158,16 @@ namespace ts {
         //!
         void getHEVCAttributes(PID pid, HEVCAttributes& attr) const;
 
+        //!
+        //! Get the statistics of the "sequence parameter set" cache of the AVC or HEVC attributes on the specified PID.
+        //! A repeated identical SPS is a cache hit and is not parsed again. A new or modified SPS is a cache miss.
+        //! A large number of misses indicates a stream with frequently changing video parameters.
+        //! @param [in] pid The PID to check.
+        //! @param [out] hits Number of SPS which were identical to the previous one.
+        //! @param [out] misses Number of SPS which were parsed.
+        //!
+        void getSPSCacheStatistics(PID pid, uint64_t& hits, uint64_t& misses) const;
+
         //!
         //! Get the current AC-3 audio attributes on the specified PID.
         //! @param [in] pid The PID to check.
@@ -170,6 +201,12 @@ namespace ts {
         virtual void immediateResetPID(PID pid) override;
 
     private:
+        // Maximum number of unused PES buffers to keep in the pool.
+        static constexpr size_t MAX_POOL_SIZE = 16;
+
+        // In streaming mode, number of bytes after a start code prefix which are needed to analyze it.
+        static constexpr size_t STREAM_START_CODE_SIZE = 3;
+
         // This internal structure contains the analysis context for one PID.
         struct PIDContext
         {
@@ -186,12 +223,20 @@ namespace ts {
             HEVCAttributes       hevc {};        // Current HEVC attributes
             AC3Attributes        ac3 {};         // Current AC-3 attributes
             PacketCounter        ac3_count = 0;   // Number of PES packets with contents which looks like AC-3
+            size_t               header_size = 0;         // Streaming: PES header size, zero if not yet known
+            size_t               notified = 0;            // Streaming: size of PES payload already notified
+            size_t               scan_offset = 0;         // Streaming: next PES payload offset to scan for start codes
+            CodecType            codec {CodecType::UNDEFINED}; // Streaming: video codec of current PES packet
+            bool                 intra_found = false;     // Streaming: an intra-coded image was notified in current PES packet
 
             // Default constructor:
-            PIDContext() : ts(new ByteBlock()) {}
+            PIDContext() = default;
 
             // Called when packet synchronization is lost on the PID.
-            void syncLost() { sync = false; ts->clear(); }
+            void syncLost();
+
+            // Reset the streaming state at the start of a PES packet.
+            void resetStreaming();
         };
 
         // Map of PID contexts, indexed by PID.
@@ -215,6 +260,9 @@ namespace ts {
         // Feed the demux with a TS packet (PID already filtered).
         void processPacket(const TSPacket&);
 
+        // Process new data in the PES buffer of a PID context.
+        void processNewData(PID);
+
         // If a PID context contains a complete PES packet with specified length, process it.
         void processPESPacketIfComplete(PID, PIDContext&);
 
@@ -224,6 +272,20 @@ namespace ts {
         // Process all video/audio analysis on the PES packet.
         void handlePESContent(PIDContext&, const PESPacket&);
 
+        // Streaming mode: notify the handler of new PES data. Must be called between beforeCallingHandler()
+        // and afterCallingHandler(). When last is true, the PES packet is complete, no more data will come.
+        void streamPESContent(PID, PIDContext&, bool last);
+
+        // Streaming mode: analyze a start code at the given offset in the PES payload.
+        void streamStartCode(PID, PIDContext&, const uint8_t* data, size_t size, size_t offset);
+
+        // Get a PES buffer from the pool, return a PES buffer to the pool when it is no longer used.
+        ByteBlockPtr allocateBuffer();
+        void releaseBuffer(ByteBlockPtr&);
+
+        // Erase a PID context, recycle its PES buffer.
+        void erasePIDContext(PID);
+
         // Implementation of TableHandlerInterface.
         virtual void handleTable(SectionDemux& demux, const BinaryTable& table) override;
 
@@ -233,5 +295,7 @@ namespace ts {
         PIDContextMap        _pids {};
         PIDTypeMap           _pid_types {};
         SectionDemux         _section_demux;
+        bool                 _streaming = false;
+        std::vector<ByteBlockPtr> _buffer_pool {};  // Unused PES buffers, ready for reuse.
     };
 }
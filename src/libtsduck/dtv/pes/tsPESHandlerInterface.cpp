@@ -21,4 +21,7 @@ void ts::PESHandlerInterface::handleNewHEVCAttributes(PESDemux&, const PESPacket
 void ts::PESHandlerInterface::handleIntraImage(PESDemux&, const PESPacket&, size_t) {}
 void ts::PESHandlerInterface::handleNewMPEG2AudioAttributes(PESDemux&, const PESPacket&, const MPEG2AudioAttributes&) {}
 void ts::PESHandlerInterface::handleNewAC3Attributes(PESDemux&, const PESPacket&, const AC3Attributes&) {}
+void ts::PESHandlerInterface::handlePESPayloadFragment(PESDemux&, PID, size_t, const uint8_t*, size_t) {}
+void ts::PESHandlerInterface::handleStreamStartCode(PESDemux&, PID, CodecType, uint8_t, size_t) {}
+void ts::PESHandlerInterface::handleStreamIntraImage(PESDemux&, PID, size_t) {}
 ts::PESHandlerInterface::~PESHandlerInterface() {}
@@ -14,6 +14,7 @@
 #pragma once
 #include "tsByteBlock.h"
 #include "tsTS.h"
+#include "tsCodecType.h"
 
 namespace ts {
 
@@ -127,5 +128,40 @@ namespace ts {
         //! @param [in] attr Audio attributes.
         //!
         virtual void handleNewAC3Attributes(PESDemux& demux, const PESPacket& packet, const AC3Attributes& attr);
+
+        //!
+        //! This hook is invoked in streaming mode when new payload data of a PES packet are received.
+        //! The PES packet is not yet complete. The data area is valid only during the execution of the hook.
+        //! @param [in,out] demux A reference to the PES demux.
+        //! @param [in] pid The PID of the PES packet.
+        //! @param [in] offset Offset of @a data in the PES packet payload.
+        //! @param [in] data Address of the new payload data.
+        //! @param [in] size Size in bytes of the new payload data.
+        //! @see PESDemux::setStreaming()
+        //!
+        virtual void handlePESPayloadFragment(PESDemux& demux, PID pid, size_t offset, const uint8_t* data, size_t size);
+
+        //!
+        //! This hook is invoked in streaming mode when a video start code is received.
+        //! The PES packet is not yet complete.
+        //! @param [in,out] demux A reference to the PES demux.
+        //! @param [in] pid The PID of the PES packet.
+        //! @param [in] codec The video codec of the PID.
+        //! @param [in] type The NALunit type with AVC, HEVC or VVC. The XX in start code (00 00 01 xx) with MPEG-1/2 video.
+        //! @param [in] offset Offset of the start code (00 00 01 xx) in the PES packet payload.
+        //! @see PESDemux::setStreaming()
+        //!
+        virtual void handleStreamStartCode(PESDemux& demux, PID pid, CodecType codec, uint8_t type, size_t offset);
+
+        //!
+        //! This hook is invoked in streaming mode when the start of an intra-code image is received.
+        //! The PES packet is not yet complete. The hook is invoked at most once per PES packet.
+        //! @param [in,out] demux A reference to the PES demux.
+        //! @param [in] pid The PID of the PES packet.
+        //! @param [in] offset Offset in the PES packet payload where the image is found.
+        //! This is informational only, the exact semantics depends on the video codec.
+        //! @see PESDemux::setStreaming()
+        //!
+        virtual void handleStreamIntraImage(PESDemux& demux, PID pid, size_t offset);
     };
 }
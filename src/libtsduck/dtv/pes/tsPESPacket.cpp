@@ -470,53 +470,8 @@ size_t ts::PESPacket::FindIntraImage(const uint8_t* data, size_t size, uint8_t s
     if (au_iter.isValid()) {
         // Loop on all access units.
         for (; !au_iter.atEnd(); au_iter.next()) {
-            const uint8_t au_type = au_iter.currentAccessUnitType();
-            if (codec == CodecType::AVC) {
-                if (au_type == AVC_AUT_IDR) {
-                    // Found an explicit IDR picture.
-                    // IDR = Instantaneous Decoding Refresh.
-                    return au_iter.currentAccessUnitOffset();
-                }
-                else if (au_type == AVC_AUT_DELIMITER) {
-                    // Found an access unit delimiter, analyze it.
-                    const AVCAccessUnitDelimiter aud(au_iter.currentAccessUnit(), au_iter.currentAccessUnitSize());
-                    if (aud.valid && (aud.primary_pic_type == AVC_PIC_TYPE_I || aud.primary_pic_type == AVC_PIC_TYPE_SI || aud.primary_pic_type == AVC_PIC_TYPE_I_SI)) {
-                        // Found an access unit delimiter which contains intra slices only.
-                        return au_iter.currentAccessUnitOffset();
-                    }
-                }
-            }
-            else if (codec == CodecType::HEVC) {
-                if (au_type == HEVC_AUT_CRA_NUT || au_type == HEVC_AUT_IDR_N_LP || au_type == HEVC_AUT_IDR_W_RADL || au_type == HEVC_AUT_RADL_N || au_type == HEVC_AUT_RADL_R) {
-                    // Found an explicit intra picture.
-                    // CRA = Clear Random Access.
-                    // RADL = Random Access Decodable Leading.
-                    return au_iter.currentAccessUnitOffset();
-                }
-                else if (au_type == HEVC_AUT_AUD_NUT) {
-                    // Found an access unit delimiter, analyze it.
-                    const HEVCAccessUnitDelimiter aud(au_iter.currentAccessUnit(), au_iter.currentAccessUnitSize());
-                    if (aud.valid && aud.pic_type == HEVC_PIC_TYPE_I) {
-                        // Found an access unit delimiter which contains intra slices only.
-                        return au_iter.currentAccessUnitOffset();
-                    }
-                }
-            }
-            else if (codec == CodecType::VVC) {
-                if (au_type == VVC_AUT_CRA_NUT || au_type == VVC_AUT_RADL_NUT || au_type == VVC_AUT_IDR_N_LP || au_type == VVC_AUT_IDR_W_RADL) {
-                    // Found an explicit intra picture.
-                    // CRA = Clear Random Access.
-                    // RADL = Random Access Decodable Leading.
-                    return au_iter.currentAccessUnitOffset();
-                }
-                else if (au_type == VVC_AUT_AUD_NUT) {
-                    // Found an access unit delimiter, analyze it.
-                    const VVCAccessUnitDelimiter aud(au_iter.currentAccessUnit(), au_iter.currentAccessUnitSize());
-                    if (aud.valid && aud.aud_pic_type == VVC_PIC_TYPE_I) {
-                        // Found an access unit delimiter which contains intra slices only.
-                        return au_iter.currentAccessUnitOffset();
-                    }
-                }
+            if (IsIntraAccessUnit(codec, au_iter.currentAccessUnitType(), au_iter.currentAccessUnit(), au_iter.currentAccessUnitSize())) {
+                return au_iter.currentAccessUnitOffset();
             }
         }
     }
@@ -527,8 +482,7 @@ size_t ts::PESPacket::FindIntraImage(const uint8_t* data, size_t size, uint8_t s
         // The beginning of the PES payload is already a start code prefix in MPEG-1/2.
         while (pl_size > 0) {
             // Look for next start code
-            static const uint8_t StartCodePrefix[] = {0x00, 0x00, 0x01};
-            const uint8_t* pl_next = LocatePattern(pl_data + 1, pl_size - 1, StartCodePrefix, sizeof(StartCodePrefix));
+            const uint8_t* pl_next = LocateZeroZero(pl_data + 1, pl_size - 1, 0x01);
             if (pl_next == nullptr) {
                 // No next start code, current one extends up to the end of the payload.
                 pl_next = pl_data + pl_size;
@@ -547,3 +501,50 @@ size_t ts::PESPacket::FindIntraImage(const uint8_t* data, size_t size, uint8_t s
     // No intra-image found.
     return NPOS;
 }
+
+
+//----------------------------------------------------------------------------
+// Check if an AVC, HEVC or VVC access unit starts an intra-coded image.
+//----------------------------------------------------------------------------
+
+bool ts::PESPacket::IsIntraAccessUnit(CodecType codec, uint8_t nal_unit_type, const uint8_t* data, size_t size)
+{
+    if (codec == CodecType::AVC) {
+        if (nal_unit_type == AVC_AUT_IDR) {
+            // Found an explicit IDR picture.
+            // IDR = Instantaneous Decoding Refresh.
+            return true;
+        }
+        else if (nal_unit_type == AVC_AUT_DELIMITER) {
+            // Found an access unit delimiter, analyze it.
+            const AVCAccessUnitDelimiter aud(data, size);
+            // Check if the access unit delimiter contains intra slices only.
+            return aud.valid && (aud.primary_pic_type == AVC_PIC_TYPE_I || aud.primary_pic_type == AVC_PIC_TYPE_SI || aud.primary_pic_type == AVC_PIC_TYPE_I_SI);
+        }
+    }
+    else if (codec == CodecType::HEVC) {
+        if (nal_unit_type == HEVC_AUT_CRA_NUT || nal_unit_type == HEVC_AUT_IDR_N_LP || nal_unit_type == HEVC_AUT_IDR_W_RADL || nal_unit_type == HEVC_AUT_RADL_N || nal_unit_type == HEVC_AUT_RADL_R) {
+            // Found an explicit intra picture.
+            // CRA = Clear Random Access.
+            // RADL = Random Access Decodable Leading.
+            return true;
+        }
+        else if (nal_unit_type == HEVC_AUT_AUD_NUT) {
+            // Found an access unit delimiter, analyze it.
+            const HEVCAccessUnitDelimiter aud(data, size);
+            return aud.valid && aud.pic_type == HEVC_PIC_TYPE_I;
+        }
+    }
+    else if (codec == CodecType::VVC) {
+        if (nal_unit_type == VVC_AUT_CRA_NUT || nal_unit_type == VVC_AUT_RADL_NUT || nal_unit_type == VVC_AUT_IDR_N_LP || nal_unit_type == VVC_AUT_IDR_W_RADL) {
+            // Found an explicit intra picture.
+            return true;
+        }
+        else if (nal_unit_type == VVC_AUT_AUD_NUT) {
+            // Found an access unit delimiter, analyze it.
+            const VVCAccessUnitDelimiter aud(data, size);
+            return aud.valid && aud.aud_pic_type == VVC_PIC_TYPE_I;
+        }
+    }
+    return false;
+}
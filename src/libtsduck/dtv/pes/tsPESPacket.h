@@ -363,6 +363,17 @@ namespace ts {
         //!
         static size_t FindIntraImage(const uint8_t* data, size_t size, uint8_t stream_type = ST_NULL, CodecType default_format = CodecType::UNDEFINED);
 
+        //!
+        //! Check if an AVC, HEVC or VVC access unit (aka "NALunit") starts an intra-coded image.
+        //! @param [in] codec Video codec, AVC, HEVC or VVC.
+        //! @param [in] nal_unit_type NALunit type.
+        //! @param [in] data Address of the NALunit, starting at the NALunit header, after the start code prefix.
+        //! @param [in] size Size of the NALunit in bytes. The NALunit can be truncated, only the first bytes
+        //! of access unit delimiters are analyzed.
+        //! @return True if the access unit starts an intra-coded image.
+        //!
+        static bool IsIntraAccessUnit(CodecType codec, uint8_t nal_unit_type, const uint8_t* data, size_t size);
+
     private:
         // Private fields
         bool      _is_valid = false;              // Content of *_data is a valid packet
@@ -11,6 +11,16 @@
 #include "tsAbstractTable.h"
 #include "tsDuckContext.h"
 #include "tsxmlElement.h"
+#include "tsGuardMutex.h"
+
+namespace {
+    // Serialize the access to the deserialized views of all shared tables.
+    ts::Mutex& SharedViewsMutex()
+    {
+        static ts::Mutex mutex;
+        return mutex;
+    }
+}
 
 
 //----------------------------------------------------------------------------
@@ -23,22 +33,24 @@ ts::DescriptorList::DescriptorList(const AbstractTable* table) :
 }
 
 ts::DescriptorList::DescriptorList(const AbstractTable* table, const DescriptorList& dl) :
-    _table(table),
-    _list(dl._list)
+    _table(table)
 {
+    copyList(dl);
 }
 
 ts::DescriptorList::DescriptorList(const AbstractTable* table, DescriptorList&& dl) noexcept :
     _table(table),
-    _list(std::move(dl._list))
+    _list(std::move(dl._list)),
+    _tags(dl._tags)
 {
+    dl._tags.reset();
 }
 
 ts::DescriptorList& ts::DescriptorList::operator=(const DescriptorList& dl)
 {
     if (&dl != this) {
         // Copy the list of descriptors but preserve the parent table.
-        _list = dl._list;
+        copyList(dl);
     }
     return *this;
 }
@@ -48,10 +60,161 @@ ts::DescriptorList& ts::DescriptorList::operator=(DescriptorList&& dl) noexcept
     if (&dl != this) {
         // Move the list of descriptors but preserve the parent table.
         _list = std::move(dl._list);
+        _tags = dl._tags;
+        dl._list.clear();
+        dl._tags.reset();
+    }
+    return *this;
+}
+
+
+//----------------------------------------------------------------------------
+// Copy the descriptors of another list.
+//----------------------------------------------------------------------------
+
+void ts::DescriptorList::copyList(const DescriptorList& dl)
+{
+    if (dl._table != nullptr && dl._table->isShared()) {
+        // Do not touch the safe pointers of the other list, they may be used in another thread.
+        _list.clear();
+        _list.reserve(dl._list.size());
+        for (const auto& elem : dl._list) {
+            _list.push_back(Element(DescriptorPtr(new Descriptor(*elem.desc, ShareMode::COPY)), elem.pds));
+        }
+    }
+    else {
+        _list = dl._list;
+    }
+    _tags = dl._tags;
+}
+
+
+//----------------------------------------------------------------------------
+// List entries and their deserialized views.
+//----------------------------------------------------------------------------
+
+ts::DescriptorList::Element& ts::DescriptorList::Element::operator=(const Element& other)
+{
+    if (&other != this) {
+        clearDecoded();
+        desc = other.desc;
+        pds = other.pds;
     }
     return *this;
 }
 
+ts::DescriptorList::Element& ts::DescriptorList::Element::operator=(Element&& other) noexcept
+{
+    if (&other != this) {
+        clearDecoded();
+        desc = std::move(other.desc);
+        pds = other.pds;
+        decoded = other.decoded;
+        other.decoded = nullptr;
+    }
+    return *this;
+}
+
+void ts::DescriptorList::Element::clearDecoded()
+{
+    Decoded* dec = decoded;
+    decoded = nullptr;
+    while (dec != nullptr) {
+        Decoded* const next = dec->next;
+        delete dec;
+        dec = next;
+    }
+}
+
+ts::DescriptorList::Decoded::Decoded(const DuckContext& duck, const Descriptor& bin, AbstractDescriptor* obj) :
+    binary(bin.content(), bin.size()),
+    charset(duck.charsetIn()),
+    object(obj)
+{
+}
+
+bool ts::DescriptorList::Decoded::sameBinary(const Descriptor& bin) const
+{
+    return binary.size() == bin.size() && std::memcmp(binary.data(), bin.content(), bin.size()) == 0;
+}
+
+bool ts::DescriptorList::isShared() const
+{
+    return _table != nullptr && _table->isShared();
+}
+
+bool ts::DescriptorList::findDecoded(const DuckContext& duck, size_t index, const std::type_info& type, const AbstractDescriptor*& obj) const
+{
+    if (isShared()) {
+        // Other threads may use the views of a shared table, never delete them.
+        GuardMutex lock(SharedViewsMutex());
+        return searchDecoded(duck, index, type, obj, false);
+    }
+    else {
+        return searchDecoded(duck, index, type, obj, true);
+    }
+}
+
+bool ts::DescriptorList::searchDecoded(const DuckContext& duck, size_t index, const std::type_info& type, const AbstractDescriptor*& obj, bool prune) const
+{
+    const Element& elem(_list[index]);
+    bool found = false;
+    Decoded** link = &elem.decoded;
+    while (*link != nullptr) {
+        Decoded* const dec = *link;
+        const bool same_type = typeid(*dec->object) == type;
+        const bool obsolete = !dec->sameBinary(*elem.desc) || (same_type && dec->charset != duck.charsetIn());
+        if (obsolete && prune) {
+            // Obsolete view, unlink and delete it.
+            *link = dec->next;
+            delete dec;
+        }
+        else {
+            if (same_type && !obsolete) {
+                obj = dec->object->isValid() ? dec->object.pointer() : nullptr;
+                found = true;
+            }
+            link = &dec->next;
+        }
+    }
+    return found;
+}
+
+const ts::AbstractDescriptor* ts::DescriptorList::addDecoded(const DuckContext& duck, size_t index, AbstractDescriptor* obj) const
+{
+    const std::type_info& type(typeid(*obj));
+    Decoded* const dec = new Decoded(duck, *_list[index].desc, obj);
+    if (isShared()) {
+        GuardMutex lock(SharedViewsMutex());
+        // Another thread may have deserialized the same descriptor in the meantime.
+        const AbstractDescriptor* other = nullptr;
+        if (searchDecoded(duck, index, type, other, false)) {
+            delete dec;
+            return other;
+        }
+        dec->next = _list[index].decoded;
+        _list[index].decoded = dec;
+    }
+    else {
+        dec->next = _list[index].decoded;
+        _list[index].decoded = dec;
+    }
+    return obj->isValid() ? obj : nullptr;
+}
+
+
+//----------------------------------------------------------------------------
+// Recompute the set of present tags after removing descriptors.
+//----------------------------------------------------------------------------
+
+void ts::DescriptorList::rebuildTags()
+{
+    _tags.reset();
+    for (const auto& elem : _list) {
+        _tags.set(elem.desc->tag());
+    }
+}
+
 
 //----------------------------------------------------------------------------
 // Get the table id of the parent table.
@@ -112,6 +275,7 @@ bool ts::DescriptorList::add(const DescriptorPtr& desc)
 
     // Add the descriptor in the list
     _list.push_back(Element(desc, pds));
+    _tags.set(desc->tag());
     return true;
 }
 
@@ -355,6 +519,9 @@ size_t ts::DescriptorList::removeInvalidPrivateDescriptors()
             n++;
         }
     }
+    if (count > 0) {
+        rebuildTags();
+    }
 
     return count;
 }
@@ -378,6 +545,7 @@ bool ts::DescriptorList::removeByIndex(size_t index)
 
     // Remove the specified descriptor
     _list.erase(_list.begin() + index);
+    rebuildTags();
     return true;
 }
 
@@ -402,6 +570,9 @@ size_t ts::DescriptorList::removeByTag(DID tag, PDS pds)
         }
     }
 
+    if (removed_count > 0) {
+        rebuildTags();
+    }
     return removed_count;
 }
 
@@ -505,6 +676,11 @@ size_t ts::DescriptorList::lengthSerialize(uint8_t*& addr, size_t& size, size_t
 
 size_t ts::DescriptorList::search(DID tag, size_t start_index, PDS pds) const
 {
+    // Fast path when there is no such descriptor in the list.
+    if (!_tags.test(tag)) {
+        return _list.size();
+    }
+
     bool check_pds = pds != 0 && tag >= 0x80;
     size_t index = start_index;
 
@@ -530,6 +706,11 @@ size_t ts::DescriptorList::search(const ts::EDID& edid, size_t start_index) cons
         return _list.size();
     }
 
+    // Fast path when there is no descriptor with the same base tag in the list.
+    if (!_tags.test(edid.did())) {
+        return _list.size();
+    }
+
     // Now search in the list.
     size_t index = start_index;
     while (index < _list.size() && _list[index].desc->edid(_list[index].pds, tid) != edid) {
@@ -13,15 +13,25 @@
 
 #pragma once
 #include "tsDescriptor.h"
+#include "tsAbstractDescriptor.h"
 
 namespace ts {
 
     class AbstractTable;
-    class AbstractDescriptor;
     class DuckContext;
+    class Charset;
 
     //!
     //! List of MPEG PSI/SI descriptors.
+    //!
+    //! The descriptors are stored in binary form. When a descriptor is accessed in deserialized
+    //! form using deserializedAt() or the typed search(), the deserialized object is kept with
+    //! the list entry and reused on subsequent accesses. Because of this cache, a descriptor list
+    //! must not be simultaneously accessed from several threads, even when it is constant, unless
+    //! its parent table is shared between threads (see AbstractTable::isShared()). In that case,
+    //! the access to the deserialized objects is serialized and they are kept until the list is
+    //! destroyed.
+    //!
     //! @ingroup mpeg
     //!
     class TSDUCKDLL DescriptorList
@@ -40,7 +50,8 @@ namespace ts {
         //! Basic copy-like constructor.
         //! We forbid a real copy constructor because we want to copy the descriptors only,
         //! while the parent table is usually different.
-        //! The descriptors objects are shared between the two lists.
+        //! The descriptors objects are shared between the two lists, unless the
+        //! parent table of @a dl is shared between threads (see AbstractTable::isShared()).
         //! @param [in] table Parent table. A descriptor list is always attached to a table it is part of.
         //! Use zero for a descriptor list object outside a table.
         //! @param [in] dl Another instance to copy.
@@ -59,7 +70,8 @@ namespace ts {
 
         //!
         //! Assignment operator.
-        //! The descriptors objects are shared between the two lists.
+        //! The descriptors objects are shared between the two lists, unless the
+        //! parent table of @a dl is shared between threads (see AbstractTable::isShared()).
         //! The parent table remains unchanged.
         //! @param [in] dl Another instance to copy.
         //! @return A reference to this object.
@@ -157,6 +169,7 @@ namespace ts {
         void add(const DescriptorList& dl)
         {
             _list.insert(_list.end(), dl._list.begin(), dl._list.end());
+            _tags |= dl._tags;
         }
 
         //!
@@ -238,7 +251,15 @@ namespace ts {
         //!
         //! Clear the content of the descriptor list.
         //!
-        void clear() { _list.clear(); }
+        void clear() { _list.clear(); _tags.reset(); }
+
+        //!
+        //! Check if the list contains at least one descriptor with the specified tag.
+        //! This is a constant-time operation.
+        //! @param [in] tag Tag of descriptor to search.
+        //! @return True if the list contains at least one descriptor with tag @a tag.
+        //!
+        bool containsTag(DID tag) const { return _tags.test(tag); }
 
         //!
         //! Search a descriptor with the specified tag.
@@ -253,6 +274,7 @@ namespace ts {
 
         //!
         //! Search a descriptor with the specified extended tag.
+        //! This is a constant-time operation when the list contains no descriptor with the same base tag.
         //! @param [in] edid Extended tag of descriptor to search.
         //! @param [in] start_index Start searching at this index.
         //! @return The index of the descriptor in the list or count() if no such descriptor is found.
@@ -298,6 +320,22 @@ namespace ts {
         template <class DESC, typename std::enable_if<std::is_base_of<AbstractDescriptor, DESC>::value>::type* = nullptr>
         size_t search(DuckContext& duck, DID tag, DESC& desc, size_t start_index = 0, PDS pds = 0) const;
 
+        //!
+        //! Get the deserialized form of a descriptor in the list.
+        //! The descriptor is deserialized on first access only. The deserialized object, or the
+        //! deserialization failure, is kept with the list entry and reused as long as the binary
+        //! descriptor and the input character set of the TSDuck context are unchanged.
+        //! @tparam DESC A subclass of AbstractDescriptor.
+        //! @param [in,out] duck TSDuck execution context.
+        //! @param [in] index Index of the descriptor in the list. Valid index are 0 to count()-1.
+        //! @return The address of the deserialized descriptor or a null pointer if @a index is
+        //! out of range or the descriptor cannot be deserialized as a @a DESC. The returned object
+        //! remains valid until the descriptor list or the binary descriptor is modified, the list
+        //! is destroyed or the same descriptor is accessed with another input character set.
+        //!
+        template <class DESC, typename std::enable_if<std::is_base_of<AbstractDescriptor, DESC>::value>::type* = nullptr>
+        const DESC* deserializedAt(DuckContext& duck, size_t index) const;
+
         //!
         //! Total number of bytes that is required to serialize the list of descriptors.
         //! @param [in] start Starting index in the descriptor list.
@@ -391,21 +429,69 @@ namespace ts {
         bool fromXML(DuckContext& duck, const xml::Element* parent);
 
     private:
-        // Each entry contains a descriptor and its corresponding private data specifier.
-        struct Element
+        // A deserialized view of a descriptor, one per descriptor class. All views of an entry are chained.
+        // The object is kept even when the deserialization failed, to avoid deserializing again.
+        class Decoded
+        {
+            TS_NOBUILD_NOCOPY(Decoded);
+        public:
+            Decoded(const DuckContext& duck, const Descriptor& bin, AbstractDescriptor* obj);
+            bool sameBinary(const Descriptor& bin) const;
+
+            const ByteBlock             binary;   // Binary descriptor at deserialization time.
+            const Charset* const        charset;  // Default input character set at deserialization time.
+            const AbstractDescriptorPtr object;   // Deserialized descriptor, possibly invalid.
+            Decoded*                    next = nullptr;
+        };
+
+        // Each entry contains a descriptor, its corresponding private data specifier and its deserialized views.
+        // The deserialized views are not copied with the entry.
+        class Element
         {
+        public:
             // Public members:
             DescriptorPtr desc;
             PDS pds;
+            mutable Decoded* decoded = nullptr;
 
-            // Constructor:
+            // Constructors, assignments, destructor:
             Element(const DescriptorPtr& desc_ = DescriptorPtr(), PDS pds_ = 0) : desc(desc_), pds(pds_) {}
+            Element(const Element& other) : desc(other.desc), pds(other.pds) {}
+            Element(Element&& other) noexcept : desc(std::move(other.desc)), pds(other.pds), decoded(other.decoded) { other.decoded = nullptr; }
+            Element& operator=(const Element& other);
+            Element& operator=(Element&& other) noexcept;
+            ~Element() { clearDecoded(); }
+
+            // Delete all deserialized views.
+            void clearDecoded();
         };
         typedef std::vector <Element> ElementVector;
 
         // Private members
         const AbstractTable* const _table;  // Parent table (zero for descriptor list object outside a table).
         ElementVector _list {};             // Vector of safe pointers to descriptors.
+        std::bitset<256> _tags {};          // Tags which are present in the list (never a false negative).
+
+        // Recompute the set of present tags after removing descriptors.
+        void rebuildTags();
+
+        // Copy the descriptors of another list, duplicate them when the other table is shared.
+        void copyList(const DescriptorList& dl);
+
+        // Check if the parent table is shared between threads.
+        bool isShared() const;
+
+        // Find the deserialized view of a list entry for a descriptor class. Lock the views of a shared table.
+        // Return false if not found. Otherwise, obj is the deserialized object or null if it is invalid.
+        bool findDecoded(const DuckContext& duck, size_t index, const std::type_info& type, const AbstractDescriptor*& obj) const;
+
+        // Same as findDecoded() without lock. When prune is true, obsolete views are deleted:
+        // previous contents of the binary descriptor and other character sets for the same class.
+        bool searchDecoded(const DuckContext& duck, size_t index, const std::type_info& type, const AbstractDescriptor*& obj, bool prune) const;
+
+        // Add a deserialized view to a list entry. Return the object or null if it is invalid.
+        // In a shared table, return the view of another thread if it was added in the meantime.
+        const AbstractDescriptor* addDecoded(const DuckContext& duck, size_t index, AbstractDescriptor* obj) const;
 
         // Prepare removal of a private_data_specifier descriptor.
         // Return true if can be removed, false if it cannot (private descriptors ahead).
@@ -430,8 +516,9 @@ size_t ts::DescriptorList::search(DuckContext& duck, DID tag, DESC& desc, size_t
 {
     // Repeatedly search for a descriptor until one is successfully deserialized
     for (size_t index = search(tag, start_index, pds); index < _list.size(); index = search(tag, index + 1, pds)) {
-        desc.deserialize(duck, *(_list[index].desc));
-        if (desc.isValid()) {
+        const DESC* dp = deserializedAt<DESC>(duck, index);
+        if (dp != nullptr) {
+            desc = *dp;
             return index;
         }
     }
@@ -440,3 +527,19 @@ size_t ts::DescriptorList::search(DuckContext& duck, DID tag, DESC& desc, size_t
     desc.invalidate();
     return _list.size();
 }
+
+// Get the deserialized form of a descriptor in the list.
+template <class DESC, typename std::enable_if<std::is_base_of<ts::AbstractDescriptor, DESC>::value>::type*>
+const DESC* ts::DescriptorList::deserializedAt(DuckContext& duck, size_t index) const
+{
+    if (index >= _list.size() || _list[index].desc.isNull() || !_list[index].desc->isValid()) {
+        return nullptr;
+    }
+
+    // Look for a previous deserialization of the same descriptor, otherwise deserialize it and keep the result.
+    const AbstractDescriptor* obj = nullptr;
+    if (!findDecoded(duck, index, typeid(DESC), obj)) {
+        obj = addDecoded(duck, index, new DESC(duck, *_list[index].desc));
+    }
+    return static_cast<const DESC*>(obj);
+}
@@ -17,18 +17,12 @@
 // Constructors and destructors.
 //----------------------------------------------------------------------------
 
-ts::T2MIDemux::PLPContext::PLPContext() :
-    first_packet(true),
-    ts(),
-    ts_next(0)
-{
-}
-
 ts::T2MIDemux::PIDContext::PIDContext() :
     continuity(0),
     sync(false),
     t2mi(),
-    plps()
+    plps(),
+    queued()
 {
 }
 
@@ -91,11 +85,7 @@ void ts::T2MIDemux::feedPacket(const TSPacket& pkt)
     }
 
     // Get / create PID context.
-    PIDContextPtr& pc(_pids[pid]);
-    if (pc.isNull()) {
-        pc = new PIDContext;
-        CheckNonNull(pc.pointer());
-    }
+    PIDContext& pc(getPIDContext(pid));
 
     // Ignore packets without a payload (their CC should not be incremented, no need to check the synchronization).
     if (!pkt.hasPayload()) {
@@ -103,17 +93,17 @@ void ts::T2MIDemux::feedPacket(const TSPacket& pkt)
     }
 
     // Drop duplicate packet in outer transport stream.
-    if (pc->sync && pkt.getCC() == pc->continuity) {
+    if (pc.sync && pkt.getCC() == pc.continuity) {
         return;
     }
 
     // Check if we loose synchronization.
-    if (pc->sync && (pkt.getDiscontinuityIndicator() || pkt.getCC() != ((pc->continuity + 1) & CC_MASK))) {
-        pc->lostSync();
+    if (pc.sync && (pkt.getDiscontinuityIndicator() || pkt.getCC() != ((pc.continuity + 1) & CC_MASK))) {
+        pc.lostSync();
     }
 
     // Keep track of continuity counters.
-    pc->continuity = pkt.getCC();
+    pc.continuity = pkt.getCC();
 
     // Locate packet payload.
     const uint8_t* data = pkt.getPayload();
@@ -127,7 +117,7 @@ void ts::T2MIDemux::feedPacket(const TSPacket& pkt)
         const size_t pf = size == 0 ? 0 : data[0];
         if (1 + pf >= size) {
             // There is no pointer field or it points outside the TS payload. Loosing sync.
-            pc->lostSync();
+            pc.lostSync();
             return;
         }
 
@@ -136,8 +126,8 @@ void ts::T2MIDemux::feedPacket(const TSPacket& pkt)
         size--;
 
         // If we were previously desynchronized, we are back on track.
-        if (!pc->sync) {
-            pc->sync = true;
+        if (!pc.sync) {
+            pc.sync = true;
             // Skip end of previous packet, before retrieving synchronization.
             data += pf;
             size -= pf;
@@ -145,9 +135,9 @@ void ts::T2MIDemux::feedPacket(const TSPacket& pkt)
     }
 
     // Accumulate packet data and process T2-MI packets.
-    if (pc->sync) {
-        pc->t2mi.append(data, size);
-        processT2MI(pid, *pc);
+    if (pc.sync) {
+        pc.t2mi.append(data, size);
+        processT2MI(pid, pc);
     }
 }
 
@@ -159,8 +149,122 @@ void ts::T2MIDemux::feedPacket(const TSPacket& pkt)
 void ts::T2MIDemux::PIDContext::lostSync()
 {
     t2mi.clear();   // accumulated T2-MI packet buffer.
-    plps.clear();   // we also lose partially demuxed PLP's.
     sync = false;
+
+    // We also lose partially demuxed TS packets but keep complete ones in output queues.
+    for (auto& it : plps) {
+        PLPContext& plpc(*it.second);
+        if (plpc.last_size > 0) {
+            plpc.packets.pop_back();
+            plpc.last_size = 0;
+        }
+        plpc.first_packet = true;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Get / create a PID context.
+//----------------------------------------------------------------------------
+
+ts::T2MIDemux::PIDContext& ts::T2MIDemux::getPIDContext(PID pid)
+{
+    PIDContextPtr& pc(_pids[pid]);
+    if (pc.isNull()) {
+        pc = new PIDContext;
+        CheckNonNull(pc.pointer());
+    }
+    return *pc;
+}
+
+
+//----------------------------------------------------------------------------
+// Management of PLP output queues.
+//----------------------------------------------------------------------------
+
+void ts::T2MIDemux::setPLPQueue(PID pid, uint8_t plp, bool on)
+{
+    getPIDContext(pid).queued.set(plp, on);
+}
+
+void ts::T2MIDemux::getPLPs(PID pid, PLPSet& plps, bool queued_only) const
+{
+    plps.reset();
+    const auto pc = _pids.find(pid);
+    if (pc != _pids.end()) {
+        for (const auto& it : pc->second->plps) {
+            if (!queued_only || it.second->next < it.second->complete()) {
+                plps.set(it.first);
+            }
+        }
+    }
+}
+
+size_t ts::T2MIDemux::queuedTSPackets(PID pid, uint8_t plp) const
+{
+    const auto pc = _pids.find(pid);
+    if (pc != _pids.end()) {
+        const auto plpc = pc->second->plps.find(plp);
+        if (plpc != pc->second->plps.end()) {
+            return plpc->second->complete() - plpc->second->next;
+        }
+    }
+    return 0;
+}
+
+size_t ts::T2MIDemux::getTSPackets(PID pid, uint8_t plp, TSPacket* packets, size_t max_packets)
+{
+    const auto pc = _pids.find(pid);
+    if (pc == _pids.end()) {
+        return 0;
+    }
+    const auto it = pc->second->plps.find(plp);
+    if (it == pc->second->plps.end()) {
+        return 0;
+    }
+    PLPContext& plpc(*it->second);
+    const size_t count = std::min(max_packets, plpc.complete() - plpc.next);
+    if (count > 0) {
+        TSPacket::Copy(packets, &plpc.packets[plpc.next], count);
+        plpc.next += count;
+        plpc.compress();
+    }
+    return count;
+}
+
+
+//----------------------------------------------------------------------------
+// Append extracted bytes of TS packets in a PLP context.
+//----------------------------------------------------------------------------
+
+void ts::T2MIDemux::PLPContext::append(const uint8_t* data, size_t size)
+{
+    while (size > 0) {
+        if (last_size == 0) {
+            // Start a new packet, directly in the vector.
+            packets.emplace_back();
+        }
+        const size_t chunk = std::min(size, PKT_SIZE - last_size);
+        std::memcpy(packets.back().b + last_size, data, chunk);
+        data += chunk;
+        size -= chunk;
+        last_size = (last_size + chunk) % PKT_SIZE;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Remove already output packets from a PLP context.
+//----------------------------------------------------------------------------
+
+void ts::T2MIDemux::PLPContext::compress()
+{
+    // When all complete packets are output, only the incomplete one, if any, is moved.
+    // Otherwise, wait for many unused packets before compressing.
+    if (next > 0 && (next >= complete() || next >= 100)) {
+        packets.erase(packets.begin(), packets.begin() + next);
+        next = 0;
+    }
 }
 
 
@@ -190,17 +294,34 @@ void ts::T2MIDemux::processT2MI(PID pid, PIDContext& pc)
                 break;
             }
 
-            // Build a T2-MI packet.
-            T2MIPacket pkt(pc.t2mi.data() + start, packet_size, pid);
-            if (pkt.isValid()) {
-
-                // Notify the application.
-                if (_handler != nullptr) {
-                    _handler->handleT2MIPacket(*this, pkt);
+            // Check the CRC directly in the buffer, without building a T2-MI packet.
+            const uint8_t* const t2mi = pc.t2mi.data() + start;
+            if (CRC32(t2mi, packet_size - SECTION_CRC32_SIZE) == GetUInt32(t2mi + packet_size - SECTION_CRC32_SIZE)) {
+
+                // Structure of T2-MI packet: see ETSI TS 102 773, section 5.
+                // A baseband frame packet starts with frame_idx, plp_id, intl_frame_start.
+                const bool bbframe = t2mi[0] == uint8_t(T2MIPacketType::BASEBAND_FRAME) && payload_bytes >= 3;
+                const uint8_t plp = bbframe ? t2mi[T2MI_HEADER_SIZE + 1] : 0;
+                bool queued = bbframe && (_queue_all || pc.queued.test(plp));
+                const uint8_t* const bb_data = t2mi + T2MI_HEADER_SIZE + 3;
+                const size_t bb_size = bbframe ? payload_bytes - 3 : 0;
+
+                if (_handler != nullptr && (_notify_t2mi || (bbframe && !queued))) {
+                    // The application needs a T2-MI packet object.
+                    T2MIPacket pkt(t2mi, packet_size, pid);
+                    if (_notify_t2mi) {
+                        _handler->handleT2MIPacket(*this, pkt);
+                        // The handler may have enabled the output queue of this PLP.
+                        queued = bbframe && (_queue_all || pc.queued.test(plp));
+                    }
+                    if (bbframe) {
+                        demuxTS(pc, plp, queued, bb_data, bb_size, queued ? nullptr : &pkt);
+                    }
+                }
+                else if (queued) {
+                    // Directly extract the TS packets into the output queue.
+                    demuxTS(pc, plp, true, bb_data, bb_size, nullptr);
                 }
-
-                // Demux TS packets from the T2-MI packet.
-                demuxTS(pid, pc, pkt);
             }
 
             // Point to next T2-MI packet.
@@ -222,18 +343,13 @@ void ts::T2MIDemux::processT2MI(PID pid, PIDContext& pc)
 // Demux all encapsulated TS packets from a T2-MI packet.
 //----------------------------------------------------------------------------
 
-void ts::T2MIDemux::demuxTS(PID pid, PIDContext& pc, const T2MIPacket& pkt)
+void ts::T2MIDemux::demuxTS(PIDContext& pc, uint8_t plp, bool queued, const uint8_t* data, size_t size, const T2MIPacket* pkt)
 {
-    // Keep only baseband frames.
-    const uint8_t* data = pkt.basebandFrame();
-    size_t size = pkt.basebandFrameSize();
-
-    if (data == nullptr || size < T2_BBHEADER_SIZE) {
+    if (size < T2_BBHEADER_SIZE) {
         // Not a base band frame packet.
         return;
     }
 
-    // Structure of T2-MI packet: see ETSI TS 102 773, section 5.
     // Structure of a T2 baseband frame: see ETSI EN 302 755, section 5.1.7.
 
     // Extract the TS/GS field of the MATYPE in the BBHEADER.
@@ -265,72 +381,74 @@ void ts::T2MIDemux::demuxTS(PID pid, PIDContext& pc, const T2MIPacket& pkt)
     }
 
     // Get / create PLP context.
-    const uint8_t plp = pkt.plp();
     PLPContextPtr& plpp(pc.plps[plp]);
     if (plpp.isNull()) {
         plpp = new PLPContext;
         CheckNonNull(plpp.pointer());
     }
+    PLPContext& plpc(*plpp);
 
+    // In the data field, the user packets are transmitted without their sync byte.
+    // The sync byte is inserted again in the TS packets which are built here.
     if (syncd == 0xFFFF) {
         // No user packet in data field
-        plpp->ts.append(data, dfl);
+        plpc.append(data, dfl);
     }
     else {
         // Synchronization distance in bytes, bounded by data field size.
         syncd = std::min(syncd / 8, dfl);
 
         // Process end of previous packet.
-        if (!plpp->first_packet && syncd > 0) {
-            if (plpp->ts.size() % PKT_SIZE == 0) {
-                plpp->ts.append(SYNC_BYTE);
+        if (!plpc.first_packet && syncd > 0) {
+            if (plpc.last_size == 0) {
+                plpc.append(&SYNC_BYTE, 1);
             }
-            plpp->ts.append(data, syncd - npd);
+            plpc.append(data, syncd - npd);
         }
-        plpp->first_packet = false;
+        plpc.first_packet = false;
         data += syncd;
         dfl -= syncd;
 
-        // Process subsequent complete packets.
+        // Process subsequent complete packets, directly built in the vector.
+        // If the previous packet is not complete (should not happen), keep the byte stream.
+        if (plpc.last_size == 0 && dfl >= PKT_SIZE - 1) {
+            const size_t count = dfl / (PKT_SIZE - 1);
+            size_t index = plpc.packets.size();
+            plpc.packets.resize(index + count);
+            for (size_t i = 0; i < count; ++i) {
+                uint8_t* const b = plpc.packets[index++].b;
+                b[0] = SYNC_BYTE;
+                std::memcpy(b + 1, data, PKT_SIZE - 1);
+                data += PKT_SIZE - 1;
+            }
+            dfl -= count * (PKT_SIZE - 1);
+        }
         while (dfl >= PKT_SIZE - 1) {
-            plpp->ts.append(SYNC_BYTE);
-            plpp->ts.append(data, PKT_SIZE - 1);
+            plpc.append(&SYNC_BYTE, 1);
+            plpc.append(data, PKT_SIZE - 1);
             data += PKT_SIZE - 1;
             dfl -= PKT_SIZE - 1;
         }
 
         // Process optional trailing truncated packet.
         if (dfl > 0) {
-            plpp->ts.append(SYNC_BYTE);
-            plpp->ts.append(data, dfl);
+            plpc.append(&SYNC_BYTE, 1);
+            plpc.append(data, dfl);
         }
     }
 
-    // Now process each complete TS packet.
-    while (plpp->ts_next + PKT_SIZE <= plpp->ts.size()) {
-
-        // Build the TS packet.
-        TSPacket tsPkt;
-        std::memcpy(tsPkt.b, &plpp->ts[plpp->ts_next], PKT_SIZE);
-        plpp->ts_next += PKT_SIZE;
-
-        // Notify the application. Note that we are already in a protected section.
-        if (_handler != nullptr) {
-            _handler->handleTSPacket(*this, pkt, tsPkt);
+    // Without output queue, notify each complete TS packet to the application.
+    // Note that we are already in a protected section.
+    if (!queued) {
+        const size_t complete = plpc.complete();
+        while (plpc.next < complete) {
+            const TSPacket& ts(plpc.packets[plpc.next++]);
+            if (_handler != nullptr && pkt != nullptr) {
+                _handler->handleTSPacket(*this, *pkt, ts);
+            }
         }
     }
-
-    // Compress or cleanup the TS buffer.
-    if (plpp->ts_next >= plpp->ts.size()) {
-        // No more packet to output, cleanup.
-        plpp->ts.clear();
-        plpp->ts_next = 0;
-    }
-    else if (plpp->ts_next >= 100 * PKT_SIZE) {
-        // TS buffer has many unused packets, compress it.
-        plpp->ts.erase(0, plpp->ts_next);
-        plpp->ts_next = 0;
-    }
+    plpc.compress();
 }
 
 
@@ -30,6 +30,13 @@ namespace ts {
     //! The application decides which T2-MI PID's should be demuxed. These PID's can
     //! be selected from the beginning or in response to the discovery of T2-MI PID's.
     //!
+    //! The T2-MI packets are parsed in place, in the reassembly buffer of the PID.
+    //! The extracted TS packets of a PLP are either notified to the handler, one by one,
+    //! or accumulated in an output queue for this PLP (see setPLPQueue()). In the latter
+    //! case, the TS packets are directly built in the queue and the application fetches
+    //! them by blocks using getTSPackets(). A T2MIPacket object is built only when the
+    //! application needs one in a handler.
+    //!
     class TSDUCKDLL T2MIDemux:
         public AbstractDemux,
         private TableHandlerInterface
@@ -66,6 +73,61 @@ namespace ts {
             _handler = h;
         }
 
+        //!
+        //! Set of PLP identifiers.
+        //!
+        typedef std::bitset<256> PLPSet;
+
+        //!
+        //! Enable or disable the notification of T2-MI packets to the handler.
+        //! When disabled, handleT2MIPacket() is no longer invoked. The default is enabled.
+        //! @param [in] on True to enable the notification, false to disable it.
+        //!
+        void setT2MIPacketNotification(bool on) { _notify_t2mi = on; }
+
+        //!
+        //! Enable or disable the output queue of extracted TS packets for one PLP.
+        //! When the queue of a PLP is enabled, its TS packets are no longer notified
+        //! to the handler. They are accumulated in the queue until getTSPackets() is called.
+        //! @param [in] pid The T2-MI PID.
+        //! @param [in] plp The PLP identifier.
+        //! @param [in] on True to enable the queue, false to disable it.
+        //!
+        void setPLPQueue(PID pid, uint8_t plp, bool on = true);
+
+        //!
+        //! Enable or disable the output queues of all PLP's in all T2-MI PID's.
+        //! @param [in] on True to enable the queues, false to disable them.
+        //! When false, the queues which were individually enabled using setPLPQueue() are kept.
+        //!
+        void setAllPLPQueues(bool on = true) { _queue_all = on; }
+
+        //!
+        //! Get the set of PLP's which were found so far in a T2-MI PID.
+        //! @param [in] pid The T2-MI PID.
+        //! @param [out] plps The set of PLP identifiers.
+        //! @param [in] queued_only If true, return only the PLP's with TS packets in their output queue.
+        //!
+        void getPLPs(PID pid, PLPSet& plps, bool queued_only = false) const;
+
+        //!
+        //! Get the number of TS packets in the output queue of a PLP.
+        //! @param [in] pid The T2-MI PID.
+        //! @param [in] plp The PLP identifier.
+        //! @return The number of TS packets which can be fetched using getTSPackets().
+        //!
+        size_t queuedTSPackets(PID pid, uint8_t plp) const;
+
+        //!
+        //! Fetch and remove TS packets from the output queue of a PLP.
+        //! @param [in] pid The T2-MI PID.
+        //! @param [in] plp The PLP identifier.
+        //! @param [out] packets Address of a buffer of TS packets.
+        //! @param [in] max_packets Maximum number of TS packets to return.
+        //! @return The number of returned TS packets.
+        //!
+        size_t getTSPackets(PID pid, uint8_t plp, TSPacket* packets, size_t max_packets);
+
     protected:
         // Inherited methods from AbstractDemux.
         virtual void immediateReset() override;
@@ -73,14 +135,23 @@ namespace ts {
 
     private:
         // Analysis context for one PLP inside one T2-MI stream.
+        // The extracted TS packets are directly built in the vector. When the last packet is
+        // incomplete, the number of bytes which are already present is in last_size.
         struct PLPContext
         {
-            bool      first_packet;  // First T2-MI packet not yet processed
-            ByteBlock ts;            // Buffer to accumulate extracted TS packets.
-            size_t    ts_next;       // Next packet to output.
+            bool           first_packet = true;  // First T2-MI packet not yet processed
+            TSPacketVector packets {};           // Extracted TS packets, the last one may be incomplete.
+            size_t         next = 0;             // Index of next packet to output.
+            size_t         last_size = 0;        // Size of the last incomplete packet, zero if complete.
 
-            // Default constructor
-            PLPContext();
+            // Number of complete packets in the vector, including already output ones.
+            size_t complete() const { return packets.size() - (last_size > 0 ? 1 : 0); }
+
+            // Append extracted bytes of TS packets.
+            void append(const uint8_t* data, size_t size);
+
+            // Remove already output packets.
+            void compress();
         };
 
         // Map of safe pointers to PLPContext, indexed by PLP id.
@@ -94,6 +165,7 @@ namespace ts {
             bool          sync;        // We are synchronous in this PID
             ByteBlock     t2mi;        // Buffer containing the T2-MI data.
             PLPContextMap plps;        // Map of PLP context per PID.
+            PLPSet        queued;      // Set of PLP's with an output queue.
 
             // Default constructor
             PIDContext();
@@ -112,15 +184,21 @@ namespace ts {
         // Process and remove complete T2-MI packets from the buffer.
         void processT2MI(PID pid, PIDContext& pc);
 
-        // Demux all encapsulated TS packets from a T2-MI packet.
-        void demuxTS(PID pid, PIDContext& pc, const T2MIPacket& pkt);
+        // Get / create a PID context.
+        PIDContext& getPIDContext(PID pid);
+
+        // Demux all encapsulated TS packets from a baseband frame.
+        // The T2-MI packet is used for handler notification only, null when all TS packets are queued.
+        void demuxTS(PIDContext& pc, uint8_t plp, bool queued, const uint8_t* data, size_t size, const T2MIPacket* pkt);
 
         // Process a PMT.
         void processPMT(const PMT& pmt);
 
         // Private members:
-        T2MIHandlerInterface* _handler;    // Application-defined handler
-        PIDContextMap         _pids;       // Map of PID contexts.
-        SectionDemux          _psi_demux;  // Demux for PSI parsing.
+        T2MIHandlerInterface* _handler;            // Application-defined handler
+        bool                  _notify_t2mi = true; // Notify T2-MI packets to the handler.
+        bool                  _queue_all = false;  // Use an output queue for all PLP's.
+        PIDContextMap         _pids;               // Map of PID contexts.
+        SectionDemux          _psi_demux;          // Demux for PSI parsing.
     };
 }
@@ -11,3 +11,8 @@
 ts::T2MIHandlerInterface::~T2MIHandlerInterface()
 {
 }
+
+// Default implementation is empty.
+void ts::T2MIHandlerInterface::handleTSPacket(T2MIDemux&, const T2MIPacket&, const TSPacket&)
+{
+}
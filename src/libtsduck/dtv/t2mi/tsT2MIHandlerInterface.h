@@ -50,10 +50,12 @@ namespace ts {
 
         //!
         //! This hook is invoked when a new TS packet is extracted.
+        //! It is not invoked for the PLP's which have an output queue in the demux.
+        //! The default implementation does nothing.
         //! @param [in,out] demux A reference to the T2-MI demux.
         //! @param [in] t2mi The T2-MI packet from which @a ts was extracted.
         //! @param [in] ts The extracted TS packet.
         //!
-        virtual void handleTSPacket(T2MIDemux& demux, const T2MIPacket& t2mi, const TSPacket& ts) = 0;
+        virtual void handleTSPacket(T2MIDemux& demux, const T2MIPacket& t2mi, const TSPacket& ts);
     };
 }
@@ -59,6 +59,21 @@ namespace ts {
         //!
         virtual bool isPrivate() const;
 
+        //!
+        //! Check if this table object is shared between threads.
+        //! The descriptors of a shared table are duplicated, not shared, when the table
+        //! is copied because the reference counts of descriptors are not thread-safe.
+        //! @return True if this table object is shared between threads.
+        //! @see setShared()
+        //!
+        bool isShared() const { return _shared.value; }
+
+        //!
+        //! Declare this table object as shared between threads.
+        //! A shared table shall no longer be modified. Copies of a shared table are not shared.
+        //!
+        void setShared() { _shared.value = true; }
+
         //!
         //! This method serializes a table.
         //! @param [in,out] duck TSDuck execution context.
@@ -414,6 +429,17 @@ namespace ts {
         virtual void deserializePayloadWrapper(PSIBuffer& buf, const Section& section);
 
     private:
+        // The shared state of a table is not propagated to its copies.
+        class SharedFlag
+        {
+        public:
+            bool value = false;
+            SharedFlag() = default;
+            SharedFlag(const SharedFlag&) {}
+            SharedFlag& operator=(const SharedFlag&) { return *this; }
+        };
+        SharedFlag _shared {};
+
         // Unreachable constructors and operators.
         AbstractTable() = delete;
     };
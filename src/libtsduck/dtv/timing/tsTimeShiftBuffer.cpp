@@ -9,6 +9,8 @@
 #include "tsTimeShiftBuffer.h"
 #include "tsNullReport.h"
 #include "tsFileUtils.h"
+#include "tsGuardCondition.h"
+#include "tsGuardMutex.h"
 
 #if !defined(TS_CXX17)
 constexpr size_t ts::TimeShiftBuffer::MIN_TOTAL_PACKETS;
@@ -83,11 +85,9 @@ bool ts::TimeShiftBuffer::open(Report& report)
     }
 
     if (memoryResident()) {
-        // The buffer is entirely memory-resident in _wcache.
-        _wcache.resize(_total_packets);
-        _wmdata.resize(_total_packets);
-        _rcache.clear();
-        _rmdata.clear();
+        // The buffer is entirely memory-resident in _mem_buffer.
+        _mem_buffer.resize(_total_packets);
+        _mem_mdata.resize(_total_packets);
     }
     else {
         // The buffer is backed up on disk.
@@ -109,23 +109,46 @@ bool ts::TimeShiftBuffer::open(Report& report)
             return false;
         }
 
-        // The read and write buffers use half of memory quota each.
-        // Since the size of the file is larger than the sum of the two,
-        // the read and write caches never overlap when the buffer is full.
-        _wcache.resize(_mem_packets / 2);
-        _wmdata.resize(_mem_packets / 2);
-        _rcache.resize(_mem_packets / 2);
-        _rmdata.resize(_mem_packets / 2);
+        // The two write blocks and the two read blocks use a quarter of memory quota each.
+        // Since the size of the file is larger than the sum of the blocks, a read-ahead
+        // block never overlaps the write block which is being filled.
+        const size_t block_size = std::max<size_t>(1, _mem_packets / 4);
+        for (size_t i = 0; i < 2; ++i) {
+            _wblocks[i].resize(block_size);
+            _rblocks[i].resize(block_size);
+        }
+        _wcur = _rcur = _rnext = 0;
+
+        // Start the I/O thread.
+        _io_queue.clear();
+        _io_terminate = false;
+        if (!Thread::start()) {
+            report.error(u"error starting time-shift I/O thread");
+            _file.close(report);
+            return false;
+        }
     }
 
     _cur_packets = 0;
     _next_read = _next_write = 0;
-    _wcache_next = _rcache_end = _rcache_next = 0;
     _is_open = true;
     return true;
 }
 
 
+//----------------------------------------------------------------------------
+// Allocate the buffers of an I/O block.
+//----------------------------------------------------------------------------
+
+void ts::TimeShiftBuffer::IOBlock::resize(size_t size)
+{
+    packets.resize(size);
+    mdata.resize(size);
+    index = count = 0;
+    write = pending = error = false;
+}
+
+
 //----------------------------------------------------------------------------
 // Close the buffer.
 //----------------------------------------------------------------------------
@@ -136,12 +159,23 @@ bool ts::TimeShiftBuffer::close(Report& report)
         return false;
     }
 
+    // Terminate the I/O thread, if any. Pending I/O are useless now.
+    {
+        GuardCondition lock(_io_mutex, _io_submitted);
+        _io_queue.clear();
+        _io_terminate = true;
+        lock.signal();
+    }
+    waitForTermination();
+
     _is_open = false;
     _cur_packets = 0;
-    _wcache.clear();
-    _wmdata.clear();
-    _rcache.clear();
-    _rmdata.clear();
+    _mem_buffer.clear();
+    _mem_mdata.clear();
+    for (size_t i = 0; i < 2; ++i) {
+        _wblocks[i].resize(0);
+        _rblocks[i].resize(0);
+    }
     return !_file.isOpen() || _file.close(report);
 }
 
@@ -166,71 +200,29 @@ bool ts::TimeShiftBuffer::shift(TSPacket& packet, TSPacketMetadata& mdata, Repor
     assert(_next_write < _total_packets);
 
     if (memoryResident()) {
-        // The buffer is entirely memory-resident in _wcache.
-        assert(_wcache.size() == _total_packets);
+        // The buffer is entirely memory-resident in _mem_buffer.
+        assert(_mem_buffer.size() == _total_packets);
         if (was_full) {
             // Buffer full: return oldest packet.
-            ret_packet = _wcache[_next_read];
-            ret_mdata = _wmdata[_next_read];
-            _next_read = (_next_read + 1) % _wcache.size();
+            ret_packet = _mem_buffer[_next_read];
+            ret_mdata = _mem_mdata[_next_read];
+            _next_read = (_next_read + 1) % _mem_buffer.size();
         }
         else {
             // Buffer not full, increase the packet count.
             _cur_packets++;
         }
-        _wcache[_next_write] = packet;
-        _wmdata[_next_write] = mdata;
-        _next_write = (_next_write + 1) % _wcache.size();
+        _mem_buffer[_next_write] = packet;
+        _mem_mdata[_next_write] = mdata;
+        _next_write = (_next_write + 1) % _mem_buffer.size();
     }
     else {
-        // The buffer uses a backup file.
-        if (!was_full) {
-            // While the buffer is not full, simply write the packet in the file.
-            if (!_file.writePackets(&packet, &mdata, 1, report)) {
-                return false;
-            }
-            _cur_packets++;
-        }
-        else {
-            // The buffer is full, now read and write in caches.
-            // First, make sure the read cache is filled.
-            if (_rcache_next >= _rcache_end) {
-                // Read cache is empty, load it.
-                const size_t count = std::min(_rcache.size(), _total_packets - _next_read);
-                _rcache_next = 0;
-                _rcache_end = readFile(_next_read, &_rcache[0], &_rmdata[0], count, report);
-                if (_rcache_end == 0) {
-                    report.error(u"error reading time-shift file");
-                    return false;
-                }
-            }
-            // Return oldest packet from memory cache.
-            ret_packet = _rcache[_rcache_next];
-            ret_mdata = _rmdata[_rcache_next++];
-            _next_read = (_next_read + 1) % _total_packets;
-            // Flush the write cache if necessary.
-            if (_wcache_next >= _wcache.size()) {
-                // Flush the entire write cache on disk.
-                // Split in two operations if exceeds the end of file.
-                // Write index in file of the start of the write cache:
-                const size_t file_index = _next_write >= _wcache.size() ? _next_write - _wcache.size() : _total_packets + _next_write - _wcache.size();
-                assert(file_index < _total_packets);
-                const size_t count = std::min(_wcache.size(), _total_packets - file_index);
-                if (!writeFile(file_index, &_wcache[0], &_wmdata[0], count, report)) {
-                    return false;
-                }
-                // Write second part at begining of file if required.
-                if (count < _wcache.size() && !writeFile(0, &_wcache[count], &_wmdata[count], _wcache.size() - count, report)) {
-                    return false;
-                }
-                // Write cache is now empty.
-                _wcache_next = 0;
-            }
-            // Write the next packet in the write cache.
-            _wcache[_wcache_next] = packet;
-            _wmdata[_wcache_next++] = mdata;
+        // The buffer uses a backup file. The packet and metadata are swapped in place.
+        ret_packet = packet;
+        ret_mdata = mdata;
+        if (!shiftFile(ret_packet, ret_mdata, was_full, report)) {
+            return false;
         }
-        _next_write = (_next_write + 1) % _total_packets;
     }
 
     // Returned packet. It is a null packet when the buffer was not yet full.
@@ -247,6 +239,166 @@ bool ts::TimeShiftBuffer::shift(TSPacket& packet, TSPacketMetadata& mdata, Repor
 }
 
 
+//----------------------------------------------------------------------------
+// Push and pull in the disk backed buffer.
+//----------------------------------------------------------------------------
+
+bool ts::TimeShiftBuffer::shiftFile(TSPacket& packet, TSPacketMetadata& mdata, bool was_full, Report& report)
+{
+    TSPacket in_packet(packet);
+    TSPacketMetadata in_mdata(mdata);
+
+    if (was_full) {
+        // Return the oldest packet from the current read block.
+        IOBlock* rb = &_rblocks[_rcur];
+        if (_rnext >= rb->count) {
+            // The current read block is exhausted, switch to the other one, normally already prefetched.
+            _rcur ^= 1;
+            rb = &_rblocks[_rcur];
+            // The block may still be owned by the I/O thread, check its state under the mutex.
+            bool idle = false;
+            {
+                GuardMutex lock(_io_mutex);
+                idle = !rb->pending && rb->count == 0;
+            }
+            if (idle) {
+                // First read after the filling phase, nothing was prefetched yet.
+                rb->index = _next_read;
+                rb->count = std::min(rb->packets.size(), _total_packets - _next_read);
+                submitBlock(*rb, false, report);
+            }
+            if (!waitBlock(*rb, report)) {
+                return false;
+            }
+            assert(rb->index == _next_read);
+            _rnext = 0;
+            // Prefetch the next block in the exhausted one.
+            IOBlock& next = _rblocks[_rcur ^ 1];
+            next.index = (_next_read + rb->count) % _total_packets;
+            next.count = std::min(next.packets.size(), _total_packets - next.index);
+            submitBlock(next, false, report);
+        }
+        packet = rb->packets[_rnext];
+        mdata = rb->mdata[_rnext++];
+        _next_read = (_next_read + 1) % _total_packets;
+    }
+    else {
+        _cur_packets++;
+    }
+
+    // Store the new packet in the current write block.
+    IOBlock& wb = _wblocks[_wcur];
+    if (wb.count == 0) {
+        wb.index = _next_write;
+    }
+    wb.packets[wb.count] = in_packet;
+    wb.mdata[wb.count++] = in_mdata;
+    _next_write = (_next_write + 1) % _total_packets;
+
+    // Flush the write block when full or at end of file, then switch to the other one.
+    if (wb.count >= wb.packets.size() || _next_write == 0) {
+        submitBlock(wb, true, report);
+        _wcur ^= 1;
+        if (!waitBlock(_wblocks[_wcur], report)) {
+            return false;
+        }
+        _wblocks[_wcur].count = 0;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Submit a block to the I/O thread.
+//----------------------------------------------------------------------------
+
+void ts::TimeShiftBuffer::submitBlock(IOBlock& block, bool write, Report& report)
+{
+    GuardCondition lock(_io_mutex, _io_submitted);
+    block.write = write;
+    block.pending = true;
+    block.error = false;
+    block.log.messages.clear();
+    block.log.setMaxSeverity(report.maxSeverity());
+    _io_queue.push_back(&block);
+    lock.signal();
+}
+
+
+//----------------------------------------------------------------------------
+// Wait for the completion of a block by the I/O thread.
+//----------------------------------------------------------------------------
+
+bool ts::TimeShiftBuffer::waitBlock(IOBlock& block, Report& report)
+{
+    {
+        GuardCondition lock(_io_mutex, _io_completed);
+        while (block.pending) {
+            lock.waitCondition();
+        }
+    }
+
+    // The block is now owned by the application thread, replay the messages of the I/O thread.
+    for (const auto& it : block.log.messages) {
+        report.log(it.first, it.second);
+    }
+    block.log.messages.clear();
+    return !block.error;
+}
+
+
+//----------------------------------------------------------------------------
+// Messages of the I/O thread are kept until the completion of the block.
+//----------------------------------------------------------------------------
+
+void ts::TimeShiftBuffer::IOReport::writeLog(int severity, const UString& msg)
+{
+    messages.push_back(std::make_pair(severity, msg));
+}
+
+
+//----------------------------------------------------------------------------
+// The I/O thread, process blocks in order of submission.
+//----------------------------------------------------------------------------
+
+void ts::TimeShiftBuffer::main()
+{
+    for (;;) {
+        // Wait for a block to process.
+        IOBlock* block = nullptr;
+        {
+            GuardCondition lock(_io_mutex, _io_submitted);
+            while (_io_queue.empty() && !_io_terminate) {
+                lock.waitCondition();
+            }
+            if (_io_terminate) {
+                break;
+            }
+            block = _io_queue.front();
+            _io_queue.pop_front();
+        }
+
+        // Perform the I/O outside the mutex. The block is owned by this thread while pending.
+        bool success = false;
+        if (block->write) {
+            success = writeFile(block->index, &block->packets[0], &block->mdata[0], block->count, block->log);
+        }
+        else {
+            block->count = readFile(block->index, &block->packets[0], &block->mdata[0], block->count, block->log);
+            success = block->count > 0;
+        }
+
+        // Notify the completion.
+        {
+            GuardCondition lock(_io_mutex, _io_completed);
+            block->pending = false;
+            block->error = !success;
+            lock.signal();
+        }
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Seek in the backup file.
 //----------------------------------------------------------------------------
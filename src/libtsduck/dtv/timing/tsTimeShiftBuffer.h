@@ -16,6 +16,9 @@
 #include "tsTSFile.h"
 #include "tsTSPacketMetadata.h"
 #include "tsReport.h"
+#include "tsThread.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
 
 namespace ts {
 
@@ -24,9 +27,16 @@ namespace ts {
     //!
     //! A TS packet buffer for time shift.
     //! The buffer is partly implemented in virtual memory and partly on disk.
+    //!
+    //! When the buffer is backed up on disk, all file accesses are performed by an
+    //! internal thread. The memory cache is split into two write-behind blocks and
+    //! two read-ahead blocks. While the application fills one write block and reads
+    //! from one read block, the internal thread flushes the other write block and
+    //! prefetches the next read block. In steady state, shift() never waits for disk I/O.
+    //!
     //! @ingroup mpeg
     //!
-    class TSDUCKDLL TimeShiftBuffer
+    class TSDUCKDLL TimeShiftBuffer : private Thread
     {
         TS_NOCOPY(TimeShiftBuffer);
     public:
@@ -56,7 +66,7 @@ namespace ts {
         //!
         //! Destructor.
         //!
-        virtual ~TimeShiftBuffer();
+        virtual ~TimeShiftBuffer() override;
 
         //!
         //! Set the total size of the time shift buffer in packets.
@@ -68,7 +78,8 @@ namespace ts {
 
         //!
         //! Set the maximum number of cached packets to be held in memory.
-        //! Must be called before open().
+        //! Must be called before open(). When the buffer is backed up on disk, this memory
+        //! is split into four blocks, two for write-behind and two for read-ahead.
         //! @param [in] count Max number of cached packets in memory.
         //! @return True on success, false if already open.
         //!
@@ -149,31 +160,81 @@ namespace ts {
         //! @param [in,out] packet On input, contains the packet to push.
         //! On output, contains the time-shifted packet.
         //! @param [in,out] metadata Packet metadata.
-        //! @param [in,out] report Where to report errors.
+        //! @param [in,out] report Where to report errors. When the buffer is backed up on disk,
+        //! the errors of the internal I/O thread are reported here, during a later call to shift().
         //! @return True on success, false on error.
         //!
         bool shift(TSPacket& packet, TSPacketMetadata& metadata, Report& report);
 
     private:
+        // Messages which are reported by the I/O thread on a block. They are
+        // replayed in the report of the application when the block completes.
+        class IOReport : public Report
+        {
+        public:
+            std::list<std::pair<int, UString>> messages {};
+        protected:
+            virtual void writeLog(int severity, const UString& msg) override;
+        };
+
+        // A block of contiguous packets in the backup file, read or written by the I/O thread.
+        // The packets, metadata and messages are owned by the I/O thread while the block is pending.
+        class IOBlock
+        {
+        public:
+            TSPacketVector         packets {};   // Packet buffer.
+            TSPacketMetadataVector mdata {};     // Packet metadata buffer.
+            size_t                 index = 0;    // Index in file of first packet.
+            size_t                 count = 0;    // Number of packets to write, or to read then actually read.
+            bool                   write = false;   // Write operation, read otherwise.
+            bool                   pending = false; // Submitted to the I/O thread, not yet completed.
+            bool                   error = false;   // Last I/O operation failed.
+            IOReport               log {};          // Messages of the last I/O operation.
+
+            // Allocate the buffers.
+            void resize(size_t size);
+        };
+
         bool    _is_open = false;           // Buffer is open.
         size_t  _cur_packets = 0;           // Current number of packets in the buffer.
         size_t  _total_packets = DEFAULT_TOTAL_PACKETS; // Total capacity of the buffer.
         size_t  _mem_packets = DEFAULT_MEMORY_PACKETS;  // Max packets in memory.
         UString _directory {};              // Where to store the backup file.
-        TSFile  _file {};                   // Backup file on disk.
+        TSFile  _file {};                   // Backup file on disk, accessed by the I/O thread only.
         size_t  _next_read = 0;             // Index in buffer of next packet to read.
         size_t  _next_write = 0;            // Index in buffer of next packet to write.
-        size_t  _wcache_next = 0;           // Next index to write in _wcache (up to end of _wcache).
-        size_t  _rcache_end = 0;            // End index in _rcache (after last loaded packet).
-        size_t  _rcache_next = 0;           // Next index to read in _rcache.
-        TSPacketVector         _wcache {};  // Write cache (or complete buffer if in memory).
-        TSPacketVector         _rcache {};  // Read cache.
-        TSPacketMetadataVector _wmdata {};  // Packet metadata for _wcache.
-        TSPacketMetadataVector _rmdata {};  // Packet metadata for _rcache.
+        TSPacketVector         _mem_buffer {};  // Complete buffer when memory resident.
+        TSPacketMetadataVector _mem_mdata {};   // Packet metadata for _mem_buffer.
+
+        // Blocks which are used when the buffer is backed up on disk.
+        IOBlock _wblocks[2] {};             // Write-behind blocks.
+        IOBlock _rblocks[2] {};             // Read-ahead blocks.
+        size_t  _wcur = 0;                  // Index in _wblocks of block being filled.
+        size_t  _rcur = 0;                  // Index in _rblocks of block being read.
+        size_t  _rnext = 0;                 // Next index to read in _rblocks[_rcur].
+
+        // Communication with the I/O thread. The blocks are processed in order of submission.
+        // Therefore, a block which is read is always read after all previously submitted writes.
+        Mutex               _io_mutex {};      // Protect the following fields.
+        Condition           _io_submitted {};  // Signaled when a block is submitted or on termination.
+        Condition           _io_completed {};  // Signaled when a block is completed.
+        std::deque<IOBlock*> _io_queue {};     // Blocks to process by the I/O thread.
+        bool                _io_terminate = false; // Request to terminate the I/O thread.
+
+        // Submit a block to the I/O thread, wait for completion of a block.
+        // The messages of the I/O thread on the block are reported on completion.
+        void submitBlock(IOBlock& block, bool write, Report& report);
+        bool waitBlock(IOBlock& block, Report& report);
+
+        // Push and pull in the disk backed buffer.
+        bool shiftFile(TSPacket& packet, TSPacketMetadata& mdata, bool was_full, Report& report);
 
         // Seek, read, write in the backup file.
         bool seekFile(size_t index, Report& report);
         bool writeFile(size_t index, const TSPacket* buffer, const TSPacketMetadata* mdata, size_t count, Report& report);
         size_t readFile(size_t index, TSPacket* buffer, TSPacketMetadata* mdata, size_t count, Report& report);
+
+        // Implementation of Thread, the I/O thread.
+        virtual void main() override;
     };
 }
@@ -0,0 +1,324 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+
+#include "tsPcapTSExtractor.h"
+#include "tsTSPacket.h"
+#include "tsGuardMutex.h"
+#include "tsFileUtils.h"
+
+
+//----------------------------------------------------------------------------
+// Flow identification.
+//----------------------------------------------------------------------------
+
+ts::PcapTSExtractor::FlowId::FlowId(const PcapFilter::UDPDatagram& dg) :
+    ip_version(dg.isIPv6() ? IPv6_VERSION : IPv4_VERSION),
+    source_port(dg.sourcePort()),
+    destination_port(dg.destinationPort())
+{
+    if (ip_version == IPv6_VERSION) {
+        std::memcpy(source.data(), dg.ip_header + IPv6_SRC_ADDR_OFFSET, IPv6_ADDR_SIZE);
+        std::memcpy(destination.data(), dg.ip_header + IPv6_DEST_ADDR_OFFSET, IPv6_ADDR_SIZE);
+    }
+    else {
+        std::memcpy(source.data(), dg.ip_header + IPv4_SRC_ADDR_OFFSET, 4);
+        std::memcpy(destination.data(), dg.ip_header + IPv4_DEST_ADDR_OFFSET, 4);
+    }
+}
+
+bool ts::PcapTSExtractor::FlowId::operator<(const FlowId& other) const
+{
+    if (ip_version != other.ip_version) {
+        return ip_version < other.ip_version;
+    }
+    else if (destination != other.destination) {
+        return destination < other.destination;
+    }
+    else if (destination_port != other.destination_port) {
+        return destination_port < other.destination_port;
+    }
+    else if (source != other.source) {
+        return source < other.source;
+    }
+    else {
+        return source_port < other.source_port;
+    }
+}
+
+size_t ts::PcapTSExtractor::FlowId::hash() const
+{
+    // FNV-1a hash on all fields.
+    uint32_t h = 0x811C9DC5;
+    const auto add = [&h](uint8_t b) { h = (h ^ b) * 0x01000193; };
+    for (size_t i = 0; i < IPv6_ADDR_SIZE; ++i) {
+        add(source[i]);
+        add(destination[i]);
+    }
+    add(uint8_t(source_port >> 8));
+    add(uint8_t(source_port));
+    add(uint8_t(destination_port >> 8));
+    add(uint8_t(destination_port));
+    return h;
+}
+
+ts::UString ts::PcapTSExtractor::FlowId::socketName(const std::array<uint8_t, IPv6_ADDR_SIZE>& addr, uint16_t port) const
+{
+    if (ip_version == IPv6_VERSION) {
+        return IPv6SocketAddress(addr.data(), addr.size(), port).toString();
+    }
+    else {
+        return IPv4SocketAddress(GetUInt32BE(addr.data()), port).toString();
+    }
+}
+
+ts::UString ts::PcapTSExtractor::FlowId::sourceName() const
+{
+    return socketName(source, source_port);
+}
+
+ts::UString ts::PcapTSExtractor::FlowId::destinationName() const
+{
+    return socketName(destination, destination_port);
+}
+
+ts::UString ts::PcapTSExtractor::FlowId::fileName() const
+{
+    // Keep only characters which are valid in file names on all systems.
+    UString name(sourceName() + u"-" + destinationName());
+    for (auto& c : name) {
+        if (!IsAlpha(c) && !IsDigit(c) && c != u'.' && c != u'-') {
+            c = u'_';
+        }
+    }
+    return name;
+}
+
+
+//----------------------------------------------------------------------------
+// Flow statistics.
+//----------------------------------------------------------------------------
+
+ts::BitRate ts::PcapTSExtractor::FlowStatistics::bitrate() const
+{
+    const MicroSecond duration = last_timestamp - first_timestamp;
+    return first_timestamp < 0 || duration <= 0 ? 0 : BitRate(packets * PKT_SIZE_BITS * MicroSecPerSec) / duration;
+}
+
+
+//----------------------------------------------------------------------------
+// Destructor.
+//----------------------------------------------------------------------------
+
+ts::PcapTSExtractor::~PcapTSExtractor()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Report an error from any thread.
+//----------------------------------------------------------------------------
+
+void ts::PcapTSExtractor::error(const UString& msg)
+{
+    GuardMutex lock(_report_mutex);
+    _success = false;
+    if (_report != nullptr) {
+        _report->error(msg);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Read all UDP datagrams from a pcap file and extract all transport streams.
+//----------------------------------------------------------------------------
+
+bool ts::PcapTSExtractor::extract(PcapFilter& file, Report& report)
+{
+    _report = &report;
+    _success = true;
+    _stats.clear();
+
+    if (!_output_dir.empty() && !IsDirectory(_output_dir) && !CreateDirectory(_output_dir, true, report)) {
+        _report = nullptr;
+        return false;
+    }
+
+    // Without memory mapping, the data of a datagram are overwritten by the next read.
+    // Therefore, the datagrams are processed one by one, in the current thread.
+    const size_t cores = std::max<size_t>(1, std::thread::hardware_concurrency());
+    const size_t count = file.isMapped() ? (_thread_count == 0 ? cores : _thread_count) : 1;
+    report.verbose(u"extracting transport streams in %d thread%s", {count, count > 1 ? u"s" : u""});
+
+    std::vector<WorkerPtr> workers;
+    for (size_t i = 0; i < count; ++i) {
+        workers.push_back(new Worker(this));
+        if (count > 1) {
+            workers.back()->start();
+        }
+    }
+
+    // Read the file, shard the datagrams by flow.
+    std::vector<PcapFilter::UDPDatagram> datagrams(MAX_DATAGRAMS);
+    std::vector<Batch*> batches(count, nullptr);
+    size_t dg_count = 0;
+    while ((dg_count = file.readUDP(datagrams.data(), datagrams.size(), report)) > 0) {
+        if (count == 1) {
+            for (size_t i = 0; i < dg_count; ++i) {
+                workers[0]->process(datagrams[i]);
+            }
+        }
+        else {
+            for (size_t i = 0; i < dg_count; ++i) {
+                const size_t index = FlowId(datagrams[i]).hash() % count;
+                if (batches[index] == nullptr) {
+                    batches[index] = new Batch;
+                    batches[index]->reserve(dg_count);
+                }
+                batches[index]->push_back(datagrams[i]);
+            }
+            for (size_t i = 0; i < count; ++i) {
+                if (batches[i] != nullptr) {
+                    workers[i]->queue.enqueue(batches[i]);
+                    batches[i] = nullptr;
+                }
+            }
+        }
+    }
+
+    // Terminate the workers: an empty message means end of processing.
+    if (count > 1) {
+        for (const auto& w : workers) {
+            w->queue.forceEnqueue(static_cast<Batch*>(nullptr));
+        }
+        for (const auto& w : workers) {
+            w->waitForTermination();
+        }
+    }
+
+    // Collect the statistics of all flows. Each flow is in exactly one worker.
+    std::map<FlowId, FlowStatistics> all;
+    for (const auto& w : workers) {
+        for (auto& it : w->flows) {
+            if (it.second.file.is_open()) {
+                it.second.file.close();
+            }
+            all[it.first] = it.second.stats;
+        }
+    }
+    for (const auto& it : all) {
+        _stats.push_back(it.second);
+    }
+
+    _report = nullptr;
+    return _success;
+}
+
+
+//----------------------------------------------------------------------------
+// Worker thread: process batches until an empty one is received.
+//----------------------------------------------------------------------------
+
+void ts::PcapTSExtractor::Worker::main()
+{
+    for (;;) {
+        BatchQueue::MessagePtr batch;
+        queue.dequeue(batch);
+        if (batch.isNull()) {
+            break;
+        }
+        for (const auto& dg : *batch) {
+            process(dg);
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Worker: process one datagram.
+//----------------------------------------------------------------------------
+
+void ts::PcapTSExtractor::Worker::process(const PcapFilter::UDPDatagram& dg)
+{
+    // Locate the TS packets in the datagram. Ignore datagrams without TS packets.
+    size_t start = 0;
+    size_t count = 0;
+    if (!TSPacket::Locate(dg.data, dg.size, start, count)) {
+        return;
+    }
+
+    // Check the presence of an RTP header: version 2 and payload type is MPEG-2 TS.
+    const bool rtp = start >= RTP_HEADER_SIZE && (dg.data[0] >> 6) == 2 && (dg.data[1] & 0x7F) == RTP_PT_MP2T;
+
+    // Get or create the flow.
+    const FlowId id(dg);
+    Flow& flow(flows[id]);
+    FlowStatistics& stats(flow.stats);
+    const bool first = stats.datagrams == 0;
+    if (first) {
+        stats.id = id;
+        stats.rtp = rtp;
+        if (!_extractor->_output_dir.empty()) {
+            stats.file_name = _extractor->_output_dir + PathSeparator + id.fileName() + u".ts";
+            flow.file.open(stats.file_name.toUTF8().c_str(), std::ios::out | std::ios::binary);
+            if (!flow.file) {
+                _extractor->error(UString::Format(u"error creating %s", {stats.file_name}));
+            }
+        }
+    }
+
+    // Timing statistics.
+    if (dg.timestamp >= 0) {
+        if (stats.first_timestamp < 0) {
+            stats.first_timestamp = dg.timestamp;
+        }
+        else {
+            stats.max_interval = std::max(stats.max_interval, dg.timestamp - stats.last_timestamp);
+        }
+    }
+
+    // RTP statistics.
+    if (rtp) {
+        const uint16_t sequence = GetUInt16BE(dg.data + 2);
+        const uint32_t rtp_time = GetUInt32BE(dg.data + 4);
+        const int16_t delta = int16_t(uint16_t(sequence - flow.last_sequence));
+        flow.rtp_received++;
+        // Only the datagrams which move the sequence forward are the new reference.
+        // Reordered and duplicated datagrams are counted as received only.
+        if (first || delta > 0) {
+            // Inter-arrival jitter (RFC 3550, section 6.4.1), difference of relative transit times.
+            if (!first && dg.timestamp >= 0 && flow.last_rtp_arrival >= 0) {
+                const MicroSecond rtp_delta = (MicroSecond(int32_t(rtp_time - flow.last_rtp_time)) * MicroSecPerSec) / MicroSecond(RTP_RATE_MP2T);
+                const MicroSecond d = std::abs((dg.timestamp - flow.last_rtp_arrival) - rtp_delta);
+                // J += (|D| - J) / 16, computed on J * 16 to keep the fractional part (RFC 3550, appendix A.8).
+                flow.rtp_jitter16 += d - ((flow.rtp_jitter16 + 8) >> 4);
+                stats.jitter = (flow.rtp_jitter16 + 8) >> 4;
+            }
+            flow.rtp_expected += first ? 1 : uint64_t(delta);
+            flow.last_sequence = sequence;
+            flow.last_rtp_time = rtp_time;
+            flow.last_rtp_arrival = dg.timestamp;
+        }
+        // Lost datagrams (RFC 3550, appendix A.3): a reordered datagram is no longer lost when it arrives.
+        stats.rtp_lost = flow.rtp_expected > flow.rtp_received ? flow.rtp_expected - flow.rtp_received : 0;
+    }
+
+    if (dg.timestamp >= 0) {
+        stats.last_timestamp = dg.timestamp;
+    }
+    stats.datagrams++;
+    stats.packets += count;
+
+    // Save the TS packets.
+    if (flow.file.is_open()) {
+        flow.file.write(reinterpret_cast<const char*>(dg.data + start), std::streamsize(count * PKT_SIZE));
+        if (!flow.file) {
+            _extractor->error(UString::Format(u"error writing %s", {stats.file_name}));
+            flow.file.close();
+        }
+    }
+}
@@ -0,0 +1,207 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Extract all UDP/RTP transport streams from a pcap file in one pass.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsPcapFilter.h"
+#include "tsBitRate.h"
+#include "tsThread.h"
+#include "tsMutex.h"
+#include "tsMessageQueue.h"
+
+namespace ts {
+    //!
+    //! Extract all UDP/RTP transport streams from a pcap or pcap-ng file in one pass.
+    //! @ingroup net
+    //!
+    //! The capture file is read once. The UDP datagrams are grouped by flow (source and
+    //! destination addresses and ports). The flows which contain TS packets are analyzed
+    //! and their TS packets are optionally saved, each flow in its own TS file.
+    //!
+    //! When the capture file is memory-mapped, the flows are sharded by flow identification
+    //! over several worker threads. The datagrams are passed to the workers without copy.
+    //!
+    class TSDUCKDLL PcapTSExtractor
+    {
+        TS_NOCOPY(PcapTSExtractor);
+    public:
+        //!
+        //! Identification of a UDP flow.
+        //!
+        class TSDUCKDLL FlowId
+        {
+        public:
+            uint8_t  ip_version = 0;                            //!< IP version, 4 or 6.
+            std::array<uint8_t, IPv6_ADDR_SIZE> source {};      //!< Source IP address, only 4 first bytes with IPv4.
+            std::array<uint8_t, IPv6_ADDR_SIZE> destination {}; //!< Destination IP address, only 4 first bytes with IPv4.
+            uint16_t source_port = 0;                           //!< Source UDP port.
+            uint16_t destination_port = 0;                      //!< Destination UDP port.
+
+            //!
+            //! Default constructor.
+            //!
+            FlowId() = default;
+
+            //!
+            //! Constructor from a UDP datagram.
+            //! @param [in] dg A UDP datagram.
+            //!
+            FlowId(const PcapFilter::UDPDatagram& dg);
+
+            //!
+            //! Comparison operator, for use in containers.
+            //! @param [in] other Other instance to compare.
+            //! @return True if this instance is logically less than @a other.
+            //!
+            bool operator<(const FlowId& other) const;
+
+            //!
+            //! Compute a hash value of the flow identification, to distribute flows.
+            //! @return The hash value.
+            //!
+            size_t hash() const;
+
+            //!
+            //! Get the source socket address as a string.
+            //! @return The source socket address.
+            //!
+            UString sourceName() const;
+
+            //!
+            //! Get the destination socket address as a string.
+            //! @return The destination socket address.
+            //!
+            UString destinationName() const;
+
+            //!
+            //! Build a file name for the flow, without directory and extension.
+            //! @return The file name, built from source and destination.
+            //!
+            UString fileName() const;
+
+        private:
+            UString socketName(const std::array<uint8_t, IPv6_ADDR_SIZE>& addr, uint16_t port) const;
+        };
+
+        //!
+        //! Statistics of one flow containing TS packets.
+        //!
+        class TSDUCKDLL FlowStatistics
+        {
+        public:
+            FlowId      id {};                //!< Flow identification.
+            bool        rtp = false;          //!< The TS packets are encapsulated in RTP.
+            uint64_t    datagrams = 0;        //!< Number of datagrams containing TS packets.
+            uint64_t    packets = 0;          //!< Number of TS packets.
+            MicroSecond first_timestamp = -1; //!< Capture timestamp of the first datagram, negative if unknown.
+            MicroSecond last_timestamp = -1;  //!< Capture timestamp of the last datagram, negative if unknown.
+            MicroSecond max_interval = 0;     //!< Maximum interval between two datagrams.
+            MicroSecond jitter = 0;           //!< RTP inter-arrival jitter as defined in RFC 3550, in microseconds.
+            uint64_t    rtp_lost = 0;         //!< Number of lost RTP datagrams (expected minus received, reordered datagrams are not lost).
+            UString     file_name {};         //!< Name of the output TS file, if any.
+
+            //!
+            //! Compute the average TS bitrate of the flow.
+            //! @return The TS bitrate or zero if unknown.
+            //!
+            BitRate bitrate() const;
+        };
+
+        //!
+        //! A list of flow statistics.
+        //!
+        typedef std::vector<FlowStatistics> FlowStatisticsVector;
+
+        //!
+        //! Default constructor.
+        //!
+        PcapTSExtractor() = default;
+
+        //!
+        //! Destructor.
+        //!
+        ~PcapTSExtractor();
+
+        //!
+        //! Set the directory of output TS files.
+        //! @param [in] directory Output directory. If empty (the default), no TS file is written.
+        //!
+        void setOutputDirectory(const UString& directory) { _output_dir = directory; }
+
+        //!
+        //! Set the maximum number of worker threads.
+        //! @param [in] count Number of worker threads. Zero (the default) means the number of CPU cores.
+        //!
+        void setThreadCount(size_t count) { _thread_count = count; }
+
+        //!
+        //! Read all UDP datagrams from a pcap file and extract all transport streams.
+        //! @param [in,out] file An open pcap file. The filters are already set. The file is read up to the end.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool extract(PcapFilter& file, Report& report);
+
+        //!
+        //! Get the statistics of all flows containing TS packets after extract().
+        //! @return A constant reference to the statistics, sorted by flow identification.
+        //!
+        const FlowStatisticsVector& statistics() const { return _stats; }
+
+    private:
+        // Maximum number of datagrams which are read at a time.
+        static constexpr size_t MAX_DATAGRAMS = 256;
+
+        // A batch of datagrams to process by a worker.
+        typedef std::vector<PcapFilter::UDPDatagram> Batch;
+        typedef MessageQueue<Batch, Mutex> BatchQueue;
+
+        // State of a flow in a worker.
+        class Flow
+        {
+        public:
+            FlowStatistics stats {};
+            std::ofstream  file {};
+            uint64_t       rtp_expected = 0;       // RTP: number of sequence numbers from the first to the highest one.
+            uint64_t       rtp_received = 0;       // RTP: number of received datagrams.
+            MicroSecond    last_rtp_arrival = -1;  // RTP: capture timestamp of the highest sequence number.
+            uint32_t       last_rtp_time = 0;      // RTP: RTP timestamp of the highest sequence number.
+            MicroSecond    rtp_jitter16 = 0;       // RTP: inter-arrival jitter, scaled by 16 (RFC 3550, appendix A.8).
+            uint16_t       last_sequence = 0;      // RTP: highest sequence number.
+        };
+
+        // Processing thread, owns a subset of the flows.
+        class Worker : public Thread
+        {
+            TS_NOBUILD_NOCOPY(Worker);
+        public:
+            Worker(PcapTSExtractor* extractor) : _extractor(extractor) {}
+            BatchQueue queue {16};
+            std::map<FlowId, Flow> flows {};
+            void process(const PcapFilter::UDPDatagram& dg);
+        private:
+            PcapTSExtractor* _extractor;
+            virtual void main() override;
+        };
+        typedef SafePtr<Worker, NullMutex> WorkerPtr;
+
+        UString              _output_dir {};
+        size_t               _thread_count = 0;
+        Report*              _report = nullptr;  // Application report during extract().
+        Mutex                _report_mutex {};   // Protection of _report and _success.
+        bool                 _success = true;    // No error during extract().
+        FlowStatisticsVector _stats {};
+
+        // Report an error from any thread.
+        void error(const UString& msg);
+    };
+}
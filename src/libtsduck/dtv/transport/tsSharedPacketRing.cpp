@@ -0,0 +1,624 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+
+#include "tsSharedPacketRing.h"
+
+#if defined(TS_UNIX)
+    #include "tsBeforeStandardHeaders.h"
+    #include <sys/types.h>
+    #include <sys/stat.h>
+    #include <sys/file.h>
+    #include <signal.h>
+    #include "tsAfterStandardHeaders.h"
+#endif
+
+// Identification of the shared segment layout.
+#define RING_MAGIC    0x54535348  // "TSSH"
+#define RING_VERSION  1
+
+// Size of a metadata slot (serialized TSPacketMetadata, rounded).
+#define METADATA_SLOT 16
+static_assert(METADATA_SLOT >= ts::TSPacketMetadata::SERIALIZATION_SIZE, "metadata slot too small for serialized TSPacketMetadata");
+
+// Polling interval when waiting for the other side, in milliseconds.
+#define POLL_INTERVAL 1
+
+// Interval between checks of the liveness of the other processes, in milliseconds.
+#define CHECK_INTERVAL 100
+
+// Maximum time for a writer to initialize a new segment, in milliseconds.
+// A segment which remains uninitialized longer was left by a crashed writer.
+#define INIT_TIMEOUT 1000
+
+// Maximum number of attempts to create a segment while other writers reclaim it.
+#define CREATE_ATTEMPTS 3
+
+// Read index of a reader cursor which is not yet or no longer active.
+#define INACTIVE_READER std::numeric_limits<uint64_t>::max()
+
+// All atomic variables in the shared segment must be address-free.
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "64-bit atomics must be lock-free");
+
+// Header of the shared segment. Read cursors, packets and metadata follow.
+struct ts::SharedPacketRing::Header
+{
+    std::atomic<uint32_t> magic;          // RING_MAGIC when the segment is initialized.
+    uint32_t              version;        // RING_VERSION.
+    uint32_t              packet_count;   // Capacity of the ring in packets.
+    uint32_t              max_readers;    // Number of reader cursors.
+    uint32_t              policy;         // LagPolicy value.
+    std::atomic<uint32_t> writer_pid;     // Process id of the writer.
+    std::atomic<uint32_t> closed;         // Set by the writer when the ring is properly closed.
+    alignas(64)
+    std::atomic<uint64_t> write_index;    // Number of packets which were completely written.
+    std::atomic<uint64_t> reserve_index;  // Number of packets which are being written (drop policy).
+};
+
+// Read cursor of one reader, on its own cache line.
+struct alignas(64) ts::SharedPacketRing::Reader
+{
+    std::atomic<uint32_t> pid;            // Process id of the reader, zero if free.
+    std::atomic<uint64_t> read_index;     // Number of packets which were read, INACTIVE_READER if not active.
+};
+
+
+//----------------------------------------------------------------------------
+// Layout of the shared segment.
+//----------------------------------------------------------------------------
+
+size_t ts::SharedPacketRing::SegmentSize(size_t packet_count, size_t max_readers)
+{
+    return sizeof(Header) + max_readers * sizeof(Reader) + packet_count * (PKT_SIZE + METADATA_SLOT);
+}
+
+ts::SharedPacketRing::Reader* ts::SharedPacketRing::readers() const
+{
+    return reinterpret_cast<Reader*>(reinterpret_cast<uint8_t*>(_header) + sizeof(Header));
+}
+
+ts::TSPacket* ts::SharedPacketRing::packets() const
+{
+    return reinterpret_cast<TSPacket*>(reinterpret_cast<uint8_t*>(readers()) + _header->max_readers * sizeof(Reader));
+}
+
+uint8_t* ts::SharedPacketRing::metadata() const
+{
+    return reinterpret_cast<uint8_t*>(packets() + _header->packet_count);
+}
+
+ts::UString ts::SharedPacketRing::SegmentName(const UString& name)
+{
+    return u"/tsduck-" + name;
+}
+
+
+//----------------------------------------------------------------------------
+// Destructor.
+//----------------------------------------------------------------------------
+
+ts::SharedPacketRing::~SharedPacketRing()
+{
+    close();
+}
+
+
+#if !defined(TS_UNIX)
+
+//----------------------------------------------------------------------------
+// Stubs for unsupported platforms.
+//----------------------------------------------------------------------------
+
+bool ts::SharedPacketRing::create(const UString&, size_t, size_t, LagPolicy, Report& report, uint32_t)
+{
+    report.error(u"shared memory rings are not supported on this platform");
+    return false;
+}
+
+bool ts::SharedPacketRing::open(const UString&, MilliSecond, Report& report, const AbortInterface*)
+{
+    report.error(u"shared memory rings are not supported on this platform");
+    return false;
+}
+
+void ts::SharedPacketRing::close()
+{
+}
+
+bool ts::SharedPacketRing::write(const TSPacket*, const TSPacketMetadata*, size_t, Report& report, const AbortInterface*)
+{
+    report.error(u"shared memory ring not open for writing");
+    return false;
+}
+
+size_t ts::SharedPacketRing::read(TSPacket*, TSPacketMetadata*, size_t, Report& report, const AbortInterface*)
+{
+    report.error(u"shared memory ring not open for reading");
+    return 0;
+}
+
+#else
+
+//----------------------------------------------------------------------------
+// Check if a process is still alive.
+//----------------------------------------------------------------------------
+
+bool ts::SharedPacketRing::ProcessAlive(uint32_t pid)
+{
+    return pid != 0 && (::kill(::pid_t(pid), 0) == 0 || errno == EPERM);
+}
+
+
+//----------------------------------------------------------------------------
+// Map a segment from a file descriptor. Close the descriptor.
+//----------------------------------------------------------------------------
+
+bool ts::SharedPacketRing::map(int fd, size_t size, Report& report)
+{
+    void* addr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    const int err = errno;
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        report.error(u"error mapping shared memory %s: %s", {_segment_name, SysErrorCodeMessage(err)});
+        return false;
+    }
+    _header = reinterpret_cast<Header*>(addr);
+    _segment_size = size;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Remove the name of a segment if it still designates a given segment.
+//----------------------------------------------------------------------------
+
+void ts::SharedPacketRing::UnlinkSegment(const std::string& name8, uint64_t dev, uint64_t inode)
+{
+    const int fd = ::shm_open(name8.c_str(), O_RDONLY, 0);
+    if (fd >= 0) {
+        // The lock on the segment serializes the removals between processes, when the system
+        // supports locks on shared memory. The name is checked again after locking: another
+        // process may have removed and recreated the segment in the meantime.
+        ::flock(fd, LOCK_EX);
+        const int fd2 = ::shm_open(name8.c_str(), O_RDONLY, 0);
+        if (fd2 >= 0) {
+            struct ::stat st, st2;
+            if (::fstat(fd, &st) == 0 && ::fstat(fd2, &st2) == 0 &&
+                uint64_t(st.st_dev) == dev && uint64_t(st.st_ino) == inode &&
+                st2.st_dev == st.st_dev && st2.st_ino == st.st_ino)
+            {
+                ::shm_unlink(name8.c_str());
+            }
+            ::close(fd2);
+        }
+        ::close(fd); // also releases the lock
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Writer: remove an existing segment with the same name if its writer is gone.
+//----------------------------------------------------------------------------
+
+bool ts::SharedPacketRing::reclaim(const UString& name, Report& report)
+{
+    const std::string name8(_segment_name.toUTF8());
+    const int fd = ::shm_open(name8.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        // Already removed by its writer or by another writer: create it again.
+        if (errno == ENOENT) {
+            return true;
+        }
+        report.error(u"error opening shared memory %s: %s", {_segment_name, SysErrorCodeMessage()});
+        return false;
+    }
+
+    // A new segment has no magic number until its writer has initialized it. Wait for
+    // the initialization before checking the writer. A segment which remains uninitialized
+    // after the timeout was left by a writer which crashed during the initialization.
+    const Time deadline(Time::CurrentUTC() + INIT_TIMEOUT);
+    struct ::stat st;
+    bool initialized = false;
+    bool closed = false;
+    uint32_t pid = 0;
+    for (;;) {
+        if (::fstat(fd, &st) != 0) {
+            report.error(u"error checking shared memory %s: %s", {_segment_name, SysErrorCodeMessage()});
+            ::close(fd);
+            return false;
+        }
+        if (size_t(st.st_size) >= sizeof(Header)) {
+            void* addr = ::mmap(nullptr, sizeof(Header), PROT_READ, MAP_SHARED, fd, 0);
+            if (addr != MAP_FAILED) {
+                const Header* hdr = reinterpret_cast<const Header*>(addr);
+                initialized = hdr->magic.load(std::memory_order_acquire) == RING_MAGIC;
+                closed = hdr->closed.load() != 0;
+                pid = hdr->writer_pid.load();
+                ::munmap(addr, sizeof(Header));
+            }
+        }
+        if (initialized || Time::CurrentUTC() >= deadline) {
+            break;
+        }
+        SleepThread(10 * POLL_INTERVAL);
+    }
+    ::close(fd);
+
+    if (initialized && !closed && ProcessAlive(pid)) {
+        report.error(u"shared memory ring %s is already used by process %d", {name, pid});
+        return false;
+    }
+    if (initialized) {
+        report.verbose(u"reclaiming shared memory ring %s from a terminated writer", {name});
+    }
+    else {
+        report.verbose(u"reclaiming shared memory ring %s, not initialized by its writer", {name});
+    }
+    UnlinkSegment(name8, uint64_t(st.st_dev), uint64_t(st.st_ino));
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Create the ring, as the writer.
+//----------------------------------------------------------------------------
+
+bool ts::SharedPacketRing::create(const UString& name, size_t packet_count, size_t max_readers, LagPolicy policy, Report& report, uint32_t access_mode)
+{
+    close();
+
+    if (name.empty() || name.contain(u'/')) {
+        report.error(u"invalid shared memory ring name \"%s\"", {name});
+        return false;
+    }
+    packet_count = std::max<size_t>(1, packet_count);
+    max_readers = std::max<size_t>(1, max_readers);
+    _segment_name = SegmentName(name);
+    const std::string name8(_segment_name.toUTF8());
+
+    const ::mode_t mode = ::mode_t(access_mode & 0777);
+    int fd = ::shm_open(name8.c_str(), O_RDWR | O_CREAT | O_EXCL, mode);
+    for (size_t attempt = 1; fd < 0 && errno == EEXIST && attempt < CREATE_ATTEMPTS; ++attempt) {
+        // The segment already exists. Reclaim it if its writer has terminated.
+        if (!reclaim(name, report)) {
+            return false;
+        }
+        fd = ::shm_open(name8.c_str(), O_RDWR | O_CREAT | O_EXCL, mode);
+    }
+    if (fd < 0) {
+        report.error(u"error creating shared memory %s: %s", {_segment_name, SysErrorCodeMessage()});
+        return false;
+    }
+
+    // Apply the exact access mode, without the umask of the process.
+    if (::fchmod(fd, mode) < 0) {
+        report.error(u"error setting permissions of shared memory %s: %s", {_segment_name, SysErrorCodeMessage()});
+        ::close(fd);
+        ::shm_unlink(name8.c_str());
+        return false;
+    }
+
+    // Size the segment. The new content is zeroed.
+    const size_t size = SegmentSize(packet_count, max_readers);
+    if (::ftruncate(fd, ::off_t(size)) < 0) {
+        report.error(u"error sizing shared memory %s: %s", {_segment_name, SysErrorCodeMessage()});
+        ::close(fd);
+        ::shm_unlink(name8.c_str());
+        return false;
+    }
+    if (!map(fd, size, report)) {
+        ::shm_unlink(name8.c_str());
+        return false;
+    }
+
+    // Initialize the segment. The magic number is set last, when everything is ready.
+    _writer = true;
+    _header->version = RING_VERSION;
+    _header->packet_count = uint32_t(packet_count);
+    _header->max_readers = uint32_t(max_readers);
+    _header->policy = uint32_t(policy);
+    _header->writer_pid = uint32_t(CurrentProcessId());
+    _header->closed = 0;
+    _header->write_index = 0;
+    _header->reserve_index = 0;
+    for (size_t i = 0; i < max_readers; ++i) {
+        readers()[i].read_index = INACTIVE_READER;
+        readers()[i].pid = 0;
+    }
+    _header->magic.store(RING_MAGIC, std::memory_order_release);
+    report.debug(u"created shared memory ring %s, %d packets, %d readers", {name, packet_count, max_readers});
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Open an existing ring, as a reader.
+//----------------------------------------------------------------------------
+
+bool ts::SharedPacketRing::open(const UString& name, MilliSecond timeout, Report& report, const AbortInterface* abort)
+{
+    close();
+    _segment_name = SegmentName(name);
+    const std::string name8(_segment_name.toUTF8());
+    const Time deadline(timeout == Infinite ? Time::Apocalypse : Time::CurrentUTC() + timeout);
+
+    // Wait until the segment is created and initialized by the writer.
+    for (;;) {
+        const int fd = ::shm_open(name8.c_str(), O_RDWR, 0);
+        if (fd >= 0) {
+            struct ::stat st;
+            if (::fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(Header)) {
+                _dev = uint64_t(st.st_dev);
+                _inode = uint64_t(st.st_ino);
+                if (!map(fd, size_t(st.st_size), report)) {
+                    return false;
+                }
+                if (_header->magic.load(std::memory_order_acquire) == RING_MAGIC) {
+                    break;
+                }
+                // Not yet initialized.
+                ::munmap(_header, _segment_size);
+                _header = nullptr;
+            }
+            else {
+                ::close(fd);
+            }
+        }
+        if ((abort != nullptr && abort->aborting()) || Time::CurrentUTC() >= deadline) {
+            report.error(u"shared memory ring %s not found", {name});
+            return false;
+        }
+        SleepThread(10 * POLL_INTERVAL);
+    }
+
+    // Check the layout of the segment.
+    if (_header->version != RING_VERSION || SegmentSize(_header->packet_count, _header->max_readers) > _segment_size) {
+        report.error(u"incompatible shared memory ring %s", {name});
+        ::munmap(_header, _segment_size);
+        _header = nullptr;
+        return false;
+    }
+
+    // Allocate a read cursor: a free one or one from a terminated reader.
+    const uint32_t pid = uint32_t(CurrentProcessId());
+    for (size_t pass = 0; pass < 2; ++pass) {
+        for (size_t i = 0; i < _header->max_readers; ++i) {
+            Reader& rd(readers()[i]);
+            uint32_t expected = rd.pid.load();
+            if ((expected == 0 || (pass == 1 && !ProcessAlive(expected))) && rd.pid.compare_exchange_strong(expected, pid)) {
+                // Start reading at the current write position (live stream).
+                _reader_index = i;
+                _lost = 0;
+                rd.read_index.store(_header->write_index.load(std::memory_order_acquire), std::memory_order_release);
+                report.debug(u"opened shared memory ring %s, reader %d", {name, i});
+                return true;
+            }
+        }
+    }
+
+    report.error(u"too many readers on shared memory ring %s (max: %d)", {name, _header->max_readers});
+    ::munmap(_header, _segment_size);
+    _header = nullptr;
+    return false;
+}
+
+
+//----------------------------------------------------------------------------
+// Close the ring.
+//----------------------------------------------------------------------------
+
+void ts::SharedPacketRing::close()
+{
+    if (_header != nullptr) {
+        if (_writer) {
+            // Readers get an end of stream after the remaining packets. Remove the name
+            // immediately, the memory is released when the last reader unmaps it.
+            _header->closed.store(1, std::memory_order_release);
+            ::shm_unlink(_segment_name.toUTF8().c_str());
+        }
+        else {
+            Reader& rd(readers()[_reader_index]);
+            rd.read_index = INACTIVE_READER;
+            rd.pid = 0;
+        }
+        ::munmap(_header, _segment_size);
+        _header = nullptr;
+        _segment_size = 0;
+        _writer = false;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Writer: get the position of the slowest active reader.
+//----------------------------------------------------------------------------
+
+uint64_t ts::SharedPacketRing::slowestReader()
+{
+    // Check the liveness of the readers from time to time only.
+    const Time now(Time::CurrentUTC());
+    const bool check = now - _last_check >= CHECK_INTERVAL;
+    if (check) {
+        _last_check = now;
+    }
+
+    uint64_t slowest = _header->write_index.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < _header->max_readers; ++i) {
+        Reader& rd(readers()[i]);
+        uint32_t pid = rd.pid.load();
+        if (pid != 0) {
+            if (check && !ProcessAlive(pid)) {
+                // A reader crashed, release its cursor.
+                rd.read_index = INACTIVE_READER;
+                rd.pid.compare_exchange_strong(pid, 0);
+            }
+            else {
+                slowest = std::min(slowest, rd.read_index.load(std::memory_order_acquire));
+            }
+        }
+    }
+    return slowest;
+}
+
+
+//----------------------------------------------------------------------------
+// Writer: write packets in the ring.
+//----------------------------------------------------------------------------
+
+bool ts::SharedPacketRing::write(const TSPacket* pkts, const TSPacketMetadata* mdata, size_t count, Report& report, const AbortInterface* abort)
+{
+    if (_header == nullptr || !_writer) {
+        report.error(u"shared memory ring not open for writing");
+        return false;
+    }
+
+    const uint64_t capacity = _header->packet_count;
+    const bool block = _header->policy == uint32_t(LagPolicy::BLOCK);
+    TSPacket* ring_packets = packets();
+    uint8_t* ring_metadata = metadata();
+    const TSPacketMetadata default_mdata;
+
+    while (count > 0) {
+        const uint64_t wr = _header->write_index.load(std::memory_order_relaxed);
+        size_t n = count;
+        if (block) {
+            // Wait for the slowest reader.
+            const uint64_t free = capacity - std::min(capacity, wr - std::min(wr, slowestReader()));
+            if (free == 0) {
+                if (abort != nullptr && abort->aborting()) {
+                    return false;
+                }
+                SleepThread(POLL_INTERVAL);
+                continue;
+            }
+            n = size_t(std::min<uint64_t>(n, free));
+        }
+        const size_t index = size_t(wr % capacity);
+        n = std::min(n, size_t(capacity) - index);
+
+        // Publish the area which is being overwritten before modifying it (see read()).
+        _header->reserve_index.store(wr + n, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        TSPacket::Copy(ring_packets + index, pkts, n);
+        for (size_t i = 0; i < n; ++i) {
+            (mdata == nullptr ? default_mdata : mdata[i]).serialize(ring_metadata + (index + i) * METADATA_SLOT, METADATA_SLOT);
+        }
+        _header->write_index.store(wr + n, std::memory_order_release);
+
+        pkts += n;
+        if (mdata != nullptr) {
+            mdata += n;
+        }
+        count -= n;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Reader: check if the writer is gone (terminated or crashed).
+//----------------------------------------------------------------------------
+
+bool ts::SharedPacketRing::writerGone()
+{
+    if (_header->closed.load(std::memory_order_acquire) != 0) {
+        return true;
+    }
+
+    // Check the liveness of the writer from time to time only.
+    const Time now(Time::CurrentUTC());
+    if (now - _last_check < CHECK_INTERVAL) {
+        return false;
+    }
+    _last_check = now;
+    if (ProcessAlive(_header->writer_pid.load())) {
+        return false;
+    }
+
+    // The writer crashed. Remove the name of the segment if it is still ours
+    // (a new writer may have already reclaimed it).
+    UnlinkSegment(_segment_name.toUTF8(), _dev, _inode);
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Reader: read packets from the ring.
+//----------------------------------------------------------------------------
+
+size_t ts::SharedPacketRing::read(TSPacket* pkts, TSPacketMetadata* mdata, size_t max_count, Report& report, const AbortInterface* abort)
+{
+    if (_header == nullptr || _writer) {
+        report.error(u"shared memory ring not open for reading");
+        return 0;
+    }
+
+    const uint64_t capacity = _header->packet_count;
+    const TSPacket* ring_packets = packets();
+    const uint8_t* ring_metadata = metadata();
+    Reader& rd(readers()[_reader_index]);
+
+    while (max_count > 0) {
+        uint64_t rx = rd.read_index.load(std::memory_order_relaxed);
+        const uint64_t wr = _header->write_index.load(std::memory_order_acquire);
+
+        if (wr == rx) {
+            // Nothing to read, check end of stream, then wait.
+            if (writerGone() && _header->write_index.load(std::memory_order_acquire) == rx) {
+                return 0;
+            }
+            if (abort != nullptr && abort->aborting()) {
+                return 0;
+            }
+            SleepThread(POLL_INTERVAL);
+            continue;
+        }
+
+        // Skip packets which were already overwritten by the writer.
+        if (wr - rx > capacity) {
+            const uint64_t lost = wr - rx - capacity;
+            report.warning(u"shared memory ring: reader too slow, lost %'d packets", {lost});
+            _lost += lost;
+            rx += lost;
+        }
+
+        // Copy a contiguous area.
+        const size_t index = size_t(rx % capacity);
+        size_t n = size_t(std::min<uint64_t>({max_count, wr - rx, capacity - index}));
+        TSPacket::Copy(pkts, ring_packets + index, n);
+        if (mdata != nullptr) {
+            for (size_t i = 0; i < n; ++i) {
+                mdata[i].deserialize(ring_metadata + (index + i) * METADATA_SLOT, TSPacketMetadata::SERIALIZATION_SIZE);
+            }
+        }
+
+        // Check if the writer has overwritten some packets during the copy (drop policy only).
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t valid = _header->reserve_index.load(std::memory_order_relaxed);
+        if (valid > capacity && valid - capacity > rx) {
+            const size_t overwritten = size_t(std::min<uint64_t>(n, valid - capacity - rx));
+            _lost += overwritten;
+            if (overwritten == n) {
+                rd.read_index.store(rx + n, std::memory_order_release);
+                continue;
+            }
+            n -= overwritten;
+            std::memmove(pkts, pkts + overwritten, n * PKT_SIZE);
+            if (mdata != nullptr) {
+                std::copy(mdata + overwritten, mdata + overwritten + n, mdata);
+            }
+            rx += overwritten;
+        }
+
+        rd.read_index.store(rx + n, std::memory_order_release);
+        return n;
+    }
+    return 0;
+}
+
+#endif // TS_UNIX
@@ -0,0 +1,204 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Ring buffer of TS packets in shared memory, one writer, several readers.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsTSPacket.h"
+#include "tsTSPacketMetadata.h"
+#include "tsAbortInterface.h"
+#include "tsReport.h"
+#include "tsSysUtils.h"
+#include "tsTime.h"
+
+namespace ts {
+    //!
+    //! Ring buffer of TS packets in shared memory, one writer process, several reader processes.
+    //! @ingroup mpeg
+    //!
+    //! The ring is a named POSIX shared memory segment. The writer process creates the segment.
+    //! Each reader process opens the segment and allocates its own read cursor in the segment.
+    //! Each packet is written once in memory and read directly by all readers, without going
+    //! through the kernel. The metadata of the packets (timestamps, labels) are also transmitted.
+    //!
+    //! The ring synchronization uses atomic variables in the shared memory only. There is no
+    //! lock which could be left acquired by a crashed process. A waiting process polls the ring.
+    //!
+    //! When a reader lags behind the writer, two policies are possible. With the @e drop policy,
+    //! the writer never waits and the late reader loses packets. The reader detects the loss
+    //! and skips to the oldest available packet. With the @e block policy, the writer waits
+    //! for the slowest reader. Readers which terminated without closing the ring (crash) are
+    //! detected and their cursor is released.
+    //!
+    //! When the writer terminates, the name of the segment is removed. The readers receive
+    //! the remaining packets and then an end of stream. When the writer crashes, the readers
+    //! detect it, receive the remaining packets and also get an end of stream. A new writer
+    //! with the same name reclaims the segment of a crashed writer. A segment which is not
+    //! yet initialized by its writer is reclaimed only when it remains uninitialized for one
+    //! second. The removal of a segment is serialized between processes using a file lock
+    //! on the segment, when the system supports it. The memory of the segment is released
+    //! by the system when the last process unmaps it.
+    //!
+    //! This class is implemented on UNIX systems only.
+    //!
+    class TSDUCKDLL SharedPacketRing
+    {
+        TS_NOCOPY(SharedPacketRing);
+    public:
+        //!
+        //! Policy of the writer when a reader is too late.
+        //!
+        enum class LagPolicy : uint32_t {
+            DROP  = 0,  //!< The writer never waits, the late reader loses packets.
+            BLOCK = 1,  //!< The writer waits for the slowest reader.
+        };
+
+        //!
+        //! Default capacity of the ring in TS packets.
+        //!
+        static constexpr size_t DEFAULT_PACKET_COUNT = 64 * 1024;
+
+        //!
+        //! Default maximum number of readers.
+        //!
+        static constexpr size_t DEFAULT_MAX_READERS = 16;
+
+        //!
+        //! Default access mode of the shared memory segment (UNIX permissions).
+        //! Only the processes of the same user can read the ring.
+        //!
+        static constexpr uint32_t DEFAULT_ACCESS_MODE = 0600;
+
+        //!
+        //! Constructor.
+        //!
+        SharedPacketRing() = default;
+
+        //!
+        //! Destructor.
+        //!
+        ~SharedPacketRing();
+
+        //!
+        //! Create the ring, as the writer.
+        //! @param [in] name Name of the ring. It shall be a simple name, without slash.
+        //! @param [in] packet_count Capacity of the ring in TS packets.
+        //! @param [in] max_readers Maximum number of simultaneous readers.
+        //! @param [in] policy Policy of the writer when a reader is too late.
+        //! @param [in,out] report Where to report errors.
+        //! @param [in] access_mode UNIX permissions of the shared memory segment. The readers need
+        //! read and write access to update their read cursor. The umask of the process is ignored.
+        //! @return True on success, false on error.
+        //!
+        bool create(const UString& name, size_t packet_count, size_t max_readers, LagPolicy policy, Report& report, uint32_t access_mode = DEFAULT_ACCESS_MODE);
+
+        //!
+        //! Open an existing ring, as a reader.
+        //! @param [in] name Name of the ring.
+        //! @param [in] timeout Maximum time to wait for the creation of the ring by the writer.
+        //! @param [in,out] report Where to report errors.
+        //! @param [in] abort An optional abort interface to interrupt the wait.
+        //! @return True on success, false on error.
+        //!
+        bool open(const UString& name, MilliSecond timeout, Report& report, const AbortInterface* abort = nullptr);
+
+        //!
+        //! Close the ring.
+        //! When the writer closes the ring, the readers get an end of stream.
+        //!
+        void close();
+
+        //!
+        //! Check if the ring is open.
+        //! @return True if the ring is open.
+        //!
+        bool isOpen() const { return _header != nullptr; }
+
+        //!
+        //! Writer: write packets in the ring.
+        //! With the drop policy, this method never waits. With the block policy, this method
+        //! waits for the slowest reader, until the packets are written or @a abort is set.
+        //! @param [in] packets Address of packets to write.
+        //! @param [in] metadata Address of packet metadata. Can be null.
+        //! @param [in] count Number of packets to write.
+        //! @param [in,out] report Where to report errors.
+        //! @param [in] abort An optional abort interface to interrupt the wait.
+        //! @return True on success, false on error or abort.
+        //!
+        bool write(const TSPacket* packets, const TSPacketMetadata* metadata, size_t count, Report& report, const AbortInterface* abort = nullptr);
+
+        //!
+        //! Reader: read packets from the ring.
+        //! Wait until at least one packet is available, the end of stream or @a abort is set.
+        //! @param [out] packets Address of the buffer for packets.
+        //! @param [out] metadata Address of the buffer for packet metadata. Can be null.
+        //! @param [in] max_count Maximum number of packets to read.
+        //! @param [in,out] report Where to report errors and packet losses.
+        //! @param [in] abort An optional abort interface to interrupt the wait.
+        //! @return Number of read packets. Zero on end of stream, error or abort.
+        //!
+        size_t read(TSPacket* packets, TSPacketMetadata* metadata, size_t max_count, Report& report, const AbortInterface* abort = nullptr);
+
+        //!
+        //! Reader: get the total number of lost packets because this reader was too late.
+        //! @return The total number of lost packets.
+        //!
+        uint64_t lostPackets() const { return _lost; }
+
+        //!
+        //! Get the name of the shared memory segment for a ring name.
+        //! @param [in] name Name of the ring.
+        //! @return Name of the shared memory segment.
+        //!
+        static UString SegmentName(const UString& name);
+
+    private:
+        struct Header;
+        struct Reader;
+
+        Header*     _header = nullptr;   // Mapped shared segment.
+        size_t      _segment_size = 0;   // Size of the mapped segment.
+        UString     _segment_name {};    // Name of the shared memory segment.
+        bool        _writer = false;     // This process is the writer.
+        size_t      _reader_index = 0;   // Index of our reader cursor (reader only).
+        uint64_t    _lost = 0;           // Number of lost packets (reader only).
+        uint64_t    _dev = 0;            // Device of the segment file (reader only, to check reclamation).
+        uint64_t    _inode = 0;          // Inode of the segment file (reader only, to check reclamation).
+        Time        _last_check {};      // Last check of other processes.
+
+        // Compute the segment size for a given capacity.
+        static size_t SegmentSize(size_t packet_count, size_t max_readers);
+
+        // Addresses of areas in the segment.
+        Reader* readers() const;
+        TSPacket* packets() const;
+        uint8_t* metadata() const;
+
+        // Check if a process is still alive.
+        static bool ProcessAlive(uint32_t pid);
+
+        // Writer: get the position of the slowest active reader, release cursors of dead readers.
+        uint64_t slowestReader();
+
+        // Reader: check if the writer is gone (terminated or crashed).
+        bool writerGone();
+
+        // Writer: remove an existing segment with the same name if its writer is gone.
+        // Return false if the segment is still used or on error.
+        bool reclaim(const UString& name, Report& report);
+
+        // Remove the name of a segment if it still designates the segment with the given device and inode.
+        static void UnlinkSegment(const std::string& name8, uint64_t dev, uint64_t inode);
+
+        // Map a segment from a file descriptor. Close the descriptor.
+        bool map(int fd, size_t size, Report& report);
+    };
+}
@@ -16,7 +16,7 @@
 //----------------------------------------------------------------------------
 
 ts::TSPacketQueue::TSPacketQueue(size_t size) :
-    _buffer(size)
+    _buffer(std::max<size_t>(size, 1))
 {
 }
 
@@ -37,10 +37,16 @@ void ts::TSPacketQueue::reset(size_t size)
 
     _eof = false;
     _stopped = false;
-    _inCount = 0;
-    _readIndex = 0;
-    _writeIndex = 0;
+    _readerWaiting = false;
+    _writerWaiting = false;
+    _newBitrate = false;
+    _readCount = 0;
+    _writeCount = 0;
+    _pcr.reset();
     _bitrate = 0;
+    _pcrBitrate = 0;
+    _sharedBitrate = 0;
+    _readerBitrate = 0;
 }
 
 
@@ -50,14 +56,50 @@ void ts::TSPacketQueue::reset(size_t size)
 
 size_t ts::TSPacketQueue::bufferSize() const
 {
-    GuardMutex lock(_mutex);
     return _buffer.size();
 }
 
 size_t ts::TSPacketQueue::currentSize() const
 {
-    GuardMutex lock(_mutex);
-    return _inCount;
+    const size_t read = _readCount.load(std::memory_order_acquire);
+    return _writeCount.load(std::memory_order_acquire) - read;
+}
+
+
+//----------------------------------------------------------------------------
+// Wait until a condition becomes true. Each side has its own waiting flag and
+// condition: a thread which was just signaled may still be in its wait loop
+// when the other side starts waiting.
+//----------------------------------------------------------------------------
+
+template <class PREDICATE>
+void ts::TSPacketQueue::waitFor(std::atomic<bool>& waiting, Condition& condition, PREDICATE pred)
+{
+    // Fast path, without lock.
+    if (pred()) {
+        return;
+    }
+
+    GuardCondition lock(_mutex, condition);
+    for (;;) {
+        // The fence makes sure that the other side sees the waiting flag if we do not see its update.
+        waiting = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (pred()) {
+            waiting = false;
+            return;
+        }
+        lock.waitCondition();
+    }
+}
+
+void ts::TSPacketQueue::wakeUp(std::atomic<bool>& waiting, Condition& condition)
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting.load() && waiting.exchange(false)) {
+        GuardCondition lock(_mutex, condition);
+        lock.signal();
+    }
 }
 
 
@@ -67,36 +109,26 @@ size_t ts::TSPacketQueue::currentSize() const
 
 bool ts::TSPacketQueue::lockWriteBuffer(TSPacket*& buffer, size_t& buffer_size, size_t min_size)
 {
-    GuardCondition lock(_mutex, _dequeued);
-
-    // Maximum size we can allocate to the write window.
-    assert(_readIndex < _buffer.size());
-    assert(_writeIndex < _buffer.size());
-    const size_t max_size = _buffer.size() - _writeIndex;
+    const size_t size = _buffer.size();
+    const size_t write = _writeCount.load(std::memory_order_relaxed);
+    const size_t index = write % size;
 
     // We cannot ask for more than the distance to the end of the buffer.
     // But we also need to wait for at least one packet.
-    min_size = std::max<size_t>(1, std::min(min_size, max_size));
+    min_size = std::max<size_t>(1, std::min(min_size, size - index));
 
     // Wait until we get enough free space.
-    while (!_stopped && _buffer.size() - _inCount < min_size) {
-        lock.waitCondition();
-    }
+    waitFor(_writerWaiting, _writerCondition, [&]() { return _stopped || size - (write - _readCount.load(std::memory_order_acquire)) >= min_size; });
 
     // Return the write window.
-    buffer = &_buffer[_writeIndex];
+    buffer = &_buffer[index];
     if (_stopped) {
         // The reader thread has reported a stop condition, we can no longer write into the buffer.
         buffer_size = 0;
     }
-    else if (_readIndex > _writeIndex) {
-        // The write window extends up to the read index (where packets were not yet consumed).
-        buffer_size = _readIndex - _writeIndex;
-    }
     else {
-        // The write window wraps up at the end of the buffer.
         // Return only the first contiguous part of the write window.
-        buffer_size = max_size;
+        buffer_size = std::min(size - (write - _readCount.load(std::memory_order_acquire)), size - index);
     }
 
     // A write buffer is returned only when the reader thread does not want to terminate.
@@ -110,12 +142,11 @@ bool ts::TSPacketQueue::lockWriteBuffer(TSPacket*& buffer, size_t& buffer_size,
 
 void ts::TSPacketQueue::releaseWriteBuffer(size_t count)
 {
-    GuardCondition lock(_mutex, _enqueued);
-
     // Verify that the specified size is compatible with the current write window.
-    assert(_readIndex < _buffer.size());
-    assert(_writeIndex < _buffer.size());
-    const size_t max_count = (_readIndex > _writeIndex ? _readIndex : _buffer.size()) - _writeIndex;
+    const size_t size = _buffer.size();
+    const size_t write = _writeCount.load(std::memory_order_relaxed);
+    const size_t index = write % size;
+    const size_t max_count = std::min(size - (write - _readCount.load(std::memory_order_acquire)), size - index);
 
     // This is a bug in the application to specify more than the max size.
     assert(count <= max_count);
@@ -126,18 +157,23 @@ void ts::TSPacketQueue::releaseWriteBuffer(size_t count)
     }
 
     // When the writer thread did not specify a bitrate, analyze PCR's.
-    if (_bitrate == 0) {
+    if (_bitrate == 0 && count > 0) {
         for (size_t i = 0; i < count; ++i) {
-            _pcr.feedPacket(_buffer[_writeIndex + i]);
+            _pcr.feedPacket(_buffer[index + i]);
+        }
+        // Publish the bitrate only when it changes.
+        const BitRate bitrate = _pcr.bitrateIsValid() ? BitRate(_pcr.bitrate188()) : BitRate(0);
+        if (bitrate != _pcrBitrate) {
+            _pcrBitrate = bitrate;
+            publishBitrate(bitrate);
         }
     }
 
-    // Mark written packets as part of the buffer.
-    _inCount += count;
-    _writeIndex = (_writeIndex + count) % _buffer.size();
-
-    // Signal that packets have been enqueued
-    lock.signal();
+    // Mark written packets as part of the buffer and signal that packets have been enqueued.
+    if (count > 0) {
+        _writeCount.store(write + count, std::memory_order_release);
+        wakeUp(_readerWaiting, _readerCondition);
+    }
 }
 
 
@@ -147,8 +183,6 @@ void ts::TSPacketQueue::releaseWriteBuffer(size_t count)
 
 void ts::TSPacketQueue::setBitrate(const BitRate& bitrate)
 {
-    GuardMutex lock(_mutex);
-
     // Remember the bitrate value.
     _bitrate = bitrate;
 
@@ -156,6 +190,31 @@ void ts::TSPacketQueue::setBitrate(const BitRate& bitrate)
     if (bitrate > 0) {
         _pcr.reset();
     }
+    _pcrBitrate = 0;
+    publishBitrate(bitrate);
+}
+
+
+//----------------------------------------------------------------------------
+// Transmit the bitrate from the writer thread to the reader thread.
+//----------------------------------------------------------------------------
+
+void ts::TSPacketQueue::publishBitrate(const BitRate& bitrate)
+{
+    GuardMutex lock(_mutex);
+    _sharedBitrate = bitrate;
+    _newBitrate.store(true, std::memory_order_release);
+}
+
+ts::BitRate ts::TSPacketQueue::getBitrate()
+{
+    // The mutex is used only when the bitrate has changed.
+    if (_newBitrate.load(std::memory_order_acquire)) {
+        GuardMutex lock(_mutex);
+        _newBitrate = false;
+        _readerBitrate = _sharedBitrate;
+    }
+    return _readerBitrate;
 }
 
 
@@ -165,8 +224,7 @@ void ts::TSPacketQueue::setBitrate(const BitRate& bitrate)
 
 bool ts::TSPacketQueue::eof() const
 {
-    GuardMutex lock(_mutex);
-    return _eof && _inCount == 0;
+    return _eof && currentSize() == 0;
 }
 
 
@@ -176,59 +234,53 @@ bool ts::TSPacketQueue::eof() const
 
 void ts::TSPacketQueue::setEOF()
 {
-    GuardCondition lock(_mutex, _enqueued);
     _eof = true;
 
     // We did not really enqueue packets but if a reader thread is waiting we need to wake it up.
-    lock.signal();
+    wakeUp(_readerWaiting, _readerCondition);
 }
 
 
 //----------------------------------------------------------------------------
-// Get bitrate, must be called with mutex held.
+// Copy available packets to the reader thread.
 //----------------------------------------------------------------------------
 
-ts::BitRate ts::TSPacketQueue::getBitrate() const
+size_t ts::TSPacketQueue::copyPackets(TSPacket* buffer, size_t buffer_count)
 {
-    if (_bitrate != 0) {
-        return _bitrate;
-    }
-    else if (_pcr.bitrateIsValid()) {
-        return _pcr.bitrate188();
-    }
-    else {
-        return 0;
+    const size_t size = _buffer.size();
+    const size_t read = _readCount.load(std::memory_order_relaxed);
+    const size_t count = std::min(buffer_count, _writeCount.load(std::memory_order_acquire) - read);
+
+    if (count > 0) {
+        // Copy at most two contiguous areas.
+        const size_t index = read % size;
+        const size_t first = std::min(count, size - index);
+        TSPacket::Copy(buffer, &_buffer[index], first);
+        TSPacket::Copy(buffer + first, &_buffer[0], count - first);
+
+        // Signal that packets were freed.
+        _readCount.store(read + count, std::memory_order_release);
+        wakeUp(_writerWaiting, _writerCondition);
     }
+    return count;
 }
 
 
 //----------------------------------------------------------------------------
-// Called by the reader thread to get the next packet.
+// Called by the reader thread to get the next packets.
 //----------------------------------------------------------------------------
 
 bool ts::TSPacketQueue::getPacket(TSPacket& packet, BitRate& bitrate)
 {
-    GuardCondition lock(_mutex, _dequeued);
-
     // Get bitrate, either from reader thread or from PCR analysis.
     bitrate = getBitrate();
+    return copyPackets(&packet, 1) > 0;
+}
 
-    // Get packet when available.
-    if (_inCount == 0) {
-        // No packet available.
-        return false;
-    }
-    else {
-        // Return next packet.
-        packet = _buffer[_readIndex];
-        _readIndex = (_readIndex + 1) % _buffer.size();
-        _inCount--;
-
-        // Signal the condition that a packet was freed.
-        lock.signal();
-
-        return true;
-    }
+size_t ts::TSPacketQueue::getPackets(TSPacket* buffer, size_t buffer_count, BitRate& bitrate)
+{
+    bitrate = getBitrate();
+    return copyPackets(buffer, buffer_count);
 }
 
 
@@ -238,30 +290,16 @@ bool ts::TSPacketQueue::getPacket(TSPacket& packet, BitRate& bitrate)
 
 bool ts::TSPacketQueue::waitPackets(TSPacket* buffer, size_t buffer_count, size_t& actual_count, BitRate& bitrate)
 {
-    // Clear out params.
-    actual_count = 0;
-
     // Wait until there is some packet in the buffer.
-    GuardCondition lock(_mutex, _enqueued);
-    while (!_eof && !_stopped && _inCount == 0) {
-        lock.waitCondition();
-    }
+    const size_t read = _readCount.load(std::memory_order_relaxed);
+    waitFor(_readerWaiting, _readerCondition, [&]() { return _eof || _stopped || _writeCount.load(std::memory_order_acquire) != read; });
 
     // Return as many packets as we can. Ignore eof for now.
-    while (_inCount > 0 && buffer_count > 0) {
-        *buffer++ = _buffer[_readIndex];
-        buffer_count--;
-        actual_count++;
-        _readIndex = (_readIndex + 1) % _buffer.size();
-        _inCount--;
-    }
+    actual_count = copyPackets(buffer, buffer_count);
 
     // Get bitrate, either from reader thread or from PCR analysis.
     bitrate = getBitrate();
 
-    // Signal that packets were freed.
-    _dequeued.signal();
-
     // Return false when no packet is returned. Do not return false immediately
     // when _eof is true, wait for all enqueued packets to be returned.
     return actual_count > 0;
@@ -274,12 +312,11 @@ bool ts::TSPacketQueue::waitPackets(TSPacket* buffer, size_t buffer_count, size_
 
 void ts::TSPacketQueue::stop()
 {
-    GuardCondition lock(_mutex, _dequeued);
-
     // Report a stop condition.
     _stopped = true;
 
-    // Signal the condition that a packet was freed. This is not really freeing
-    // a packet but it means that the writer thread should wake up.
+    // This is not really freeing a packet but it means that the writer thread should wake up.
+    GuardCondition lock(_mutex, _writerCondition);
+    _writerWaiting = false;
     lock.signal();
 }
@@ -37,6 +37,12 @@ namespace ts {
     //!
     //! Termination conditions can be triggered on both sides.
     //!
+    //! There must be one single writer thread and one single reader thread. The positions
+    //! in the buffer are atomic variables and packets are exchanged without locking. The
+    //! mutex is used only when one side must wait for the other one or when the bitrate
+    //! changes. To reduce the synchronization overhead, the reader thread should preferably
+    //! get packets by batches using getPackets() or waitPackets().
+    //!
     class TSDUCKDLL TSPacketQueue
     {
         TS_NOCOPY(TSPacketQueue);
@@ -124,6 +130,17 @@ namespace ts {
         //!
         bool getPacket(TSPacket& packet, BitRate& bitrate);
 
+        //!
+        //! Called by the reader thread to get all available packets without waiting.
+        //! The reader thread is never suspended.
+        //! @param [out] buffer Address of packet buffer.
+        //! @param [in] buffer_count Size of @a buffer in number of packets.
+        //! @param [out] bitrate Input bitrate or zero if unknown.
+        //! @return Number of returned packets in @a buffer. Zero if none was available
+        //! or an end of file occured.
+        //!
+        size_t getPackets(TSPacket* buffer, size_t buffer_count, BitRate& bitrate);
+
         //!
         //! Called by the reader thread to wait for packets.
         //! The reader thread is suspended until at least one packet is available.
@@ -147,19 +164,37 @@ namespace ts {
         void stop();
 
     private:
-        volatile bool     _eof = false;      // The writer thread has reported an end of file.
-        volatile bool     _stopped = false;  // The read thread has reported a stop condition.
-        mutable Mutex     _mutex {};         // Protect access to shared data.
-        mutable Condition _enqueued {};      // Signaled when packets are inserted.
-        mutable Condition _dequeued {};      // Signaled when packets were freed.
-        TSPacketVector    _buffer {};        // The packet buffer.
-        PCRAnalyzer       _pcr {1, 12};      // PCR analyzer to get the bitrate.
-        size_t            _inCount = 0;      // Number of packets currently inside the buffer.
-        size_t            _readIndex = 0;    // Index of next packet to read.
-        size_t            _writeIndex = 0;   // Index of next packet to write.
-        BitRate           _bitrate = 0;      // Bitrate as set by the writer thread.
-
-        // Get bitrate, must be called with mutex held.
-        BitRate getBitrate() const;
+        std::atomic<bool>   _eof {false};           // The writer thread has reported an end of file.
+        std::atomic<bool>   _stopped {false};       // The read thread has reported a stop condition.
+        std::atomic<bool>   _readerWaiting {false}; // The reader thread is waiting on _readerCondition.
+        std::atomic<bool>   _writerWaiting {false}; // The writer thread is waiting on _writerCondition.
+        std::atomic<bool>   _newBitrate {false};    // The writer thread has published a new bitrate.
+        std::atomic<size_t> _readCount {0};         // Total number of read packets, updated by the reader thread.
+        std::atomic<size_t> _writeCount {0};        // Total number of written packets, updated by the writer thread.
+        mutable Mutex       _mutex {};              // Protect waiting and _sharedBitrate.
+        mutable Condition   _readerCondition {};    // Signaled when packets are inserted.
+        mutable Condition   _writerCondition {};    // Signaled when packets are freed.
+        TSPacketVector      _buffer {};             // The packet buffer.
+        PCRAnalyzer         _pcr {1, 12};           // PCR analyzer to get the bitrate (writer thread).
+        BitRate             _bitrate = 0;           // Bitrate as set by the writer thread (writer thread).
+        BitRate             _pcrBitrate = 0;        // Last published PCR-based bitrate (writer thread).
+        BitRate             _sharedBitrate = 0;     // Last published bitrate, under mutex protection.
+        BitRate             _readerBitrate = 0;     // Last bitrate as seen by the reader thread.
+
+        // Publish a new bitrate from the writer thread.
+        void publishBitrate(const BitRate& bitrate);
+
+        // Get the bitrate in the reader thread.
+        BitRate getBitrate();
+
+        // Copy available packets to the reader thread.
+        size_t copyPackets(TSPacket* buffer, size_t buffer_count);
+
+        // Wait until a condition becomes true.
+        template <class PREDICATE>
+        void waitFor(std::atomic<bool>& waiting, Condition& condition, PREDICATE pred);
+
+        // Wake up the other side if it is waiting.
+        void wakeUp(std::atomic<bool>& waiting, Condition& condition);
     };
 }
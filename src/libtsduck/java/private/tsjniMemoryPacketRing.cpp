@@ -0,0 +1,120 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/#license
+//
+//----------------------------------------------------------------------------
+//
+//  Native implementation of the Java class io.tsduck.MemoryPacketRing.
+//
+//----------------------------------------------------------------------------
+
+#include "tsMemoryPacketRing.h"
+#include "tsjni.h"
+
+#if !defined(TS_NO_JAVA)
+
+//
+// private native void initNativeObject(String name, int packetCount);
+//
+TSDUCKJNI void JNICALL Java_io_tsduck_MemoryPacketRing_initNativeObject(JNIEnv* env, jobject obj, jstring jname, jint packetCount)
+{
+    // Make sure we do not allocate twice (and lose previous instance).
+    ts::MemoryPacketRing* ring = ts::jni::GetPointerField<ts::MemoryPacketRing>(env, obj, "nativeObject");
+    if (env != nullptr && ring == nullptr) {
+        ts::jni::SetPointerField(env, obj, "nativeObject", new ts::MemoryPacketRing(ts::jni::ToUString(env, jname), size_t(std::max<jint>(1, packetCount))));
+    }
+}
+
+//
+// public native java.nio.ByteBuffer writeArea(long timeout);
+//
+TSDUCKJNI jobject JNICALL Java_io_tsduck_MemoryPacketRing_writeArea(JNIEnv* env, jobject obj, jlong timeout)
+{
+    ts::MemoryPacketRing* ring = ts::jni::GetPointerField<ts::MemoryPacketRing>(env, obj, "nativeObject");
+    ts::TSPacket* packets = nullptr;
+    ts::TSPacketMetadata* metadata = nullptr;
+    const size_t count = ring == nullptr ? 0 : ring->getWriteArea(packets, metadata, timeout < 0 ? ts::Infinite : ts::MilliSecond(timeout));
+    return count == 0 ? nullptr : env->NewDirectByteBuffer(packets, jlong(count * ts::PKT_SIZE));
+}
+
+//
+// public native void commitWrite(int count);
+//
+TSDUCKJNI void JNICALL Java_io_tsduck_MemoryPacketRing_commitWrite(JNIEnv* env, jobject obj, jint count)
+{
+    ts::MemoryPacketRing* ring = ts::jni::GetPointerField<ts::MemoryPacketRing>(env, obj, "nativeObject");
+    if (ring != nullptr && count > 0) {
+        ring->commitWrite(size_t(count));
+    }
+}
+
+//
+// public native void setEndOfStream();
+//
+TSDUCKJNI void JNICALL Java_io_tsduck_MemoryPacketRing_setEndOfStream(JNIEnv* env, jobject obj)
+{
+    ts::MemoryPacketRing* ring = ts::jni::GetPointerField<ts::MemoryPacketRing>(env, obj, "nativeObject");
+    if (ring != nullptr) {
+        ring->setEndOfStream();
+    }
+}
+
+//
+// public native java.nio.ByteBuffer readArea(long timeout);
+//
+TSDUCKJNI jobject JNICALL Java_io_tsduck_MemoryPacketRing_readArea(JNIEnv* env, jobject obj, jlong timeout)
+{
+    ts::MemoryPacketRing* ring = ts::jni::GetPointerField<ts::MemoryPacketRing>(env, obj, "nativeObject");
+    const ts::TSPacket* packets = nullptr;
+    const ts::TSPacketMetadata* metadata = nullptr;
+    const size_t count = ring == nullptr ? 0 : ring->getReadArea(packets, metadata, timeout < 0 ? ts::Infinite : ts::MilliSecond(timeout));
+    // The Java side shall not modify the buffer.
+    return count == 0 ? nullptr : env->NewDirectByteBuffer(const_cast<ts::TSPacket*>(packets), jlong(count * ts::PKT_SIZE));
+}
+
+//
+// public native void commitRead(int count);
+//
+TSDUCKJNI void JNICALL Java_io_tsduck_MemoryPacketRing_commitRead(JNIEnv* env, jobject obj, jint count)
+{
+    ts::MemoryPacketRing* ring = ts::jni::GetPointerField<ts::MemoryPacketRing>(env, obj, "nativeObject");
+    if (ring != nullptr && count > 0) {
+        ring->commitRead(size_t(count));
+    }
+}
+
+//
+// public native boolean endOfStream();
+//
+TSDUCKJNI jboolean JNICALL Java_io_tsduck_MemoryPacketRing_endOfStream(JNIEnv* env, jobject obj)
+{
+    ts::MemoryPacketRing* ring = ts::jni::GetPointerField<ts::MemoryPacketRing>(env, obj, "nativeObject");
+    return ring == nullptr || ring->endOfStream() || ring->aborted();
+}
+
+//
+// public native void abort();
+//
+TSDUCKJNI void JNICALL Java_io_tsduck_MemoryPacketRing_abort(JNIEnv* env, jobject obj)
+{
+    ts::MemoryPacketRing* ring = ts::jni::GetPointerField<ts::MemoryPacketRing>(env, obj, "nativeObject");
+    if (ring != nullptr) {
+        ring->abort();
+    }
+}
+
+//
+// public native void delete();
+//
+TSDUCKJNI void JNICALL Java_io_tsduck_MemoryPacketRing_delete(JNIEnv* env, jobject obj)
+{
+    ts::MemoryPacketRing* ring = ts::jni::GetPointerField<ts::MemoryPacketRing>(env, obj, "nativeObject");
+    if (ring != nullptr) {
+        delete ring;
+        ts::jni::SetLongField(env, obj, "nativeObject", 0);
+    }
+}
+
+#endif // TS_NO_JAVA
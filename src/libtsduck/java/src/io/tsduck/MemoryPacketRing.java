@@ -0,0 +1,100 @@
+//----------------------------------------------------------------------------
+//
+//  TSDuck - The MPEG Transport Stream Toolkit
+//  Copyright (c) 2005-2023, Thierry Lelegard
+//  BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+
+package io.tsduck;
+
+import java.nio.ByteBuffer;
+
+/**
+ * A wrapper class for C++ MemoryPacketRing.
+ *
+ * A shared ring buffer of TS packets between the application and the "memory"
+ * input or output plugin, using the plugin option "--ring" with the same name.
+ * The application directly reads or writes the TS packets in the memory of the ring,
+ * using direct byte buffers, without callback. This is not a zero-copy interface:
+ * the plugin copies the packets between the ring and the packet buffer of the TSProcessor.
+ *
+ * The plugin looks for the ring when it needs the first packets. The ring can be created
+ * before or after TSProcessor.start(). With the "memory" input plugin, TSProcessor.start()
+ * waits for the first input packets. The packets must be written in the ring from another
+ * thread, otherwise start() blocks until the end of stream. Deleting the ring aborts the
+ * exchange of packets.
+ * @ingroup java
+ */
+public final class MemoryPacketRing extends NativeObject {
+
+    /**
+     * Size in bytes of a TS packet.
+     */
+    public static final int PKT_SIZE = 188;
+
+    /*
+     * Set the address of the C++ object.
+     */
+    private native void initNativeObject(String name, int packetCount);
+
+    /**
+     * Constructor
+     * @param name Name of the ring, as used in option "--ring" of the memory plugins.
+     * @param packetCount Capacity of the ring in TS packets.
+     */
+    public MemoryPacketRing(String name, int packetCount) {
+        initNativeObject(name, packetCount);
+    }
+
+    /**
+     * Get the next contiguous area of free packets in the ring (producer side, with the input plugin).
+     * @param timeout Maximum number of milliseconds to wait for free space, negative means infinite.
+     * @return A direct byte buffer over the free packets. Its capacity is a multiple of PKT_SIZE.
+     * Null on timeout, abort or end of stream.
+     */
+    public native ByteBuffer writeArea(long timeout);
+
+    /**
+     * Publish packets which were written in the area from writeArea() (producer side).
+     * @param count Number of written packets.
+     */
+    public native void commitWrite(int count);
+
+    /**
+     * Signal the end of stream (producer side).
+     */
+    public native void setEndOfStream();
+
+    /**
+     * Get the next contiguous area of packets in the ring (consumer side, with the output plugin).
+     * @param timeout Maximum number of milliseconds to wait for packets, negative means infinite.
+     * @return A direct byte buffer over the available packets. Its capacity is a multiple of PKT_SIZE.
+     * The buffer must not be modified. Null on timeout, abort or end of stream.
+     */
+    public native ByteBuffer readArea(long timeout);
+
+    /**
+     * Release packets which were read from the area from readArea() (consumer side).
+     * The byte buffer from readArea() must no longer be used.
+     * @param count Number of read packets.
+     */
+    public native void commitRead(int count);
+
+    /**
+     * Check if the end of stream was reached or the ring was aborted.
+     * @return True if there is no more packet to read.
+     */
+    public native boolean endOfStream();
+
+    /**
+     * Abort the exchange of packets. All waiting operations are interrupted.
+     */
+    public native void abort();
+
+    /**
+     * Delete the encapsulated C++ object.
+     */
+    @Override
+    public native void delete();
+}
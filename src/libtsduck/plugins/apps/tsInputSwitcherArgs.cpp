@@ -124,6 +124,18 @@ void ts::InputSwitcherArgs::defineArgs(Args& args)
               u"Specify the index of the first input plugin to start. "
               u"By default, the first plugin (index 0) is used.");
 
+    args.option(u"fix-continuity");
+    args.help(u"fix-continuity",
+              u"Fix the continuity counters in the output stream. When switching from one input "
+              u"plugin to another one, the continuity counters of each PID in the new input are "
+              u"offset to be continuous with the previous input. The offset is computed from the "
+              u"continuity state of the new input, which is maintained while the input is in "
+              u"standby, or on the first packet of the PID after the switch. The continuity errors "
+              u"in the new input are preserved. The packets of the PSI PID's (PAT, PMT's, NIT and DVB-SI) are "
+              u"replaced with null packets until the start of the next section in each PID. "
+              u"Additionally, the discontinuity_indicator is set in the first packet with a PCR "
+              u"in each PID after the switch to signal the change of time base to the receivers.");
+
     args.option(u"infinite", 'i');
     args.help(u"infinite", u"Infinitely repeat the cycle through all input plugins in sequence.");
 
@@ -171,6 +183,14 @@ void ts::InputSwitcherArgs::defineArgs(Args& args)
     args.option(u"terminate", 't');
     args.help(u"terminate", u"Terminate execution when the current input plugin terminates.");
 
+    args.option(u"warm-standby");
+    args.help(u"warm-standby",
+              u"Keep all input plugins in warm standby. This option implies --fast-switch. "
+              u"Additionally, the input plugins which are not the current one keep only "
+              u"their most recently received packets in their buffer. When switching, "
+              u"the output immediately continues with up-to-date packets from the new input "
+              u"instead of replaying the older packets which were buffered before the switch.");
+
     args.option(u"udp-buffer-size", 0, Args::UNSIGNED);
     args.help(u"udp-buffer-size",
               u"Specifies the UDP socket receive buffer size (socket option).");
@@ -184,8 +204,10 @@ void ts::InputSwitcherArgs::defineArgs(Args& args)
 bool ts::InputSwitcherArgs::loadArgs(DuckContext& duck, Args& args)
 {
     appName = args.appName();
-    fastSwitch = args.present(u"fast-switch");
+    warmStandby = args.present(u"warm-standby");
+    fastSwitch = warmStandby || args.present(u"fast-switch");
     delayedSwitch = args.present(u"delayed-switch");
+    fixContinuity = args.present(u"fix-continuity");
     terminate = args.present(u"terminate");
     args.getIntValue(cycleCount, u"cycle", args.present(u"infinite") ? 0 : 1);
     args.getIntValue(bufferedPackets, u"buffer-packets", DEFAULT_BUFFERED_PACKETS);
@@ -210,7 +232,7 @@ bool ts::InputSwitcherArgs::loadArgs(DuckContext& duck, Args& args)
         args.error(u"options --cycle, --infinite and --terminate are mutually exclusive");
     }
     if (fastSwitch && delayedSwitch) {
-        args.error(u"options --delayed-switch and --fast-switch are mutually exclusive");
+        args.error(u"option --delayed-switch is incompatible with --fast-switch and --warm-standby");
     }
 
     // Resolve all allowed remote.
@@ -30,6 +30,8 @@ namespace ts {
         UString             appName {};            //!< Application name, for help messages.
         bool                fastSwitch = false;    //!< Fast switch between input plugins.
         bool                delayedSwitch = false; //!< Delayed switch between input plugins.
+        bool                warmStandby = false;   //!< Keep only the most recent packets in standby inputs (implies fastSwitch).
+        bool                fixContinuity = false; //!< Fix continuity counters and signal PCR discontinuities after switching.
         bool                terminate = false;     //!< Terminate when one input plugin completes.
         bool                reusePort = false;     //!< Reuse-port socket option.
         size_t              firstInput = 0;        //!< Index of first input plugin.
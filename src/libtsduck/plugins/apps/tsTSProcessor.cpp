@@ -11,6 +11,7 @@
 #include "tstspOutputExecutor.h"
 #include "tstspProcessorExecutor.h"
 #include "tstspControlServer.h"
+#include "tsSignalizationCache.h"
 #include "tsGuardMutex.h"
 
 
@@ -132,6 +133,11 @@ bool ts::TSProcessor::start(const TSProcessorArgs& args)
             realtime = false;
         }
 
+        // Enable the shared signalization cache before the plugins start demuxing tables.
+        if (_args.signalization_cache > 0) {
+            SignalizationCache::Instance().setMaxTables(_args.signalization_cache);
+        }
+
         // Now, we definitely know if we are in offline or realtime mode.
         // Adjust some default parameters.
         _args.applyDefaults(realtime);
@@ -21,6 +21,8 @@ constexpr ts::PacketCounter ts::TSProcessorArgs::DEFAULT_INIT_BITRATE_PKT_INTERV
 #define DEF_MAX_FLUSH_PKT_RT    1000  // packets
 #define DEF_MAX_INPUT_PKT_OFL      0  // packets
 #define DEF_MAX_INPUT_PKT_RT    1000  // packets
+#define DEF_SLICE_LATENCY_OFL    100  // milliseconds
+#define DEF_SLICE_LATENCY_RT      10  // milliseconds
 
 
 //----------------------------------------------------------------------------
@@ -156,6 +158,30 @@ void ts::TSProcessorArgs::defineArgs(Args& args)
               u"This option is useful only when an output plugin or device has problems with large output requests. "
               u"This option forces multiple smaller send operations.");
 
+    args.option(u"max-slice-latency", 0, Args::POSITIVE);
+    args.help(u"max-slice-latency", u"milliseconds",
+              u"With --min-slice-packets, specify the maximum time in milliseconds a plugin "
+              u"waits for a complete slice of packets before processing the available ones. "
+              u"This limits the latency which is introduced by each plugin, typically with live inputs. "
+              u"The default is " + UString::Decimal(DEF_SLICE_LATENCY_OFL) + u" ms in offline mode and " +
+              UString::Decimal(DEF_SLICE_LATENCY_RT) + u" ms in real-time mode.");
+
+    args.option(u"min-slice-packets", 0, Args::POSITIVE);
+    args.help(u"min-slice-packets",
+              u"Specify the number of packets to accumulate before waking up a packet processor "
+              u"or the output plugin. By default, a plugin is woken up as soon as one packet is available. "
+              u"With long chains of plugins, processing larger slices of packets reduces the number "
+              u"of thread context switches. The actual size of the slices is adapted to the throughput "
+              u"of each plugin so that no plugin waits more than --max-slice-latency.");
+
+    args.option(u"signalization-cache", 0, Args::POSITIVE);
+    args.help(u"signalization-cache", u"count",
+              u"Enable a process-wide cache of deserialized signalization tables (PAT, PMT, NIT, SDT, VCT, etc.) "
+              u"and specify the maximum number of tables in the cache. When several plugins analyze the "
+              u"signalization of the same stream, each table is deserialized once only, the other plugins "
+              u"receive a copy of it. This is useful with many plugins and large tables. "
+              u"By default, there is no cache.");
+
     args.option(u"realtime", 'r', Args::TRISTATE, 0, 1, -255, 256, true);
     args.help(u"realtime",
               u"Specifies if tsp and all plugins should use default values for real-time "
@@ -183,6 +209,9 @@ bool ts::TSProcessorArgs::loadArgs(DuckContext& duck, Args& args)
     args.getIntValue(max_input_pkt, u"max-input-packets", 0);
     args.getIntValue(max_output_pkt, u"max-output-packets", NPOS); // unlimited by default
     args.getIntValue(init_input_pkt, u"initial-input-packets", 0);
+    args.getIntValue(min_slice_pkt, u"min-slice-packets", 0);
+    args.getIntValue(max_slice_latency, u"max-slice-latency", 0);
+    args.getIntValue(signalization_cache, u"signalization-cache", 0);
     args.getIntValue(instuff_start, u"add-start-stuffing", 0);
     args.getIntValue(instuff_stop, u"add-stop-stuffing", 0);
     ignore_jt = args.present(u"ignore-joint-termination");
@@ -248,4 +277,7 @@ void ts::TSProcessorArgs::applyDefaults(bool rt)
     if (max_input_pkt == 0) {
         max_input_pkt = rt ? DEF_MAX_INPUT_PKT_RT: DEF_MAX_INPUT_PKT_OFL;
     }
+    if (max_slice_latency == 0) {
+        max_slice_latency = rt ? DEF_SLICE_LATENCY_RT : DEF_SLICE_LATENCY_OFL;
+    }
 }
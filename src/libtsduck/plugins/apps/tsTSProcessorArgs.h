@@ -35,6 +35,9 @@ namespace ts {
         size_t            max_input_pkt = 0;        //!< Max packets per input operation.
         size_t            max_output_pkt = NPOS;    //!< Max packets per outsput operation. NPOS means unlimited.
         size_t            init_input_pkt = 0;       //!< Initial number of input packets to read before starting the processing (zero means default).
+        size_t            min_slice_pkt = 0;        //!< Min number of packets to accumulate before waking up a plugin (zero or one means no accumulation).
+        MilliSecond       max_slice_latency = 0;    //!< Max time to wait for a slice of @a min_slice_pkt packets (zero means default).
+        size_t            signalization_cache = 0;  //!< Max number of tables in the process-wide signalization cache (zero means disabled).
         size_t            instuff_nullpkt = 0;      //!< Add input stuffing: add @a instuff_nullpkt null packets every @a instuff_inpkt input packets.
         size_t            instuff_inpkt = 0;        //!< Add input stuffing: add @a instuff_nullpkt null packets every @a instuff_inpkt input packets.
         size_t            instuff_start = 0;        //!< Add input stuffing: add @a instuff_start null packets before actual input.
@@ -0,0 +1,246 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+
+#include "tsMemoryPacketRing.h"
+#include "tsGuardMutex.h"
+#include "tsGuardCondition.h"
+#include "tsTime.h"
+
+//----------------------------------------------------------------------------
+// Repository of rings by name.
+//----------------------------------------------------------------------------
+
+ts::Mutex& ts::MemoryPacketRing::RepositoryMutex()
+{
+    static Mutex mutex;
+    return mutex;
+}
+
+std::map<ts::UString, ts::MemoryPacketRing::BufferPtr>& ts::MemoryPacketRing::Repository()
+{
+    static std::map<UString, BufferPtr> rings;
+    return rings;
+}
+
+
+//----------------------------------------------------------------------------
+// Constructors and destructors.
+//----------------------------------------------------------------------------
+
+ts::MemoryPacketRing::Buffer::Buffer(const UString& name_, size_t packet_count) :
+    name(name_),
+    packets(std::max<size_t>(1, packet_count)),
+    metadata(packets.size())
+{
+}
+
+ts::MemoryPacketRing::MemoryPacketRing(const UString& name, size_t packet_count) :
+    _buffer(new Buffer(name, packet_count)),
+    _owner(true)
+{
+    GuardMutex lock(RepositoryMutex());
+    Repository()[name] = _buffer;
+}
+
+ts::MemoryPacketRing::MemoryPacketRing(const BufferPtr& buffer) :
+    _buffer(buffer),
+    _owner(false)
+{
+}
+
+ts::MemoryPacketRing::~MemoryPacketRing()
+{
+    // The memory of the ring is freed when the last instance is deleted.
+    if (_owner) {
+        abort();
+        GuardMutex lock(RepositoryMutex());
+        auto it = Repository().find(_buffer->name);
+        if (it != Repository().end() && it->second == _buffer) {
+            Repository().erase(it);
+        }
+    }
+}
+
+ts::MemoryPacketRingPtr ts::MemoryPacketRing::Find(const UString& name)
+{
+    GuardMutex lock(RepositoryMutex());
+    auto it = Repository().find(name);
+    return it == Repository().end() ? MemoryPacketRingPtr() : MemoryPacketRingPtr(new MemoryPacketRing(it->second));
+}
+
+
+//----------------------------------------------------------------------------
+// Wait until a condition on the ring becomes true. Each side has its own
+// waiting flag and condition: a thread which was just signaled may still be
+// in its wait loop when the other side starts waiting.
+//----------------------------------------------------------------------------
+
+template <class PREDICATE>
+bool ts::MemoryPacketRing::waitFor(std::atomic<bool>& waiting, Condition& condition, PREDICATE pred, MilliSecond timeout)
+{
+    // Fast path, without lock.
+    if (pred()) {
+        return true;
+    }
+    else if (timeout <= 0) {
+        return false;
+    }
+
+    const Time deadline(timeout == Infinite ? Time::Apocalypse : Time::CurrentUTC() + timeout);
+    GuardCondition lock(_buffer->mutex, condition);
+    for (;;) {
+        // The fence makes sure that the other side sees the waiting flag if we do not see its update.
+        waiting = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (pred()) {
+            waiting = false;
+            return true;
+        }
+        const Time now(Time::CurrentUTC());
+        if (now >= deadline) {
+            waiting = false;
+            return false;
+        }
+        lock.waitCondition(timeout == Infinite ? Infinite : deadline - now);
+    }
+}
+
+void ts::MemoryPacketRing::wakeUp(std::atomic<bool>& waiting, Condition& condition)
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting.load() && waiting.exchange(false)) {
+        GuardCondition lock(_buffer->mutex, condition);
+        lock.signal();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Producer side.
+//----------------------------------------------------------------------------
+
+size_t ts::MemoryPacketRing::getWriteArea(TSPacket*& packets, TSPacketMetadata*& metadata, MilliSecond timeout)
+{
+    Buffer& buf(*_buffer);
+    const size_t size = buf.packets.size();
+    const size_t tail = buf.tail.load(std::memory_order_relaxed);
+    waitFor(buf.producerWaiting, buf.producerCondition, [&]() { return buf.aborted || buf.eos || tail - buf.head.load(std::memory_order_acquire) < size; }, timeout);
+
+    if (buf.aborted || buf.eos) {
+        return 0;
+    }
+    const size_t free = size - (tail - buf.head.load(std::memory_order_acquire));
+    const size_t index = tail % size;
+    packets = &buf.packets[index];
+    metadata = &buf.metadata[index];
+    return std::min(free, size - index);
+}
+
+void ts::MemoryPacketRing::commitWrite(size_t count)
+{
+    Buffer& buf(*_buffer);
+    if (count > 0) {
+        buf.tail.store(buf.tail.load(std::memory_order_relaxed) + count, std::memory_order_release);
+        wakeUp(buf.consumerWaiting, buf.consumerCondition);
+    }
+}
+
+size_t ts::MemoryPacketRing::write(const TSPacket* packets, const TSPacketMetadata* metadata, size_t count, MilliSecond timeout)
+{
+    size_t written = 0;
+    while (written < count) {
+        TSPacket* pkt = nullptr;
+        TSPacketMetadata* mdata = nullptr;
+        const size_t n = std::min(count - written, getWriteArea(pkt, mdata, timeout));
+        if (n == 0) {
+            break;
+        }
+        TSPacket::Copy(pkt, packets + written, n);
+        if (metadata != nullptr) {
+            TSPacketMetadata::Copy(mdata, metadata + written, n);
+        }
+        commitWrite(n);
+        written += n;
+    }
+    return written;
+}
+
+void ts::MemoryPacketRing::setEndOfStream()
+{
+    Buffer& buf(*_buffer);
+    buf.eos = true;
+    wakeUp(buf.consumerWaiting, buf.consumerCondition);
+}
+
+
+//----------------------------------------------------------------------------
+// Consumer side.
+//----------------------------------------------------------------------------
+
+size_t ts::MemoryPacketRing::getReadArea(const TSPacket*& packets, const TSPacketMetadata*& metadata, MilliSecond timeout)
+{
+    Buffer& buf(*_buffer);
+    const size_t size = buf.packets.size();
+    const size_t head = buf.head.load(std::memory_order_relaxed);
+    waitFor(buf.consumerWaiting, buf.consumerCondition, [&]() { return buf.aborted || buf.eos || buf.tail.load(std::memory_order_acquire) != head; }, timeout);
+
+    // On end of stream, the remaining packets are still available.
+    const size_t count = buf.aborted ? 0 : buf.tail.load(std::memory_order_acquire) - head;
+    const size_t index = head % size;
+    packets = &buf.packets[index];
+    metadata = &buf.metadata[index];
+    return std::min(count, size - index);
+}
+
+void ts::MemoryPacketRing::commitRead(size_t count)
+{
+    Buffer& buf(*_buffer);
+    if (count > 0) {
+        // Reset the metadata so that producers which ignore them get default values.
+        const size_t head = buf.head.load(std::memory_order_relaxed);
+        const size_t index = head % buf.packets.size();
+        TSPacketMetadata::Reset(&buf.metadata[index], count);
+        buf.head.store(head + count, std::memory_order_release);
+        wakeUp(buf.producerWaiting, buf.producerCondition);
+    }
+}
+
+size_t ts::MemoryPacketRing::read(TSPacket* packets, TSPacketMetadata* metadata, size_t max_count, MilliSecond timeout)
+{
+    size_t count = 0;
+    while (count < max_count) {
+        const TSPacket* pkt = nullptr;
+        const TSPacketMetadata* mdata = nullptr;
+        // Wait only for the first packet, then get what is immediately available.
+        const size_t n = std::min(max_count - count, getReadArea(pkt, mdata, count == 0 ? timeout : 0));
+        if (n == 0) {
+            break;
+        }
+        TSPacket::Copy(packets + count, pkt, n);
+        if (metadata != nullptr) {
+            TSPacketMetadata::Copy(metadata + count, mdata, n);
+        }
+        commitRead(n);
+        count += n;
+    }
+    return count;
+}
+
+
+//----------------------------------------------------------------------------
+// Abort the exchange of packets.
+//----------------------------------------------------------------------------
+
+void ts::MemoryPacketRing::abort()
+{
+    Buffer& buf(*_buffer);
+    buf.aborted = true;
+    GuardMutex lock(buf.mutex);
+    buf.consumerCondition.signal();
+    buf.producerCondition.signal();
+}
@@ -0,0 +1,223 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Shared ring buffer of TS packets between an application and memory plugins.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsTSPacket.h"
+#include "tsTSPacketMetadata.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
+#include "tsSafePtr.h"
+
+namespace ts {
+
+    class MemoryPacketRing;
+
+    //!
+    //! Safe pointer to a MemoryPacketRing (thread-safe).
+    //!
+    typedef SafePtr<MemoryPacketRing, Mutex> MemoryPacketRingPtr;
+
+    //!
+    //! Shared ring buffer of TS packets between an application and the memory plugins.
+    //! @ingroup plugin
+    //!
+    //! An application which runs a TSProcessor pipeline creates an instance of this class
+    //! with a unique name. The @c memory input or output plugin is then used with the
+    //! option @c --ring and the same name.
+    //!
+    //! The ring has one single producer and one single consumer. With the @c memory input
+    //! plugin, the application is the producer and the plugin is the consumer. With the
+    //! @c memory output plugin, the plugin is the producer and the application is the consumer.
+    //!
+    //! The application directly writes or reads the TS packets and their metadata in the
+    //! memory of the ring, using getWriteArea() / commitWrite() or getReadArea() / commitRead().
+    //! There is no callback. The positions in the ring are atomic variables. A mutex is used
+    //! only to wait when the ring is full or empty.
+    //!
+    //! This is not a zero-copy interface: the memory plugins copy the packets between the
+    //! ring and the packet buffer of the TSProcessor, which is not accessible to the
+    //! application. Only the copy between the application and the ring is avoided.
+    //!
+    //! The metadata of consumed packets are reset in commitRead(). Therefore, a producer
+    //! which does not care about metadata can ignore them.
+    //!
+    //! The memory plugins look for the ring by name when they need the first packets. The ring
+    //! can be created before or after TSProcessor::start(), for instance by the thread which
+    //! feeds the input ring. With the @c memory input plugin, TSProcessor::start() preloads the
+    //! first input packets. Therefore, the application must feed the input ring from another
+    //! thread, or start() blocks until the end of stream is set.
+    //!
+    //! The memory of the ring is shared between the instance which was created by the
+    //! application and the instances which are returned by Find(). When the application
+    //! deletes its instance, the ring is aborted and can no longer be found by name, but
+    //! its memory remains valid until the plugins release it.
+    //!
+    class TSDUCKDLL MemoryPacketRing
+    {
+        TS_NOBUILD_NOCOPY(MemoryPacketRing);
+    public:
+        //!
+        //! Constructor.
+        //! @param [in] name Name of the ring, as used in option @c --ring of the memory plugins.
+        //! If another ring with the same name already exists, it can no longer be found by name.
+        //! @param [in] packet_count Capacity of the ring in TS packets.
+        //!
+        MemoryPacketRing(const UString& name, size_t packet_count);
+
+        //!
+        //! Destructor.
+        //! When the instance was created by the application, the ring is aborted and unregistered.
+        //!
+        ~MemoryPacketRing();
+
+        //!
+        //! Find a ring by name.
+        //! @param [in] name Name of the ring.
+        //! @return A new instance which shares the memory of the ring with the same name.
+        //! The returned pointer is null if the ring is not found.
+        //!
+        static MemoryPacketRingPtr Find(const UString& name);
+
+        //!
+        //! Get the name of the ring.
+        //! @return The name of the ring.
+        //!
+        const UString& name() const { return _buffer->name; }
+
+        //!
+        //! Get the capacity of the ring.
+        //! @return The maximum number of packets in the ring.
+        //!
+        size_t capacity() const { return _buffer->packets.size(); }
+
+        //!
+        //! Get the number of packets which are currently in the ring.
+        //! @return The number of packets which were committed by the producer and not yet by the consumer.
+        //!
+        size_t packetCount() const { return _buffer->tail.load(std::memory_order_acquire) - _buffer->head.load(std::memory_order_acquire); }
+
+        //!
+        //! Producer: get the next contiguous area of free packets in the ring.
+        //! @param [out] packets Address of the first free packet.
+        //! @param [out] metadata Address of the metadata of the first free packet.
+        //! @param [in] timeout Maximum time to wait for free space.
+        //! @return Number of contiguous free packets. Zero on timeout, abort or end of stream.
+        //!
+        size_t getWriteArea(TSPacket*& packets, TSPacketMetadata*& metadata, MilliSecond timeout = Infinite);
+
+        //!
+        //! Producer: publish packets which were written in the area from getWriteArea().
+        //! @param [in] count Number of written packets, not more than returned by getWriteArea().
+        //!
+        void commitWrite(size_t count);
+
+        //!
+        //! Producer: copy packets into the ring.
+        //! @param [in] packets Address of the packets to write.
+        //! @param [in] metadata Address of the packet metadata. Can be null.
+        //! @param [in] count Number of packets to write.
+        //! @param [in] timeout Maximum time to wait for free space, for each contiguous area.
+        //! @return Number of written packets. Less than @a count on timeout, abort or end of stream.
+        //!
+        size_t write(const TSPacket* packets, const TSPacketMetadata* metadata, size_t count, MilliSecond timeout = Infinite);
+
+        //!
+        //! Producer: signal the end of stream.
+        //! The consumer receives the remaining packets and then gets an end of stream.
+        //!
+        void setEndOfStream();
+
+        //!
+        //! Consumer: get the next contiguous area of packets in the ring.
+        //! @param [out] packets Address of the first packet.
+        //! @param [out] metadata Address of the metadata of the first packet.
+        //! @param [in] timeout Maximum time to wait for packets.
+        //! @return Number of contiguous available packets. Zero on timeout, abort or end of stream.
+        //!
+        size_t getReadArea(const TSPacket*& packets, const TSPacketMetadata*& metadata, MilliSecond timeout = Infinite);
+
+        //!
+        //! Consumer: release packets which were read from the area from getReadArea().
+        //! @param [in] count Number of read packets, not more than returned by getReadArea().
+        //!
+        void commitRead(size_t count);
+
+        //!
+        //! Consumer: copy packets from the ring.
+        //! @param [out] packets Address of the buffer for packets.
+        //! @param [out] metadata Address of the buffer for packet metadata. Can be null.
+        //! @param [in] max_count Maximum number of packets to read.
+        //! @param [in] timeout Maximum time to wait for the first packet.
+        //! @return Number of read packets. Zero on timeout, abort or end of stream.
+        //!
+        size_t read(TSPacket* packets, TSPacketMetadata* metadata, size_t max_count, MilliSecond timeout = Infinite);
+
+        //!
+        //! Check if the end of stream was reached.
+        //! @return True if the producer signaled the end of stream and all packets were read.
+        //!
+        bool endOfStream() const { return _buffer->eos && packetCount() == 0; }
+
+        //!
+        //! Abort the exchange of packets, from the producer or the consumer.
+        //! All waiting operations are interrupted.
+        //!
+        void abort();
+
+        //!
+        //! Check if the exchange of packets was aborted.
+        //! @return True if the exchange of packets was aborted.
+        //!
+        bool aborted() const { return _buffer->aborted; }
+
+    private:
+        // Memory of the ring, shared by all instances with the same name.
+        class Buffer
+        {
+            TS_NOBUILD_NOCOPY(Buffer);
+        public:
+            Buffer(const UString& name, size_t packet_count);
+
+            const UString                 name;
+            std::vector<TSPacket>         packets;
+            std::vector<TSPacketMetadata> metadata;
+            std::atomic<size_t>           head {0};         // Next packet to read, updated by the consumer.
+            std::atomic<size_t>           tail {0};         // Next packet to write, updated by the producer.
+            std::atomic<bool>             eos {false};      // End of stream, set by the producer.
+            std::atomic<bool>             aborted {false};  // Aborted by any side.
+            std::atomic<bool>             consumerWaiting {false};  // The consumer is waiting on consumerCondition.
+            std::atomic<bool>             producerWaiting {false};  // The producer is waiting on producerCondition.
+            Mutex                         mutex {};
+            Condition                     consumerCondition {};     // Signaled when packets are written.
+            Condition                     producerCondition {};     // Signaled when packets are read.
+        };
+        typedef SafePtr<Buffer, Mutex> BufferPtr;
+
+        const BufferPtr _buffer;  // Never null.
+        const bool      _owner;   // Created by the application, registered by name.
+
+        // Constructor of the instances which are returned by Find().
+        MemoryPacketRing(const BufferPtr& buffer);
+
+        // Repository of rings by name.
+        static Mutex& RepositoryMutex();
+        static std::map<UString, BufferPtr>& Repository();
+
+        // Wait until a condition on the ring becomes true. Return false on timeout.
+        template <class PREDICATE>
+        bool waitFor(std::atomic<bool>& waiting, Condition& condition, PREDICATE pred, MilliSecond timeout);
+
+        // Wake up the other side if it is waiting.
+        void wakeUp(std::atomic<bool>& waiting, Condition& condition);
+    };
+}
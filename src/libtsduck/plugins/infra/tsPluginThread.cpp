@@ -8,6 +8,7 @@
 
 #include "tsPluginThread.h"
 #include "tsPluginRepository.h"
+#include "tsAsyncReport.h"
 
 
 //----------------------------------------------------------------------------
@@ -18,6 +19,7 @@ ts::PluginThread::PluginThread(Report* report, const UString& appName, PluginTyp
     Thread(),
     TSP(report->maxSeverity()),
     _report(report),
+    _async(dynamic_cast<AsyncReport*>(report)),
     _name(options.name),
     _logname(),
     _shlib(nullptr)
@@ -121,5 +123,22 @@ ts::Plugin* ts::PluginThread::plugin() const
 
 void ts::PluginThread::writeLog(int severity, const UString& msg)
 {
-    _report->log(severity, u"%s: %s", {_logname.empty() ? _name : _logname, msg});
+    if (_async != nullptr) {
+        // Let the asynchronous report format the message in its own thread.
+        _async->logSource(severity, msg, _logname.empty() ? _name : _logname, pluginIndex());
+    }
+    else {
+        _report->log(severity, u"%s: %s", {_logname.empty() ? _name : _logname, msg});
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Change the report object.
+//----------------------------------------------------------------------------
+
+void ts::PluginThread::setReport(Report* rep)
+{
+    _report = rep;
+    _async = dynamic_cast<AsyncReport*>(rep);
 }
@@ -17,6 +17,9 @@
 #include "tsPluginOptions.h"
 
 namespace ts {
+
+    class AsyncReport;
+
     //!
     //! Base class for threads executing a tsp plugin.
     //! The subclasses shall implement the TSP interface.
@@ -47,7 +50,7 @@ namespace ts {
         //! Change the report object.
         //! @param [in] rep Address of new report instance.
         //!
-        void setReport(Report* rep) { _report = rep; }
+        void setReport(Report* rep);
 
         //!
         //! Plugin stack size overhead.
@@ -74,6 +77,7 @@ namespace ts {
 
     private:
         Report*       _report;  // Common report interface for all plugins
+        AsyncReport*  _async;   // Same as _report if this is an asynchronous report, null otherwise.
         const UString _name;    // Plugin name.
         UString       _logname; // Plugin name as displayed in log messages.
         Plugin*       _shlib;   // Shared library API.
@@ -7,6 +7,7 @@
 //----------------------------------------------------------------------------
 
 #include "tsAbstractDescrambler.h"
+#include "tsGuardMutex.h"
 #include "tsGuardCondition.h"
 
 // Stack usage required by this module in the ECM deciphering thread.
@@ -59,6 +60,21 @@ ts::AbstractDescrambler::AbstractDescrambler(TSP* tsp_, const UString& descripti
     help(u"swap-cw",
         u"Swap even and odd control words from the ECM's. "
         u"Useful when a crazy ECMG inadvertently swapped the CW before generating the ECM.");
+
+    option(u"threads", 0, INTEGER, 0, 1, 0, 64);
+    help(u"threads",
+         u"Number of threads which descramble packets in parallel. "
+         u"The signalization and the ECM's are still processed in the order of the stream, "
+         u"only the decryption of the packets is distributed over several threads. "
+         u"The packets are processed by windows of packets (see option --packet-window). "
+         u"The default is zero, meaning that the packets are descrambled in the plugin thread.");
+
+    option(u"packet-window", 0, POSITIVE);
+    help(u"packet-window",
+         u"Number of packets which are processed at once. "
+         u"The packets of a window which use the same control words are descrambled together. "
+         u"With --threads, a larger window reduces the synchronization overhead but increases the latency. "
+         u"The default is " + UString::Decimal(DEFAULT_PACKET_WINDOW) + u" packets.");
 }
 
 
@@ -73,6 +89,8 @@ bool ts::AbstractDescrambler::getOptions()
     _service.set(value(u""));
     _synchronous = present(u"synchronous") || !tsp->realtime();
     _swap_cw = present(u"swap-cw");
+    getIntValue(_thread_count, u"threads", 0);
+    getIntValue(_window_size, u"packet-window", DEFAULT_PACKET_WINDOW);
     getIntValues(_pids, u"pid");
     if (!duck.loadArgs(*this) || !_scrambling.loadArgs(duck, *this)) {
         return false;
@@ -126,6 +144,8 @@ bool ts::AbstractDescrambler::start()
     _ecm_streams.clear();
     _scrambled_streams.clear();
     _demux.reset();
+    _fixed_scv = SC_CLEAR;
+    _fixed_keys.clear();
 
     // Initialize the scrambling engine.
     if (!_scrambling.start()) {
@@ -142,6 +162,8 @@ bool ts::AbstractDescrambler::start()
         _ecm_thread.start();
     }
 
+    // Create the descrambling threads, if any.
+    startDecryptThreads();
     return true;
 }
 
@@ -152,6 +174,9 @@ bool ts::AbstractDescrambler::start()
 
 bool ts::AbstractDescrambler::stop()
 {
+    // Terminate the descrambling threads, if any.
+    stopDecryptThreads();
+
     // In asynchronous mode, notify the ECM processing thread to terminate
     // and wait for its actual termination.
     if (_need_ecm && !_synchronous) {
@@ -174,7 +199,7 @@ bool ts::AbstractDescrambler::stop()
 
 void ts::AbstractDescrambler::handlePMT(const PMT& pmt, PID)
 {
-    tsp->debug(u"PMT: service 0x%X, %d elementary streams", {pmt.service_id, pmt.streams.size()});
+    tsp->debug(TS_CHECKED_FORMAT(u"PMT: service 0x%X, %d elementary streams", pmt.service_id, pmt.streams.size()));
 
     // Default scrambling is DVB-CSA2.
     uint8_t scrambling_type = SCRAMBLING_DVB_CSA2;
@@ -210,10 +235,12 @@ void ts::AbstractDescrambler::handlePMT(const PMT& pmt, PID)
 
     // Set global scrambling type from scrambling descriptor, if not specified on the command line.
     _scrambling.setScramblingType(scrambling_type, false);
-    tsp->verbose(u"using scrambling mode: %s", {NameFromDTV(u"ScramblingMode", _scrambling.scramblingType())});
+    tsp->verbose(TS_CHECKED_FORMAT(u"using scrambling mode: %s", NameFromDTV(u"ScramblingMode", _scrambling.scramblingType())));
     for (auto& it : _ecm_streams) {
         it.second->scrambling.setScramblingType(scrambling_type, false);
+        it.second->keys.clear();
     }
+    _fixed_keys.clear();
 }
 
 
@@ -241,7 +268,7 @@ void ts::AbstractDescrambler::analyzeDescriptors(const DescriptorList& dlist, st
 
                         // Ask subclass if this PID is OK
                         if (checkCADescriptor(sysid, ByteBlock(desc + 4, size - 4))) {
-                            tsp->verbose(u"using ECM PID %d (0x%X)", {pid, pid});
+                            tsp->verbose(TS_CHECKED_FORMAT(u"using ECM PID %d (0x%X)", pid, pid));
                             // Create context for this ECM stream.
                             ecm_pids.insert(pid);
                             getOrCreateECMStream(pid);
@@ -274,12 +301,12 @@ void ts::AbstractDescrambler::analyzeDescriptors(const DescriptorList& dlist, st
 void ts::AbstractDescrambler::handleSection(SectionDemux& demux, const Section& sect)
 {
     const PID ecm_pid = sect.sourcePID();
-    tsp->log(2, u"got ECM (TID 0x%X) on PID %d (0x%X)", {sect.tableId(), ecm_pid, ecm_pid});
+    tsp->log(2, TS_CHECKED_FORMAT(u"got ECM (TID 0x%X) on PID %d (0x%X)", sect.tableId(), ecm_pid, ecm_pid));
 
     // Get ECM stream context
     auto ecm_it = _ecm_streams.find(ecm_pid);
     if (ecm_it == _ecm_streams.end()) {
-        tsp->warning(u"got ECM on non-ECM PID %d (0x%X)", {ecm_pid, ecm_pid});
+        tsp->warning(TS_CHECKED_FORMAT(u"got ECM on non-ECM PID %d (0x%X)", ecm_pid, ecm_pid));
         return;
     }
     ECMStreamPtr& estream(ecm_it->second);
@@ -297,7 +324,7 @@ void ts::AbstractDescrambler::handleSection(SectionDemux& demux, const Section&
         tsp->log(2, u"ECM not handled by subclass");
         return;
     }
-    tsp->debug(u"new ECM (TID 0x%X) on PID %d (0x%X)", {sect.tableId(), ecm_pid, ecm_pid});
+    tsp->debug(TS_CHECKED_FORMAT(u"new ECM (TID 0x%X) on PID %d (0x%X)", sect.tableId(), ecm_pid, ecm_pid));
 
     // In asynchronous mode, the CW are accessed under mutex protection.
     if (!_synchronous) {
@@ -344,19 +371,19 @@ void ts::AbstractDescrambler::processECM(ECMStream& estream)
 
     // Here, we have an ECM to decipher.
     const size_t dumpSize = std::min<size_t>(8, ecm.payloadSize());
-    tsp->debug(u"packet %d, decipher ECM, %d bytes: %s%s", {
+    tsp->debug(TS_CHECKED_FORMAT(u"packet %d, decipher ECM, %d bytes: %s%s",
                tsp->pluginPackets(),
                ecm.payloadSize(),
                UString::Dump(ecm.payload(), dumpSize, UString::SINGLE_LINE),
-               dumpSize < ecm.payloadSize() ? u" ..." : u""});
+               dumpSize < ecm.payloadSize() ? u" ..." : u""));
 
     // Submit the ECM to the CAS (subclass).
     // Exchange the control words if CW swapping was requested.
     bool ok = decipherECM(ecm, _swap_cw ? cw_odd : cw_even, _swap_cw ? cw_even : cw_odd);
 
     if (ok) {
-        tsp->debug(u"even CW: %s", {UString::Dump(cw_even.cw, UString::SINGLE_LINE)});
-        tsp->debug(u"odd CW:  %s", {UString::Dump(cw_odd.cw, UString::SINGLE_LINE)});
+        tsp->debug(TS_CHECKED_FORMAT(u"even CW: %s", UString::Dump(cw_even.cw, UString::SINGLE_LINE)));
+        tsp->debug(TS_CHECKED_FORMAT(u"odd CW:  %s", UString::Dump(cw_odd.cw, UString::SINGLE_LINE)));
     }
 
     // In asynchronous mode, relock the mutex.
@@ -446,18 +473,25 @@ void ts::AbstractDescrambler::ECMThread::main()
 
 
 //----------------------------------------------------------------------------
-// Packet processing method
+// Process signalization and control words for one packet.
 //----------------------------------------------------------------------------
 
-ts::ProcessorPlugin::Status ts::AbstractDescrambler::processPacket(TSPacket& pkt, TSPacketMetadata& pkt_data)
+bool ts::AbstractDescrambler::analyzePacket(TSPacket& pkt, ECMStreamPtr& pecm, bool& descramble)
 {
     const PID pid = pkt.getPID();
+    pecm.clear();
+    descramble = false;
+
+    // Get scrambling_control_value in packet.
+    uint8_t scv = pkt.getScrambling();
+    const bool scrambled = pkt.hasPayload() && (scv == SC_EVEN_KEY || scv == SC_ODD_KEY);
 
     // Descramble packets from fixed PID's using fixed control words.
     // If there is a user-specified list of PID's, we don't manage a service
     // and there is nothing else to do.
     if (_pids.any()) {
-        return !_pids.test(pid) || _scrambling.decrypt(pkt) ? TSP_OK : TSP_END;
+        descramble = scrambled && _pids.test(pid);
+        return true;
     }
 
     // Filter sections to locate the service and grab ECM's.
@@ -466,32 +500,29 @@ ts::ProcessorPlugin::Status ts::AbstractDescrambler::processPacket(TSPacket& pkt
 
     // If the service is definitely unknown or a fatal error occured during table analysis, give up.
     if (_abort || _service.nonExistentService()) {
-        return TSP_END;
+        return false;
     }
 
-    // Get scrambling_control_value in packet.
-    uint8_t scv = pkt.getScrambling();
-
     // If the packet has no payload or is clear, there is nothing to descramble.
-    if (!pkt.hasPayload() || (scv != SC_EVEN_KEY && scv != SC_ODD_KEY)) {
-        return TSP_OK;
+    if (!scrambled) {
+        return true;
     }
 
     // Without ECM's, we descramble using fixed control words.
     if (!_need_ecm) {
-        return _scrambling.decrypt(pkt) ? TSP_OK : TSP_END;
+        descramble = true;
+        return true;
     }
 
     // Get PID context. If the PID is not known as a scrambled PID,
     // with a corresponding ECM stream, we cannot descramble it.
     auto ssit = _scrambled_streams.find(pid);
     if (ssit == _scrambled_streams.end()) {
-        return TSP_OK;
+        return true;
     }
     ScrambledStream& ss(ssit->second);
 
     // Locate an ECM stream with a currently valid pair of CW.
-    ECMStreamPtr pecm;
     for (auto it = ss.ecm_pids.begin(); pecm.isNull() && it != ss.ecm_pids.end(); ++it) {
         pecm = getOrCreateECMStream(*it);
         // Flag cw_valid is "write-protected, read-volatile", no mutex needed.
@@ -501,7 +532,7 @@ ts::ProcessorPlugin::Status ts::AbstractDescrambler::processPacket(TSPacket& pkt
     }
     if (pecm.isNull()) {
         // No ECM stream has valid Control Word now, cannot descramble
-        return TSP_OK;
+        return true;
     }
 
     // We found a valid CW, check if new CW were deciphered and store them in the descrambler.
@@ -529,8 +560,256 @@ ts::ProcessorPlugin::Status ts::AbstractDescrambler::processPacket(TSPacket& pkt
         if (!_synchronous) {
             _mutex.release();
         }
+
+        // The current key generation of this ECM stream is obsolete.
+        pecm->keys.clear();
+    }
+
+    descramble = true;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Packet window processing. The packets are descrambled by batches, in the
+// plugin thread or in several descrambling threads.
+//----------------------------------------------------------------------------
+
+size_t ts::AbstractDescrambler::getPacketWindowSize()
+{
+    return _window_size;
+}
+
+size_t ts::AbstractDescrambler::processPacketWindow(TSPacketWindow& win)
+{
+    size_t end = win.size();
+    _jobs.clear();
+    _window_keys.clear();
+
+    // First pass, in stream order: process the signalization and the ECM's and
+    // associate each packet to descramble with the key generation it shall use.
+    for (size_t index = 0; index < win.size(); ++index) {
+        TSPacket* pkt = win.packet(index);
+        ECMStreamPtr pecm;
+        bool descramble = false;
+        if (pkt == nullptr) {
+            continue; // dropped packet
+        }
+        if (!analyzePacket(*pkt, pecm, descramble)) {
+            end = index;
+            break;
+        }
+        if (descramble) {
+            KeyGenerationPtr keys;
+            if (!pecm.isNull()) {
+                // Control words from ECM's.
+                if (pecm->keys.isNull()) {
+                    pecm->keys = newKeyGeneration(pecm->scrambling);
+                }
+                keys = pecm->keys;
+            }
+            else {
+                // Fixed control words, the next one is used each time the parity changes.
+                const uint8_t scv = pkt->getScrambling();
+                if (_fixed_keys.isNull() || scv != _fixed_scv) {
+                    if (!_scrambling.setDecryptParity(scv)) {
+                        end = index;
+                        break;
+                    }
+                    _fixed_scv = scv;
+                    _fixed_keys = newKeyGeneration(_scrambling);
+                }
+                keys = _fixed_keys;
+            }
+            if (_window_keys.empty() || _window_keys.back() != keys) {
+                _window_keys.push_back(keys);
+            }
+            _jobs.push_back({index, pkt, keys.pointer()});
+        }
+    }
+
+    // Second pass: decrypt the packets, inline or using the descrambling threads.
+    if (!_decryptor.isNull()) {
+        end = std::min(end, _decryptor->decrypt(0, _jobs.size()));
     }
+    else if (!_jobs.empty()) {
+        {
+            GuardMutex lock(_jobs_mutex);
+            ++_window_seq;
+            _pending_threads = _decrypt_threads.size();
+            _error_index = NPOS;
+            for (const auto& thread : _decrypt_threads) {
+                thread->start_work.signal();
+            }
+        }
+        GuardCondition lock(_jobs_mutex, _jobs_done);
+        while (_pending_threads > 0) {
+            lock.waitCondition();
+        }
+        end = std::min(end, _error_index);
+    }
+
+    return end;
+}
+
+
+//----------------------------------------------------------------------------
+// Build a new key generation from the current control words.
+//----------------------------------------------------------------------------
+
+ts::AbstractDescrambler::KeyGenerationPtr ts::AbstractDescrambler::newKeyGeneration(TSScrambling& engine)
+{
+    KeyGenerationPtr keys(new KeyGeneration);
+    keys->id = ++_last_key_id;
+    keys->scrambling = engine.scramblingType();
+    engine.getCW(keys->cw[0], SC_EVEN_KEY);
+    engine.getCW(keys->cw[1], SC_ODD_KEY);
+    return keys;
+}
+
 
-    // Descramble the packet payload.
-    return pecm->scrambling.decrypt(pkt) ? TSP_OK : TSP_END;
+//----------------------------------------------------------------------------
+// Start and stop the descrambling threads.
+//----------------------------------------------------------------------------
+
+void ts::AbstractDescrambler::startDecryptThreads()
+{
+    _decryptor.clear();
+    _decrypt_threads.clear();
+    _window_seq = 0;
+    _pending_threads = 0;
+    _stop_decrypt = false;
+    for (size_t i = 0; i < _thread_count; ++i) {
+        _decrypt_threads.push_back(new DecryptThread(this, i));
+        _decrypt_threads.back()->start();
+    }
+    if (_thread_count == 0) {
+        _decryptor = new Decryptor(this);
+    }
+}
+
+void ts::AbstractDescrambler::stopDecryptThreads()
+{
+    if (!_decrypt_threads.empty()) {
+        {
+            GuardMutex lock(_jobs_mutex);
+            _stop_decrypt = true;
+            for (const auto& thread : _decrypt_threads) {
+                thread->start_work.signal();
+            }
+        }
+        for (const auto& thread : _decrypt_threads) {
+            thread->waitForTermination();
+        }
+        _decrypt_threads.clear();
+    }
+    _decryptor.clear();
+    _jobs.clear();
+    _window_keys.clear();
+}
+
+
+//----------------------------------------------------------------------------
+// Descrambling of the packets of a packet window.
+//----------------------------------------------------------------------------
+
+ts::AbstractDescrambler::Decryptor::Engine::Engine(const TSScrambling& scrambling, const KeyGeneration& keys) :
+    engine(scrambling)
+{
+    // The control words are provided by the key generation, never from the command line.
+    engine.clearFixedCW();
+    engine.setScramblingType(keys.scrambling);
+    // An unset control word must not leave the one of a previous generation in the engine.
+    for (int parity = 0; parity < 2; ++parity) {
+        cw_set[parity] = !keys.cw[parity].empty() && engine.setCW(keys.cw[parity], parity);
+    }
+}
+
+size_t ts::AbstractDescrambler::Decryptor::decrypt(size_t first, size_t last)
+{
+    // Group the jobs by key generation, create the engines of new key generations.
+    for (auto& it : _engines) {
+        it.second->jobs.clear();
+    }
+    for (size_t i = first; i < last; ++i) {
+        const DecryptJob& job(_parent->_jobs[i]);
+        EnginePtr& eng(_engines[job.keys->id]);
+        if (eng.isNull()) {
+            eng = new Engine(_parent->_scrambling, *job.keys);
+        }
+        eng->jobs.push_back(&job);
+    }
+
+    // Descramble all packets of each key generation at once.
+    size_t error = NPOS;
+    for (auto it = _engines.begin(); it != _engines.end(); ) {
+        Engine& eng(*it->second);
+        if (eng.jobs.empty()) {
+            // This key generation is no longer used.
+            it = _engines.erase(it);
+            continue;
+        }
+        eng.packets.clear();
+        for (auto job : eng.jobs) {
+            const uint8_t scv = job->packet->getScrambling();
+            if ((scv == SC_EVEN_KEY || scv == SC_ODD_KEY) && !eng.cw_set[scv & 1]) {
+                // The decryption fails without key.
+                _parent->tsp->error(TS_CHECKED_FORMAT(u"no %s control word to descramble packet", scv == SC_EVEN_KEY ? u"even" : u"odd"));
+                error = std::min(error, job->index);
+                break;
+            }
+            eng.packets.push_back(job->packet);
+        }
+        if (!eng.engine.decrypt(eng.packets.data(), eng.packets.size())) {
+            error = std::min(error, eng.jobs.front()->index);
+        }
+        ++it;
+    }
+    return error;
+}
+
+
+//----------------------------------------------------------------------------
+// Descrambling thread.
+//----------------------------------------------------------------------------
+
+ts::AbstractDescrambler::DecryptThread::DecryptThread(AbstractDescrambler* parent, size_t index) :
+    _parent(parent),
+    _index(index),
+    _decryptor(parent)
+{
+}
+
+void ts::AbstractDescrambler::DecryptThread::main()
+{
+    uint64_t window_seq = 0;
+
+    // The loop executes with the mutex held. The mutex is released while
+    // descrambling packets and while waiting for the condition 'start_work'.
+    GuardCondition lock(_parent->_jobs_mutex, start_work);
+
+    while (!_parent->_stop_decrypt) {
+        if (_parent->_window_seq == window_seq) {
+            lock.waitCondition();
+            continue;
+        }
+        window_seq = _parent->_window_seq;
+
+        // Each thread processes a contiguous range of jobs. The job list is not
+        // modified by the plugin thread until all threads complete the window.
+        const size_t count = _parent->_jobs.size();
+        const size_t threads = _parent->_decrypt_threads.size();
+        const size_t first = count * _index / threads;
+        const size_t last = count * (_index + 1) / threads;
+
+        _parent->_jobs_mutex.release();
+        const size_t error = _decryptor.decrypt(first, last);
+        _parent->_jobs_mutex.acquire();
+
+        // Report completion of this window.
+        _parent->_error_index = std::min(_parent->_error_index, error);
+        if (--_parent->_pending_threads == 0) {
+            _parent->_jobs_done.signal();
+        }
+    }
 }
@@ -40,7 +40,8 @@ namespace ts {
         virtual bool getOptions() override;
         virtual bool start() override;
         virtual bool stop() override;
-        virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+        virtual size_t getPacketWindowSize() override;
+        virtual size_t processPacketWindow(TSPacketWindow&) override;
 
     protected:
         //!
@@ -49,6 +50,11 @@ namespace ts {
         //!
         static constexpr size_t DEFAULT_ECM_THREAD_STACK_USAGE = 128 * 1024;
 
+        //!
+        //! Default number of packets in a packet window.
+        //!
+        static constexpr size_t DEFAULT_PACKET_WINDOW = 512;
+
         //!
         //! Constructor for subclasses.
         //! @param [in] tsp Object to communicate with the Transport Stream Processor main executable.
@@ -186,6 +192,18 @@ namespace ts {
         // Map of scrambled streams in the service, indexed by PID.
         typedef std::map<PID, ScrambledStream> ScrambledStreamMap;
 
+        // Snapshot of the control words which apply to a range of packets ("key generation").
+        // A new generation is created each time a control word changes. Descrambling threads
+        // compare the generation id of each packet with the one they last loaded.
+        class KeyGeneration
+        {
+        public:
+            uint64_t  id = 0;                           // Unique id of this generation.
+            uint8_t   scrambling = SCRAMBLING_DVB_CSA2; // Scrambling type.
+            ByteBlock cw[2];                            // Even and odd control words, empty if unset.
+        };
+        typedef SafePtr<KeyGeneration, NullMutex> KeyGenerationPtr;
+
         // Description of an ECM stream
         class ECMStream
         {
@@ -206,6 +224,7 @@ namespace ts {
             CWData        cw_even {};           // Last valid CW (even)
             CWData        cw_odd {};            // Last valid CW (odd)
             // -- end of protected area --
+            KeyGenerationPtr keys {};           // Current key generation in packet window mode, null if to be rebuilt.
         };
 
         typedef SafePtr<ECMStream, NullMutex> ECMStreamPtr;
@@ -227,9 +246,84 @@ namespace ts {
             AbstractDescrambler* _parent;
         };
 
+        // A packet to descramble in a packet window, with its key generation.
+        class DecryptJob
+        {
+        public:
+            size_t         index;  // Index in packet window.
+            TSPacket*      packet; // Packet to descramble.
+            KeyGeneration* keys;   // Key generation to use (kept alive by _window_keys).
+        };
+
+        // Descrambling of the packets of a packet window, using private engines.
+        // The jobs are grouped by key generation. Each key generation keeps its own
+        // engine, its control words are loaded once, even when several ECM streams
+        // are interleaved. All packets of a key generation are descrambled as one batch.
+        class Decryptor
+        {
+            TS_NOBUILD_NOCOPY(Decryptor);
+        public:
+            // Constructor.
+            Decryptor(AbstractDescrambler* parent) : _parent(parent) {}
+
+            // Descramble a range of jobs. Return the window index of the first packet in error or NPOS.
+            size_t decrypt(size_t first, size_t last);
+
+        private:
+            // Descrambling engine of a key generation.
+            class Engine
+            {
+                TS_NOBUILD_NOCOPY(Engine);
+            public:
+                Engine(const TSScrambling& scrambling, const KeyGeneration& keys);
+                TSScrambling           engine;                // Private descrambling engine.
+                bool                   cw_set[2] {false, false};  // Even and odd control words are loaded in engine.
+                std::vector<const DecryptJob*> jobs {};       // Jobs of this key generation in the current range.
+                std::vector<TSPacket*> packets {};            // Packets to descramble at once.
+            };
+            typedef SafePtr<Engine, NullMutex> EnginePtr;
+
+            AbstractDescrambler*        _parent;
+            std::map<uint64_t, EnginePtr> _engines {};  // Engines of the key generations in use, indexed by id.
+        };
+        typedef SafePtr<Decryptor, NullMutex> DecryptorPtr;
+
+        // Descrambling thread, in packet window mode.
+        class DecryptThread : public Thread
+        {
+            TS_NOBUILD_NOCOPY(DecryptThread);
+        public:
+            // Constructor.
+            DecryptThread(AbstractDescrambler* parent, size_t index);
+
+            // Work notification, use with parent mutex.
+            Condition start_work {};
+
+        private:
+            AbstractDescrambler* _parent;
+            size_t               _index;      // Index of this thread in the pool.
+            Decryptor            _decryptor;  // Descrambling of the jobs of this thread.
+
+            // Thread entry point.
+            virtual void main() override;
+        };
+        typedef SafePtr<DecryptThread, NullMutex> DecryptThreadPtr;
+
         // Get the ECM stream for a PID, create it if non existent
         ECMStreamPtr getOrCreateECMStream(PID);
 
+        // Process signalization and control words for one packet, without descrambling it.
+        // Return false on fatal error. Set 'descramble' when the packet must be descrambled,
+        // using the scrambling engine of 'pecm' (or the default one when 'pecm' is null).
+        bool analyzePacket(TSPacket& pkt, ECMStreamPtr& pecm, bool& descramble);
+
+        // Build a new key generation from the current control words of a scrambling engine.
+        KeyGenerationPtr newKeyGeneration(TSScrambling&);
+
+        // Start and stop descrambling threads.
+        void startDecryptThreads();
+        void stopDecryptThreads();
+
         // Process one ECM (the one in ECMStream::ecm).
         // In asynchronous mode, this method must be invoked with the mutex held. The method
         // releases the mutex while deciphering the ECM and relocks it before exiting.
@@ -257,5 +351,24 @@ namespace ts {
         // -- start of protected area --
         bool               _stop_thread = false;  // Terminate ECM processing thread
         // -- end of protected area --
+
+        // Packet window mode, descrambling in the plugin thread or in several descrambling threads.
+        size_t                        _thread_count = 0;     // Number of descrambling threads, zero means descramble inline.
+        size_t                        _window_size = DEFAULT_PACKET_WINDOW;
+        uint64_t                      _last_key_id = 0;      // Last allocated key generation id.
+        uint8_t                       _fixed_scv = SC_CLEAR; // Last scrambling control value with fixed control words.
+        KeyGenerationPtr              _fixed_keys {};        // Current key generation with fixed control words.
+        std::vector<KeyGenerationPtr> _window_keys {};       // Key generations which are used in current window.
+        std::vector<DecryptJob>       _jobs {};              // Packets to descramble in current window.
+        DecryptorPtr                  _decryptor {};         // Inline descrambling, without descrambling threads.
+        std::vector<DecryptThreadPtr> _decrypt_threads {};   // Pool of descrambling threads.
+        Mutex                         _jobs_mutex {};        // Exclusive access to protected area.
+        Condition                     _jobs_done {};         // Notify that all threads completed their jobs.
+        // -- start of protected area --
+        uint64_t                      _window_seq = 0;       // Sequence number of packet window to process.
+        size_t                        _pending_threads = 0;  // Number of threads which did not complete the window.
+        size_t                        _error_index = NPOS;   // Window index of first packet in error.
+        bool                          _stop_decrypt = false; // Terminate descrambling threads.
+        // -- end of protected area --
     };
 }
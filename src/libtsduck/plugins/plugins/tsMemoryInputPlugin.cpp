@@ -9,9 +9,14 @@
 #include "tsMemoryInputPlugin.h"
 #include "tsPluginRepository.h"
 #include "tsPluginEventData.h"
+#include "tsGuardMutex.h"
+#include "tsSysUtils.h"
 
 TS_REGISTER_INPUT_PLUGIN(u"memory", ts::MemoryInputPlugin);
 
+// Polling interval to check abort conditions while waiting for packets in a ring.
+#define RING_POLL_TIMEOUT 100
+
 
 //----------------------------------------------------------------------------
 // Constructor
@@ -30,6 +35,15 @@ ts::MemoryInputPlugin::MemoryInputPlugin(TSP* tsp_) :
          u"The event data is an instance of PluginEventData pointing to the input buffer. "
          u"The application shall handle the event, waiting for input packets as long as necessary. "
          u"Returning zero packet (or not handling the event) means end if input.");
+
+    option(u"ring", 'r', STRING);
+    help(u"ring", u"name",
+         u"Read the input packets from the memory ring with the specified name. "
+         u"The application shall create a MemoryPacketRing with that name, before or after the start of the plugin. "
+         u"The application directly writes packets and metadata into the ring, without callback. "
+         u"The plugin copies them from the ring into the tsp buffer. "
+         u"The input ends when the application signals the end of stream or aborts the ring. "
+         u"When this option is specified, --event-code is ignored.");
 }
 
 
@@ -40,9 +54,67 @@ ts::MemoryInputPlugin::MemoryInputPlugin(TSP* tsp_) :
 bool ts::MemoryInputPlugin::getOptions()
 {
     getIntValue(_event_code, u"event-code");
+    getValue(_ring_name, u"ring");
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Start / stop methods.
+//----------------------------------------------------------------------------
+
+bool ts::MemoryInputPlugin::start()
+{
+    // The ring is searched when the first packets are needed.
+    GuardMutex lock(_mutex);
+    _ring.clear();
+    _aborted = false;
+    return true;
+}
+
+bool ts::MemoryInputPlugin::stop()
+{
+    GuardMutex lock(_mutex);
+    _ring.clear();
     return true;
 }
 
+bool ts::MemoryInputPlugin::abortInput()
+{
+    GuardMutex lock(_mutex);
+    _aborted = true;
+    if (!_ring.isNull()) {
+        _ring->abort();
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Get the ring, wait until the application creates it.
+//----------------------------------------------------------------------------
+
+ts::MemoryPacketRingPtr ts::MemoryInputPlugin::getRing()
+{
+    bool waiting = false;
+    for (;;) {
+        {
+            GuardMutex lock(_mutex);
+            if (_ring.isNull() && !_aborted) {
+                _ring = MemoryPacketRing::Find(_ring_name);
+            }
+            if (!_ring.isNull() || _aborted || tsp->aborting()) {
+                return _ring;
+            }
+        }
+        if (!waiting) {
+            verbose(u"waiting for memory ring \"%s\"", {_ring_name});
+            waiting = true;
+        }
+        SleepThread(RING_POLL_TIMEOUT);
+    }
+}
+
 
 //----------------------------------------------------------------------------
 // Receive packets method.
@@ -50,6 +122,16 @@ bool ts::MemoryInputPlugin::getOptions()
 
 size_t ts::MemoryInputPlugin::receive(TSPacket* buffer, TSPacketMetadata* metadata, size_t max_packets)
 {
+    if (!_ring_name.empty()) {
+        // Read packets from the ring, checking abort from time to time.
+        const MemoryPacketRingPtr ring(getRing());
+        size_t count = 0;
+        while (count == 0 && !ring.isNull() && !ring->endOfStream() && !ring->aborted() && !tsp->aborting()) {
+            count = ring->read(buffer, metadata, max_packets, RING_POLL_TIMEOUT);
+        }
+        return count;
+    }
+
     // Prepare an event data block pointing to the input buffer.
     PluginEventData data(buffer->b, 0, PKT_SIZE * max_packets);
     tsp->signalPluginEvent(_event_code, &data);
@@ -13,6 +13,7 @@
 
 #pragma once
 #include "tsInputPlugin.h"
+#include "tsMemoryPacketRing.h"
 
 namespace ts {
     //!
@@ -25,9 +26,19 @@ namespace ts {
     public:
         // Implementation of plugin API
         virtual bool getOptions() override;
+        virtual bool start() override;
+        virtual bool stop() override;
+        virtual bool abortInput() override;
         virtual size_t receive(TSPacket*, TSPacketMetadata*, size_t) override;
 
     private:
-        uint32_t _event_code = 0;
+        uint32_t            _event_code = 0;
+        UString             _ring_name {};
+        Mutex               _mutex {};          // Protect _ring and _aborted, used by abortInput().
+        MemoryPacketRingPtr _ring {};
+        bool                _aborted = false;
+
+        // Get the ring, wait until the application creates it. Return null when aborted.
+        MemoryPacketRingPtr getRing();
     };
 }
@@ -9,9 +9,13 @@
 #include "tsMemoryOutputPlugin.h"
 #include "tsPluginRepository.h"
 #include "tsPluginEventData.h"
+#include "tsSysUtils.h"
 
 TS_REGISTER_OUTPUT_PLUGIN(u"memory", ts::MemoryOutputPlugin);
 
+// Polling interval to check abort conditions while waiting for free space in a ring.
+#define RING_POLL_TIMEOUT 100
+
 
 //----------------------------------------------------------------------------
 // Constructor
@@ -29,6 +33,16 @@ ts::MemoryOutputPlugin::MemoryOutputPlugin(TSP* tsp_) :
          u"Signal a plugin event with the specified code each time the plugin output packets. "
          u"The event data is an instance of PluginEventData pointing to the output packets. "
          u"If an event handler sets the error indicator in the event data, the transmission is aborted.");
+
+    option(u"ring", 'r', STRING);
+    help(u"ring", u"name",
+         u"Write the output packets into the memory ring with the specified name. "
+         u"The application shall create a MemoryPacketRing with that name, before or after the start of the plugin. "
+         u"The plugin copies the packets from the tsp buffer into the ring. "
+         u"The application directly reads packets and metadata from the ring, without callback. "
+         u"The end of stream is signaled in the ring when the plugin stops. "
+         u"If the application aborts the ring, the transmission is aborted. "
+         u"When this option is specified, --event-code is ignored.");
 }
 
 
@@ -39,6 +53,32 @@ ts::MemoryOutputPlugin::MemoryOutputPlugin(TSP* tsp_) :
 bool ts::MemoryOutputPlugin::getOptions()
 {
     getIntValue(_event_code, u"event-code");
+    getValue(_ring_name, u"ring");
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Start / stop methods.
+//----------------------------------------------------------------------------
+
+bool ts::MemoryOutputPlugin::start()
+{
+    // The ring is searched when the first packets are sent.
+    _ring.clear();
+    return true;
+}
+
+bool ts::MemoryOutputPlugin::stop()
+{
+    // Signal the end of stream, even if no packet was sent.
+    if (_ring.isNull() && !_ring_name.empty()) {
+        _ring = MemoryPacketRing::Find(_ring_name);
+    }
+    if (!_ring.isNull()) {
+        _ring->setEndOfStream();
+        _ring.clear();
+    }
     return true;
 }
 
@@ -49,6 +89,27 @@ bool ts::MemoryOutputPlugin::getOptions()
 
 bool ts::MemoryOutputPlugin::send(const TSPacket* packets, const TSPacketMetadata* metadata, size_t packet_count)
 {
+    if (!_ring_name.empty()) {
+        // Wait until the application creates the ring.
+        bool waiting = false;
+        while (_ring.isNull() && !tsp->aborting()) {
+            _ring = MemoryPacketRing::Find(_ring_name);
+            if (_ring.isNull()) {
+                if (!waiting) {
+                    verbose(u"waiting for memory ring \"%s\"", {_ring_name});
+                    waiting = true;
+                }
+                SleepThread(RING_POLL_TIMEOUT);
+            }
+        }
+        // Write packets into the ring, checking abort from time to time.
+        size_t count = 0;
+        while (count < packet_count && !_ring.isNull() && !_ring->aborted() && !tsp->aborting()) {
+            count += _ring->write(packets + count, metadata + count, packet_count - count, RING_POLL_TIMEOUT);
+        }
+        return count == packet_count;
+    }
+
     // Prepare an event data block pointing to the output packets.
     PluginEventData data(packets->b, PKT_SIZE * packet_count);
     tsp->signalPluginEvent(_event_code, &data);
@@ -13,6 +13,7 @@
 
 #pragma once
 #include "tsOutputPlugin.h"
+#include "tsMemoryPacketRing.h"
 
 namespace ts {
     //!
@@ -25,9 +26,13 @@ namespace ts {
     public:
         // Implementation of plugin API
         virtual bool getOptions() override;
+        virtual bool start() override;
+        virtual bool stop() override;
         virtual bool send(const TSPacket*, const TSPacketMetadata*, size_t) override;
 
     private:
-        uint32_t _event_code = 0;
+        uint32_t            _event_code = 0;
+        UString             _ring_name {};
+        MemoryPacketRingPtr _ring {};
     };
 }
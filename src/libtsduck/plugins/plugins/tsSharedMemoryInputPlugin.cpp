@@ -0,0 +1,90 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+
+#include "tsSharedMemoryInputPlugin.h"
+#include "tsPluginRepository.h"
+
+TS_REGISTER_INPUT_PLUGIN(u"shm", ts::SharedMemoryInputPlugin);
+
+
+//----------------------------------------------------------------------------
+// Constructor
+//----------------------------------------------------------------------------
+
+ts::SharedMemoryInputPlugin::SharedMemoryInputPlugin(TSP* tsp_) :
+    InputPlugin(tsp_, u"Receive packets from another tsp process through shared memory", u"[options] name")
+{
+    setIntro(u"The input packets are read from a ring buffer in shared memory which is written "
+             u"by another tsp process on the same system, using the output plugin 'shm'. "
+             u"Several tsp processes can read the same ring simultaneously. "
+             u"The input starts with the current packets in the ring. "
+             u"The input ends when the writer process terminates. "
+             u"This plugin is implemented on UNIX systems only.");
+
+    option(u"", 0, STRING, 1, 1);
+    help(u"", u"Name of the shared memory ring, as specified in the 'shm' output plugin of the writer process.");
+
+    option(u"timeout", 't', UNSIGNED);
+    help(u"timeout", u"milliseconds",
+         u"Maximum time to wait for the creation of the shared memory ring by the writer process. "
+         u"The default is to wait forever.");
+}
+
+
+//----------------------------------------------------------------------------
+// Get command line options.
+//----------------------------------------------------------------------------
+
+bool ts::SharedMemoryInputPlugin::getOptions()
+{
+    getValue(_name, u"");
+    getIntValue(_timeout, u"timeout", Infinite);
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Start / stop methods.
+//----------------------------------------------------------------------------
+
+bool ts::SharedMemoryInputPlugin::start()
+{
+    _aborted = false;
+    return _ring.open(_name, _timeout, *tsp, this);
+}
+
+bool ts::SharedMemoryInputPlugin::stop()
+{
+    if (_ring.lostPackets() > 0) {
+        warning(u"lost %'d packets, reader too slow", {_ring.lostPackets()});
+    }
+    _ring.close();
+    return true;
+}
+
+bool ts::SharedMemoryInputPlugin::abortInput()
+{
+    // The ring is polled, the abort condition is checked while waiting.
+    _aborted = true;
+    return true;
+}
+
+bool ts::SharedMemoryInputPlugin::aborting() const
+{
+    return _aborted || tsp->aborting();
+}
+
+
+//----------------------------------------------------------------------------
+// Input method.
+//----------------------------------------------------------------------------
+
+size_t ts::SharedMemoryInputPlugin::receive(TSPacket* buffer, TSPacketMetadata* pkt_data, size_t max_packets)
+{
+    return _ring.read(buffer, pkt_data, max_packets, *tsp, this);
+}
@@ -0,0 +1,43 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Shared memory input plugin for tsp.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsInputPlugin.h"
+#include "tsSharedPacketRing.h"
+
+namespace ts {
+    //!
+    //! Shared memory input plugin for tsp.
+    //! @ingroup plugin
+    //!
+    class TSDUCKDLL SharedMemoryInputPlugin: public InputPlugin, private AbortInterface
+    {
+        TS_PLUGIN_CONSTRUCTORS(SharedMemoryInputPlugin);
+    public:
+        // Implementation of plugin API
+        virtual bool getOptions() override;
+        virtual bool start() override;
+        virtual bool stop() override;
+        virtual bool abortInput() override;
+        virtual size_t receive(TSPacket*, TSPacketMetadata*, size_t) override;
+
+    private:
+        UString           _name {};
+        MilliSecond       _timeout = 0;
+        SharedPacketRing  _ring {};
+        std::atomic<bool> _aborted {false};
+
+        // Implementation of AbortInterface, interrupt the wait for packets.
+        virtual bool aborting() const override;
+    };
+}
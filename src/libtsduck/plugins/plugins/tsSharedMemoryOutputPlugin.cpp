@@ -0,0 +1,106 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+
+#include "tsSharedMemoryOutputPlugin.h"
+#include "tsPluginRepository.h"
+
+TS_REGISTER_OUTPUT_PLUGIN(u"shm", ts::SharedMemoryOutputPlugin);
+
+
+//----------------------------------------------------------------------------
+// Constructor
+//----------------------------------------------------------------------------
+
+ts::SharedMemoryOutputPlugin::SharedMemoryOutputPlugin(TSP* tsp_) :
+    OutputPlugin(tsp_, u"Send packets to other tsp processes through shared memory", u"[options] name")
+{
+    setIntro(u"The output packets are written once in a ring buffer in shared memory. "
+             u"Several other tsp processes on the same system read the same packets, "
+             u"using the input plugin 'shm' with the same name. "
+             u"The packet metadata (timestamps, labels) are also transmitted. "
+             u"This plugin is implemented on UNIX systems only.");
+
+    option(u"", 0, STRING, 1, 1);
+    help(u"",
+         u"Name of the shared memory ring. "
+         u"It shall be a simple name, without slash. "
+         u"The same name shall be used in the 'shm' input plugin of the reader processes.");
+
+    option(u"access", 0, Enumeration({
+        {u"user",  0600},
+        {u"group", 0660},
+        {u"all",   0666},
+    }));
+    help(u"access",
+         u"Processes which are allowed to read the shared memory ring. "
+         u"With 'user', only the processes of the same user can read it. "
+         u"With 'group', the processes of the same group can also read it. "
+         u"With 'all', all processes on the system can read it. "
+         u"The default is 'user'.");
+
+    option(u"max-readers", 'm', POSITIVE);
+    help(u"max-readers",
+         u"Maximum number of simultaneous reader processes. "
+         u"The default is " + UString::Decimal(SharedPacketRing::DEFAULT_MAX_READERS) + u".");
+
+    option(u"packets", 'p', POSITIVE);
+    help(u"packets",
+         u"Capacity of the shared memory ring in TS packets. "
+         u"The default is " + UString::Decimal(SharedPacketRing::DEFAULT_PACKET_COUNT) + u" packets.");
+
+    option(u"policy", 0, Enumeration({
+        {u"drop",  int(SharedPacketRing::LagPolicy::DROP)},
+        {u"block", int(SharedPacketRing::LagPolicy::BLOCK)},
+    }));
+    help(u"policy",
+         u"Policy when a reader process is too slow. "
+         u"With 'drop', the output never waits and the slow readers lose packets. "
+         u"With 'block', the output waits for the slowest reader. "
+         u"The default is 'drop'.");
+}
+
+
+//----------------------------------------------------------------------------
+// Get command line options.
+//----------------------------------------------------------------------------
+
+bool ts::SharedMemoryOutputPlugin::getOptions()
+{
+    getValue(_name, u"");
+    getIntValue(_packet_count, u"packets", SharedPacketRing::DEFAULT_PACKET_COUNT);
+    getIntValue(_max_readers, u"max-readers", SharedPacketRing::DEFAULT_MAX_READERS);
+    getIntValue(_policy, u"policy", SharedPacketRing::LagPolicy::DROP);
+    getIntValue(_access_mode, u"access", SharedPacketRing::DEFAULT_ACCESS_MODE);
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Start / stop methods.
+//----------------------------------------------------------------------------
+
+bool ts::SharedMemoryOutputPlugin::start()
+{
+    return _ring.create(_name, _packet_count, _max_readers, _policy, *tsp, _access_mode);
+}
+
+bool ts::SharedMemoryOutputPlugin::stop()
+{
+    _ring.close();
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Send packets method.
+//----------------------------------------------------------------------------
+
+bool ts::SharedMemoryOutputPlugin::send(const TSPacket* packets, const TSPacketMetadata* metadata, size_t packet_count)
+{
+    return _ring.write(packets, metadata, packet_count, *tsp, tsp);
+}
@@ -0,0 +1,41 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Shared memory output plugin for tsp.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsOutputPlugin.h"
+#include "tsSharedPacketRing.h"
+
+namespace ts {
+    //!
+    //! Shared memory output plugin for tsp.
+    //! @ingroup plugin
+    //!
+    class TSDUCKDLL SharedMemoryOutputPlugin: public OutputPlugin
+    {
+        TS_PLUGIN_CONSTRUCTORS(SharedMemoryOutputPlugin);
+    public:
+        // Implementation of plugin API
+        virtual bool getOptions() override;
+        virtual bool start() override;
+        virtual bool stop() override;
+        virtual bool send(const TSPacket*, const TSPacketMetadata*, size_t) override;
+
+    private:
+        UString                     _name {};
+        size_t                      _packet_count = 0;
+        size_t                      _max_readers = 0;
+        SharedPacketRing::LagPolicy _policy = SharedPacketRing::LagPolicy::DROP;
+        uint32_t                    _access_mode = SharedPacketRing::DEFAULT_ACCESS_MODE;
+        SharedPacketRing            _ring {};
+    };
+}
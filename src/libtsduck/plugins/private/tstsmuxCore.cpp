@@ -16,6 +16,10 @@
 #include "tsTOT.h"
 #include "tsEIT.h"
 
+#if !defined(TS_CXX17)
+constexpr size_t ts::tsmux::Core::Input::BATCH_PACKETS;
+#endif
+
 
 //----------------------------------------------------------------------------
 // Constructor and destructor.
@@ -415,30 +419,19 @@ ts::tsmux::Core::Input::Input(Core& core, size_t index) :
     _got_ts_id(false),
     _ts_id(0),
     _input(_core._opt, core._handlers, index, _core._log),
-    _demux(_core._duck, this, nullptr),
-    _eit_demux(_core._duck, nullptr, this),
     _pcr_merger(_core._duck),
     _nit(),
     _next_insertion(0),
     _next_packet(),
     _next_metadata(),
-    _pid_clocks()
+    _pid_clocks(),
+    _batch_packets(BATCH_PACKETS),
+    _batch_metadata(BATCH_PACKETS),
+    _batch_count(0),
+    _batch_next(0),
+    _batch_index(0),
+    _signalization()
 {
-    // Filter all global PSI/SI for merging in output PSI.
-    _demux.addPID(PID_PAT);
-    _demux.addPID(PID_CAT);
-    if (_core._opt.nitScope != TableScope::NONE) {
-        _demux.addPID(PID_NIT);
-    }
-    if (_core._opt.sdtScope != TableScope::NONE) {
-        _demux.addPID(PID_SDT);
-    }
-
-    // Filter EIT sections one by one if the output stream shall contain EIT's.
-    if (_core._opt.eitScope != TableScope::NONE) {
-        _eit_demux.addPID(PID_EIT);
-    }
-
     // Always reset PCR progression when moving ahead of PTS or DTS.
     _pcr_merger.setResetBackwards(true);
 
@@ -470,17 +463,32 @@ bool ts::tsmux::Core::Input::getPacket(TSPacket& pkt, TSPacketMetadata& pkt_data
         }
     }
 
-    // Get one packet from the input executor thread, non-blocking.
-    size_t ret_count = 0;
-    _terminated = _terminated || !_input.getPackets(&pkt, &pkt_data, 1, ret_count, false);
-    if (_terminated || ret_count == 0) {
-        return false;
+    // Get a batch of packets from the input executor thread, non-blocking.
+    if (_batch_next >= _batch_count) {
+        _batch_next = _batch_count = 0;
+        _terminated = _terminated || !_input.getPackets(&_batch_packets[0], &_batch_metadata[0], _batch_packets.size(), _batch_count, _batch_index, _signalization, false);
+        if (_terminated || _batch_count == 0) {
+            return false;
+        }
     }
+
+    // Get next packet from the batch.
+    const PacketCounter index = _batch_index + _batch_next;
+    pkt = _batch_packets[_batch_next];
+    pkt_data = _batch_metadata[_batch_next++];
     const PID pid = pkt.getPID();
 
-    // Feed the two PSI/SI demux.
-    _demux.feedPacket(pkt);
-    _eit_demux.feedPacket(pkt);
+    // Process the PSI/SI which were completed by the input thread up to this packet.
+    while (!_signalization.empty() && _signalization.front().index <= index) {
+        const InputExecutor::Signalization& sig(_signalization.front());
+        if (!sig.table.isNull()) {
+            handleTable(*sig.table);
+        }
+        else if (!sig.section.isNull()) {
+            handleEIT(sig.section);
+        }
+        _signalization.pop_front();
+    }
 
     // If this is TDT/TOT PID, check if we need to pass it.
     if (pid == PID_TDT && _core._time_input_index == NPOS) {
@@ -555,10 +563,10 @@ void ts::tsmux::Core::Input::adjustPCR(TSPacket& pkt)
 
 
 //----------------------------------------------------------------------------
-// Receive a PSI/SI table from an input stream.
+// Process a PSI/SI table from an input stream.
 //----------------------------------------------------------------------------
 
-void ts::tsmux::Core::Input::handleTable(SectionDemux& demux, const BinaryTable& table)
+void ts::tsmux::Core::Input::handleTable(const BinaryTable& table)
 {
     switch (table.tableId()) {
         case TID_PAT: {
@@ -851,21 +859,18 @@ void ts::tsmux::Core::Input::handleSDT(const SDT& sdt)
 
 
 //----------------------------------------------------------------------------
-// Receive an EIT section from an input stream.
+// Process an EIT section from an input stream.
 //----------------------------------------------------------------------------
 
-void ts::tsmux::Core::Input::handleSection(SectionDemux& demux, const Section& section)
+void ts::tsmux::Core::Input::handleEIT(const SectionPtr& sp)
 {
-    const TID tid = section.tableId();
-    const bool is_eit = EIT::IsEIT(tid) && section.sourcePID() == PID_EIT;
+    const TID tid = sp->tableId();
+    const bool is_eit = EIT::IsEIT(tid) && sp->sourcePID() == PID_EIT;
     const bool is_actual = EIT::IsActual(tid);
 
     if (is_eit && _core._opt.eitScope != TableScope::NONE && (is_actual || _core._opt.eitScope == TableScope::ALL)) {
 
-        // Create a copy of the EIT section object (shared section data).
-        const SectionPtr sp(new Section(section, ShareMode::SHARE));
-        CheckNonNull(sp.pointer());
-
+        // The section is a private copy from the input thread, it can be directly patched and queued.
         // If this is an EIT-Actual, patch the EIT with output TS id.
         if (is_actual && sp->payloadSize() >= 4) {
             sp->setUInt16(0, _core._opt.outputTSId, false);
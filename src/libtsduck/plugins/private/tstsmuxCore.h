@@ -17,7 +17,6 @@
 #include "tstsmuxInputExecutor.h"
 #include "tstsmuxOutputExecutor.h"
 #include "tsTime.h"
-#include "tsSectionDemux.h"
 #include "tsCyclingPacketizer.h"
 #include "tsPCRMerger.h"
 #include "tsPAT.h"
@@ -30,6 +29,11 @@ namespace ts {
     namespace tsmux {
         //!
         //! Multiplexer (tsmux) core engine.
+        //!
+        //! The core thread only schedules the output packets. The PSI/SI of each input
+        //! stream are demultiplexed by the corresponding input thread and the core thread
+        //! only merges the complete tables into the output PSI/SI.
+        //!
         //! @ingroup plugin
         //!
         class Core: private Thread, private SectionProviderInterface
@@ -131,7 +135,7 @@ namespace ts {
             // Description of an input stream.
             //----------------------------------------------------------------
 
-            class Input : private TableHandlerInterface, SectionHandlerInterface
+            class Input
             {
                 TS_NOBUILD_NOCOPY(Input);
             public:
@@ -160,33 +164,41 @@ namespace ts {
                 bool getPacket(TSPacket& pkt, TSPacketMetadata& pkt_data);
 
             private:
+                // Max number of packets which are fetched at once from the input executor.
+                // This avoids locking the executor buffer for each packet.
+                static constexpr size_t BATCH_PACKETS = 64;
+
                 Core&            _core;           // Reference to the parent Core.
                 const size_t     _plugin_index;   // Input plugin index.
                 bool             _terminated;     // Detected that the executor thread has terminated.
                 bool             _got_ts_id;      // Input transport stream id is known.
                 uint16_t         _ts_id;          // Input transport stream id (when _got_ts_id is true).
                 InputExecutor    _input;          // Input plugin thread.
-                SectionDemux     _demux;          // Demux for PSI/SI (except PMT's and EIT's).
-                SectionDemux     _eit_demux;      // Demux for EIT's.
                 PCRMerger        _pcr_merger;     // Adjust PCR in input packets to be synchronized with the output stream.
                 NIT              _nit;            // NIT waiting to be merged.
                 PacketCounter    _next_insertion; // Insertion point of next packet.
                 TSPacket         _next_packet;    // Next packet to insert if already received but not yet inserted.
                 TSPacketMetadata _next_metadata;  // Associated metadata.
                 std::map<PID,PIDClock> _pid_clocks;  // Output clock of each input PID.
+                TSPacketVector         _batch_packets;   // Packets which were fetched from the input executor.
+                TSPacketMetadataVector _batch_metadata;  // Associated metadata.
+                size_t                 _batch_count;     // Number of packets in the batch.
+                size_t                 _batch_next;      // Index of next packet to return in the batch.
+                PacketCounter          _batch_index;     // Index in the input stream of the first packet in the batch.
+                InputExecutor::SignalizationList _signalization;  // Tables and sections from the input executor.
 
                 // Adjust the PCR of a packet before insertion.
                 void adjustPCR(TSPacket& pkt);
 
-                // Receive a PSI/SI table.
-                virtual void handleTable(SectionDemux& demux, const BinaryTable& table) override;
+                // Process a PSI/SI table.
+                void handleTable(const BinaryTable& table);
                 void handlePAT(const PAT&);
                 void handleCAT(const CAT&);
                 void handleNIT(const NIT&);
                 void handleSDT(const SDT&);
 
-                // Receive an EIT section.
-                virtual void handleSection(SectionDemux& demux, const Section& section) override;
+                // Process an EIT section.
+                void handleEIT(const SectionPtr& section);
             };
         };
     }
@@ -9,6 +9,7 @@
 #include "tstsmuxInputExecutor.h"
 #include "tsGuardMutex.h"
 #include "tsGuardCondition.h"
+#include "tsEIT.h"
 
 
 //----------------------------------------------------------------------------
@@ -19,10 +20,35 @@ ts::tsmux::InputExecutor::InputExecutor(const MuxerArgs& opt, const PluginEventH
     // Input threads have a high priority to be always ready to load incoming packets in the buffer.
     PluginExecutor(opt, handlers, PluginType::INPUT, opt.inputs[index], ThreadAttributes().setPriority(ThreadAttributes::GetHighPriority()), log),
     _input(dynamic_cast<InputPlugin*>(PluginThread::plugin())),
-    _pluginIndex(index)
+    _pluginIndex(index),
+    _duck(this),
+    _demux(_duck, this, nullptr),
+    _eit_demux(_duck, nullptr, this),
+    _demux_index(0),
+    _packets_index(0),
+    _new_signal(),
+    _signalization()
 {
     // Make sure that the input plugins display their index.
     setLogName(UString::Format(u"%s[%d]", {pluginName(), _pluginIndex}));
+
+    // Preset common default options.
+    _duck.restoreArgs(_opt.duckArgs);
+
+    // Filter all global PSI/SI for merging in output PSI.
+    _demux.addPID(PID_PAT);
+    _demux.addPID(PID_CAT);
+    if (_opt.nitScope != TableScope::NONE) {
+        _demux.addPID(PID_NIT);
+    }
+    if (_opt.sdtScope != TableScope::NONE) {
+        _demux.addPID(PID_SDT);
+    }
+
+    // Filter EIT sections one by one if the output stream shall contain EIT's.
+    if (_opt.eitScope != TableScope::NONE) {
+        _eit_demux.addPID(PID_EIT);
+    }
 }
 
 ts::tsmux::InputExecutor::~InputExecutor()
@@ -59,7 +85,7 @@ void ts::tsmux::InputExecutor::terminate()
 // Copy packets from the input buffer.
 //----------------------------------------------------------------------------
 
-bool ts::tsmux::InputExecutor::getPackets(TSPacket* pkt, TSPacketMetadata* mdata, size_t max_count, size_t& ret_count, bool blocking)
+bool ts::tsmux::InputExecutor::getPackets(TSPacket* pkt, TSPacketMetadata* mdata, size_t max_count, size_t& ret_count, PacketCounter& first_index, SignalizationList& signalization, bool blocking)
 {
     // In blocking mode, loop until there is some packet in the buffer.
     GuardCondition lock(_mutex, _got_packets);
@@ -80,11 +106,20 @@ bool ts::tsmux::InputExecutor::getPackets(TSPacket* pkt, TSPacketMetadata* mdata
     ret_count = std::min(std::min(max_count, _packets_count), _buffer_size - _packets_first);
 
     // Copy packets if there are some.
+    first_index = _packets_index;
     if (ret_count > 0) {
         TSPacket::Copy(pkt, &_packets[_packets_first], ret_count);
         TSPacketMetadata::Copy(mdata, &_metadata[_packets_first], ret_count);
         _packets_first = (_packets_first + ret_count) % _buffer_size;
         _packets_count -= ret_count;
+        _packets_index += ret_count;
+
+        // Move the signalization which was completed up to the last returned packet.
+        auto end = _signalization.begin();
+        while (end != _signalization.end() && end->index < _packets_index) {
+            ++end;
+        }
+        signalization.splice(signalization.end(), _signalization, _signalization.begin(), end);
 
         // Signal that there are some free space.
         // The mutex was initially locked for the _got_packets condition because we needed to wait
@@ -116,6 +151,8 @@ void ts::tsmux::InputExecutor::main()
                 const size_t dropped = std::min(_opt.lossyReclaim, _buffer_size);
                 _packets_first = (_packets_first + dropped) % _buffer_size;
                 _packets_count -= dropped;
+                _packets_index += dropped;
+                discardSignalization(_packets_index - dropped, _packets_index);
             }
             // Wait for free space in the buffer.
             while (!_terminate && _packets_count >= _buffer_size) {
@@ -130,9 +167,17 @@ void ts::tsmux::InputExecutor::main()
         if (!_terminate) {
             count = _input->receive(&_packets[first], &_metadata[first], std::min(count, _opt.maxInputPackets));
             if (count > 0) {
+                // Demux the PSI/SI from the received packets. This is done outside the mutex
+                // protection since the core thread cannot access these packets yet.
+                for (size_t i = 0; i < count; ++i) {
+                    _demux.feedPacket(_packets[first + i]);
+                    _eit_demux.feedPacket(_packets[first + i]);
+                    _demux_index++;
+                }
                 // Packets successfully received.
                 GuardCondition lock(_mutex, _got_packets);
                 _packets_count += count;
+                _signalization.splice(_signalization.end(), _new_signal);
                 // Signal that there are some new packets in the buffer.
                 lock.signal();
             }
@@ -155,3 +200,65 @@ void ts::tsmux::InputExecutor::main()
     _input->stop();
     debug(u"input thread terminated");
 }
+
+
+//----------------------------------------------------------------------------
+// Receive PSI/SI in the context of the plugin thread.
+//----------------------------------------------------------------------------
+
+void ts::tsmux::InputExecutor::handleTable(SectionDemux& demux, const BinaryTable& table)
+{
+    // The table is copied since it will be used in the core thread.
+    _new_signal.emplace_back();
+    _new_signal.back().index = _demux_index;
+    _new_signal.back().table = new BinaryTable(table, ShareMode::COPY);
+}
+
+void ts::tsmux::InputExecutor::handleSection(SectionDemux& demux, const Section& section)
+{
+    // The section is copied since it will be used (and modified) in the core thread.
+    if (EIT::IsEIT(section.tableId())) {
+        _new_signal.emplace_back();
+        _new_signal.back().index = _demux_index;
+        _new_signal.back().section = new Section(section, ShareMode::COPY);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Discard the signalization which uses some dropped input packets.
+//----------------------------------------------------------------------------
+
+void ts::tsmux::InputExecutor::discardSignalization(PacketCounter begin, PacketCounter end)
+{
+    // Check if a section uses some packets in the dropped range.
+    const auto dropped = [begin, end](const Section& section) {
+        return section.firstTSPacketIndex() < end && section.lastTSPacketIndex() >= begin;
+    };
+
+    // Without demux in the input thread, these tables and sections would never have been
+    // demuxed in the core thread. The demux of a discarded table is reset to notify it
+    // again on its next repetition, as it would have been without the dropped packets.
+    for (auto it = _signalization.begin(); it != _signalization.end(); ) {
+        bool discard = false;
+        if (!it->table.isNull()) {
+            for (size_t i = 0; !discard && i < it->table->sectionCount(); ++i) {
+                const SectionPtr sp(it->table->sectionAt(i));
+                discard = !sp.isNull() && dropped(*sp);
+            }
+            if (discard) {
+                _demux.resetPID(it->table->sourcePID());
+            }
+        }
+        else if (!it->section.isNull()) {
+            discard = dropped(*it->section);
+        }
+        if (discard) {
+            debug(u"discarding signalization from dropped packets, table id 0x%X, packet %'d", {it->table.isNull() ? it->section->tableId() : it->table->tableId(), it->index});
+            it = _signalization.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
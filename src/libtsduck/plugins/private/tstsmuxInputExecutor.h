@@ -15,17 +15,41 @@
 #include "tstsmuxPluginExecutor.h"
 #include "tsMuxerArgs.h"
 #include "tsInputPlugin.h"
+#include "tsDuckContext.h"
+#include "tsSectionDemux.h"
+#include "tsBinaryTable.h"
 
 namespace ts {
     namespace tsmux {
         //!
         //! Execution context of a tsmux input plugin.
+        //!
+        //! The PSI/SI which are merged in the output stream are demultiplexed in the
+        //! context of the input thread. The core thread receives the complete tables
+        //! and sections with the packets, without demultiplexing them itself.
+        //!
         //! @ingroup plugin
         //!
-        class InputExecutor : public PluginExecutor
+        class InputExecutor : public PluginExecutor, private TableHandlerInterface, private SectionHandlerInterface
         {
             TS_NOBUILD_NOCOPY(InputExecutor);
         public:
+            //!
+            //! A PSI/SI table or EIT section which was demultiplexed by the input thread.
+            //!
+            class Signalization
+            {
+            public:
+                PacketCounter  index = 0;   //!< Index in the input stream of the last packet of the table or section.
+                BinaryTablePtr table {};    //!< Complete PSI/SI table, null for an EIT section.
+                SectionPtr     section {};  //!< EIT section, null for a complete table.
+            };
+
+            //!
+            //! List of demultiplexed tables and sections, in order of input packets.
+            //!
+            typedef std::list<Signalization> SignalizationList;
+
             //!
             //! Constructor.
             //! @param [in] opt Command line options.
@@ -46,11 +70,14 @@ namespace ts {
             //! @param [out] mdata Address of packet metadata buffer.
             //! @param [in] max_count Buffer size in number of packets.
             //! @param [out] ret_count Returned number of actual packets.
+            //! @param [out] first_index Index in the input stream of the first returned packet.
+            //! @param [in,out] signalization The tables and sections which were completed up to
+            //! the last returned packet are appended to this list, in order of input packets.
             //! @param [in] blocking If true, block until at least one packet is available.
             //! If false, immediately return with @a ret_count being zero if no packet is available.
             //! @return True on success, false if the output is terminated on error.
             //!
-            bool getPackets(TSPacket* pkt, TSPacketMetadata* mdata, size_t max_count, size_t& ret_count, bool blocking);
+            bool getPackets(TSPacket* pkt, TSPacketMetadata* mdata, size_t max_count, size_t& ret_count, PacketCounter& first_index, SignalizationList& signalization, bool blocking);
 
             // Implementation of TSP.
             virtual size_t pluginIndex() const override;
@@ -59,11 +86,26 @@ namespace ts {
             virtual void terminate() override;
 
         private:
-            InputPlugin* _input;         // Plugin API.
-            const size_t _pluginIndex;   // Index of this input plugin.
+            InputPlugin*      _input;            // Plugin API.
+            const size_t      _pluginIndex;      // Index of this input plugin.
+            DuckContext       _duck;             // TSDuck execution context for the demux.
+            SectionDemux      _demux;            // Demux for PSI/SI (except PMT's and EIT's).
+            SectionDemux      _eit_demux;        // Demux for EIT's.
+            PacketCounter     _demux_index;      // Index in the input stream of the packet in the demux.
+            PacketCounter     _packets_index;    // Index in the input stream of the first packet in the buffer (under mutex).
+            SignalizationList _new_signal;       // Signalization from the last received packets (input thread only).
+            SignalizationList _signalization;    // Signalization for packets in the buffer (under mutex).
 
             // Implementation of Thread.
             virtual void main() override;
+
+            // Discard the signalization which uses some packets in a range of dropped input packets.
+            // Must be called by the input thread under the protection of the mutex.
+            void discardSignalization(PacketCounter begin, PacketCounter end);
+
+            // Implementation of table and section handlers.
+            virtual void handleTable(SectionDemux& demux, const BinaryTable& table) override;
+            virtual void handleSection(SectionDemux& demux, const Section& section) override;
         };
     }
 }
@@ -10,6 +10,7 @@
 #include "tsPluginRepository.h"
 #include "tsGuardCondition.h"
 #include "tsGuardMutex.h"
+#include "tsMonotonic.h"
 
 
 //----------------------------------------------------------------------------
@@ -36,6 +37,8 @@ ts::tsp::PluginExecutor::PluginExecutor(const TSProcessorArgs& options,
     _input_end(false),
     _bitrate(0),
     _br_confidence(BitRateConfidence::LOW),
+    _wake_threshold(1),
+    _slice_target(0),
     _restart(false),
     _restart_data()
 {
@@ -109,7 +112,7 @@ void ts::tsp::PluginExecutor::initBuffer(PacketBuffer*         buffer,
                                          const BitRate&        bitrate,
                                          BitRateConfidence     br_confidence)
 {
-    log(10, u"initBuffer(..., pkt_first = %'d, pkt_cnt = %'d, input_end = %s, aborted = %s, bitrate = %'d)", {pkt_first, pkt_cnt, input_end, aborted, bitrate});
+    log(10, TS_CHECKED_FORMAT(u"initBuffer(..., pkt_first = %'d, pkt_cnt = %'d, input_end = %s, aborted = %s, bitrate = %'d)", pkt_first, pkt_cnt, input_end, aborted, bitrate));
 
     _buffer = buffer;
     _metadata = metadata;
@@ -132,7 +135,7 @@ bool ts::tsp::PluginExecutor::passPackets(size_t count, const BitRate& bitrate,
 {
     assert(count <= _pkt_cnt);
 
-    log(10, u"passPackets(count = %'d, bitrate = %'d, input_end = %s, aborted = %s)", {count, bitrate, input_end, aborted});
+    log(10, TS_CHECKED_FORMAT(u"passPackets(count = %'d, bitrate = %'d, input_end = %s, aborted = %s)", count, bitrate, input_end, aborted));
 
     // We access data under the protection of the global mutex.
     GuardMutex lock(_global_mutex);
@@ -150,8 +153,8 @@ bool ts::tsp::PluginExecutor::passPackets(size_t count, const BitRate& bitrate,
     next->_br_confidence = br_confidence;
     next->_input_end = next->_input_end || input_end;
 
-    // Wake the next processor when there is some new input data or end of input.
-    if (count > 0 || input_end) {
+    // Wake the next processor when there is enough new input data or end of input.
+    if ((count > 0 && next->_pkt_cnt >= next->_wake_threshold) || input_end) {
         next->_to_do.signal();
     }
 
@@ -180,11 +183,11 @@ void ts::tsp::PluginExecutor::waitWork(size_t min_pkt_cnt, size_t& pkt_first, si
                                        BitRate& bitrate, BitRateConfidence& br_confidence,
                                        bool& input_end, bool& aborted, bool &timeout)
 {
-    log(10, u"waitWork(min_pkt_cnt = %'d, ...)", {min_pkt_cnt});
+    log(10, TS_CHECKED_FORMAT(u"waitWork(min_pkt_cnt = %'d, ...)", min_pkt_cnt));
 
     // Cannot allocate more than the buffer size.
     if (min_pkt_cnt > _buffer->count()) {
-        debug(u"requests too many packets at a time: %'d, larger than buffer size: %'d", {min_pkt_cnt, _buffer->count()});
+        debug(TS_CHECKED_FORMAT(u"requests too many packets at a time: %'d, larger than buffer size: %'d", min_pkt_cnt, _buffer->count()));
         min_pkt_cnt = _buffer->count();
     }
 
@@ -195,6 +198,7 @@ void ts::tsp::PluginExecutor::waitWork(size_t min_pkt_cnt, size_t& pkt_first, si
     timeout = false;
 
     // Loop until enough packets are available (or some error condition).
+    _wake_threshold = min_pkt_cnt;
     while (_pkt_cnt < min_pkt_cnt && !_input_end && !timeout && !next->_tsp_aborting) {
         // If packet area for this processor is empty, wait for some packet.
         // The mutex is implicitely released, we wait for the condition
@@ -204,6 +208,12 @@ void ts::tsp::PluginExecutor::waitWork(size_t min_pkt_cnt, size_t& pkt_first, si
         timeout = !lock.waitCondition(_tsp_timeout) && !plugin()->handlePacketTimeout();
     }
 
+    // Try to accumulate larger slices of packets to reduce the number of context switches.
+    if (!timeout && min_pkt_cnt == 1 && _options.min_slice_pkt > 1 && plugin()->type() != PluginType::INPUT) {
+        waitSlice(lock);
+    }
+    _wake_threshold = 1;
+
     // The number of returned packets is limited up to the wrap-up point of the circular buffer,
     // if allowed by the requested minimum number of packets.
     if (timeout) {
@@ -229,8 +239,50 @@ void ts::tsp::PluginExecutor::waitWork(size_t min_pkt_cnt, size_t& pkt_first, si
     // there is no propagation of packets from output back to input.
     aborted = plugin()->type() != PluginType::OUTPUT && next->_tsp_aborting;
 
-    log(10, u"waitWork(min_pkt_cnt = %'d, pkt_first = %'d, pkt_cnt = %'d, bitrate = %'d, input_end = %s, aborted = %s, timeout = %s)",
-        {min_pkt_cnt, pkt_first, pkt_cnt, bitrate, input_end, aborted, timeout});
+    log(10, TS_CHECKED_FORMAT(u"waitWork(min_pkt_cnt = %'d, pkt_first = %'d, pkt_cnt = %'d, bitrate = %'d, input_end = %s, aborted = %s, timeout = %s)",
+        min_pkt_cnt, pkt_first, pkt_cnt, bitrate, input_end, aborted, timeout));
+}
+
+
+//----------------------------------------------------------------------------
+// Wait for more packets to accumulate a slice.
+//----------------------------------------------------------------------------
+
+void ts::tsp::PluginExecutor::waitSlice(GuardCondition& lock)
+{
+    PluginExecutor* next = ringNext<PluginExecutor>();
+
+    // The slice target is adapted to the throughput of the plugin. It is never larger than
+    // the contiguous area up to the wrap-up point of the buffer and half the buffer size,
+    // to let the previous plugins make progress.
+    if (_slice_target == 0) {
+        _slice_target = _options.min_slice_pkt;
+    }
+    const size_t target = std::min({_slice_target, _buffer->count() / 2, _buffer->count() - _pkt_first});
+
+    // Wait until the slice is complete or the deadline is reached. The previous plugin
+    // signals us only when the target is reached, not on each new packet.
+    Monotonic deadline(true);
+    deadline += _options.max_slice_latency * NanoSecPerMilliSec;
+    bool expired = false;
+    _wake_threshold = target;
+    while (_pkt_cnt < target && !_input_end && !_restart && !next->_tsp_aborting && !expired) {
+        const NanoSecond remain = deadline - Monotonic(true);
+        expired = remain <= 0;
+        if (!expired) {
+            lock.waitCondition(std::max<MilliSecond>(1, remain / NanoSecPerMilliSec));
+        }
+    }
+
+    // Adapt the next target: grow when the slice was complete, shrink towards
+    // the number of packets which were received within the deadline otherwise.
+    if (_pkt_cnt >= target) {
+        _slice_target = std::min(_options.min_slice_pkt, 2 * _slice_target);
+    }
+    else if (expired) {
+        _slice_target = std::max<size_t>(1, (_slice_target + _pkt_cnt) / 2);
+    }
+    log(10, TS_CHECKED_FORMAT(u"waitSlice: target = %'d, got = %'d, next target = %'d", target, _pkt_cnt, _slice_target));
 }
 
 
@@ -330,7 +382,7 @@ bool ts::tsp::PluginExecutor::processPendingRestart(bool& restarted)
 
     // Verbose message in the current tsp process and back to the remote tspcontrol.
     verbose(u"restarting due to remote tspcontrol");
-    _restart_data->report.verbose(u"restarting plugin %s", {pluginName()});
+    _restart_data->report.verbose(TS_CHECKED_FORMAT(u"restarting plugin %s", pluginName()));
 
     // First, stop the current execution.
     plugin()->stop();
@@ -362,7 +414,7 @@ bool ts::tsp::PluginExecutor::processPendingRestart(bool& restarted)
 
         // In case of restart failure, try to restart with the previous arguments.
         if (!success) {
-            _restart_data->report.warning(u"failed to restart plugin %s, restarting with previous parameters", {pluginName()});
+            _restart_data->report.warning(TS_CHECKED_FORMAT(u"failed to restart plugin %s, restarting with previous parameters", pluginName()));
             success = plugin()->analyze(pluginName(), previous_args, false) && plugin()->getOptions() && plugin()->start();
         }
     }
@@ -378,6 +430,6 @@ bool ts::tsp::PluginExecutor::processPendingRestart(bool& restarted)
     _restart = false;
     _restart_data.clear();
 
-    debug(u"restarted plugin %s, status: %s", {pluginName(), success});
+    debug(TS_CHECKED_FORMAT(u"restarted plugin %s, status: %s", pluginName(), success));
     return success;
 }
@@ -18,6 +18,7 @@
 #include "tsPluginEventHandlerRegistry.h"
 #include "tsPlugin.h"
 #include "tsCondition.h"
+#include "tsGuardCondition.h"
 #include "tsMutex.h"
 
 namespace ts {
@@ -211,6 +212,8 @@ namespace ts {
             bool              _input_end;      // No more packet after current ones [*]
             BitRate           _bitrate;        // Input bitrate (set by previous plugin) [*]
             BitRateConfidence _br_confidence;  // Input bitrate confidence (set by previous plugin) [*]
+            size_t            _wake_threshold; // Min number of packets in area before signaling _to_do [*]
+            size_t            _slice_target;   // Current number of packets to accumulate, adapted to the throughput [*]
             bool              _restart;        // Restart the plugin asap using _restart_data
             RestartDataPtr    _restart_data;   // How to restart the plugin
 
@@ -232,6 +235,10 @@ namespace ts {
 
             // Restart this plugin.
             void restart(const RestartDataPtr&);
+
+            // Wait for more packets to accumulate a slice, within the maximum slice latency.
+            // Must be called with the global mutex held, using the GuardCondition on _to_do.
+            void waitSlice(GuardCondition& lock);
         };
     }
 }
@@ -470,6 +470,28 @@ bool ts::tsswitch::Core::outputSent(size_t pluginIndex, size_t count)
 }
 
 
+//----------------------------------------------------------------------------
+// Get the PID's which carry sections in an input plugin.
+//----------------------------------------------------------------------------
+
+ts::PIDSet ts::tsswitch::Core::psiPIDs(size_t pluginIndex)
+{
+    assert(pluginIndex < _inputs.size());
+    return _inputs[pluginIndex]->psiPIDs();
+}
+
+
+//----------------------------------------------------------------------------
+// Get the continuity counters of an input plugin before its next output packet.
+//----------------------------------------------------------------------------
+
+void ts::tsswitch::Core::previousCC(size_t pluginIndex, std::array<uint8_t, PID_MAX>& cc)
+{
+    assert(pluginIndex < _inputs.size());
+    _inputs[pluginIndex]->previousCC(cc);
+}
+
+
 //----------------------------------------------------------------------------
 // Report completion of input start (called by input plugins).
 //----------------------------------------------------------------------------
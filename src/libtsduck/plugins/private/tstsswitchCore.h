@@ -128,6 +128,21 @@ namespace ts {
             //!
             bool outputSent(size_t pluginIndex, size_t count);
 
+            //!
+            //! Get the PID's which carry sections in an input plugin.
+            //! @param [in] pluginIndex Index of the input plugin.
+            //! @return The PID's of all known PSI/SI tables in the input plugin.
+            //!
+            PIDSet psiPIDs(size_t pluginIndex);
+
+            //!
+            //! Get the continuity counters of an input plugin before its next output packet.
+            //! @param [in] pluginIndex Index of the input plugin.
+            //! @param [out] cc The continuity counter of the last packet of each PID before the next
+            //! packet to output, InputExecutor::INVALID_CC if there is none.
+            //!
+            void previousCC(size_t pluginIndex, std::array<uint8_t, PID_MAX>& cc);
+
         private:
             // Upon reception of an event (end of input, remote command, etc), there
             // is a list of actions to execute which depends on the switch policy.
@@ -10,6 +10,12 @@
 #include "tstsswitchCore.h"
 #include "tsGuardMutex.h"
 #include "tsGuardCondition.h"
+#include "tsBinaryTable.h"
+#include "tsPAT.h"
+
+#if !defined(TS_CXX17)
+constexpr uint8_t ts::tsswitch::InputExecutor::INVALID_CC;
+#endif
 
 
 //----------------------------------------------------------------------------
@@ -37,7 +43,12 @@ ts::tsswitch::InputExecutor::InputExecutor(const InputSwitcherArgs& opt,
     _terminated(false),
     _outFirst(0),
     _outCount(0),
-    _start_time(true) // initialized with current system time
+    _start_time(true), // initialized with current system time
+    _psiPIDs(),
+    _duck(this),
+    _psiDemux(_duck, this),
+    _bufferCC(opt.bufferedPackets),
+    _previousCC()
 {
     // Make sure that the input plugins display their index.
     setLogName(UString::Format(u"%s[%d]", {pluginName(), _pluginIndex}));
@@ -148,6 +159,7 @@ void ts::tsswitch::InputExecutor::freeOutput(size_t count)
 {
     GuardCondition lock(_mutex, _todo);
     assert(count <= _outCount);
+    releaseCC(_outFirst, count);
     _outFirst = (_outFirst + count) % _buffer.size();
     _outCount -= count;
     _outputInUse = false;
@@ -155,6 +167,70 @@ void ts::tsswitch::InputExecutor::freeOutput(size_t count)
 }
 
 
+//----------------------------------------------------------------------------
+// Analysis of the PSI of the input, with --fix-continuity.
+//----------------------------------------------------------------------------
+
+ts::PIDSet ts::tsswitch::InputExecutor::psiPIDs()
+{
+    GuardMutex lock(_mutex);
+    return _psiPIDs;
+}
+
+void ts::tsswitch::InputExecutor::resetPSI()
+{
+    // Before getting the PAT, only the PSI/SI PID's with fixed values are known.
+    PIDSet pids;
+    for (PID pid = PID_PAT; pid <= PID_DVB_LAST; ++pid) {
+        pids.set(pid);
+    }
+    _psiDemux.reset();
+    _psiDemux.setPIDFilter(NoPID);
+    _psiDemux.addPID(PID_PAT);
+    GuardMutex lock(_mutex);
+    _psiPIDs = pids;
+    _previousCC.fill(INVALID_CC);
+}
+
+void ts::tsswitch::InputExecutor::previousCC(std::array<uint8_t, PID_MAX>& cc)
+{
+    GuardMutex lock(_mutex);
+    cc = _previousCC;
+}
+
+void ts::tsswitch::InputExecutor::releaseCC(size_t first, size_t count)
+{
+    // The packets which were output may have been modified by the output executor.
+    // Their original continuity counters were saved in _bufferCC. The PSI packets
+    // which were replaced with null packets are ignored.
+    if (_opt.fixContinuity) {
+        for (size_t n = 0; n < count; ++n) {
+            const size_t index = (first + n) % _buffer.size();
+            const PID pid = _buffer[index].getPID();
+            if (pid != PID_NULL) {
+                _previousCC[pid] = _bufferCC[index];
+            }
+        }
+    }
+}
+
+void ts::tsswitch::InputExecutor::handleTable(SectionDemux& demux, const BinaryTable& table)
+{
+    if (table.tableId() == TID_PAT) {
+        const PAT pat(_duck, table);
+        if (pat.isValid()) {
+            GuardMutex lock(_mutex);
+            if (pat.nit_pid != PID_NULL) {
+                _psiPIDs.set(pat.nit_pid);
+            }
+            for (const auto& it : pat.pmts) {
+                _psiPIDs.set(it.second);
+            }
+        }
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Invoked in the context of the plugin thread.
 //----------------------------------------------------------------------------
@@ -189,6 +265,9 @@ void ts::tsswitch::InputExecutor::main()
         }
 
         // Here, we need to start an input session.
+        if (_opt.fixContinuity) {
+            resetPSI();
+        }
         debug(u"starting input plugin");
         const bool started = _input->start();
         debug(u"input plugin started, status: %s", {started});
@@ -224,6 +303,7 @@ void ts::tsswitch::InputExecutor::main()
                         assert(_outFirst < _buffer.size());
                         const size_t freeCount = std::min(_opt.maxInputPackets, _buffer.size() - _outFirst);
                         assert(freeCount <= _outCount);
+                        releaseCC(_outFirst, freeCount);
                         _outFirst = (_outFirst + freeCount) % _buffer.size();
                         _outCount -= freeCount;
                     }
@@ -264,10 +344,26 @@ void ts::tsswitch::InputExecutor::main()
                 }
             }
 
+            // Keep the PSI and continuity state of the input up to date, even when it is not the current one.
+            // The packets are not yet visible from the output thread.
+            if (_opt.fixContinuity) {
+                for (size_t n = 0; n < inCount; ++n) {
+                    _psiDemux.feedPacket(_buffer[inFirst + n]);
+                    _bufferCC[inFirst + n] = _buffer[inFirst + n].getCC();
+                }
+            }
+
             // Signal the presence of received packets.
             {
                 GuardMutex lock(_mutex);
                 _outCount += inCount;
+                // With --warm-standby, a standby input keeps only the packets it just received.
+                // The packets are contiguous in the buffer since they were received at once.
+                if (_opt.warmStandby && !_isCurrent && !_outputInUse && _outCount > inCount) {
+                    releaseCC(_outFirst, _outCount - inCount);
+                    _outFirst = inFirst;
+                    _outCount = inCount;
+                }
             }
             _core.inputReceived(_pluginIndex);
         }
@@ -18,6 +18,7 @@
 #include "tsMutex.h"
 #include "tsCondition.h"
 #include "tsMonotonic.h"
+#include "tsSectionDemux.h"
 
 namespace ts {
     namespace tsswitch {
@@ -25,7 +26,7 @@ namespace ts {
         //! Execution context of a tsswitch input plugin.
         //! @ingroup plugin
         //!
-        class InputExecutor : public PluginExecutor
+        class InputExecutor : public PluginExecutor, private TableHandlerInterface
         {
             TS_NOBUILD_NOCOPY(InputExecutor);
         public:
@@ -99,6 +100,27 @@ namespace ts {
             //!
             void freeOutput(size_t count);
 
+            //!
+            //! Get the PID's which carry sections in the current input session.
+            //! With --fix-continuity, the PAT of the input is permanently analyzed, even in standby.
+            //! @return The PID's of all known PSI/SI tables (fixed PID's, NIT and PMT's).
+            //!
+            PIDSet psiPIDs();
+
+            //!
+            //! Get the continuity counters of the input before its next output packet.
+            //! With --fix-continuity, the continuity state of the input is permanently updated,
+            //! including in standby, when older packets are dropped instead of being output.
+            //! @param [out] cc The original continuity counter of the last packet of each PID before
+            //! the next packet to output, INVALID_CC if there is none in the current input session.
+            //!
+            void previousCC(std::array<uint8_t, PID_MAX>& cc);
+
+            //!
+            //! Invalid value in an array of continuity counters.
+            //!
+            static constexpr uint8_t INVALID_CC = 0xFF;
+
             // Implementation of TSP.
             virtual size_t pluginIndex() const override;
 
@@ -117,9 +139,23 @@ namespace ts {
             size_t                   _outFirst;      // Index of first packet to output in _buffer.
             size_t                   _outCount;      // Number of packets to output, not always contiguous, may wrap up.
             Monotonic                _start_time;    // Creation time in a monotonic clock.
+            PIDSet                   _psiPIDs;       // PID's carrying sections in the input.
+            DuckContext              _duck;          // Context for the analysis of the input.
+            SectionDemux             _psiDemux;      // PAT demux of the input, used in the input thread only.
+            ByteBlock                _bufferCC;      // Original continuity counter of each packet in _buffer.
+            std::array<uint8_t, PID_MAX> _previousCC;  // Continuity counter of each PID before _outFirst.
+
+            // Reset the analysis of the input at the beginning of a session.
+            void resetPSI();
+
+            // Update the continuity state with packets which leave the buffer, output or dropped.
+            void releaseCC(size_t first, size_t count);
 
             // Implementation of Thread.
             virtual void main() override;
+
+            // Implementation of TableHandlerInterface.
+            virtual void handleTable(SectionDemux& demux, const BinaryTable& table) override;
         };
 
         //!
@@ -21,8 +21,16 @@ ts::tsswitch::OutputExecutor::OutputExecutor(const InputSwitcherArgs& opt,
 
     PluginExecutor(opt, handlers, PluginType::OUTPUT, opt.output, ThreadAttributes(), core, log),
     _output(dynamic_cast<OutputPlugin*>(plugin())),
-    _terminate(false)
+    _terminate(false),
+    _psiSync(),
+    _ccSync(),
+    _pcrSwitch(),
+    _lastCC(),
+    _ccOffset(),
+    _inputCC()
 {
+    _lastCC.fill(InputExecutor::INVALID_CC);
+    _ccOffset.fill(0);
 }
 
 ts::tsswitch::OutputExecutor::~OutputExecutor()
@@ -51,16 +59,27 @@ void ts::tsswitch::OutputExecutor::main()
     debug(u"output thread started");
 
     size_t pluginIndex = 0;
+    size_t previousIndex = NPOS;
     TSPacket* first = nullptr;
     TSPacketMetadata* metadata = nullptr;
     size_t count = 0;
 
     // Loop until there are packets to output.
     while (!_terminate && _core.getOutputArea(pluginIndex, first, metadata, count)) {
-        log(2, u"got %d packets from plugin %d, terminate: %s", {count, pluginIndex, _terminate});
+        log(2, TS_CHECKED_FORMAT(u"got %d packets from plugin %d, terminate: %s", count, pluginIndex, _terminate));
         if (!_terminate && count > 0) {
 
-            // Output the packets.
+            // With --fix-continuity, repair the stream when the input plugin changes.
+            if (_opt.fixContinuity) {
+                if (previousIndex != NPOS && pluginIndex != previousIndex) {
+                    debug(TS_CHECKED_FORMAT(u"switched from input %d to %d, fixing continuity", previousIndex, pluginIndex));
+                    switchContinuity(pluginIndex);
+                }
+                fixContinuity(first, count);
+            }
+            previousIndex = pluginIndex;
+
+            // Output the packets, directly from the input plugin buffer.
             const bool success = _output->send(first, metadata, count);
 
             // Signal to the input plugin that the buffer can be reused..
@@ -82,3 +101,68 @@ void ts::tsswitch::OutputExecutor::main()
     _output->stop();
     debug(u"output thread terminated");
 }
+
+
+//----------------------------------------------------------------------------
+// Fix continuity counters and PCR discontinuities in packets to output.
+//----------------------------------------------------------------------------
+
+void ts::tsswitch::OutputExecutor::switchContinuity(size_t pluginIndex)
+{
+    _psiSync = _core.psiPIDs(pluginIndex);
+    _ccSync.set();
+    _pcrSwitch.set();
+
+    // The continuity state of the new input is maintained while it is in standby. When the
+    // continuity counter before its next packet is known, the offset is computed now and the
+    // first packet of the PID keeps its continuity with the previous packets of its input.
+    // The PSI PID's which start with dropped packets are resynchronized on their first packet.
+    _core.previousCC(pluginIndex, _inputCC);
+    for (PID pid = 0; pid < PID_MAX; ++pid) {
+        if (_inputCC[pid] != InputExecutor::INVALID_CC && _lastCC[pid] != InputExecutor::INVALID_CC && !_psiSync.test(pid)) {
+            _ccOffset[pid] = uint8_t((_lastCC[pid] - _inputCC[pid]) & CC_MASK);
+            _ccSync.reset(pid);
+        }
+    }
+}
+
+void ts::tsswitch::OutputExecutor::fixContinuity(TSPacket* pkt, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const PID pid = pkt[i].getPID();
+        if (pid == PID_NULL) {
+            continue;
+        }
+
+        // Do not start a PSI PID in the middle of a section, replace its packets with null
+        // packets until the next start of section. The PSI PID's of the new input are known
+        // because its PAT is continuously analyzed, even when it is not the current input.
+        if (_psiSync.test(pid)) {
+            if (!pkt[i].getPUSI()) {
+                pkt[i] = NullPacket;
+                continue;
+            }
+            _psiSync.reset(pid);
+        }
+
+        // Signal the change of time base in the first PCR of each PID after a switch.
+        if (_pcrSwitch.test(pid) && pkt[i].hasPCR()) {
+            pkt[i].setDiscontinuityIndicator();
+            _pcrSwitch.reset(pid);
+        }
+
+        // When the continuity state of the new input was unknown at switch time, the offset of
+        // continuity counters is computed on the first packet of each PID, to continue the previous input. The following packets of the PID use the same
+        // offset: the continuity errors in the new input remain visible in the output.
+        const uint8_t cc = pkt[i].getCC();
+        if (_ccSync.test(pid)) {
+            const uint8_t last = _lastCC[pid];
+            _ccOffset[pid] = last == InputExecutor::INVALID_CC ? 0 : uint8_t((last + (pkt[i].hasPayload() ? 1 : 0) - cc) & CC_MASK);
+            _ccSync.reset(pid);
+        }
+        if (_ccOffset[pid] != 0) {
+            pkt[i].setCC((cc + _ccOffset[pid]) & CC_MASK);
+        }
+        _lastCC[pid] = pkt[i].getCC();
+    }
+}
@@ -53,11 +53,24 @@ namespace ts {
             virtual size_t pluginIndex() const override;
 
         private:
-            OutputPlugin* _output;     // Plugin API.
-            volatile bool _terminate;  // Termination request.
+            OutputPlugin*      _output;     // Plugin API.
+            volatile bool      _terminate;  // Termination request.
+            PIDSet             _psiSync;    // PSI PID's to drop until the start of a section after a switch.
+            PIDSet             _ccSync;     // PID's with a continuity counter offset to compute after a switch.
+            PIDSet             _pcrSwitch;  // PID's with a pending PCR discontinuity after a switch.
+            std::array<uint8_t, PID_MAX> _lastCC;    // Last output continuity counter per PID, InputExecutor::INVALID_CC if none.
+            std::array<uint8_t, PID_MAX> _ccOffset;  // Continuity counter offset per PID in the current input.
+            std::array<uint8_t, PID_MAX> _inputCC;   // Continuity counters of the new input at switch time.
 
             // Implementation of Thread.
             virtual void main() override;
+
+            // Fix continuity counters and PCR discontinuities in packets to output.
+            // The packets are modified in place in the buffer of the input plugin.
+            void fixContinuity(TSPacket* pkt, size_t count);
+
+            // Prepare the continuity fix after switching to another input plugin.
+            void switchContinuity(size_t pluginIndex);
         };
     }
 }
@@ -0,0 +1,102 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/#license
+//
+//----------------------------------------------------------------------------
+//
+//  TSDuck Python bindings: encapsulates MemoryPacketRing objects for Python.
+//
+//----------------------------------------------------------------------------
+
+#include "tspy.h"
+#include "tsMemoryPacketRing.h"
+
+
+//-----------------------------------------------------------------------------
+// Interface to MemoryPacketRing.
+//-----------------------------------------------------------------------------
+
+TSDUCKPY void* tspyNewMemoryPacketRing(const uint8_t* name, size_t name_size, size_t packet_count)
+{
+    return new ts::MemoryPacketRing(ts::py::ToString(name, name_size), packet_count);
+}
+
+TSDUCKPY void tspyDeleteMemoryPacketRing(void* ring)
+{
+    delete reinterpret_cast<ts::MemoryPacketRing*>(ring);
+}
+
+TSDUCKPY size_t tspyMemoryPacketRingMetadataSize()
+{
+    return sizeof(ts::TSPacketMetadata);
+}
+
+TSDUCKPY size_t tspyMemoryPacketRingGetWriteArea(void* ring, long timeout, uint8_t** packets, uint8_t** metadata)
+{
+    ts::MemoryPacketRing* r = reinterpret_cast<ts::MemoryPacketRing*>(ring);
+    ts::TSPacket* pkt = nullptr;
+    ts::TSPacketMetadata* mdata = nullptr;
+    const size_t count = r == nullptr ? 0 : r->getWriteArea(pkt, mdata, timeout < 0 ? ts::Infinite : ts::MilliSecond(timeout));
+    if (packets != nullptr) {
+        *packets = reinterpret_cast<uint8_t*>(pkt);
+    }
+    if (metadata != nullptr) {
+        *metadata = reinterpret_cast<uint8_t*>(mdata);
+    }
+    return count;
+}
+
+TSDUCKPY void tspyMemoryPacketRingCommitWrite(void* ring, size_t count)
+{
+    ts::MemoryPacketRing* r = reinterpret_cast<ts::MemoryPacketRing*>(ring);
+    if (r != nullptr) {
+        r->commitWrite(count);
+    }
+}
+
+TSDUCKPY void tspyMemoryPacketRingSetEndOfStream(void* ring)
+{
+    ts::MemoryPacketRing* r = reinterpret_cast<ts::MemoryPacketRing*>(ring);
+    if (r != nullptr) {
+        r->setEndOfStream();
+    }
+}
+
+TSDUCKPY size_t tspyMemoryPacketRingGetReadArea(void* ring, long timeout, const uint8_t** packets, const uint8_t** metadata)
+{
+    ts::MemoryPacketRing* r = reinterpret_cast<ts::MemoryPacketRing*>(ring);
+    const ts::TSPacket* pkt = nullptr;
+    const ts::TSPacketMetadata* mdata = nullptr;
+    const size_t count = r == nullptr ? 0 : r->getReadArea(pkt, mdata, timeout < 0 ? ts::Infinite : ts::MilliSecond(timeout));
+    if (packets != nullptr) {
+        *packets = reinterpret_cast<const uint8_t*>(pkt);
+    }
+    if (metadata != nullptr) {
+        *metadata = reinterpret_cast<const uint8_t*>(mdata);
+    }
+    return count;
+}
+
+TSDUCKPY void tspyMemoryPacketRingCommitRead(void* ring, size_t count)
+{
+    ts::MemoryPacketRing* r = reinterpret_cast<ts::MemoryPacketRing*>(ring);
+    if (r != nullptr) {
+        r->commitRead(count);
+    }
+}
+
+TSDUCKPY bool tspyMemoryPacketRingEndOfStream(void* ring)
+{
+    ts::MemoryPacketRing* r = reinterpret_cast<ts::MemoryPacketRing*>(ring);
+    return r == nullptr || r->endOfStream() || r->aborted();
+}
+
+TSDUCKPY void tspyMemoryPacketRingAbort(void* ring)
+{
+    ts::MemoryPacketRing* r = reinterpret_cast<ts::MemoryPacketRing*>(ring);
+    if (r != nullptr) {
+        r->abort();
+    }
+}
@@ -1260,6 +1260,165 @@ class PluginEventHandlerRegistry(NativeObject):
 
 
 
+#-----------------------------------------------------------------------------
+# MemoryPacketRing: Shared ring of TS packets with the memory plugins
+#-----------------------------------------------------------------------------
+
+##
+# A wrapper class for C++ MemoryPacketRing.
+# @ingroup python
+#
+# A shared ring buffer of TS packets between the application and the @c memory
+# input or output plugin, using the plugin option @c --ring with the same name.
+# The application directly reads or writes the packets in the memory of the ring.
+# The areas of packets are returned as Python memoryview objects on the memory
+# of the ring. They support the buffer protocol, for instance with numpy:
+# @code
+# packets, metadata = ring.writeArea()
+# array = numpy.frombuffer(packets, dtype=numpy.uint8).reshape(-1, tsduck.MemoryPacketRing.PKT_SIZE)
+# @endcode
+#
+# This is not a zero-copy interface: the plugin copies the packets between the ring
+# and the packet buffer of the TSProcessor.
+#
+# The plugin looks for the ring when it needs the first packets. The ring can be
+# created before or after TSProcessor.start(). With the @c memory input plugin,
+# TSProcessor.start() waits for the first input packets. The packets must be written
+# in the ring from another thread, otherwise start() blocks until the end of stream.
+# Deleting the ring aborts the exchange of packets.
+#
+class MemoryPacketRing(NativeObject):
+
+    ## Size in bytes of a TS packet.
+    PKT_SIZE = 188
+
+    ##
+    # Constructor.
+    # @param name Name of the ring, as used in option @c --ring of the memory plugins.
+    # @param packet_count Capacity of the ring in TS packets.
+    #
+    def __init__(self, name, packet_count = 10000):
+        super().__init__()
+        # void* tspyNewMemoryPacketRing(const uint8_t* name, size_t name_size, size_t packet_count)
+        cfunc = _lib.tspyNewMemoryPacketRing
+        cfunc.restype = ctypes.c_void_p
+        cfunc.argtypes = [_c_uint8_p, ctypes.c_size_t, ctypes.c_size_t]
+        buf = _InByteBuffer(name)
+        self._setNative(cfunc(buf.data_ptr(), buf.size(), packet_count))
+        # size_t tspyMemoryPacketRingMetadataSize()
+        cfunc = _lib.tspyMemoryPacketRingMetadataSize
+        cfunc.restype = ctypes.c_size_t
+        cfunc.argtypes = []
+        ## Size in bytes of the metadata of a TS packet.
+        self.metadata_size = cfunc()
+
+    # Explicitly free the underlying C++ object (inherited).
+    def delete(self):
+        # void tspyDeleteMemoryPacketRing(void* ring)
+        cfunc = _lib.tspyDeleteMemoryPacketRing
+        cfunc.restype = None
+        cfunc.argtypes = [ctypes.c_void_p]
+        cfunc(self._getNative())
+        super().delete()
+
+    # Build memoryview's over an area of the ring.
+    def _views(self, count, packets, metadata):
+        if count == 0:
+            return (memoryview(b''), memoryview(b''))
+        pkt = (ctypes.c_uint8 * (count * MemoryPacketRing.PKT_SIZE)).from_address(packets.value)
+        mdata = (ctypes.c_uint8 * (count * self.metadata_size)).from_address(metadata.value)
+        return (memoryview(pkt).cast('B'), memoryview(mdata).cast('B'))
+
+    ##
+    # Get the next contiguous area of free packets in the ring (producer side, with the input plugin).
+    # @param timeout Maximum number of milliseconds to wait for free space, negative means infinite.
+    # @return A tuple of two writable memoryview objects (packets, metadata). Their size is a multiple
+    # of PKT_SIZE and @a metadata_size respectively. Empty on timeout, abort or end of stream.
+    #
+    def writeArea(self, timeout = -1):
+        # size_t tspyMemoryPacketRingGetWriteArea(void* ring, long timeout, uint8_t** packets, uint8_t** metadata)
+        cfunc = _lib.tspyMemoryPacketRingGetWriteArea
+        cfunc.restype = ctypes.c_size_t
+        cfunc.argtypes = [ctypes.c_void_p, ctypes.c_long, ctypes.POINTER(ctypes.c_void_p), ctypes.POINTER(ctypes.c_void_p)]
+        packets = ctypes.c_void_p()
+        metadata = ctypes.c_void_p()
+        count = cfunc(self._getNative(), timeout, ctypes.byref(packets), ctypes.byref(metadata))
+        return self._views(count, packets, metadata)
+
+    ##
+    # Publish packets which were written in the area from writeArea() (producer side).
+    # @param count Number of written packets.
+    # @return None.
+    #
+    def commitWrite(self, count):
+        # void tspyMemoryPacketRingCommitWrite(void* ring, size_t count)
+        cfunc = _lib.tspyMemoryPacketRingCommitWrite
+        cfunc.restype = None
+        cfunc.argtypes = [ctypes.c_void_p, ctypes.c_size_t]
+        cfunc(self._getNative(), count)
+
+    ##
+    # Signal the end of stream (producer side).
+    # @return None.
+    #
+    def setEndOfStream(self):
+        # void tspyMemoryPacketRingSetEndOfStream(void* ring)
+        cfunc = _lib.tspyMemoryPacketRingSetEndOfStream
+        cfunc.restype = None
+        cfunc.argtypes = [ctypes.c_void_p]
+        cfunc(self._getNative())
+
+    ##
+    # Get the next contiguous area of packets in the ring (consumer side, with the output plugin).
+    # @param timeout Maximum number of milliseconds to wait for packets, negative means infinite.
+    # @return A tuple of two memoryview objects (packets, metadata). Empty on timeout, abort or end of stream.
+    #
+    def readArea(self, timeout = -1):
+        # size_t tspyMemoryPacketRingGetReadArea(void* ring, long timeout, const uint8_t** packets, const uint8_t** metadata)
+        cfunc = _lib.tspyMemoryPacketRingGetReadArea
+        cfunc.restype = ctypes.c_size_t
+        cfunc.argtypes = [ctypes.c_void_p, ctypes.c_long, ctypes.POINTER(ctypes.c_void_p), ctypes.POINTER(ctypes.c_void_p)]
+        packets = ctypes.c_void_p()
+        metadata = ctypes.c_void_p()
+        count = cfunc(self._getNative(), timeout, ctypes.byref(packets), ctypes.byref(metadata))
+        return self._views(count, packets, metadata)
+
+    ##
+    # Release packets which were read from the area from readArea() (consumer side).
+    # The memoryview objects from readArea() must no longer be used.
+    # @param count Number of read packets.
+    # @return None.
+    #
+    def commitRead(self, count):
+        # void tspyMemoryPacketRingCommitRead(void* ring, size_t count)
+        cfunc = _lib.tspyMemoryPacketRingCommitRead
+        cfunc.restype = None
+        cfunc.argtypes = [ctypes.c_void_p, ctypes.c_size_t]
+        cfunc(self._getNative(), count)
+
+    ##
+    # Check if the end of stream was reached or the ring was aborted.
+    # @return True if there is no more packet to read.
+    #
+    def endOfStream(self):
+        # bool tspyMemoryPacketRingEndOfStream(void* ring)
+        cfunc = _lib.tspyMemoryPacketRingEndOfStream
+        cfunc.restype = ctypes.c_bool
+        cfunc.argtypes = [ctypes.c_void_p]
+        return bool(cfunc(self._getNative()))
+
+    ##
+    # Abort the exchange of packets. All waiting operations are interrupted.
+    # @return None.
+    #
+    def abort(self):
+        # void tspyMemoryPacketRingAbort(void* ring)
+        cfunc = _lib.tspyMemoryPacketRingAbort
+        cfunc.restype = None
+        cfunc.argtypes = [ctypes.c_void_p]
+        cfunc(self._getNative())
+
+
 #-----------------------------------------------------------------------------
 # TSPStartError: Exception class for start error in TSProcessor
 #-----------------------------------------------------------------------------
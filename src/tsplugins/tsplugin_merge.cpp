@@ -25,6 +25,7 @@
 #include "tsFatal.h"
 
 #define DEFAULT_MAX_QUEUED_PACKETS  1000            // Default size in packet of the inter-thread queue.
+#define MAX_BATCH_PACKETS           64              // Maximum number of packets which are dequeued at a time.
 #define SERVER_THREAD_STACK_SIZE    (128 * 1024)    // Size in byte of the thread stack.
 
 
@@ -75,6 +76,10 @@ namespace ts {
         PacketCounter _empty_count = 0;    // Number of times we could merge but there was no packet to merge.
         TSForkPipePtr _pipe {};            // Executed command.
         TSPacketQueue _queue {};           // TS packet queur from merge to main.
+        TSPacketVector _batch {};          // Packets which were dequeued from _queue but not yet merged.
+        size_t        _batch_next = 0;     // Index of next packet to merge in _batch.
+        size_t        _batch_count = 0;    // Number of valid packets in _batch.
+        BitRate       _batch_bitrate = 0;  // Merged bitrate when _batch was dequeued.
         PIDSet        _main_pids {};       // Set of detected PID's in main stream.
         PIDSet        _merge_pids {};      // Set of detected PID's in merged stream that we pass in main stream.
         PCRMerger     _pcr_merger {duck};  // Adjust PCR's in merged stream.
@@ -363,6 +368,9 @@ bool ts::MergePlugin::start()
 {
     // Resize the inter-thread packet queue.
     _queue.reset(_max_queue);
+    _batch.resize(MAX_BATCH_PACKETS);
+    _batch_next = _batch_count = 0;
+    _batch_bitrate = 0;
 
     // Configure the PSI merger.
     if (_merge_psi) {
@@ -525,15 +533,24 @@ ts::ProcessorPlugin::Status ts::MergePlugin::processMergePacket(TSPacket& pkt, T
     _insert_control.setMainBitRate(main_bitrate);
 
     // In case of packet insertion smoothing, check if we need to insert packets here.
-    if (_merge_smoothing && !_insert_control.mustInsert(_queue.currentSize())) {
+    if (_merge_smoothing && !_insert_control.mustInsert(_queue.currentSize() + _batch_count - _batch_next)) {
         // Don't insert now, would burst over target merged bitrate.
         _hold_count++;
         return TSP_NULL;
     }
 
+    // Dequeue all available packets at once for the next null packets, without locking the queue.
+    if (_batch_next >= _batch_count) {
+        _batch_next = 0;
+        _batch_count = _queue.getPackets(_batch.data(), _batch.size(), _batch_bitrate);
+    }
+
     // Replace current null packet in main stream with next packet from merged stream.
-    BitRate merged_bitrate = 0;
-    if (!_queue.getPacket(pkt, merged_bitrate)) {
+    const BitRate merged_bitrate = _batch_bitrate;
+    if (_batch_next < _batch_count) {
+        pkt = _batch[_batch_next++];
+    }
+    else {
         // No packet available, keep original null packet.
         _empty_count++;
         if (!_got_eof && _queue.eof()) {
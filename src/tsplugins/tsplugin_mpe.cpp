@@ -63,6 +63,11 @@ namespace ts {
         IPv4Address       _local_address {};    // Local IP address for UDP forwarding.
         uint16_t          _local_port = IPv4SocketAddress::AnyPort; // Local UDP source port for UDP forwarding.
 
+        // Forwarded datagrams are sent by batches. A batch is sent when it is full or when
+        // a given number of TS packets were processed after the first datagram in the batch.
+        static constexpr size_t MAX_BATCH = 64;
+        static constexpr PacketCounter MAX_BATCH_PACKETS = 64;
+
         // Plugin private fields.
         bool          _abort = false;           // Error, abort asap.
         UDPSocket     _sock {false, *tsp};      // Outgoing UDP socket (forwarded datagrams).
@@ -71,6 +76,9 @@ namespace ts {
         PacketCounter _datagram_count = 0;      // Number of extracted datagrams.
         std::ofstream _outfile {};              // Output file for extracted datagrams.
         MPEDemux      _demux {duck, this};      // MPE demux to extract MPE datagrams.
+        ByteBlock     _batch_data {};           // Payloads of the datagrams to forward, never reallocated.
+        std::vector<UDPSocket::OutputMessage> _batch {}; // Datagrams to forward.
+        PacketCounter _batch_packets = 0;       // Number of TS packets since the first datagram in the batch.
 
         // Inherited methods.
         virtual void handleMPENewPID(MPEDemux&, const PMT&, PID) override;
@@ -78,6 +86,9 @@ namespace ts {
 
         // Build the string for --sync-layout.
         UString syncLayoutString(const uint8_t* udp, size_t udpSize);
+
+        // Send all datagrams in the forwarding batch.
+        void sendBatch();
     };
 }
 
@@ -282,9 +293,11 @@ bool ts::MPEPlugin::getOptions()
 
 bool ts::MPEPlugin::start()
 {
-    // Initialize the MPE demux.
+    // Initialize the MPE demux. The address filters are applied before decoding the datagrams.
     _demux.reset();
     _demux.addPIDs(_pids);
+    _demux.setSourceFilter(_ip_source);
+    _demux.setDestinationFilter(_ip_dest);
 
     // Open/create output file if present.
     if (!_outfile_name.empty()) {
@@ -320,9 +333,16 @@ bool ts::MPEPlugin::start()
         }
     }
 
-    // Other states.
+    // Other states. The buffer of the forwarding batch can contain the largest datagrams.
     _datagram_count = 0;
     _previous_uc_ttl = _previous_mc_ttl = 0;
+    _batch.clear();
+    _batch_data.clear();
+    _batch_packets = 0;
+    if (_send_udp) {
+        _batch.reserve(MAX_BATCH);
+        _batch_data.reserve(MAX_BATCH * IP_MAX_PACKET_SIZE);
+    }
 
     return true;
 }
@@ -339,8 +359,9 @@ bool ts::MPEPlugin::stop()
         _outfile.close();
     }
 
-    // Close the forwarding socket.
+    // Send pending datagrams and close the forwarding socket.
     if (_sock.isOpen()) {
+        sendBatch();
         _sock.close(*tsp);
     }
 
@@ -374,11 +395,6 @@ void ts::MPEPlugin::handleMPEPacket(MPEDemux& demux, const MPEPacket& mpe)
         return;
     }
 
-    // Apply source and destination filters.
-    if (!mpe.sourceSocket().match(_ip_source) || !mpe.destinationSocket().match(_ip_dest)) {
-        return;
-    }
-
     // Network datagram and UDP payload.
     const uint8_t* const net_data = mpe.datagram();
     const uint8_t* const udp_data = mpe.udpMessage();
@@ -466,18 +482,28 @@ void ts::MPEPlugin::handleMPEPacket(MPEDemux& demux, const MPEPacket& mpe)
         const bool mc = dest.isMulticast();
         const int previous_ttl = mc ? _previous_mc_ttl : _previous_uc_ttl;
         const int mpe_ttl = mpe.datagram()[8]; // in original IP header
-        if (_ttl <= 0 && mpe_ttl != previous_ttl && _sock.setTTL(mpe_ttl, mc, *tsp)) {
-            if (mc) {
-                _previous_mc_ttl = mpe_ttl;
-            }
-            else {
-                _previous_uc_ttl = mpe_ttl;
+        if (_ttl <= 0 && mpe_ttl != previous_ttl) {
+            // The pending datagrams must be sent with the previous TTL.
+            sendBatch();
+            if (_sock.setTTL(mpe_ttl, mc, *tsp)) {
+                if (mc) {
+                    _previous_mc_ttl = mpe_ttl;
+                }
+                else {
+                    _previous_uc_ttl = mpe_ttl;
+                }
             }
         }
 
-        // Send the UDP datagram.
-        if (!_sock.send(udp_data, udp_size, dest, *tsp)) {
-            _abort = true;
+        // Add the UDP datagram in the batch. The buffer is never reallocated, previous addresses remain valid.
+        UDPSocket::OutputMessage msg;
+        msg.data = _batch_data.data() + _batch_data.size();
+        msg.size = udp_size;
+        msg.destination = dest;
+        _batch_data.append(udp_data, udp_size);
+        _batch.push_back(msg);
+        if (_batch.size() >= MAX_BATCH) {
+            sendBatch();
         }
     }
 
@@ -495,6 +521,21 @@ void ts::MPEPlugin::handleMPEPacket(MPEDemux& demux, const MPEPacket& mpe)
 }
 
 
+//----------------------------------------------------------------------------
+// Send all datagrams in the forwarding batch.
+//----------------------------------------------------------------------------
+
+void ts::MPEPlugin::sendBatch()
+{
+    if (!_batch.empty() && !_sock.send(_batch.data(), _batch.size(), *tsp)) {
+        _abort = true;
+    }
+    _batch.clear();
+    _batch_data.clear();
+    _batch_packets = 0;
+}
+
+
 //----------------------------------------------------------------------------
 // Build the string for --sync-layout.
 //----------------------------------------------------------------------------
@@ -570,5 +611,10 @@ ts::ProcessorPlugin::Status ts::MPEPlugin::processPacket(TSPacket& pkt, TSPacket
 {
     // Feed the MPE demux.
     _demux.feedPacket(pkt);
+
+    // Do not delay the forwarded datagrams for too long.
+    if (!_batch.empty() && ++_batch_packets >= MAX_BATCH_PACKETS) {
+        sendBatch();
+    }
     return _abort ? TSP_END : TSP_OK;
 }
@@ -51,13 +51,21 @@ namespace ts {
         uint16_t          _emmg_data_id = 0;        // EMMG<=>MUX data id to filter.
         size_t            _http_chunk_size = 65535; // Size to load from the TCP session each time we reload the buffer.
 
+        // Maximum number of UDP datagrams to extract at a time from the pcap file.
+        static constexpr size_t MAX_DATAGRAMS = 64;
+
         // Working data:
         PcapFilter           _pcap_udp {};          // Pcap file, in UDP mode.
         PcapStream           _pcap_tcp {};          // Pcap file, in TCP mode (DVB SimulCrypt EMMG/PDG <=> MUX).
         MicroSecond          _first_tstamp = 0;     // Time stamp of first datagram.
         IPv4SocketAddress    _actual_dest {};       // Actual destination UDP socket address.
+        IPv6SocketAddress    _actual_dest6 {};      // Actual destination UDP socket address, when IPv6.
         IPv4SocketAddress    _actual_source {};     // Actual source TCP socket address for HTTP mode.
         IPv4SocketAddressSet _all_sources {};       // All source addresses.
+        IPv6SocketAddressSet _all_sources6 {};      // All IPv6 source addresses.
+        std::array<PcapFilter::UDPDatagram, MAX_DATAGRAMS> _datagrams {}; // Last batch of UDP datagrams.
+        size_t               _datagrams_next = 0;   // Next datagram to process in _datagrams.
+        size_t               _datagrams_count = 0;  // Number of datagrams in _datagrams.
         emmgmux::Protocol    _emmgmux {};           // EMMG/PDG <=> MUX protocol instance to decode TCP stream.
         ByteBlock            _data {};              // Session data buffer, for HTTP mode.
         size_t               _data_next = 0;        // Next index in _data.
@@ -96,7 +104,7 @@ ts::PcapInputPlugin::PcapInputPlugin(TSP* tsp_) :
     option(u"", 0, FILENAME, 0, 1);
     help(u"", u"file-name",
          u"The name of a '.pcap' or '.pcapng' capture file as produced by Wireshark for instance. "
-         u"This input plugin extracts IPv4 UDP datagrams which contain transport stream packets. "
+         u"This input plugin extracts IPv4 or IPv6 UDP datagrams which contain transport stream packets. "
          u"Use the standard input by default, when no file name is specified.");
 
     option(u"destination", 'd', IPSOCKADDR_OAP);
@@ -194,8 +202,11 @@ bool ts::PcapInputPlugin::start()
 {
     _first_tstamp = -1;
     _actual_dest = _destination;
+    _actual_dest6.clear();
     _actual_source = _source;
     _all_sources.clear();
+    _all_sources6.clear();
+    _datagrams_next = _datagrams_count = 0;
     _data.clear();
     _data_next = 0;
     _data_error = false;
@@ -261,81 +272,106 @@ bool ts::PcapInputPlugin::receiveDatagram(uint8_t* buffer, size_t buffer_size, s
 
 bool ts::PcapInputPlugin::receiveUDP(uint8_t *buffer, size_t buffer_size, size_t &ret_size, MicroSecond &timestamp)
 {
-    IPv4Packet ip;
-
-    // Loop on IPv4 datagrams from the pcap file until a matching UDP packet is found (or end of file).
+    // Loop on UDP datagrams from the pcap file until a matching one is found (or end of file).
     for (;;) {
 
-        // Read one IPv4 datagram.
-        if (!_pcap_udp.readIPv4(ip, timestamp, *tsp)) {
-            return 0; // end of file, invalid pcap file format or other i/o error
+        // Extract a new batch of UDP datagrams when the previous one is exhausted.
+        if (_datagrams_next >= _datagrams_count) {
+            _datagrams_next = 0;
+            _datagrams_count = _pcap_udp.readUDP(_datagrams.data(), _datagrams.size(), *tsp);
+            if (_datagrams_count == 0) {
+                return false; // end of file, invalid pcap file format or other i/o error
+            }
         }
+        const PcapFilter::UDPDatagram& dg(_datagrams[_datagrams_next++]);
+        const bool ipv6 = dg.isIPv6();
+        timestamp = dg.timestamp;
 
-        // Get IP addresses and UDP ports.
-        const IPv4SocketAddress src(ip.sourceSocketAddress());
-        const IPv4SocketAddress dst(ip.destinationSocketAddress());
+        // Get IP addresses and UDP ports. The options are IPv4 addresses. With IPv6, only the ports can be filtered.
+        const IPv4SocketAddress src(ipv6 ? IPv4SocketAddress(IPv4Address::AnyAddress, dg.sourcePort()) : dg.sourceIPv4());
+        const IPv4SocketAddress dst(ipv6 ? IPv4SocketAddress(IPv4Address::AnyAddress, dg.destinationPort()) : dg.destinationIPv4());
+        const IPv6SocketAddress src6(ipv6 ? dg.sourceIPv6() : IPv6SocketAddress());
+        const IPv6SocketAddress dst6(ipv6 ? dg.destinationIPv6() : IPv6SocketAddress());
 
         // Filter source or destination socket address if one was specified.
-        if (!src.match(_source) || !dst.match(_actual_dest)) {
+        if (ipv6) {
+            if (_source.hasAddress() || _actual_dest.hasAddress() || !src.match(_source) || !dst.match(_actual_dest) ||
+                (_actual_dest6.hasAddress() && !dst6.match(_actual_dest6)))
+            {
+                continue; // not a matching address
+            }
+        }
+        else if (_actual_dest6.hasAddress() || !src.match(_source) || !dst.match(_actual_dest)) {
             continue; // not a matching address
         }
 
         // If the destination is not yet found, filter multicast addresses if required.
-        if (!_actual_dest.hasAddress() && _multicast && !dst.isMulticast()) {
+        const bool dest_known = _actual_dest6.hasAddress() || (_actual_dest.hasAddress() && _actual_dest.hasPort());
+        if (!dest_known && _multicast && !(ipv6 ? dst6.isMulticast() : dst.isMulticast())) {
             continue; // not a multicast address
         }
 
-        // Locate UDP payload.
-        const uint8_t* const udp_data = ip.protocolData();
-        const size_t udp_size = ip.protocolDataSize();
-
         // DVB SimulCrypt vs. raw TS.
         // The destination can be dynamically selected (address, port or both) by the first UDP datagram containing TS packets.
         if (_udp_emmg_mux) {
             // Try to decode UDP packet as DVB SimulCrypt.
-            if (!_actual_dest.hasAddress() || !_actual_dest.hasPort()) {
+            if (!dest_known) {
                 // The actual destination is not fully known yet.
                 // We are still waiting for the first UDP datagram containing a data_provision message.
                 // Is there any in this one?
-                if (!isDataProvision(udp_data, udp_size)) {
+                if (!isDataProvision(dg.data, dg.size)) {
                     continue; // no data_provision message in this UDP datagram.
                 }
-                // We just found the first UDP datagram with a data_provision message, now use this destination address all the time.
-                _actual_dest = dst;
-                tsp->verbose(u"using UDP destination address %s", {dst});
             }
 
             // Extract TS packets from the data_provision message.
-            ret_size = extractDataProvision(buffer, buffer_size, udp_data, udp_size);
-            if (ret_size == 0) {
+            ret_size = extractDataProvision(buffer, buffer_size, dg.data, dg.size);
+            if (ret_size == 0 && dest_known) {
                 continue; // no TS packets in this message
             }
         }
         else {
             // Look for raw TS.
-            if (!_actual_dest.hasAddress() || !_actual_dest.hasPort()) {
+            if (!dest_known) {
                 // The actual destination is not fully known yet.
                 // We are still waiting for the first UDP datagram containing TS packets.
                 // Is there any TS packet in this one?
                 size_t start_index = 0;
                 size_t packet_count = 0;
-                if (!TSPacket::Locate(ip.protocolData(), ip.protocolDataSize(), start_index, packet_count)) {
+                if (!TSPacket::Locate(dg.data, dg.size, start_index, packet_count)) {
                     continue; // no TS packet in this UDP datagram.
                 }
-                // We just found the first UDP datagram with TS packets, now use this destination address all the time.
-                _actual_dest = dst;
-                tsp->verbose(u"using UDP destination address %s", {dst});
             }
 
             // Now we have a valid UDP packet.
-            ret_size = std::min(ip.protocolDataSize(), buffer_size);
-            std::memmove(buffer, ip.protocolData(), ret_size);
+            ret_size = std::min(dg.size, buffer_size);
+            std::memmove(buffer, dg.data, ret_size);
+        }
+
+        // We just found the first UDP datagram with TS packets, now use this destination address all the time.
+        if (!dest_known) {
+            if (ipv6) {
+                _actual_dest6 = dst6;
+                tsp->verbose(u"using UDP destination address %s", {dst6});
+            }
+            else {
+                _actual_dest = dst;
+                tsp->verbose(u"using UDP destination address %s", {dst});
+            }
+            if (ret_size == 0) {
+                continue; // data_provision message without TS packets
+            }
         }
 
         // List all source addresses as they appear.
-        if (_all_sources.find(src) == _all_sources.end()) {
+        if (ipv6 && _all_sources6.find(src6) == _all_sources6.end()) {
+            // This is a new IPv6 source address.
+            tsp->verbose(u"%s UDP source address %s", {_all_sources.empty() && _all_sources6.empty() ? u"using" : u"adding", src6});
+            _all_sources6.insert(src6);
+        }
+        else if (!ipv6 && _all_sources.find(src) == _all_sources.end()) {
             // This is a new source address.
-            tsp->verbose(u"%s UDP source address %s", {_all_sources.empty() ? u"using" : u"adding", src});
+            tsp->verbose(u"%s UDP source address %s", {_all_sources.empty() && _all_sources6.empty() ? u"using" : u"adding", src});
             _all_sources.insert(src);
         }
 
@@ -53,6 +53,7 @@ namespace ts {
         bool      _video_attributes = false;
         bool      _audio_attributes = false;
         bool      _intra_images = false;
+        bool      _intra_images_start = false;
         bool      _negate_nal_unit_filter = false;
         bool      _multiple_files = false;
         bool      _flush_last = false;
@@ -80,6 +81,7 @@ namespace ts {
         std::ofstream     _es_file {};
         std::ostream*     _es_stream = nullptr;
         PESDemux          _demux;
+        PacketCounter     _packet_index = 0;  // Index of current TS packet in the demux.
         FileNameGenerator _pes_name_gen {};
         FileNameGenerator _es_name_gen {};
 
@@ -110,6 +112,7 @@ namespace ts {
         virtual void handleNewHEVCAttributes(PESDemux&, const PESPacket&, const HEVCAttributes&) override;
         virtual void handleNewMPEG2AudioAttributes(PESDemux&, const PESPacket&, const MPEG2AudioAttributes&) override;
         virtual void handleNewAC3Attributes(PESDemux&, const PESPacket&, const AC3Attributes&) override;
+        virtual void handleStreamIntraImage(PESDemux&, PID, size_t) override;
     };
 }
 
@@ -163,6 +166,13 @@ ts::PESPlugin::PESPlugin(TSP* tsp_) :
     option(u"intra-image", 'i');
     help(u"intra-image", u"Report intra images.");
 
+    option(u"intra-image-start");
+    help(u"intra-image-start",
+         u"Report intra images as soon as they start, without waiting for the end of the PES packet. "
+         u"Since the PES packet is not complete, the size of its payload is not reported. "
+         u"With --packet-index, the index of the TS packet where the intra image starts is reported. "
+         u"Implies --intra-image.");
+
     option(u"max-dump-count", 'x', UNSIGNED);
     help(u"max-dump-count",
          u"Specify the maximum number of times data dump occurs with options "
@@ -268,7 +278,11 @@ ts::PESPlugin::PESPlugin(TSP* tsp_) :
          u"value representing 16 bytes.");
 
     option(u"video-attributes", 'v');
-    help(u"video-attributes", u"Display video attributes.");
+    help(u"video-attributes",
+         u"Display video attributes. "
+         u"At the end of the processing, for each AVC or HEVC PID, display the number of parsed "
+         u"and repeated sequence parameter sets (SPS). A repeated SPS is not parsed again. "
+         u"A large number of parsed SPS indicates a stream with changing video parameters.");
 }
 
 
@@ -287,7 +301,8 @@ bool ts::PESPlugin::getOptions()
     _dump_avc_sei = present(u"sei-avc");
     _video_attributes = present(u"video-attributes");
     _audio_attributes = present(u"audio-attributes");
-    _intra_images = present(u"intra-image");
+    _intra_images_start = present(u"intra-image-start");
+    _intra_images = _intra_images_start || present(u"intra-image");
     _multiple_files = present(u"multiple-files");
     _flush_last = present(u"flush-last-unbounded-pes");
     getIntValue(_max_dump_size, u"max-dump-size", 0);
@@ -356,6 +371,10 @@ bool ts::PESPlugin::start()
     _demux.reset();
     _demux.setPIDFilter(_pids);
     _demux.setDefaultCodec(_default_h26x);
+    _packet_index = 0;
+
+    // With --intra-image-start, intra-images are reported as soon as they start, not at the end of the PES packet.
+    _demux.setStreaming(_intra_images_start);
 
     // Create output files.
     bool ok = openOutput(_out_filename, &_out_file, &_out, false);
@@ -437,6 +456,18 @@ bool ts::PESPlugin::stop()
     if (_flush_last && !_abort) {
         _demux.flushUnboundedPES();
     }
+
+    // Report the SPS cache statistics of AVC and HEVC PID's.
+    if (_video_attributes && _out != nullptr) {
+        for (PID pid = 0; pid < PID_MAX; ++pid) {
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            _demux.getSPSCacheStatistics(pid, hits, misses);
+            if (misses > 0) {
+                *_out << UString::Format(u"* PID 0x%X (%<d), sequence parameter sets: %'d parsed, %'d repeated", {pid, misses, hits}) << std::endl;
+            }
+        }
+    }
     if (_out_file.is_open()) {
         _out_file.close();
     }
@@ -460,6 +491,7 @@ bool ts::PESPlugin::stop()
 ts::ProcessorPlugin::Status ts::PESPlugin::processPacket(TSPacket& pkt, TSPacketMetadata& pkt_data)
 {
     _demux.feedPacket(pkt);
+    _packet_index++;
     return _abort ? TSP_END : TSP_OK;
 }
 
@@ -624,13 +656,32 @@ void ts::PESPlugin::handlePESPacket(PESDemux&, const PESPacket& pkt)
 
 void ts::PESPlugin::handleIntraImage(PESDemux& demux, const PESPacket& pkt, size_t offset)
 {
-    if (_intra_images) {
+    // In streaming mode, intra-images are reported as soon as they start, see handleStreamIntraImage().
+    if (_intra_images && !demux.streaming()) {
         *_out << "* " << prefix(pkt) << UString::Format(u", intra-image offset in PES payload: %d/%d", { offset, pkt.payloadSize() }) << std::endl;
         lastDump(*_out);
     }
 }
 
 
+//----------------------------------------------------------------------------
+// This hook is invoked in streaming mode when an intra-code image starts.
+//----------------------------------------------------------------------------
+
+void ts::PESPlugin::handleStreamIntraImage(PESDemux& demux, PID pid, size_t offset)
+{
+    if (_intra_images_start) {
+        UString line;
+        line.format(u"PID 0x%X", {pid});
+        if (_trace_packet_index) {
+            line.format(u", TS packet %'d", {_packet_index});
+        }
+        *_out << "* " << line << UString::Format(u", intra-image offset in PES payload: %d", {offset}) << std::endl;
+        lastDump(*_out);
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // This hook is invoked when a PES start code is encountered.
 //----------------------------------------------------------------------------
@@ -26,6 +26,7 @@
 #define DEFAULT_ECM_BITRATE 30000
 #define DEFAULT_ECM_INTER_PACKET  7000  // When bitrate is unknown, use 10 ECM/s for TS @10Mb/s
 #define ASYNC_HANDLER_EXTRA_STACK_SIZE (1024 * 1024)
+#define PACKET_WINDOW_SIZE 512  // Packets are scrambled by batches, inside packet windows.
 
 
 //----------------------------------------------------------------------------
@@ -82,6 +83,8 @@ namespace ts {
         virtual bool start() override;
         virtual bool stop() override;
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+        virtual size_t getPacketWindowSize() override;
+        virtual size_t processPacketWindow(TSPacketWindow&) override;
 
     private:
         // Description of a crypto-period.
@@ -160,6 +163,7 @@ namespace ts {
 
         // ScramblerPlugin state
         volatile bool     _abort = false;               // Error (service not found, etc)
+        bool              _scramble_error = false;      // Error while scrambling a batch of packets
         bool              _wait_bitrate = false;        // Waiting for bitrate to start scheduling ECM and CP.
         bool              _degraded_mode = false;       // In degraded mode (see comments above)
         PacketCounter     _packet_count = 0;            // Complete TS packet counter
@@ -179,6 +183,7 @@ namespace ts {
         size_t            _current_ecm = 0;             // Index to current ECM (ECM being broadcast)
         TSScrambling      _scrambling {*tsp};           // Scrambler
         CyclingPacketizer _pzer_pmt {duck};             // Packetizer for modified PMT
+        std::vector<TSPacket*> _batch {};               // Packets to scramble with the current CW, not yet scrambled
 
         // Initialize ECM and CP scheduling.
         void initializeScheduling();
@@ -193,6 +198,12 @@ namespace ts {
         bool changeCW();
         void changeECM();
 
+        // Process one packet, the packets to scramble are added in the batch.
+        Status handlePacket(TSPacket&);
+
+        // Scramble all packets in the batch.
+        bool scrambleBatch();
+
         // Check if we are in degraded mode or if we enter degraded mode
         bool inDegradedMode();
 
@@ -377,6 +388,7 @@ bool ts::ScramblerPlugin::start()
     _scrambled_count = 0;
     _ecm_cc = 0;
     _abort = false;
+    _scramble_error = false;
     _wait_bitrate = false;
     _degraded_mode = false;
     _ts_bitrate = 0;
@@ -455,6 +467,14 @@ bool ts::ScramblerPlugin::stop()
         _ecmg.disconnect();
     }
 
+    // Report ECM generation latency.
+    const ECMGClient::LatencyStatistics lat(_ecmg.latencyStatistics());
+    if (lat.latency.count() > 0 || lat.timeouts > 0) {
+        tsp->verbose(u"ECM latency: %'d ECM's, min: %'d ms, max: %'d ms, mean: %s ms, timeouts: %'d",
+                     {lat.latency.count(), lat.latency.minimum(), lat.latency.maximum(), lat.latency.meanString(), lat.timeouts});
+        tsp->verbose(u"ECM latency histogram: %s", {lat.histogramString()});
+    }
+
     // Terminate the scrambling engine.
     _scrambling.stop();
 
@@ -661,6 +681,11 @@ bool ts::ScramblerPlugin::tryExitDegradedMode()
 
 bool ts::ScramblerPlugin::changeCW()
 {
+    // The packets before the transition are scrambled with the previous CW.
+    if (!scrambleBatch()) {
+        return false;
+    }
+
     if (_scrambling.hasFixedCW()) {
         // A list of fixed CW was loaded from a file.
 
@@ -724,6 +749,62 @@ void ts::ScramblerPlugin::changeECM()
 //----------------------------------------------------------------------------
 
 ts::ProcessorPlugin::Status ts::ScramblerPlugin::processPacket(TSPacket& pkt, TSPacketMetadata& pkt_data)
+{
+    const Status status = handlePacket(pkt);
+    return scrambleBatch() ? status : TSP_END;
+}
+
+
+//----------------------------------------------------------------------------
+// Packet window processing: the packets are scrambled by batches.
+//----------------------------------------------------------------------------
+
+size_t ts::ScramblerPlugin::getPacketWindowSize()
+{
+    return PACKET_WINDOW_SIZE;
+}
+
+size_t ts::ScramblerPlugin::processPacketWindow(TSPacketWindow& win)
+{
+    size_t index = 0;
+    for (; index < win.size(); ++index) {
+        TSPacket* pkt = win.packet(index);
+        if (pkt != nullptr) {
+            const Status status = handlePacket(*pkt);
+            if (status == TSP_END) {
+                break;
+            }
+            else if (status == TSP_NULL) {
+                win.nullify(index);
+            }
+        }
+    }
+    scrambleBatch();
+
+    // After a scrambling error, the packets of the failed batch cannot be passed in the clear.
+    return _scramble_error ? 0 : index;
+}
+
+
+//----------------------------------------------------------------------------
+// Scramble all packets in the batch with the current CW.
+//----------------------------------------------------------------------------
+
+bool ts::ScramblerPlugin::scrambleBatch()
+{
+    if (!_scrambling.encrypt(_batch.data(), _batch.size())) {
+        _scramble_error = true;
+    }
+    _batch.clear();
+    return !_scramble_error;
+}
+
+
+//----------------------------------------------------------------------------
+// Process one packet, without scrambling it.
+//----------------------------------------------------------------------------
+
+ts::ProcessorPlugin::Status ts::ScramblerPlugin::handlePacket(TSPacket& pkt)
 {
     // Count packets
     _packet_count++;
@@ -829,10 +910,8 @@ ts::ProcessorPlugin::Status ts::ScramblerPlugin::processPacket(TSPacket& pkt, TS
         _partial_clear = _partial_scrambling - 1;
     }
 
-    // Scramble the packet payload.
-    if (!_scrambling.encrypt(pkt)) {
-        return TSP_END;
-    }
+    // The packet payload is scrambled with the other packets of the batch.
+    _batch.push_back(&pkt);
     _scrambled_count++;
 
     return TSP_OK;
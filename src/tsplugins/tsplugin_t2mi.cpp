@@ -16,6 +16,7 @@
 #include "tsT2MIDescriptor.h"
 #include "tsT2MIPacket.h"
 #include "tsTSFile.h"
+#include "tsSharedPacketRing.h"
 
 
 //----------------------------------------------------------------------------
@@ -35,7 +36,22 @@ namespace ts {
 
     private:
         // Set of identified PLP's in a PID (with --identify).
-        typedef std::bitset<256> PLPSet;
+        typedef T2MIDemux::PLPSet PLPSet;
+
+        // Output of one PLP with --split.
+        class SplitOutput
+        {
+            TS_NOCOPY(SplitOutput);
+        public:
+            SplitOutput() = default;
+            UString          name {};     // Name of the shared memory ring.
+            SharedPacketRing ring {};     // Shared memory ring.
+            PacketCounter    count = 0;   // Number of TS packets written in the ring.
+        };
+        typedef SafePtr<SplitOutput, NullMutex> SplitOutputPtr;
+
+        // Number of extracted TS packets which are fetched at a time from the demux.
+        static constexpr size_t BUFFER_PACKETS = 64;
 
         // Set of identified T2-MI PID's with their PLP's (with --identify).
         typedef std::map<PID, PLPSet> IdentifiedSet;
@@ -46,6 +62,8 @@ namespace ts {
         bool              _replace_ts = false;      // Replace transferred TS.
         bool              _log = false;             // Log T2-MI packets.
         bool              _identify = false;        // Identify T2-MI PID's and PLP's in the TS or PID.
+        bool              _split = false;           // Extract all PLP's into shared memory rings.
+        UString           _split_name {};           // Prefix of shared memory ring names with --split.
         PID               _original_pid = PID_NULL; // Original value for --pid.
         PID               _extract_pid = PID_NULL;  // PID carrying the T2-MI encapsulation.
         uint8_t           _plp = 0;                 // The PLP to extract in _pid.
@@ -57,12 +75,16 @@ namespace ts {
         PacketCounter     _ts_count = 0;            // Number of extracted TS packets.
         T2MIDemux         _demux {duck, this};      // T2-MI demux.
         IdentifiedSet     _identified {};           // Map of identified PID's and PLP's.
-        std::deque<TSPacket> _ts_queue {};          // Queue of demuxed TS packets.
+        std::map<uint8_t, SplitOutputPtr> _split_outputs {}; // Outputs of all PLP's with --split.
+        TSPacketVector    _buffer {};               // Buffer of extracted TS packets.
+
+        // Write all extracted TS packets in the output file or in the shared memory rings.
+        void writeOutputFile();
+        void writeSplitOutputs();
 
         // Inherited methods.
         virtual void handleT2MINewPID(T2MIDemux& demux, const PMT& pmt, PID pid, const T2MIDescriptor& desc) override;
         virtual void handleT2MIPacket(T2MIDemux& demux, const T2MIPacket& pkt) override;
-        virtual void handleTSPacket(T2MIDemux& demux, const T2MIPacket& t2mi, const TSPacket& ts) override;
     };
 }
 
@@ -117,6 +139,14 @@ ts::T2MIPlugin::T2MIPlugin(TSP* tsp_) :
          u"Specify the PLP (Physical Layer Pipe) to extract from the T2-MI "
          u"encapsulation. By default, use the first PLP which is found. "
          u"Ignored if --extract is not used.");
+
+    option(u"split", 's', STRING);
+    help(u"split", u"name",
+         u"Extract all PLP's from the T2-MI stream, each PLP in its own shared memory ring. "
+         u"The name of the ring for PLP N is 'name-N'. Each PLP can be processed by a separate "
+         u"tsp process using the input plugin 'shm' with the corresponding name. "
+         u"The main transport stream is passed unchanged to the next plugin. "
+         u"This option is implemented on UNIX systems only.");
 }
 
 
@@ -134,6 +164,8 @@ bool ts::T2MIPlugin::getOptions()
     getIntValue(_original_pid, u"pid", PID_NULL);
     getIntValue(_plp, u"plp");
     getValue(_outfile_name, u"output-file");
+    _split = present(u"split");
+    getValue(_split_name, u"split");
 
     // Output file open flags.
     _outfile_flags = TSFile::WRITE | TSFile::SHARED;
@@ -144,9 +176,14 @@ bool ts::T2MIPlugin::getOptions()
         _outfile_flags |= TSFile::KEEP;
     }
 
+    if (_split && (_extract || !_outfile_name.empty())) {
+        tsp->error(u"--split cannot be used with --extract or --output-file");
+        return false;
+    }
+
     // Extract is the default operation.
     // It is also implicit if an output file is specified.
-    if ((!_extract && !_log && !_identify) || !_outfile_name.empty()) {
+    if ((!_extract && !_log && !_identify && !_split) || !_outfile_name.empty()) {
         _extract = true;
     }
 
@@ -169,9 +206,15 @@ bool ts::T2MIPlugin::start()
         _demux.addPID(_extract_pid);
     }
 
+    // The extracted TS packets are accumulated in the output queues of the demux.
+    // With --split, the T2-MI packets are not needed, the TS packets are directly extracted.
+    _demux.setAllPLPQueues(_split);
+    _demux.setT2MIPacketNotification(_extract || _log || _identify);
+
     // Reset the packet output.
     _identified.clear();
-    _ts_queue.clear();
+    _split_outputs.clear();
+    _buffer.resize(BUFFER_PACKETS);
     _t2mi_count = 0;
     _ts_count = 0;
     _abort = false;
@@ -197,6 +240,13 @@ bool ts::T2MIPlugin::stop()
         tsp->verbose(u"extracted %'d TS packets from %'d T2-MI packets", {_ts_count, _t2mi_count});
     }
 
+    // With --split, close all rings and display a summary.
+    for (const auto& it : _split_outputs) {
+        it.second->ring.close();
+        tsp->verbose(u"PLP %d: extracted %'d TS packets in %s", {it.first, it.second->count, it.second->name});
+    }
+    _split_outputs.clear();
+
     // With --identify, display a summary.
     if (_identify) {
         tsp->info(u"summary: found %d PID's with T2-MI", {_identified.size()});
@@ -231,7 +281,7 @@ void ts::T2MIPlugin::handleT2MINewPID(T2MIDemux& demux, const PMT& pmt, PID pid,
     // Found a new PID carrying T2-MI.
     // Use it by default for extraction.
     if (_extract_pid == PID_NULL && pid != PID_NULL) {
-        if (_extract || _log) {
+        if (_extract || _split || _log) {
             tsp->verbose(u"using PID 0x%X (%d) to extract T2-MI stream", {pid, pid});
         }
         _extract_pid = pid;
@@ -280,8 +330,9 @@ void ts::T2MIPlugin::handleT2MIPacket(T2MIDemux& demux, const T2MIPacket& pkt)
             tsp->verbose(u"extracting PLP 0x%X (%d)", {_plp, _plp});
         }
         if (plp == _plp) {
-            // Count input T2-MI packets.
+            // Count input T2-MI packets. Accumulate the TS packets of this PLP in the demux.
             _t2mi_count++;
+            _demux.setPLPQueue(pid, _plp);
         }
     }
 
@@ -297,24 +348,50 @@ void ts::T2MIPlugin::handleT2MIPacket(T2MIDemux& demux, const T2MIPacket& pkt)
 
 
 //----------------------------------------------------------------------------
-// Process an extracted TS packet from the T2-MI stream.
+// Write all extracted TS packets in the output file.
 //----------------------------------------------------------------------------
 
-void ts::T2MIPlugin::handleTSPacket(T2MIDemux& demux, const T2MIPacket& t2mi, const TSPacket& ts)
+void ts::T2MIPlugin::writeOutputFile()
 {
-    // Keep packet from the filtered PLP only.
-    if (_extract && _plp_valid && t2mi.plp() == _plp) {
-        if (_replace_ts) {
-            // Enqueue the TS packet for replacement later.
-            // We do not really care about queue size because an overflow is not possible.
-            // This plugin deletes all input packets and replaces them with demux'ed packets.
-            // And the number of input TS packets is always higher than the number of output
-            // packets because of T2-MI encapsulation and other PID's.
-            _ts_queue.push_back(ts);
-        }
-        else {
-            // Write the packet to output file.
-            _abort = _abort || !_outfile.writePackets(&ts, nullptr, 1, *tsp);
+    size_t count = 0;
+    while (!_abort && (count = _demux.getTSPackets(_extract_pid, _plp, _buffer.data(), _buffer.size())) > 0) {
+        _abort = !_outfile.writePackets(_buffer.data(), nullptr, count, *tsp);
+        _ts_count += count;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Write all extracted TS packets in the shared memory rings, one per PLP.
+//----------------------------------------------------------------------------
+
+void ts::T2MIPlugin::writeSplitOutputs()
+{
+    PLPSet plps;
+    _demux.getPLPs(_extract_pid, plps, true);
+    for (size_t plp = 0; !_abort && plps.any() && plp < plps.size(); ++plp) {
+        if (plps.test(plp)) {
+            plps.reset(plp);
+
+            // Create the ring of a new PLP.
+            SplitOutputPtr& out(_split_outputs[uint8_t(plp)]);
+            if (out.isNull()) {
+                out = new SplitOutput;
+                out->name.format(u"%s-%d", {_split_name, plp});
+                if (!out->ring.create(out->name, SharedPacketRing::DEFAULT_PACKET_COUNT, SharedPacketRing::DEFAULT_MAX_READERS, SharedPacketRing::LagPolicy::DROP, *tsp)) {
+                    _abort = true;
+                    break;
+                }
+                tsp->verbose(u"extracting PLP %d into %s", {plp, out->name});
+            }
+
+            // Write all extracted TS packets of the PLP.
+            size_t count = 0;
+            while (!_abort && (count = _demux.getTSPackets(_extract_pid, uint8_t(plp), _buffer.data(), _buffer.size())) > 0) {
+                _abort = !out->ring.write(_buffer.data(), nullptr, count, *tsp, tsp);
+                out->count += count;
+                _ts_count += count;
+            }
         }
     }
 }
@@ -329,21 +406,33 @@ ts::ProcessorPlugin::Status ts::T2MIPlugin::processPacket(TSPacket& pkt, TSPacke
     // Feed the T2-MI demux.
     _demux.feedPacket(pkt);
 
+    // Output the extracted TS packets which are not inserted in the transport stream.
+    if (pkt.getPID() == _extract_pid) {
+        if (_split) {
+            writeSplitOutputs();
+        }
+        else if (_extract && !_replace_ts) {
+            writeOutputFile();
+        }
+    }
+
     if (_abort) {
         return TSP_END;
     }
-    else if (!_extract) {
+    else if (!_replace_ts) {
         // Without TS replacement, we simply pass all packets, unchanged.
         return TSP_OK;
     }
-    else if (_ts_queue.empty()) {
+    else if (!_plp_valid || _demux.getTSPackets(_extract_pid, _plp, &pkt, 1) == 0) {
         // No extracted packet to output, drop current packet.
+        // We do not really care about queue size because an overflow is not possible.
+        // This plugin deletes all input packets and replaces them with demux'ed packets.
+        // And the number of input TS packets is always higher than the number of output
+        // packets because of T2-MI encapsulation and other PID's.
         return TSP_DROP;
     }
     else {
-        // Replace the current packet with the next demux'ed TS packet.
-        pkt = _ts_queue.front();
-        _ts_queue.pop_front();
+        // The current packet was replaced with the next demux'ed TS packet.
         _ts_count++;
         return TSP_OK;
     }
@@ -68,6 +68,8 @@ ts::TimeShiftPlugin::TimeShiftPlugin (TSP* tsp_) :
     help(u"memory-packets",
          u"Specify the number of packets which are cached in memory. "
          u"Having a larger memory cache improves the performances. "
+         u"When the buffer is backed up on disk, the memory cache is used for read-ahead and write-behind "
+         u"blocks and the disk accesses are performed by a background thread. "
          u"By default, the size of the memory cache is " +
          UString::Decimal(TimeShiftBuffer::DEFAULT_MEMORY_PACKETS) + u" packets.");
 
@@ -14,8 +14,11 @@
 #include "tsTSAnalyzerReport.h"
 #include "tsTSAnalyzerOptions.h"
 #include "tsTSFile.h"
+#include "tsFileBatch.h"
+#include "tsGuardMutex.h"
 #include "tsPagerArgs.h"
 #include "tsDuckContext.h"
+#include "tsjsonObject.h"
 TS_MAIN(MainCode);
 
 
@@ -24,6 +27,20 @@ TS_MAIN(MainCode);
 //----------------------------------------------------------------------------
 
 namespace {
+    class Options;
+
+    // Analysis of one input file, possibly in a pool of threads.
+    class AnalyzeBatch: public ts::FileBatch
+    {
+        TS_NOBUILD_NOCOPY(AnalyzeBatch);
+    public:
+        AnalyzeBatch(Options& opt) : _opt(opt) {}
+    protected:
+        virtual bool processFile(const ts::UString& file_name, std::ostream& output, ts::Report& report, ts::json::Object& summary) override;
+    private:
+        Options& _opt;
+    };
+
     class Options: public ts::Args
     {
         TS_NOBUILD_NOCOPY(Options);
@@ -31,16 +48,17 @@ namespace {
         Options(int argc, char *argv[]);
 
         ts::DuckContext       duck {this};         // TSDuck execution context.
+        ts::DuckContext::SavedArgs duck_args {};   // Context options, for each input file.
         ts::BitRate           bitrate = 0;         // Expected bitrate (188-byte packets)
-        ts::UString           infile {};           // Input file name
         ts::TSPacketFormat    format = ts::TSPacketFormat::AUTODETECT; // Input file format.
         ts::TSAnalyzerOptions analysis {};         // Analysis options.
         ts::PagerArgs         pager {true, true};  // Output paging options.
+        AnalyzeBatch          batch {*this};       // Input files.
     };
 }
 
 Options::Options(int argc, char *argv[]) :
-    ts::Args(u"Analyze the structure of a transport stream", u"[options] [filename]")
+    ts::Args(u"Analyze the structure of a transport stream", u"[options] [filename ...]")
 {
     // Define all standard analysis options.
     duck.defineArgsForStandards(*this);
@@ -49,10 +67,14 @@ Options::Options(int argc, char *argv[]) :
     duck.defineArgsForPDS(*this);
     pager.defineArgs(*this);
     analysis.defineArgs(*this);
+    batch.defineArgs(*this);
     ts::DefineTSPacketFormatInputOption(*this);
 
-    option(u"", 0, FILENAME, 0, 1);
-    help(u"", u"Input transport stream file (standard input if omitted).");
+    option(u"", 0, FILENAME, 0, UNLIMITED_COUNT);
+    help(u"", u"filename ...",
+         u"Input transport stream files (standard input if omitted). "
+         u"When several files are specified, they are analyzed in parallel and "
+         u"one report is produced per file.");
 
     option<ts::BitRate>(u"bitrate", 'b');
     help(u"bitrate",
@@ -64,45 +86,78 @@ Options::Options(int argc, char *argv[]) :
 
     // Define all standard analysis options.
     duck.loadArgs(*this);
+    duck.saveArgs(duck_args);
     pager.loadArgs(duck, *this);
     analysis.loadArgs(duck, *this);
+    batch.loadArgs(*this);
 
-    getValue(infile, u"");
     getValue(bitrate, u"bitrate");
     format = ts::LoadTSPacketFormatInputOption(*this);
+    if (analysis.json.useJSON()) {
+        batch.setReportSuffix(u".json");
+    }
 
     exitOnError();
 }
 
 
 //----------------------------------------------------------------------------
-//  Program entry point
+//  Analyze one input file.
 //----------------------------------------------------------------------------
 
-int MainCode(int argc, char *argv[])
+bool AnalyzeBatch::processFile(const ts::UString& file_name, std::ostream& output, ts::Report& report, ts::json::Object& summary)
 {
-    // Decode command line options.
-    Options opt(argc, argv);
+    // Private TSDuck context for this file.
+    ts::DuckContext duck(&report, &output);
+    duck.restoreArgs(_opt.duck_args);
 
     // Configure the TS analyzer.
-    ts::TSAnalyzerReport analyzer(opt.duck, opt.bitrate, ts::BitRateConfidence::OVERRIDE);
-    analyzer.setAnalysisOptions(opt.analysis);
+    ts::TSAnalyzerReport analyzer(duck, _opt.bitrate, ts::BitRateConfidence::OVERRIDE);
+    analyzer.setAnalysisOptions(_opt.analysis);
 
     // Open the TS file.
     ts::TSFile file;
-    if (!file.openRead(opt.infile, 1, 0, opt, opt.format)) {
-        return EXIT_FAILURE;
+    if (!file.openRead(file_name, 1, 0, report, _opt.format)) {
+        return false;
     }
 
     // Analyze all packets in the file.
     ts::TSPacket pkt;
-    while (file.readPackets(&pkt, nullptr, 1, opt) > 0) {
+    uint64_t count = 0;
+    while (file.readPackets(&pkt, nullptr, 1, report) > 0) {
         analyzer.feedPacket(pkt);
+        count++;
+    }
+    file.close(report);
+
+    // Display analysis results. The analysis options are shared by all files
+    // and may be used to send JSON reports to a common destination.
+    {
+        ts::GuardMutex lock(mutex());
+        analyzer.report(output, _opt.analysis, report);
     }
-    file.close(opt);
 
-    // Display analysis results.
-    analyzer.report(opt.pager.output(opt), opt.analysis, opt);
+    // Summary for batch processing.
+    std::vector<uint16_t> services;
+    std::vector<ts::PID> pids;
+    analyzer.getServiceIds(services);
+    analyzer.getPIDs(pids);
+    summary.add(u"packets", count);
+    summary.add(u"services", services.size());
+    summary.add(u"pids", pids.size());
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+//  Program entry point
+//----------------------------------------------------------------------------
+
+int MainCode(int argc, char *argv[])
+{
+    // Decode command line options.
+    Options opt(argc, argv);
 
-    return EXIT_SUCCESS;
+    // Analyze all files.
+    return opt.batch.run(opt, opt.batch.useOutputStream() ? opt.pager.output(opt) : std::cout) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -13,14 +13,9 @@
 #include "tsMain.h"
 #include "tsDuckContext.h"
 #include "tsAsyncReport.h"
-#include "tsNullReport.h"
-#include "tsFatal.h"
-#include "tsMutex.h"
-#include "tsThread.h"
 #include "tsSysUtils.h"
 #include "tsECMGSCS.h"
-#include "tsTCPServer.h"
-#include "tstlvConnection.h"
+#include "tstlvServer.h"
 #include "tsDuckProtocol.h"
 #include "tsOptional.h"
 #include "tsOneShotPacketizer.h"
@@ -34,13 +29,6 @@ namespace {
     static const int16_t  DEFAULT_DELAY_STOP        = 200;
     static const int16_t  DEFAULT_TRANS_DELAY_START = -500;
     static const int16_t  DEFAULT_TRANS_DELAY_STOP  = 0;
-
-    // Stack size for execution of the client connection thread
-    static constexpr size_t CLIENT_STACK_SIZE = 128 * 1024;
-
-    // Instantiation of a TCP connection in a multi-thread context for TLV messages.
-    typedef ts::tlv::Connection<ts::Mutex> ECMGConnection;
-    typedef ts::SafePtr<ECMGConnection, ts::Mutex> ECMGConnectionPtr;
 }
 
 
@@ -89,7 +77,8 @@ ECMGOptions::ECMGOptions(int argc, char *argv[]) :
          u"This option specifies the computation time of an ECM. The clear ECM's "
          u"which are generated by this ECMG take no time to generate. But, in "
          u"order to emulate the behaviour of a real ECMG, this parameter forces "
-         u"a delay of the specified duration before returning an ECM.");
+         u"a delay of the specified duration before returning an ECM. The responses "
+         u"are always returned in the order of the requests.");
 
     option(u"cw-per-ecm", 'c', INTEGER, 0, 1, 1, 255);
     help(u"cw-per-ecm",
@@ -203,203 +192,230 @@ ECMGOptions::ECMGOptions(int argc, char *argv[]) :
 
 
 //----------------------------------------------------------------------------
-// A class implementing the ECMG shared data, used from all threads.
+// A class implementing the ECMG server. All clients are served by one
+// event-driven TLV server, in the context of the main thread.
 //----------------------------------------------------------------------------
 
-class ECMGSharedData
+class ECMGServer: private ts::tlv::ServerHandlerInterface
 {
-    TS_NOBUILD_NOCOPY(ECMGSharedData);
+    TS_NOBUILD_NOCOPY(ECMGServer);
 public:
     // Constructor.
-    ECMGSharedData(const ECMGOptions& opt);
+    ECMGServer(const ECMGOptions& opt);
 
-    // Declare a new ECM_channel_id. Return false if already active.
-    bool openChannel(uint16_t id);
-
-    // Release a ECM_channel_id. Return false if not active.
-    bool closeChannel(uint16_t id);
+    // Open the server and serve clients.
+    bool run();
 
     // Get the shared asynchronous report facility.
     ts::Report& report() { return _report; }
 
-    // Get the shared asynchronous protocol message logger.
-    ts::tlv::Logger& logger() { return _logger; }
-
 private:
-    ts::AsyncReport    _report;       // Asynchronous message report.
-    ts::tlv::Logger    _logger;       // Protocol message logger.
-    ts::Mutex          _mutex {};     // Protect shared data.
-    std::set<uint16_t> _channels {};  // Active channels.
+    // A response in the output queue of a session.
+    class Response
+    {
+    public:
+        ts::tlv::MessagePtr msg {};        // Response message.
+        uint64_t            cookie = 0;    // Timer cookie of a delayed response.
+        bool                ready = false; // Sent as soon as all previous responses are sent.
+    };
+
+    // Description of a client session.
+    class Session
+    {
+    public:
+        ts::UString                 peer {};       // Client peer name.
+        std::optional<uint16_t>     channel {};    // Current channel id.
+        std::map<uint16_t,uint16_t> streams {};    // Map of current stream id => ECM id.
+        std::deque<Response>        pending {};    // FIFO of responses behind an ECM response which waits for the emulated computation time.
+    };
+
+    const ECMGOptions&           _opt;
+    ts::AsyncReport              _report;        // Asynchronous message report.
+    ts::tlv::Logger              _logger;        // Protocol message logger.
+    ts::duck::Protocol           _protocol {};   // To encode ECM structure.
+    std::set<uint16_t>           _channels {};   // Active channels.
+    std::map<uint32_t, Session>  _sessions {};   // Client sessions, indexed by client id.
+    uint64_t                     _next_cookie = 0;
+    ts::tlv::Server              _server;        // Event-driven TLV server, must be destroyed first (its destructor notifies disconnections).
+
+    // Implementation of ServerHandlerInterface.
+    virtual void handleConnection(ts::tlv::Server& server, uint32_t client) override;
+    virtual void handleMessage(ts::tlv::Server& server, uint32_t client, const ts::tlv::MessagePtr& msg) override;
+    virtual void handleTimer(ts::tlv::Server& server, uint32_t client, uint64_t cookie) override;
+    virtual void handleDisconnection(ts::tlv::Server& server, uint32_t client) override;
+
+    // Handle the various ECMG client messages.
+    void handleChannelSetup(uint32_t client, Session& session, ts::ecmgscs::ChannelSetup* msg);
+    void handleChannelTest(uint32_t client, Session& session, ts::ecmgscs::ChannelTest* msg);
+    void handleChannelClose(uint32_t client, Session& session, ts::ecmgscs::ChannelClose* msg);
+    void handleStreamSetup(uint32_t client, Session& session, ts::ecmgscs::StreamSetup* msg);
+    void handleStreamTest(uint32_t client, Session& session, ts::ecmgscs::StreamTest* msg);
+    void handleStreamCloseRequest(uint32_t client, Session& session, ts::ecmgscs::StreamCloseRequest* msg);
+    void handleCWProvision(uint32_t client, Session& session, ts::ecmgscs::CWProvision* msg);
+
+    // Send a response, in order, after all previous delayed responses of the session.
+    void sendResponse(uint32_t client, Session& session, const ts::tlv::MessagePtr& resp, ts::MilliSecond delay = 0);
+
+    // Send all responses at the head of the queue of a session which are ready.
+    void flushResponses(uint32_t client, Session& session);
+
+    // Send an error related to the msg.
+    void sendErrorResponse(uint32_t client, Session& session, const ts::tlv::Message* msg, uint16_t errorStatus);
 };
 
 
 //----------------------------------------------------------------------------
-// Implementation of ECMGSharedData.
+// ECMG server constructor.
 //----------------------------------------------------------------------------
 
-// Constructor.
-ECMGSharedData::ECMGSharedData(const ECMGOptions& opt) :
+ECMGServer::ECMGServer(const ECMGOptions& opt) :
+    _opt(opt),
     _report(opt.maxSeverity(), opt.logArgs),
-    _logger(opt.logProtocol, &_report)
+    _logger(opt.logProtocol, &_report),
+    _server(opt.ecmgscs, this, _logger, 3)
 {
     // The CW/ECM data messages have a distinct log level.
     _logger.setSeverity(ts::ecmgscs::Tags::CW_provision, opt.logData);
     _logger.setSeverity(ts::ecmgscs::Tags::ECM_response, opt.logData);
 }
 
-// Declare a new ECM_channel_id. Return false if already active.
-bool ECMGSharedData::openChannel(uint16_t id)
-{
-    ts::GuardMutex lock(_mutex);
-    const bool ok = _channels.count(id) == 0;
-    _channels.insert(id);
-    return ok;
-}
 
-// Release a ECM_channel_id. Return false if not active.
-bool ECMGSharedData::closeChannel(uint16_t id)
+//----------------------------------------------------------------------------
+// Open the server and serve clients.
+//----------------------------------------------------------------------------
+
+bool ECMGServer::run()
 {
-    ts::GuardMutex lock(_mutex);
-    const bool ok = _channels.count(id) != 0;
-    _channels.erase(id);
-    return ok;
+    if (!_server.open(_opt.serverAddress, _opt.reusePort)) {
+        return false;
+    }
+    _report.verbose(u"TCP server listening on %s, using ECMG <=> SCS protocol version %d", {_opt.serverAddress, _opt.ecmgscs.version()});
+    return _server.run();
 }
 
 
 //----------------------------------------------------------------------------
-// A class implementing a thread which manages a client connection.
+// Client connection and disconnection.
 //----------------------------------------------------------------------------
 
-class ECMGClientHandler: public ts::Thread
+void ECMGServer::handleConnection(ts::tlv::Server& server, uint32_t client)
 {
-    TS_NOBUILD_NOCOPY(ECMGClientHandler);
-public:
-    // Constructor.
-    // When deleteWhenTerminated is true, this object is automatically deleted when the thread terminates.
-    ECMGClientHandler(const ECMGOptions& opt, const ECMGConnectionPtr& conn, ECMGSharedData* shared, bool deleteWhenTerminated);
-
-    // Destructor.
-    virtual ~ECMGClientHandler() override;
-
-    // Main code of the thread.
-    virtual void main() override;
-
-private:
-    const ECMGOptions&          _opt;
-    ts::duck::Protocol          _protocol {};   // To encode ECM structure.
-    ECMGSharedData*             _shared = nullptr;
-    ECMGConnectionPtr           _conn {};
-    ts::UString                 _peer {};
-    std::optional<uint16_t>     _channel {};    // Current channel id.
-    std::map<uint16_t,uint16_t> _streams {};    // Map of current stream id => ECM id.
+    Session& session(_sessions[client]);
+    session.peer = server.peerName(client);
+    _report.verbose(u"%s: session started", {session.peer});
 
-    // Handle the various ECMG client messages.
-    bool handleChannelSetup(ts::ecmgscs::ChannelSetup* msg);
-    bool handleChannelTest(ts::ecmgscs::ChannelTest* msg);
-    bool handleChannelClose(ts::ecmgscs::ChannelClose* msg);
-    bool handleStreamSetup(ts::ecmgscs::StreamSetup* msg);
-    bool handleStreamTest(ts::ecmgscs::StreamTest* msg);
-    bool handleStreamCloseRequest(ts::ecmgscs::StreamCloseRequest* msg);
-    bool handleCWProvision(ts::ecmgscs::CWProvision* msg);
-
-    // Send a response message.
-    bool send(const ts::tlv::Message* msg)
-    {
-        return _conn->send(*msg, _shared->logger());
+    // If --once is specified, serve only this client and exit at the end of the session.
+    if (_opt.once) {
+        server.stopAccepting();
     }
+}
 
-    // Send an error related to the msg.
-    bool sendErrorResponse(const ts::tlv::Message* msg, uint16_t errorStatus);
-};
+void ECMGServer::handleDisconnection(ts::tlv::Server&, uint32_t client)
+{
+    // Make sure to release the channel if not done by the clients.
+    const auto it = _sessions.find(client);
+    if (it != _sessions.end()) {
+        if (it->second.channel.has_value()) {
+            _channels.erase(it->second.channel.value());
+        }
+        _report.verbose(u"%s: session completed", {it->second.peer});
+        _sessions.erase(it);
+    }
+}
 
 
 //----------------------------------------------------------------------------
-// ECMG client constructor and destructor.
+// Dispatch incoming messages.
 //----------------------------------------------------------------------------
 
-ECMGClientHandler::ECMGClientHandler(const ECMGOptions& opt, const ECMGConnectionPtr& conn, ECMGSharedData* shared, bool deleteWhenTerminated) :
-    _opt(opt),
-    _shared(shared),
-    _conn(conn)
+void ECMGServer::handleMessage(ts::tlv::Server&, uint32_t client, const ts::tlv::MessagePtr& msg)
 {
-    // Set thread attributes. Beware of deleteWhenTerminated...
-    ts::ThreadAttributes attr;
-    attr.setStackSize(CLIENT_STACK_SIZE);
-    attr.setDeleteWhenTerminated(deleteWhenTerminated);
-    setAttributes(attr);
-}
+    Session& session(_sessions[client]);
 
-ECMGClientHandler::~ECMGClientHandler()
-{
-    // Wait for completion of the thread.
-    waitForTermination();
+    // Normally, an ECMG should handle incoming and outgoing messages independently.
+    // However, here we have a minimal implementation. We never send any request to
+    // the client, we simply respond to requests from the client.
+
+    switch (msg->tag()) {
+        case ts::ecmgscs::Tags::channel_setup:
+            handleChannelSetup(client, session, dynamic_cast<ts::ecmgscs::ChannelSetup*>(msg.pointer()));
+            break;
+        case ts::ecmgscs::Tags::channel_test:
+            handleChannelTest(client, session, dynamic_cast<ts::ecmgscs::ChannelTest*>(msg.pointer()));
+            break;
+        case ts::ecmgscs::Tags::channel_close:
+            handleChannelClose(client, session, dynamic_cast<ts::ecmgscs::ChannelClose*>(msg.pointer()));
+            break;
+        case ts::ecmgscs::Tags::stream_setup:
+            handleStreamSetup(client, session, dynamic_cast<ts::ecmgscs::StreamSetup*>(msg.pointer()));
+            break;
+        case ts::ecmgscs::Tags::stream_test:
+            handleStreamTest(client, session, dynamic_cast<ts::ecmgscs::StreamTest*>(msg.pointer()));
+            break;
+        case ts::ecmgscs::Tags::stream_close_request:
+            handleStreamCloseRequest(client, session, dynamic_cast<ts::ecmgscs::StreamCloseRequest*>(msg.pointer()));
+            break;
+        case ts::ecmgscs::Tags::CW_provision:
+            handleCWProvision(client, session, dynamic_cast<ts::ecmgscs::CWProvision*>(msg.pointer()));
+            break;
+        case ts::ecmgscs::Tags::channel_status:
+        case ts::ecmgscs::Tags::stream_status:
+        case ts::ecmgscs::Tags::channel_error:
+        case ts::ecmgscs::Tags::stream_error:
+            // Silently ignore unsollicited status or error messages.
+            break;
+        default:
+            // Received an invalid message for ECMG.
+            sendErrorResponse(client, session, msg.pointer(), ts::ecmgscs::Errors::inv_message);
+            break;
+    }
 }
 
 
 //----------------------------------------------------------------------------
-// Main code of the client connection thread.
+// Send responses, in order, with or without emulated computation time.
 //----------------------------------------------------------------------------
 
-void ECMGClientHandler::main()
+void ECMGServer::sendResponse(uint32_t client, Session& session, const ts::tlv::MessagePtr& resp, ts::MilliSecond delay)
 {
-    _peer = _conn->peerName();
-    _shared->report().verbose(u"%s: session started", {_peer});
+    if (delay <= 0 && session.pending.empty()) {
+        // Nothing to wait for, send now.
+        _server.send(client, *resp);
+    }
+    else {
+        // Enqueue the response behind the previous delayed responses.
+        session.pending.emplace_back();
+        Response& r(session.pending.back());
+        r.msg = resp;
+        r.ready = delay <= 0;
+        if (!r.ready) {
+            r.cookie = _next_cookie++;
+            _server.startTimer(client, delay, r.cookie);
+        }
+    }
+}
 
-    // Normally, an ECMG should handle incoming and outgoing messages independently.
-    // However, here we have a minimal implementation. We never send any request to
-    // the client and the ECM generation is instantaneous. So, we simply wait for
-    // requests from the client and respond to them immediately.
-
-    // Loop on message reception
-    ts::tlv::MessagePtr msg;
-    bool ok = true;
-    while (ok && _conn->receive(msg, nullptr, _shared->logger())) {
-        switch (msg->tag()) {
-            case ts::ecmgscs::Tags::channel_setup:
-                ok = handleChannelSetup(dynamic_cast<ts::ecmgscs::ChannelSetup*>(msg.pointer()));
-                break;
-            case ts::ecmgscs::Tags::channel_test:
-                ok = handleChannelTest(dynamic_cast<ts::ecmgscs::ChannelTest*>(msg.pointer()));
-                break;
-            case ts::ecmgscs::Tags::channel_close:
-                ok = handleChannelClose(dynamic_cast<ts::ecmgscs::ChannelClose*>(msg.pointer()));
-                break;
-            case ts::ecmgscs::Tags::stream_setup:
-                ok = handleStreamSetup(dynamic_cast<ts::ecmgscs::StreamSetup*>(msg.pointer()));
-                break;
-            case ts::ecmgscs::Tags::stream_test:
-                ok = handleStreamTest(dynamic_cast<ts::ecmgscs::StreamTest*>(msg.pointer()));
-                break;
-            case ts::ecmgscs::Tags::stream_close_request:
-                ok = handleStreamCloseRequest(dynamic_cast<ts::ecmgscs::StreamCloseRequest*>(msg.pointer()));
-                break;
-            case ts::ecmgscs::Tags::CW_provision:
-                ok = handleCWProvision(dynamic_cast<ts::ecmgscs::CWProvision*>(msg.pointer()));
-                break;
-            case ts::ecmgscs::Tags::channel_status:
-            case ts::ecmgscs::Tags::stream_status:
-            case ts::ecmgscs::Tags::channel_error:
-            case ts::ecmgscs::Tags::stream_error:
-                // Silently ignore unsollicited status or error messages.
-                break;
-            default:
-                // Received an invalid message for ECMG.
-                ok = sendErrorResponse(msg.pointer(), ts::ecmgscs::Errors::inv_message);
+void ECMGServer::handleTimer(ts::tlv::Server&, uint32_t client, uint64_t cookie)
+{
+    // The response may have been dropped when the channel was closed.
+    const auto sit = _sessions.find(client);
+    if (sit != _sessions.end()) {
+        for (auto& r : sit->second.pending) {
+            if (!r.ready && r.cookie == cookie) {
+                r.ready = true;
+                flushResponses(client, sit->second);
                 break;
+            }
         }
     }
+}
 
-    // Error while receiving or sending messages, most likely a client disconnection.
-    _conn->disconnect(NULLREP);
-    _conn->close(_shared->report());
-
-    // Make sure to release the channel if not done by the clients.
-    if (_channel.has_value()) {
-        _shared->closeChannel(_channel.value());
-        _channel.reset();
+void ECMGServer::flushResponses(uint32_t client, Session& session)
+{
+    while (!session.pending.empty() && session.pending.front().ready) {
+        _server.send(client, *session.pending.front().msg);
+        session.pending.pop_front();
     }
-
-    _shared->report().verbose(u"%s: session completed", {_peer});
 }
 
 
@@ -407,37 +423,32 @@ void ECMGClientHandler::main()
 // Send an error related to the msg.
 //----------------------------------------------------------------------------
 
-bool ECMGClientHandler::sendErrorResponse(const ts::tlv::Message* msg, uint16_t errorStatus)
+void ECMGServer::sendErrorResponse(uint32_t client, Session& session, const ts::tlv::Message* msg, uint16_t errorStatus)
 {
     const ts::tlv::ChannelMessage* channelMsg = nullptr;
     const ts::tlv::StreamMessage* streamMsg = nullptr;
-    ts::ecmgscs::ChannelError channelError(_opt.ecmgscs);
-    ts::ecmgscs::StreamError streamError(_opt.ecmgscs);
-    ts::tlv::Message* resp = nullptr;
+    ts::tlv::MessagePtr resp;
 
     // Build the appropriate response.
     if ((streamMsg = dynamic_cast<const ts::tlv::StreamMessage*>(msg)) != nullptr) {
         // Response to a stream message.
-        streamError.channel_id = streamMsg->channel_id;
-        streamError.stream_id = streamMsg->stream_id;
-        streamError.error_status.push_back(errorStatus);
-        resp = &streamError;
-    }
-    else if ((channelMsg = dynamic_cast<const ts::tlv::ChannelMessage*>(msg)) != nullptr) {
-        // Response to a channel message.
-        channelError.channel_id = channelMsg->channel_id;
-        channelError.error_status.push_back(errorStatus);
-        resp = &channelError;
+        ts::ecmgscs::StreamError* streamError = new ts::ecmgscs::StreamError(_opt.ecmgscs);
+        resp = streamError;
+        streamError->channel_id = streamMsg->channel_id;
+        streamError->stream_id = streamMsg->stream_id;
+        streamError->error_status.push_back(errorStatus);
     }
     else {
-        // Response to garbage.
-        channelError.channel_id = 0;
-        channelError.error_status.push_back(errorStatus);
-        resp = &channelError;
+        // Response to a channel message or to garbage.
+        ts::ecmgscs::ChannelError* channelError = new ts::ecmgscs::ChannelError(_opt.ecmgscs);
+        resp = channelError;
+        channelMsg = dynamic_cast<const ts::tlv::ChannelMessage*>(msg);
+        channelError->channel_id = channelMsg == nullptr ? 0 : channelMsg->channel_id;
+        channelError->error_status.push_back(errorStatus);
     }
 
     // Send the response.
-    return send(resp);
+    sendResponse(client, session, resp);
 }
 
 
@@ -445,149 +456,154 @@ bool ECMGClientHandler::sendErrorResponse(const ts::tlv::Message* msg, uint16_t
 // Handle the various types of messages from the client.
 //----------------------------------------------------------------------------
 
-bool ECMGClientHandler::handleChannelSetup(ts::ecmgscs::ChannelSetup* msg)
+void ECMGServer::handleChannelSetup(uint32_t client, Session& session, ts::ecmgscs::ChannelSetup* msg)
 {
     assert(msg != nullptr);
-    if (_channel.has_value()) {
+    if (session.channel.has_value()) {
         // Channel already set in this session.
-        return sendErrorResponse(msg, ts::ecmgscs::Errors::inv_channel_id);
+        sendErrorResponse(client, session, msg, ts::ecmgscs::Errors::inv_channel_id);
     }
-    else if (!_shared->openChannel(msg->channel_id)) {
+    else if (!_channels.insert(msg->channel_id).second) {
         // Channel id already in use.
-        return sendErrorResponse(msg, ts::ecmgscs::Errors::channel_id_in_use);
+        sendErrorResponse(client, session, msg, ts::ecmgscs::Errors::channel_id_in_use);
     }
     else {
         // Channel accepted.
-        _channel = msg->channel_id;
-        ts::ecmgscs::ChannelStatus resp(_opt.channelStatus);
-        resp.channel_id = msg->channel_id;
-        return send(&resp);
+        session.channel = msg->channel_id;
+        ts::ecmgscs::ChannelStatus* resp = new ts::ecmgscs::ChannelStatus(_opt.channelStatus);
+        ts::tlv::MessagePtr respPtr(resp);
+        resp->channel_id = msg->channel_id;
+        sendResponse(client, session, respPtr);
     }
 }
 
 
-bool ECMGClientHandler::handleChannelTest(ts::ecmgscs::ChannelTest* msg)
+void ECMGServer::handleChannelTest(uint32_t client, Session& session, ts::ecmgscs::ChannelTest* msg)
 {
     assert(msg != nullptr);
-    if (_channel != msg->channel_id) {
+    if (session.channel != msg->channel_id) {
         // Not the right channel.
-        return sendErrorResponse(msg, ts::ecmgscs::Errors::inv_channel_id);
+        sendErrorResponse(client, session, msg, ts::ecmgscs::Errors::inv_channel_id);
     }
     else {
         // Channel ok.
-        _channel = msg->channel_id;
-        ts::ecmgscs::ChannelStatus resp(_opt.channelStatus);
-        resp.channel_id = msg->channel_id;
-        return send(&resp);
+        ts::ecmgscs::ChannelStatus* resp = new ts::ecmgscs::ChannelStatus(_opt.channelStatus);
+        ts::tlv::MessagePtr respPtr(resp);
+        resp->channel_id = msg->channel_id;
+        sendResponse(client, session, respPtr);
     }
 }
 
 
-bool ECMGClientHandler::handleChannelClose(ts::ecmgscs::ChannelClose* msg)
+void ECMGServer::handleChannelClose(uint32_t client, Session& session, ts::ecmgscs::ChannelClose* msg)
 {
     assert(msg != nullptr);
-    if (_channel != msg->channel_id) {
+    if (session.channel != msg->channel_id) {
         // Not the right channel.
-        return sendErrorResponse(msg, ts::ecmgscs::Errors::inv_channel_id);
+        sendErrorResponse(client, session, msg, ts::ecmgscs::Errors::inv_channel_id);
     }
     else {
         // Channel ok, close everything, no response expected.
-        _shared->closeChannel(msg->channel_id);
-        _channel.reset();
-        _streams.clear();
-        return true;
+        _channels.erase(msg->channel_id);
+        session.channel.reset();
+        session.streams.clear();
+        session.pending.clear();
     }
 }
 
 
-bool ECMGClientHandler::handleStreamSetup(ts::ecmgscs::StreamSetup* msg)
+void ECMGServer::handleStreamSetup(uint32_t client, Session& session, ts::ecmgscs::StreamSetup* msg)
 {
     assert(msg != nullptr);
-    if (_channel != msg->channel_id) {
+    if (session.channel != msg->channel_id) {
         // Not the right channel.
-        return sendErrorResponse(msg, ts::ecmgscs::Errors::inv_channel_id);
+        sendErrorResponse(client, session, msg, ts::ecmgscs::Errors::inv_channel_id);
     }
-    else if (_streams.count(msg->stream_id) != 0) {
+    else if (session.streams.count(msg->stream_id) != 0) {
         // Stream already in use in this channel.
-        return sendErrorResponse(msg, ts::ecmgscs::Errors::stream_id_in_use);
+        sendErrorResponse(client, session, msg, ts::ecmgscs::Errors::stream_id_in_use);
     }
     else {
         // Stream ok.
-        _streams[msg->stream_id] = msg->ECM_id;
-        ts::ecmgscs::StreamStatus resp(_opt.streamStatus);
-        resp.channel_id = msg->channel_id;
-        resp.stream_id = msg->stream_id;
-        resp.ECM_id = msg->ECM_id;
-        return send(&resp);
+        session.streams[msg->stream_id] = msg->ECM_id;
+        ts::ecmgscs::StreamStatus* resp = new ts::ecmgscs::StreamStatus(_opt.streamStatus);
+        ts::tlv::MessagePtr respPtr(resp);
+        resp->channel_id = msg->channel_id;
+        resp->stream_id = msg->stream_id;
+        resp->ECM_id = msg->ECM_id;
+        sendResponse(client, session, respPtr);
     }
 }
 
 
-bool ECMGClientHandler::handleStreamTest(ts::ecmgscs::StreamTest* msg)
+void ECMGServer::handleStreamTest(uint32_t client, Session& session, ts::ecmgscs::StreamTest* msg)
 {
     assert(msg != nullptr);
-    if (_channel != msg->channel_id) {
+    if (session.channel != msg->channel_id) {
         // Not the right channel.
-        return sendErrorResponse(msg, ts::ecmgscs::Errors::inv_channel_id);
+        sendErrorResponse(client, session, msg, ts::ecmgscs::Errors::inv_channel_id);
     }
-    else if (_streams.count(msg->stream_id) == 0) {
+    else if (session.streams.count(msg->stream_id) == 0) {
         // Stream not in use in this channel.
-        return sendErrorResponse(msg, ts::ecmgscs::Errors::inv_stream_id);
+        sendErrorResponse(client, session, msg, ts::ecmgscs::Errors::inv_stream_id);
     }
     else {
         // Stream ok.
-        ts::ecmgscs::StreamStatus resp(_opt.streamStatus);
-        resp.channel_id = msg->channel_id;
-        resp.stream_id = msg->stream_id;
-        resp.ECM_id = _streams[msg->stream_id];
-        return send(&resp);
+        ts::ecmgscs::StreamStatus* resp = new ts::ecmgscs::StreamStatus(_opt.streamStatus);
+        ts::tlv::MessagePtr respPtr(resp);
+        resp->channel_id = msg->channel_id;
+        resp->stream_id = msg->stream_id;
+        resp->ECM_id = session.streams[msg->stream_id];
+        sendResponse(client, session, respPtr);
     }
 }
 
 
-bool ECMGClientHandler::handleStreamCloseRequest(ts::ecmgscs::StreamCloseRequest* msg)
+void ECMGServer::handleStreamCloseRequest(uint32_t client, Session& session, ts::ecmgscs::StreamCloseRequest* msg)
 {
     assert(msg != nullptr);
-    if (_channel != msg->channel_id) {
+    if (session.channel != msg->channel_id) {
         // Not the right channel.
-        return sendErrorResponse(msg, ts::ecmgscs::Errors::inv_channel_id);
+        sendErrorResponse(client, session, msg, ts::ecmgscs::Errors::inv_channel_id);
     }
-    else if (_streams.count(msg->stream_id) == 0) {
+    else if (session.streams.count(msg->stream_id) == 0) {
         // Stream not in use in this channel.
-        return sendErrorResponse(msg, ts::ecmgscs::Errors::inv_stream_id);
+        sendErrorResponse(client, session, msg, ts::ecmgscs::Errors::inv_stream_id);
     }
     else {
         // Stream ok, close it.
-        _streams.erase(msg->stream_id);
-        ts::ecmgscs::StreamCloseResponse resp(_opt.ecmgscs);
-        resp.channel_id = msg->channel_id;
-        resp.stream_id = msg->stream_id;
-        return send(&resp);
+        session.streams.erase(msg->stream_id);
+        ts::ecmgscs::StreamCloseResponse* resp = new ts::ecmgscs::StreamCloseResponse(_opt.ecmgscs);
+        ts::tlv::MessagePtr respPtr(resp);
+        resp->channel_id = msg->channel_id;
+        resp->stream_id = msg->stream_id;
+        sendResponse(client, session, respPtr);
     }
 }
 
 
-bool ECMGClientHandler::handleCWProvision(ts::ecmgscs::CWProvision* msg)
+void ECMGServer::handleCWProvision(uint32_t client, Session& session, ts::ecmgscs::CWProvision* msg)
 {
     assert(msg != nullptr);
-    if (_channel != msg->channel_id) {
+    if (session.channel != msg->channel_id) {
         // Not the right channel.
-        return sendErrorResponse(msg, ts::ecmgscs::Errors::inv_channel_id);
+        sendErrorResponse(client, session, msg, ts::ecmgscs::Errors::inv_channel_id);
     }
-    else if (_streams.count(msg->stream_id) == 0) {
+    else if (session.streams.count(msg->stream_id) == 0) {
         // Stream not in use in this channel.
-        return sendErrorResponse(msg, ts::ecmgscs::Errors::inv_stream_id);
+        sendErrorResponse(client, session, msg, ts::ecmgscs::Errors::inv_stream_id);
     }
     else if (msg->CP_CW_combination.size() != _opt.channelStatus.CW_per_msg) {
         // Not the right number of CW in the request.
-        return sendErrorResponse(msg, ts::ecmgscs::Errors::not_enough_CW);
+        sendErrorResponse(client, session, msg, ts::ecmgscs::Errors::not_enough_CW);
     }
     else {
         // Start to build the response.
-        ts::ecmgscs::ECMResponse resp(_opt.ecmgscs);
-        resp.channel_id = msg->channel_id;
-        resp.stream_id = msg->stream_id;
-        resp.CP_number = msg->CP_number;
+        ts::ecmgscs::ECMResponse* resp = new ts::ecmgscs::ECMResponse(_opt.ecmgscs);
+        ts::tlv::MessagePtr respPtr(resp);
+        resp->channel_id = msg->channel_id;
+        resp->stream_id = msg->stream_id;
+        resp->CP_number = msg->CP_number;
 
         // Check if 16-bit crypto-period numbers wrap over 0xFFFF.
         const uint16_t cpMax = msg->CP_number + _opt.channelStatus.lead_CW;
@@ -598,7 +614,8 @@ bool ECMGClientHandler::handleCWProvision(ts::ecmgscs::CWProvision* msg)
         for (auto it = msg->CP_CW_combination.begin(); it != msg->CP_CW_combination.end(); ++it) {
             if ((!cpWrap && (it->CP < msg->CP_number || it->CP > cpMax)) || (cpWrap && it->CP > cpMax && it->CP < msg->CP_number)) {
                 // Incorrect CP/CW combination.
-                return sendErrorResponse(msg, ts::ecmgscs::Errors::not_enough_CW);
+                sendErrorResponse(client, session, msg, ts::ecmgscs::Errors::not_enough_CW);
+                return;
             }
             if ((it->CP & 0x01) == 0) {
                 ecm.cw_even = it->CW;
@@ -607,7 +624,9 @@ bool ECMGClientHandler::handleCWProvision(ts::ecmgscs::CWProvision* msg)
                 ecm.cw_odd = it->CW;
             }
             // In debug mode, display if CW has reduced entropy.
-            _shared->report().debug(u"incoming CW entropy: %s", {it->CW.size() == ts::DVBCSA2::KEY_SIZE && ts::DVBCSA2::IsReducedCW(it->CW.data()) ? u"reduced" : u"not reduced"});
+            if (_report.debug()) {
+                _report.debug(u"incoming CW entropy: %s", it->CW.size() == ts::DVBCSA2::KEY_SIZE && ts::DVBCSA2::IsReducedCW(it->CW.data()) ? u"reduced" : u"not reduced");
+            }
         }
 
         // Add optional access criteria in ECM.
@@ -640,20 +659,17 @@ bool ECMGClientHandler::handleCWProvision(ts::ecmgscs::CWProvision* msg)
             zer.addSection(ecmSection);
             zer.getPackets(ecmPackets);
             if (!ecmPackets.empty()) {
-                resp.ECM_datagram.copy(ecmPackets[0].b, ecmPackets.size() * ts::PKT_SIZE);
+                resp->ECM_datagram.copy(ecmPackets[0].b, ecmPackets.size() * ts::PKT_SIZE);
             }
         }
         else {
             // Send ECM as a section.
-            resp.ECM_datagram.copy(ecmSection->content(), ecmSection->size());
-        }
-
-        // Emulate the computation time of a real ECMG.
-        if (_opt.ecmCompTime > 0) {
-            ts::SleepThread(_opt.ecmCompTime);
+            resp->ECM_datagram.copy(ecmSection->content(), ecmSection->size());
         }
 
-        return send(&resp);
+        // Emulate the computation time of a real ECMG. The response is sent when
+        // the timer expires, without blocking the other clients.
+        sendResponse(client, session, respPtr, _opt.ecmCompTime);
     }
 }
 
@@ -666,52 +682,13 @@ int MainCode(int argc, char *argv[])
 {
     ECMGOptions opt(argc, argv);
 
-    // Create ECMG shared data (including the asynchronous report).
-    ECMGSharedData shared(opt);
-
-    // Initialize a TCP server.
-    ts::TCPServer server;
-    if (!server.open(shared.report()) ||
-        !server.reusePort(opt.reusePort, shared.report()) ||
-        !server.bind(opt.serverAddress, shared.report()) ||
-        !server.listen(5, shared.report()))
-    {
-        return EXIT_FAILURE;
-    }
-    shared.report().verbose(u"TCP server listening on %s, using ECMG <=> SCS protocol version %d", {opt.serverAddress, opt.ecmgscs.version()});
-
     // On UNIX systems, ignore SIGPIPE. This signal is raised when trying to write to a disconnected
     // socket. This may happen when a client disconnects after sending stream_close_request without
     // waiting for stream_close_response. In that case, we (the ECMG) may send the response after
     // the client disconnects, creating a SIGPIPE signal.
     ts::IgnorePipeSignal();
 
-    // Manage incoming client connections.
-    for (;;) {
-
-        // Accept one incoming connection.
-        ts::IPv4SocketAddress clientAddress;
-        ECMGConnectionPtr conn(new ECMGConnection(opt.ecmgscs, true, 3));
-        ts::CheckNonNull(conn.pointer());
-        if (!server.accept(*conn, clientAddress, shared.report())) {
-            break;
-        }
-
-        // Process the connection.
-        if (opt.once) {
-            // If --once is specified, run once in the context of the main thread and exit.
-            ECMGClientHandler client(opt, conn, &shared, false);
-            client.main();
-            break;
-        }
-        else {
-            // Otherwise, create a thread and forget about it.
-            // The thread will deallocate itself automatically when it completes.
-            ECMGClientHandler* client = new ECMGClientHandler(opt, conn, &shared, true);
-            ts::CheckNonNull(client);
-            client->start();
-        }
-    }
-
-    return EXIT_SUCCESS;
+    // Serve all clients in one event-driven server.
+    ECMGServer server(opt);
+    return server.run() ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -0,0 +1,529 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+//
+//  Minimal generic DVB SimulCrypt compliant MUX server for EMMG/PDG.
+//
+//----------------------------------------------------------------------------
+
+#include "tsMain.h"
+#include "tsDuckContext.h"
+#include "tsAsyncReport.h"
+#include "tsSysUtils.h"
+#include "tsEMMGMUX.h"
+#include "tstlvServer.h"
+#include "tsOptional.h"
+TS_MAIN(MainCode);
+
+namespace {
+    // Command line default arguments.
+    static const uint16_t DEFAULT_SERVER_PORT = 2223;
+}
+
+
+//----------------------------------------------------------------------------
+// Command line options
+//----------------------------------------------------------------------------
+
+namespace {
+    class MuxOptions: public ts::Args
+    {
+        TS_NOBUILD_NOCOPY(MuxOptions);
+    public:
+        MuxOptions(int argc, char *argv[]);
+
+        ts::DuckContext       duck {this};        // TSDuck execution context.
+        ts::AsyncReportArgs   logArgs {};         // Options for asynchronous log.
+        ts::emmgmux::Protocol emmgmux {};         // EMMG <=> MUX protocol instance.
+        int                   logProtocol = ts::Severity::Debug;  // Log level for EMMG <=> MUX protocol.
+        int                   logData = ts::Severity::Debug;      // Log level for data_provision messages.
+        bool                  once = false;       // Accept only one client.
+        bool                  reusePort = false;  // Socket option.
+        uint16_t              maxBandwidth = 0;   // Maximum allocated bandwidth in kb/s, zero means unlimited.
+        ts::MilliSecond       statInterval = 0;   // Statistics reporting interval.
+        ts::IPv4SocketAddress serverAddress {};   // TCP server local address.
+    };
+}
+
+MuxOptions::MuxOptions(int argc, char *argv[]) :
+    ts::Args(u"Minimal generic DVB SimulCrypt-compliant MUX server for EMMG/PDG", u"[options]")
+{
+    logArgs.defineArgs(*this);
+
+    option(u"bandwidth", 'b', UINT16);
+    help(u"bandwidth", u"kb/s",
+         u"Specify the maximum bandwidth in kilobits per second which is allocated to a stream "
+         u"in response to a stream_BW_request message. By default, the requested bandwidth is "
+         u"always allocated.");
+
+    option(u"emmg-mux-version", 0, INTEGER, 0, 1, 1, 5);
+    help(u"emmg-mux-version",
+         u"Specify the version of the EMMG/PDG <=> MUX DVB SimulCrypt protocol. "
+         u"Valid values are 1 to 5. The default is 2.");
+
+    option(u"log-data", 0, ts::Severity::Enums, 0, 1, true);
+    help(u"log-data", u"level",
+         u"Same as --log-protocol but applies to data_provision messages only. To debug "
+         u"the session management without being flooded by data messages, use "
+         u"--log-protocol=info --log-data=debug");
+
+    option(u"log-protocol", 0, ts::Severity::Enums, 0, 1, true);
+    help(u"log-protocol", u"level",
+         u"Log all EMMG/PDG <=> MUX protocol messages using the specified level. If the "
+         u"option is not present, the messages are logged at debug level only. If the "
+         u"option is present without value, the messages are logged at info level.");
+
+    option(u"no-reuse-port", 0);
+    help(u"no-reuse-port", u"Disable the reuse port socket option. Do not use unless completely necessary.");
+
+    option(u"once", 'o');
+    help(u"once", u"Accept only one client and exit at the end of the session.");
+
+    option(u"port", 'p', UINT16);
+    help(u"port", u"TCP port number of the MUX server. Default: " + ts::UString::Decimal(DEFAULT_SERVER_PORT) + u".");
+
+    option(u"statistics-interval", 's', POSITIVE);
+    help(u"statistics-interval", u"seconds",
+         u"Periodically report the amount of data which were received from each client, "
+         u"at verbose level. By default, statistics are reported at the end of each session only.");
+
+    analyze(argc, argv);
+
+    logArgs.loadArgs(duck, *this);
+    serverAddress.setPort(intValue<uint16_t>(u"port", DEFAULT_SERVER_PORT));
+    once = present(u"once");
+    reusePort = !present(u"no-reuse-port");
+    maxBandwidth = intValue<uint16_t>(u"bandwidth", 0);
+    statInterval = intValue<ts::MilliSecond>(u"statistics-interval", 0) * ts::MilliSecPerSec;
+    logProtocol = present(u"log-protocol") ? intValue<int>(u"log-protocol", ts::Severity::Info) : ts::Severity::Debug;
+    logData = present(u"log-data") ? intValue<int>(u"log-data", ts::Severity::Info) : logProtocol;
+    emmgmux.setVersion(intValue<ts::tlv::VERSION>(u"emmg-mux-version", 2));
+
+    exitOnError();
+}
+
+
+//----------------------------------------------------------------------------
+// A class implementing the MUX server. All clients are served by one
+// event-driven TLV server, in the context of the main thread.
+//----------------------------------------------------------------------------
+
+namespace {
+    class MuxServer: private ts::tlv::ServerHandlerInterface
+    {
+        TS_NOBUILD_NOCOPY(MuxServer);
+    public:
+        // Constructor.
+        MuxServer(const MuxOptions& opt);
+
+        // Open the server and serve clients.
+        bool run();
+
+    private:
+        // Description of a data stream.
+        class Stream
+        {
+        public:
+            uint16_t data_id = 0;
+            uint8_t  data_type = 0;
+        };
+
+        // Description of a client session.
+        class Session
+        {
+        public:
+            ts::UString                 peer {};           // Client peer name.
+            std::optional<uint16_t>     channel {};        // Current data_channel_id.
+            uint32_t                    client_id = 0;     // EMMG/PDG client id.
+            bool                        section_mode = false;
+            std::map<uint16_t, Stream>  streams {};        // Map of current data_stream_id => stream description.
+            uint64_t                    messages = 0;      // Number of data_provision messages.
+            uint64_t                    datagrams = 0;     // Number of datagrams.
+            uint64_t                    bytes = 0;         // Number of datagram bytes.
+            ts::Monotonic               start {true};      // Start of session.
+        };
+
+        const MuxOptions&            _opt;
+        ts::AsyncReport              _report;        // Asynchronous message report.
+        ts::tlv::Logger              _logger;        // Protocol message logger.
+        std::map<uint32_t, Session>  _sessions {};   // Client sessions, indexed by client id.
+        ts::tlv::Server              _server;        // Event-driven TLV server, must be destroyed first (its destructor notifies disconnections).
+
+        // Implementation of ServerHandlerInterface.
+        virtual void handleConnection(ts::tlv::Server& server, uint32_t client) override;
+        virtual void handleMessage(ts::tlv::Server& server, uint32_t client, const ts::tlv::MessagePtr& msg) override;
+        virtual void handleTimer(ts::tlv::Server& server, uint32_t client, uint64_t cookie) override;
+        virtual void handleDisconnection(ts::tlv::Server& server, uint32_t client) override;
+
+        // Handle the various EMMG/PDG client messages.
+        void handleChannelSetup(uint32_t client, Session& session, ts::emmgmux::ChannelSetup* msg);
+        void handleChannelTest(uint32_t client, Session& session, ts::emmgmux::ChannelTest* msg);
+        void handleChannelClose(uint32_t client, Session& session, ts::emmgmux::ChannelClose* msg);
+        void handleStreamSetup(uint32_t client, Session& session, ts::emmgmux::StreamSetup* msg);
+        void handleStreamTest(uint32_t client, Session& session, ts::emmgmux::StreamTest* msg);
+        void handleStreamCloseRequest(uint32_t client, Session& session, ts::emmgmux::StreamCloseRequest* msg);
+        void handleStreamBWRequest(uint32_t client, Session& session, ts::emmgmux::StreamBWRequest* msg);
+        void handleDataProvision(uint32_t client, Session& session, ts::emmgmux::DataProvision* msg);
+
+        // Check that a stream message applies to an existing stream. Send an error if not.
+        bool checkStream(uint32_t client, Session& session, const ts::tlv::StreamMessage* msg, uint32_t client_id, bool exists = true);
+
+        // Send an error related to the msg.
+        void sendErrorResponse(uint32_t client, const ts::tlv::Message* msg, uint16_t errorStatus);
+
+        // Report statistics of a session.
+        void reportStatistics(const Session& session);
+    };
+}
+
+
+//----------------------------------------------------------------------------
+// MUX server constructor.
+//----------------------------------------------------------------------------
+
+MuxServer::MuxServer(const MuxOptions& opt) :
+    _opt(opt),
+    _report(opt.maxSeverity(), opt.logArgs),
+    _logger(opt.logProtocol, &_report),
+    _server(opt.emmgmux, this, _logger, 3)
+{
+    // The data messages have a distinct log level.
+    _logger.setSeverity(ts::emmgmux::Tags::data_provision, opt.logData);
+}
+
+
+//----------------------------------------------------------------------------
+// Open the server and serve clients.
+//----------------------------------------------------------------------------
+
+bool MuxServer::run()
+{
+    if (!_server.open(_opt.serverAddress, _opt.reusePort)) {
+        return false;
+    }
+    _report.verbose(u"TCP server listening on %s, using EMMG/PDG <=> MUX protocol version %d", {_opt.serverAddress, _opt.emmgmux.version()});
+    return _server.run();
+}
+
+
+//----------------------------------------------------------------------------
+// Client connection and disconnection.
+//----------------------------------------------------------------------------
+
+void MuxServer::handleConnection(ts::tlv::Server& server, uint32_t client)
+{
+    Session& session(_sessions[client]);
+    session.peer = server.peerName(client);
+    _report.verbose(u"%s: session started", {session.peer});
+
+    // Periodic statistics use one timer per client.
+    if (_opt.statInterval > 0) {
+        server.startTimer(client, _opt.statInterval);
+    }
+
+    // If --once is specified, serve only this client and exit at the end of the session.
+    if (_opt.once) {
+        server.stopAccepting();
+    }
+}
+
+void MuxServer::handleDisconnection(ts::tlv::Server&, uint32_t client)
+{
+    const auto it = _sessions.find(client);
+    if (it != _sessions.end()) {
+        reportStatistics(it->second);
+        _report.verbose(u"%s: session completed", {it->second.peer});
+        _sessions.erase(it);
+    }
+}
+
+void MuxServer::handleTimer(ts::tlv::Server& server, uint32_t client, uint64_t)
+{
+    const auto it = _sessions.find(client);
+    if (it != _sessions.end()) {
+        reportStatistics(it->second);
+        server.startTimer(client, _opt.statInterval);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Report statistics of a session.
+//----------------------------------------------------------------------------
+
+void MuxServer::reportStatistics(const Session& session)
+{
+    const ts::MilliSecond ms = (ts::Monotonic(true) - session.start) / ts::NanoSecPerMilliSec;
+    const uint64_t kbps = ms <= 0 ? 0 : (session.bytes * 8) / uint64_t(ms);
+    _report.verbose(u"%s: received %'d data_provision, %'d datagrams, %'d bytes, %'d kb/s", {session.peer, session.messages, session.datagrams, session.bytes, kbps});
+}
+
+
+//----------------------------------------------------------------------------
+// Dispatch incoming messages.
+//----------------------------------------------------------------------------
+
+void MuxServer::handleMessage(ts::tlv::Server&, uint32_t client, const ts::tlv::MessagePtr& msg)
+{
+    Session& session(_sessions[client]);
+
+    // This is a minimal MUX. We never send any request to the client,
+    // we simply respond to requests from the client.
+
+    switch (msg->tag()) {
+        case ts::emmgmux::Tags::channel_setup:
+            handleChannelSetup(client, session, dynamic_cast<ts::emmgmux::ChannelSetup*>(msg.pointer()));
+            break;
+        case ts::emmgmux::Tags::channel_test:
+            handleChannelTest(client, session, dynamic_cast<ts::emmgmux::ChannelTest*>(msg.pointer()));
+            break;
+        case ts::emmgmux::Tags::channel_close:
+            handleChannelClose(client, session, dynamic_cast<ts::emmgmux::ChannelClose*>(msg.pointer()));
+            break;
+        case ts::emmgmux::Tags::stream_setup:
+            handleStreamSetup(client, session, dynamic_cast<ts::emmgmux::StreamSetup*>(msg.pointer()));
+            break;
+        case ts::emmgmux::Tags::stream_test:
+            handleStreamTest(client, session, dynamic_cast<ts::emmgmux::StreamTest*>(msg.pointer()));
+            break;
+        case ts::emmgmux::Tags::stream_close_request:
+            handleStreamCloseRequest(client, session, dynamic_cast<ts::emmgmux::StreamCloseRequest*>(msg.pointer()));
+            break;
+        case ts::emmgmux::Tags::stream_BW_request:
+            handleStreamBWRequest(client, session, dynamic_cast<ts::emmgmux::StreamBWRequest*>(msg.pointer()));
+            break;
+        case ts::emmgmux::Tags::data_provision:
+            handleDataProvision(client, session, dynamic_cast<ts::emmgmux::DataProvision*>(msg.pointer()));
+            break;
+        case ts::emmgmux::Tags::channel_status:
+        case ts::emmgmux::Tags::stream_status:
+        case ts::emmgmux::Tags::channel_error:
+        case ts::emmgmux::Tags::stream_error:
+            // Silently ignore unsollicited status or error messages.
+            break;
+        default:
+            // Received an invalid message for a MUX.
+            sendErrorResponse(client, msg.pointer(), ts::emmgmux::Errors::inv_message);
+            break;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Send an error related to the msg.
+//----------------------------------------------------------------------------
+
+void MuxServer::sendErrorResponse(uint32_t client, const ts::tlv::Message* msg, uint16_t errorStatus)
+{
+    const auto it = _sessions.find(client);
+    const uint32_t client_id = it == _sessions.end() ? 0 : it->second.client_id;
+    const ts::tlv::ChannelMessage* channelMsg = nullptr;
+    const ts::tlv::StreamMessage* streamMsg = nullptr;
+
+    if ((streamMsg = dynamic_cast<const ts::tlv::StreamMessage*>(msg)) != nullptr) {
+        // Response to a stream message.
+        ts::emmgmux::StreamError resp(_opt.emmgmux);
+        resp.channel_id = streamMsg->channel_id;
+        resp.stream_id = streamMsg->stream_id;
+        resp.client_id = client_id;
+        resp.error_status.push_back(errorStatus);
+        _server.send(client, resp);
+    }
+    else {
+        // Response to a channel message or garbage.
+        ts::emmgmux::ChannelError resp(_opt.emmgmux);
+        if ((channelMsg = dynamic_cast<const ts::tlv::ChannelMessage*>(msg)) != nullptr) {
+            resp.channel_id = channelMsg->channel_id;
+        }
+        resp.client_id = client_id;
+        resp.error_status.push_back(errorStatus);
+        _server.send(client, resp);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Check that a stream message applies to a stream of the current channel.
+//----------------------------------------------------------------------------
+
+bool MuxServer::checkStream(uint32_t client, Session& session, const ts::tlv::StreamMessage* msg, uint32_t client_id, bool exists)
+{
+    assert(msg != nullptr);
+    if (session.channel != msg->channel_id) {
+        sendErrorResponse(client, msg, ts::emmgmux::Errors::inv_data_channel_id);
+        return false;
+    }
+    else if (session.client_id != client_id) {
+        sendErrorResponse(client, msg, ts::emmgmux::Errors::inv_client_id);
+        return false;
+    }
+    else if (exists && session.streams.count(msg->stream_id) == 0) {
+        sendErrorResponse(client, msg, ts::emmgmux::Errors::inv_data_stream_id);
+        return false;
+    }
+    else if (!exists && session.streams.count(msg->stream_id) != 0) {
+        sendErrorResponse(client, msg, ts::emmgmux::Errors::stream_id_in_use);
+        return false;
+    }
+    else {
+        return true;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Handle the various types of messages from the client.
+//----------------------------------------------------------------------------
+
+void MuxServer::handleChannelSetup(uint32_t client, Session& session, ts::emmgmux::ChannelSetup* msg)
+{
+    assert(msg != nullptr);
+    if (session.channel.has_value()) {
+        // Channel already set in this session.
+        sendErrorResponse(client, msg, ts::emmgmux::Errors::too_many_channels);
+    }
+    else {
+        // Channel accepted.
+        session.channel = msg->channel_id;
+        session.client_id = msg->client_id;
+        session.section_mode = !msg->section_TSpkt_flag;
+        ts::emmgmux::ChannelStatus resp(_opt.emmgmux);
+        resp.channel_id = msg->channel_id;
+        resp.client_id = msg->client_id;
+        resp.section_TSpkt_flag = msg->section_TSpkt_flag;
+        _server.send(client, resp);
+    }
+}
+
+
+void MuxServer::handleChannelTest(uint32_t client, Session& session, ts::emmgmux::ChannelTest* msg)
+{
+    assert(msg != nullptr);
+    if (session.channel != msg->channel_id) {
+        sendErrorResponse(client, msg, ts::emmgmux::Errors::inv_data_channel_id);
+    }
+    else if (session.client_id != msg->client_id) {
+        sendErrorResponse(client, msg, ts::emmgmux::Errors::inv_client_id);
+    }
+    else {
+        ts::emmgmux::ChannelStatus resp(_opt.emmgmux);
+        resp.channel_id = msg->channel_id;
+        resp.client_id = msg->client_id;
+        resp.section_TSpkt_flag = !session.section_mode;
+        _server.send(client, resp);
+    }
+}
+
+
+void MuxServer::handleChannelClose(uint32_t client, Session& session, ts::emmgmux::ChannelClose* msg)
+{
+    assert(msg != nullptr);
+    if (session.channel != msg->channel_id) {
+        sendErrorResponse(client, msg, ts::emmgmux::Errors::inv_data_channel_id);
+    }
+    else {
+        // Close everything, no response expected.
+        session.channel.reset();
+        session.streams.clear();
+    }
+}
+
+
+void MuxServer::handleStreamSetup(uint32_t client, Session& session, ts::emmgmux::StreamSetup* msg)
+{
+    if (checkStream(client, session, msg, msg->client_id, false)) {
+        Stream& stream(session.streams[msg->stream_id]);
+        stream.data_id = msg->data_id;
+        stream.data_type = msg->data_type;
+        ts::emmgmux::StreamStatus resp(_opt.emmgmux);
+        resp.channel_id = msg->channel_id;
+        resp.stream_id = msg->stream_id;
+        resp.client_id = msg->client_id;
+        resp.data_id = msg->data_id;
+        resp.data_type = msg->data_type;
+        _server.send(client, resp);
+    }
+}
+
+
+void MuxServer::handleStreamTest(uint32_t client, Session& session, ts::emmgmux::StreamTest* msg)
+{
+    if (checkStream(client, session, msg, msg->client_id)) {
+        const Stream& stream(session.streams[msg->stream_id]);
+        ts::emmgmux::StreamStatus resp(_opt.emmgmux);
+        resp.channel_id = msg->channel_id;
+        resp.stream_id = msg->stream_id;
+        resp.client_id = msg->client_id;
+        resp.data_id = stream.data_id;
+        resp.data_type = stream.data_type;
+        _server.send(client, resp);
+    }
+}
+
+
+void MuxServer::handleStreamCloseRequest(uint32_t client, Session& session, ts::emmgmux::StreamCloseRequest* msg)
+{
+    if (checkStream(client, session, msg, msg->client_id)) {
+        session.streams.erase(msg->stream_id);
+        ts::emmgmux::StreamCloseResponse resp(_opt.emmgmux);
+        resp.channel_id = msg->channel_id;
+        resp.stream_id = msg->stream_id;
+        resp.client_id = msg->client_id;
+        _server.send(client, resp);
+    }
+}
+
+
+void MuxServer::handleStreamBWRequest(uint32_t client, Session& session, ts::emmgmux::StreamBWRequest* msg)
+{
+    if (checkStream(client, session, msg, msg->client_id)) {
+        // Allocate the requested bandwidth, up to the maximum if one is specified.
+        ts::emmgmux::StreamBWAllocation resp(_opt.emmgmux);
+        resp.channel_id = msg->channel_id;
+        resp.stream_id = msg->stream_id;
+        resp.client_id = msg->client_id;
+        resp.has_bandwidth = msg->has_bandwidth || _opt.maxBandwidth > 0;
+        resp.bandwidth = msg->has_bandwidth ? msg->bandwidth : _opt.maxBandwidth;
+        if (_opt.maxBandwidth > 0) {
+            resp.bandwidth = std::min(resp.bandwidth, _opt.maxBandwidth);
+        }
+        _server.send(client, resp);
+    }
+}
+
+
+void MuxServer::handleDataProvision(uint32_t client, Session& session, ts::emmgmux::DataProvision* msg)
+{
+    // With UDP, the data_provision messages do not use the TCP connection.
+    // Here, only data over TCP are accepted. No response is expected.
+    if (checkStream(client, session, msg, msg->client_id)) {
+        session.messages++;
+        for (const auto& dg : msg->datagram) {
+            if (!dg.isNull()) {
+                session.datagrams++;
+                session.bytes += dg->size();
+            }
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+//  Program entry point
+//----------------------------------------------------------------------------
+
+int MainCode(int argc, char *argv[])
+{
+    MuxOptions opt(argc, argv);
+
+    // On UNIX systems, ignore SIGPIPE, clients may disconnect without waiting for the last responses.
+    ts::IgnorePipeSignal();
+
+    // Serve all clients in one event-driven server.
+    MuxServer server(opt);
+    return server.run() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
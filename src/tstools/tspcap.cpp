@@ -13,6 +13,7 @@
 #include "tsMain.h"
 #include "tsDuckContext.h"
 #include "tsPcapStream.h"
+#include "tsPcapTSExtractor.h"
 #include "tsIPv4Packet.h"
 #include "tsTime.h"
 #include "tsBitRate.h"
@@ -39,12 +40,15 @@ namespace {
         ts::PagerArgs         pager {true, true};
         ts::UString           input_file {};
         ts::UString           output_file {};
+        ts::UString           ts_directory {};
         bool                  print_summary = false;
         bool                  list_streams = false;
         bool                  print_intervals = false;
         bool                  dvb_simulcrypt = false;
         bool                  extract_tcp = false;
         bool                  save_tcp = false;
+        bool                  ts_streams = false;
+        size_t                thread_count = 0;
         std::set<uint8_t>     protocols {};
         ts::IPv4SocketAddress source_filter {};
         ts::IPv4SocketAddress dest_filter {};
@@ -88,6 +92,13 @@ Options::Options(int argc, char *argv[]) :
          u"The two directions of the TCP session are dumped. "
          u"The first TCP session matching the --source and --destination options is selected.");
 
+    option(u"extract-ts", 'x', DIRECTORY);
+    help(u"extract-ts",
+         u"Extract all UDP or RTP streams containing TS packets, each one into its own TS file in the specified directory. "
+         u"The name of each TS file is built from the source and destination socket addresses of the stream. "
+         u"The capture file is read only once. "
+         u"The statistics of the streams are displayed, as with --ts-streams.");
+
     option(u"interval", 'i', POSITIVE);
     help(u"interval", u"micro-seconds",
          u"Print a summary of exchanged data by intervals of times in micro-seconds.");
@@ -115,6 +126,19 @@ Options::Options(int argc, char *argv[]) :
     option(u"tcp", 't');
     help(u"tcp", u"Filter TCP packets.");
 
+    option(u"threads", 0, POSITIVE);
+    help(u"threads",
+         u"With --ts-streams or --extract-ts, number of threads which process the UDP streams in parallel. "
+         u"The default is the number of CPU cores in the system. "
+         u"The standard input is always processed in one single thread.");
+
+    option(u"ts-streams");
+    help(u"ts-streams",
+         u"List all UDP or RTP streams containing TS packets, IPv4 or IPv6, with their statistics: "
+         u"TS bitrate, maximum interval between datagrams and, with RTP, inter-arrival jitter and lost datagrams. "
+         u"The capture file is read only once. "
+         u"The options --source and --destination can be used to select streams.");
+
     option(u"udp", 'u');
     help(u"udp", u"Filter UDP packets.");
 
@@ -133,6 +157,9 @@ Options::Options(int argc, char *argv[]) :
     print_intervals = present(u"interval");
     dvb_simulcrypt = present(u"dvb-simulcrypt");
     extract_tcp = present(u"extract-tcp-stream");
+    getValue(ts_directory, u"extract-ts");
+    ts_streams = present(u"ts-streams") || present(u"extract-ts");
+    getIntValue(thread_count, u"threads", 0);
 
     // Default is to print a summary of the file content.
     print_summary = !list_streams && !print_intervals;
@@ -155,6 +182,9 @@ Options::Options(int argc, char *argv[]) :
     if (dvb_simulcrypt && extract_tcp) {
         error(u"--dvb-simulcrypt and --extract-tcp-stream are mutually exclusive");
     }
+    if (ts_streams && (dvb_simulcrypt || extract_tcp || save_tcp)) {
+        error(u"--ts-streams and --extract-ts cannot be used with DVB SimulCrypt or TCP session options");
+    }
     exitOnError();
 }
 
@@ -785,6 +815,71 @@ bool TCPSessionDump::save()
 }
 
 
+//----------------------------------------------------------------------------
+// Extraction of all TS streams.
+//----------------------------------------------------------------------------
+
+namespace {
+    class TSStreamsExtraction
+    {
+        TS_NOBUILD_NOCOPY(TSStreamsExtraction);
+    public:
+        // Constructor.
+        TSStreamsExtraction(Options& opt) : _opt(opt) {}
+
+        // Extract and list all TS streams, return true on success, false on error.
+        bool extract(std::ostream&);
+
+    private:
+        Options&            _opt;
+        ts::PcapFilter      _file {};
+        ts::PcapTSExtractor _extractor {};
+    };
+}
+
+// Extract and list all TS streams, return true on success, false on error.
+bool TSStreamsExtraction::extract(std::ostream& out)
+{
+    // Open the pcap file.
+    if (!_file.loadArgs(_opt.duck, _opt) || !_file.open(_opt.input_file, _opt)) {
+        return false;
+    }
+
+    // Set packet filters.
+    _file.setProtocolFilterUDP();
+    _file.setSourceFilter(_opt.source_filter);
+    _file.setDestinationFilter(_opt.dest_filter);
+
+    // Read the file once, process all streams.
+    _extractor.setOutputDirectory(_opt.ts_directory);
+    _extractor.setThreadCount(_opt.thread_count);
+    const bool ok = _extractor.extract(_file, _opt);
+    _file.close();
+
+    // Display the statistics of all streams.
+    out << std::endl
+        << ts::UString::Format(u"%-22s %-22s %-4s %11s %12s %12s %10s %8s", {u"Source", u"Destination", u"Type", u"TS packets", u"Bitrate", u"Max gap (us)", u"Jitter (us)", u"RTP lost"})
+        << std::endl;
+    for (const auto& st : _extractor.statistics()) {
+        out << ts::UString::Format(u"%-22s %-22s %-4s %11'd %12'd %12'd %10s %8s",
+                                   {st.id.sourceName(),
+                                    st.id.destinationName(),
+                                    st.rtp ? u"RTP" : u"UDP",
+                                    st.packets,
+                                    st.bitrate(),
+                                    st.max_interval,
+                                    st.rtp ? ts::UString::Decimal(st.jitter) : u"-",
+                                    st.rtp ? ts::UString::Decimal(st.rtp_lost) : u"-"})
+            << std::endl;
+        if (!st.file_name.empty()) {
+            out << "  => " << st.file_name << std::endl;
+        }
+    }
+    out << std::endl;
+    return ok;
+}
+
+
 //----------------------------------------------------------------------------
 // Program main code.
 //----------------------------------------------------------------------------
@@ -808,6 +903,11 @@ int MainCode(int argc, char *argv[])
         TCPSessionDump tcp(opt);
         status = tcp.save();
     }
+    else if (opt.ts_streams) {
+        // Extraction of all TS streams.
+        TSStreamsExtraction tse(opt);
+        status = tse.extract(out);
+    }
     else if (!opt.dvb_simulcrypt) {
         // Global file analysis by default.
         FileAnalysis dfa(opt);
@@ -13,10 +13,13 @@
 #include "tsMain.h"
 #include "tsDuckContext.h"
 #include "tsTSFile.h"
+#include "tsFileBatch.h"
+#include "tsGuardMutex.h"
 #include "tsPagerArgs.h"
 #include "tsTablesDisplay.h"
 #include "tsPSILogger.h"
 #include "tsTSPacket.h"
+#include "tsjsonObject.h"
 TS_MAIN(MainCode);
 
 
@@ -25,6 +28,20 @@ TS_MAIN(MainCode);
 //----------------------------------------------------------------------------
 
 namespace {
+    class Options;
+
+    // Extraction of PSI from one input file, possibly in a pool of threads.
+    class PSIBatch: public ts::FileBatch
+    {
+        TS_NOBUILD_NOCOPY(PSIBatch);
+    public:
+        PSIBatch(Options& opt) : _opt(opt) {}
+    protected:
+        virtual bool processFile(const ts::UString& file_name, std::ostream& output, ts::Report& report, ts::json::Object& summary) override;
+    private:
+        Options& _opt;
+    };
+
     class Options: public ts::Args
     {
         TS_NOBUILD_NOCOPY(Options);
@@ -32,17 +49,20 @@ namespace {
         Options(int argc, char *argv[]);
 
         ts::DuckContext    duck {this};        // TSDuck execution context.
-        ts::TablesDisplay  display {duck};     // Table formatting options.
-        ts::PSILogger      logger {display};   // Table logging options
+        ts::DuckContext::SavedArgs duck_args {}; // Context options, for each input file.
         ts::PagerArgs      pager {true, true}; // Output paging options.
-        ts::UString        infile {};          // Input file name.
+        PSIBatch           batch {*this};      // Input files.
         ts::TSPacketFormat format = ts::TSPacketFormat::AUTODETECT; // Input file format.
     };
 }
 
 Options::Options(int argc, char *argv[]) :
-    Args(u"Extract all standard PSI from an MPEG transport stream", u"[options] [filename]")
+    Args(u"Extract all standard PSI from an MPEG transport stream", u"[options] [filename ...]")
 {
+    // Only used to define and check the options, reloaded for each input file.
+    ts::TablesDisplay display(duck);
+    ts::PSILogger logger(display);
+
     duck.defineArgsForCAS(*this);
     duck.defineArgsForPDS(*this);
     duck.defineArgsForStandards(*this);
@@ -51,57 +71,91 @@ Options::Options(int argc, char *argv[]) :
     pager.defineArgs(*this);
     logger.defineArgs(*this);
     display.defineArgs(*this);
+    batch.defineArgs(*this);
     ts::DefineTSPacketFormatInputOption(*this);
 
-    option(u"", 0, FILENAME, 0, 1);
-    help(u"", u"Input MPEG capture file (standard input if omitted).");
+    option(u"", 0, FILENAME, 0, UNLIMITED_COUNT);
+    help(u"", u"filename ...",
+         u"Input MPEG capture files (standard input if omitted). "
+         u"When several files are specified, they are processed in parallel and "
+         u"the PSI are reported separately for each file.");
 
     analyze(argc, argv);
 
     duck.loadArgs(*this);
+    duck.saveArgs(duck_args);
     pager.loadArgs(duck, *this);
     logger.loadArgs(duck, *this);
     display.loadArgs(duck, *this);
+    batch.loadArgs(*this);
 
-    getValue(infile, u"");
     format = ts::LoadTSPacketFormatInputOption(*this);
 
+    // Output files cannot be shared by several input files.
+    if (batch.batchMode() && (present(u"output-file") || present(u"text-output") || present(u"xml-output") || present(u"json-output"))) {
+        error(u"output files cannot be used with several input files, use --output-directory for text reports");
+    }
+
     exitOnError();
 }
 
 
 //----------------------------------------------------------------------------
-//  Program entry point
+//  Extract PSI from one input file.
 //----------------------------------------------------------------------------
 
-int MainCode(int argc, char *argv[])
+bool PSIBatch::processFile(const ts::UString& file_name, std::ostream& output, ts::Report& report, ts::json::Object& summary)
 {
-    // Decode command line options.
-    Options opt(argc, argv);
-
-    // Redirect display on pager process or stdout only.
-    opt.duck.setOutput(&opt.pager.output(opt), false);
+    // Private TSDuck context and logger for this file.
+    ts::DuckContext duck(&report, &output);
+    duck.restoreArgs(_opt.duck_args);
+    ts::TablesDisplay display(duck);
+    ts::PSILogger logger(display);
+    {
+        ts::GuardMutex lock(mutex());
+        if (!display.loadArgs(duck, _opt) || !logger.loadArgs(duck, _opt)) {
+            return false;
+        }
+    }
 
     // Open the TS file.
     ts::TSFile file;
-    if (!file.openRead(opt.infile, 1, 0, opt, opt.format)) {
-        return EXIT_FAILURE;
+    if (!file.openRead(file_name, 1, 0, report, _opt.format)) {
+        return false;
     }
 
     // Read all packets in the file and pass them to the logger
     ts::TSPacket pkt;
-    if (!opt.logger.open()) {
-        return EXIT_FAILURE;
+    uint64_t count = 0;
+    if (!logger.open()) {
+        return false;
     }
-    while (!opt.logger.completed() && file.readPackets(&pkt, nullptr, 1, opt) > 0) {
-        opt.logger.feedPacket(pkt);
+    while (!logger.completed() && file.readPackets(&pkt, nullptr, 1, report) > 0) {
+        logger.feedPacket(pkt);
+        count++;
     }
-    file.close(opt);
-    opt.logger.close();
+    file.close(report);
+    logger.close();
 
     // Report errors
-    if (opt.verbose()) {
-        opt.logger.reportDemuxErrors();
+    if (report.verbose()) {
+        logger.reportDemuxErrors();
     }
-    return EXIT_SUCCESS;
+
+    summary.add(u"packets", count);
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+//  Program entry point
+//----------------------------------------------------------------------------
+
+int MainCode(int argc, char *argv[])
+{
+    // Decode command line options.
+    Options opt(argc, argv);
+
+    // Process all files.
+    return opt.batch.run(opt, opt.batch.useOutputStream() ? opt.pager.output(opt) : std::cout) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -15,7 +15,10 @@
 #include "tsTSFile.h"
 #include "tsTablesDisplay.h"
 #include "tsTablesLogger.h"
+#include "tsFileBatch.h"
+#include "tsGuardMutex.h"
 #include "tsPagerArgs.h"
+#include "tsjsonObject.h"
 TS_MAIN(MainCode);
 
 
@@ -24,6 +27,20 @@ TS_MAIN(MainCode);
 //----------------------------------------------------------------------------
 
 namespace {
+    class Options;
+
+    // Collection of tables from one input file, possibly in a pool of threads.
+    class TablesBatch: public ts::FileBatch
+    {
+        TS_NOBUILD_NOCOPY(TablesBatch);
+    public:
+        TablesBatch(Options& opt) : _opt(opt) {}
+    protected:
+        virtual bool processFile(const ts::UString& file_name, std::ostream& output, ts::Report& report, ts::json::Object& summary) override;
+    private:
+        Options& _opt;
+    };
+
     class Options: public ts::Args
     {
         TS_NOBUILD_NOCOPY(Options);
@@ -31,17 +48,21 @@ namespace {
         Options(int argc, char *argv[]);
 
         ts::DuckContext    duck {this};        // TSDuck execution context.
-        ts::TablesDisplay  display {duck};     // Table formatting.
-        ts::TablesLogger   logger {display};   // Table logging.
+        ts::DuckContext::SavedArgs duck_args {}; // Context options, for each input file.
         ts::PagerArgs      pager {true, true}; // Output paging options.
-        ts::UString        infile {};          // Input file name.
+        TablesBatch        batch {*this};      // Input files.
         ts::TSPacketFormat format = ts::TSPacketFormat::AUTODETECT;
     };
 }
 
 Options::Options(int argc, char *argv[]) :
-    Args(u"Collect PSI/SI tables from an MPEG transport stream", u"[options] [filename]")
+    Args(u"Collect PSI/SI tables from an MPEG transport stream", u"[options] [filename ...]")
 {
+    // The table display and logger options are defined and checked here.
+    // Each input file uses its own instances, loaded from these options.
+    ts::TablesDisplay display(duck);
+    ts::TablesLogger logger(display);
+
     duck.defineArgsForCAS(*this);
     duck.defineArgsForPDS(*this);
     duck.defineArgsForStandards(*this);
@@ -50,60 +71,94 @@ Options::Options(int argc, char *argv[]) :
     pager.defineArgs(*this);
     logger.defineArgs(*this);
     display.defineArgs(*this);
+    batch.defineArgs(*this);
     ts::DefineTSPacketFormatInputOption(*this);
 
-    option(u"", 0, FILENAME, 0, 1);
-    help(u"", u"Input transport stream file (standard input if omitted).");
+    option(u"", 0, FILENAME, 0, UNLIMITED_COUNT);
+    help(u"", u"filename ...",
+         u"Input transport stream files (standard input if omitted). "
+         u"When several files are specified, they are processed in parallel and "
+         u"the tables are reported separately for each file.");
 
     analyze(argc, argv);
 
     duck.loadArgs(*this);
+    duck.saveArgs(duck_args);
     pager.loadArgs(duck, *this);
     logger.loadArgs(duck, *this);
     display.loadArgs(duck, *this);
+    batch.loadArgs(*this);
 
-    getValue(infile, u"");
     format = ts::LoadTSPacketFormatInputOption(*this);
 
+    // Output files cannot be shared by several input files.
+    if (batch.batchMode() && (present(u"output-file") || present(u"text-output") || present(u"binary-output") || present(u"xml-output") || present(u"json-output"))) {
+        error(u"output files cannot be used with several input files, use --output-directory for text reports");
+    }
+
     exitOnError();
 }
 
 
 //----------------------------------------------------------------------------
-//  Program entry point
+//  Collect tables from one input file.
 //----------------------------------------------------------------------------
 
-int MainCode(int argc, char *argv[])
+bool TablesBatch::processFile(const ts::UString& file_name, std::ostream& output, ts::Report& report, ts::json::Object& summary)
 {
-    // Decode command line options.
-    Options opt(argc, argv);
-
-    // Redirect display on pager process or stdout only.
-    opt.duck.setOutput(&opt.pager.output(opt), false);
+    // Private TSDuck context and logger for this file.
+    ts::DuckContext duck(&report, &output);
+    duck.restoreArgs(_opt.duck_args);
+    ts::TablesDisplay display(duck);
+    ts::TablesLogger logger(display);
+    {
+        ts::GuardMutex lock(mutex());
+        if (!display.loadArgs(duck, _opt) || !logger.loadArgs(duck, _opt)) {
+            return false;
+        }
+    }
 
     // Open section logger.
-    if (!opt.logger.open()) {
-        return EXIT_FAILURE;
+    if (!logger.open()) {
+        return false;
     }
 
     // Open the TS file.
     ts::TSFile file;
-    if (!file.openRead(opt.infile, 1, 0, opt, opt.format)) {
-        return EXIT_FAILURE;
+    if (!file.openRead(file_name, 1, 0, report, _opt.format)) {
+        logger.close();
+        return false;
     }
 
     // Read all packets in the file and pass them to the logger
     ts::TSPacket pkt;
-    while (!opt.logger.completed() && file.readPackets(&pkt, nullptr, 1, opt) > 0) {
-        opt.logger.feedPacket(pkt);
+    uint64_t count = 0;
+    while (!logger.completed() && file.readPackets(&pkt, nullptr, 1, report) > 0) {
+        logger.feedPacket(pkt);
+        count++;
     }
-    file.close(opt);
-    opt.logger.close();
+    file.close(report);
+    logger.close();
 
     // Report errors
-    if (opt.verbose() && !opt.logger.hasErrors()) {
-        opt.logger.reportDemuxErrors(std::cerr);
+    if (report.verbose() && !logger.hasErrors()) {
+        logger.reportDemuxErrors(report);
     }
 
-    return opt.logger.hasErrors() ? EXIT_FAILURE : EXIT_SUCCESS;
+    summary.add(u"packets", count);
+    return !logger.hasErrors();
+}
+
+
+//----------------------------------------------------------------------------
+//  Program entry point
+//----------------------------------------------------------------------------
+
+int MainCode(int argc, char *argv[])
+{
+    // Decode command line options.
+    Options opt(argc, argv);
+
+    // Process all files.
+    return opt.batch.run(opt, opt.batch.useOutputStream() ? opt.pager.output(opt) : std::cout) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -234,12 +234,17 @@ namespace {
             Event(ts::Time d, uint16_t ch, uint16_t st) : due(d), terminate(false), channel_id(ch), stream_id(st) {}
         };
 
+        // Events are indexed by due time. With thousands of streams, a sorted
+        // list is too slow. Events with the same due time are kept in order of
+        // insertion by the multimap.
+        typedef std::multimap<ts::Time, Event> EventMap;
+
         // EventScheduler private fields.
         const CmdOptions& _opt;
         ts::Report&       _report;
         ts::Mutex         _mutex {};
         ts::Condition     _condition {};
-        std::list<Event>  _events {};
+        EventMap          _events {};
         size_t            _request_count = 0;
 
         // Enqueue an event.
@@ -263,16 +268,11 @@ void EventQueue::enqueue(const Event& event)
 {
     ts::GuardCondition lock(_mutex, _condition);
 
-    // Keep an ordered list of events by due time, most future first.
-    auto iter = _events.begin();
-    while (iter != _events.end() && iter->due > event.due) {
-        ++iter;
-    }
-    const bool at_end = iter == _events.end();
-    _events.insert(iter, event);
+    // Keep events ordered by due time, the next one first.
+    const auto iter = _events.insert(std::make_pair(event.due, event));
 
-    // If event was inserted at end, maybe we need to wake up.
-    if (at_end) {
+    // If event was inserted first, maybe we need to wake up.
+    if (iter == _events.begin()) {
         lock.signal();
     }
 }
@@ -293,17 +293,18 @@ bool EventQueue::waitEvent(uint16_t& channel_id, uint16_t& stream_id)
             // Wait until explicitly signalled.
             lock.waitCondition();
         }
-        else if (_events.back().due <= now) {
-            // Last event is ready.
-            channel_id = _events.back().channel_id;
-            stream_id = _events.back().stream_id;
-            const bool terminate = _events.back().terminate;
-            _events.pop_back();
+        else if (_events.begin()->first <= now) {
+            // First event is ready.
+            const Event& event(_events.begin()->second);
+            channel_id = event.channel_id;
+            stream_id = event.stream_id;
+            const bool terminate = event.terminate;
+            _events.erase(_events.begin());
             return !terminate;
         }
         else {
-            // Wait until last event time (or explicitly signalled).
-            lock.waitCondition(_events.back().due - now);
+            // Wait until first event time (or explicitly signalled).
+            lock.waitCondition(_events.begin()->first - now);
         }
     }
 }
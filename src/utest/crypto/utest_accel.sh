@@ -1,6 +1,6 @@
 #!/usr/bin/env bash
 #
-# Test effectiveness of accelerated instructions on crypto algorithms.
+# Test effectiveness of accelerated instructions on crypto algorithms and video start codes.
 # The utest exe shall be in the PATH.
 
 SCRIPT=$(basename $BASH_SOURCE)
@@ -76,3 +76,13 @@ echo "$head"
 echo "SHA-512 test with TS_NO_HARDWARE_ACCELERATION=true"
 echo "$head"
 TSUNIT_SHA512_ITERATIONS=10000000 TS_NO_HARDWARE_ACCELERATION=true "$BINDIR/utest" -d -t Crypto::SHA512
+
+echo "$head"
+echo "HEVC start code test in default configuration"
+echo "$head"
+TSUNIT_HEVC_ITERATIONS=1000 "$BINDIR/utest" -d -t Codecs::IteratorHEVC
+
+echo "$head"
+echo "HEVC start code test with TS_NO_HARDWARE_ACCELERATION=true"
+echo "$head"
+TSUNIT_HEVC_ITERATIONS=1000 TS_NO_HARDWARE_ACCELERATION=true "$BINDIR/utest" -d -t Codecs::IteratorHEVC
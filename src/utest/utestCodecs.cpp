@@ -11,7 +11,11 @@
 //----------------------------------------------------------------------------
 
 #include "tsAccessUnitIterator.h"
+#include "tsAVCAttributes.h"
 #include "tsAVC.h"
+#include "tsHEVC.h"
+#include "tsByteBlock.h"
+#include "utestTSUnitBenchmark.h"
 #include "tsunit.h"
 
 
@@ -26,9 +30,13 @@ public:
     virtual void afterTest() override;
 
     void testIterator();
+    void testIteratorHEVC();
+    void testAVCAttributes();
 
     TSUNIT_TEST_BEGIN(CodecsTest);
     TSUNIT_TEST(testIterator);
+    TSUNIT_TEST(testIteratorHEVC);
+    TSUNIT_TEST(testAVCAttributes);
     TSUNIT_TEST_END();
 };
 
@@ -121,3 +129,102 @@ void CodecsTest::testIterator()
     TSUNIT_ASSERT(iter.atEnd());
     TSUNIT_EQUAL(3, iter.currentAccessUnitIndex());
 }
+
+void CodecsTest::testIteratorHEVC()
+{
+    // Build a synthetic 4K HEVC elementary stream: 8 images, each of them with
+    // an AUD, a VPS, SPS and PPS on the first image, then 16 slices of 32 kB.
+    static constexpr size_t IMAGE_COUNT = 8;
+    static constexpr size_t SLICE_COUNT = 16;
+    static constexpr size_t SLICE_SIZE = 32 * 1024;
+    ts::ByteBlock es;
+    size_t nalunit_count = 0;
+    size_t slice_count = 0;
+    uint32_t seed = 4096;
+    for (size_t image = 0; image < IMAGE_COUNT; ++image) {
+        es.append(ts::ByteBlock({0x00, 0x00, 0x00, 0x01, uint8_t(ts::HEVC_AUT_AUD_NUT << 1), 0x01, 0x50}));
+        nalunit_count++;
+        if (image == 0) {
+            es.append(ts::ByteBlock({0x00, 0x00, 0x00, 0x01, uint8_t(ts::HEVC_AUT_VPS_NUT << 1), 0x01, 0x0C, 0x01, 0xFF, 0xFF}));
+            es.append(ts::ByteBlock({0x00, 0x00, 0x00, 0x01, uint8_t(ts::HEVC_AUT_SPS_NUT << 1), 0x01, 0x01, 0x01, 0x60, 0x00}));
+            es.append(ts::ByteBlock({0x00, 0x00, 0x00, 0x01, uint8_t(ts::HEVC_AUT_PPS_NUT << 1), 0x01, 0xC1, 0x72, 0xB4, 0x62}));
+            nalunit_count += 3;
+        }
+        for (size_t slice = 0; slice < SLICE_COUNT; ++slice) {
+            es.append(ts::ByteBlock({0x00, 0x00, 0x01, uint8_t((image == 0 ? ts::HEVC_AUT_IDR_W_RADL : ts::HEVC_AUT_TRAIL_R) << 1), 0x01}));
+            nalunit_count++;
+            slice_count++;
+            // Pseudo-random slice data, with emulation prevention bytes.
+            const size_t start = es.size();
+            es.resize(start + SLICE_SIZE);
+            for (size_t i = start; i < es.size(); ++i) {
+                seed = seed * 1103515245 + 12345;
+                es[i] = uint8_t(seed >> 16);
+                if (i >= start + 2 && es[i-2] == 0x00 && es[i-1] == 0x00 && es[i] <= 0x03) {
+                    es[i] = 0x03;
+                }
+            }
+            // A NALunit does not end with a zero byte.
+            if (es[es.size() - 1] == 0x00) {
+                es[es.size() - 1] = 0x80;
+            }
+        }
+    }
+
+    utest::TSUnitBenchmark bench(u"TSUNIT_HEVC_ITERATIONS");
+    bench.start();
+    for (size_t iter = 0; iter < bench.iterations; ++iter) {
+        size_t count = 0;
+        size_t slices = 0;
+        for (ts::AccessUnitIterator au(es.data(), es.size(), ts::ST_HEVC_VIDEO); !au.atEnd(); au.next()) {
+            count++;
+            if (au.currentAccessUnitType() == ts::HEVC_AUT_IDR_W_RADL || au.currentAccessUnitType() == ts::HEVC_AUT_TRAIL_R) {
+                slices++;
+                TSUNIT_EQUAL(SLICE_SIZE + 2, au.currentAccessUnitSize());
+            }
+        }
+        TSUNIT_EQUAL(nalunit_count, count);
+        TSUNIT_EQUAL(slice_count, slices);
+    }
+    bench.stop();
+    bench.report(u"CodecsTest::testIteratorHEVC");
+}
+
+void CodecsTest::testAVCAttributes()
+{
+    // SPS, High profile, level 4.0, 1920x1080, 4:2:0, no VUI.
+    static const uint8_t sps1[] = {0x67, 0x64, 0x00, 0x28, 0xAC, 0xD9, 0x40, 0x78, 0x02, 0x27, 0xE5, 0x40};
+    // Same SPS with level 4.1.
+    static const uint8_t sps2[] = {0x67, 0x64, 0x00, 0x29, 0xAC, 0xD9, 0x40, 0x78, 0x02, 0x27, 0xE5, 0x40};
+    // PPS, not an SPS.
+    static const uint8_t pps[] = {0x68, 0xCE, 0x38, 0x80};
+
+    ts::AVCAttributes attr;
+    TSUNIT_ASSERT(!attr.isValid());
+    TSUNIT_EQUAL(0, attr.spsCacheHits());
+    TSUNIT_EQUAL(0, attr.spsCacheMisses());
+
+    TSUNIT_ASSERT(attr.moreBinaryData(sps1, sizeof(sps1)));
+    TSUNIT_ASSERT(attr.isValid());
+    TSUNIT_EQUAL(1920, attr.horizontalSize());
+    TSUNIT_EQUAL(1080, attr.verticalSize());
+    TSUNIT_EQUAL(100, attr.profile());
+    TSUNIT_EQUAL(40, attr.level());
+    TSUNIT_EQUAL(0, attr.spsCacheHits());
+    TSUNIT_EQUAL(1, attr.spsCacheMisses());
+
+    // Other NALunits are ignored, repeated SPS are not parsed again.
+    TSUNIT_ASSERT(!attr.moreBinaryData(pps, sizeof(pps)));
+    TSUNIT_ASSERT(!attr.moreBinaryData(sps1, sizeof(sps1)));
+    TSUNIT_ASSERT(!attr.moreBinaryData(sps1, sizeof(sps1)));
+    TSUNIT_EQUAL(2, attr.spsCacheHits());
+    TSUNIT_EQUAL(1, attr.spsCacheMisses());
+
+    // A modified SPS is parsed.
+    TSUNIT_ASSERT(attr.moreBinaryData(sps2, sizeof(sps2)));
+    TSUNIT_EQUAL(41, attr.level());
+    TSUNIT_EQUAL(1920, attr.horizontalSize());
+    TSUNIT_ASSERT(!attr.moreBinaryData(sps2, sizeof(sps2)));
+    TSUNIT_EQUAL(3, attr.spsCacheHits());
+    TSUNIT_EQUAL(2, attr.spsCacheMisses());
+}
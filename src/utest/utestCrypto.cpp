@@ -28,6 +28,8 @@
 #include "tsDVBCISSA.h"
 #include "tsIDSA.h"
 #include "tsTSPacket.h"
+#include "tsTSScrambling.h"
+#include "tsNullReport.h"
 #include "tsSystemRandomGenerator.h"
 #include "tsunit.h"
 #include "utestTSUnitBenchmark.h"
@@ -65,6 +67,9 @@ public:
     void testAES_CTS3();
     void testAES_CTS4();
     void testAES_DVS042();
+    void testAES_Blocks();
+    void testMultiInPlace();
+    void testScramblingBatch();
     void testDES();
     void testTDES();
     void testTDES_CBC();
@@ -87,6 +92,9 @@ public:
     TSUNIT_TEST(testAES_CTS3);
     TSUNIT_TEST(testAES_CTS4);
     TSUNIT_TEST(testAES_DVS042);
+    TSUNIT_TEST(testAES_Blocks);
+    TSUNIT_TEST(testMultiInPlace);
+    TSUNIT_TEST(testScramblingBatch);
     TSUNIT_TEST(testDES);
     TSUNIT_TEST(testTDES);
     TSUNIT_TEST(testTDES_CBC);
@@ -127,6 +135,8 @@ private:
 
     void testChainingSizes(ts::CipherChaining& algo, int sizes, ...);
 
+    void testMulti(ts::CipherChaining& algo, const std::vector<size_t>& sizes);
+
     void testHash(utest::TSUnitBenchmark& bench,
                   ts::Hash& algo,
                   size_t tv_index,
@@ -441,6 +451,168 @@ void CryptoTest::testAES_DVS042()
     testChainingSizes(dvs042_aes, 16, 17, 23, 31, 32, 33, 45, 64, 67, 184, 12345, 0);
 }
 
+void CryptoTest::testAES_Blocks()
+{
+    // Multi-block ECB operations must give the same result as individual blocks.
+    ts::SystemRandomGenerator prng;
+    ts::AES aes;
+    ts::ByteBlock key(32);
+    ts::ByteBlock plain(13 * ts::AES::BLOCK_SIZE);
+    ts::ByteBlock cipher(plain.size());
+    ts::ByteBlock ref(ts::AES::BLOCK_SIZE);
+
+    for (size_t key_size = 16; key_size <= 32; key_size += 8) {
+        TSUNIT_ASSERT(prng.read(key.data(), key_size));
+        TSUNIT_ASSERT(prng.read(plain.data(), plain.size()));
+        TSUNIT_ASSERT(aes.setKey(key.data(), key_size));
+
+        TSUNIT_ASSERT(aes.encryptBlocks(plain.data(), cipher.data(), 13));
+        for (size_t i = 0; i < 13; ++i) {
+            TSUNIT_ASSERT(aes.encrypt(plain.data() + i * ts::AES::BLOCK_SIZE, ts::AES::BLOCK_SIZE, ref.data(), ref.size()));
+            TSUNIT_EQUAL(0, std::memcmp(ref.data(), cipher.data() + i * ts::AES::BLOCK_SIZE, ts::AES::BLOCK_SIZE));
+        }
+
+        // Decryption in place.
+        TSUNIT_ASSERT(aes.decryptBlocks(cipher.data(), cipher.data(), 13));
+        TSUNIT_ASSERT(cipher == plain);
+    }
+}
+
+void CryptoTest::testMulti(ts::CipherChaining& algo, const std::vector<size_t>& sizes)
+{
+    ts::SystemRandomGenerator prng;
+    ts::ByteBlock key(algo.maxKeySize());
+    ts::ByteBlock iv(algo.maxIVSize());
+    TSUNIT_ASSERT(prng.read(key.data(), key.size()));
+    TSUNIT_ASSERT(prng.read(iv.data(), iv.size()));
+    TSUNIT_ASSERT(algo.setKey(key.data(), key.size()));
+    if (!iv.empty()) {
+        TSUNIT_ASSERT(algo.setIV(iv.data(), iv.size()));
+    }
+
+    // Build messages, reference encryption message by message.
+    std::vector<ts::ByteBlock> plain(sizes.size());
+    std::vector<ts::ByteBlock> cipher(sizes.size());
+    std::vector<ts::ByteBlock> ref(sizes.size());
+    std::vector<void*> data(sizes.size());
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        plain[i].resize(sizes[i]);
+        TSUNIT_ASSERT(sizes[i] == 0 || prng.read(plain[i].data(), sizes[i]));
+        ref[i] = cipher[i] = plain[i];
+        TSUNIT_ASSERT(sizes[i] == 0 || algo.encryptInPlace(ref[i].data(), sizes[i]));
+        data[i] = cipher[i].data();
+    }
+
+    TSUNIT_ASSERT(algo.encryptInPlaceMulti(sizes.size(), data.data(), sizes.data()));
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        TSUNIT_ASSERT(cipher[i] == ref[i]);
+    }
+    TSUNIT_ASSERT(algo.decryptInPlaceMulti(sizes.size(), data.data(), sizes.data()));
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        TSUNIT_ASSERT(cipher[i] == plain[i]);
+    }
+}
+
+void CryptoTest::testMultiInPlace()
+{
+    // Multi-message operations must give the same result as individual messages.
+    const std::vector<size_t> blocks {176, 32, 160, 16, 176, 176, 64, 176, 176, 176, 48, 176};
+    const std::vector<size_t> residues {184, 5, 184, 17, 183, 0, 184, 100, 184, 184, 8, 184, 150, 184};
+
+    ts::CBC<ts::AES> cbc_aes;
+    testMulti(cbc_aes, blocks);
+
+    ts::DVBCISSA cissa;
+    testMulti(cissa, blocks);
+
+    ts::CTR<ts::AES> ctr_aes;
+    testMulti(ctr_aes, residues);
+
+    ts::IDSA idsa;
+    testMulti(idsa, residues);
+
+    ts::SCTE52_2008 scte;
+    testMulti(scte, residues);
+
+    ts::DVBCSA2 csa;
+    testMulti(csa, residues);
+}
+
+void CryptoTest::testScramblingBatch()
+{
+    // A batch of packets with various payload sizes.
+    static constexpr size_t PKT_COUNT = 64;
+    ts::SystemRandomGenerator prng;
+    std::vector<ts::TSPacket> plain(PKT_COUNT);
+    for (size_t i = 0; i < PKT_COUNT; ++i) {
+        plain[i].init(ts::PID(100 + i % 3), uint8_t(i & 0x0F), 0xFF);
+        TSUNIT_ASSERT(prng.read(plain[i].b + 4, ts::PKT_SIZE - 4));
+        if (i % 7 == 3) {
+            // Add an adaptation field, the payload becomes shorter.
+            plain[i].b[3] |= 0x20;
+            plain[i].b[4] = uint8_t(i);
+        }
+    }
+
+    const uint8_t types[] = {ts::SCRAMBLING_DVB_CSA2, ts::SCRAMBLING_DVB_CISSA1, ts::SCRAMBLING_ATIS_IIF_IDSA, ts::SCRAMBLING_DUCK_AES_CBC, ts::SCRAMBLING_DUCK_AES_CTR};
+    for (auto type : types) {
+        utest::TSUnitBenchmark bench(u"TSUNIT_SCRAMBLING_BATCH_ITERATIONS");
+        ts::TSScrambling single(NULLREP, type);
+        ts::TSScrambling batch(NULLREP, type);
+        ts::ByteBlock cw(16);
+        TSUNIT_ASSERT(prng.read(cw.data(), cw.size()));
+        if (type == ts::SCRAMBLING_DVB_CSA2) {
+            cw.resize(8);
+        }
+        TSUNIT_ASSERT(single.start());
+        TSUNIT_ASSERT(batch.start());
+        TSUNIT_ASSERT(single.setCW(cw, 0));
+        TSUNIT_ASSERT(batch.setCW(cw, 0));
+        TSUNIT_ASSERT(single.setEncryptParity(0));
+        TSUNIT_ASSERT(batch.setEncryptParity(0));
+
+        // Reference: packet per packet.
+        std::vector<ts::TSPacket> ref(plain);
+        for (auto& pkt : ref) {
+            TSUNIT_ASSERT(single.encrypt(pkt));
+        }
+
+        // Batch encryption must give the same result.
+        std::vector<ts::TSPacket> pkts(plain);
+        TSUNIT_ASSERT(batch.encrypt(pkts.data(), pkts.size()));
+        TSUNIT_ASSERT(pkts == ref);
+
+        // Batch decryption.
+        TSUNIT_ASSERT(batch.decrypt(pkts.data(), pkts.size()));
+        TSUNIT_ASSERT(pkts == plain);
+
+        // Same thing with non-contiguous packets: every other packet, in reverse order.
+        std::vector<ts::TSPacket*> addresses;
+        std::vector<ts::TSPacket> ref2(plain);
+        for (size_t i = PKT_COUNT; i >= 2; i -= 2) {
+            addresses.push_back(&pkts[i - 2]);
+            ref2[i - 2] = ref[i - 2];
+        }
+        TSUNIT_ASSERT(batch.encrypt(addresses.data(), addresses.size()));
+        TSUNIT_ASSERT(pkts == ref2);
+        TSUNIT_ASSERT(batch.decrypt(addresses.data(), addresses.size()));
+        TSUNIT_ASSERT(pkts == plain);
+
+        // Benchmark batch encryption + decryption.
+        bool ok = true;
+        bench.start();
+        for (size_t iter = 0; iter < bench.iterations; ++iter) {
+            ok = batch.encrypt(pkts.data(), pkts.size()) && batch.decrypt(pkts.data(), pkts.size()) && ok;
+        }
+        bench.stop();
+        TSUNIT_ASSERT(ok);
+        TSUNIT_ASSERT(pkts == plain);
+        TSUNIT_ASSERT(single.stop());
+        TSUNIT_ASSERT(batch.stop());
+        bench.report(ts::UString::Format(u"CryptoTest::testScramblingBatch (%s, %d packets)", {batch.algoName(), PKT_COUNT}));
+    }
+}
+
 void CryptoTest::testDES()
 {
     ts::DES des;
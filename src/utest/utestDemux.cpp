@@ -21,10 +21,18 @@
 #include "tsSDT.h"
 #include "tsNIT.h"
 #include "tsBAT.h"
+#include "tsEIT.h"
+#include "tsShortEventDescriptor.h"
 #include "tsTOT.h"
 #include "tsTDT.h"
 #include "tsNames.h"
+#include "tsSignalizationCache.h"
+#include "tsDVBCharTableSingleByte.h"
+#include "tsT2MIDemux.h"
+#include "tsT2MIPacket.h"
+#include "tsCRC32.h"
 #include "tsunit.h"
+#include "utestTSUnitBenchmark.h"
 
 #include "tables/psi_bat_cplus_packets.h"
 #include "tables/psi_bat_cplus_sections.h"
@@ -71,6 +79,9 @@ public:
     void testTDT();
     void testTOT();
     void testHEVC();
+    void testSignalizationCache();
+    void testT2MI();
+    void testDeserializeBenchmark();
 
     TSUNIT_TEST_BEGIN(DemuxTest);
     TSUNIT_TEST(testPAT);
@@ -84,6 +95,9 @@ public:
     TSUNIT_TEST(testTDT);
     TSUNIT_TEST(testTOT);
     TSUNIT_TEST(testHEVC);
+    TSUNIT_TEST(testSignalizationCache);
+    TSUNIT_TEST(testT2MI);
+    TSUNIT_TEST(testDeserializeBenchmark);
     TSUNIT_TEST_END();
 
 private:
@@ -93,8 +107,20 @@ private:
     // Compare a vector of packets with the list of reference packets
     bool checkPackets(const char* test_name, const char* table_name, const ts::TSPacketVector& packets, const uint8_t* ref_packets, size_t ref_packets_size);
 
+    // Demux one table from reference packets.
+    void demuxTable(ts::DuckContext& duck, ts::BinaryTable& table, const uint8_t* ref_packets, size_t ref_packets_size);
+
+    // Decoding throughput of one table type, from packets or from a binary table.
+    template <class TABLE>
+    void benchmarkTable(const char* name, const uint8_t* ref_packets, size_t ref_packets_size);
+    template <class TABLE>
+    void benchmarkTable(const char* name, ts::DuckContext& duck, const ts::BinaryTable& bin);
+
     // Unitary test for one table.
     void testTable(const char* name, const uint8_t* ref_packets, size_t ref_packets_size, const uint8_t* ref_sections, size_t ref_sections_size);
+
+    // Build a T2-MI stream on a PID, with TS packets in several PLP's.
+    void buildT2MI(ts::TSPacketVector& packets, ts::PID pid, const std::map<uint8_t, ts::TSPacketVector>& plps);
 };
 
 TSUNIT_REGISTER(DemuxTest);
@@ -468,3 +494,315 @@ void DemuxTest::testHEVC()
 {
     TEST_TABLE("PMT with HEVC descriptor", pmt_hevc);
 }
+
+void DemuxTest::testSignalizationCache()
+{
+    ts::DuckContext duck;
+    ts::BinaryTable bin;
+    demuxTable(duck, bin, psi_sdt_r3_packets, sizeof(psi_sdt_r3_packets));
+
+    // Use a private copy of the binary table to check that the content is compared.
+    ts::BinaryTable table;
+    table.copy(bin);
+
+    ts::SignalizationCache& cache(ts::SignalizationCache::Instance());
+    cache.clear();
+    const uint64_t hits = cache.hitCount();
+
+    // The cache is disabled by default.
+    TSUNIT_EQUAL(0, cache.maxTables());
+    ts::SignalizationCache::TablePtr holder0;
+    TSUNIT_ASSERT(cache.getTable<ts::SDT>(duck, bin, holder0).isValid());
+    TSUNIT_EQUAL(0, cache.tableCount());
+
+    cache.setMaxTables(16);
+    ts::SignalizationCache::TablePtr holder1;
+    const ts::SDT& sdt1(cache.getTable<ts::SDT>(duck, bin, holder1));
+    TSUNIT_ASSERT(sdt1.isValid());
+    TSUNIT_EQUAL(0x0003, sdt1.ts_id);
+    TSUNIT_EQUAL(1, cache.tableCount());
+    TSUNIT_EQUAL(hits, cache.hitCount());
+
+    // Same content: the cached instance is shared.
+    ts::SignalizationCache::TablePtr holder2;
+    const ts::SDT& sdt2(cache.getTable<ts::SDT>(duck, table, holder2));
+    TSUNIT_ASSERT(&sdt1 == &sdt2);
+    TSUNIT_ASSERT(sdt2.isShared());
+    TSUNIT_EQUAL(hits + 1, cache.hitCount());
+
+    // A copy of a shared table is private and owns its descriptors.
+    ts::SDT copy(sdt2);
+    TSUNIT_ASSERT(!copy.isShared());
+    TSUNIT_EQUAL(sdt2.services.size(), copy.services.size());
+    TSUNIT_ASSERT(!sdt2.services.empty());
+    const ts::DescriptorList& dl1(sdt2.services.begin()->second.descs);
+    const ts::DescriptorList& dl2(copy.services.begin()->second.descs);
+    TSUNIT_ASSERT(!dl1.empty());
+    TSUNIT_ASSERT(dl1[0].pointer() != dl2[0].pointer());
+    TSUNIT_ASSERT(*dl1[0] == *dl2[0]);
+
+    // The standards of the table are added in the context, with or without cache.
+    // The key contains the standards after deserialization: a new context first misses.
+    ts::DuckContext duck1;
+    TSUNIT_ASSERT(duck1.standards() == ts::Standards::NONE);
+    ts::SignalizationCache::TablePtr holder5;
+    const ts::SDT& sdt5(cache.getTable<ts::SDT>(duck1, table, holder5));
+    TSUNIT_ASSERT(&sdt5 != &sdt1);
+    TSUNIT_EQUAL(hits + 1, cache.hitCount());
+    TSUNIT_ASSERT(duck1.standards() == duck.standards());
+    TSUNIT_ASSERT(bool(duck1.standards() & ts::Standards::DVB));
+    ts::SignalizationCache::TablePtr holder6;
+    TSUNIT_ASSERT(&cache.getTable<ts::SDT>(duck1, table, holder6) == &sdt5);
+    TSUNIT_EQUAL(hits + 2, cache.hitCount());
+    TSUNIT_ASSERT(duck1.standards() == duck.standards());
+
+    // Different context: different instance.
+    ts::DuckContext duck2;
+    duck2.setDefaultCharsetIn(&ts::DVBCharTableSingleByte::DVB_ISO_8859_15);
+    ts::SignalizationCache::TablePtr holder3;
+    const ts::SDT& sdt3(cache.getTable<ts::SDT>(duck2, table, holder3));
+    TSUNIT_ASSERT(&sdt1 != &sdt3);
+    TSUNIT_EQUAL(2, cache.tableCount());
+
+    // The least recently used table is removed first.
+    cache.setMaxTables(1);
+    TSUNIT_EQUAL(1, cache.tableCount());
+    ts::SignalizationCache::TablePtr holder4;
+    cache.getTable<ts::SDT>(duck2, table, holder4);
+    TSUNIT_EQUAL(hits + 3, cache.hitCount());
+
+    cache.clear();
+    cache.setMaxTables(ts::SignalizationCache::DEFAULT_MAX_TABLES);
+    TSUNIT_EQUAL(0, cache.tableCount());
+    TSUNIT_EQUAL(0x0003, sdt1.ts_id);
+}
+
+void DemuxTest::demuxTable(ts::DuckContext& duck, ts::BinaryTable& table, const uint8_t* ref_packets, size_t ref_packets_size)
+{
+    ts::StandaloneTableDemux demux(duck, ts::AllPIDs);
+    const ts::TSPacket* pkt = reinterpret_cast<const ts::TSPacket*>(ref_packets);
+    for (size_t pi = 0; pi < ref_packets_size / ts::PKT_SIZE; ++pi) {
+        demux.feedPacket(pkt[pi]);
+    }
+    TSUNIT_EQUAL(1, demux.tableCount());
+    table = *demux.tableAt(0);
+}
+
+template <class TABLE>
+void DemuxTest::benchmarkTable(const char* name, const uint8_t* ref_packets, size_t ref_packets_size)
+{
+    ts::DuckContext duck;
+    ts::BinaryTable bin;
+    demuxTable(duck, bin, ref_packets, ref_packets_size);
+    benchmarkTable<TABLE>(name, duck, bin);
+}
+
+template <class TABLE>
+void DemuxTest::benchmarkTable(const char* name, ts::DuckContext& duck, const ts::BinaryTable& bin)
+{
+    // Support for benchmarking: number of iterations in TSUNIT_DESERIALIZE_ITERATIONS.
+    utest::TSUnitBenchmark bench(u"TSUNIT_DESERIALIZE_ITERATIONS");
+    bench.start();
+    for (size_t iter = 0; iter < bench.iterations; ++iter) {
+        const TABLE table(duck, bin);
+        TSUNIT_ASSERT(table.isValid());
+    }
+    bench.stop();
+    bench.report(ts::UString::FromUTF8(name));
+}
+
+void DemuxTest::testDeserializeBenchmark()
+{
+    benchmarkTable<ts::PMT>("DemuxTest::testDeserializeBenchmark: PMT", psi_pmt_planete_packets, sizeof(psi_pmt_planete_packets));
+    benchmarkTable<ts::SDT>("DemuxTest::testDeserializeBenchmark: SDT", psi_sdt_r3_packets, sizeof(psi_sdt_r3_packets));
+    benchmarkTable<ts::NIT>("DemuxTest::testDeserializeBenchmark: NIT", psi_nit_tntv23_packets, sizeof(psi_nit_tntv23_packets));
+    benchmarkTable<ts::BAT>("DemuxTest::testDeserializeBenchmark: BAT", psi_bat_cplus_packets, sizeof(psi_bat_cplus_packets));
+
+    // There is no reference EIT in the test tables. Build an EIT schedule with events
+    // of 5 minutes in the same segment, each one with a short event descriptor.
+    ts::DuckContext duck;
+    ts::EIT eit(true, false, 0, 0, true, 0x0101, 0x0002, 0x0003);
+    const ts::Time start(2023, 6, 1, 0, 0);
+    for (uint16_t id = 0; id < 30; ++id) {
+        ts::EIT::Event& ev(eit.events[id]);
+        ev.event_id = id;
+        ev.start_time = start + id * 5 * ts::MilliSecPerMin;
+        ev.duration = 5 * 60;
+        ev.running_status = 1;
+        ev.descs.add(duck, ts::ShortEventDescriptor(u"eng", ts::UString::Format(u"Event %d", {id}), u"Description of the event, a few words"));
+    }
+    ts::BinaryTable bin;
+    eit.serialize(duck, bin);
+    TSUNIT_ASSERT(bin.isValid());
+    const ts::EIT eit2(duck, bin);
+    TSUNIT_ASSERT(eit2.isValid());
+    TSUNIT_EQUAL(30, eit2.events.size());
+    benchmarkTable<ts::EIT>("DemuxTest::testDeserializeBenchmark: EIT", duck, bin);
+}
+
+
+//----------------------------------------------------------------------------
+// T2-MI demux.
+//----------------------------------------------------------------------------
+
+void DemuxTest::buildT2MI(ts::TSPacketVector& packets, ts::PID pid, const std::map<uint8_t, ts::TSPacketVector>& plps)
+{
+    // Size of the data field of the baseband frames, not a multiple of the user packet size.
+    constexpr size_t dfl_max = 500;
+    constexpr size_t upl = ts::PKT_SIZE - 1;
+
+    // Build the T2-MI packets, alternating baseband frames of all PLP's.
+    ts::ByteBlock t2mi;
+    std::vector<size_t> starts;
+    std::map<uint8_t, size_t> offsets;
+    for (bool more = true; more; ) {
+        more = false;
+        for (const auto& it : plps) {
+            const size_t total = it.second.size() * upl;
+            size_t& offset(offsets[it.first]);
+            if (offset >= total) {
+                continue;
+            }
+            more = true;
+            const size_t dfl = std::min(dfl_max, total - offset);
+            const size_t first = (offset + upl - 1) / upl * upl - offset;
+            const size_t payload = 3 + ts::T2_BBHEADER_SIZE + dfl;
+
+            // T2-MI header and baseband frame header.
+            starts.push_back(t2mi.size());
+            t2mi.appendUInt8(uint8_t(ts::T2MIPacketType::BASEBAND_FRAME));
+            t2mi.appendUInt8(0);      // packet count
+            t2mi.appendUInt16(0);     // superframe index, rfu
+            t2mi.appendUInt16(uint16_t(8 * payload));
+            t2mi.appendUInt8(0);      // frame index
+            t2mi.appendUInt8(it.first);
+            t2mi.appendUInt8(0);      // interleaving frame start, rfu
+            t2mi.appendUInt8(0xC0);   // MATYPE-1: TS mode
+            t2mi.appendUInt8(0);      // MATYPE-2
+            t2mi.appendUInt16(uint16_t(8 * ts::PKT_SIZE));
+            t2mi.appendUInt16(uint16_t(8 * dfl));
+            t2mi.appendUInt8(ts::SYNC_BYTE);
+            t2mi.appendUInt16(first < dfl ? uint16_t(8 * first) : 0xFFFF);
+            t2mi.appendUInt8(0);      // CRC-8, not checked
+
+            // User packets without sync byte.
+            for (size_t i = 0; i < dfl; ++i) {
+                const size_t index = offset + i;
+                t2mi.appendUInt8(it.second[index / upl].b[1 + index % upl]);
+            }
+            offset += dfl;
+            t2mi.appendUInt32(ts::CRC32(t2mi.data() + starts.back(), t2mi.size() - starts.back()));
+        }
+    }
+
+    // Packetize the T2-MI packets in TS packets, using pointer fields.
+    uint8_t cc = 0;
+    size_t next_start = 0;
+    for (size_t index = 0; index < t2mi.size(); ) {
+        ts::TSPacket pkt;
+        pkt.init(pid, cc, 0xFF);
+        cc = (cc + 1) & ts::CC_MASK;
+        uint8_t* data = pkt.b + ts::PKT_HEADER_SIZE;
+        size_t size = ts::PKT_SIZE - ts::PKT_HEADER_SIZE;
+        while (next_start < starts.size() && starts[next_start] < index) {
+            next_start++;
+        }
+        if (next_start < starts.size() && starts[next_start] < index + size - 1) {
+            pkt.setPUSI();
+            *data++ = uint8_t(starts[next_start] - index);
+            size--;
+        }
+        size = std::min(size, t2mi.size() - index);
+        std::memcpy(data, t2mi.data() + index, size);
+        index += size;
+        packets.push_back(pkt);
+    }
+}
+
+namespace {
+    class T2MITestHandler : public ts::T2MIHandlerInterface
+    {
+    public:
+        size_t t2mi_count = 0;
+        std::map<uint8_t, ts::TSPacketVector> plps {};
+        virtual void handleT2MINewPID(ts::T2MIDemux&, const ts::PMT&, ts::PID, const ts::T2MIDescriptor&) override {}
+        virtual void handleT2MIPacket(ts::T2MIDemux&, const ts::T2MIPacket&) override { t2mi_count++; }
+        virtual void handleTSPacket(ts::T2MIDemux&, const ts::T2MIPacket& t2mi, const ts::TSPacket& ts) override { plps[t2mi.plp()].push_back(ts); }
+    };
+}
+
+void DemuxTest::testT2MI()
+{
+    constexpr ts::PID pid = 0x1000;
+
+    // Reference TS packets in two PLP's.
+    std::map<uint8_t, ts::TSPacketVector> ref;
+    for (uint8_t plp = 0; plp < 2; ++plp) {
+        ts::TSPacketVector& packets(ref[plp]);
+        for (size_t i = 0; i < 20 + size_t(plp); ++i) {
+            ts::TSPacket pkt;
+            pkt.init(100 + plp, uint8_t(i), uint8_t(i + plp));
+            packets.push_back(pkt);
+        }
+    }
+
+    ts::TSPacketVector stream;
+    buildT2MI(stream, pid, ref);
+    TSUNIT_ASSERT(!stream.empty());
+
+    // Notification of TS packets to the handler.
+    ts::DuckContext duck;
+    T2MITestHandler handler;
+    ts::T2MIDemux demux1(duck, &handler, ts::PIDSet().set(pid));
+    for (const auto& pkt : stream) {
+        demux1.feedPacket(pkt);
+    }
+    TSUNIT_ASSERT(handler.t2mi_count > 0);
+    TSUNIT_EQUAL(2, handler.plps.size());
+    TSUNIT_ASSERT(handler.plps[0] == ref[0]);
+    TSUNIT_ASSERT(handler.plps[1] == ref[1]);
+    TSUNIT_EQUAL(0, demux1.queuedTSPackets(pid, 0));
+
+    // Output queue for one PLP, without T2-MI notification.
+    T2MITestHandler handler2;
+    ts::T2MIDemux demux2(duck, &handler2, ts::PIDSet().set(pid));
+    demux2.setT2MIPacketNotification(false);
+    demux2.setPLPQueue(pid, 1);
+    for (const auto& pkt : stream) {
+        demux2.feedPacket(pkt);
+    }
+    TSUNIT_EQUAL(0, handler2.t2mi_count);
+    TSUNIT_EQUAL(1, handler2.plps.size());
+    TSUNIT_ASSERT(handler2.plps[0] == ref[0]);
+    TSUNIT_EQUAL(21, demux2.queuedTSPackets(pid, 1));
+
+    ts::T2MIDemux::PLPSet plps;
+    demux2.getPLPs(pid, plps);
+    TSUNIT_EQUAL(2, plps.count());
+    demux2.getPLPs(pid, plps, true);
+    TSUNIT_EQUAL(1, plps.count());
+    TSUNIT_ASSERT(plps.test(1));
+
+    ts::TSPacketVector out(30);
+    TSUNIT_EQUAL(5, demux2.getTSPackets(pid, 1, out.data(), 5));
+    TSUNIT_EQUAL(16, demux2.getTSPackets(pid, 1, out.data() + 5, 25));
+    TSUNIT_EQUAL(0, demux2.getTSPackets(pid, 1, out.data(), 30));
+    out.resize(21);
+    TSUNIT_ASSERT(out == ref[1]);
+
+    // Output queues for all PLP's, without handler, fed packet by packet.
+    ts::T2MIDemux demux3(duck, nullptr, ts::PIDSet().set(pid));
+    demux3.setAllPLPQueues();
+    std::map<uint8_t, ts::TSPacketVector> res;
+    for (const auto& pkt : stream) {
+        demux3.feedPacket(pkt);
+        for (uint8_t plp = 0; plp < 2; ++plp) {
+            ts::TSPacket ts;
+            while (demux3.getTSPackets(pid, plp, &ts, 1) == 1) {
+                res[plp].push_back(ts);
+            }
+        }
+    }
+    TSUNIT_ASSERT(res[0] == ref[0]);
+    TSUNIT_ASSERT(res[1] == ref[1]);
+}
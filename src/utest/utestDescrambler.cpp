@@ -0,0 +1,309 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for the descrambler plugin.
+//
+//----------------------------------------------------------------------------
+
+#include "tsPluginEventHandlerInterface.h"
+#include "tsPluginEventData.h"
+#include "tsPluginRepository.h"
+#include "tsTSProcessor.h"
+#include "tsTSScrambling.h"
+#include "tsOneShotPacketizer.h"
+#include "tsDuckProtocol.h"
+#include "tsCADescriptor.h"
+#include "tsPAT.h"
+#include "tsPMT.h"
+#include "tsFileUtils.h"
+#include "tsNullReport.h"
+#include "tsunit.h"
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class DescramblerTest: public tsunit::Test
+{
+public:
+    DescramblerTest();
+
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testThreads();
+    void testECM();
+
+    TSUNIT_TEST_BEGIN(DescramblerTest);
+    TSUNIT_TEST(testThreads);
+    TSUNIT_TEST(testECM);
+    TSUNIT_TEST_END();
+
+private:
+    ts::UString _cwFileName;
+
+    // Run the descrambler plugin on a list of packets.
+    static void Descramble(const ts::TSPacketVector& input, ts::TSPacketVector& output, const ts::UStringVector& args);
+};
+
+TSUNIT_REGISTER(DescramblerTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Constructor.
+DescramblerTest::DescramblerTest() :
+    _cwFileName()
+{
+}
+
+// Test suite initialization method.
+void DescramblerTest::beforeTest()
+{
+    if (_cwFileName.empty()) {
+        _cwFileName = ts::TempFile(u".txt");
+    }
+    ts::DeleteFile(_cwFileName, NULLREP);
+}
+
+// Test suite cleanup method.
+void DescramblerTest::afterTest()
+{
+    ts::DeleteFile(_cwFileName, NULLREP);
+}
+
+
+//----------------------------------------------------------------------------
+// Event handlers for memory input and output plugins.
+//----------------------------------------------------------------------------
+
+namespace {
+    class Input : public ts::PluginEventHandlerInterface
+    {
+        TS_NOBUILD_NOCOPY(Input);
+    public:
+        Input(const ts::TSPacketVector& packets) : _packets(packets) {}
+        virtual void handlePluginEvent(const ts::PluginEventContext& context) override;
+    private:
+        const ts::TSPacketVector& _packets;
+        size_t _next = 0;
+    };
+
+    void Input::handlePluginEvent(const ts::PluginEventContext& context)
+    {
+        ts::PluginEventData* data = dynamic_cast<ts::PluginEventData*>(context.pluginData());
+        if (data != nullptr && _next < _packets.size()) {
+            const size_t count = std::min(_packets.size() - _next, data->maxSize() / ts::PKT_SIZE);
+            data->append(&_packets[_next], count * ts::PKT_SIZE);
+            _next += count;
+        }
+    }
+
+    class Output : public ts::PluginEventHandlerInterface
+    {
+        TS_NOBUILD_NOCOPY(Output);
+    public:
+        Output(ts::TSPacketVector& packets) : _packets(packets) {}
+        virtual void handlePluginEvent(const ts::PluginEventContext& context) override;
+    private:
+        ts::TSPacketVector& _packets;
+    };
+
+    void Output::handlePluginEvent(const ts::PluginEventContext& context)
+    {
+        ts::PluginEventData* data = dynamic_cast<ts::PluginEventData*>(context.pluginData());
+        if (data != nullptr) {
+            const size_t count = data->size() / ts::PKT_SIZE;
+            const size_t index = _packets.size();
+            _packets.resize(index + count);
+            ts::TSPacket::Copy(&_packets[index], data->data(), count);
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Run the descrambler plugin on a list of packets.
+//----------------------------------------------------------------------------
+
+void DescramblerTest::Descramble(const ts::TSPacketVector& input, ts::TSPacketVector& output, const ts::UStringVector& args)
+{
+    // The descrambler plugin is a shared library which is built with the unitary tests.
+    if (ts::PluginRepository::Instance().getProcessor(u"descrambler", CERR) == nullptr) {
+        TSUNIT_FAIL("descrambler plugin not found, check TSPLUGINS_PATH");
+    }
+
+    output.clear();
+    Input in(input);
+    Output out(output);
+
+    ts::TSProcessorArgs opt;
+    opt.input = {u"memory", {}};
+    opt.plugins = {{u"descrambler", args}};
+    opt.output = {u"memory", {}};
+
+    ts::TSProcessor tsp(CERR);
+    tsp.registerEventHandler(&in, ts::PluginType::INPUT);
+    tsp.registerEventHandler(&out, ts::PluginType::OUTPUT);
+    TSUNIT_ASSERT(tsp.start(opt));
+    tsp.waitForTermination();
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void DescramblerTest::testThreads()
+{
+    // Two control words, the next one is used each time the parity changes.
+    const ts::ByteBlock cw1({0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF});
+    const ts::ByteBlock cw2({0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10});
+    constexpr size_t CRYPTO_PERIOD = 50;
+    constexpr size_t PACKET_COUNT = 5 * CRYPTO_PERIOD + 7;
+
+    // Build clear packets and scramble them, changing the parity at each crypto-period.
+    ts::TSPacketVector clear(PACKET_COUNT);
+    ts::TSPacketVector scrambled(PACKET_COUNT);
+    ts::TSScrambling scrambler(NULLREP);
+    TSUNIT_ASSERT(scrambler.start());
+    TSUNIT_ASSERT(scrambler.setCW(cw1, ts::SC_EVEN_KEY));
+    TSUNIT_ASSERT(scrambler.setCW(cw2, ts::SC_ODD_KEY));
+    for (size_t i = 0; i < PACKET_COUNT; ++i) {
+        clear[i].init(100, uint8_t(i & 0x0F));
+        for (size_t j = 0; j < clear[i].getPayloadSize(); ++j) {
+            clear[i].getPayload()[j] = uint8_t(i * 7 + j);
+        }
+        scrambled[i] = clear[i];
+        TSUNIT_ASSERT(scrambler.setEncryptParity(int((i / CRYPTO_PERIOD) & 1)));
+        TSUNIT_ASSERT(scrambler.encrypt(scrambled[i]));
+    }
+    TSUNIT_ASSERT(scrambled[0].getScrambling() == ts::SC_EVEN_KEY);
+    TSUNIT_ASSERT(scrambled[CRYPTO_PERIOD].getScrambling() == ts::SC_ODD_KEY);
+    TSUNIT_ASSERT(std::memcmp(&clear[0], &scrambled[0], ts::PKT_SIZE) != 0);
+
+    // Descramble with several threads. The packet windows are not aligned on crypto-periods.
+    // The control words are loaded from a file, the option --cw accepts only one value.
+    TSUNIT_ASSERT(ts::UString::Save(ts::UStringList({u"0123456789ABCDEF", u"FEDCBA9876543210"}), _cwFileName));
+    ts::TSPacketVector output;
+    Descramble(scrambled, output, {u"--pid", u"100", u"--cw-file", _cwFileName, u"--threads", u"3", u"--packet-window", u"20"});
+
+    TSUNIT_EQUAL(PACKET_COUNT, output.size());
+    for (size_t i = 0; i < PACKET_COUNT; ++i) {
+        TSUNIT_EQUAL(ts::SC_CLEAR, output[i].getScrambling());
+        TSUNIT_EQUAL(0, std::memcmp(&clear[i], &output[i], ts::PKT_SIZE));
+    }
+}
+
+void DescramblerTest::testECM()
+{
+    // One service with two components. Each component has its own ECM stream,
+    // the packets of the two components are interleaved. Each ECM contains the
+    // control words of the current and next crypto-periods.
+    constexpr uint16_t SERVICE_ID = 1;
+    constexpr ts::PID PMT_PID = 1000;
+    constexpr ts::PID ES_PID[2] = {100, 101};
+    constexpr ts::PID ECM_PID[2] = {200, 201};
+    constexpr size_t CRYPTO_PERIODS = 6;
+    constexpr size_t CRYPTO_PERIOD = 40;
+
+    ts::DuckContext duck;
+    ts::TSPacketVector clear;
+    ts::TSPacketVector scrambled;
+    ts::TSPacketVector packets;
+
+    // Control word of a component in a crypto-period.
+    const auto cw = [](size_t comp, size_t cp) {
+        return ts::ByteBlock({uint8_t(comp), uint8_t(cp), 0x45, 0x67, 0x89, 0xAB, 0xCD, uint8_t(0x10 * comp + cp)});
+    };
+
+    // Signalization, in the clear.
+    ts::PAT pat(0, true, 1);
+    pat.pmts[SERVICE_ID] = PMT_PID;
+    ts::OneShotPacketizer pat_pzer(duck, ts::PID_PAT);
+    pat_pzer.addTable(duck, pat);
+    pat_pzer.getPackets(packets);
+    clear.insert(clear.end(), packets.begin(), packets.end());
+
+    ts::PMT pmt(0, true, SERVICE_ID, ES_PID[0]);
+    for (size_t comp = 0; comp < 2; ++comp) {
+        ts::PMT::Stream& stream(pmt.streams[ES_PID[comp]]);
+        stream.stream_type = comp == 0 ? ts::ST_MPEG2_VIDEO : ts::ST_MPEG2_AUDIO;
+        stream.descs.add(duck, ts::CADescriptor(0x1234, ECM_PID[comp]));
+    }
+    ts::OneShotPacketizer pmt_pzer(duck, PMT_PID);
+    pmt_pzer.addTable(duck, pmt);
+    pmt_pzer.getPackets(packets);
+    clear.insert(clear.end(), packets.begin(), packets.end());
+    scrambled = clear;
+
+    ts::duck::Protocol protocol;
+    ts::TSScrambling scrambler[2] {NULLREP, NULLREP};
+    std::unique_ptr<ts::OneShotPacketizer> ecm_pzer[2];
+    uint8_t cc[2] {0, 0};
+    for (size_t comp = 0; comp < 2; ++comp) {
+        TSUNIT_ASSERT(scrambler[comp].start());
+        ecm_pzer[comp].reset(new ts::OneShotPacketizer(duck, ECM_PID[comp]));
+    }
+
+    for (size_t cp = 0; cp < CRYPTO_PERIODS; ++cp) {
+        // New ECM's at the beginning of each crypto-period.
+        for (size_t comp = 0; comp < 2; ++comp) {
+            ts::duck::ClearECM ecm(protocol);
+            (cp % 2 == 0 ? ecm.cw_even : ecm.cw_odd) = cw(comp, cp);
+            (cp % 2 == 0 ? ecm.cw_odd : ecm.cw_even) = cw(comp, cp + 1);
+            ts::ByteBlockPtr data(new ts::ByteBlock);
+            ts::tlv::Serializer zer(data);
+            ecm.serialize(zer);
+            ecm_pzer[comp]->addSection(ts::SectionPtr(new ts::Section(ts::TID(0x80 + cp % 2), true, data->data(), data->size())));
+            ecm_pzer[comp]->getPackets(packets);
+            ecm_pzer[comp]->removeAll();
+            clear.insert(clear.end(), packets.begin(), packets.end());
+            scrambled.insert(scrambled.end(), packets.begin(), packets.end());
+            TSUNIT_ASSERT(scrambler[comp].setCW(cw(comp, cp), int(cp % 2)));
+            TSUNIT_ASSERT(scrambler[comp].setEncryptParity(int(cp % 2)));
+        }
+
+        // Interleaved packets of the two components.
+        for (size_t i = 0; i < CRYPTO_PERIOD; ++i) {
+            const size_t comp = i % 2;
+            ts::TSPacket pkt;
+            pkt.init(ES_PID[comp], cc[comp]++ & 0x0F);
+            for (size_t j = 0; j < pkt.getPayloadSize(); ++j) {
+                pkt.getPayload()[j] = uint8_t(cp * 31 + i * 7 + j);
+            }
+            clear.push_back(pkt);
+            TSUNIT_ASSERT(scrambler[comp].encrypt(pkt));
+            scrambled.push_back(pkt);
+        }
+    }
+    TSUNIT_EQUAL(clear.size(), scrambled.size());
+
+    // Descramble inline and with several threads. With small windows, the key generations
+    // of the two ECM streams change inside windows and are interleaved in each window.
+    const ts::UStringVector options[] = {
+        {u"--synchronous"},
+        {u"--synchronous", u"--packet-window", u"25"},
+        {u"--synchronous", u"--threads", u"3", u"--packet-window", u"25"},
+    };
+    for (const auto& opts : options) {
+        ts::UStringVector args({u"1"});
+        args.insert(args.end(), opts.begin(), opts.end());
+        ts::TSPacketVector output;
+        Descramble(scrambled, output, args);
+        debug() << "DescramblerTest::testECM: " << ts::UString::Join(args, u" ") << std::endl;
+        TSUNIT_EQUAL(clear.size(), output.size());
+        for (size_t i = 0; i < output.size(); ++i) {
+            TSUNIT_EQUAL(ts::SC_CLEAR, output[i].getScrambling());
+            TSUNIT_EQUAL(0, std::memcmp(&clear[i], &output[i], ts::PKT_SIZE));
+        }
+    }
+}
@@ -0,0 +1,434 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::ECMGClient
+//
+//----------------------------------------------------------------------------
+
+#include "tsECMGClient.h"
+#include "tsTCPServer.h"
+#include "tsGuardMutex.h"
+#include "tsSysUtils.h"
+#include "tsNullReport.h"
+#include "utestTSUnitThread.h"
+#include "tsunit.h"
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class ECMGClientTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testBucketLimits();
+    void testLatency();
+    void testNotConnected();
+    void testLoopback();
+    void testConcurrentOpen();
+
+    TSUNIT_TEST_BEGIN(ECMGClientTest);
+    TSUNIT_TEST(testBucketLimits);
+    TSUNIT_TEST(testLatency);
+    TSUNIT_TEST(testNotConnected);
+    TSUNIT_TEST(testLoopback);
+    TSUNIT_TEST(testConcurrentOpen);
+    TSUNIT_TEST_END();
+};
+
+TSUNIT_REGISTER(ECMGClientTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void ECMGClientTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void ECMGClientTest::afterTest()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void ECMGClientTest::testBucketLimits()
+{
+    typedef ts::ECMGClient::LatencyStatistics LS;
+    TSUNIT_EQUAL(1, LS::BucketLimit(0));
+    TSUNIT_EQUAL(2, LS::BucketLimit(1));
+    TSUNIT_EQUAL(5, LS::BucketLimit(2));
+    TSUNIT_EQUAL(10, LS::BucketLimit(3));
+    TSUNIT_EQUAL(2000, LS::BucketLimit(ts::ECMGClient::LATENCY_BUCKETS - 2));
+    TSUNIT_EQUAL(ts::Infinite, LS::BucketLimit(ts::ECMGClient::LATENCY_BUCKETS - 1));
+}
+
+void ECMGClientTest::testLatency()
+{
+    ts::ECMGClient::LatencyStatistics lat;
+    TSUNIT_EQUAL(0, lat.latency.count());
+    TSUNIT_EQUAL(u"", lat.histogramString());
+
+    lat.feed(0);
+    lat.feed(7);
+    lat.feed(8);
+    lat.feed(20);
+    lat.feed(3000);
+
+    TSUNIT_EQUAL(5, lat.latency.count());
+    TSUNIT_EQUAL(0, lat.latency.minimum());
+    TSUNIT_EQUAL(3000, lat.latency.maximum());
+    TSUNIT_EQUAL(1, lat.histogram[0]);
+    TSUNIT_EQUAL(2, lat.histogram[3]);
+    TSUNIT_EQUAL(1, lat.histogram[5]);
+    TSUNIT_EQUAL(1, lat.histogram[ts::ECMGClient::LATENCY_BUCKETS - 1]);
+    TSUNIT_EQUAL(u"<1ms: 1, <10ms: 2, <50ms: 1, >=2000ms: 1", lat.histogramString());
+}
+
+void ECMGClientTest::testNotConnected()
+{
+    ts::ecmgscs::Protocol protocol;
+    ts::ECMGClient client(protocol);
+    TSUNIT_ASSERT(!client.isConnected());
+    TSUNIT_EQUAL(0, client.pendingRequests());
+    TSUNIT_ASSERT(!client.disconnect());
+}
+
+// A fake ECMG thread, serving one connection on the loopback interface.
+// ECM requests are answered by batches, in reverse order. The ECM datagram
+// contains the ECM_stream_id and CP_number to check the correlation.
+namespace {
+    class FakeECMG: public utest::TSUnitThread
+    {
+        TS_NOBUILD_NOCOPY(FakeECMG);
+    public:
+        FakeECMG(const ts::ecmgscs::Protocol& protocol, uint16_t port, size_t batch) :
+            utest::TSUnitThread(),
+            _protocol(protocol),
+            _port(port),
+            _batch(batch)
+        {
+        }
+
+        virtual ~FakeECMG() override
+        {
+            waitForTermination();
+        }
+
+        // Start listening, before the client connects.
+        bool listen()
+        {
+            return _server.open(CERR) &&
+                   _server.reusePort(true, CERR) &&
+                   _server.bind(ts::IPv4SocketAddress(ts::IPv4Address::LocalHost, _port), CERR) &&
+                   _server.listen(5, CERR);
+        }
+
+        // Number of requests to receive before sending the responses.
+        void setBatch(size_t batch)
+        {
+            ts::GuardMutex lock(_mutex);
+            _batch = batch;
+        }
+
+        // Maximum number of simultaneously pending requests.
+        size_t maxPending() const
+        {
+            ts::GuardMutex lock(_mutex);
+            return _max_pending;
+        }
+
+        // Thread execution.
+        virtual void test() override
+        {
+            ts::tlv::Logger logger(ts::Severity::Debug, &CERR);
+            ts::tlv::Connection<ts::NullMutex> conn(_protocol, true, 3);
+            ts::IPv4SocketAddress client;
+            TSUNIT_ASSERT(_server.accept(conn, client, CERR));
+
+            std::vector<ts::tlv::MessagePtr> pending;
+            ts::tlv::MessagePtr msg;
+            while (conn.receive(msg, nullptr, logger)) {
+                const ts::tlv::ChannelMessage* const cmsg = dynamic_cast<const ts::tlv::ChannelMessage*>(msg.pointer());
+                const ts::tlv::StreamMessage* const smsg = dynamic_cast<const ts::tlv::StreamMessage*>(msg.pointer());
+                switch (msg->tag()) {
+                    case ts::ecmgscs::Tags::channel_setup: {
+                        TSUNIT_ASSERT(cmsg != nullptr);
+                        ts::ecmgscs::ChannelStatus resp(_protocol);
+                        resp.channel_id = cmsg->channel_id;
+                        resp.CW_per_msg = 1;
+                        resp.max_comp_time = 100;
+                        TSUNIT_ASSERT(conn.send(resp, logger));
+                        break;
+                    }
+                    case ts::ecmgscs::Tags::stream_setup: {
+                        const ts::ecmgscs::StreamSetup* const setup = dynamic_cast<const ts::ecmgscs::StreamSetup*>(msg.pointer());
+                        TSUNIT_ASSERT(setup != nullptr);
+                        ts::ecmgscs::StreamStatus resp(_protocol);
+                        resp.channel_id = setup->channel_id;
+                        resp.stream_id = setup->stream_id;
+                        resp.ECM_id = setup->ECM_id;
+                        TSUNIT_ASSERT(conn.send(resp, logger));
+                        break;
+                    }
+                    case ts::ecmgscs::Tags::CW_provision: {
+                        TSUNIT_ASSERT(smsg != nullptr);
+                        const uint16_t cp_number = dynamic_cast<const ts::ecmgscs::CWProvision*>(smsg)->CP_number;
+                        ts::ecmgscs::ECMResponse* resp = new ts::ecmgscs::ECMResponse(_protocol);
+                        resp->channel_id = smsg->channel_id;
+                        resp->stream_id = smsg->stream_id;
+                        resp->CP_number = cp_number;
+                        resp->ECM_datagram = {uint8_t(smsg->stream_id >> 8), uint8_t(smsg->stream_id), uint8_t(cp_number >> 8), uint8_t(cp_number)};
+                        pending.push_back(ts::tlv::MessagePtr(resp));
+                        ts::GuardMutex lock(_mutex);
+                        _max_pending = std::max(_max_pending, pending.size());
+                        if (pending.size() >= _batch) {
+                            for (auto it = pending.rbegin(); it != pending.rend(); ++it) {
+                                TSUNIT_ASSERT(conn.send(**it, logger));
+                            }
+                            pending.clear();
+                        }
+                        break;
+                    }
+                    case ts::ecmgscs::Tags::stream_close_request: {
+                        TSUNIT_ASSERT(smsg != nullptr);
+                        ts::ecmgscs::StreamCloseResponse resp(_protocol);
+                        resp.channel_id = smsg->channel_id;
+                        resp.stream_id = smsg->stream_id;
+                        TSUNIT_ASSERT(conn.send(resp, logger));
+                        break;
+                    }
+                    default: {
+                        break;
+                    }
+                }
+            }
+            conn.disconnect(NULLREP);
+            conn.close(NULLREP);
+            _server.close(NULLREP);
+        }
+
+    private:
+        const ts::ecmgscs::Protocol& _protocol;
+        const uint16_t _port;
+        ts::TCPServer  _server {};
+        mutable ts::Mutex _mutex {};
+        size_t _batch;
+        size_t _max_pending = 0;
+    };
+
+    // Collect asynchronous ECM responses.
+    class ECMCollector: public ts::ECMGClientHandlerInterface
+    {
+    public:
+        ECMCollector() = default;
+        virtual void handleECM(const ts::ecmgscs::ECMResponse& response) override
+        {
+            ts::GuardMutex lock(_mutex);
+            _responses.push_back(std::make_pair(response.stream_id, response.CP_number));
+            _correlated = _correlated && response.ECM_datagram == ts::ByteBlock({uint8_t(response.stream_id >> 8), uint8_t(response.stream_id), uint8_t(response.CP_number >> 8), uint8_t(response.CP_number)});
+        }
+        std::set<std::pair<uint16_t, uint16_t>> responses(size_t& count, bool& correlated) const
+        {
+            ts::GuardMutex lock(_mutex);
+            count = _responses.size();
+            correlated = _correlated;
+            return std::set<std::pair<uint16_t, uint16_t>>(_responses.begin(), _responses.end());
+        }
+    private:
+        mutable ts::Mutex _mutex {};
+        std::vector<std::pair<uint16_t, uint16_t>> _responses {};
+        bool _correlated = true;
+    };
+}
+
+void ECMGClientTest::testLoopback()
+{
+    TSUNIT_ASSERT(ts::IPInitialize());
+
+    const uint16_t port = 12347;
+    constexpr size_t BATCH = 4;
+    constexpr uint16_t REQUESTS = 8;
+
+    ts::ecmgscs::Protocol protocol;
+    protocol.setVersion(2);
+    FakeECMG ecmg(protocol, port, BATCH);
+    TSUNIT_ASSERT(ecmg.listen());
+    ecmg.start();
+
+    // Two clients share one ECM channel, with the same requested stream and ECM ids.
+    ts::ECMGClientArgs args;
+    args.ecmg_address = ts::IPv4SocketAddress(ts::IPv4Address::LocalHost, port);
+    args.super_cas_id = 0x12345678;
+    args.cp_duration = 10000;
+    args.dvbsim_version = 2;
+    args.ecm_channel_id = 1;
+    args.ecm_stream_id = 1;
+    args.ecm_id = 1;
+    args.shared_channel = true;
+    args.max_outstanding = BATCH;
+
+    const ts::tlv::Logger logger(ts::Severity::Debug, &CERR);
+    ts::ECMGClient client1(protocol);
+    ts::ECMGClient client2(protocol);
+    ts::ecmgscs::ChannelStatus channel_status(protocol);
+    ts::ecmgscs::StreamStatus stream_status1(protocol);
+    ts::ecmgscs::StreamStatus stream_status2(protocol);
+    TSUNIT_ASSERT(client1.connect(args, channel_status, stream_status1, nullptr, logger));
+    TSUNIT_ASSERT(client2.connect(args, channel_status, stream_status2, nullptr, logger));
+    TSUNIT_ASSERT(client1.isConnected());
+    TSUNIT_ASSERT(client2.isConnected());
+
+    // The fake ECMG accepts only one connection: the second client uses the same
+    // channel and gets the next free stream and ECM ids.
+    TSUNIT_EQUAL(1, stream_status1.stream_id);
+    TSUNIT_EQUAL(1, stream_status1.ECM_id);
+    TSUNIT_EQUAL(2, stream_status2.stream_id);
+    TSUNIT_EQUAL(2, stream_status2.ECM_id);
+
+    // Pipelined asynchronous requests. The ECMG responds only when it has received
+    // a full batch, which would never happen without pipelining.
+    const ts::ByteBlock cw(8, 0x55);
+    ECMCollector collector;
+    std::set<std::pair<uint16_t, uint16_t>> expected;
+    for (uint16_t cp = 0; cp < REQUESTS; ++cp) {
+        TSUNIT_ASSERT(client1.submitECM(cp, cw, ts::ByteBlock(), ts::ByteBlock(), 0, &collector));
+        TSUNIT_ASSERT(client2.submitECM(cp + 100, cw, ts::ByteBlock(), ts::ByteBlock(), 0, &collector));
+        expected.insert(std::make_pair(uint16_t(1), cp));
+        expected.insert(std::make_pair(uint16_t(2), uint16_t(cp + 100)));
+    }
+    for (int i = 0; i < 500 && (client1.pendingRequests() > 0 || client2.pendingRequests() > 0); ++i) {
+        ts::SleepThread(10);
+    }
+    TSUNIT_EQUAL(0, client1.pendingRequests());
+    TSUNIT_EQUAL(0, client2.pendingRequests());
+
+    size_t count = 0;
+    bool correlated = false;
+    const std::set<std::pair<uint16_t, uint16_t>> received(collector.responses(count, correlated));
+    TSUNIT_EQUAL(2 * REQUESTS, count);
+    TSUNIT_ASSERT(correlated);
+    TSUNIT_ASSERT(received == expected);
+    TSUNIT_EQUAL(BATCH, ecmg.maxPending());
+    TSUNIT_EQUAL(REQUESTS, client1.latencyStatistics().latency.count());
+    TSUNIT_EQUAL(REQUESTS, client2.latencyStatistics().latency.count());
+    TSUNIT_EQUAL(0, client1.latencyStatistics().timeouts);
+
+    // Synchronous requests, answered immediately.
+    ecmg.setBatch(1);
+    ts::ecmgscs::ECMResponse response(protocol);
+    TSUNIT_ASSERT(client2.generateECM(200, cw, ts::ByteBlock(), ts::ByteBlock(), 0, response));
+    TSUNIT_EQUAL(2, response.stream_id);
+    TSUNIT_EQUAL(200, response.CP_number);
+    TSUNIT_ASSERT(response.ECM_datagram == ts::ByteBlock({0x00, 0x02, 0x00, 200}));
+    TSUNIT_ASSERT(client1.generateECM(201, cw, ts::ByteBlock(), ts::ByteBlock(), 0, response));
+    TSUNIT_EQUAL(1, response.stream_id);
+    TSUNIT_EQUAL(201, response.CP_number);
+
+    // The channel is closed with the last client.
+    TSUNIT_ASSERT(client2.disconnect());
+    TSUNIT_ASSERT(!client2.isConnected());
+    TSUNIT_ASSERT(client1.isConnected());
+    TSUNIT_ASSERT(client1.disconnect());
+    TSUNIT_ASSERT(!client1.isConnected());
+}
+
+// A client thread, connecting to a shared channel.
+namespace {
+    class ConnectThread: public utest::TSUnitThread
+    {
+        TS_NOBUILD_NOCOPY(ConnectThread);
+    public:
+        ConnectThread(const ts::ecmgscs::Protocol& protocol, const ts::ECMGClientArgs& args) :
+            utest::TSUnitThread(),
+            client(protocol),
+            stream_status(protocol),
+            _protocol(protocol),
+            _args(args)
+        {
+        }
+
+        virtual ~ConnectThread() override
+        {
+            waitForTermination();
+        }
+
+        virtual void test() override
+        {
+            const ts::tlv::Logger logger(ts::Severity::Debug, &CERR);
+            ts::ecmgscs::ChannelStatus channel_status(_protocol);
+            TSUNIT_ASSERT(client.connect(_args, channel_status, stream_status, nullptr, logger));
+        }
+
+        ts::ECMGClient client;
+        ts::ecmgscs::StreamStatus stream_status;
+
+    private:
+        const ts::ecmgscs::Protocol& _protocol;
+        const ts::ECMGClientArgs& _args;
+    };
+}
+
+void ECMGClientTest::testConcurrentOpen()
+{
+    TSUNIT_ASSERT(ts::IPInitialize());
+
+    const uint16_t port = 12349;
+    constexpr size_t CLIENTS = 4;
+
+    ts::ecmgscs::Protocol protocol;
+    protocol.setVersion(2);
+    FakeECMG ecmg(protocol, port, 1);
+    TSUNIT_ASSERT(ecmg.listen());
+    ecmg.start();
+
+    ts::ECMGClientArgs args;
+    args.ecmg_address = ts::IPv4SocketAddress(ts::IPv4Address::LocalHost, port);
+    args.super_cas_id = 0x12345678;
+    args.cp_duration = 10000;
+    args.dvbsim_version = 2;
+    args.ecm_channel_id = 2;
+    args.ecm_stream_id = 1;
+    args.ecm_id = 1;
+    args.shared_channel = true;
+
+    // All clients simultaneously open the same shared channel. The fake ECMG accepts
+    // only one connection: the first client connects, the others wait for it.
+    std::vector<std::unique_ptr<ConnectThread>> threads;
+    for (size_t i = 0; i < CLIENTS; ++i) {
+        threads.push_back(std::unique_ptr<ConnectThread>(new ConnectThread(protocol, args)));
+    }
+    for (const auto& th : threads) {
+        th->start();
+    }
+    std::set<uint16_t> stream_ids;
+    for (const auto& th : threads) {
+        th->waitForTermination();
+        TSUNIT_ASSERT(th->client.isConnected());
+        stream_ids.insert(th->stream_status.stream_id);
+    }
+    TSUNIT_EQUAL(CLIENTS, stream_ids.size());
+
+    ts::ecmgscs::ECMResponse response(protocol);
+    for (const auto& th : threads) {
+        TSUNIT_ASSERT(th->client.generateECM(10, ts::ByteBlock(8, 0x55), ts::ByteBlock(), ts::ByteBlock(), 0, response));
+        TSUNIT_EQUAL(th->stream_status.stream_id, response.stream_id);
+    }
+    for (const auto& th : threads) {
+        TSUNIT_ASSERT(th->client.disconnect());
+    }
+}
@@ -0,0 +1,169 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::FileBatch.
+//
+//----------------------------------------------------------------------------
+
+#include "tsFileBatch.h"
+#include "tsFileUtils.h"
+#include "tsjsonObject.h"
+#include "tsNullReport.h"
+#include "tsunit.h"
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class FileBatchTest: public tsunit::Test
+{
+public:
+    FileBatchTest();
+
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testOutputStream();
+    void testOutputDirectory();
+
+    TSUNIT_TEST_BEGIN(FileBatchTest);
+    TSUNIT_TEST(testOutputStream);
+    TSUNIT_TEST(testOutputDirectory);
+    TSUNIT_TEST_END();
+
+private:
+    ts::UString _tempDir;
+    void cleanupDir();
+};
+
+TSUNIT_REGISTER(FileBatchTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Constructor.
+FileBatchTest::FileBatchTest() :
+    _tempDir()
+{
+}
+
+// Test suite initialization method.
+void FileBatchTest::beforeTest()
+{
+    if (_tempDir.empty()) {
+        _tempDir = ts::TempFile(u"");
+    }
+    cleanupDir();
+}
+
+// Test suite cleanup method.
+void FileBatchTest::afterTest()
+{
+    cleanupDir();
+}
+
+void FileBatchTest::cleanupDir()
+{
+    if (ts::IsDirectory(_tempDir)) {
+        ts::UStringVector files;
+        ts::ExpandWildcard(files, _tempDir + ts::PathSeparator + u"*");
+        for (const auto& name : files) {
+            ts::DeleteFile(name, NULLREP);
+        }
+        ts::DeleteFile(_tempDir, NULLREP);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// A file batch which reports the name of each file, without reading it.
+//----------------------------------------------------------------------------
+
+namespace {
+    class TestBatch: public ts::FileBatch
+    {
+    public:
+        TestBatch() = default;
+    protected:
+        virtual bool processFile(const ts::UString& file_name, std::ostream& output, ts::Report& report, ts::json::Object& summary) override;
+    };
+
+    bool TestBatch::processFile(const ts::UString& file_name, std::ostream& output, ts::Report&, ts::json::Object& summary)
+    {
+        output << "report of " << file_name << std::endl;
+        summary.add(u"size", file_name.size());
+        return true;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void FileBatchTest::testOutputStream()
+{
+    TestBatch batch;
+    ts::Args args(u"test", u"[files]", ts::Args::NO_EXIT_ON_ERROR | ts::Args::NO_ERROR_DISPLAY);
+    batch.defineArgs(args);
+    args.option(u"", 0, ts::Args::STRING, 0, ts::Args::UNLIMITED_COUNT);
+    TSUNIT_ASSERT(args.analyze(u"test", {u"--threads", u"3", u"dir1/a.ts", u"dir2/a.ts", u"b.ts", u"dir3/a.ts"}));
+    TSUNIT_ASSERT(batch.loadArgs(args));
+    TSUNIT_ASSERT(batch.batchMode());
+    TSUNIT_ASSERT(batch.useOutputStream());
+
+    // The reports are written in the order of the input files, whatever thread processes them.
+    std::ostringstream out;
+    TSUNIT_ASSERT(batch.run(NULLREP, out));
+    TSUNIT_EQUAL("==== dir1/a.ts\n"
+                 "report of dir1/a.ts\n"
+                 "==== dir2/a.ts\n"
+                 "report of dir2/a.ts\n"
+                 "==== b.ts\n"
+                 "report of b.ts\n"
+                 "==== dir3/a.ts\n"
+                 "report of dir3/a.ts\n",
+                 out.str());
+}
+
+void FileBatchTest::testOutputDirectory()
+{
+    TestBatch batch;
+    ts::Args args(u"test", u"[files]", ts::Args::NO_EXIT_ON_ERROR | ts::Args::NO_ERROR_DISPLAY);
+    batch.defineArgs(args);
+    args.option(u"", 0, ts::Args::STRING, 0, ts::Args::UNLIMITED_COUNT);
+    TSUNIT_ASSERT(args.analyze(u"test", {u"--output-directory", _tempDir, u"--threads", u"2", u"dir1/a.ts", u"dir2/a.ts", u"b.ts", u"dir3/A.TS"}));
+    TSUNIT_ASSERT(batch.loadArgs(args));
+    TSUNIT_ASSERT(!batch.useOutputStream());
+
+    std::ostringstream out;
+    TSUNIT_ASSERT(batch.run(NULLREP, out));
+    TSUNIT_ASSERT(out.str().empty());
+
+    // Input files with the same base name (ignoring case) produce distinct reports.
+    const ts::UString prefix(_tempDir + ts::PathSeparator);
+    ts::UStringVector files;
+    ts::ExpandWildcard(files, prefix + u"*");
+    std::sort(files.begin(), files.end());
+    TSUNIT_EQUAL(4, files.size());
+    TSUNIT_EQUAL(prefix + u"A.TS-4.txt", files[0]);
+    TSUNIT_EQUAL(prefix + u"a.ts-1.txt", files[1]);
+    TSUNIT_EQUAL(prefix + u"a.ts-2.txt", files[2]);
+    TSUNIT_EQUAL(prefix + u"b.ts.txt", files[3]);
+
+    ts::UStringList lines;
+    TSUNIT_ASSERT(ts::UString::Load(lines, prefix + u"a.ts-2.txt"));
+    TSUNIT_EQUAL(1, lines.size());
+    TSUNIT_EQUAL(u"report of dir2/a.ts", lines.front());
+    TSUNIT_ASSERT(ts::UString::Load(lines, prefix + u"A.TS-4.txt"));
+    TSUNIT_EQUAL(1, lines.size());
+    TSUNIT_EQUAL(u"report of dir3/A.TS", lines.front());
+}
@@ -0,0 +1,308 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::InputSwitcher.
+//
+//----------------------------------------------------------------------------
+
+#include "tsInputSwitcher.h"
+#include "tsPluginEventHandlerInterface.h"
+#include "tsPluginEventData.h"
+#include "tsTSFile.h"
+#include "tsFileUtils.h"
+#include "tsSysUtils.h"
+#include "tsGuardMutex.h"
+#include "tsNullReport.h"
+#include "tsunit.h"
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class InputSwitcherTest: public tsunit::Test
+{
+public:
+    InputSwitcherTest();
+
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testFixContinuity();
+    void testWarmStandby();
+
+    TSUNIT_TEST_BEGIN(InputSwitcherTest);
+    TSUNIT_TEST(testFixContinuity);
+    TSUNIT_TEST(testWarmStandby);
+    TSUNIT_TEST_END();
+
+private:
+    ts::UString _tempPrefix;
+    ts::UString fileName(const ts::UString& name) const { return _tempPrefix + name; }
+    void cleanupFiles();
+};
+
+TSUNIT_REGISTER(InputSwitcherTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Constructor.
+InputSwitcherTest::InputSwitcherTest() :
+    _tempPrefix()
+{
+}
+
+// Test suite initialization method.
+void InputSwitcherTest::beforeTest()
+{
+    if (_tempPrefix.empty()) {
+        _tempPrefix = ts::TempFile(u"");
+    }
+    cleanupFiles();
+}
+
+// Test suite cleanup method.
+void InputSwitcherTest::afterTest()
+{
+    cleanupFiles();
+}
+
+void InputSwitcherTest::cleanupFiles()
+{
+    ts::DeleteFile(fileName(u"-a.ts"), NULLREP);
+    ts::DeleteFile(fileName(u"-b.ts"), NULLREP);
+    ts::DeleteFile(fileName(u"-out.ts"), NULLREP);
+}
+
+
+//----------------------------------------------------------------------------
+// Event handlers for memory plugins, for the warm standby test.
+//----------------------------------------------------------------------------
+
+namespace {
+    constexpr ts::PID PID_WARM = 100;
+
+    // Original continuity counter of packet at index in an input. The second input
+    // has a continuity error every 3 packets, the first one has none.
+    uint8_t InputCC(size_t input, size_t index)
+    {
+        return uint8_t((input == 0 ? index : index + index / 3) & ts::CC_MASK);
+    }
+
+    // Endless input plugins, packets contain the input index and the packet index.
+    // Each input has a PCR every 10 packets.
+    class WarmInput : public ts::PluginEventHandlerInterface
+    {
+        TS_NOCOPY(WarmInput);
+    public:
+        WarmInput() = default;
+        virtual void handlePluginEvent(const ts::PluginEventContext& context) override;
+    private:
+        size_t _next[2] {0, 0};
+    };
+
+    void WarmInput::handlePluginEvent(const ts::PluginEventContext& context)
+    {
+        ts::PluginEventData* data = dynamic_cast<ts::PluginEventData*>(context.pluginData());
+        const size_t input = context.pluginIndex();
+        if (data != nullptr && input < 2) {
+            for (size_t count = 0; count < 10 && data->remainingSize() >= ts::PKT_SIZE; ++count) {
+                const size_t index = _next[input]++;
+                ts::TSPacket pkt;
+                pkt.init(PID_WARM, InputCC(input, index));
+                if (index % 10 == 0) {
+                    pkt.setPCR(index * 1000, true);
+                }
+                uint8_t* pl = pkt.getPayload();
+                pl[0] = uint8_t(input);
+                ts::PutUInt32(pl + 1, uint32_t(index));
+                data->append(&pkt, ts::PKT_SIZE);
+            }
+            ts::SleepThread(2);
+        }
+    }
+
+    // Output plugin, collect all packets.
+    class WarmOutput : public ts::PluginEventHandlerInterface
+    {
+        TS_NOCOPY(WarmOutput);
+    public:
+        WarmOutput() = default;
+        ts::TSPacketVector packets() const;
+        virtual void handlePluginEvent(const ts::PluginEventContext& context) override;
+    private:
+        mutable ts::Mutex  _mutex {};
+        ts::TSPacketVector _packets {};
+    };
+
+    ts::TSPacketVector WarmOutput::packets() const
+    {
+        ts::GuardMutex lock(_mutex);
+        return _packets;
+    }
+
+    void WarmOutput::handlePluginEvent(const ts::PluginEventContext& context)
+    {
+        ts::PluginEventData* data = dynamic_cast<ts::PluginEventData*>(context.pluginData());
+        if (data != nullptr) {
+            ts::GuardMutex lock(_mutex);
+            const size_t count = data->size() / ts::PKT_SIZE;
+            const size_t index = _packets.size();
+            _packets.resize(index + count);
+            ts::TSPacket::Copy(&_packets[index], data->data(), count);
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void InputSwitcherTest::testFixContinuity()
+{
+    constexpr ts::PID PID_VIDEO = 100;
+
+    // First input: 20 packets in PID 100, continuity counters 0 to 3 (modulo 16).
+    ts::TSPacketVector packetsA(20);
+    for (size_t i = 0; i < packetsA.size(); ++i) {
+        packetsA[i].init(PID_VIDEO, uint8_t(i & ts::CC_MASK));
+    }
+
+    // Second input: starts in the middle of a PAT section, followed by the start
+    // of a PAT section, then PID 100 with a PCR and a continuity error.
+    ts::TSPacketVector packetsB(7);
+    packetsB[0].init(ts::PID_PAT, 5);
+    packetsB[1].init(ts::PID_PAT, 6);
+    packetsB[1].setPUSI();
+    packetsB[2].init(PID_VIDEO, 7);
+    TSUNIT_ASSERT(packetsB[2].setPCR(1000, true));
+    packetsB[3].init(PID_VIDEO, 8);
+    packetsB[4].init(PID_VIDEO, 9);
+    packetsB[5].init(PID_VIDEO, 11);
+    packetsB[6].init(PID_VIDEO, 12);
+
+    ts::TSFile file;
+    TSUNIT_ASSERT(file.open(fileName(u"-a.ts"), ts::TSFile::WRITE, CERR));
+    TSUNIT_ASSERT(file.writePackets(packetsA.data(), nullptr, packetsA.size(), CERR));
+    TSUNIT_ASSERT(file.close(CERR));
+    TSUNIT_ASSERT(file.open(fileName(u"-b.ts"), ts::TSFile::WRITE, CERR));
+    TSUNIT_ASSERT(file.writePackets(packetsB.data(), nullptr, packetsB.size(), CERR));
+    TSUNIT_ASSERT(file.close(CERR));
+
+    // Switch from the first input to the second one at end of input.
+    ts::InputSwitcherArgs args;
+    args.fixContinuity = true;
+    args.inputs = {{u"file", {fileName(u"-a.ts")}}, {u"file", {fileName(u"-b.ts")}}};
+    args.output = {u"file", {fileName(u"-out.ts")}};
+
+    ts::InputSwitcher switcher(CERR);
+    TSUNIT_ASSERT(switcher.start(args));
+    switcher.waitForTermination();
+
+    ts::TSPacketVector output(packetsA.size() + packetsB.size() + 1);
+    TSUNIT_ASSERT(file.open(fileName(u"-out.ts"), ts::TSFile::READ, CERR));
+    TSUNIT_EQUAL(packetsA.size() + packetsB.size(), file.readPackets(output.data(), nullptr, output.size(), CERR));
+    TSUNIT_ASSERT(file.close(CERR));
+
+    // The first input is unmodified.
+    for (size_t i = 0; i < packetsA.size(); ++i) {
+        TSUNIT_EQUAL(0, std::memcmp(&packetsA[i], &output[i], ts::PKT_SIZE));
+    }
+    const ts::TSPacket* outB = &output[packetsA.size()];
+
+    // The PAT packet in the middle of a section is dropped, the next one is unmodified.
+    TSUNIT_EQUAL(ts::PID_NULL, outB[0].getPID());
+    TSUNIT_EQUAL(0, std::memcmp(&packetsB[1], &outB[1], ts::PKT_SIZE));
+
+    // The continuity counters of PID 100 continue the first input, the continuity error is preserved.
+    TSUNIT_EQUAL(PID_VIDEO, outB[2].getPID());
+    TSUNIT_EQUAL(4, outB[2].getCC());
+    TSUNIT_EQUAL(5, outB[3].getCC());
+    TSUNIT_EQUAL(6, outB[4].getCC());
+    TSUNIT_EQUAL(8, outB[5].getCC());
+    TSUNIT_EQUAL(9, outB[6].getCC());
+
+    // The first PCR after the switch signals a discontinuity.
+    TSUNIT_ASSERT(outB[2].hasPCR());
+    TSUNIT_EQUAL(1000, outB[2].getPCR());
+    TSUNIT_ASSERT(outB[2].getDiscontinuityIndicator());
+}
+
+void InputSwitcherTest::testWarmStandby()
+{
+    WarmInput input;
+    WarmOutput output;
+
+    ts::InputSwitcherArgs args;
+    args.fastSwitch = true;
+    args.warmStandby = true;
+    args.fixContinuity = true;
+    args.bufferedPackets = 100;
+    args.maxInputPackets = 10;
+    args.inputs = {{u"memory", {}}, {u"memory", {}}};
+    args.output = {u"memory", {}};
+
+    // Switch to the second input while the two inputs are running.
+    ts::InputSwitcher switcher(CERR);
+    switcher.registerEventHandler(&input, ts::PluginType::INPUT);
+    switcher.registerEventHandler(&output, ts::PluginType::OUTPUT);
+    TSUNIT_ASSERT(switcher.start(args));
+    ts::SleepThread(200);
+    switcher.setInput(1);
+    ts::SleepThread(200);
+    switcher.stop();
+    switcher.waitForTermination();
+
+    const ts::TSPacketVector packets(output.packets());
+    size_t switch_index = ts::NPOS;
+    size_t first_pcr = ts::NPOS;
+    for (size_t i = 0; i < packets.size(); ++i) {
+        TSUNIT_EQUAL(PID_WARM, packets[i].getPID());
+        const size_t in = packets[i].getPayload()[0];
+        const size_t index = ts::GetUInt32(packets[i].getPayload() + 1);
+        TSUNIT_ASSERT(in < 2);
+        if (i == 0) {
+            TSUNIT_EQUAL(0, in);
+            continue;
+        }
+        const size_t prev_in = packets[i-1].getPayload()[0];
+        const size_t prev_index = ts::GetUInt32(packets[i-1].getPayload() + 1);
+        const uint8_t out_diff = uint8_t((packets[i].getCC() - packets[i-1].getCC()) & ts::CC_MASK);
+        if (in == prev_in) {
+            // Same input: the continuity errors of the input are preserved, no other change.
+            TSUNIT_EQUAL(prev_index + 1, index);
+            TSUNIT_EQUAL((InputCC(in, index) - InputCC(in, prev_index)) & ts::CC_MASK, out_diff);
+        }
+        else {
+            // Switch from the first input to the second one, only once.
+            TSUNIT_EQUAL(0, prev_in);
+            TSUNIT_EQUAL(1, in);
+            TSUNIT_EQUAL(ts::NPOS, switch_index);
+            switch_index = i;
+            // The warm standby input kept only its recent packets.
+            TSUNIT_ASSERT(index > 0);
+            // The continuity state of the standby input was maintained: the continuity
+            // error between the last dropped packet and the first output one is preserved.
+            TSUNIT_EQUAL((InputCC(in, index) - InputCC(in, index - 1)) & ts::CC_MASK, out_diff);
+        }
+        // Only the first PCR after the switch signals a discontinuity.
+        if (in == 1 && first_pcr == ts::NPOS && packets[i].hasPCR()) {
+            first_pcr = i;
+            TSUNIT_ASSERT(packets[i].getDiscontinuityIndicator());
+        }
+        else if (packets[i].hasPCR()) {
+            TSUNIT_ASSERT(!packets[i].getDiscontinuityIndicator());
+        }
+    }
+    TSUNIT_ASSERT(switch_index != ts::NPOS);
+    TSUNIT_ASSERT(first_pcr != ts::NPOS);
+}
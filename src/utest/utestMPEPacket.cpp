@@ -11,7 +11,11 @@
 //----------------------------------------------------------------------------
 
 #include "tsMPEPacket.h"
+#include "tsMPEDemux.h"
+#include "tsOneShotPacketizer.h"
+#include "tsDuckContext.h"
 #include "tsunit.h"
+#include "utestTSUnitBenchmark.h"
 #include "tables/psi_mpe_sections.h"
 
 
@@ -27,11 +31,19 @@ public:
 
     void testSection();
     void testBuild();
+    void testReuse();
+    void testDemux();
 
     TSUNIT_TEST_BEGIN(MPEPacketTest);
     TSUNIT_TEST(testSection);
     TSUNIT_TEST(testBuild);
+    TSUNIT_TEST(testReuse);
+    TSUNIT_TEST(testDemux);
     TSUNIT_TEST_END();
+
+private:
+    // Build a stream of MPE sections with two different destinations.
+    static void buildStream(ts::DuckContext& duck, ts::TSPacketVector& packets, ts::PID pid, size_t count);
 };
 
 TSUNIT_REGISTER(MPEPacketTest);
@@ -120,3 +132,115 @@ void MPEPacketTest::testBuild()
     TSUNIT_ASSERT(mpe2.udpMessage() != nullptr);
     TSUNIT_EQUAL(0, std::memcmp(mpe2.udpMessage(), ref, mpe2.udpMessageSize()));
 }
+
+void MPEPacketTest::testReuse()
+{
+    const ts::PID pid = 1234;
+    const ts::Section sec1(psi_mpe_sections, sizeof(psi_mpe_sections), pid, ts::CRC32::CHECK);
+
+    ts::MPEPacket ref;
+    ref.setSourcePID(pid);
+    ref.setDestinationSocket(ts::IPv4SocketAddress(123, 34, 45, 78, 4654));
+    ref.setUDPMessage(psi_mpe_sections, 100);
+    ts::Section sec2;
+    ref.createSection(sec2);
+    TSUNIT_ASSERT(sec2.isValid());
+
+    // Decoding successive sections reuses the same datagram buffer.
+    ts::MPEPacket mpe(sec1);
+    TSUNIT_ASSERT(mpe.isValid());
+    const uint8_t* const buffer = mpe.datagram();
+    mpe.copy(sec2);
+    TSUNIT_ASSERT(mpe.isValid());
+    TSUNIT_ASSERT(mpe.datagram() == buffer);
+    TSUNIT_ASSERT(mpe.destinationIPAddress() == ts::IPv4Address(123, 34, 45, 78));
+
+    // A shared buffer is not overwritten.
+    ts::MPEPacket shared(mpe, ts::ShareMode::SHARE);
+    mpe.copy(sec1);
+    TSUNIT_ASSERT(mpe.isValid());
+    TSUNIT_ASSERT(mpe.datagram() != buffer);
+    TSUNIT_ASSERT(mpe.destinationIPAddress() == ts::IPv4Address(224, 20, 20, 2));
+    TSUNIT_ASSERT(shared.datagram() == buffer);
+    TSUNIT_ASSERT(shared.destinationIPAddress() == ts::IPv4Address(123, 34, 45, 78));
+}
+
+void MPEPacketTest::buildStream(ts::DuckContext& duck, ts::TSPacketVector& packets, ts::PID pid, size_t count)
+{
+    ts::MPEPacket mpe;
+    mpe.setSourcePID(pid);
+    mpe.setDestinationSocket(ts::IPv4SocketAddress(123, 34, 45, 78, 4654));
+    mpe.setUDPMessage(psi_mpe_sections, 200);
+    ts::SectionPtr sec2(new ts::Section);
+    mpe.createSection(*sec2);
+
+    ts::OneShotPacketizer pzer(duck, pid);
+    const ts::SectionPtr sec1(new ts::Section(psi_mpe_sections, sizeof(psi_mpe_sections), pid, ts::CRC32::CHECK));
+    for (size_t i = 0; i < count; ++i) {
+        pzer.addSection(sec1);
+        pzer.addSection(sec2);
+    }
+    pzer.getPackets(packets);
+}
+
+namespace {
+    class MPETestHandler : public ts::MPEHandlerInterface
+    {
+    public:
+        size_t count = 0;
+        size_t bytes = 0;
+        std::set<ts::IPv4SocketAddress> destinations {};
+        virtual void handleMPENewPID(ts::MPEDemux&, const ts::PMT&, ts::PID) override {}
+        virtual void handleMPEPacket(ts::MPEDemux&, const ts::MPEPacket& mpe) override
+        {
+            count++;
+            bytes += mpe.udpMessageSize();
+            destinations.insert(mpe.destinationSocket());
+        }
+    };
+}
+
+void MPEPacketTest::testDemux()
+{
+    const ts::PID pid = 1234;
+    ts::DuckContext duck;
+    ts::TSPacketVector packets;
+    buildStream(duck, packets, pid, 20);
+
+    // All datagrams.
+    MPETestHandler handler1;
+    ts::MPEDemux demux1(duck, &handler1);
+    demux1.addPID(pid);
+    for (const auto& pkt : packets) {
+        demux1.feedPacket(pkt);
+    }
+    TSUNIT_EQUAL(40, handler1.count);
+    TSUNIT_EQUAL(2, handler1.destinations.size());
+
+    // Filter on destination, before decoding the datagrams.
+    MPETestHandler handler2;
+    ts::MPEDemux demux2(duck, &handler2);
+    demux2.addPID(pid);
+    demux2.setDestinationFilter(ts::IPv4SocketAddress(224, 20, 20, 2, 6000));
+    for (const auto& pkt : packets) {
+        demux2.feedPacket(pkt);
+    }
+    TSUNIT_EQUAL(20, handler2.count);
+    TSUNIT_EQUAL(20 * 1468, handler2.bytes);
+    TSUNIT_EQUAL(1, handler2.destinations.size());
+
+    // Support for benchmarking: number of iterations in TSUNIT_MPE_ITERATIONS.
+    utest::TSUnitBenchmark bench(u"TSUNIT_MPE_ITERATIONS");
+    MPETestHandler handler3;
+    ts::MPEDemux demux3(duck, &handler3);
+    demux3.addPID(pid);
+    bench.start();
+    for (size_t iter = 0; iter < bench.iterations; ++iter) {
+        for (const auto& pkt : packets) {
+            demux3.feedPacket(pkt);
+        }
+    }
+    bench.stop();
+    bench.report(u"MPEPacketTest::testDemux");
+    TSUNIT_ASSERT(handler3.count > 0);
+}
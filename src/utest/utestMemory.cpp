@@ -74,6 +74,7 @@ public:
     void testGetIntVarLE();
     void testPutIntVarBE();
     void testPutIntVarLE();
+    void testLocateZeroZero();
 
     TSUNIT_TEST_BEGIN(MemoryTest);
     TSUNIT_TEST(testGetUInt8);
@@ -126,6 +127,7 @@ public:
     TSUNIT_TEST(testGetIntVarLE);
     TSUNIT_TEST(testPutIntVarBE);
     TSUNIT_TEST(testPutIntVarLE);
+    TSUNIT_TEST(testLocateZeroZero);
     TSUNIT_TEST_END();
 };
 
@@ -510,3 +512,32 @@ void MemoryTest::testPutIntVarLE()
     ts::PutIntVarLE(out, 8, 0x908F8E8D8C8B8A89);
     TSUNIT_EQUAL(0, std::memcmp(out, _bytes + 0x89, 8));
 }
+
+void MemoryTest::testLocateZeroZero()
+{
+    static const uint8_t data[] = {0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x01, 0x47, 0x00, 0x00, 0x01, 0x00, 0x00};
+    TSUNIT_EQUAL(4, ts::LocateZeroZero(data, sizeof(data), 0x01) - data);
+    TSUNIT_EQUAL(3, ts::LocateZeroZero(data, sizeof(data), 0x00) - data);
+    TSUNIT_EQUAL(0, ts::LocateZeroZero(data, sizeof(data), 0x02) - data);
+    TSUNIT_ASSERT(ts::LocateZeroZero(data, 6, 0x01) == nullptr);
+    TSUNIT_ASSERT(ts::LocateZeroZero(data + 11, 2, 0x00) == nullptr);
+    TSUNIT_ASSERT(ts::LocateZeroZero(nullptr, 10, 0x01) == nullptr);
+
+    // Compare with LocatePattern() on pseudo-random areas with frequent zeroes, with all
+    // sizes and alignments, to exercise all SIMD block boundaries.
+    uint8_t area[300];
+    uint32_t seed = 12345;
+    for (size_t size = 0; size < 256; ++size) {
+        for (size_t start = 0; start < 4; ++start) {
+            for (size_t i = 0; i < sizeof(area); ++i) {
+                seed = seed * 1103515245 + 12345;
+                const uint32_t r = (seed >> 16) % 16;
+                area[i] = r < 3 ? 0x00 : (r == 3 ? 0x01 : uint8_t(seed >> 24));
+            }
+            for (uint8_t third = 0; third < 2; ++third) {
+                const uint8_t pattern[] = {0x00, 0x00, third};
+                TSUNIT_ASSERT(ts::LocateZeroZero(area + start, size, third) == ts::LocatePattern(area + start, size, pattern, sizeof(pattern)));
+            }
+        }
+    }
+}
@@ -14,6 +14,9 @@
 #include "tsPluginEventData.h"
 #include "tsTSProcessor.h"
 #include "tsAsyncReport.h"
+#include "tsMemoryPacketRing.h"
+#include "tsSharedPacketRing.h"
+#include "tsNullReport.h"
 #include "tsunit.h"
 
 
@@ -28,9 +31,17 @@ public:
     virtual void afterTest() override;
 
     void testAll();
+    void testRing();
+    void testSharedRing();
+    void testSharedRingBlock();
+    void testSharedRingReclaim();
 
     TSUNIT_TEST_BEGIN(MemoryPluginTest);
     TSUNIT_TEST(testAll);
+    TSUNIT_TEST(testRing);
+    TSUNIT_TEST(testSharedRing);
+    TSUNIT_TEST(testSharedRingBlock);
+    TSUNIT_TEST(testSharedRingReclaim);
     TSUNIT_TEST_END();
 };
 
@@ -233,3 +244,251 @@ void MemoryPluginTest::testAll()
     TSUNIT_EQUAL(0, std::memcmp(&output_packets[0], REF_PACKETS, ts::PKT_SIZE * REF_PACKETS_COUNT));
     TSUNIT_EQUAL(u"", log_buffer);
 }
+
+void MemoryPluginTest::testRing()
+{
+    ts::UString log_buffer;
+    TestReport log(log_buffer);
+
+    // Small rings to exercise the wrap-around.
+    ts::MemoryPacketRing in_ring(u"utest-input", 2);
+    const ts::MemoryPacketRingPtr found(ts::MemoryPacketRing::Find(u"utest-input"));
+    TSUNIT_ASSERT(!found.isNull());
+    TSUNIT_EQUAL(u"utest-input", found->name());
+    TSUNIT_EQUAL(2, found->capacity());
+    TSUNIT_ASSERT(ts::MemoryPacketRing::Find(u"utest-foo").isNull());
+
+    ts::TSProcessorArgs opt;
+    opt.input = {u"memory", {u"--ring", u"utest-input"}};
+    opt.output = {u"memory", {u"--ring", u"utest-output"}};
+
+    // Application input: write directly into the ring. The producer must run before
+    // starting the pipeline because the input packets are preloaded in start().
+    std::thread producer([&in_ring]() {
+        size_t index = 0;
+        while (index < REF_PACKETS_COUNT) {
+            ts::TSPacket* pkt = nullptr;
+            ts::TSPacketMetadata* mdata = nullptr;
+            const size_t count = std::min(REF_PACKETS_COUNT - index, in_ring.getWriteArea(pkt, mdata));
+            if (count == 0) {
+                break;
+            }
+            ts::TSPacket::Copy(pkt, REF_PACKETS + index, count);
+            in_ring.commitWrite(count);
+            index += count;
+        }
+        in_ring.setEndOfStream();
+    });
+
+    ts::TSProcessor tsp(log);
+    const bool started = tsp.start(opt);
+    if (!started) {
+        in_ring.abort();
+        producer.join();
+    }
+    TSUNIT_ASSERT(started);
+
+    // Application output: the ring is created after the start of the pipeline.
+    // The output plugin waits for it. Read packets directly from the ring.
+    ts::MemoryPacketRing out_ring(u"utest-output", 2);
+    ts::TSPacketVector output_packets;
+    const ts::TSPacket* pkt = nullptr;
+    const ts::TSPacketMetadata* mdata = nullptr;
+    size_t count = 0;
+    while ((count = out_ring.getReadArea(pkt, mdata)) > 0) {
+        output_packets.insert(output_packets.end(), pkt, pkt + count);
+        out_ring.commitRead(count);
+    }
+    TSUNIT_ASSERT(out_ring.endOfStream());
+
+    producer.join();
+    tsp.waitForTermination();
+
+    TSUNIT_EQUAL(REF_PACKETS_COUNT, output_packets.size());
+    TSUNIT_EQUAL(0, std::memcmp(&output_packets[0], REF_PACKETS, ts::PKT_SIZE * REF_PACKETS_COUNT));
+    TSUNIT_EQUAL(u"", log_buffer);
+
+    // The memory of a ring remains valid after the deletion of the application instance.
+    ts::MemoryPacketRing* owner = new ts::MemoryPacketRing(u"utest-owner", 4);
+    const ts::MemoryPacketRingPtr user(ts::MemoryPacketRing::Find(u"utest-owner"));
+    TSUNIT_ASSERT(!user.isNull());
+    TSUNIT_EQUAL(1, owner->write(REF_PACKETS, nullptr, 1));
+    TSUNIT_EQUAL(1, user->packetCount());
+    delete owner;
+    TSUNIT_ASSERT(ts::MemoryPacketRing::Find(u"utest-owner").isNull());
+    TSUNIT_ASSERT(user->aborted());
+    TSUNIT_EQUAL(1, user->packetCount());
+    TSUNIT_EQUAL(0, user->write(REF_PACKETS, nullptr, 1));
+}
+
+void MemoryPluginTest::testSharedRing()
+{
+#if defined(TS_UNIX)
+    const ts::UString name(ts::UString::Format(u"utest-%d", {ts::CurrentProcessId()}));
+    ts::Report& rep(NULLREP);
+
+    // Writer and reader in the same process, small ring with drop policy.
+    ts::SharedPacketRing writer;
+    ts::SharedPacketRing reader;
+    TSUNIT_ASSERT(!reader.open(name, 0, rep));
+    TSUNIT_ASSERT(writer.create(name, 8, 2, ts::SharedPacketRing::LagPolicy::DROP, rep));
+    TSUNIT_ASSERT(reader.open(name, 0, rep));
+
+    // Reference packets with distinct PID's and labels.
+    ts::TSPacket ref[16];
+    ts::TSPacketMetadata mdata[16];
+    for (size_t i = 0; i < 16; ++i) {
+        ref[i] = ts::NullPacket;
+        ref[i].setPID(ts::PID(i));
+        mdata[i].setLabel(i % ts::TSPacketLabelSet::SIZE);
+    }
+
+    // Write less than the capacity, read everything back with metadata.
+    ts::TSPacket pkt[8];
+    ts::TSPacketMetadata mpkt[8];
+    TSUNIT_ASSERT(writer.write(ref, mdata, 5, rep));
+    TSUNIT_EQUAL(5, reader.read(pkt, mpkt, 8, rep));
+    TSUNIT_EQUAL(0, std::memcmp(pkt, ref, 5 * ts::PKT_SIZE));
+    for (size_t i = 0; i < 5; ++i) {
+        TSUNIT_ASSERT(mpkt[i].hasLabel(i % ts::TSPacketLabelSet::SIZE));
+    }
+    TSUNIT_EQUAL(0, reader.lostPackets());
+
+    // Overflow the ring: the reader loses the oldest packets.
+    TSUNIT_ASSERT(writer.write(ref, mdata, 11, rep));
+    TSUNIT_EQUAL(8, reader.read(pkt, nullptr, 8, rep));
+    TSUNIT_EQUAL(0, std::memcmp(pkt, ref + 3, 8 * ts::PKT_SIZE));
+    TSUNIT_EQUAL(3, reader.lostPackets());
+
+    // Closing the writer means end of stream after the remaining packets.
+    TSUNIT_ASSERT(writer.write(ref, nullptr, 2, rep));
+    writer.close();
+    TSUNIT_EQUAL(2, reader.read(pkt, nullptr, 8, rep));
+    TSUNIT_EQUAL(0, reader.read(pkt, nullptr, 8, rep));
+    reader.close();
+
+    // The name was removed by the writer.
+    TSUNIT_ASSERT(!reader.open(name, 0, rep));
+#endif
+}
+
+void MemoryPluginTest::testSharedRingBlock()
+{
+#if defined(TS_UNIX)
+    const ts::UString name(ts::UString::Format(u"utest-block-%d", {ts::CurrentProcessId()}));
+    ts::Report& rep(NULLREP);
+
+    // Small ring with block policy: the writer waits for the reader.
+    ts::SharedPacketRing writer;
+    ts::SharedPacketRing reader;
+    TSUNIT_ASSERT(writer.create(name, 4, 2, ts::SharedPacketRing::LagPolicy::BLOCK, rep));
+    TSUNIT_ASSERT(reader.open(name, 0, rep));
+
+    ts::TSPacket ref[64];
+    for (size_t i = 0; i < 64; ++i) {
+        ref[i] = ts::NullPacket;
+        ref[i].setPID(ts::PID(i));
+    }
+
+    // Write 16 times the capacity of the ring from another thread.
+    bool written = false;
+    std::thread producer([&]() {
+        written = writer.write(ref, nullptr, 64, rep);
+        writer.close();
+    });
+
+    // Read slowly, all packets are received, in order.
+    ts::TSPacketVector received;
+    ts::TSPacket pkt[3];
+    size_t count = 0;
+    while ((count = reader.read(pkt, nullptr, 3, rep)) > 0) {
+        received.insert(received.end(), pkt, pkt + count);
+        ts::SleepThread(1);
+    }
+    producer.join();
+
+    TSUNIT_ASSERT(written);
+    TSUNIT_EQUAL(64, received.size());
+    TSUNIT_EQUAL(0, std::memcmp(&received[0], ref, 64 * ts::PKT_SIZE));
+    TSUNIT_EQUAL(0, reader.lostPackets());
+    reader.close();
+
+    // A blocked writer is interrupted by its abort interface.
+    class Abort: public ts::AbortInterface
+    {
+    public:
+        virtual bool aborting() const override { return true; }
+    };
+    Abort abort;
+    TSUNIT_ASSERT(writer.create(name, 4, 2, ts::SharedPacketRing::LagPolicy::BLOCK, rep));
+    TSUNIT_ASSERT(reader.open(name, 0, rep));
+    TSUNIT_ASSERT(writer.write(ref, nullptr, 4, rep, &abort));
+    TSUNIT_ASSERT(!writer.write(ref, nullptr, 1, rep, &abort));
+    TSUNIT_EQUAL(3, reader.read(pkt, nullptr, 3, rep));
+    TSUNIT_EQUAL(0, std::memcmp(pkt, ref, 3 * ts::PKT_SIZE));
+    reader.close();
+    writer.close();
+#endif
+}
+
+void MemoryPluginTest::testSharedRingReclaim()
+{
+#if defined(TS_UNIX)
+    const ts::UString name(ts::UString::Format(u"utest-reclaim-%d", {ts::CurrentProcessId()}));
+    const std::string segment(ts::SharedPacketRing::SegmentName(name).toUTF8());
+    ts::Report& rep(NULLREP);
+
+    ts::TSPacket ref[4];
+    for (size_t i = 0; i < 4; ++i) {
+        ref[i] = ts::NullPacket;
+        ref[i].setPID(ts::PID(i));
+    }
+
+    // A writer process crashes, without closing the ring.
+    const ::pid_t pid = ::fork();
+    TSUNIT_ASSERT(pid >= 0);
+    if (pid == 0) {
+        ts::SharedPacketRing crashed;
+        ::_exit(crashed.create(name, 8, 2, ts::SharedPacketRing::LagPolicy::DROP, rep) && crashed.write(ref, nullptr, 2, rep) ? 0 : 1);
+    }
+    int status = 0;
+    TSUNIT_EQUAL(pid, ::waitpid(pid, &status, 0));
+    TSUNIT_ASSERT(WIFEXITED(status));
+    TSUNIT_EQUAL(0, WEXITSTATUS(status));
+
+    // A reader of the crashed ring, then a new writer which reclaims the name.
+    ts::SharedPacketRing old_reader;
+    TSUNIT_ASSERT(old_reader.open(name, 0, rep));
+    ts::SharedPacketRing writer;
+    TSUNIT_ASSERT(writer.create(name, 8, 2, ts::SharedPacketRing::LagPolicy::DROP, rep));
+
+    // A second writer is rejected while the first one is alive.
+    ts::SharedPacketRing other;
+    TSUNIT_ASSERT(!other.create(name, 8, 2, ts::SharedPacketRing::LagPolicy::DROP, rep));
+
+    // The reader of the crashed ring gets an end of stream and does not remove the new ring.
+    ts::TSPacket pkt[4];
+    TSUNIT_EQUAL(0, old_reader.read(pkt, nullptr, 4, rep));
+    old_reader.close();
+    ts::SharedPacketRing reader;
+    TSUNIT_ASSERT(reader.open(name, 0, rep));
+    TSUNIT_ASSERT(writer.write(ref, nullptr, 4, rep));
+    TSUNIT_EQUAL(4, reader.read(pkt, nullptr, 4, rep));
+    TSUNIT_EQUAL(0, std::memcmp(pkt, ref, 4 * ts::PKT_SIZE));
+    reader.close();
+    writer.close();
+
+    // A writer crashed before initializing the segment: it is reclaimed after a timeout.
+    const int fd = ::shm_open(segment.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    TSUNIT_ASSERT(fd >= 0);
+    ::close(fd);
+    const ts::Time start(ts::Time::CurrentUTC());
+    TSUNIT_ASSERT(writer.create(name, 8, 2, ts::SharedPacketRing::LagPolicy::DROP, rep));
+    TSUNIT_ASSERT(ts::Time::CurrentUTC() - start >= 900);
+    TSUNIT_ASSERT(reader.open(name, 0, rep));
+    TSUNIT_ASSERT(writer.write(ref, nullptr, 1, rep));
+    TSUNIT_EQUAL(1, reader.read(pkt, nullptr, 4, rep));
+    reader.close();
+    writer.close();
+#endif
+}
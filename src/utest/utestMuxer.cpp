@@ -0,0 +1,332 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::Muxer
+//
+//----------------------------------------------------------------------------
+
+#include "tsMuxer.h"
+#include "tsPluginEventHandlerInterface.h"
+#include "tsPluginEventData.h"
+#include "tsOneShotPacketizer.h"
+#include "tsSectionDemux.h"
+#include "tsPAT.h"
+#include "tsSDT.h"
+#include "tsEIT.h"
+#include "tsCerrReport.h"
+#include "tsSysUtils.h"
+#include "tsunit.h"
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class MuxerTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testOrder();
+    void testLossy();
+
+    TSUNIT_TEST_BEGIN(MuxerTest);
+    TSUNIT_TEST(testOrder);
+    TSUNIT_TEST(testLossy);
+    TSUNIT_TEST_END();
+
+private:
+    void testCommon(bool lossy, size_t blocks, ts::MilliSecond pace);
+};
+
+TSUNIT_REGISTER(MuxerTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void MuxerTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void MuxerTest::afterTest()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Input stream: blocks of 16 packets. Block k declares service SERVICE_BASE + k
+// in a PAT, an SDT and an EIT, each one immediately preceded by a marker packet.
+// All marker packets contain their index in the input stream.
+//----------------------------------------------------------------------------
+
+namespace {
+
+    constexpr size_t   BLOCK_PACKETS = 16;
+    constexpr size_t   PAT_OFFSET = 3;       // Offset of PAT packet in a block.
+    constexpr size_t   SDT_OFFSET = 5;       // Offset of SDT packet in a block.
+    constexpr size_t   EIT_OFFSET = 7;       // Offset of EIT packet in a block.
+    constexpr ts::PID  MARKER_PID = 0x0100;
+    constexpr uint16_t SERVICE_BASE = 0x1000;
+
+    void AddTable(ts::TSPacketVector& packets, ts::DuckContext& duck, const ts::AbstractTable& table, ts::PID pid, size_t block)
+    {
+        ts::OneShotPacketizer pzer(duck, pid);
+        pzer.addTable(duck, table);
+        ts::TSPacketVector pkts;
+        pzer.getPackets(pkts);
+        TSUNIT_EQUAL(1, pkts.size());
+        pkts[0].setCC(uint8_t(block & 0x0F));
+        packets.push_back(pkts[0]);
+    }
+
+    void BuildInput(ts::TSPacketVector& packets, size_t blocks)
+    {
+        ts::DuckContext duck;
+        packets.clear();
+        for (size_t block = 0; block < blocks; ++block) {
+            const uint16_t service_id = uint16_t(SERVICE_BASE + block);
+            const uint8_t version = uint8_t(block & 0x1F);
+            for (size_t i = 0; i < BLOCK_PACKETS; ++i) {
+                if (i == PAT_OFFSET) {
+                    ts::PAT pat(version, true, 1);
+                    pat.pmts[service_id] = 0x0200;
+                    AddTable(packets, duck, pat, ts::PID_PAT, block);
+                }
+                else if (i == SDT_OFFSET) {
+                    ts::SDT sdt(true, version, true, 1, 1);
+                    sdt.services[service_id].running_status = 4;
+                    AddTable(packets, duck, sdt, ts::PID_SDT, block);
+                }
+                else if (i == EIT_OFFSET) {
+                    ts::EIT eit(true, true, 0, version, true, service_id, 1, 1);
+                    AddTable(packets, duck, eit, ts::PID_EIT, block);
+                }
+                else {
+                    ts::TSPacket pkt;
+                    pkt.init(MARKER_PID, uint8_t(packets.size() & 0x0F));
+                    ts::PutUInt32(pkt.getPayload(), uint32_t(packets.size()));
+                    packets.push_back(pkt);
+                }
+            }
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// An event handler for memory input plugin: send packets by groups.
+//----------------------------------------------------------------------------
+
+namespace {
+    class Input : public ts::PluginEventHandlerInterface
+    {
+        TS_NOBUILD_NOCOPY(Input);
+    public:
+        Input(const ts::TSPacketVector& packets, ts::MilliSecond pace) : _packets(packets), _pace(pace) {}
+        virtual void handlePluginEvent(const ts::PluginEventContext& context) override;
+    private:
+        const ts::TSPacketVector& _packets;
+        const ts::MilliSecond _pace;
+        size_t _next = 0;
+    };
+
+    void Input::handlePluginEvent(const ts::PluginEventContext& context)
+    {
+        ts::PluginEventData* data = dynamic_cast<ts::PluginEventData*>(context.pluginData());
+        if (data != nullptr && _next < _packets.size()) {
+            // Always fill the requested size to keep the input buffer aligned on groups of packets.
+            const size_t count = std::min(data->maxSize() / ts::PKT_SIZE, _packets.size() - _next);
+            data->append(&_packets[_next], count * ts::PKT_SIZE);
+            _next += count;
+            ts::SleepThread(_pace);
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// An event handler for memory output plugin: fill a vector of packets.
+//----------------------------------------------------------------------------
+
+namespace {
+    class Output : public ts::PluginEventHandlerInterface
+    {
+        TS_NOBUILD_NOCOPY(Output);
+    public:
+        Output(ts::TSPacketVector& output) : _output(output) {}
+        virtual void handlePluginEvent(const ts::PluginEventContext& context) override;
+    private:
+        ts::TSPacketVector& _output;
+    };
+
+    void Output::handlePluginEvent(const ts::PluginEventContext& context)
+    {
+        ts::PluginEventData* data = dynamic_cast<ts::PluginEventData*>(context.pluginData());
+        if (data != nullptr) {
+            const size_t packets_count = data->size() / ts::PKT_SIZE;
+            const size_t index = _output.size();
+            _output.resize(index + packets_count);
+            ts::TSPacket::Copy(&_output[index], data->data(), packets_count);
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Analysis of the output stream: position of the first occurrence of each
+// service in the PAT, SDT and EIT.
+//----------------------------------------------------------------------------
+
+namespace {
+    class Analyzer : private ts::TableHandlerInterface, private ts::SectionHandlerInterface
+    {
+        TS_NOCOPY(Analyzer);
+    public:
+        Analyzer(const ts::TSPacketVector& packets);
+
+        std::map<size_t, ts::PacketCounter>   markers {};  // Key: input index, value: output index.
+        std::map<uint16_t, ts::PacketCounter> pat {};      // Key: service id, value: output index of first PAT.
+        std::map<uint16_t, ts::PacketCounter> sdt {};      // Same for SDT.
+        std::map<uint16_t, ts::PacketCounter> eit {};      // Same for EIT.
+
+    private:
+        ts::DuckContext  _duck {};
+        ts::SectionDemux _demux {_duck, this, this};
+
+        virtual void handleTable(ts::SectionDemux& demux, const ts::BinaryTable& table) override;
+        virtual void handleSection(ts::SectionDemux& demux, const ts::Section& section) override;
+    };
+
+    Analyzer::Analyzer(const ts::TSPacketVector& packets)
+    {
+        _demux.addPID(ts::PID_PAT);
+        _demux.addPID(ts::PID_SDT);
+        _demux.addPID(ts::PID_EIT);
+        for (size_t i = 0; i < packets.size(); ++i) {
+            if (packets[i].getPID() == MARKER_PID) {
+                markers.insert(std::make_pair(size_t(ts::GetUInt32(packets[i].getPayload())), ts::PacketCounter(i)));
+            }
+            _demux.feedPacket(packets[i]);
+        }
+    }
+
+    void Analyzer::handleTable(ts::SectionDemux&, const ts::BinaryTable& table)
+    {
+        if (table.tableId() == ts::TID_PAT) {
+            const ts::PAT pat_table(_duck, table);
+            for (const auto& it : pat_table.pmts) {
+                pat.insert(std::make_pair(it.first, table.lastTSPacketIndex()));
+            }
+        }
+        else if (table.tableId() == ts::TID_SDT_ACT) {
+            const ts::SDT sdt_table(_duck, table);
+            for (const auto& it : sdt_table.services) {
+                sdt.insert(std::make_pair(it.first, table.lastTSPacketIndex()));
+            }
+        }
+    }
+
+    void Analyzer::handleSection(ts::SectionDemux&, const ts::Section& section)
+    {
+        if (section.tableId() == ts::TID_EIT_PF_ACT) {
+            eit.insert(std::make_pair(section.tableIdExtension(), section.lastTSPacketIndex()));
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void MuxerTest::testOrder()
+{
+    // Input slower than output: the core thread also inserts EIT's.
+    testCommon(false, 48, 10);
+}
+
+void MuxerTest::testLossy()
+{
+    // Input much faster than output: the input buffer overflows.
+    testCommon(true, 200, 1);
+}
+
+void MuxerTest::testCommon(bool lossy, size_t blocks, ts::MilliSecond pace)
+{
+    ts::TSPacketVector input_packets;
+    ts::TSPacketVector output_packets;
+    BuildInput(input_packets, blocks);
+
+    Input input(input_packets, pace);
+    Output output(output_packets);
+
+    // With a 16-packet input buffer, groups of 8 packets and a lossy reclaim of 8 packets,
+    // the PSI/SI of a block and their preceding markers are always dropped together.
+    ts::MuxerArgs opt;
+    opt.inputs.push_back(ts::PluginOptions(u"memory"));
+    opt.output.set(u"memory");
+    opt.outputBitRate = 2000000;
+    opt.inBufferPackets = BLOCK_PACKETS;
+    opt.maxInputPackets = BLOCK_PACKETS / 2;
+    opt.lossyInput = lossy;
+    opt.lossyReclaim = BLOCK_PACKETS / 2;
+    opt.inputOnce = true;
+    opt.outputTSId = 1;
+    opt.outputNetwId = 1;
+
+    ts::Muxer mux(CERR);
+    mux.registerEventHandler(&input, ts::PluginType::INPUT);
+    mux.registerEventHandler(&output, ts::PluginType::OUTPUT);
+    TSUNIT_ASSERT(mux.start(opt));
+    mux.waitForTermination();
+
+    const Analyzer an(output_packets);
+    debug() << "MuxerTest: lossy: " << lossy << ", input packets: " << input_packets.size()
+            << ", output packets: " << output_packets.size() << ", markers: " << an.markers.size()
+            << ", services in PAT: " << an.pat.size() << ", SDT: " << an.sdt.size() << ", EIT: " << an.eit.size() << std::endl;
+
+    // Markers are never reordered.
+    ts::PacketCounter previous = 0;
+    for (const auto& it : an.markers) {
+        TSUNIT_ASSERT(it.second >= previous);
+        previous = it.second;
+    }
+
+    // A service appears in the output PSI/SI only after the input packet which precedes
+    // the corresponding input table. If that packet was dropped, the table was dropped too
+    // and the service never appears.
+    const auto check = [&an](const std::map<uint16_t, ts::PacketCounter>& services, size_t offset) {
+        for (const auto& it : services) {
+            TSUNIT_ASSERT(it.first >= SERVICE_BASE);
+            const size_t marker = (it.first - SERVICE_BASE) * BLOCK_PACKETS + offset - 1;
+            const auto pos = an.markers.find(marker);
+            TSUNIT_ASSERT(pos != an.markers.end());
+            TSUNIT_ASSERT(pos->second < it.second);
+        }
+    };
+    check(an.pat, PAT_OFFSET);
+    check(an.sdt, SDT_OFFSET);
+    check(an.eit, EIT_OFFSET);
+
+    if (!lossy) {
+        // Without loss, no marker is missing, except at end of stream when the output is terminated.
+        TSUNIT_ASSERT(!an.markers.empty());
+        for (size_t i = 0; i < an.markers.rbegin()->first; ++i) {
+            const size_t offset = i % BLOCK_PACKETS;
+            TSUNIT_ASSERT(offset == PAT_OFFSET || offset == SDT_OFFSET || offset == EIT_OFFSET || ts::Contains(an.markers, i));
+        }
+        TSUNIT_ASSERT(!an.pat.empty());
+        TSUNIT_ASSERT(!an.sdt.empty());
+        TSUNIT_ASSERT(!an.eit.empty());
+    }
+}
@@ -77,7 +77,9 @@ public:
     void testHiDes();
     void testIP();
     void testExtension();
+    void testExtensionPrecedence();
     void testInheritance();
+    void testSections();
 
     TSUNIT_TEST_BEGIN(NamesTest);
     TSUNIT_TEST(testConfigFile);
@@ -120,7 +122,9 @@ public:
     TSUNIT_TEST(testHiDes);
     TSUNIT_TEST(testIP);
     TSUNIT_TEST(testExtension);
+    TSUNIT_TEST(testExtensionPrecedence);
     TSUNIT_TEST(testInheritance);
+    TSUNIT_TEST(testSections);
     TSUNIT_TEST_END();
 
 private:
@@ -480,6 +484,49 @@ void NamesTest::testExtension()
     ts::NamesFile::DeleteInstance(ts::NamesFile::Predefined::DTV);
 }
 
+void NamesTest::testExtensionPrecedence()
+{
+    // When ranges overlap, the main file has precedence over the extensions,
+    // then the first definition in load order is used.
+    const ts::UString extFileName(ts::TempFile(u".names"));
+    TSUNIT_ASSERT(ts::UString::Save(ts::UStringVector({
+        u"[Section]",
+        u"Bits = 8",
+        u"0x10-0x1F = main-range",
+        u"0x30 = main-30",
+    }), _tempFileName));
+    TSUNIT_ASSERT(ts::UString::Save(ts::UStringVector({
+        u"[section]",
+        u"0x05-0x12 = ext-low",
+        u"0x15 = ext-15",
+        u"0x30 = ext-30",
+        u"0x40 = ext-40",
+        u"0x41-0x45 = ext-range",
+        u"0x43 = ext-43",
+    }), extFileName));
+
+    // The overlapping ranges are reported as errors, hide them in non-debug mode.
+    const int severity = CERR.maxSeverity();
+    if (!debugMode()) {
+        CERR.setMaxSeverity(ts::Severity::Fatal);
+    }
+    ts::NamesFile::RegisterExtensionFile reg(extFileName);
+    {
+        ts::NamesFile file(_tempFileName, true);
+        TSUNIT_EQUAL(u"main-range", file.nameFromSection(u"section", 0x10));
+        TSUNIT_EQUAL(u"main-range", file.nameFromSection(u"section", 0x12));
+        TSUNIT_EQUAL(u"main-range", file.nameFromSection(u"section", 0x15));
+        TSUNIT_EQUAL(u"unknown (0x05)", file.nameFromSection(u"section", 0x05));
+        TSUNIT_EQUAL(u"main-30", file.nameFromSection(u"section", 0x30));
+        TSUNIT_EQUAL(u"ext-40", file.nameFromSection(u"section", 0x40));
+        TSUNIT_EQUAL(u"ext-range", file.nameFromSection(u"section", 0x43));
+        TSUNIT_EQUAL(4, file.errorCount());
+    }
+    ts::NamesFile::UnregisterExtensionFile(extFileName);
+    CERR.setMaxSeverity(severity);
+    ts::DeleteFile(extFileName, NULLREP);
+}
+
 void NamesTest::testInheritance()
 {
     // Create a temporary names file.
@@ -529,3 +576,34 @@ void NamesTest::testInheritance()
     TSUNIT_EQUAL(u"value1", file.nameFromSection(u"level1", 1));
     TSUNIT_EQUAL(u"unknown (0x00)", file.nameFromSection(u"level1", 0));
 }
+
+void NamesTest::testSections()
+{
+    // Sections are parsed on demand. A section can be split in several parts.
+    TSUNIT_ASSERT(ts::UString::Save(ts::UStringVector({
+        u"# Comment",
+        u"[Section1]",
+        u"Bits = 8",
+        u"0x10-0x1F = range",
+        u"0x05 = five",
+        u"",
+        u"[section2]",
+        u"  1 =   \u00E9t\u00E9  ",
+        u"[SECTION1]",
+        u"0x20 = merged",
+    }), _tempFileName));
+
+    ts::NamesFile file(_tempFileName);
+
+    TSUNIT_EQUAL(u"five", file.nameFromSection(u"section1", 5));
+    TSUNIT_EQUAL(u"range", file.nameFromSection(u"section1", 0x10));
+    TSUNIT_EQUAL(u"range", file.nameFromSection(u"section1", 0x15));
+    TSUNIT_EQUAL(u"range", file.nameFromSection(u"section1", 0x1F));
+    TSUNIT_EQUAL(u"merged (0x20)", file.nameFromSection(u"Section1", 0x20, ts::NamesFlags::VALUE));
+    TSUNIT_EQUAL(u"unknown (0x21)", file.nameFromSection(u"section1", 0x21));
+    TSUNIT_EQUAL(u"unknown (0x04)", file.nameFromSection(u"section1", 4));
+    TSUNIT_EQUAL(u"\u00E9t\u00E9", file.nameFromSection(u"section2", 1));
+    TSUNIT_ASSERT(!file.nameExists(u"section3", 1));
+
+    TSUNIT_EQUAL(0, file.errorCount());
+}
@@ -30,9 +30,11 @@ public:
     virtual void afterTest() override;
 
     void testPacketizer();
+    void testStreaming();
 
     TSUNIT_TEST_BEGIN(PESPacketizerTest);
     TSUNIT_TEST(testPacketizer);
+    TSUNIT_TEST(testStreaming);
     TSUNIT_TEST_END();
 
 private:
@@ -152,3 +154,126 @@ void PESPacketizerTest::handlePESPacket(ts::PESDemux& demux, const ts::PESPacket
             TSUNIT_FAIL("invalid PES packet count");
     }
 }
+
+
+//----------------------------------------------------------------------------
+// Streaming mode of the PES demux.
+//----------------------------------------------------------------------------
+
+namespace {
+    // Build an unbounded AVC PES packet: AUD (P picture), PPS, then one slice of the specified type.
+    ts::PESPacketPtr BuildAVCPES(uint8_t slice_type, size_t slice_size, uint8_t filler)
+    {
+        ts::ByteBlock data({
+            0x00, 0x00, 0x01, 0xE0, 0x00, 0x00, 0x80, 0x00, 0x00, // PES header, unbounded, 9 bytes
+            0x00, 0x00, 0x00, 0x01, 0x09, 0x30,                   // AUD, primary_pic_type = 1 (I, P)
+            0x00, 0x00, 0x01, 0x68, 0xCE, 0x38, 0x80,             // PPS
+            0x00, 0x00, 0x01, slice_type,                         // Slice
+        });
+        data.append(filler, slice_size);
+        return new ts::PESPacket(data.data(), data.size(), 100);
+    }
+
+    class StreamingHandler: public ts::PESHandlerInterface
+    {
+    public:
+        ts::PacketCounter     packet_index = 0;    // Index of current TS packet.
+        ts::ByteBlock         fragments {};        // Accumulated payload fragments of current PES packet.
+        std::vector<uint8_t>  start_codes {};      // NALunit types of all start codes.
+        std::vector<size_t>   start_offsets {};    // Offsets of all start codes.
+        size_t                pes_count = 0;
+        size_t                intra_count = 0;
+        size_t                stream_intra_count = 0;
+        size_t                stream_intra_offset = ts::NPOS;
+        ts::PacketCounter     stream_intra_packet = 0;
+        ts::PacketCounter     first_pes_last_packet = 0;
+        ts::PESPacketPtr      kept {};             // Shared copy of first PES packet.
+        ts::ByteBlock         kept_content {};     // Private copy of first PES packet.
+
+        virtual void handlePESPacket(ts::PESDemux&, const ts::PESPacket& pes) override
+        {
+            // All payload fragments were notified before the complete PES packet.
+            TSUNIT_EQUAL(pes.payloadSize(), fragments.size());
+            TSUNIT_ASSERT(fragments == ts::ByteBlock(pes.payload(), pes.payloadSize()));
+            fragments.clear();
+            if (pes_count++ == 0) {
+                first_pes_last_packet = pes.lastTSPacketIndex();
+                kept = new ts::PESPacket(pes, ts::ShareMode::SHARE);
+                kept_content.copy(pes.content(), pes.size());
+            }
+        }
+        virtual void handleIntraImage(ts::PESDemux&, const ts::PESPacket&, size_t offset) override
+        {
+            intra_count++;
+            TSUNIT_EQUAL(stream_intra_offset, offset);
+        }
+        virtual void handlePESPayloadFragment(ts::PESDemux&, ts::PID pid, size_t offset, const uint8_t* data, size_t size) override
+        {
+            TSUNIT_EQUAL(100, pid);
+            TSUNIT_EQUAL(fragments.size(), offset);
+            fragments.append(data, size);
+        }
+        virtual void handleStreamStartCode(ts::PESDemux&, ts::PID, ts::CodecType codec, uint8_t type, size_t offset) override
+        {
+            TSUNIT_EQUAL(ts::CodecType::AVC, codec);
+            start_codes.push_back(type);
+            start_offsets.push_back(offset);
+        }
+        virtual void handleStreamIntraImage(ts::PESDemux&, ts::PID, size_t offset) override
+        {
+            stream_intra_count++;
+            stream_intra_offset = offset;
+            stream_intra_packet = packet_index;
+        }
+    };
+}
+
+void PESPacketizerTest::testStreaming()
+{
+    // Two PES packets, an IDR picture, then a non-IDR picture.
+    ts::DuckContext duck;
+    ts::PESOneShotPacketizer zer(duck, 100);
+    zer.addPES(BuildAVCPES(0x65, 5000, 0x55));
+    zer.addPES(BuildAVCPES(0x41, 500, 0x77));
+    ts::TSPacketVector packets;
+    zer.getPackets(packets);
+    TSUNIT_ASSERT(packets.size() > 30);
+
+    StreamingHandler handler;
+    ts::PESDemux demux(duck, &handler);
+    demux.setDefaultCodec(ts::CodecType::AVC);
+    demux.setStreaming(true);
+    TSUNIT_ASSERT(demux.streaming());
+
+    for (handler.packet_index = 0; handler.packet_index < packets.size(); ++handler.packet_index) {
+        demux.feedPacket(packets[handler.packet_index]);
+    }
+    demux.flushUnboundedPES();
+
+    TSUNIT_EQUAL(2, handler.pes_count);
+    TSUNIT_EQUAL(1, handler.intra_count);
+    TSUNIT_EQUAL(1, handler.stream_intra_count);
+
+    // The IDR slice header starts at offset 16 in the PES payload.
+    TSUNIT_EQUAL(16, handler.stream_intra_offset);
+
+    // The intra-image was notified in the first TS packet, long before the end of the PES packet.
+    TSUNIT_EQUAL(0, handler.stream_intra_packet);
+    TSUNIT_ASSERT(handler.first_pes_last_packet > 20);
+
+    // All start codes, in both PES packets.
+    TSUNIT_EQUAL(6, handler.start_codes.size());
+    TSUNIT_EQUAL(9, handler.start_codes[0]);
+    TSUNIT_EQUAL(8, handler.start_codes[1]);
+    TSUNIT_EQUAL(5, handler.start_codes[2]);
+    TSUNIT_EQUAL(9, handler.start_codes[3]);
+    TSUNIT_EQUAL(8, handler.start_codes[4]);
+    TSUNIT_EQUAL(1, handler.start_codes[5]);
+    TSUNIT_EQUAL(1, handler.start_offsets[0]);
+    TSUNIT_EQUAL(6, handler.start_offsets[1]);
+    TSUNIT_EQUAL(13, handler.start_offsets[2]);
+
+    // The first PES packet, kept by the handler, was not overwritten by the second one.
+    TSUNIT_ASSERT(!handler.kept.isNull());
+    TSUNIT_ASSERT(handler.kept_content == ts::ByteBlock(handler.kept->content(), handler.kept->size()));
+}
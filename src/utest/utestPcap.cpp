@@ -0,0 +1,441 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for pcap files.
+//
+//----------------------------------------------------------------------------
+
+#include "tsPcapFilter.h"
+#include "tsPcapTSExtractor.h"
+#include "tsByteBlock.h"
+#include "tsTS.h"
+#include "tsFileUtils.h"
+#include "tsNullReport.h"
+#include "tsCerrReport.h"
+#include "tsunit.h"
+#include "utestTSUnitBenchmark.h"
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class PcapTest: public tsunit::Test
+{
+public:
+    PcapTest();
+
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testReadIPv4();
+    void testReadIP();
+    void testReadUDP();
+    void testFilterUDP();
+    void testExtractTS();
+    void testExtractRTP();
+    void testBenchmark();
+
+    TSUNIT_TEST_BEGIN(PcapTest);
+    TSUNIT_TEST(testReadIPv4);
+    TSUNIT_TEST(testReadIP);
+    TSUNIT_TEST(testReadUDP);
+    TSUNIT_TEST(testFilterUDP);
+    TSUNIT_TEST(testExtractTS);
+    TSUNIT_TEST(testExtractRTP);
+    TSUNIT_TEST(testBenchmark);
+    TSUNIT_TEST_END();
+
+private:
+    ts::UString _tempFileName;
+
+    // Build Ethernet frames.
+    static void AppendEthernet(ts::ByteBlock& frame, uint16_t ether_type);
+    static void AppendUDP(ts::ByteBlock& frame, uint16_t src_port, uint16_t dst_port, size_t payload_size);
+    static ts::ByteBlock IPv4Frame(uint8_t protocol, uint16_t fragment, size_t payload_size);
+    static ts::ByteBlock IPv6Frame(size_t payload_size);
+    static ts::ByteBlock RTPFrame(uint16_t sequence, uint32_t rtp_time);
+
+    // Save a pcap file with Ethernet frames, one microsecond apart.
+    static bool SaveFrames(const ts::UString& file_name, const ts::ByteBlock* frames, size_t count);
+
+    // Build a pcap file with a few datagrams.
+    bool buildFile();
+};
+
+TSUNIT_REGISTER(PcapTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Constructor.
+PcapTest::PcapTest() :
+    _tempFileName()
+{
+}
+
+// Test suite initialization method.
+void PcapTest::beforeTest()
+{
+    if (_tempFileName.empty()) {
+        _tempFileName = ts::TempFile(u".pcap");
+    }
+    ts::DeleteFile(_tempFileName, NULLREP);
+    TSUNIT_ASSERT(buildFile());
+}
+
+// Test suite cleanup method.
+void PcapTest::afterTest()
+{
+    ts::DeleteFile(_tempFileName, NULLREP);
+}
+
+
+//----------------------------------------------------------------------------
+// Build the test capture file.
+//----------------------------------------------------------------------------
+
+namespace {
+    constexpr size_t   TS_PAYLOAD_SIZE = 7 * ts::PKT_SIZE;
+    constexpr uint32_t IPv4_SOURCE = 0x0A000001;       // 10.0.0.1
+    constexpr uint32_t IPv4_DESTINATION = 0xEF010101;  // 239.1.1.1
+    constexpr uint16_t SOURCE_PORT = 1000;
+    constexpr uint16_t DESTINATION_PORT = 1234;
+    constexpr uint32_t FIRST_SECOND = 1000;
+}
+
+void PcapTest::AppendEthernet(ts::ByteBlock& frame, uint16_t ether_type)
+{
+    frame.append(uint8_t(0x02), 12); // MAC addresses
+    frame.appendUInt16BE(ether_type);
+}
+
+void PcapTest::AppendUDP(ts::ByteBlock& frame, uint16_t src_port, uint16_t dst_port, size_t payload_size)
+{
+    frame.appendUInt16BE(src_port);
+    frame.appendUInt16BE(dst_port);
+    frame.appendUInt16BE(uint16_t(ts::UDP_HEADER_SIZE + payload_size));
+    frame.appendUInt16BE(0); // no checksum
+    for (size_t i = 0; i < payload_size; ++i) {
+        frame.appendUInt8(i % ts::PKT_SIZE == 0 ? ts::SYNC_BYTE : uint8_t(i));
+    }
+}
+
+ts::ByteBlock PcapTest::IPv4Frame(uint8_t protocol, uint16_t fragment, size_t payload_size)
+{
+    ts::ByteBlock frame;
+    AppendEthernet(frame, ts::ETHERTYPE_IPv4);
+    const size_t ip_start = frame.size();
+    frame.appendUInt8(0x45); // version 4, 5 words header
+    frame.appendUInt8(0);
+    frame.appendUInt16BE(uint16_t(ts::IPv4_MIN_HEADER_SIZE + ts::UDP_HEADER_SIZE + payload_size));
+    frame.appendUInt16BE(0); // identification
+    frame.appendUInt16BE(fragment);
+    frame.appendUInt8(64);   // TTL
+    frame.appendUInt8(protocol);
+    frame.appendUInt16BE(0); // checksum, updated later
+    frame.appendUInt32BE(IPv4_SOURCE);
+    frame.appendUInt32BE(IPv4_DESTINATION);
+    ts::IPv4Packet::UpdateIPHeaderChecksum(frame.data() + ip_start, ts::IPv4_MIN_HEADER_SIZE);
+    // Same layout as UDP for other protocols, not analyzed.
+    AppendUDP(frame, SOURCE_PORT, DESTINATION_PORT, payload_size);
+    return frame;
+}
+
+ts::ByteBlock PcapTest::IPv6Frame(size_t payload_size)
+{
+    ts::ByteBlock frame;
+    AppendEthernet(frame, ts::ETHERTYPE_IPv6);
+    frame.appendUInt32BE(0x60000000); // version 6
+    frame.appendUInt16BE(uint16_t(8 + ts::UDP_HEADER_SIZE + payload_size));
+    frame.appendUInt8(ts::IPv6_EXT_HOP_BY_HOP);
+    frame.appendUInt8(64); // hop limit
+    frame.appendUInt64BE(0x20010DB800000000); // 2001:db8::1
+    frame.appendUInt64BE(1);
+    frame.appendUInt64BE(0xFF05000000000000); // ff05::1
+    frame.appendUInt64BE(1);
+    // Hop-by-hop options extension header, 8 bytes, padding only.
+    frame.appendUInt8(ts::IPv4_PROTO_UDP);
+    frame.appendUInt8(0);
+    frame.append(uint8_t(0x00), 6);
+    AppendUDP(frame, SOURCE_PORT + 1, DESTINATION_PORT + 1, payload_size);
+    return frame;
+}
+
+ts::ByteBlock PcapTest::RTPFrame(uint16_t sequence, uint32_t rtp_time)
+{
+    // Same UDP datagram as IPv4Frame(), the start of the payload is replaced with an RTP header.
+    ts::ByteBlock frame(IPv4Frame(ts::IPv4_PROTO_UDP, 0, ts::RTP_HEADER_SIZE + TS_PAYLOAD_SIZE));
+    uint8_t* rtp = frame.data() + frame.size() - ts::RTP_HEADER_SIZE - TS_PAYLOAD_SIZE;
+    rtp[0] = 0x80; // version 2
+    rtp[1] = ts::RTP_PT_MP2T;
+    ts::PutUInt16BE(rtp + 2, sequence);
+    ts::PutUInt32BE(rtp + 4, rtp_time);
+    ts::PutUInt32BE(rtp + 8, 0x12345678); // SSRC
+    for (size_t i = 0; i < TS_PAYLOAD_SIZE; ++i) {
+        rtp[ts::RTP_HEADER_SIZE + i] = i % ts::PKT_SIZE == 0 ? ts::SYNC_BYTE : uint8_t(i);
+    }
+    return frame;
+}
+
+bool PcapTest::buildFile()
+{
+    const ts::ByteBlock frames[] = {
+        IPv4Frame(ts::IPv4_PROTO_UDP, 0, TS_PAYLOAD_SIZE),
+        IPv6Frame(TS_PAYLOAD_SIZE),
+        IPv4Frame(ts::IPv4_PROTO_ICMP, 0, 100),
+        IPv4Frame(ts::IPv4_PROTO_UDP, 0x2000, 200),  // "More Fragments" bit set
+        IPv4Frame(ts::IPv4_PROTO_UDP, 0, 5 * ts::PKT_SIZE),
+    };
+    return SaveFrames(_tempFileName, frames, sizeof(frames) / sizeof(frames[0]));
+}
+
+bool PcapTest::SaveFrames(const ts::UString& file_name, const ts::ByteBlock* frames, size_t count)
+{
+    // Pcap file header, little endian, microsecond timestamps, Ethernet link.
+    ts::ByteBlock file;
+    file.appendUInt32LE(ts::PCAP_MAGIC_BE);
+    file.appendUInt16LE(2);
+    file.appendUInt16LE(4);
+    file.appendUInt32LE(0);
+    file.appendUInt32LE(0);
+    file.appendUInt32LE(65535);
+    file.appendUInt32LE(ts::LINKTYPE_ETHERNET);
+
+    // One record per frame, one microsecond apart.
+    for (size_t i = 0; i < count; ++i) {
+        file.appendUInt32LE(FIRST_SECOND);
+        file.appendUInt32LE(uint32_t(i));
+        file.appendUInt32LE(uint32_t(frames[i].size()));
+        file.appendUInt32LE(uint32_t(frames[i].size()));
+        file.append(frames[i]);
+    }
+    return file.saveToFile(file_name, &CERR);
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void PcapTest::testReadIPv4()
+{
+    ts::PcapFile file;
+    TSUNIT_ASSERT(file.open(_tempFileName, CERR));
+
+    ts::IPv4Packet packet;
+    ts::MicroSecond timestamp = -1;
+    TSUNIT_ASSERT(file.readIPv4(packet, timestamp, CERR));
+    TSUNIT_EQUAL(FIRST_SECOND * ts::MicroSecPerSec, timestamp);
+    TSUNIT_ASSERT(packet.isUDP());
+    TSUNIT_EQUAL(TS_PAYLOAD_SIZE, packet.protocolDataSize());
+    TSUNIT_EQUAL(IPv4_DESTINATION, packet.destinationAddress().address());
+
+    // The IPv6 datagram is skipped.
+    TSUNIT_ASSERT(file.readIPv4(packet, timestamp, CERR));
+    TSUNIT_EQUAL(FIRST_SECOND * ts::MicroSecPerSec + 2, timestamp);
+    TSUNIT_EQUAL(ts::IPv4_PROTO_ICMP, packet.protocol());
+
+    TSUNIT_ASSERT(file.readIPv4(packet, timestamp, CERR));
+    TSUNIT_ASSERT(packet.fragmented());
+    TSUNIT_ASSERT(file.readIPv4(packet, timestamp, CERR));
+    TSUNIT_EQUAL(5 * ts::PKT_SIZE, packet.protocolDataSize());
+    TSUNIT_ASSERT(!file.readIPv4(packet, timestamp, NULLREP));
+
+    TSUNIT_EQUAL(5, file.packetCount());
+    TSUNIT_EQUAL(4, file.ipv4PacketCount());
+    TSUNIT_EQUAL(FIRST_SECOND * ts::MicroSecPerSec, file.firstTimestamp());
+    TSUNIT_EQUAL(FIRST_SECOND * ts::MicroSecPerSec + 4, file.lastTimestamp());
+    file.close();
+    TSUNIT_ASSERT(!file.isOpen());
+}
+
+void PcapTest::testReadIP()
+{
+    ts::PcapFile file;
+    TSUNIT_ASSERT(file.open(_tempFileName, CERR));
+
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    ts::MicroSecond timestamp = -1;
+    std::vector<uint8_t> versions;
+    while (file.readIP(data, size, timestamp, NULLREP)) {
+        versions.push_back(data[0] >> 4);
+    }
+    TSUNIT_ASSERT(versions == std::vector<uint8_t>({4, 6, 4, 4, 4}));
+    file.close();
+}
+
+void PcapTest::testReadUDP()
+{
+    ts::PcapFilter file;
+    TSUNIT_ASSERT(file.open(_tempFileName, CERR));
+
+    // The ICMP packet and the IPv4 fragment are skipped.
+    std::vector<ts::PcapFilter::UDPDatagram> all;
+    ts::PcapFilter::UDPDatagram batch[16];
+    for (size_t count = 0; (count = file.readUDP(batch, 16, NULLREP)) > 0; ) {
+        TSUNIT_ASSERT(count == 1 || file.isMapped());
+        all.insert(all.end(), batch, batch + count);
+    }
+    TSUNIT_EQUAL(3, all.size());
+
+    TSUNIT_ASSERT(!all[0].isIPv6());
+    TSUNIT_EQUAL(FIRST_SECOND * ts::MicroSecPerSec, all[0].timestamp);
+    TSUNIT_EQUAL(TS_PAYLOAD_SIZE, all[0].size);
+    TSUNIT_EQUAL(ts::SYNC_BYTE, all[0].data[0]);
+    TSUNIT_ASSERT(all[0].sourceIPv4() == ts::IPv4SocketAddress(IPv4_SOURCE, SOURCE_PORT));
+    TSUNIT_ASSERT(all[0].destinationIPv4() == ts::IPv4SocketAddress(IPv4_DESTINATION, DESTINATION_PORT));
+
+    TSUNIT_ASSERT(all[1].isIPv6());
+    TSUNIT_EQUAL(FIRST_SECOND * ts::MicroSecPerSec + 1, all[1].timestamp);
+    TSUNIT_EQUAL(TS_PAYLOAD_SIZE, all[1].size);
+    TSUNIT_EQUAL(ts::SYNC_BYTE, all[1].data[0]);
+    TSUNIT_EQUAL(SOURCE_PORT + 1, all[1].sourcePort());
+    TSUNIT_EQUAL(DESTINATION_PORT + 1, all[1].destinationPort());
+    TSUNIT_ASSERT(all[1].sourceIPv6() == ts::IPv6SocketAddress(0x2001, 0x0DB8, 0, 0, 0, 0, 0, 1, SOURCE_PORT + 1));
+    TSUNIT_ASSERT(all[1].destinationIPv6().isMulticast());
+
+    TSUNIT_ASSERT(!all[2].isIPv6());
+    TSUNIT_EQUAL(5 * ts::PKT_SIZE, all[2].size);
+    file.close();
+}
+
+void PcapTest::testFilterUDP()
+{
+    ts::PcapFilter file;
+    TSUNIT_ASSERT(file.open(_tempFileName, CERR));
+
+    // With an IPv4 address filter, the IPv6 datagram is skipped.
+    file.setDestinationFilter(ts::IPv4SocketAddress(IPv4_DESTINATION, DESTINATION_PORT));
+    size_t total = 0;
+    ts::PcapFilter::UDPDatagram batch[16];
+    for (size_t count = 0; (count = file.readUDP(batch, 16, NULLREP)) > 0; ) {
+        for (size_t i = 0; i < count; ++i) {
+            TSUNIT_ASSERT(!batch[i].isIPv6());
+        }
+        total += count;
+    }
+    TSUNIT_EQUAL(2, total);
+    file.close();
+
+    // With a port-only filter, the IPv6 datagram is selected.
+    TSUNIT_ASSERT(file.open(_tempFileName, CERR));
+    file.setDestinationFilter(ts::IPv4SocketAddress(ts::IPv4Address::AnyAddress, DESTINATION_PORT + 1));
+    TSUNIT_EQUAL(1, file.readUDP(batch, 16, NULLREP));
+    TSUNIT_ASSERT(batch[0].isIPv6());
+    TSUNIT_EQUAL(0, file.readUDP(batch, 16, NULLREP));
+    file.close();
+}
+
+void PcapTest::testExtractTS()
+{
+    const ts::UString dir(ts::TempFile(u""));
+    ts::PcapFilter file;
+    TSUNIT_ASSERT(file.open(_tempFileName, CERR));
+
+    ts::PcapTSExtractor extractor;
+    extractor.setOutputDirectory(dir);
+    extractor.setThreadCount(2);
+    TSUNIT_ASSERT(extractor.extract(file, CERR));
+    file.close();
+
+    // One IPv4 flow in two datagrams (the fragment is ignored), one IPv6 flow.
+    const auto& stats(extractor.statistics());
+    TSUNIT_EQUAL(2, stats.size());
+
+    TSUNIT_EQUAL(ts::IPv4_VERSION, stats[0].id.ip_version);
+    TSUNIT_EQUAL(u"10.0.0.1:1000", stats[0].id.sourceName());
+    TSUNIT_EQUAL(u"239.1.1.1:1234", stats[0].id.destinationName());
+    TSUNIT_ASSERT(!stats[0].rtp);
+    TSUNIT_EQUAL(2, stats[0].datagrams);
+    TSUNIT_EQUAL(12, stats[0].packets);
+    TSUNIT_EQUAL(4, stats[0].max_interval);
+    TSUNIT_EQUAL(12 * ts::PKT_SIZE, ts::GetFileSize(stats[0].file_name));
+
+    TSUNIT_EQUAL(ts::IPv6_VERSION, stats[1].id.ip_version);
+    TSUNIT_EQUAL(1, stats[1].datagrams);
+    TSUNIT_EQUAL(7, stats[1].packets);
+    TSUNIT_EQUAL(7 * ts::PKT_SIZE, ts::GetFileSize(stats[1].file_name));
+
+    for (const auto& st : stats) {
+        ts::DeleteFile(st.file_name, NULLREP);
+    }
+    ts::DeleteFile(dir, NULLREP);
+}
+
+void PcapTest::testExtractRTP()
+{
+    // Reordered datagrams are not lost, the datagram 15 is lost.
+    const ts::ByteBlock frames[] = {
+        RTPFrame(10, 1000),
+        RTPFrame(12, 1180),
+        RTPFrame(11, 1090),
+        RTPFrame(13, 1270),
+        RTPFrame(14, 1360),
+        RTPFrame(16, 1540),
+    };
+    TSUNIT_ASSERT(SaveFrames(_tempFileName, frames, sizeof(frames) / sizeof(frames[0])));
+
+    ts::PcapFilter file;
+    TSUNIT_ASSERT(file.open(_tempFileName, CERR));
+    ts::PcapTSExtractor extractor;
+    TSUNIT_ASSERT(extractor.extract(file, CERR));
+    file.close();
+
+    const auto& stats(extractor.statistics());
+    TSUNIT_EQUAL(1, stats.size());
+    TSUNIT_ASSERT(stats[0].rtp);
+    TSUNIT_EQUAL(6, stats[0].datagrams);
+    TSUNIT_EQUAL(6 * 7, stats[0].packets);
+    TSUNIT_EQUAL(1, stats[0].rtp_lost);
+
+    // Constant transit time differences of 10 us: RTP timestamps are one 90 kHz tick (11 us)
+    // apart, the datagrams are captured 1 us apart. The jitter converges to 10 us. The smoothing
+    // by 1/16 keeps the fractional part, a difference of less than 16 us is not lost.
+    std::vector<ts::ByteBlock> slow;
+    for (uint16_t i = 0; i < 100; ++i) {
+        slow.push_back(RTPFrame(i, 1000 + i));
+    }
+    TSUNIT_ASSERT(SaveFrames(_tempFileName, slow.data(), slow.size()));
+    TSUNIT_ASSERT(file.open(_tempFileName, CERR));
+    ts::PcapTSExtractor extractor2;
+    TSUNIT_ASSERT(extractor2.extract(file, CERR));
+    file.close();
+
+    const auto& stats2(extractor2.statistics());
+    TSUNIT_EQUAL(1, stats2.size());
+    TSUNIT_ASSERT(stats2[0].rtp);
+    TSUNIT_EQUAL(0, stats2[0].rtp_lost);
+    TSUNIT_EQUAL(10, stats2[0].jitter);
+}
+
+void PcapTest::testBenchmark()
+{
+    utest::TSUnitBenchmark bench(u"TSUNIT_PCAP_ITERATIONS");
+    ts::PcapFilter file;
+    ts::PcapFilter::UDPDatagram batch[64];
+    size_t bytes = 0;
+
+    bench.start();
+    for (size_t iter = 0; iter < bench.iterations; ++iter) {
+        TSUNIT_ASSERT(file.open(_tempFileName, NULLREP));
+        for (size_t count = 0; (count = file.readUDP(batch, 64, NULLREP)) > 0; ) {
+            for (size_t i = 0; i < count; ++i) {
+                bytes += batch[i].size;
+            }
+        }
+        file.close();
+    }
+    bench.stop();
+
+    TSUNIT_EQUAL(bench.iterations * (2 * TS_PAYLOAD_SIZE + 5 * ts::PKT_SIZE), bytes);
+    bench.report(u"PcapTest::testBenchmark");
+}
@@ -14,6 +14,7 @@
 #include "tsReportFile.h"
 #include "tsFileUtils.h"
 #include "tsNullReport.h"
+#include "tsAsyncReport.h"
 #include "tsunit.h"
 
 
@@ -32,15 +33,25 @@ public:
     void testSeverity();
     void testString();
     void testPrintf();
+    void testVariadic();
     void testByName();
     void testByStream();
+    void testAsync();
+    void testAsyncShortThreads();
+    void testAsyncCoalesce();
+    void testAsyncJSON();
 
     TSUNIT_TEST_BEGIN(ReportTest);
     TSUNIT_TEST(testSeverity);
     TSUNIT_TEST(testString);
     TSUNIT_TEST(testPrintf);
+    TSUNIT_TEST(testVariadic);
     TSUNIT_TEST(testByName);
     TSUNIT_TEST(testByStream);
+    TSUNIT_TEST(testAsync);
+    TSUNIT_TEST(testAsyncShortThreads);
+    TSUNIT_TEST(testAsyncCoalesce);
+    TSUNIT_TEST(testAsyncJSON);
     TSUNIT_TEST_END();
 
 private:
@@ -251,6 +262,53 @@ void ReportTest::testPrintf()
     TSUNIT_EQUAL(u"", log.getMessages());
 }
 
+// Test case: log using printf-like formats without argument list
+namespace {
+    class CountedString: public ts::StringifyInterface
+    {
+    public:
+        mutable int count = 0;
+        virtual ts::UString toString() const override { count++; return u"str"; }
+    };
+}
+
+void ReportTest::testVariadic()
+{
+    static_assert(ts::UString::FormatArgCount(u"") == 0, "invalid FormatArgCount");
+    static_assert(ts::UString::FormatArgCount(u"abc %% def") == 0, "invalid FormatArgCount");
+    static_assert(ts::UString::FormatArgCount(u"a %d b %5'd c %-08.3f") == 3, "invalid FormatArgCount");
+    static_assert(ts::UString::FormatArgCount(u"0x%X (%<d)") == 1, "invalid FormatArgCount");
+    static_assert(ts::UString::FormatArgCount(u"%*d %-*.*s") == 5, "invalid FormatArgCount");
+    static_assert(ts::UString::FormatArgCount(u"%y %d %") == 1, "invalid FormatArgCount");
+
+    ts::ReportBuffer<> log;
+    CountedString str;
+
+    log.setMaxSeverity(ts::Severity::Info);
+    log.debug(u"%d %s", 1, str);
+    log.log(2, u"%s", str);
+    log.verbose(u"%s %d", str, 2);
+    TSUNIT_EQUAL(0, str.count);
+    TSUNIT_ASSERT(log.emptyMessages());
+
+    log.info(u"%d %s %s", 3, str, u"abc");
+    log.warning(u"0x%X (%<d)", uint8_t(12));
+    log.log(ts::Severity::Info, u"%*d|", 4, 5);
+    log.info(TS_CHECKED_FORMAT(u"%s=%d", u"checked", 6));
+    TSUNIT_EQUAL(1, str.count);
+    TSUNIT_ASSERT(!log.gotErrors());
+    log.error(u"%s", str);
+    TSUNIT_EQUAL(2, str.count);
+    TSUNIT_ASSERT(log.gotErrors());
+
+    TSUNIT_EQUAL(u"3 str abc\n"
+                 u"Warning: 0x0C (12)\n"
+                 u"   5|\n"
+                 u"checked=6\n"
+                 u"Error: str",
+                 log.getMessages());
+}
+
 // Test case: log file by name
 void ReportTest::testByName()
 {
@@ -305,3 +363,133 @@ void ReportTest::testByStream()
     ts::UString::Load(value, _fileName);
     TSUNIT_ASSERT(value == ref);
 }
+
+// An asynchronous report which collects all lines.
+namespace {
+    class AsyncReportBuffer : public ts::AsyncReport
+    {
+        TS_NOBUILD_NOCOPY(AsyncReportBuffer);
+    public:
+        AsyncReportBuffer(const ts::AsyncReportArgs& args) : ts::AsyncReport(ts::Severity::Info, args) {}
+        virtual ~AsyncReportBuffer() override { terminate(); }
+        ts::UStringVector lines {};
+    protected:
+        virtual void asyncThreadLog(int severity, const ts::UString& message) override
+        {
+            lines.push_back(message);
+            tsunit::Test::debug() << "AsyncReportBuffer: " << message << std::endl;
+        }
+    };
+}
+
+// Test case: asynchronous report from several threads
+void ReportTest::testAsync()
+{
+    ts::AsyncReportArgs args;
+    args.sync_log = true;
+    AsyncReportBuffer log(args);
+
+    static constexpr size_t COUNT = 100;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; ++t) {
+        threads.push_back(std::thread([&log, t]() {
+            for (size_t i = 0; i < COUNT; ++i) {
+                log.info(u"thread %d, message %d", {t, i});
+            }
+        }));
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    log.logSource(ts::Severity::Info, u"the end", u"foo", 3);
+    log.terminate();
+
+    TSUNIT_EQUAL(4 * COUNT + 1, log.lines.size());
+    TSUNIT_EQUAL(0, log.droppedMessages());
+    TSUNIT_EQUAL(u"foo: the end", log.lines.back());
+
+    // Messages from the same thread are in order.
+    for (size_t t = 0; t < 4; ++t) {
+        size_t next = 0;
+        const ts::UString prefix(ts::UString::Format(u"thread %d, message ", {t}));
+        for (const auto& line : log.lines) {
+            if (line.startWith(prefix)) {
+                TSUNIT_EQUAL(ts::UString::Format(u"thread %d, message %d", {t, next}), line);
+                next++;
+            }
+        }
+        TSUNIT_EQUAL(COUNT, next);
+    }
+}
+
+// Test case: coalescing of identical messages
+// Test case: asynchronous report from many short-lived threads, their rings are reclaimed
+void ReportTest::testAsyncShortThreads()
+{
+    ts::AsyncReportArgs args;
+    args.sync_log = true;
+    args.log_coalesce = false;
+    AsyncReportBuffer log(args);
+
+    static constexpr size_t COUNT = 200;
+    for (size_t t = 0; t < COUNT; ++t) {
+        // Thread ids are frequently reused by the system.
+        std::thread th([&log, t]() { log.info(u"thread %d", {t}); });
+        th.join();
+    }
+    log.terminate();
+
+    TSUNIT_EQUAL(COUNT, log.lines.size());
+    TSUNIT_EQUAL(0, log.droppedMessages());
+    for (size_t t = 0; t < COUNT && t < log.lines.size(); ++t) {
+        TSUNIT_EQUAL(ts::UString::Format(u"thread %d", {t}), log.lines[t]);
+    }
+}
+
+void ReportTest::testAsyncCoalesce()
+{
+    ts::AsyncReportArgs args;
+    args.sync_log = true;
+    args.log_coalesce = true;
+    AsyncReportBuffer log(args);
+
+    for (size_t i = 0; i < 10; ++i) {
+        log.info(u"same message");
+    }
+    log.info(u"other message");
+    log.terminate();
+
+    // Depending on the scheduling, the repetitions may be reported in several lines.
+    TSUNIT_ASSERT(log.lines.size() >= 3);
+    TSUNIT_EQUAL(u"same message", log.lines.front());
+    TSUNIT_EQUAL(u"other message", log.lines.back());
+    size_t total = 1;
+    for (size_t i = 1; i + 1 < log.lines.size(); ++i) {
+        size_t count = 0;
+        TSUNIT_ASSERT(log.lines[i].scan(u"last message repeated %d times", {&count}));
+        total += count;
+    }
+    TSUNIT_EQUAL(10, total);
+}
+
+// Test case: JSON log lines
+void ReportTest::testAsyncJSON()
+{
+    ts::AsyncReportArgs args;
+    args.sync_log = true;
+    args.log_json = true;
+    AsyncReportBuffer log(args);
+
+    log.warning(u"message 1");
+    log.logSource(ts::Severity::Info, u"message 2", u"foo", 3);
+    log.terminate();
+
+    TSUNIT_EQUAL(2, log.lines.size());
+    TSUNIT_ASSERT(log.lines[0].startWith(u"{"));
+    TSUNIT_ASSERT(log.lines[0].contain(u"\"severity\": \"warning\""));
+    TSUNIT_ASSERT(log.lines[0].contain(u"\"message\": \"message 1\""));
+    TSUNIT_ASSERT(!log.lines[0].contain(u"\"plugin\""));
+    TSUNIT_ASSERT(log.lines[1].contain(u"\"source\": \"foo\""));
+    TSUNIT_ASSERT(log.lines[1].contain(u"\"plugin\": 3"));
+    TSUNIT_ASSERT(log.lines[1].contain(u"\"time\": \""));
+}
@@ -0,0 +1,207 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::tlv::Server
+//
+//----------------------------------------------------------------------------
+
+#include "tstlvServer.h"
+#include "tstlvConnection.h"
+#include "tstlvSerializer.h"
+#include "tsECMGSCS.h"
+#include "tsGuardMutex.h"
+#include "tsSysUtils.h"
+#include "tsNullReport.h"
+#include "utestTSUnitThread.h"
+#include "tsunit.h"
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class TLVServerTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testLoopback();
+
+    TSUNIT_TEST_BEGIN(TLVServerTest);
+    TSUNIT_TEST(testLoopback);
+    TSUNIT_TEST_END();
+};
+
+TSUNIT_REGISTER(TLVServerTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void TLVServerTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void TLVServerTest::afterTest()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+// A TLV server thread. Each channel_test is answered by an ECM_response with
+// a large datagram, to fill the socket buffers, followed by a channel_status.
+// The channel id of the request is the sequence number of the request.
+namespace {
+    constexpr size_t DATAGRAM_SIZE = 32000;
+
+    class EchoServer: public utest::TSUnitThread, private ts::tlv::ServerHandlerInterface
+    {
+        TS_NOBUILD_NOCOPY(EchoServer);
+    public:
+        EchoServer(const ts::ecmgscs::Protocol& protocol) :
+            utest::TSUnitThread(),
+            _protocol(protocol),
+            _logger(ts::Severity::Debug, &CERR),
+            _server(protocol, this, _logger, 3)
+        {
+        }
+
+        virtual ~EchoServer() override
+        {
+            _server.stop();
+            waitForTermination();
+        }
+
+        // Start listening, before the client connects.
+        bool open(uint16_t port)
+        {
+            return _server.open(ts::IPv4SocketAddress(ts::IPv4Address::LocalHost, port));
+        }
+
+        // Get the channel ids of the received requests.
+        std::vector<uint16_t> received() const
+        {
+            ts::GuardMutex lock(_mutex);
+            return _received;
+        }
+
+        // Thread execution.
+        virtual void test() override
+        {
+            TSUNIT_ASSERT(_server.run());
+        }
+
+    private:
+        const ts::ecmgscs::Protocol& _protocol;
+        ts::tlv::Logger       _logger;
+        ts::tlv::Server       _server;
+        mutable ts::Mutex     _mutex {};
+        std::vector<uint16_t> _received {};
+
+        virtual void handleMessage(ts::tlv::Server& server, uint32_t client, const ts::tlv::MessagePtr& msg) override
+        {
+            const ts::ecmgscs::ChannelTest* const req = dynamic_cast<const ts::ecmgscs::ChannelTest*>(msg.pointer());
+            TSUNIT_ASSERT(req != nullptr);
+            {
+                ts::GuardMutex lock(_mutex);
+                _received.push_back(req->channel_id);
+            }
+            ts::ecmgscs::ECMResponse ecm(_protocol);
+            ecm.channel_id = req->channel_id;
+            ecm.stream_id = 1;
+            ecm.CP_number = req->channel_id;
+            ecm.ECM_datagram.resize(DATAGRAM_SIZE, uint8_t(req->channel_id));
+            TSUNIT_ASSERT(server.send(client, ecm));
+            ts::ecmgscs::ChannelStatus status(_protocol);
+            status.channel_id = req->channel_id;
+            TSUNIT_ASSERT(server.send(client, status));
+        }
+    };
+}
+
+void TLVServerTest::testLoopback()
+{
+    TSUNIT_ASSERT(ts::IPInitialize());
+
+    const uint16_t port = 12348;
+    constexpr uint16_t REQUESTS = 64;
+
+    ts::ecmgscs::Protocol protocol;
+    EchoServer server(protocol);
+    TSUNIT_ASSERT(server.open(port));
+    server.start();
+
+    ts::tlv::Logger logger(ts::Severity::Debug, &CERR);
+    ts::tlv::Connection<ts::NullMutex> client(protocol, true, 3);
+    ts::TCPConnection& raw(client);
+    TSUNIT_ASSERT(client.open(CERR));
+    TSUNIT_ASSERT(client.connect(ts::IPv4SocketAddress(ts::IPv4Address::LocalHost, port), CERR));
+
+    // Serialize all requests in one buffer.
+    ts::ByteBlockPtr data(new ts::ByteBlock);
+    std::vector<size_t> ends;
+    {
+        ts::tlv::Serializer zer(data);
+        for (uint16_t i = 0; i < REQUESTS; ++i) {
+            ts::ecmgscs::ChannelTest req(protocol);
+            req.channel_id = i;
+            req.serialize(zer);
+            ends.push_back(data->size());
+        }
+    }
+
+    // The server receives partial messages: the first request is sent byte per byte,
+    // the next ones in chunks which are not aligned on messages. The last requests
+    // are sent together.
+    size_t sent = 0;
+    while (sent < ends[0]) {
+        TSUNIT_ASSERT(raw.send(data->data() + sent, 1, CERR));
+        sent++;
+        ts::SleepThread(2);
+    }
+    while (sent < ends[REQUESTS / 2]) {
+        const size_t size = std::min<size_t>(7, ends[REQUESTS / 2] - sent);
+        TSUNIT_ASSERT(raw.send(data->data() + sent, size, CERR));
+        sent += size;
+    }
+    TSUNIT_ASSERT(raw.send(data->data() + sent, data->size() - sent, CERR));
+
+    // The server has queued more responses than the socket buffers can hold, they are
+    // sent when the socket becomes writable, in order.
+    ts::SleepThread(100);
+    for (uint16_t i = 0; i < REQUESTS; ++i) {
+        ts::tlv::MessagePtr msg;
+        TSUNIT_ASSERT(client.receive(msg, nullptr, logger));
+        const ts::ecmgscs::ECMResponse* const ecm = dynamic_cast<const ts::ecmgscs::ECMResponse*>(msg.pointer());
+        TSUNIT_ASSERT(ecm != nullptr);
+        TSUNIT_EQUAL(i, ecm->channel_id);
+        TSUNIT_EQUAL(i, ecm->CP_number);
+        TSUNIT_ASSERT(ecm->ECM_datagram == ts::ByteBlock(DATAGRAM_SIZE, uint8_t(i)));
+        TSUNIT_ASSERT(client.receive(msg, nullptr, logger));
+        const ts::ecmgscs::ChannelStatus* const status = dynamic_cast<const ts::ecmgscs::ChannelStatus*>(msg.pointer());
+        TSUNIT_ASSERT(status != nullptr);
+        TSUNIT_EQUAL(i, status->channel_id);
+    }
+
+    // All requests were received once, complete and in order.
+    const std::vector<uint16_t> received(server.received());
+    TSUNIT_EQUAL(REQUESTS, received.size());
+    for (uint16_t i = 0; i < received.size(); ++i) {
+        TSUNIT_EQUAL(i, received[i]);
+    }
+
+    client.disconnect(NULLREP);
+    client.close(NULLREP);
+}
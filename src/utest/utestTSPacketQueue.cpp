@@ -0,0 +1,218 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::TSPacketQueue
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSPacketQueue.h"
+#include "tsSysUtils.h"
+#include "tsunit.h"
+#include "utestTSUnitThread.h"
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class TSPacketQueueTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testSequential();
+    void testThreads();
+    void testStop();
+
+    TSUNIT_TEST_BEGIN(TSPacketQueueTest);
+    TSUNIT_TEST(testSequential);
+    TSUNIT_TEST(testThreads);
+    TSUNIT_TEST(testStop);
+    TSUNIT_TEST_END();
+};
+
+TSUNIT_REGISTER(TSPacketQueueTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void TSPacketQueueTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void TSPacketQueueTest::afterTest()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Test cases
+//----------------------------------------------------------------------------
+
+namespace {
+    // Build a packet with a recognizable content.
+    ts::TSPacket MakePacket(size_t index)
+    {
+        ts::TSPacket pkt(ts::NullPacket);
+        pkt.setPID(ts::PID(index % ts::PID_MAX));
+        ts::PutUInt32(pkt.b + 4, uint32_t(index));
+        return pkt;
+    }
+
+    // Push packets in the queue, by chunks.
+    void PushPackets(ts::TSPacketQueue& queue, size_t first, size_t count)
+    {
+        while (count > 0) {
+            ts::TSPacket* buffer = nullptr;
+            size_t size = 0;
+            TSUNIT_ASSERT(queue.lockWriteBuffer(buffer, size, std::min<size_t>(count, 7)));
+            size = std::min(size, count);
+            for (size_t i = 0; i < size; ++i) {
+                buffer[i] = MakePacket(first++);
+            }
+            queue.releaseWriteBuffer(size);
+            count -= size;
+        }
+    }
+}
+
+void TSPacketQueueTest::testSequential()
+{
+    ts::TSPacketQueue queue(10);
+    ts::TSPacket pkt;
+    ts::TSPacket buffer[20];
+    ts::BitRate bitrate = 0;
+
+    TSUNIT_EQUAL(10, queue.bufferSize());
+    TSUNIT_EQUAL(0, queue.currentSize());
+    TSUNIT_ASSERT(!queue.getPacket(pkt, bitrate));
+    TSUNIT_ASSERT(!queue.eof());
+
+    queue.setBitrate(1000000);
+    PushPackets(queue, 0, 8);
+    TSUNIT_EQUAL(8, queue.currentSize());
+    TSUNIT_ASSERT(queue.getPacket(pkt, bitrate));
+    TSUNIT_EQUAL(1000000, bitrate.toInt());
+    TSUNIT_ASSERT(pkt == MakePacket(0));
+
+    // Wrap around the end of the buffer, get all packets at once.
+    PushPackets(queue, 8, 3);
+    TSUNIT_EQUAL(10, queue.currentSize());
+    TSUNIT_EQUAL(10, queue.getPackets(buffer, 20, bitrate));
+    for (size_t i = 0; i < 10; ++i) {
+        TSUNIT_ASSERT(buffer[i] == MakePacket(i + 1));
+    }
+    TSUNIT_EQUAL(0, queue.getPackets(buffer, 20, bitrate));
+
+    queue.setEOF();
+    TSUNIT_ASSERT(queue.eof());
+}
+
+namespace {
+    class WriterThread: public utest::TSUnitThread
+    {
+        TS_NOBUILD_NOCOPY(WriterThread);
+    private:
+        ts::TSPacketQueue& _queue;
+        size_t _count;
+    public:
+        WriterThread(ts::TSPacketQueue& queue, size_t count) :
+            utest::TSUnitThread(),
+            _queue(queue),
+            _count(count)
+        {
+        }
+
+        virtual ~WriterThread() override
+        {
+            waitForTermination();
+        }
+
+        virtual void test() override
+        {
+            PushPackets(_queue, 0, _count);
+            _queue.setEOF();
+        }
+    };
+}
+
+void TSPacketQueueTest::testThreads()
+{
+    constexpr size_t COUNT = 100000;
+    ts::TSPacketQueue queue(13);
+    WriterThread writer(queue, COUNT);
+    TSUNIT_ASSERT(writer.start());
+
+    // Alternate waiting reads and non-waiting reads.
+    size_t index = 0;
+    ts::TSPacket buffer[16];
+    ts::BitRate bitrate = 0;
+    size_t count = 0;
+    while (queue.waitPackets(buffer, (index % 3) + 1, count, bitrate)) {
+        for (size_t i = 0; i < count; ++i) {
+            TSUNIT_ASSERT(buffer[i] == MakePacket(index++));
+        }
+        count = queue.getPackets(buffer, 16, bitrate);
+        for (size_t i = 0; i < count; ++i) {
+            TSUNIT_ASSERT(buffer[i] == MakePacket(index++));
+        }
+    }
+    TSUNIT_EQUAL(COUNT, index);
+    TSUNIT_ASSERT(queue.eof());
+}
+
+namespace {
+    class BlockedWriterThread: public utest::TSUnitThread
+    {
+        TS_NOBUILD_NOCOPY(BlockedWriterThread);
+    private:
+        ts::TSPacketQueue& _queue;
+    public:
+        explicit BlockedWriterThread(ts::TSPacketQueue& queue) :
+            utest::TSUnitThread(),
+            _queue(queue)
+        {
+        }
+
+        virtual ~BlockedWriterThread() override
+        {
+            waitForTermination();
+        }
+
+        virtual void test() override
+        {
+            // Fill the queue, the second write blocks until the reader stops.
+            ts::TSPacket* buffer = nullptr;
+            size_t size = 0;
+            TSUNIT_ASSERT(_queue.lockWriteBuffer(buffer, size, 4));
+            _queue.releaseWriteBuffer(size);
+            TSUNIT_ASSERT(!_queue.lockWriteBuffer(buffer, size, 1));
+            TSUNIT_EQUAL(0, size);
+        }
+    };
+}
+
+void TSPacketQueueTest::testStop()
+{
+    ts::TSPacketQueue queue(4);
+    BlockedWriterThread writer(queue);
+    TSUNIT_ASSERT(writer.start());
+    while (queue.currentSize() < 4) {
+        ts::SleepThread(1);
+    }
+    ts::SleepThread(20);
+    queue.stop();
+    writer.waitForTermination();
+    TSUNIT_ASSERT(queue.stopped());
+    TSUNIT_EQUAL(4, queue.currentSize());
+}
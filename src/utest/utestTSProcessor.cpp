@@ -12,6 +12,9 @@
 
 #include "tsTSProcessor.h"
 #include "tsPluginRepository.h"
+#include "tsPluginEventData.h"
+#include "tsSysUtils.h"
+#include "tsNullReport.h"
 #include "tsCerrReport.h"
 #include "tsunit.h"
 
@@ -27,9 +30,11 @@ public:
     virtual void afterTest() override;
 
     void testProcessing();
+    void testSlices();
 
     TSUNIT_TEST_BEGIN(TSProcessorTest);
     TSUNIT_TEST(testProcessing);
+    TSUNIT_TEST(testSlices);
     TSUNIT_TEST_END();
 };
 
@@ -214,6 +219,63 @@ void TestEventHandler::handlePluginEvent(const ts::PluginEventContext& ctx)
 }
 
 
+//----------------------------------------------------------------------------
+// Event handlers for memory input and output plugins, to test the slices
+// of packets. The input slowly delivers one numbered packet at a time.
+//----------------------------------------------------------------------------
+
+namespace {
+    class SlowInput : public ts::PluginEventHandlerInterface
+    {
+        TS_NOBUILD_NOCOPY(SlowInput);
+    public:
+        SlowInput(size_t count, ts::MilliSecond interval) : _count(count), _interval(interval) {}
+        virtual void handlePluginEvent(const ts::PluginEventContext& context) override;
+        std::atomic<size_t> delivered {0};
+    private:
+        const size_t _count;
+        const ts::MilliSecond _interval;
+    };
+
+    void SlowInput::handlePluginEvent(const ts::PluginEventContext& context)
+    {
+        ts::PluginEventData* data = dynamic_cast<ts::PluginEventData*>(context.pluginData());
+        if (data != nullptr && delivered < _count) {
+            ts::SleepThread(_interval);
+            ts::TSPacket pkt(ts::NullPacket);
+            ts::PutUInt32BE(pkt.b + 4, uint32_t(delivered));
+            data->append(pkt.b, ts::PKT_SIZE);
+            delivered++;
+        }
+    }
+
+    class SliceOutput : public ts::PluginEventHandlerInterface
+    {
+        TS_NOBUILD_NOCOPY(SliceOutput);
+    public:
+        SliceOutput(const SlowInput& input) : _input(input) {}
+        virtual void handlePluginEvent(const ts::PluginEventContext& context) override;
+        std::vector<uint32_t> indexes {};  // Indexes of received packets.
+        size_t first_delivered = 0;        // Number of input packets when the first packet was output.
+    private:
+        const SlowInput& _input;
+    };
+
+    void SliceOutput::handlePluginEvent(const ts::PluginEventContext& context)
+    {
+        ts::PluginEventData* data = dynamic_cast<ts::PluginEventData*>(context.pluginData());
+        if (data != nullptr) {
+            if (indexes.empty()) {
+                first_delivered = _input.delivered;
+            }
+            for (size_t i = 0; i + ts::PKT_SIZE <= data->size(); i += ts::PKT_SIZE) {
+                indexes.push_back(ts::GetUInt32BE(data->data() + i + 4));
+            }
+        }
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Unitary tests.
 //----------------------------------------------------------------------------
@@ -303,3 +365,66 @@ void TSProcessorTest::testProcessing()
     TSUNIT_EQUAL(3,          handler2.logs[0].count);
     TSUNIT_EQUAL(26,         handler2.logs[0].packets);
 }
+
+void TSProcessorTest::testSlices()
+{
+    ts::PluginRepository::Instance().registerProcessor(u"test1", TestPlugin::CreateInstance);
+
+    // Large slices: all packets are processed by all plugins.
+    {
+        ts::TSProcessorArgs opt;
+        opt.app_name = u"TSProcessorTest::testSlices";
+        opt.input = {u"null", {u"10000"}};
+        opt.plugins = {
+            {u"test1", {u"--count", u"1000"}},
+            {u"test1", {u"--count", u"1000"}},
+        };
+        opt.output = {u"drop"};
+        opt.min_slice_pkt = 128;
+
+        ts::TSProcessor tsproc(CERR);
+        TestEventHandler handler;
+        ts::TSProcessor::Criteria crit;
+        crit.event_code = TestPlugin::EVENT_STOP;
+        tsproc.registerEventHandler(&handler, crit);
+
+        TSUNIT_ASSERT(tsproc.start(opt));
+        tsproc.waitForTermination();
+
+        TSUNIT_EQUAL(2, handler.logs.size());
+        TSUNIT_EQUAL(10000, handler.logs[0].packets);
+        TSUNIT_EQUAL(10000, handler.logs[1].packets);
+    }
+
+    // Slow input: the slices are never complete, the packets are output after the
+    // maximum latency, long before the end of the input, and in the right order.
+    {
+        constexpr size_t COUNT = 40;
+        SlowInput input(COUNT, 5);
+        SliceOutput output(input);
+
+        ts::TSProcessorArgs opt;
+        opt.app_name = u"TSProcessorTest::testSlices";
+        opt.input = {u"memory", {}};
+        opt.plugins = {
+            {u"test1", {}},
+            {u"test1", {}},
+        };
+        opt.output = {u"memory", {}};
+        opt.min_slice_pkt = 1000;
+        opt.max_slice_latency = 10;
+
+        ts::TSProcessor tsproc(NULLREP);
+        tsproc.registerEventHandler(&input, ts::PluginType::INPUT);
+        tsproc.registerEventHandler(&output, ts::PluginType::OUTPUT);
+        TSUNIT_ASSERT(tsproc.start(opt));
+        tsproc.waitForTermination();
+
+        debug() << "TSProcessorTest::testSlices: first output after " << output.first_delivered << " input packets" << std::endl;
+        TSUNIT_EQUAL(COUNT, output.indexes.size());
+        for (size_t i = 0; i < output.indexes.size(); ++i) {
+            TSUNIT_EQUAL(i, output.indexes[i]);
+        }
+        TSUNIT_ASSUME(output.first_delivered < COUNT);
+    }
+}
@@ -26,6 +26,7 @@
 #include "tsEacemPreferredNameIdentifierDescriptor.h"
 #include "tsEacemLogicalChannelNumberDescriptor.h"
 #include "tsEutelsatChannelNumberDescriptor.h"
+#include "tsSupplementaryAudioDescriptor.h"
 #include "tsDuckContext.h"
 #include "tsTSPacket.h"
 #include "tsunit.h"
@@ -52,6 +53,8 @@ public:
     void testTOT();
     void testTSDT();
     void testCleanupPrivateDescriptors();
+    void testDeserializedDescriptors();
+    void testSharedDescriptors();
 
     TSUNIT_TEST_BEGIN(TableTest);
     TSUNIT_TEST(testAssignPMT);
@@ -65,6 +68,8 @@ public:
     TSUNIT_TEST(testTOT);
     TSUNIT_TEST(testTSDT);
     TSUNIT_TEST(testCleanupPrivateDescriptors);
+    TSUNIT_TEST(testDeserializedDescriptors);
+    TSUNIT_TEST(testSharedDescriptors);
     TSUNIT_TEST_END();
 };
 
@@ -347,3 +352,108 @@ void TableTest::testCleanupPrivateDescriptors()
     TSUNIT_EQUAL(1, dlist.count());
     TSUNIT_EQUAL(ts::DID_SERVICE, dlist[0]->tag());
 }
+
+void TableTest::testDeserializedDescriptors()
+{
+    ts::DuckContext duck;
+    ts::DescriptorList dlist(nullptr);
+    dlist.add(duck, ts::AVCVideoDescriptor());
+    dlist.add(duck, ts::CADescriptor(0x1234, 2002));
+    dlist.add(duck, ts::CADescriptor(0x5678, 3003));
+
+    TSUNIT_ASSERT(dlist.containsTag(ts::DID_CA));
+    TSUNIT_ASSERT(dlist.containsTag(ts::DID_AVC_VIDEO));
+    TSUNIT_ASSERT(!dlist.containsTag(ts::DID_AC3));
+    TSUNIT_EQUAL(3, dlist.search(ts::DID_AC3));
+    TSUNIT_EQUAL(1, dlist.search(ts::DID_CA));
+
+    // Deserialized once, then reused.
+    const ts::CADescriptor* ca1 = dlist.deserializedAt<ts::CADescriptor>(duck, 1);
+    TSUNIT_ASSERT(ca1 != nullptr);
+    TSUNIT_EQUAL(0x1234, ca1->cas_id);
+    TSUNIT_EQUAL(2002, ca1->ca_pid);
+    TSUNIT_ASSERT(dlist.deserializedAt<ts::CADescriptor>(duck, 1) == ca1);
+    TSUNIT_ASSERT(dlist.deserializedAt<ts::CADescriptor>(duck, 0) == nullptr);
+    TSUNIT_ASSERT(dlist.deserializedAt<ts::CADescriptor>(duck, 3) == nullptr);
+
+    ts::CADescriptor ca;
+    TSUNIT_EQUAL(2, dlist.search(duck, ts::DID_CA, ca, 2));
+    TSUNIT_EQUAL(3003, ca.ca_pid);
+
+    // Copies do not share the deserialized objects.
+    ts::DescriptorList dlist2(nullptr, dlist);
+    TSUNIT_ASSERT(dlist2.containsTag(ts::DID_CA));
+    const ts::CADescriptor* ca2 = dlist2.deserializedAt<ts::CADescriptor>(duck, 1);
+    TSUNIT_ASSERT(ca2 != nullptr);
+    TSUNIT_ASSERT(ca2 != ca1);
+    TSUNIT_EQUAL(2002, ca2->ca_pid);
+
+    // Failed deserializations are kept too.
+    TSUNIT_ASSERT(dlist2.deserializedAt<ts::AVCVideoDescriptor>(duck, 1) == nullptr);
+    TSUNIT_ASSERT(dlist2.deserializedAt<ts::AVCVideoDescriptor>(duck, 1) == nullptr);
+    TSUNIT_ASSERT(dlist2.deserializedAt<ts::CADescriptor>(duck, 1) == ca2);
+
+    // A modified binary descriptor is deserialized again.
+    dlist2[1]->payload()[3] = 0x10;
+    ca2 = dlist2.deserializedAt<ts::CADescriptor>(duck, 1);
+    TSUNIT_ASSERT(ca2 != nullptr);
+    TSUNIT_EQUAL((2002 & 0x1F00) | 0x10, ca2->ca_pid);
+    TSUNIT_ASSERT(dlist2.deserializedAt<ts::CADescriptor>(duck, 1) == ca2);
+
+    TSUNIT_EQUAL(2, dlist.removeByTag(ts::DID_CA));
+    TSUNIT_ASSERT(!dlist.containsTag(ts::DID_CA));
+    TSUNIT_ASSERT(dlist.containsTag(ts::DID_AVC_VIDEO));
+    TSUNIT_EQUAL(1, dlist.search(ts::DID_CA));
+    TSUNIT_ASSERT(dlist2.containsTag(ts::DID_CA));
+}
+
+void TableTest::testSharedDescriptors()
+{
+    ts::DuckContext duck;
+    ts::CAT cat;
+    cat.descs.add(duck, ts::CADescriptor(0x1234, 2002));
+    cat.descs.add(duck, ts::SupplementaryAudioDescriptor());
+
+    // Extended tags.
+    TSUNIT_EQUAL(1, cat.descs.search(ts::EDID::ExtensionDVB(ts::EDID_SUPPL_AUDIO)));
+    TSUNIT_EQUAL(2, cat.descs.search(ts::EDID::ExtensionDVB(ts::EDID_SUPPL_AUDIO), 2));
+    TSUNIT_EQUAL(2, cat.descs.search(ts::EDID::ExtensionMPEG(0x02)));
+
+    // All threads use the same deserialized views of a shared table.
+    cat.setShared();
+    const ts::CAT& shared(cat);
+    constexpr size_t thread_count = 4;
+    std::vector<const ts::CADescriptor*> views(thread_count, nullptr);
+    std::vector<size_t> changes(thread_count, 0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < thread_count; ++t) {
+        threads.push_back(std::thread([&shared, &views, &changes, t]() {
+            ts::DuckContext tduck;
+            for (size_t i = 0; i < 1000; ++i) {
+                const ts::CADescriptor* ca = shared.descs.deserializedAt<ts::CADescriptor>(tduck, 0);
+                if (ca != views[t]) {
+                    views[t] = ca;
+                    changes[t]++;
+                }
+            }
+        }));
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    for (size_t t = 0; t < thread_count; ++t) {
+        TSUNIT_ASSERT(views[t] != nullptr);
+        TSUNIT_ASSERT(views[t] == views[0]);
+        TSUNIT_EQUAL(1, changes[t]);
+    }
+    TSUNIT_EQUAL(2002, views[0]->ca_pid);
+
+    // A copy of a shared table is private, with its own descriptors and views.
+    ts::CAT copy(shared);
+    TSUNIT_ASSERT(!copy.isShared());
+    TSUNIT_ASSERT(copy.descs[0].pointer() != shared.descs[0].pointer());
+    const ts::CADescriptor* ca = copy.descs.deserializedAt<ts::CADescriptor>(duck, 0);
+    TSUNIT_ASSERT(ca != nullptr);
+    TSUNIT_ASSERT(ca != views[0]);
+    TSUNIT_EQUAL(2002, ca->ca_pid);
+}
@@ -28,11 +28,13 @@ public:
     void testMinimum();
     void testMemory();
     void testFile();
+    void testFileBlocks();
 
     TSUNIT_TEST_BEGIN(TimeShiftBufferTest);
     TSUNIT_TEST(testMinimum);
     TSUNIT_TEST(testMemory);
     TSUNIT_TEST(testFile);
+    TSUNIT_TEST(testFileBlocks);
     TSUNIT_TEST_END();
 
 private:
@@ -145,3 +147,9 @@ void TimeShiftBufferTest::testFile()
 {
     testCommon(20, 4);
 }
+
+void TimeShiftBufferTest::testFileBlocks()
+{
+    // Read-ahead and write-behind blocks of 5 packets, not aligned on the file size.
+    testCommon(77, 20);
+}
@@ -0,0 +1,159 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2023, Thierry Lelegard
+// BSD-2-Clause license, see LICENSE.txt file or https://tsduck.io/license
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::TimerWheel
+//
+//----------------------------------------------------------------------------
+
+#include "tsTimerWheel.h"
+#include "tsunit.h"
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class TimerWheelTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testStartExpire();
+    void testCancel();
+    void testRevolutions();
+    void testNextTimeout();
+
+    TSUNIT_TEST_BEGIN(TimerWheelTest);
+    TSUNIT_TEST(testStartExpire);
+    TSUNIT_TEST(testCancel);
+    TSUNIT_TEST(testRevolutions);
+    TSUNIT_TEST(testNextTimeout);
+    TSUNIT_TEST_END();
+};
+
+TSUNIT_REGISTER(TimerWheelTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void TimerWheelTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void TimerWheelTest::afterTest()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void TimerWheelTest::testStartExpire()
+{
+    ts::TimerWheel<int> wheel(1, 16);
+    TSUNIT_ASSERT(wheel.empty());
+
+    TSUNIT_ASSERT(wheel.start(30, 3) != ts::TimerWheel<int>::INVALID_TIMER);
+    wheel.start(10, 1);
+    wheel.start(20, 2);
+    wheel.start(10, 11);
+    TSUNIT_EQUAL(4, wheel.size());
+
+    std::vector<int> expired;
+    TSUNIT_EQUAL(0, wheel.expire(5, expired));
+    TSUNIT_ASSERT(expired.empty());
+
+    // Same due time: order of start.
+    TSUNIT_EQUAL(2, wheel.expire(10, expired));
+    TSUNIT_EQUAL(2, expired.size());
+    TSUNIT_EQUAL(1, expired[0]);
+    TSUNIT_EQUAL(11, expired[1]);
+
+    // Late call: all expired timers in order of due time, appended.
+    TSUNIT_EQUAL(2, wheel.expire(100, expired));
+    TSUNIT_EQUAL(4, expired.size());
+    TSUNIT_EQUAL(2, expired[2]);
+    TSUNIT_EQUAL(3, expired[3]);
+    TSUNIT_ASSERT(wheel.empty());
+
+    // A timer in the past expires at next call.
+    expired.clear();
+    wheel.start(50, 5);
+    TSUNIT_EQUAL(1, wheel.expire(100, expired));
+    TSUNIT_EQUAL(5, expired[0]);
+}
+
+void TimerWheelTest::testCancel()
+{
+    ts::TimerWheel<int> wheel(1, 16);
+    const auto id1 = wheel.start(10, 1);
+    const auto id2 = wheel.start(10, 2);
+    TSUNIT_ASSERT(id1 != id2);
+
+    TSUNIT_ASSERT(wheel.cancel(id1));
+    TSUNIT_ASSERT(!wheel.cancel(id1));
+    TSUNIT_ASSERT(!wheel.cancel(ts::TimerWheel<int>::INVALID_TIMER));
+    TSUNIT_EQUAL(1, wheel.size());
+
+    std::vector<int> expired;
+    TSUNIT_EQUAL(1, wheel.expire(10, expired));
+    TSUNIT_EQUAL(2, expired[0]);
+    TSUNIT_ASSERT(!wheel.cancel(id2));
+
+    wheel.start(20, 3);
+    wheel.start(30, 4);
+    wheel.clear();
+    TSUNIT_ASSERT(wheel.empty());
+    TSUNIT_EQUAL(0, wheel.expire(100, expired));
+}
+
+void TimerWheelTest::testRevolutions()
+{
+    // Timers more than one revolution away share slots with closer ones.
+    ts::TimerWheel<int> wheel(10, 8);
+    wheel.start(25, 1);      // tick 2
+    wheel.start(105, 2);     // tick 10, same slot as tick 2
+    wheel.start(185, 3);     // tick 18, same slot again
+
+    std::vector<int> expired;
+    TSUNIT_EQUAL(1, wheel.expire(30, expired));
+    TSUNIT_EQUAL(1, expired[0]);
+    TSUNIT_EQUAL(0, wheel.expire(100, expired));
+    TSUNIT_EQUAL(1, wheel.expire(110, expired));
+    TSUNIT_EQUAL(2, expired[1]);
+    TSUNIT_EQUAL(1, wheel.expire(1000, expired));
+    TSUNIT_EQUAL(3, expired[2]);
+    TSUNIT_ASSERT(wheel.empty());
+}
+
+void TimerWheelTest::testNextTimeout()
+{
+    ts::TimerWheel<int> wheel(1, 100);
+    TSUNIT_EQUAL(ts::Infinite, wheel.nextTimeout(0));
+
+    wheel.start(40, 1);
+    wheel.start(25, 2);
+    TSUNIT_EQUAL(25, wheel.nextTimeout(0));
+    TSUNIT_EQUAL(5, wheel.nextTimeout(20));
+    TSUNIT_EQUAL(0, wheel.nextTimeout(30));
+
+    std::vector<int> expired;
+    wheel.expire(30, expired);
+    TSUNIT_EQUAL(10, wheel.nextTimeout(30));
+    wheel.expire(40, expired);
+
+    // Beyond one revolution, wake up at end of current revolution.
+    wheel.start(1000, 3);
+    TSUNIT_EQUAL(100, wheel.nextTimeout(40));
+}